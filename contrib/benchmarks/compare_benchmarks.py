@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Compares two benchmark result directories and flags large deltas.
+
+Usage: compare_benchmarks.py <baseline-dir> <candidate-dir> [threshold]
+
+Both directories should have been produced by run_benchmarks.py against
+two build trees. Every numeric metric in the suites' JSON files is
+compared; metrics whose relative change exceeds the threshold (default
+0.05, i.e. 5%) are flagged. Whether a change is a regression or an
+improvement is inferred from the metric name: *_per_sec rates are
+better when higher, while seconds, bytes and peak_rss_kb are better
+when lower. Keys under "config" describe the workload and are only
+checked for equality, since comparing timings from different workloads
+is meaningless.
+
+Exits nonzero when any regression (or workload mismatch) is found, so
+this can gate CI.
+"""
+
+import json
+import os
+import sys
+
+HIGHER_IS_BETTER = ('_per_sec',)
+LOWER_IS_BETTER = ('seconds', '_secs', 'bytes', '_kb', '_ns')
+
+
+def flatten(value, prefix=''):
+    """Yields (dotted-key, leaf) pairs from nested JSON objects."""
+    if isinstance(value, dict):
+        for key, child in value.items():
+            yield from flatten(child, prefix + key + '.')
+    else:
+        yield prefix[:-1], value
+
+
+def direction(key):
+    leaf = key.rsplit('.', 1)[-1]
+    if any(leaf.endswith(s) for s in HIGHER_IS_BETTER):
+        return 1
+    if any(leaf.endswith(s) or leaf == s for s in LOWER_IS_BETTER):
+        return -1
+    return 0
+
+
+def compare_file(name, baseline, candidate, threshold):
+    base = dict(flatten(baseline))
+    cand = dict(flatten(candidate))
+
+    regressions = 0
+    for key in sorted(set(base) | set(cand)):
+        if key not in base or key not in cand:
+            side = 'baseline' if key in base else 'candidate'
+            print('  {:<40} only in {}'.format(key, side))
+            continue
+
+        old, new = base[key], cand[key]
+        if key.startswith('config.'):
+            if old != new:
+                print('  {:<40} WORKLOAD MISMATCH: {} vs {}'.format(
+                    key, old, new))
+                regressions += 1
+            continue
+
+        if not isinstance(old, (int, float)) \
+                or not isinstance(new, (int, float)):
+            continue
+        if old == new:
+            continue
+        delta = (new - old) / old if old else float('inf')
+        if abs(delta) <= threshold:
+            continue
+
+        sense = direction(key) * (1 if delta > 0 else -1)
+        label = {1: 'improvement', -1: 'REGRESSION', 0: 'changed'}[sense]
+        if sense < 0:
+            regressions += 1
+        print('  {:<40} {:>14.6g} -> {:>14.6g} ({:+.1%}) {}'.format(
+            key, old, new, delta, label))
+
+    return regressions
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__.strip())
+        return 1
+
+    baseline_dir = sys.argv[1]
+    candidate_dir = sys.argv[2]
+    threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 0.05
+
+    names = sorted(n for n in os.listdir(baseline_dir)
+                   if n.endswith('.json')
+                   and os.path.exists(os.path.join(candidate_dir, n)))
+    if not names:
+        print('no common result files between {} and {}'.format(
+            baseline_dir, candidate_dir))
+        return 1
+
+    regressions = 0
+    for name in names:
+        print('{}:'.format(name))
+        with open(os.path.join(baseline_dir, name)) as f:
+            baseline = json.load(f)
+        with open(os.path.join(candidate_dir, name)) as f:
+            candidate = json.load(f)
+        regressions += compare_file(name, baseline, candidate, threshold)
+
+    if regressions:
+        print('{} regression(s) above the {:.0%} threshold'.format(
+            regressions, threshold))
+        return 1
+    print('no regressions above the {:.0%} threshold'.format(threshold))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
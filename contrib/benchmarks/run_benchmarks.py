@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Runs the MeTA benchmark suites and collects their results.
+
+Usage: run_benchmarks.py <build-dir> <output-dir> [suite ...]
+
+Runs each benchmark executable from <build-dir> (the tools use fixed
+seeds, so repeated runs over the same tree are comparable) and writes
+one file per suite into <output-dir>: <suite>.json for the JSON-emitting
+suites and analyzers.txt for the text-only analyzer report. With no
+suite names given, every suite is attempted; suites whose prerequisites
+are missing (bench-embeddings without an [embeddings] config, or
+search-bench without the cranfield index config) are skipped with a
+note rather than failing the whole run.
+
+Compare two result directories with compare_benchmarks.py. This script
+is normally driven by the top-level `benchmarks` target.
+"""
+
+import os
+import subprocess
+import sys
+
+# suite name -> (executable, extra arguments). The search suite writes
+# its JSON itself (second argument); the others emit JSON on stdout.
+# Paths are relative to the build directory, matching the conventions of
+# the unit-test and bench-search targets.
+SUITES = {
+    'core': ('bench-core', []),
+    'index': ('bench-index', []),
+    'topics': ('bench-topics', []),
+    'search': ('search-bench', ['../config.toml']),
+    'embeddings': ('bench-embeddings', ['../config.toml']),
+    'analyzers': ('bench-analyzers', ['../data/sample-document.txt',
+                                      '../data/lemur-stopwords.txt',
+                                      '../data/sentence-boundaries']),
+}
+
+
+def find_binary(build_dir, name):
+    """Locates an executable by target name anywhere in the build tree."""
+    for root, _, files in os.walk(build_dir):
+        if name in files:
+            path = os.path.join(root, name)
+            if os.access(path, os.X_OK):
+                return path
+    return None
+
+
+def run_suite(suite, build_dir, output_dir):
+    binary, args = SUITES[suite]
+    path = find_binary(build_dir, binary)
+    if path is None:
+        print('-- skipping {}: {} not built'.format(suite, binary))
+        return True
+
+    out_name = 'analyzers.txt' if suite == 'analyzers' \
+        else '{}.json'.format(suite)
+    out_path = os.path.join(output_dir, out_name)
+    if suite == 'search':
+        args = args + [out_path]
+
+    print('-- running {}: {} {}'.format(suite, binary, ' '.join(args)))
+    result = subprocess.run([path] + args, cwd=build_dir,
+                            stdout=subprocess.PIPE)
+    if result.returncode != 0:
+        print('-- skipping {}: {} exited with status {}'.format(
+            suite, binary, result.returncode))
+        return True
+
+    if suite != 'search':
+        with open(out_path, 'wb') as output:
+            output.write(result.stdout)
+    return os.path.exists(out_path)
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__.strip())
+        return 1
+
+    build_dir = sys.argv[1]
+    output_dir = sys.argv[2]
+    suites = sys.argv[3:] or list(SUITES)
+
+    unknown = [s for s in suites if s not in SUITES]
+    if unknown:
+        print('unknown suites: {} (choose from {})'.format(
+            ', '.join(unknown), ', '.join(SUITES)))
+        return 1
+
+    os.makedirs(output_dir, exist_ok=True)
+
+    ok = True
+    for suite in suites:
+        ok = run_suite(suite, build_dir, output_dir) and ok
+
+    print('-- results written to {}'.format(output_dir))
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,4 +1,5 @@
 #include "meta/analyzers/analyzer.h"
+#include "meta/analyzers/field_analyzer.h"
 #include "meta/analyzers/multi_analyzer.h"
 
 #include "meta/analyzers/ngram/ngram_analyzer.h"
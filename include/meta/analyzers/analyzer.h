@@ -13,9 +13,12 @@
 
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include "meta/analyzers/featurizer.h"
 #include "meta/config.h"
+#include "meta/corpus/corpus.h"
+#include "meta/parallel/thread_pool.h"
 
 namespace cpptoml
 {
@@ -89,6 +92,32 @@ class analyzer
     virtual void tokenize(const corpus::document& doc, featurizer& counts) = 0;
 };
 
+/**
+ * Analyzes every document in a corpus using a pool of threads, cloning
+ * the analyzer once per thread. Standalone feature generation (outside
+ * of index creation, which parallelizes on its own) is otherwise limited
+ * to one analyze() call at a time.
+ *
+ * @param ana The analyzer to run over the documents
+ * @param docs The corpus to analyze
+ * @param pool The thread pool to shard the documents across
+ * @return the feature_map for each document, in corpus order
+ */
+template <class T>
+std::vector<feature_map<T>> analyze_batch(const analyzer& ana,
+                                          corpus::corpus& docs,
+                                          parallel::thread_pool& pool)
+{
+    std::vector<feature_map<T>> results(docs.size());
+    corpus::parallel_consume(
+        docs, pool, [&]() { return ana.clone(); },
+        [&](std::unique_ptr<analyzer>& local_ana,
+            const corpus::document& doc) {
+            results[doc.id()] = local_ana->template analyze<T>(doc);
+        });
+    return results;
+}
+
 /**
  * Basic exception for analyzer interactions.
  */
@@ -0,0 +1,96 @@
+/**
+ * @file field_analyzer.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_FIELD_ANALYZER_H_
+#define META_FIELD_ANALYZER_H_
+
+#include "meta/analyzers/analyzer_factory.h"
+#include "meta/analyzers/token_stream.h"
+#include "meta/util/clonable.h"
+
+namespace meta
+{
+namespace analyzers
+{
+
+/**
+ * Analyzes a single string metadata field of each document, emitting its
+ * unigrams namespaced under the field's name (e.g. "title:wing" for the
+ * term "wing" occurring in the "title" field). Combined with the regular
+ * content analyzers via [[analyzers]], this stripes per-field postings
+ * into the same inverted index and document space, so field-aware rankers
+ * like okapi_bm25f can score several fields in one postings traversal
+ * instead of federating one index per field.
+ *
+ * Documents without metadata (e.g. query documents) produce no features,
+ * so query tokenization through the same analyzer chain is unaffected.
+ *
+ * Required config parameters:
+ * ~~~toml
+ * [[analyzers]]
+ * method = "field" # this analyzer
+ * field = "title" # string metadata field name from the corpus config
+ * filter = "default-unigram-chain" # filter type required
+ * ~~~
+ *
+ * Optional config parameters: none.
+ */
+class field_analyzer : public util::clonable<analyzer, field_analyzer>
+{
+  public:
+    /**
+     * Constructor.
+     * @param field The name of the metadata field to analyze
+     * @param field_index The position of that field in the corpus'
+     * metadata schema
+     * @param stream The stream to read tokens from
+     */
+    field_analyzer(std::string field, uint64_t field_index,
+                   std::unique_ptr<token_stream> stream);
+
+    /**
+     * Copy constructor.
+     * @param other The other field_analyzer to copy from
+     */
+    field_analyzer(const field_analyzer& other);
+
+    /// Identifier for this analyzer.
+    const static util::string_view id;
+
+    /**
+     * @param field The field a term occurred in
+     * @param term The term itself
+     * @return the namespaced feature emitted for a term occurring in a
+     * field; rankers use this to look up a term's per-field postings
+     */
+    static std::string field_term(const std::string& field,
+                                  const std::string& term);
+
+  private:
+    virtual void tokenize(const corpus::document& doc,
+                          featurizer& counts) override;
+
+    /// The name of the field to analyze
+    std::string field_;
+
+    /// The field's position in the metadata schema
+    uint64_t field_index_;
+
+    /// The token stream to be used for extracting tokens
+    std::unique_ptr<token_stream> stream_;
+};
+
+/**
+ * Specialization of the factory method for creating field_analyzers.
+ */
+template <>
+std::unique_ptr<analyzer> make_analyzer<field_analyzer>(const cpptoml::table&,
+                                                        const cpptoml::table&);
+}
+}
+#endif
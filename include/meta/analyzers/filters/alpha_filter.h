@@ -52,7 +52,7 @@ class alpha_filter : public util::clonable<token_stream, alpha_filter>
     /**
      * Obtains the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -73,6 +73,12 @@ class alpha_filter : public util::clonable<token_stream, alpha_filter>
 
     /// The buffered token.
     util::optional<std::string> token_;
+
+    /// Scratch copy of the source token for the utf calls
+    std::string scratch_;
+
+    /// The most recently emitted token
+    std::string current_;
 };
 }
 }
@@ -54,7 +54,7 @@ class empty_sentence_filter
     /**
      * Obtains the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -78,6 +78,9 @@ class empty_sentence_filter
 
     /// Keeps track of the right hand side of a potentially empty sentence
     util::optional<std::string> second_;
+
+    /// The most recently emitted token
+    std::string current_;
 };
 }
 }
@@ -58,7 +58,7 @@ class english_normalizer
     /**
      * Obtains the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -73,14 +73,14 @@ class english_normalizer
      * Determines if the given token is a whitespace token.
      * @param token The given token
      */
-    bool is_whitespace(const std::string& token) const;
+    bool is_whitespace(util::string_view token) const;
 
     /**
      * Converts the given non-whitespace token into a series of tokens and
      * places them on the buffer.
      * @param token The given token
      */
-    void parse_token(const std::string& token);
+    void parse_token(util::string_view token);
 
     /**
      * Checks for starting quotes in the token, adding a normalized begin
@@ -88,7 +88,7 @@ class english_normalizer
      * @param start The index to start searching at
      * @param token The given token
      */
-    uint64_t starting_quotes(uint64_t start, const std::string& token);
+    uint64_t starting_quotes(uint64_t start, util::string_view token);
 
     /**
      * Checks if the given character is a passable quote symbol.
@@ -101,7 +101,7 @@ class english_normalizer
      * @param start The index to start searching at
      * @param token The given token
      */
-    uint64_t strip_dashes(uint64_t start, const std::string& token);
+    uint64_t strip_dashes(uint64_t start, util::string_view token);
 
     /**
      * Reads "word" characters (alpha numeric and dashes) starting at start
@@ -110,18 +110,21 @@ class english_normalizer
      * @param start The index to start searching at
      * @param token The given token
      */
-    uint64_t word(uint64_t start, const std::string& token);
+    uint64_t word(uint64_t start, util::string_view token);
 
     /**
      * @return the next buffered token.
      */
-    std::string current_token();
+    util::string_view current_token();
 
     /// The source to read tokens from
     std::unique_ptr<token_stream> source_;
 
     /// Buffered tokens to return
     std::deque<std::string> tokens_;
+
+    /// The most recently emitted token
+    std::string current_;
 };
 }
 }
@@ -65,7 +65,7 @@ class icu_filter : public util::clonable<token_stream, icu_filter>
     /**
      * @return the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -89,6 +89,12 @@ class icu_filter : public util::clonable<token_stream, icu_filter>
 
     /// Current token (if available)
     util::optional<std::string> token_;
+
+    /// Scratch copy of the source token for the transliteration call
+    std::string scratch_;
+
+    /// The most recently emitted token
+    std::string current_;
 };
 
 /**
@@ -68,7 +68,7 @@ class length_filter : public util::clonable<token_stream, length_filter>
     /**
      * @return the next token in the sequence
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -90,6 +90,9 @@ class length_filter : public util::clonable<token_stream, length_filter>
     /// The next buffered token
     util::optional<std::string> token_;
 
+    /// The most recently emitted token
+    std::string current_;
+
     /// The minimum length of a token that can be emitted by this filter
     uint64_t min_length_;
 
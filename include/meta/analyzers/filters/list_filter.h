@@ -10,9 +10,9 @@
 #define META_LIST_FILTER_H_
 
 #include <memory>
-#include <unordered_set>
 
 #include "meta/analyzers/filter_factory.h"
+#include "meta/hashing/probe_set.h"
 #include "meta/util/clonable.h"
 #include "meta/util/optional.h"
 
@@ -83,7 +83,7 @@ class list_filter : public util::clonable<token_stream, list_filter>
     /**
      * @return the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -105,8 +105,14 @@ class list_filter : public util::clonable<token_stream, list_filter>
     /// The next buffered token
     util::optional<std::string> token_;
 
-    /// The set of tokens used for filtering
-    std::unordered_set<std::string> list_;
+    /// The most recently emitted token
+    std::string current_;
+
+    /// The set of tokens used for filtering. A flat probing table with
+    /// farm_hash makes the per-token membership check one hash and one
+    /// probe over contiguous storage, which matters since this filter
+    /// sits on the critical path of every indexed token.
+    hashing::probe_set<std::string> list_;
 
     /// Whether or not this filter accepts or rejects tokens in the list
     type method_;
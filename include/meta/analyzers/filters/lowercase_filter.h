@@ -52,7 +52,7 @@ class lowercase_filter : public util::clonable<token_stream, lowercase_filter>
     /**
      * Obtains the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -65,6 +65,12 @@ class lowercase_filter : public util::clonable<token_stream, lowercase_filter>
   private:
     /// The stream to read tokens from.
     std::unique_ptr<token_stream> source_;
+
+    /// Scratch copy of the source token for the case folding call
+    std::string scratch_;
+
+    /// The most recently emitted (folded) token
+    std::string token_;
 };
 }
 }
@@ -10,9 +10,9 @@
 #define META_FILTER_PORTER2_FILTER_H_
 
 #include <memory>
+#include <vector>
 #include "meta/analyzers/token_stream.h"
 #include "meta/util/clonable.h"
-#include "meta/util/optional.h"
 #include "meta/util/string_view.h"
 
 namespace meta
@@ -26,6 +26,10 @@ namespace filters
  * Filter that stems words according to the porter2 stemmer algorithm.
  * Requires that the porter2 stemmer project submodule be downloaded.
  *
+ * Internally, tokens are pulled from the source and stemmed a block at
+ * a time via porter2::stem_batch(); the token_stream interface is
+ * unchanged.
+ *
  * Required config parameters: none.
  * Optional config parameters: none.
  */
@@ -54,7 +58,7 @@ class porter2_filter : public util::clonable<token_stream, porter2_filter>
     /**
      * Obtains the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines if there are more tokens available in the stream.
@@ -66,15 +70,29 @@ class porter2_filter : public util::clonable<token_stream, porter2_filter>
 
   private:
     /**
-     * Finds the next valid token for this filter.
+     * Finds the next valid token for this filter, refilling and
+     * stemming a new block from the source when the current one is
+     * exhausted.
      */
     void next_token();
 
     /// The stream to read tokens from
     std::unique_ptr<token_stream> source_;
 
-    /// The buffered next token.
-    util::optional<std::string> token_;
+    /// Tokens pulled from the source and stemmed as a block
+    std::vector<std::string> block_;
+
+    /// The number of valid tokens in the current block
+    std::size_t count_{0};
+
+    /// The position of the next token to emit within the block
+    std::size_t pos_{0};
+
+    /// Whether the block holds a token to emit
+    bool has_token_{false};
+
+    /// The most recently emitted token
+    std::string current_;
 };
 }
 }
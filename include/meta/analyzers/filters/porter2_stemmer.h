@@ -11,6 +11,7 @@
 #define PORTER2_STEMMER_H_
 
 #include <string>
+#include <vector>
 #include "meta/util/string_view.h"
 
 namespace meta
@@ -26,6 +27,23 @@ namespace porter2
  * @param word The word to stem
  */
 void stem(std::string& word);
+
+/**
+ * Stems a range of words in-place, amortizing the call overhead across
+ * the batch and keeping the stemmer's suffix tables hot in cache.
+ * Equivalent to calling stem() on each element.
+ * @param first The beginning of the range to stem
+ * @param last The end of the range to stem
+ */
+void stem_batch(std::vector<std::string>::iterator first,
+                std::vector<std::string>::iterator last);
+
+/**
+ * Stems a buffer of words in-place. Equivalent to calling stem() on
+ * each element.
+ * @param words The words to stem
+ */
+void stem_batch(std::vector<std::string>& words);
 }
 }
 }
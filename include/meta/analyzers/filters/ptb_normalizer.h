@@ -55,7 +55,7 @@ class ptb_normalizer : public util::clonable<token_stream, ptb_normalizer>
     /**
      * Obtains the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -69,7 +69,13 @@ class ptb_normalizer : public util::clonable<token_stream, ptb_normalizer>
     /**
      * @return the token from the front of the buffered tokens list
      */
-    std::string current_token();
+    util::string_view current_token();
+
+    /**
+     * Copies a token into the token buffer.
+     * @param token The token to buffer
+     */
+    void buffer_token(util::string_view token);
 
     /**
      * Performs token normalization, splitting, etc.  The token(s) are
@@ -77,13 +83,16 @@ class ptb_normalizer : public util::clonable<token_stream, ptb_normalizer>
      *
      * @param token The token to be parsed
      */
-    void parse_token(const std::string& token);
+    void parse_token(util::string_view token);
 
     /// The source to read tokens from
     std::unique_ptr<token_stream> source_;
 
     /// Buffered tokens to return
     std::deque<std::string> tokens_;
+
+    /// The most recently emitted token
+    std::string current_;
 };
 }
 }
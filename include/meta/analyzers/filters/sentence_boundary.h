@@ -74,7 +74,7 @@ class sentence_boundary : public util::clonable<token_stream, sentence_boundary>
     /**
      * @return the next token in the sequence.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines whether there are more tokens available in the stream.
@@ -88,7 +88,7 @@ class sentence_boundary : public util::clonable<token_stream, sentence_boundary>
     /**
      * @return the next buffered token.
      */
-    std::string current_token();
+    util::string_view current_token();
 
     /**
      * Determines if the given token is a possible end of sentence
@@ -115,6 +115,9 @@ class sentence_boundary : public util::clonable<token_stream, sentence_boundary>
     /// The current buffered tokens
     std::deque<std::string> tokens_;
 
+    /// The most recently emitted token
+    std::string current_;
+
     /// The previous token
     util::optional<std::string> prev_;
 
@@ -0,0 +1,90 @@
+/**
+ * @file fused_unigram_chain.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_ANALYZERS_FUSED_UNIGRAM_CHAIN_H_
+#define META_ANALYZERS_FUSED_UNIGRAM_CHAIN_H_
+
+#include <string>
+
+#include "meta/analyzers/token_stream.h"
+#include "meta/analyzers/tokenizers/icu_tokenizer.h"
+#include "meta/config.h"
+#include "meta/hashing/probe_set.h"
+#include "meta/util/clonable.h"
+
+namespace meta
+{
+namespace analyzers
+{
+
+/**
+ * A fused, single-pass implementation of the "default-unigram-chain"
+ * filter stack (icu_tokenizer -> lowercase -> alpha -> length(2, 35) ->
+ * stopword list -> porter2). Building the chain out of individual
+ * token_stream filters costs a virtual call and a buffered hand-off per
+ * token per stage; this class runs all of the stages over each token in
+ * one loop with direct calls, so the whole chain is a single virtual
+ * call per emitted token at the stream boundary.
+ *
+ * The output is identical to the filter-by-filter construction, so
+ * analyzer::load() substitutes this class transparently whenever a
+ * config requests the default unigram chain.
+ */
+class fused_unigram_chain
+    : public util::clonable<token_stream, fused_unigram_chain>
+{
+  public:
+    /**
+     * @param stopword_file Path to the stopword list, one word per line
+     */
+    fused_unigram_chain(const std::string& stopword_file);
+
+    /**
+     * Copy constructs a fused_unigram_chain.
+     */
+    fused_unigram_chain(const fused_unigram_chain& other);
+
+    void set_content(std::string&& content) override;
+
+    util::string_view next() override;
+
+    operator bool() const override;
+
+    /// Identifier for this filter chain
+    const static util::string_view id;
+
+  private:
+    /**
+     * Runs the fused filter loop until a token survives every stage (or
+     * the tokenizer is exhausted).
+     */
+    void next_token();
+
+    /// The tokenizer feeding the chain; called directly, not virtually
+    tokenizers::icu_tokenizer tokenizer_;
+
+    /// The stopword list applied after case folding; a flat probing
+    /// table keeps the membership check to one hash and one probe
+    hashing::probe_set<std::string> stopwords_;
+
+    /// The next buffered token, when has_token_ is set
+    std::string token_;
+
+    /// The most recently emitted token
+    std::string current_;
+
+    /// Scratch copy of the source token for the utf calls
+    std::string scratch_;
+
+    /// Whether token_ holds a token to emit
+    bool has_token_{false};
+};
+}
+}
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file hashed_ngram_analyzer.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_HASHED_NGRAM_ANALYZER_H_
+#define META_HASHED_NGRAM_ANALYZER_H_
+
+#include <memory>
+
+#include "meta/analyzers/analyzer.h"
+#include "meta/config.h"
+#include "meta/learn/instance.h"
+
+namespace meta
+{
+namespace analyzers
+{
+
+class token_stream;
+
+/**
+ * Analyzes documents using hashed word n-grams. Where
+ * ngram_word_analyzer materializes every n-gram as a concatenated
+ * string key (and thus a vocabulary_map entry), this analyzer feature
+ * hashes each n-gram directly to a 64-bit id and emits
+ * learn::feature_vectors with no string keys at all. The id space is
+ * truncated to a configurable number of bits for collision control, so
+ * the feature space stays fixed regardless of n.
+ *
+ * Because its features are numeric rather than strings, this class
+ * does not plug into the analyzer/featurizer hierarchy; it is intended
+ * for building learn datasets without an index.
+ *
+ * Required config parameters:
+ * ~~~toml
+ * [[analyzers]]
+ * ngram = 3 # integer required
+ * filter = "default-chain" # filter type required
+ * ~~~
+ *
+ * Optional config parameters:
+ * ~~~toml
+ * hash-bits = 18 # width of the hashed feature space
+ * ~~~
+ */
+class hashed_ngram_analyzer
+{
+  public:
+    /**
+     * Constructor.
+     * @param n The value of n to use for the ngrams
+     * @param bits The number of bits to retain of each hashed id
+     * @param stream The stream to read tokens from
+     */
+    hashed_ngram_analyzer(uint16_t n, uint8_t bits,
+                          std::unique_ptr<token_stream> stream);
+
+    /**
+     * Copy constructor.
+     * @param other The other hashed_ngram_analyzer to copy from
+     */
+    hashed_ngram_analyzer(const hashed_ngram_analyzer& other);
+
+    /**
+     * Hashes each n-gram of the document's token stream into the
+     * feature space.
+     * @param doc The document to analyze
+     * @return the feature_vector of hashed n-gram counts
+     */
+    learn::feature_vector analyze(const corpus::document& doc);
+
+    /**
+     * @return the n value used for the n-grams
+     */
+    uint16_t n_value() const;
+
+    /**
+     * @return the size of the hashed feature space, \f$2^{bits}\f$
+     */
+    uint64_t num_features() const;
+
+  private:
+    /// The value of n for the n-grams
+    uint16_t n_;
+
+    /// Mask truncating hashed ids to the configured bit width
+    uint64_t mask_;
+
+    /// The token stream to be used for extracting tokens
+    std::unique_ptr<token_stream> stream_;
+};
+
+/**
+ * Factory method for creating a hashed_ngram_analyzer from
+ * configuration.
+ * @param global The global configuration group
+ * @param config The configuration group for this analyzer
+ */
+std::unique_ptr<hashed_ngram_analyzer>
+make_hashed_ngram_analyzer(const cpptoml::table& global,
+                           const cpptoml::table& config);
+}
+}
+#endif
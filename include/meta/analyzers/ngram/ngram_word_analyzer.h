@@ -11,6 +11,7 @@
 
 #include "meta/analyzers/analyzer_factory.h"
 #include "meta/analyzers/ngram/ngram_analyzer.h"
+#include "meta/util/arena.h"
 #include "meta/util/clonable.h"
 
 namespace meta
@@ -63,6 +64,11 @@ class ngram_word_analyzer
 
     /// The token stream to be used for extracting tokens
     std::unique_ptr<token_stream> stream_;
+
+    /// Scratch arena for the per-document token window, reset for each
+    /// document tokenized. Analyzers are cloned per thread, so this is
+    /// not shared.
+    util::arena arena_;
 };
 
 /**
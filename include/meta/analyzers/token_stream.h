@@ -15,6 +15,7 @@
 #include <stdexcept>
 
 #include "meta/config.h"
+#include "meta/util/string_view.h"
 
 namespace meta
 {
@@ -25,14 +26,22 @@ namespace analyzers
  * Base class that represents a stream of tokens that have been extracted
  * from a document. These tokens may be raw tokens (in the case of a
  * tokenizer class) or filtered tokens (from the filter classes).
+ *
+ * Tokens are handed out as string_views into a buffer owned by the
+ * stream, so a chain of filters passes tokens along without allocating a
+ * string per token per stage; filters that rewrite text copy into their
+ * own (reused) buffer first. Consumers that need to retain a token past
+ * the next call to next() or set_content() must copy it.
  */
 class token_stream
 {
   public:
     /**
-     * Obtains the next token in the sequence.
+     * Obtains the next token in the sequence. The returned view is
+     * invalidated by the next call to next() or set_content() on this
+     * stream.
      */
-    virtual std::string next() = 0;
+    virtual util::string_view next() = 0;
 
     /**
      * Determines whether there are more tokens available in the
@@ -49,9 +49,9 @@ class character_tokenizer
 
     /**
      * @return the next token in the document. This token will contain a
-     * single character.
+     * single character viewed directly from the document content.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines if there are more tokens in the document.
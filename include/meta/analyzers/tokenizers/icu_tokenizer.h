@@ -100,7 +100,7 @@ class icu_tokenizer : public util::clonable<token_stream, icu_tokenizer>
      * non-whitespace characters, or a token consisting of only
      * whitespace characters.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines if there are more tokens in the document.
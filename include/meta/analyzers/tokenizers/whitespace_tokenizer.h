@@ -54,9 +54,10 @@ class whitespace_tokenizer : public util::clonable<token_stream,
     /**
      * @return the next token in the document. This will either be a
      * whitespace character, or a token consisting of a sequence of
-     * non-whitespace characters.
+     * non-whitespace characters. The returned view points directly into
+     * the document content; no copy is made.
      */
-    std::string next() override;
+    util::string_view next() override;
 
     /**
      * Determines if there are more tokens in the document.
@@ -1,3 +1,4 @@
+#include "meta/caching/concurrent_cache.h"
 #include "meta/caching/dblru_cache.h"
 #include "meta/caching/no_evict_cache.h"
 #include "meta/caching/shard_cache.h"
@@ -0,0 +1,153 @@
+/**
+ * @file concurrent_cache.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_CONCURRENT_CACHE_H_
+#define META_CONCURRENT_CACHE_H_
+
+#include "meta/config.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#if !META_HAS_STD_SHARED_PTR_ATOMICS
+#include <mutex>
+#include "meta/util/shim.h"
+#endif
+
+#include "meta/util/optional.h"
+
+namespace meta
+{
+namespace caching
+{
+
+/**
+ * A read-optimized concurrent cache designed for multi-threaded query
+ * serving, where splay_cache's global mutex (and its habit of mutating
+ * the tree on every find) causes heavy lock contention.
+ *
+ * The cache is a fixed-capacity open-addressing table of slots, each
+ * holding a shared_ptr to an immutable (key, value) entry. Lookups probe
+ * a small window of slots using the std::shared_ptr atomic access
+ * functions, so the read path takes no locks and writes nothing but a
+ * relaxed per-slot reference bit. Insertions use the same atomic
+ * accesses; eviction is a CLOCK-style (second chance) approximation of
+ * LRU within the probe window, so recently referenced entries survive
+ * while cold ones are replaced.
+ *
+ * Because eviction is local to a probe window, the cache may drop an
+ * entry while spare capacity exists elsewhere in the table; this is the
+ * usual trade made to keep the fast path synchronization-free.
+ */
+template <class Key, class Value>
+class concurrent_cache
+{
+  public:
+    /**
+     * Constructs a concurrent_cache holding at most (approximately) the
+     * given number of entries. The capacity is rounded up to a power of
+     * two.
+     *
+     * @param max_size the maximum allowed size for this cache
+     */
+    concurrent_cache(uint64_t max_size);
+
+    /**
+     * concurrent_cache may be move constructed.
+     */
+    concurrent_cache(concurrent_cache&&);
+
+    /**
+     * concurrent_cache may be assigned.
+     * @return the current concurrent_cache
+     */
+    concurrent_cache& operator=(concurrent_cache rhs);
+
+    /**
+     * Swaps the current concurrent_cache with a given one. This is not
+     * safe to run concurrently with other operations on either cache.
+     *
+     * @param other the cache to swap with
+     */
+    void swap(concurrent_cache& other);
+
+    /**
+     * Inserts a given (key, value) pair into the cache, possibly
+     * evicting a cold entry in the key's probe window.
+     *
+     * @param key
+     * @param value
+     */
+    void insert(const Key& key, const Value& value);
+
+    /**
+     * Finds a value in the cache. If it exists, the optional will be
+     * engaged, otherwise, it will be disengaged.
+     *
+     * @param key the key to find the corresponding value for
+     * @return an optional that may contain the value, if found
+     */
+    util::optional<Value> find(const Key& key);
+
+    /** Empties the cache. */
+    void clear();
+
+  private:
+    /**
+     * An immutable (key, value) pair with its CLOCK reference bit.
+     * Entries are shared so that readers can keep one alive while an
+     * insertion concurrently replaces the slot pointing at it.
+     */
+    struct entry
+    {
+        entry(const Key& k, const Value& v) : key{k}, value{v}
+        {
+            // nothing
+        }
+
+        const Key key;
+        const Value value;
+        std::atomic<bool> referenced{true};
+    };
+
+    /**
+     * @param slot the slot to read
+     * @return the entry the slot currently points at, if any
+     */
+    std::shared_ptr<entry> load_slot(uint64_t slot) const;
+
+    /**
+     * @param slot the slot to overwrite
+     * @param ent the entry to place in the slot
+     */
+    void store_slot(uint64_t slot, std::shared_ptr<entry> ent);
+
+    /// the slots of the open-addressing table
+    std::vector<std::shared_ptr<entry>> slots_;
+
+    /// bitmask for reducing hashes to slot indexes (capacity - 1)
+    uint64_t mask_;
+
+    /// the hash function for placing keys
+    std::hash<Key> hasher_;
+
+#if !META_HAS_STD_SHARED_PTR_ATOMICS
+    /// fallback lock for platforms without std::shared_ptr atomics
+    std::unique_ptr<std::mutex> mutables_{make_unique<std::mutex>()};
+#endif
+
+    /// the number of slots probed for a given key
+    const static uint64_t probe_window = 8;
+};
+}
+}
+
+#include "meta/caching/concurrent_cache.tcc"
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file concurrent_cache.tcc
+ */
+
+#include "meta/caching/concurrent_cache.h"
+
+namespace meta
+{
+namespace caching
+{
+
+template <class Key, class Value>
+concurrent_cache<Key, Value>::concurrent_cache(uint64_t max_size)
+{
+    uint64_t capacity = 1;
+    while (capacity < max_size)
+        capacity <<= 1;
+    slots_.resize(capacity);
+    mask_ = capacity - 1;
+}
+
+template <class Key, class Value>
+concurrent_cache<Key, Value>::concurrent_cache(concurrent_cache&& other)
+    : slots_{std::move(other.slots_)},
+      mask_{other.mask_},
+      hasher_{std::move(other.hasher_)}
+{
+    // nothing
+}
+
+template <class Key, class Value>
+concurrent_cache<Key, Value>& concurrent_cache<Key, Value>::
+operator=(concurrent_cache rhs)
+{
+    swap(rhs);
+    return *this;
+}
+
+template <class Key, class Value>
+void concurrent_cache<Key, Value>::swap(concurrent_cache& other)
+{
+    std::swap(slots_, other.slots_);
+    std::swap(mask_, other.mask_);
+    std::swap(hasher_, other.hasher_);
+#if !META_HAS_STD_SHARED_PTR_ATOMICS
+    std::swap(mutables_, other.mutables_);
+#endif
+}
+
+template <class Key, class Value>
+auto concurrent_cache<Key, Value>::load_slot(uint64_t slot) const
+    -> std::shared_ptr<entry>
+{
+#if META_HAS_STD_SHARED_PTR_ATOMICS
+    return std::atomic_load(&slots_[slot]);
+#else
+    std::lock_guard<std::mutex> lock{*mutables_};
+    return slots_[slot];
+#endif
+}
+
+template <class Key, class Value>
+void concurrent_cache<Key, Value>::store_slot(uint64_t slot,
+                                              std::shared_ptr<entry> ent)
+{
+#if META_HAS_STD_SHARED_PTR_ATOMICS
+    std::atomic_store(&slots_[slot], std::move(ent));
+#else
+    std::lock_guard<std::mutex> lock{*mutables_};
+    slots_[slot] = std::move(ent);
+#endif
+}
+
+template <class Key, class Value>
+util::optional<Value> concurrent_cache<Key, Value>::find(const Key& key)
+{
+    auto home = hasher_(key);
+    for (uint64_t i = 0; i < probe_window; ++i)
+    {
+        auto ent = load_slot((home + i) & mask_);
+        if (ent && ent->key == key)
+        {
+            // second-chance bit for the CLOCK eviction; relaxed since it
+            // is only a hint and carries no other data
+            ent->referenced.store(true, std::memory_order_relaxed);
+            return {ent->value};
+        }
+    }
+    return util::nullopt;
+}
+
+template <class Key, class Value>
+void concurrent_cache<Key, Value>::insert(const Key& key, const Value& value)
+{
+    auto ent = std::make_shared<entry>(key, value);
+    auto home = hasher_(key);
+
+    // prefer an empty slot (or one already holding this key) so that we
+    // only evict when the probe window is actually full
+    for (uint64_t i = 0; i < probe_window; ++i)
+    {
+        auto slot = (home + i) & mask_;
+        auto old = load_slot(slot);
+        if (!old || old->key == key)
+        {
+            store_slot(slot, std::move(ent));
+            return;
+        }
+    }
+
+    // CLOCK eviction: clear reference bits until we find an entry that
+    // was not referenced since the last sweep, then replace it
+    for (uint64_t i = 0; i < probe_window; ++i)
+    {
+        auto slot = (home + i) & mask_;
+        auto old = load_slot(slot);
+        if (old && !old->referenced.exchange(false, std::memory_order_relaxed))
+        {
+            store_slot(slot, std::move(ent));
+            return;
+        }
+    }
+
+    // everything in the window was recently referenced; fall back to the
+    // home slot rather than dropping the new entry
+    store_slot(home & mask_, std::move(ent));
+}
+
+template <class Key, class Value>
+void concurrent_cache<Key, Value>::clear()
+{
+    for (uint64_t slot = 0; slot < slots_.size(); ++slot)
+        store_slot(slot, nullptr);
+}
+}
+}
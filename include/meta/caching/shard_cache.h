@@ -10,7 +10,11 @@
 #ifndef META_SHARD_CACHE_H_
 #define META_SHARD_CACHE_H_
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "meta/caching/dblru_cache.h"
@@ -99,6 +103,126 @@ using splay_shard_cache = generic_shard_cache<Key, Value, splay_cache>;
  */
 template <class Key, class Value>
 using dblru_shard_cache = generic_shard_cache<Key, Value, default_dblru_cache>;
+
+/**
+ * A two-level cache: a small, direct-mapped, thread-local L1 in front of
+ * a generic_shard_cache L2. L1 hits touch no lock and no shared (mutable)
+ * state, so threads that repeatedly look up the same hot keys (e.g. the
+ * common query terms in a ranker's postings cache) stop contending on
+ * the shard mutexes entirely once their L1s are warm.
+ *
+ * Coherence is epoch-based: every insert bumps a shared epoch counter,
+ * and an L1 slot is only trusted if it was filled under the current
+ * epoch. A store therefore (conservatively) invalidates every thread's
+ * L1, and the next lookup per slot refills from L2. This favors the
+ * read-mostly-after-warm-up access pattern the caches here see.
+ *
+ * Each thread lazily materializes one L1 per cache instance (a few KiB);
+ * these are keyed by a unique instance id and are only reclaimed when
+ * the thread exits.
+ */
+template <class Key, class Value, template <class, class> class Map>
+class two_level_shard_cache
+{
+  public:
+    /**
+     * Constructs a two-level shard cache with the given number of L2
+     * shards, passing any additional parameters to the underlying Map
+     * classes created.
+     *
+     * @param shards the number of shards to create
+     * @param args the remaining arguments to be used in creating the Map
+     * for each shard
+     */
+    template <class... Args>
+    two_level_shard_cache(uint8_t shards, Args&&... args);
+
+    /**
+     * two_level_shard_cache may be move constructed
+     */
+    two_level_shard_cache(two_level_shard_cache&&) = default;
+
+    /**
+     * two_level_shard_cache may be move assigned
+     */
+    two_level_shard_cache& operator=(two_level_shard_cache&&) = default;
+
+    /**
+     * Default destructor.
+     */
+    ~two_level_shard_cache() = default;
+
+    /**
+     * Inserts a given (key, value) pair into the cache, invalidating
+     * the thread-local L1s by advancing the epoch.
+     * @param key
+     * @param value
+     */
+    void insert(const Key& key, const Value& value);
+
+    /**
+     * Finds a value in the cache, consulting this thread's L1 before
+     * the sharded L2. If it exists, the optional will be engaged,
+     * otherwise, it will be disengaged.
+     *
+     * @param key the key to find the corresponding value for
+     * @return an optional that may contain the value, if found
+     */
+    util::optional<Value> find(const Key& key);
+
+  private:
+    /// The number of direct-mapped slots in each thread-local L1.
+    const static std::size_t l1_slots = 256;
+
+    /**
+     * One direct-mapped L1 slot: the cached (key, value) pair and the
+     * epoch it was filled under.
+     */
+    struct l1_slot
+    {
+        uint64_t epoch = 0;
+        util::optional<std::pair<Key, Value>> entry;
+    };
+
+    using l1_cache = std::vector<l1_slot>;
+
+    /**
+     * @return this thread's L1 for this cache instance, creating it on
+     * first use
+     */
+    l1_cache& local_cache() const;
+
+    /// The sharded L2.
+    generic_shard_cache<Key, Value, Map> shards_;
+
+    /// The epoch counter used to invalidate L1 slots on stores. Held
+    /// through a unique_ptr so the cache stays movable.
+    std::unique_ptr<std::atomic<uint64_t>> epoch_;
+
+    /// The unique id of this cache instance, keying the thread-local L1s.
+    uint64_t id_;
+
+    /**
+     * The hash function used for determining which L1 slot a key
+     * belongs to.
+     */
+    std::hash<Key> hasher_;
+};
+
+/**
+ * A two-level sharding cache that uses splay_caches as the internal map.
+ */
+template <class Key, class Value>
+using two_level_splay_shard_cache
+    = two_level_shard_cache<Key, Value, splay_cache>;
+
+/**
+ * A two-level sharding cache that uses a default_dblru_cache as the
+ * internal map.
+ */
+template <class Key, class Value>
+using two_level_dblru_shard_cache
+    = two_level_shard_cache<Key, Value, default_dblru_cache>;
 }
 }
 
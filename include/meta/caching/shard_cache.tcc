@@ -32,5 +32,59 @@ util::optional<Value> generic_shard_cache<Key, Value, Map>::find(const Key& key)
     auto shard = hasher_(key) % shards_.size();
     return shards_[shard].find(key);
 }
+
+template <class Key, class Value, template <class, class> class Map>
+template <class... Args>
+two_level_shard_cache<Key, Value, Map>::two_level_shard_cache(uint8_t shards,
+                                                              Args&&... args)
+    : shards_{shards, std::forward<Args>(args)...},
+      epoch_{new std::atomic<uint64_t>{0}}
+{
+    static std::atomic<uint64_t> next_id{0};
+    id_ = next_id.fetch_add(1);
+}
+
+template <class Key, class Value, template <class, class> class Map>
+auto two_level_shard_cache<Key, Value, Map>::local_cache() const -> l1_cache&
+{
+    static thread_local std::unordered_map<uint64_t, l1_cache> caches;
+    auto& l1 = caches[id_];
+    if (l1.empty())
+        l1.resize(l1_slots);
+    return l1;
+}
+
+template <class Key, class Value, template <class, class> class Map>
+void two_level_shard_cache<Key, Value, Map>::insert(const Key& key,
+                                                    const Value& value)
+{
+    shards_.insert(key, value);
+    // release pairs with the acquire in find(): an L1 slot filled under
+    // an older epoch can no longer be trusted
+    epoch_->fetch_add(1, std::memory_order_release);
+}
+
+template <class Key, class Value, template <class, class> class Map>
+util::optional<Value>
+two_level_shard_cache<Key, Value, Map>::find(const Key& key)
+{
+    auto& l1 = local_cache();
+    auto& slot = l1[hasher_(key) % l1.size()];
+
+    // the epoch is read *before* the L2 lookup: if a store races with
+    // the refill below, the slot is stamped with the pre-store epoch
+    // and the next lookup will see it as stale
+    auto current = epoch_->load(std::memory_order_acquire);
+    if (slot.entry && slot.epoch == current && slot.entry->first == key)
+        return slot.entry->second;
+
+    auto result = shards_.find(key);
+    if (result)
+    {
+        slot.epoch = current;
+        slot.entry = std::make_pair(key, *result);
+    }
+    return result;
+}
 }
 }
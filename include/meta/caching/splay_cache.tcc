@@ -3,6 +3,7 @@
  */
 
 #include "meta/caching/splay_cache.h"
+#include "meta/util/memory_accounting.h"
 
 namespace meta
 {
@@ -58,6 +59,8 @@ void splay_cache
     {
         subroot = new node{key, value};
         ++size_;
+        memory::component("caching::splay_cache (nodes)")
+            .allocated(sizeof(node));
     }
     else if (key < subroot->key)
     {
@@ -138,6 +141,8 @@ void splay_cache<Key, Value>::clear(node*& subroot)
         clear(subroot->left);
         clear(subroot->right);
         delete subroot;
+        memory::component("caching::splay_cache (nodes)")
+            .released(sizeof(node));
         subroot = nullptr;
     }
 }
@@ -0,0 +1,117 @@
+/**
+ * @file ann_index.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_CLASSIFY_ANN_INDEX_H_
+#define META_CLASSIFY_ANN_INDEX_H_
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/meta.h"
+#include "meta/learn/instance.h"
+
+namespace meta
+{
+namespace classify
+{
+
+/**
+ * An approximate nearest neighbor index over sparse feature vectors,
+ * using an inverted-file (clustering) structure: the vectors are
+ * partitioned with spherical k-means at build time, and a query
+ * exhaustively scores only the members of the nprobe closest clusters
+ * instead of the whole collection. With \f$\sqrt{N}\f$ clusters and a
+ * small nprobe, candidate retrieval is roughly \f$O(\sqrt{N})\f$ per
+ * query at a small recall cost.
+ *
+ * Similarity is cosine: all stored vectors (and queries) are
+ * unit-normalized, so a dot product suffices.
+ */
+class ann_index
+{
+  public:
+    /**
+     * Construction options for the index.
+     */
+    struct options_type
+    {
+        /// Number of clusters; 0 means sqrt(num vectors)
+        uint64_t num_clusters = 0;
+        /// Maximum k-means iterations at build time
+        uint64_t max_iters = 5;
+        /// Number of clusters probed per query
+        uint64_t num_probes = 8;
+
+        options_type()
+        {
+            // nothing; see sgd_model::options_type for why this is
+            // explicitly defined
+        }
+    };
+
+    /**
+     * Builds the index over a collection of (id, vector) pairs.
+     * @param vectors The vectors to index, paired with their ids
+     * @param options The construction options
+     */
+    ann_index(std::vector<std::pair<doc_id, learn::feature_vector>> vectors,
+              options_type options = {});
+
+    /**
+     * Loads an ann_index from a stream.
+     * @param in The stream to read from
+     */
+    ann_index(std::istream& in);
+
+    /**
+     * Saves the index to a stream.
+     * @param out The stream to write to
+     */
+    void save(std::ostream& out) const;
+
+    /**
+     * Finds the (approximate) k nearest neighbors of the query by
+     * probing the closest clusters.
+     *
+     * @param query The query vector
+     * @param k The number of neighbors to return
+     * @return (id, cosine similarity) pairs in descending order of
+     * similarity
+     */
+    std::vector<std::pair<doc_id, double>>
+    query(const learn::feature_vector& query, uint64_t k) const;
+
+    /**
+     * @return the number of indexed vectors
+     */
+    uint64_t size() const;
+
+  private:
+    void build_clusters(uint64_t num_clusters, uint64_t max_iters);
+
+    /// The indexed vectors, unit-normalized
+    std::vector<learn::feature_vector> vectors_;
+
+    /// The id for each indexed vector
+    std::vector<doc_id> ids_;
+
+    /// The unit-normalized cluster centroids
+    std::vector<learn::feature_vector> centroids_;
+
+    /// The member vectors (indices into vectors_) for each cluster
+    std::vector<std::vector<uint64_t>> clusters_;
+
+    /// The number of clusters probed per query
+    uint64_t num_probes_;
+};
+}
+}
+#endif
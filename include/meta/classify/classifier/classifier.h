@@ -9,12 +9,14 @@
 #ifndef META_CLASSIFIER_H_
 #define META_CLASSIFIER_H_
 
+#include <future>
 #include <ostream>
 #include <vector>
 #include "meta/classify/confusion_matrix.h"
 #include "meta/index/forward_index.h"
 #include "meta/learn/dataset.h"
 #include "meta/classify/multiclass_dataset_view.h"
+#include "meta/parallel/thread_pool.h"
 
 namespace meta
 {
@@ -46,6 +48,31 @@ class classifier
      */
     virtual class_label classify(const feature_vector& instance) const = 0;
 
+    /**
+     * Classifies a batch of instances, sharding the batch across the
+     * given thread pool. The default implementation calls classify()
+     * once per instance from the workers; classifiers with a cheaper
+     * batch strategy (per-batch scratch shared across instances, one
+     * pass over several models) override it. classify() must be safe
+     * to invoke concurrently, which holds for every classifier shipped
+     * with MeTA.
+     *
+     * @param docs The instances to classify
+     * @param pool The thread pool to shard the batch across
+     * @return the predicted label for each instance, in batch order
+     */
+    virtual std::vector<class_label>
+    classify_batch(const dataset_view_type& docs,
+                   parallel::thread_pool& pool) const;
+
+    /**
+     * Classifies a batch of instances on a thread pool sized to the
+     * hardware concurrency.
+     * @see classify_batch()
+     */
+    std::vector<class_label>
+    classify_batch(const dataset_view_type& docs) const;
+
     /**
      * Classifies a collection document into specific groups, as determined
      * by training data; this function will make repeated calls to
@@ -117,6 +144,76 @@ confusion_matrix cross_validate(Creator&& creator,
     return matrix;
 }
 
+/**
+ * Performs k-fold cross-validation on a set of documents, training and
+ * testing the folds concurrently on a thread pool. The data is shuffled
+ * and partitioned exactly once; every fold's train and test views share
+ * the underlying dataset storage and materialize only their own index
+ * vectors. Since the folds' classifiers are independent, this overload
+ * is profitable whenever a single classifier does not already saturate
+ * the machine during training. Fold accuracies are recorded in fold
+ * order, matching the serial overload.
+ *
+ * @param creator A function to create classifiers given a
+ * multiclass_dataset_view
+ * @param docs Testing documents
+ * @param k The number of folds
+ * @param pool The thread pool to train the folds on
+ * @param even_split Whether to evenly split the data by class for a fair
+ * baseline
+ * @return a confusion_matrix containing the results over all the folds
+ */
+template <class Creator>
+confusion_matrix cross_validate(Creator&& creator,
+                                classifier::dataset_view_type docs, size_t k,
+                                parallel::thread_pool& pool,
+                                bool even_split = false)
+{
+    using diff_type = decltype(docs.begin())::difference_type;
+
+    if (even_split)
+        docs = docs.create_even_split();
+
+    // docs might be ordered by class, so make sure things are shuffled
+    docs.shuffle();
+
+    auto step_size = docs.size() / k;
+    std::vector<std::future<confusion_matrix>> folds;
+    folds.reserve(k);
+    for (size_t i = 0; i < k; ++i)
+    {
+        // fold i tests on [i * step_size, (i + 1) * step_size) and trains
+        // on everything else; both pieces are views over docs' storage
+        auto test_begin
+            = docs.begin() + static_cast<diff_type>(i * step_size);
+        auto test_end
+            = docs.begin() + static_cast<diff_type>((i + 1) * step_size);
+
+        multiclass_dataset_view test_view{docs, test_begin, test_end};
+        multiclass_dataset_view train_view{docs, test_end, docs.end()};
+        for (auto it = docs.begin(); it != test_begin; ++it)
+            train_view.add_by_index(it.index());
+
+        folds.emplace_back(
+            pool.submit_task([&creator, i, k, train_view, test_view]() {
+                LOG(info) << "Cross-validating fold " << (i + 1) << "/" << k
+                          << ENDLG;
+                auto cls = creator(train_view);
+                return cls->test(test_view);
+            }));
+    }
+
+    confusion_matrix matrix;
+    for (auto& fold : folds)
+    {
+        auto m = fold.get();
+        matrix.add_fold_accuracy(m.accuracy());
+        matrix += m;
+    }
+
+    return matrix;
+}
+
 /**
  * Performs k-fold cross-validation on a set of documents.
  *
@@ -130,6 +227,23 @@ confusion_matrix cross_validate(Creator&& creator,
 confusion_matrix cross_validate(const cpptoml::table& config,
                                 classifier::dataset_view_type docs, size_t k,
                                 bool even_split = false);
+
+/**
+ * Performs k-fold cross-validation on a set of documents, training and
+ * testing the folds concurrently on a thread pool.
+ *
+ * @param config The configuration to use to create the classifier
+ * @param docs Testing documents
+ * @param k The number of folds
+ * @param pool The thread pool to train the folds on
+ * @param even_split Whether to evenly split the data by class for a fair
+ * baseline
+ * @return a confusion_matrix containing the results over all the folds
+ */
+confusion_matrix cross_validate(const cpptoml::table& config,
+                                classifier::dataset_view_type docs, size_t k,
+                                parallel::thread_pool& pool,
+                                bool even_split = false);
 }
 }
 #endif
@@ -11,6 +11,7 @@
 
 #include "meta/classify/classifier_factory.h"
 #include "meta/classify/classifier/classifier.h"
+#include "meta/classify/kernel/dense_evaluator.h"
 #include "meta/classify/kernel/polynomial.h"
 #include "meta/meta.h"
 
@@ -153,6 +154,13 @@ class dual_perceptron : public classifier
      */
     std::unique_ptr<kernel::kernel> kernel_;
 
+    /**
+     * Fast kernel evaluation against the support vectors: the query is
+     * densified once per classification and the support-vector norms
+     * are cached. Mutable because it holds per-query scratch space.
+     */
+    mutable kernel::dense_evaluator evaluator_;
+
     /**
      * \f$\alpha\f$, the learning rate
      */
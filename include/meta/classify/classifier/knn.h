@@ -13,8 +13,10 @@
 #include "meta/index/inverted_index.h"
 #include "meta/index/forward_index.h"
 #include "meta/index/ranker/ranker.h"
+#include "meta/classify/ann_index.h"
 #include "meta/classify/classifier_factory.h"
 #include "meta/classify/classifier/classifier.h"
+#include "meta/util/optional.h"
 
 namespace meta
 {
@@ -38,7 +40,16 @@ namespace classify
  * ~~~toml
  * [classifier]
  * weighted = true # default is false
+ * ann = true # default is false; use approximate nearest neighbors
+ * ann-clusters = 0 # 0 means sqrt(num training docs)
+ * ann-max-iters = 5
+ * ann-nprobe = 8
  * ~~~
+ *
+ * When `ann = true`, the training vectors are placed in an ann_index and
+ * neighbors are retrieved by probing the closest clusters rather than
+ * scoring every legal document with the ranker, trading a small recall
+ * loss for sublinear candidate retrieval.
  */
 class knn : public classifier
 {
@@ -54,10 +65,13 @@ class knn : public classifier
      * @param k The value of k in k-NN
      * @param ranker The ranker to be used internally
      * @param weighted Whether to weight the neighbors by distance to the query
+     * @param ann_options If set, build an ann_index over the training
+     * vectors and use it for (approximate) neighbor retrieval
      */
     knn(multiclass_dataset_view docs,
         std::shared_ptr<index::inverted_index> idx, uint16_t k,
-        std::unique_ptr<index::ranker> ranker, bool weighted = false);
+        std::unique_ptr<index::ranker> ranker, bool weighted = false,
+        util::optional<ann_index::options_type> ann_options = util::nullopt);
 
     /**
      * Loads a knn classifier from a stream.
@@ -85,6 +99,13 @@ class knn : public classifier
         const std::vector<index::search_result>& scored,
         const std::vector<std::pair<class_label, uint16_t>>& sorted) const;
 
+    /**
+     * Tallies the votes of the scored neighbors.
+     * @param scored The scored neighbors, in descending order of score
+     * @return the winning label
+     */
+    class_label vote(const std::vector<index::search_result>& scored) const;
+
     /** the inverted index used for ranking */
     std::shared_ptr<index::inverted_index> inv_idx_;
 
@@ -101,6 +122,9 @@ class knn : public classifier
 
     /** Whether we want the neighbors to be weighted by distance or not */
     const bool weighted_;
+
+    /** optional approximate nearest neighbor index over the training set */
+    util::optional<ann_index> ann_;
 };
 
 /**
@@ -70,6 +70,19 @@ class naive_bayes : public classifier
      */
     class_label classify(const feature_vector& instance) const override;
 
+    /**
+     * Classifies a batch of instances, hoisting the per-class setup
+     * (log priors, distribution lookups) out of the per-instance loop
+     * and sharding the instances across the pool.
+     *
+     * @param docs The instances to classify
+     * @param pool The thread pool to shard the batch across
+     * @return the predicted label for each instance, in batch order
+     */
+    std::vector<class_label>
+    classify_batch(const dataset_view_type& docs,
+                   parallel::thread_pool& pool) const override;
+
     /**
      * Saves the model to a stream.
      * @param os The stream to save to
@@ -13,6 +13,7 @@
 #include "meta/index/forward_index.h"
 #include "meta/classify/classifier_factory.h"
 #include "meta/classify/classifier/classifier.h"
+#include "meta/math/dense_similarity.h"
 
 namespace meta
 {
@@ -62,14 +63,11 @@ class nearest_centroid : public classifier
 
   private:
     /**
-     * @param d_id
-     * @param centroid
-     * @return the cosine similarity between the query and a centroid
+     * Packs the sparse centroids into the dense scoring kernel (one
+     * aligned row per class, with precomputed norms) after training or
+     * loading.
      */
-    template <class ForwardIterator>
-    double
-        cosine_sim(ForwardIterator begin, ForwardIterator end,
-                   const std::unordered_map<term_id, double>& centroid) const;
+    void pack_centroids();
 
     /// Inverted index used for ranking
     std::shared_ptr<index::inverted_index> inv_idx_;
@@ -77,6 +75,12 @@ class nearest_centroid : public classifier
     /// The document centroids for this learner
     std::unordered_map<class_label, std::unordered_map<term_id, double>>
         centroids_;
+
+    /// The centroids packed for one-against-many cosine scoring
+    math::dense::dense_scorer scorer_;
+
+    /// The class label for each of the scorer's rows
+    std::vector<class_label> row_labels_;
 };
 
 /**
@@ -47,6 +47,19 @@ class one_vs_all : public online_classifier
      */
     one_vs_all(multiclass_dataset_view docs, const cpptoml::table& base);
 
+    /**
+     * Constructs a new one_vs_all classifier, retaining the base
+     * classifier configuration so that incremental training (train())
+     * can create classifiers for labels that appear only in later data
+     * deltas. Prefer this overload when the model will be refreshed
+     * with train_incremental().
+     *
+     * @param docs The training data
+     * @param base The configuration for the individual binary_classifiers
+     */
+    one_vs_all(multiclass_dataset_view docs,
+               std::shared_ptr<const cpptoml::table> base);
+
     /**
      * Loads a one_vs_all classifier from a stream.
      * @param in The stream to read from
@@ -57,6 +70,19 @@ class one_vs_all : public online_classifier
 
     class_label classify(const feature_vector& doc) const override;
 
+    /**
+     * Classifies a batch of instances: the binary models are gathered
+     * into a flat list once per batch, then each worker evaluates every
+     * model against its instances in one pass over the features.
+     *
+     * @param docs The instances to classify
+     * @param pool The thread pool to shard the batch across
+     * @return the predicted label for each instance, in batch order
+     */
+    std::vector<class_label>
+    classify_batch(const dataset_view_type& docs,
+                   parallel::thread_pool& pool) const override;
+
     void train(dataset_view_type docs) override;
 
     void train_one(const feature_vector& doc,
@@ -68,11 +94,22 @@ class one_vs_all : public online_classifier
     const static util::string_view id;
 
   private:
+    /**
+     * Trains a fresh binary classifier for every label in the dataset.
+     */
+    void init(multiclass_dataset_view& docs, const cpptoml::table& base);
+
     /**
      * The set of classifiers this ensemble uses for classification.
      */
     std::unordered_map<class_label, std::unique_ptr<binary_classifier>>
         classifiers_;
+
+    /**
+     * The base classifier configuration, retained (when available) so
+     * that incremental training can add classifiers for new labels.
+     */
+    std::shared_ptr<const cpptoml::table> base_config_;
 };
 
 /**
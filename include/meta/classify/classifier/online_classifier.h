@@ -41,6 +41,22 @@ class online_classifier : public classifier
      */
     virtual void train_one(const feature_vector& doc, const class_label& label)
         = 0;
+
+    /**
+     * Warm-starts training from the current model state on new data.
+     * This is the entry point for incremental model refreshes: train()
+     * never resets weights or optimizer state (classifiers like sgd
+     * serialize their full optimizer state, so a loaded model continues
+     * exactly where it left off), and this named alias documents that
+     * contract for callers updating a model on a data delta rather than
+     * retraining from scratch.
+     *
+     * @param docs The new documents to fold into the model
+     */
+    void train_incremental(dataset_view_type docs)
+    {
+        train(std::move(docs));
+    }
 };
 }
 }
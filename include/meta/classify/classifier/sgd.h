@@ -14,6 +14,7 @@
 #include "meta/classify/classifier/online_binary_classifier.h"
 #include "meta/learn/loss/loss_function.h"
 #include "meta/learn/sgd.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/util/disk_vector.h"
 #include "meta/meta.h"
 
@@ -78,6 +79,23 @@ class sgd : public online_binary_classifier
 
     void train(binary_dataset_view docs) override;
 
+    /**
+     * Trains the model over the dataset using Hogwild-style lock-free
+     * parallel stochastic gradient descent: the pool's threads each
+     * process a shard of the (shuffled) data per epoch, updating the
+     * shared weight vector concurrently without synchronization. For
+     * sparse data, concurrent updates rarely touch the same weights and
+     * the occasional lost update does not affect convergence; dense
+     * data should prefer the sequential train() overload. Convergence
+     * is checked once per epoch against the average epoch loss.
+     *
+     * @see https://arxiv.org/abs/1106.5730
+     *
+     * @param docs The training documents
+     * @param pool The thread pool to shard each epoch across
+     */
+    void train(binary_dataset_view docs, parallel::thread_pool& pool);
+
     void train_one(const feature_vector& doc, bool label) override;
 
     /**
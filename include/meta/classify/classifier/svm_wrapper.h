@@ -9,6 +9,7 @@
 #ifndef META_SVM_WRAPPER_H_
 #define META_SVM_WRAPPER_H_
 
+#include <memory>
 #include <unordered_map>
 
 #include "meta/classify/classifier_factory.h"
@@ -22,13 +23,22 @@ namespace meta
 namespace classify
 {
 
+namespace detail
+{
+class svm_bridge;
+}
+
 /**
  * Wrapper class for liblinear (http://www.csie.ntu.edu.tw/~cjlin/liblinear/)
  * and libsvm (http://www.csie.ntu.edu.tw/~cjlin/libsvm/)
  * implementation of support vector machine classification.
  *
  * To use this class, make sure that you have checked out the libsvm-modules
- * submodule and have compiled both libsvm and liblinear.
+ * submodule. When the submodule sources are present at configure time the
+ * solvers are linked directly into the toolkit and training/prediction run
+ * in-process, converting the dataset to problem structs in memory; the
+ * prebuilt train/predict binaries (and their temporary-file round trips)
+ * are only used as a fallback.
  *
  * If no kernel is selected, liblinear is used. Otherwise, libsvm is used.
  *
@@ -120,6 +130,10 @@ class svm_wrapper : public classifier
 
     /** the list of class_labels (mainly for serializing the model) */
     std::vector<class_label> labels_;
+
+    /** the in-process model, when built with the bundled solver sources
+     * (null when falling back to the prebuilt binaries) */
+    std::shared_ptr<detail::svm_bridge> bridge_;
 };
 
 /**
@@ -0,0 +1,134 @@
+/**
+ * @file concurrent_confusion_matrix.h
+ * @author Sean Massung
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_CONCURRENT_CONFUSION_MATRIX_H_
+#define META_CONCURRENT_CONFUSION_MATRIX_H_
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "meta/classify/confusion_matrix.h"
+#include "meta/config.h"
+#include "meta/meta.h"
+
+namespace meta
+{
+namespace classify
+{
+
+/**
+ * A confusion matrix whose counts may be accumulated concurrently from
+ * many threads. The label set is interned up front (it is known before
+ * evaluation begins), so the counts live in a dense label-indexed matrix
+ * of atomics and add() is a single relaxed fetch-add with no locking and
+ * no map insertions. Precision, recall, and F1 are computed in one
+ * streaming pass over the dense counts rather than by repeated hash
+ * lookups, so evaluating very large test sets is no longer the serial
+ * tail of parallel cross-validation.
+ *
+ * Use matrix() to obtain an ordinary confusion_matrix for printing,
+ * merging across folds, or significance testing.
+ */
+class concurrent_confusion_matrix
+{
+  public:
+    /**
+     * @param labels The complete set of class labels that may appear as
+     * either a prediction or a ground truth during evaluation
+     */
+    concurrent_confusion_matrix(std::vector<class_label> labels);
+
+    /**
+     * Records a prediction; safe to call concurrently.
+     * @param predicted The predicted class label
+     * @param actual The actual class label
+     * @param times The number of times this prediction was made
+     */
+    void add(const predicted_label& predicted, const class_label& actual,
+             size_t times = 1)
+    {
+        auto row = ids_.at(class_label{predicted});
+        auto col = ids_.at(actual);
+        counts_[row * labels_.size() + col].fetch_add(
+            times, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return the accuracy over all recorded predictions
+     */
+    double accuracy() const;
+
+    /**
+     * @return the overall F1 score
+     */
+    double f1_score() const;
+
+    /**
+     * @param lbl
+     * @return the F1 score for the lbl class
+     */
+    double f1_score(const class_label& lbl) const;
+
+    /**
+     * @return the overall precision
+     */
+    double precision() const;
+
+    /**
+     * @return the precision for the lbl class
+     */
+    double precision(const class_label& lbl) const;
+
+    /**
+     * @return the overall recall
+     */
+    double recall() const;
+
+    /**
+     * @return the recall for the lbl class
+     */
+    double recall(const class_label& lbl) const;
+
+    /**
+     * @return an equivalent confusion_matrix for printing, fold merging,
+     * or significance testing
+     */
+    confusion_matrix matrix() const;
+
+  private:
+    /**
+     * Per-class precision, recall, and F1 computed in one pass over the
+     * dense counts.
+     */
+    struct class_metrics
+    {
+        double precision;
+        double recall;
+        double f1;
+    };
+
+    /**
+     * @param idx The interned index of the class to compute metrics for
+     */
+    class_metrics metrics_for(size_t idx) const;
+
+    /// The interned label set, in sorted order
+    std::vector<class_label> labels_;
+
+    /// Maps a label to its row/column in the dense matrix
+    std::unordered_map<class_label, size_t> ids_;
+
+    /// Dense counts, indexed by [predicted * labels_.size() + actual]
+    std::unique_ptr<std::atomic<size_t>[]> counts_;
+};
+}
+}
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file dense_evaluator.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_CLASSIFY_KERNEL_DENSE_EVALUATOR_H_
+#define META_CLASSIFY_KERNEL_DENSE_EVALUATOR_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "meta/classify/kernel/kernel.h"
+#include "meta/config.h"
+#include "meta/util/aligned_allocator.h"
+
+namespace meta
+{
+namespace classify
+{
+namespace kernel
+{
+
+/**
+ * Accelerates repeated kernel evaluations of one query vector against a
+ * (growing) set of registered sparse vectors, as in dual_perceptron
+ * classification where every prediction evaluates the kernel against
+ * every support vector.
+ *
+ * The query is densified once per set_query() into a cache-aligned
+ * array, so each subsequent dot product is a single linear scan over the
+ * support vector's contiguous (feature, value) pairs indexing into the
+ * dense buffer instead of a two-way sparse merge. Squared norms of the
+ * registered vectors are cached at registration time so that
+ * distance-based kernels (rbf) also reduce to the one dot product via
+ * kernel::from_linear().
+ */
+class dense_evaluator
+{
+  public:
+    /**
+     * Registers a copy of a vector with the evaluator, caching its
+     * squared norm.
+     *
+     * @param id The id the vector will be evaluated under
+     * @param vec The vector to register
+     */
+    void add(learn::instance_id id, feature_vector vec);
+
+    /**
+     * @param id The id to look up
+     * @return whether a vector is registered under this id
+     */
+    bool contains(learn::instance_id id) const;
+
+    /**
+     * Densifies a query vector into the internal buffer. Subsequent
+     * eval() calls compute kernel values against this query.
+     *
+     * @param query The query vector
+     */
+    void set_query(const feature_vector& query);
+
+    /**
+     * Computes the kernel value between the current query and the
+     * vector registered under the given id.
+     *
+     * @param kern The kernel to evaluate
+     * @param id The id of the registered vector
+     * @return \f$K(query, vec_{id})\f$
+     */
+    double eval(const kernel& kern, learn::instance_id id) const;
+
+  private:
+    /// A registered vector and its cached squared norm
+    struct entry
+    {
+        feature_vector vec;
+        double norm_sq;
+    };
+
+    /// The registered vectors by id
+    std::unordered_map<learn::instance_id, entry> vectors_;
+
+    /// The current query, densified; sized to cover every feature id
+    /// seen so far so lookups never bounds-check
+    util::aligned_vector<double> query_;
+
+    /// The nonzero positions of the current query, for sparse clearing
+    std::vector<learn::feature_id> nonzero_;
+
+    /// The squared norm of the current query
+    double query_norm_sq_ = 0;
+};
+}
+}
+}
+#endif
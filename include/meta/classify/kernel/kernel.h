@@ -38,6 +38,22 @@ class kernel
     virtual double operator()(const feature_vector& first,
                               const feature_vector& second) const = 0;
 
+    /**
+     * Computes the kernel value from a precomputed dot product and the
+     * squared norms of the two vectors. Every kernel in the hierarchy is
+     * a function of these three quantities, which lets callers like
+     * kernel::dense_evaluator compute the dot product with a fast
+     * sparse-dense kernel and cache the norms instead of re-merging two
+     * sparse vectors per evaluation.
+     *
+     * @param dot \f$x^T z\f$
+     * @param first_norm_sq \f$\|x\|^2\f$
+     * @param second_norm_sq \f$\|z\|^2\f$
+     * @return the value of \f$K(x, z)\f$
+     */
+    virtual double from_linear(double dot, double first_norm_sq,
+                               double second_norm_sq) const = 0;
+
     /**
      * Saves the kernel to a stream. This should first save the kernel's
      * id, followed by any parameters needed for reconstruction.
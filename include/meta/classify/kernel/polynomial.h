@@ -54,6 +54,9 @@ class polynomial : public kernel
     double operator()(const feature_vector& first,
                       const feature_vector& second) const override;
 
+    double from_linear(double dot, double first_norm_sq,
+                       double second_norm_sq) const override;
+
     void save(std::ostream& out) const override;
 
   private:
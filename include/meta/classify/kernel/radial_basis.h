@@ -45,6 +45,9 @@ class radial_basis : public kernel
     double operator()(const feature_vector& first,
                       const feature_vector& second) const override;
 
+    double from_linear(double dot, double first_norm_sq,
+                       double second_norm_sq) const override;
+
     void save(std::ostream& out) const override;
 
     static const util::string_view id;
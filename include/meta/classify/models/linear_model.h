@@ -12,6 +12,7 @@
 #include <istream>
 #include <ostream>
 #include <unordered_map>
+#include <vector>
 
 #include "meta/meta.h"
 #include "meta/util/sparse_vector.h"
@@ -56,9 +57,11 @@ class linear_model
 
     /**
      * A single weight vector for a specific feature id. This stores the
-     * weights that a given feature has for each class.
+     * weights that a given feature has for each class. Most features are
+     * active for only a handful of classes, so the first few weights are
+     * stored in situ to avoid a heap allocation per feature.
      */
-    using weight_vector = util::sparse_vector<class_id, feature_value>;
+    using weight_vector = util::small_sparse_vector<class_id, feature_value>;
 
     /**
      * A collection of weight_vector by feature id.
@@ -173,6 +176,25 @@ class linear_model
      */
     void condense(bool log = false);
 
+    /**
+     * Compacts the model into an immutable deployment form: the
+     * per-feature weight vectors are condensed and copied into a single
+     * contiguous CSR-like layout (feature-major rows of (class, weight)
+     * entries), and the hash map of sparse vectors is discarded. Scoring
+     * a frozen model walks one contiguous array instead of chasing a
+     * separately allocated vector per feature, and saving/loading it
+     * streams the arrays in bulk.
+     *
+     * A frozen model cannot be updated; calling update() or condense()
+     * on it throws linear_model_exception.
+     */
+    void freeze();
+
+    /**
+     * @return whether this model has been frozen via freeze()
+     */
+    bool frozen() const;
+
     /**
      * @return the weights
      */
@@ -180,9 +202,37 @@ class linear_model
 
   private:
     /**
-     * The weights for the model
+     * Accumulates per-class scores for a feature vector against either
+     * the mutable or the frozen storage.
+     */
+    template <class FeatureVector>
+    weight_vector score(FeatureVector&& features) const;
+
+    /**
+     * The weights for the model (empty once frozen)
      */
     weight_vectors weights_;
+
+    /**
+     * Whether the model has been compacted with freeze().
+     */
+    bool frozen_ = false;
+
+    /**
+     * Maps a feature id to its row index in the frozen layout.
+     */
+    std::unordered_map<feature_id, uint64_t> rows_;
+
+    /**
+     * Row boundaries into entries_; row \f$r\f$ spans
+     * [offsets_[r], offsets_[r + 1]).
+     */
+    std::vector<uint64_t> offsets_;
+
+    /**
+     * All nonzero (class, weight) entries, feature-major and contiguous.
+     */
+    std::vector<scored_class> entries_;
 };
 }
 }
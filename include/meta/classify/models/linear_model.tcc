@@ -25,6 +25,12 @@ void linear_model<FeatureId, FeatureValue, ClassId>::load(std::istream& model)
     if (!model)
         throw exception{"model not found"};
 
+    weights_.clear();
+    frozen_ = false;
+    rows_.clear();
+    offsets_.clear();
+    entries_.clear();
+
     uint64_t num_feats;
     io::packed::read(model, num_feats);
 
@@ -59,6 +65,26 @@ template <class FeatureId, class FeatureValue, class ClassId>
 void linear_model<FeatureId, FeatureValue, ClassId>::save(
     std::ostream& model) const
 {
+    if (frozen_)
+    {
+        // same on-disk format as below, emitted from the compact layout
+        uint64_t sze = rows_.size();
+        io::packed::write(model, sze);
+        for (const auto& row : rows_)
+        {
+            io::packed::write(model, row.first);
+            auto begin = offsets_[row.second];
+            auto end = offsets_[row.second + 1];
+            io::packed::write(model, end - begin);
+            for (auto i = begin; i < end; ++i)
+            {
+                io::packed::write(model, entries_[i].first);
+                io::packed::write(model, entries_[i].second);
+            }
+        }
+        return;
+    }
+
     uint64_t sze = weights_.size();
     io::packed::write(model, sze);
     for (const auto& feat_vec : weights_)
@@ -79,28 +105,81 @@ void linear_model<FeatureId, FeatureValue, ClassId>::save(
 }
 
 template <class FeatureId, class FeatureValue, class ClassId>
-template <class FeatureVector, class Filter>
-auto linear_model<FeatureId, FeatureValue, ClassId>::best_class(
-    FeatureVector&& features, Filter&& filter) const -> class_id
+void linear_model<FeatureId, FeatureValue, ClassId>::freeze()
+{
+    if (frozen_)
+        return;
+
+    condense();
+
+    uint64_t nnz = 0;
+    for (const auto& feat_vec : weights_)
+        nnz += feat_vec.second.size();
+
+    rows_.reserve(weights_.size());
+    offsets_.reserve(weights_.size() + 1);
+    entries_.reserve(nnz);
+
+    offsets_.push_back(0);
+    for (const auto& feat_vec : weights_)
+    {
+        rows_[feat_vec.first] = offsets_.size() - 1;
+        for (const auto& weight : feat_vec.second)
+            entries_.emplace_back(weight.first, weight.second);
+        offsets_.push_back(entries_.size());
+    }
+
+    weights_.clear();
+    frozen_ = true;
+}
+
+template <class FeatureId, class FeatureValue, class ClassId>
+bool linear_model<FeatureId, FeatureValue, ClassId>::frozen() const
+{
+    return frozen_;
+}
+
+template <class FeatureId, class FeatureValue, class ClassId>
+template <class FeatureVector>
+auto linear_model<FeatureId, FeatureValue, ClassId>::score(
+    FeatureVector&& features) const -> weight_vector
 {
     weight_vector class_scores;
-    for (const auto& feat : features)
+    if (frozen_)
     {
-        const auto& name = feat.first;
-        auto val = feat.second;
+        for (const auto& feat : features)
+        {
+            auto it = rows_.find(feat.first);
+            if (it == rows_.end())
+                continue;
+
+            auto end = offsets_[it->second + 1];
+            for (auto i = offsets_[it->second]; i < end; ++i)
+                class_scores[entries_[i].first]
+                    += feat.second * entries_[i].second;
+        }
+        return class_scores;
+    }
 
-        auto it = weights_.find(name);
+    for (const auto& feat : features)
+    {
+        auto it = weights_.find(feat.first);
         if (it == weights_.end())
             continue;
 
         for (const auto& class_weight : it->second)
-        {
-            auto tid = class_weight.first;
-            auto trans_w = class_weight.second;
-
-            class_scores[tid] += val * trans_w;
-        }
+            class_scores[class_weight.first]
+                += feat.second * class_weight.second;
     }
+    return class_scores;
+}
+
+template <class FeatureId, class FeatureValue, class ClassId>
+template <class FeatureVector, class Filter>
+auto linear_model<FeatureId, FeatureValue, ClassId>::best_class(
+    FeatureVector&& features, Filter&& filter) const -> class_id
+{
+    auto class_scores = score(std::forward<FeatureVector>(features));
 
     auto best_score = std::numeric_limits<feature_value>::lowest();
     class_id best_class{};
@@ -132,24 +211,7 @@ auto linear_model<FeatureId, FeatureValue, ClassId>::best_classes(
     FeatureVector&& features, uint64_t num, Filter&& filter) const
     -> scored_classes
 {
-    weight_vector class_scores;
-    for (const auto& feat : features)
-    {
-        const auto& name = feat.first;
-        auto val = feat.second;
-
-        auto it = weights_.find(name);
-        if (it == weights_.end())
-            continue;
-
-        for (const auto& class_weight : it->second)
-        {
-            auto tid = class_weight.first;
-            auto trans_w = class_weight.second;
-
-            class_scores[tid] += val * trans_w;
-        }
-    }
+    auto class_scores = score(std::forward<FeatureVector>(features));
 
     auto heap = util::make_fixed_heap<scored_class>(
         num, [](const scored_class& lhs, const scored_class& rhs) {
@@ -178,13 +240,16 @@ template <class FeatureId, class FeatureValue, class ClassId>
 void linear_model<FeatureId, FeatureValue, ClassId>::update(
     const weight_vectors& updates, feature_value scale)
 {
+    if (frozen_)
+        throw exception{"cannot update a frozen linear_model"};
+
     for (const auto& feat_vec : updates)
     {
         const auto& feat = feat_vec.first;
         auto& wv = weights_[feat];
 
-        for (const auto& up : feat_vec.second)
-            wv[up.first] += up.second * scale;
+        wv.merge_sorted(feat_vec.second.begin(), feat_vec.second.end(),
+                        [&](feature_value val) { return val * scale; });
     }
 }
 
@@ -192,12 +257,18 @@ template <class FeatureId, class FeatureValue, class ClassId>
 void linear_model<FeatureId, FeatureValue, ClassId>::update(
     const class_id& cid, const feature_id& fid, feature_value delta)
 {
+    if (frozen_)
+        throw exception{"cannot update a frozen linear_model"};
+
     weights_[fid][cid] += delta;
 }
 
 template <class FeatureId, class FeatureValue, class ClassId>
 void linear_model<FeatureId, FeatureValue, ClassId>::condense(bool log)
 {
+    if (frozen_)
+        throw exception{"cannot condense a frozen linear_model"};
+
     // build feature set
     std::vector<feature_id> features;
     features.reserve(weights_.size());
@@ -119,6 +119,11 @@ class multiclass_dataset_view : public learn::dataset_view
         return dset<multiclass_dataset>().label(instance);
     }
 
+    label_id label_id_for(const class_label& lbl) const
+    {
+        return dset<multiclass_dataset>().label_id_for(lbl);
+    }
+
     multiclass_dataset::class_label_iterator labels_begin() const
     {
         return dset<multiclass_dataset>().labels_begin();
@@ -1,5 +1,8 @@
 #include "meta/corpus/corpus.h"
 #include "meta/corpus/file_corpus.h"
+#include "meta/corpus/frame_corpus.h"
 #include "meta/corpus/gz_corpus.h"
 #include "meta/corpus/libsvm_corpus.h"
 #include "meta/corpus/line_corpus.h"
+#include "meta/corpus/prefetch_corpus.h"
+#include "meta/corpus/shard_corpus.h"
@@ -172,7 +172,10 @@ void parallel_consume(corpus& docs, parallel::thread_pool& pool,
         futures.emplace_back(pool.submit_task(task));
     }
     for (auto& fut : futures)
+    {
+        pool.wait(fut);
         fut.get();
+    }
 }
 }
 }
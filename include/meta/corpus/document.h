@@ -10,6 +10,7 @@
 #ifndef META_DOCUMENT_H_
 #define META_DOCUMENT_H_
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -55,6 +56,16 @@ class document
     void content(const std::string& content,
                  const std::string& encoding = "utf-8");
 
+    /**
+     * Sets the content of the document to be the parameter, taking
+     * ownership of the string. Line-oriented corpora use this to hand
+     * their read buffer to the document without a per-document copy.
+     * @param content The string content to move into this document
+     * @param encoding the encoding of content, which defaults to utf-8
+     */
+    void content(std::string&& content,
+                 const std::string& encoding = "utf-8");
+
     /**
      * Sets the encoding for the document to be the parameter
      * @param encoding The string label for the encoding
@@ -77,7 +88,22 @@ class document
     doc_id id() const;
 
     /**
-     * @return whether this document contains its content internally
+     * Sets a provider closure that materializes the document's content
+     * on first access instead of storing it up front. Corpora whose
+     * documents live in separate files use this so pipelines that never
+     * touch the text (or read it on a different thread) skip the
+     * up-front read and copy entirely.
+     *
+     * @param provider The closure producing this document's content
+     * @param encoding the encoding of the content, which defaults to
+     * utf-8
+     */
+    void content_provider(std::function<std::string()> provider,
+                          const std::string& encoding = "utf-8");
+
+    /**
+     * @return whether this document holds content, either materialized
+     * or obtainable from a content provider
      */
     bool contains_content() const;
 
@@ -108,8 +134,11 @@ class document
     /// Other metadata fields for this document
     std::vector<metadata::field> mdata_;
 
-    /// What the document contains
-    util::optional<std::string> content_;
+    /// What the document contains (mutable for lazy materialization)
+    mutable util::optional<std::string> content_;
+
+    /// Produces the content on demand; cleared once materialized
+    mutable std::function<std::string()> content_provider_;
 
     /// The encoding for the content
     std::string encoding_;
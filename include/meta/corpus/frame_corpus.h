@@ -0,0 +1,150 @@
+/**
+ * @file frame_corpus.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_CORPUS_FRAME_CORPUS_H_
+#define META_CORPUS_FRAME_CORPUS_H_
+
+#include <fstream>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/corpus/corpus.h"
+#include "meta/corpus/corpus_factory.h"
+
+namespace meta
+{
+namespace corpus
+{
+
+/**
+ * Reads documents from a framed corpus container: a sequence of
+ * independently Zstandard-compressed blocks of documents plus a block
+ * offset index. Labels and metadata are stored inline with each
+ * document, so a container is a single pair of files
+ * (`<dataset>.frames` and `<dataset>.frames.index`).
+ *
+ * Unlike gz_corpus, the container supports O(1) random document fetch
+ * (seek to the enclosing block, decompress only it) in addition to
+ * sequential streaming, so selective re-analysis no longer has to
+ * decompress the whole corpus. Containers are created from any existing
+ * corpus with build() (see the frame-corpus-gen tool).
+ */
+class frame_corpus : public corpus
+{
+  public:
+    /// The identifier for this corpus
+    const static util::string_view id;
+
+    /**
+     * @param file The path to the container, without the ".frames"
+     * suffix
+     * @param encoding The encoding for the documents
+     */
+    frame_corpus(const std::string& file, std::string encoding = "utf-8");
+
+    bool has_next() const override;
+
+    document next() override;
+
+    uint64_t size() const override;
+
+    metadata::schema_type schema() const override;
+
+    /**
+     * Fetches a single document by id, decompressing only the block
+     * that contains it.
+     *
+     * @param d_id The id of the document to fetch
+     * @return the document
+     */
+    document fetch(doc_id d_id);
+
+    /**
+     * Writes a framed container holding every document of the given
+     * corpus, consuming it in the process. Labels and metadata are
+     * stored inline, so the container is self-contained.
+     *
+     * @param docs The corpus to convert
+     * @param file The path for the container, without the ".frames"
+     * suffix
+     * @param docs_per_block The number of documents compressed into each
+     * block; smaller blocks make random access cheaper, larger blocks
+     * compress better
+     */
+    static void build(corpus& docs, const std::string& file,
+                      uint64_t docs_per_block = 512);
+
+  private:
+    /// Locates one compressed block within the frames file
+    struct block_info
+    {
+        /// the byte offset of the block in the frames file
+        uint64_t offset;
+        /// the compressed size of the block
+        uint64_t compressed_size;
+        /// the uncompressed size of the block
+        uint64_t uncompressed_size;
+    };
+
+    /**
+     * Decompresses the given block (if not already loaded) and resets
+     * the decode cursor to its first document.
+     */
+    void load_block(uint64_t block);
+
+    /**
+     * Positions the decode cursor on the given document and decodes it.
+     */
+    document decode(doc_id d_id);
+
+    /// The path to the container, without the ".frames" suffix
+    std::string file_;
+
+    /// The next document for sequential reading
+    doc_id cur_id_;
+
+    /// The total number of documents in the container
+    uint64_t num_docs_;
+
+    /// The number of documents per block
+    uint64_t docs_per_block_;
+
+    /// The metadata schema stored in the container
+    metadata::schema_type schema_;
+
+    /// The block offset index
+    std::vector<block_info> blocks_;
+
+    /// The stream over the compressed blocks
+    std::ifstream frames_;
+
+    /// The currently loaded block, or blocks_.size() if none
+    uint64_t cur_block_;
+
+    /// The uncompressed payload of the current block
+    std::string payload_;
+
+    /// The decode cursor within payload_
+    const char* pos_;
+
+    /// The (global) index of the document at the decode cursor
+    uint64_t pos_doc_;
+};
+
+/**
+ * Specialization of the factory method used to create frame_corpus
+ * instances.
+ */
+template <>
+std::unique_ptr<corpus> make_corpus<frame_corpus>(util::string_view prefix,
+                                                  util::string_view dataset,
+                                                  const cpptoml::table& config);
+}
+}
+#endif
@@ -10,10 +10,12 @@
 #ifndef META_GZ_CORPUS_H_
 #define META_GZ_CORPUS_H_
 
+#include <istream>
+#include <memory>
+
 #include "meta/config.h"
 #include "meta/corpus/corpus.h"
 #include "meta/corpus/corpus_factory.h"
-#include "meta/io/gzstream.h"
 
 namespace meta
 {
@@ -21,8 +23,10 @@ namespace corpus
 {
 
 /**
- * Fills document objects with content line-by-line from gzip-compressed
- * input files.
+ * Fills document objects with content line-by-line from compressed input
+ * files. Zstandard-compressed files (".zst") are preferred when the
+ * toolkit is built with zstd support; otherwise (or when absent) the
+ * gzip-compressed file (".gz") is read.
  */
 class gz_corpus : public corpus
 {
@@ -61,10 +65,10 @@ class gz_corpus : public corpus
     uint64_t num_lines_;
 
     /// The stream for reading the corpus
-    io::gzifstream corpus_stream_;
+    std::unique_ptr<std::istream> corpus_stream_;
 
     /// The stream to read the class labels
-    io::gzifstream class_stream_;
+    std::unique_ptr<std::istream> class_stream_;
 };
 
 /**
@@ -11,6 +11,7 @@
 #define META_CORPUS_LIBSVM_CORPUS_H_
 
 #include <fstream>
+#include <vector>
 
 #include "meta/config.h"
 #include "meta/corpus/corpus.h"
@@ -51,6 +52,22 @@ class libsvm_corpus : public corpus
                   label_type type = label_type::CLASSIFICATION,
                   uint64_t num_docs = 0);
 
+    /**
+     * Reads a corpus split across several libsvm-formatted files, in the
+     * order given. Large training dumps are often written as shards; this
+     * avoids having to concatenate them before indexing.
+     *
+     * @param files The paths to the corpus files, in document order
+     * @param type The label type for the data (classification or
+     * regression)
+     * @param num_docs The total number of documents (i.e., lines) across
+     * all files if known beforehand. If unknown, leave out this parameter
+     * and the value will be calculated in the constructor.
+     */
+    libsvm_corpus(std::vector<std::string> files,
+                  label_type type = label_type::CLASSIFICATION,
+                  uint64_t num_docs = 0);
+
     bool has_next() const override;
 
     document next() override;
@@ -60,15 +77,27 @@ class libsvm_corpus : public corpus
     metadata::schema_type schema() const override;
 
   private:
+    /**
+     * Buffers in the next line, moving on to the next file when the
+     * current one is exhausted.
+     */
+    void buffer_next();
+
     /// The current document we are on
     doc_id cur_id_;
 
     /// The label type
     label_type lbl_type_;
 
-    /// The number of lines in the file
+    /// The number of lines across all files
     uint64_t num_lines_;
 
+    /// The corpus files, in document order
+    std::vector<std::string> files_;
+
+    /// The index of the file currently being read
+    uint64_t cur_file_;
+
     /// The next document
     std::string next_content_;
 
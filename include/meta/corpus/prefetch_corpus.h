@@ -0,0 +1,117 @@
+/**
+ * @file prefetch_corpus.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_PREFETCH_CORPUS_H_
+#define META_PREFETCH_CORPUS_H_
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+#include "meta/config.h"
+#include "meta/corpus/corpus.h"
+#include "meta/parallel/mpmc_queue.h"
+
+namespace meta
+{
+namespace corpus
+{
+
+/**
+ * Decorator that reads ahead in a wrapped corpus on a background thread,
+ * delivering documents through a bounded queue in doc-id order. This
+ * overlaps corpus I/O, parsing, and metadata attachment with whatever the
+ * consumer does with each document, so a serial next() loop (or the
+ * reader stage of a parallel pipeline) is no longer limited to the speed
+ * of a single thread doing both reading and consuming.
+ *
+ * The wrapped corpus must be fully configured (metadata parser,
+ * store-full-text) before it is handed to the decorator, since reading
+ * begins immediately on construction. All shipped corpus formats parse
+ * their backing streams serially, so a single reader thread is used; it
+ * runs nothing but the wrapped corpus' next(), which is exactly the work
+ * a consuming thread no longer has to wait on.
+ *
+ * Optional corpus-spec parameter:
+ * ~~~toml
+ * prefetch-size = 1024 # documents to read ahead; 0 (default) disables
+ * ~~~
+ */
+class prefetch_corpus : public corpus
+{
+  public:
+    /**
+     * Wraps a corpus and begins reading ahead immediately.
+     * @param backing The corpus to read from
+     * @param buffer_size The maximum number of documents to hold ahead of
+     * the consumer
+     */
+    prefetch_corpus(std::unique_ptr<corpus> backing,
+                    uint64_t buffer_size = 1024);
+
+    /**
+     * Destroys the decorator, stopping the reader thread even if the
+     * corpus has not been fully consumed.
+     */
+    ~prefetch_corpus();
+
+    /**
+     * @return whether there is another document in this corpus
+     */
+    bool has_next() const override;
+
+    /**
+     * @return the next document from this corpus. If the reader thread
+     * encountered an error, it is rethrown here.
+     */
+    document next() override;
+
+    /**
+     * @return the number of documents in this corpus
+     */
+    uint64_t size() const override;
+
+    /**
+     * @return the corpus' metadata schema
+     */
+    metadata::schema_type schema() const override;
+
+  private:
+    /// The reader thread's main loop
+    void read();
+
+    /// The wrapped corpus; only the reader thread touches it after
+    /// construction
+    std::unique_ptr<corpus> backing_;
+
+    /// The total number of documents, cached from the wrapped corpus
+    uint64_t size_;
+
+    /// The metadata schema, cached from the wrapped corpus
+    metadata::schema_type schema_;
+
+    /// The number of documents handed out so far
+    uint64_t delivered_;
+
+    /// Signals the reader thread to stop on early destruction
+    std::atomic<bool> stop_;
+
+    /// An error raised on the reader thread, rethrown from next()
+    std::exception_ptr error_;
+
+    /// The bounded hand-off queue of read-ahead documents
+    parallel::mpmc_queue<document> queue_;
+
+    /// The background reader thread
+    std::thread thread_;
+};
+}
+}
+#endif
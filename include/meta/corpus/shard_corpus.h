@@ -0,0 +1,109 @@
+/**
+ * @file shard_corpus.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_SHARD_CORPUS_H_
+#define META_SHARD_CORPUS_H_
+
+#include <memory>
+
+#include "meta/config.h"
+#include "meta/corpus/corpus.h"
+
+namespace meta
+{
+namespace corpus
+{
+
+/**
+ * Decorator that restricts a corpus to one shard of a deterministic
+ * partition by doc-id range: shard \f$i\f$ of \f$n\f$ covers global ids
+ * \f$[iS/n, (i+1)S/n)\f$ for a corpus of size \f$S\f$. Every process
+ * computing the same (shard, num_shards) pair over the same corpus sees
+ * the same documents, so an index build can be fanned out across
+ * machines without hand-splitting files.
+ *
+ * Documents are renumbered with shard-local ids starting at zero, which
+ * is what a per-shard index build expects; base() reports the first
+ * global id so a later merge can restore global doc ids by offsetting.
+ * Range sharding (rather than hashing) is used precisely so that this
+ * offset is a single constant per shard.
+ *
+ * Optional corpus-spec parameters:
+ * ~~~toml
+ * num-shards = 16 # 0 (default) disables sharding
+ * shard = 3       # which shard this process should read
+ * ~~~
+ */
+class shard_corpus : public corpus
+{
+  public:
+    /**
+     * @param backing The corpus to restrict; must be fully configured
+     * @param shard The zero-based shard to expose
+     * @param num_shards The total number of shards in the partition
+     */
+    shard_corpus(std::unique_ptr<corpus> backing, uint64_t shard,
+                 uint64_t num_shards);
+
+    /**
+     * @return whether there is another document in this shard
+     */
+    bool has_next() const override;
+
+    /**
+     * @return the next document in this shard, renumbered with a
+     * shard-local doc id
+     */
+    document next() override;
+
+    /**
+     * @return the number of documents in this shard
+     */
+    uint64_t size() const override;
+
+    /**
+     * @return the corpus' metadata schema
+     */
+    metadata::schema_type schema() const override;
+
+    /**
+     * @return the zero-based shard this view exposes
+     */
+    uint64_t shard() const;
+
+    /**
+     * @return the total number of shards in the partition
+     */
+    uint64_t num_shards() const;
+
+    /**
+     * @return the global doc id of this shard's first document: the
+     * offset to add to shard-local ids when merging per-shard outputs
+     */
+    doc_id base() const;
+
+  private:
+    /// The wrapped corpus
+    std::unique_ptr<corpus> backing_;
+    /// The zero-based shard to expose
+    uint64_t shard_;
+    /// The total number of shards
+    uint64_t num_shards_;
+    /// The first global doc id in this shard
+    uint64_t begin_;
+    /// One past the last global doc id in this shard
+    uint64_t end_;
+    /// The number of documents consumed from the wrapped corpus
+    uint64_t consumed_;
+    /// The number of documents handed out so far
+    uint64_t delivered_;
+};
+}
+}
+#endif
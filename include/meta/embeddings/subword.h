@@ -0,0 +1,44 @@
+/**
+ * @file subword.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_EMBEDDINGS_SUBWORD_H_
+#define META_EMBEDDINGS_SUBWORD_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/util/string_view.h"
+
+namespace meta
+{
+namespace embeddings
+{
+
+/**
+ * Computes the hashed character n-gram bucket ids for a word. The word
+ * is wrapped in '<' and '>' boundary markers and every character n-gram
+ * with min_ngram <= n <= max_ngram is hashed into [0, num_buckets).
+ * The hash seed is fixed, so bucket ids computed at training time match
+ * the ones computed at lookup time in a different process and the
+ * bucket table can be persisted alongside the embeddings.
+ *
+ * @param word The surface form to decompose
+ * @param num_buckets The size of the bucket table
+ * @param min_ngram The smallest n-gram length to extract
+ * @param max_ngram The largest n-gram length to extract
+ * @return the bucket ids, one per extracted n-gram (duplicates kept)
+ */
+std::vector<uint64_t> subword_buckets(util::string_view word,
+                                      uint64_t num_buckets,
+                                      std::size_t min_ngram = 3,
+                                      std::size_t max_ngram = 6);
+}
+}
+#endif
@@ -11,6 +11,7 @@
 #define META_EMBEDDINGS_WORD_EMBEDDINGS_H_
 
 #include <istream>
+#include <memory>
 #include <stdexcept>
 
 #include "cpptoml.h"
@@ -18,6 +19,7 @@
 #include "meta/hashing/probe_map.h"
 #include "meta/util/aligned_allocator.h"
 #include "meta/util/array_view.h"
+#include "meta/util/disk_vector.h"
 #include "meta/util/string_view.h"
 
 namespace meta
@@ -63,10 +65,51 @@ class word_embeddings
     word_embeddings(std::istream& vocab, std::istream& first,
                     std::istream& second);
 
+    /**
+     * Loads word embeddings backed by a memory-mapped file previously
+     * written with save_mmap(). Only the vocabulary is materialized in
+     * RAM; the vectors are mapped from the page cache, so construction
+     * is fast and concurrent processes share one physical copy.
+     *
+     * @param vocab The stream to read the vocabulary from
+     * @param mmap_prefix The prefix of the mapped files (".meta" and
+     * ".bin" are appended)
+     */
+    word_embeddings(std::istream& vocab, const std::string& mmap_prefix);
+
+    /**
+     * Writes the embeddings matrix in the memory-mappable format, as
+     * raw full-precision vectors or quantized to 8 bits per dimension
+     * with a per-dimension (min, scale) pair stored in the metadata
+     * file. Quantization shrinks the mapping 8x at a small cost in
+     * cosine-neighbor fidelity.
+     *
+     * @param mmap_prefix The prefix to write the ".meta" and ".bin"
+     * files under
+     * @param quantize Whether to store 8-bit quantized vectors
+     */
+    void save_mmap(const std::string& mmap_prefix, bool quantize) const;
+
+    /**
+     * Loads a subword (character n-gram) bucket table written by the
+     * GloVe trainer. Once loaded, at() composes vectors for
+     * out-of-vocabulary terms from their hashed character n-grams
+     * instead of falling back to the single <unk> vector.
+     *
+     * @param subwords The stream to read the bucket table from
+     */
+    void load_subwords(std::istream& subwords);
+
     /**
      * @param term The term to look up
      * @return the embedding vector (as an array_view) for the given term,
      *  or the vector for the unknown word as appropriate
+     *
+     * For full-precision models (in-RAM or memory-mapped), the view
+     * aliases the underlying storage. For quantized models, the vector
+     * is dequantized into a thread-local buffer and the view is only
+     * valid until the next lookup on the same thread; the same holds
+     * for out-of-vocabulary vectors composed from a subword table.
      */
     embedding at(util::string_view term) const;
 
@@ -85,11 +128,62 @@ class word_embeddings
     std::vector<scored_embedding> top_k(util::array_view<const double> query,
                                         std::size_t k = 100) const;
 
+    /**
+     * Scores a batch of queries in a single pass over the embeddings
+     * matrix. Each row is read from memory once and scored against
+     * every query while it is still in cache, so a batch costs little
+     * more memory bandwidth than a single query.
+     *
+     * @param queries The query vectors, each of the same length as a
+     * word embedding
+     * @param k The number of embeddings to return per query
+     * @return the top k scored_embeddings closest to each query, in
+     * query order
+     */
+    std::vector<std::vector<scored_embedding>>
+    top_k(const std::vector<util::array_view<const double>>& queries,
+          std::size_t k = 100) const;
+
+    /**
+     * Builds a coarse spherical k-means clustering over the embedding
+     * rows, enabling the approximate top_k_approx() scan. Intended to
+     * be run once after loading for workloads dominated by
+     * nearest-neighbor queries.
+     *
+     * @param num_clusters The number of coarse clusters
+     * @param kmeans_iters The number of Lloyd iterations to run
+     */
+    void build_clusters(std::size_t num_clusters,
+                        std::size_t kmeans_iters = 10);
+
+    /**
+     * Approximate top-k: only the rows in the nprobe clusters whose
+     * centroids score best against the query are scanned, trading a
+     * little recall for touching a fraction of the vocabulary. Falls
+     * back to the exact scan if build_clusters() has not been called.
+     *
+     * @param query A vector of the same length as a word embedding to
+     *  query for
+     * @param k The number of embeddings to return
+     * @param nprobe The number of coarse clusters to scan
+     * @return the (approximate) top k scored_embeddings closest to the
+     * query
+     */
+    std::vector<scored_embedding>
+    top_k_approx(util::array_view<const double> query, std::size_t k = 100,
+                 std::size_t nprobe = 4) const;
+
     /**
      * @return the number of dimensions for each word
      */
     std::size_t vector_size() const;
 
+    /**
+     * @return the number of words in the vocabulary (not counting the
+     * <unk> vector, whose id is equal to this value)
+     */
+    std::size_t vocab_size() const;
+
   private:
     util::array_view<double> vector(std::size_t tid);
 
@@ -97,6 +191,30 @@ class word_embeddings
 
     void load_vocab(std::istream& vocab);
 
+    /**
+     * @return the vector size recorded in a mapped metadata file
+     */
+    static std::size_t read_meta_vector_size(const std::string& filename);
+
+    /**
+     * Scores the query against either every row or just the given
+     * candidate rows, returning the top k. All of the top_k variants
+     * funnel through here.
+     *
+     * @param query The query vector
+     * @param k The number of embeddings to return
+     * @param candidates The row ids to scan, or nullptr for all rows
+     */
+    std::vector<scored_embedding>
+    scan_top_k(util::array_view<const double> query, std::size_t k,
+               const std::vector<std::size_t>* candidates) const;
+
+    /**
+     * @return a pointer to the full-precision row for the given id, or
+     * nullptr when the model is quantized
+     */
+    const double* raw_row(std::size_t tid) const;
+
     /// The size of the word embeddings
     const std::size_t vector_size_;
 
@@ -106,8 +224,36 @@ class word_embeddings
     /// A hash table from a term to its id
     hashing::probe_map<util::string_view, std::size_t> term_to_id_;
 
-    /// The embeddings matrix
+    /// The embeddings matrix (when loaded into RAM)
     util::aligned_vector<double> embeddings_;
+
+    /// The full-precision embeddings matrix (when memory-mapped)
+    std::unique_ptr<util::disk_vector<const double>> mmap_vectors_;
+
+    /// The 8-bit quantized embeddings matrix (when memory-mapped)
+    std::unique_ptr<util::disk_vector<const uint8_t>> quantized_;
+
+    /// Per-dimension minimum for dequantization
+    util::aligned_vector<double> quant_min_;
+
+    /// Per-dimension scale for dequantization
+    util::aligned_vector<double> quant_scale_;
+
+    /// Subword bucket vectors (row-major) for OOV composition
+    util::aligned_vector<double> subword_vectors_;
+
+    /// The size of the subword bucket table (0 when none is loaded)
+    uint64_t num_subword_buckets_ = 0;
+
+    /// The smallest and largest char n-gram lengths in the table
+    std::size_t min_ngram_ = 3;
+    std::size_t max_ngram_ = 6;
+
+    /// Coarse cluster centroids (row-major); empty until build_clusters()
+    util::aligned_vector<double> centroids_;
+
+    /// The row ids assigned to each coarse cluster
+    std::vector<std::vector<std::size_t>> cluster_members_;
 };
 
 /**
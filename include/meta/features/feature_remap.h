@@ -0,0 +1,98 @@
+/**
+ * @file feature_remap.h
+ * @author Sean Massung
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_FEATURES_FEATURE_REMAP_H_
+#define META_FEATURES_FEATURE_REMAP_H_
+
+#include <string>
+
+#include "meta/config.h"
+#include "meta/learn/instance.h"
+#include "meta/meta.h"
+#include "meta/succinct/sarray.h"
+
+namespace meta
+{
+namespace features
+{
+/**
+ * A compact, mmap-backed view of a feature_selector's selected-feature
+ * set. This loads only the sarray artifact the selector wrote (see
+ * feature_selector::prefix()), none of its per-class score files, so a
+ * selection computed once can be reapplied cheaply anywhere: lookups
+ * are constant time over the mapped bit vector and safe for concurrent
+ * readers.
+ *
+ * The remap can be applied while building a forward_index by
+ * uninverting (see the "feature-remap" config key), in which case
+ * unselected features are dropped and the survivors renumbered to the
+ * dense [0, total_selected()) id space before they are ever
+ * materialized in the postings.
+ */
+class feature_remap
+{
+  public:
+    /**
+     * @param prefix The feature_selector's prefix (the directory
+     * containing its sarray artifact)
+     */
+    feature_remap(const std::string& prefix)
+        : sarray_{prefix + "/sarray"},
+          s_rank_{prefix + "/sarray", sarray_},
+          s_select_{prefix + "/sarray", sarray_}
+    {
+        // nothing
+    }
+
+    /**
+     * @param term
+     * @return whether the given term was selected
+     */
+    bool selected(term_id term) const
+    {
+        return s_rank_.rank(term) < s_rank_.rank(term + 1);
+    }
+
+    /**
+     * @param term A term with `selected(term) == true`
+     * @return the dense feature_id the term maps to
+     */
+    learn::feature_id new_id(term_id term) const
+    {
+        return learn::feature_id{s_rank_.rank(term)};
+    }
+
+    /**
+     * @param feature A feature_id obtained via new_id()
+     * @return the original term_id for this feature
+     */
+    term_id old_id(learn::feature_id feature) const
+    {
+        return term_id{s_select_.select(feature)};
+    }
+
+    /**
+     * @return the total number of selected features
+     */
+    uint64_t total_selected() const
+    {
+        return s_rank_.size();
+    }
+
+  private:
+    /// the mapped bit vector of selected term ids
+    succinct::sarray sarray_;
+    /// rank structure: maps old ids to dense new ids
+    succinct::sarray_rank s_rank_;
+    /// select structure: maps dense new ids back to old ids
+    succinct::sarray_select s_select_;
+};
+}
+}
+#endif
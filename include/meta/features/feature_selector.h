@@ -12,6 +12,7 @@
 #define META_FEATURE_SELECTOR_H_
 
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -81,6 +82,16 @@ class feature_selector
      */
     uint64_t total_selected() const;
 
+    /**
+     * @return the prefix under which this selector's artifacts are
+     * stored; the sarray written there by select() is the compact remap
+     * consumed by feature_remap
+     */
+    const std::string& prefix() const
+    {
+        return prefix_;
+    }
+
     /**
      * Determines the new, condensed feature_id for a given term_id after
      * feature selection has been performed. This is only defined for
@@ -13,6 +13,7 @@
 #include <mutex>
 #include <vector>
 
+#include "meta/graph/csr_graph.h"
 #include "meta/graph/undirected_graph.h"
 #include "meta/graph/directed_graph.h"
 #include "meta/stats/multinomial.h"
@@ -34,6 +35,14 @@ using centrality_result = std::vector<std::pair<node_id, double>>;
 template <class Graph>
 centrality_result degree_centrality(const Graph& g);
 
+/**
+ * Find the degree centrality of each node using a CSR snapshot of the
+ * graph.
+ * @param g
+ * @return a collection of (id, centrality) pairs
+ */
+inline centrality_result degree_centrality(const csr_graph& g);
+
 /**
  * Find the PageRank centrality of each node in the graph via power iteration.
  * @see http://ilpubs.stanford.edu:8090/422/1/1999-66.pdf
@@ -51,6 +60,53 @@ page_rank_centrality(const DirectedGraph& g, double damp = 0.85,
                      const stats::multinomial<node_id>& jump_dist = {},
                      uint64_t max_iters = 100);
 
+/**
+ * Find the PageRank centrality of each node using a CSR snapshot of the
+ * graph. Each power iteration is partitioned across a thread pool and
+ * every node pulls rank from its contiguous incoming edge array, so large
+ * graphs should be snapshotted once and ranked with this overload.
+ * @param g
+ * @param damp The dampening (smoothing) factor
+ * @param max_iters The maximum number of iterations to run the power iteration
+ * @param jump_dist A personalization vector that indicates the
+ * jumping probability for nodes in the graph. By default, this is empty
+ * which signifies a uniform distribution.
+ * @return a collection of (id, centrality) pairs
+ */
+inline centrality_result
+page_rank_centrality(const csr_graph& g, double damp = 0.85,
+                     const stats::multinomial<node_id>& jump_dist = {},
+                     uint64_t max_iters = 100);
+
+/**
+ * Incrementally updates PageRank scores after a small mutation of the
+ * graph. Starting from the ranks computed against a previous snapshot,
+ * rank corrections are propagated outward from the changed vertices and
+ * a node is only recomputed while its rank is still moving by more than
+ * epsilon, so the cost is proportional to the size of the change set
+ * rather than the graph.
+ *
+ * The node set must be unchanged between the two snapshots; changed
+ * should contain both endpoints of every added or removed edge. (If
+ * nodes were added, fall back to a full page_rank_centrality run.)
+ *
+ * @param g The current CSR snapshot of the graph
+ * @param previous The result of a previous PageRank computation
+ * @param changed The endpoints of every edge that was added or removed
+ * @param damp The dampening (smoothing) factor
+ * @param jump_dist A personalization vector that indicates the
+ * jumping probability for nodes in the graph. By default, this is empty
+ * which signifies a uniform distribution.
+ * @param epsilon Rank changes smaller than this stop propagating
+ * @param max_iters The maximum number of propagation rounds
+ * @return a collection of (id, centrality) pairs
+ */
+inline centrality_result
+page_rank_update(const csr_graph& g, const centrality_result& previous,
+                 const std::vector<node_id>& changed, double damp = 0.85,
+                 const stats::multinomial<node_id>& jump_dist = {},
+                 double epsilon = 1e-10, uint64_t max_iters = 100);
+
 /**
  * Find the betweenness centrality of each node in the graph using the algorithm
  * from Ulrik Brandes, 2001. This function is parallelized as it takes some time
@@ -62,6 +118,16 @@ page_rank_centrality(const DirectedGraph& g, double damp = 0.85,
 template <class Graph>
 centrality_result betweenness_centrality(const Graph& g);
 
+/**
+ * Find the betweenness centrality of each node using a CSR snapshot of
+ * the graph. The Brandes source computations run in parallel with
+ * per-thread accumulators that are reduced at the end, rather than
+ * locking around every centrality update.
+ * @param g
+ * @return a collection of (id, centrality) pairs
+ */
+inline centrality_result betweenness_centrality(const csr_graph& g);
+
 /**
  * Finds the eigenvector centrality of each node (i.e. "prestige") using power
  * iteration.
@@ -84,6 +150,13 @@ namespace internal
 template <class Graph>
 void betweenness_step(const Graph& g, centrality_result& cb, node_id n,
                       std::mutex& calc_mut);
+
+/**
+ * Helper function for betweenness_centrality over a CSR snapshot. The
+ * centrality contributions are accumulated into a thread-local vector.
+ */
+inline void betweenness_step(const csr_graph& g, std::vector<double>& cb,
+                             node_id n);
 }
 }
 }
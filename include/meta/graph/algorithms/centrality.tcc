@@ -3,12 +3,15 @@
  * @author Sean Massung
  */
 
+#include <cmath>
 #include <stack>
 #include <queue>
 #include <vector>
 #include <unordered_map>
 
+#include "meta/parallel/algorithm.h"
 #include "meta/parallel/parallel_for.h"
+#include "meta/util/range.h"
 
 namespace meta
 {
@@ -32,6 +35,21 @@ centrality_result degree_centrality(const Graph& g)
     return res;
 }
 
+inline centrality_result degree_centrality(const csr_graph& g)
+{
+    centrality_result res;
+    res.reserve(g.size());
+    for (uint64_t i = 0; i < g.size(); ++i)
+        res.emplace_back(node_id{i}, g.out_degree(node_id{i}));
+
+    using pair_t = std::pair<node_id, double>;
+    std::sort(res.begin(), res.end(), [&](const pair_t& a, const pair_t& b)
+              {
+                  return a.second > b.second;
+              });
+    return res;
+}
+
 template <class Graph>
 centrality_result betweenness_centrality(const Graph& g)
 {
@@ -121,6 +139,207 @@ page_rank_centrality(const DirectedGraph& g, double damp /* = 0.85 */,
     return evc;
 }
 
+inline centrality_result betweenness_centrality(const csr_graph& g)
+{
+    centrality_result cb;
+    cb.reserve(g.size());
+    for (uint64_t i = 0; i < g.size(); ++i)
+        cb.emplace_back(node_id{i}, 0.0);
+
+    if (g.size() > 0)
+    {
+        std::mutex print_mut; // progress mutex
+
+        printing::progress prog{" Calculating betweenness centrality ",
+                                g.size()};
+        size_t done = 0;
+        parallel::thread_pool pool;
+        auto ids = util::range<uint64_t>(0, g.size() - 1); // inclusive
+        auto total = parallel::reduction(
+            ids.begin(), ids.end(), pool,
+            [&]()
+            {
+                return std::vector<double>(g.size(), 0.0);
+            },
+            [&](std::vector<double>& local, uint64_t n)
+            {
+                internal::betweenness_step(g, local, node_id{n});
+                std::lock_guard<std::mutex> lock{print_mut};
+                prog(++done);
+            },
+            [&](std::vector<double>& result, const std::vector<double>& partial)
+            {
+                for (uint64_t i = 0; i < result.size(); ++i)
+                    result[i] += partial[i];
+            });
+        prog.end();
+
+        for (uint64_t i = 0; i < g.size(); ++i)
+            cb[i].second = total[i];
+    }
+
+    using pair_t = std::pair<node_id, double>;
+    std::sort(cb.begin(), cb.end(), [&](const pair_t& a, const pair_t& b)
+              {
+                  return a.second > b.second;
+              });
+    return cb;
+}
+
+inline centrality_result
+page_rank_centrality(const csr_graph& g, double damp /* = 0.85 */,
+                     const stats::multinomial<node_id>& jump_dist /* = {} */,
+                     uint64_t max_iters /* = 100 */)
+{
+    if (damp < 0.0 || damp > 1.0)
+        throw graph_exception{"PageRank dampening factor must be on [0, 1]"};
+
+    if (g.size() == 0)
+        return {};
+
+    std::vector<double> v(g.size(), 1.0 / g.size());
+    std::vector<double> w(g.size(), 0.0);
+
+    parallel::thread_pool pool;
+    auto ids = util::range<uint64_t>(0, g.size() - 1); // inclusive
+
+    printing::progress prog{" > Calculating PageRank centrality ", max_iters};
+    for (uint64_t iter = 0; iter < max_iters; ++iter)
+    {
+        prog(iter);
+
+        parallel::parallel_for(
+            ids.begin(), ids.end(), pool, [&](uint64_t i)
+            {
+                node_id curr{i};
+                double sum = 0.0;
+                for (const auto& n : g.incoming(curr))
+                {
+                    auto adj_size = g.out_degree(n);
+                    if (adj_size != 0)
+                        sum += v[n] / adj_size;
+                }
+                if (jump_dist.counts() == 0.0)
+                {
+                    w[i] = (1.0 - damp) / g.size() + damp * sum;
+                }
+                else
+                {
+                    w[i] = (1.0 - damp) * jump_dist.probability(curr)
+                           + damp * sum;
+                }
+            });
+        v.swap(w);
+    }
+    prog.end();
+
+    centrality_result evc;
+    evc.reserve(g.size());
+    node_id id{0};
+    for (auto& n : v)
+        evc.emplace_back(id++, n);
+
+    using pair_t = std::pair<node_id, double>;
+    std::sort(evc.begin(), evc.end(), [&](const pair_t& a, const pair_t& b)
+              {
+                  return a.second > b.second;
+              });
+    return evc;
+}
+
+inline centrality_result
+page_rank_update(const csr_graph& g, const centrality_result& previous,
+                 const std::vector<node_id>& changed, double damp /* = 0.85 */,
+                 const stats::multinomial<node_id>& jump_dist /* = {} */,
+                 double epsilon /* = 1e-10 */, uint64_t max_iters /* = 100 */)
+{
+    if (damp < 0.0 || damp > 1.0)
+        throw graph_exception{"PageRank dampening factor must be on [0, 1]"};
+
+    if (previous.size() != g.size())
+        throw graph_exception{
+            "previous PageRank result does not match the snapshot"};
+
+    if (g.size() == 0)
+        return {};
+
+    std::vector<double> v(g.size(), 0.0);
+    for (const auto& pr : previous)
+        v[pr.first] = pr.second;
+
+    // the frontier starts at the mutated vertices and everything they
+    // point at: an edge change at u both moves u's own pull sum and
+    // reapportions the rank u distributes to its out-neighbors
+    std::vector<char> queued(g.size(), 0);
+    std::vector<node_id> frontier;
+    auto enqueue = [&](node_id id)
+    {
+        if (!queued[id])
+        {
+            queued[id] = 1;
+            frontier.push_back(id);
+        }
+    };
+    for (const auto& id : changed)
+    {
+        enqueue(id);
+        for (const auto& n : g.outgoing(id))
+            enqueue(n);
+    }
+
+    std::vector<std::pair<node_id, double>> updates;
+    for (uint64_t iter = 0; iter < max_iters && !frontier.empty(); ++iter)
+    {
+        // recompute every frontier node against the current ranks...
+        updates.clear();
+        updates.reserve(frontier.size());
+        for (const auto& curr : frontier)
+        {
+            double sum = 0.0;
+            for (const auto& n : g.incoming(curr))
+            {
+                auto adj_size = g.out_degree(n);
+                if (adj_size != 0)
+                    sum += v[n] / adj_size;
+            }
+            double rank;
+            if (jump_dist.counts() == 0.0)
+                rank = (1.0 - damp) / g.size() + damp * sum;
+            else
+                rank = (1.0 - damp) * jump_dist.probability(curr) + damp * sum;
+            updates.emplace_back(curr, rank);
+        }
+
+        // ...then apply the new ranks and propagate to the out-neighbors
+        // of any node that moved by more than epsilon
+        frontier.clear();
+        queued.assign(queued.size(), 0);
+        for (const auto& up : updates)
+        {
+            auto delta = up.second - v[up.first];
+            v[up.first] = up.second;
+            if (std::abs(delta) > epsilon)
+            {
+                for (const auto& n : g.outgoing(up.first))
+                    enqueue(n);
+            }
+        }
+    }
+
+    centrality_result evc;
+    evc.reserve(g.size());
+    node_id id{0};
+    for (auto& n : v)
+        evc.emplace_back(id++, n);
+
+    using pair_t = std::pair<node_id, double>;
+    std::sort(evc.begin(), evc.end(), [&](const pair_t& a, const pair_t& b)
+              {
+                  return a.second > b.second;
+              });
+    return evc;
+}
+
 template <class Graph>
 centrality_result eigenvector_centrality(const Graph& g,
                                          uint64_t max_iters /* = 100 */)
@@ -207,6 +426,54 @@ void betweenness_step(const Graph& g, centrality_result& cb, node_id n,
         }
     }
 }
+
+inline void betweenness_step(const csr_graph& g, std::vector<double>& cb,
+                             node_id n)
+{
+    // ids are dense in the snapshot, so plain arrays replace the hash
+    // maps used by the adjacency-map version
+    std::stack<node_id> stack;
+    std::vector<std::vector<node_id>> parent(g.size());
+    std::vector<double> sigma(g.size(), 0.0);
+    sigma[n] = 1.0;
+    std::vector<double> d(g.size(), -1.0);
+    d[n] = 0;
+    std::queue<node_id> queue;
+    queue.push(n);
+    while (!queue.empty())
+    {
+        auto v = queue.front();
+        queue.pop();
+        stack.push(v);
+        for (const auto& w : g.outgoing(v))
+        {
+            // w found for the first time?
+            if (d[w] < 0)
+            {
+                queue.push(w);
+                d[w] = d[v] + 1;
+            }
+            // shortest path to w via v?
+            if (d[w] == d[v] + 1)
+            {
+                sigma[w] = sigma[w] + sigma[v];
+                parent[w].push_back(v);
+            }
+        }
+    }
+
+    std::vector<double> delta(g.size(), 0);
+    // S returns vertices in order of non-increasing distance from n
+    while (!stack.empty())
+    {
+        auto w = stack.top();
+        stack.pop();
+        for (auto& v : parent[w])
+            delta[v] += (sigma[v] / sigma[w]) * (1.0 + delta[w]);
+        if (w != n)
+            cb[w] += delta[w];
+    }
+}
 }
 }
 }
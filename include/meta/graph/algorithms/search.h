@@ -10,6 +10,7 @@
 #ifndef META_GRAPH_ALGORITHMS_SEARCH_H_
 #define META_GRAPH_ALGORITHMS_SEARCH_H_
 
+#include "meta/graph/csr_graph.h"
 #include "meta/graph/undirected_graph.h"
 #include "meta/graph/directed_graph.h"
 
@@ -36,6 +37,34 @@ std::vector<node_id> myopic_search(Graph& g, node_id src, node_id dest);
  */
 template <class Graph>
 std::vector<node_id> bfs(Graph& g, node_id src, node_id dest);
+
+/**
+ * Computes hop distances from a set of source nodes to every node in a
+ * CSR snapshot of the graph using a level-synchronous BFS. Each level's
+ * frontier is kept in a flat array and expanded across a thread pool
+ * into per-thread next-frontier buffers, and the traversal switches
+ * between top-down (scan the frontier's outgoing edges) and bottom-up
+ * (scan unvisited nodes' incoming edges) expansion depending on the
+ * frontier size, following Beamer et al.'s direction-optimizing BFS.
+ * This is the workhorse for multi-source shortest path queries.
+ *
+ * @see http://www.scottbeamer.net/pubs/beamer-sc2012.pdf
+ *
+ * @param g The CSR snapshot to traverse
+ * @param sources The nodes to start the traversal from (distance 0)
+ * @return the minimum number of hops from any source to each node;
+ * unreachable nodes are assigned std::numeric_limits<uint64_t>::max()
+ */
+inline std::vector<uint64_t> bfs_distances(const csr_graph& g,
+                                           const std::vector<node_id>& sources);
+
+/**
+ * Convenience overload for a single-source distance query.
+ * @param g The CSR snapshot to traverse
+ * @param src The node to start the traversal from
+ * @return the minimum number of hops from src to each node
+ */
+inline std::vector<uint64_t> bfs_distances(const csr_graph& g, node_id src);
 }
 }
 }
@@ -3,10 +3,14 @@
  * @author Sean Massung
  */
 
+#include <atomic>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 #include <queue>
+#include "meta/parallel/algorithm.h"
 #include "meta/util/optional.h"
+#include "meta/util/range.h"
 
 namespace meta
 {
@@ -88,6 +92,134 @@ std::vector<node_id> bfs(Graph& g, node_id src, node_id dest)
 
     return path;
 }
+
+inline std::vector<uint64_t> bfs_distances(const csr_graph& g,
+                                           const std::vector<node_id>& sources)
+{
+    constexpr auto unreachable = std::numeric_limits<uint64_t>::max();
+    std::vector<uint64_t> dist(g.size(), unreachable);
+    if (g.size() == 0)
+        return dist;
+
+    // visited flags are claimed with an atomic exchange during top-down
+    // expansion so each discovered node joins exactly one thread's
+    // next-frontier buffer
+    std::unique_ptr<std::atomic<char>[]> visited{
+        new std::atomic<char>[g.size()]};
+    for (uint64_t i = 0; i < g.size(); ++i)
+        visited[i].store(0, std::memory_order_relaxed);
+
+    std::vector<node_id> frontier;
+    frontier.reserve(sources.size());
+    for (const auto& src : sources)
+    {
+        if (src >= g.size())
+            throw graph_algorithm_exception{"BFS source out of range"};
+        if (!visited[src].exchange(1, std::memory_order_relaxed))
+        {
+            dist[src] = 0;
+            frontier.push_back(src);
+        }
+    }
+
+    auto frontier_edges = [&](const std::vector<node_id>& f)
+    {
+        uint64_t edges = 0;
+        for (const auto& id : f)
+            edges += g.out_degree(id);
+        return edges;
+    };
+
+    // direction-optimizing thresholds from Beamer et al.
+    constexpr uint64_t alpha = 15;
+    constexpr uint64_t beta = 18;
+
+    parallel::thread_pool pool;
+    auto local_buffer = [&]()
+    {
+        return std::vector<node_id>{};
+    };
+    auto concat = [&](std::vector<node_id>& result,
+                      const std::vector<node_id>& partial)
+    {
+        result.insert(result.end(), partial.begin(), partial.end());
+    };
+
+    uint64_t level = 0;
+    uint64_t curr_edges = frontier_edges(frontier);
+    uint64_t unexplored_edges = g.num_edges();
+    bool bottom_up = false;
+    std::vector<char> on_frontier(g.size(), 0);
+    while (!frontier.empty())
+    {
+        ++level;
+        unexplored_edges -= std::min(curr_edges, unexplored_edges);
+        if (!bottom_up && curr_edges > unexplored_edges / alpha)
+            bottom_up = true;
+        else if (bottom_up && frontier.size() < g.size() / beta)
+            bottom_up = false;
+
+        std::vector<node_id> next;
+        if (bottom_up)
+        {
+            // every unvisited node checks whether one of its in-neighbors
+            // is on the current frontier; each node is owned by exactly
+            // one thread, so no claiming is needed
+            on_frontier.assign(on_frontier.size(), 0);
+            for (const auto& id : frontier)
+                on_frontier[id] = 1;
+
+            auto ids = util::range<uint64_t>(0, g.size() - 1); // inclusive
+            next = parallel::reduction(
+                ids.begin(), ids.end(), pool, local_buffer,
+                [&](std::vector<node_id>& local, uint64_t i)
+                {
+                    if (visited[i].load(std::memory_order_relaxed))
+                        return;
+                    for (const auto& n : g.incoming(node_id{i}))
+                    {
+                        if (on_frontier[n])
+                        {
+                            visited[i].store(1, std::memory_order_relaxed);
+                            dist[i] = level;
+                            local.push_back(node_id{i});
+                            break;
+                        }
+                    }
+                },
+                concat);
+        }
+        else
+        {
+            next = parallel::reduction(
+                frontier.begin(), frontier.end(), pool, local_buffer,
+                [&](std::vector<node_id>& local, node_id id)
+                {
+                    for (const auto& n : g.outgoing(id))
+                    {
+                        if (!visited[n].load(std::memory_order_relaxed)
+                            && !visited[n].exchange(1,
+                                                    std::memory_order_relaxed))
+                        {
+                            dist[n] = level;
+                            local.push_back(n);
+                        }
+                    }
+                },
+                concat);
+        }
+
+        curr_edges = frontier_edges(next);
+        frontier.swap(next);
+    }
+
+    return dist;
+}
+
+inline std::vector<uint64_t> bfs_distances(const csr_graph& g, node_id src)
+{
+    return bfs_distances(g, std::vector<node_id>{src});
+}
 }
 }
 }
@@ -0,0 +1,132 @@
+/**
+ * @file csr_graph.h
+ * @author Sean Massung
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_GRAPH_CSR_GRAPH_H_
+#define META_GRAPH_CSR_GRAPH_H_
+
+#include <numeric>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/meta.h"
+#include "meta/util/array_view.h"
+
+namespace meta
+{
+namespace graph
+{
+
+/**
+ * An immutable compressed-sparse-row snapshot of a graph. The adjacency
+ * information is compiled into contiguous edge arrays (both outgoing and
+ * incoming), so the traversal-heavy algorithms can scan neighbors without
+ * chasing per-node adjacency list pointers. Node and edge payloads are not
+ * copied; ids index into the original graph.
+ */
+class csr_graph
+{
+  public:
+    /**
+     * Compiles a CSR snapshot of the given graph. For undirected graphs
+     * the incoming and outgoing arrays hold the same (symmetric)
+     * adjacency information.
+     *
+     * @param g The graph to snapshot
+     */
+    template <class Graph>
+    csr_graph(const Graph& g)
+    {
+        auto num_nodes = g.size();
+
+        offsets_.reserve(num_nodes + 1);
+        offsets_.push_back(0);
+        edges_.reserve(g.num_edges());
+        for (uint64_t i = 0; i < num_nodes; ++i)
+        {
+            for (const auto& pr : g.adjacent(node_id{i}))
+                edges_.push_back(pr.first);
+            offsets_.push_back(edges_.size());
+        }
+
+        // transpose the outgoing arrays to obtain the incoming ones
+        in_offsets_.assign(num_nodes + 1, 0);
+        for (const auto& target : edges_)
+            ++in_offsets_[static_cast<uint64_t>(target) + 1];
+        std::partial_sum(in_offsets_.begin(), in_offsets_.end(),
+                         in_offsets_.begin());
+
+        in_edges_.resize(edges_.size());
+        auto pos = in_offsets_;
+        for (uint64_t i = 0; i < num_nodes; ++i)
+        {
+            for (uint64_t e = offsets_[i]; e < offsets_[i + 1]; ++e)
+            {
+                auto target = static_cast<uint64_t>(edges_[e]);
+                in_edges_[pos[target]++] = node_id{i};
+            }
+        }
+    }
+
+    /**
+     * @return the number of nodes in the snapshot
+     */
+    uint64_t size() const
+    {
+        return offsets_.size() - 1;
+    }
+
+    /**
+     * @return the number of edges in the snapshot
+     */
+    uint64_t num_edges() const
+    {
+        return edges_.size();
+    }
+
+    /**
+     * @param id The node id to get the outgoing degree for
+     * @return the number of outgoing edges for the node
+     */
+    uint64_t out_degree(node_id id) const
+    {
+        return offsets_[id + 1] - offsets_[id];
+    }
+
+    /**
+     * @param id The node id to get outgoing neighbors for
+     * @return a view over the node ids this node has edges to
+     */
+    util::array_view<const node_id> outgoing(node_id id) const
+    {
+        return {edges_.data() + offsets_[id], edges_.data() + offsets_[id + 1]};
+    }
+
+    /**
+     * @param id The node id to get incoming neighbors for
+     * @return a view over the node ids that have edges to this node
+     */
+    util::array_view<const node_id> incoming(node_id id) const
+    {
+        return {in_edges_.data() + in_offsets_[id],
+                in_edges_.data() + in_offsets_[id + 1]};
+    }
+
+  private:
+    /// edge array offsets per node (outgoing); offsets_[i + 1] ends node i
+    std::vector<uint64_t> offsets_;
+    /// the concatenated outgoing adjacency lists
+    std::vector<node_id> edges_;
+    /// edge array offsets per node (incoming)
+    std::vector<uint64_t> in_offsets_;
+    /// the concatenated incoming adjacency lists
+    std::vector<node_id> in_edges_;
+};
+}
+}
+#endif
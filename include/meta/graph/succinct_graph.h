@@ -0,0 +1,301 @@
+/**
+ * @file succinct_graph.h
+ * @author Sean Massung
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_GRAPH_SUCCINCT_GRAPH_H_
+#define META_GRAPH_SUCCINCT_GRAPH_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/graph/default_edge.h"
+#include "meta/graph/default_node.h"
+#include "meta/graph/graph.h"
+#include "meta/meta.h"
+#include "meta/succinct/sarray.h"
+#include "meta/util/optional.h"
+
+namespace meta
+{
+namespace graph
+{
+
+/**
+ * An immutable graph whose adjacency structure is stored in an Elias-Fano
+ * encoded sarray rather than per-node vectors of (node_id, edge) pairs.
+ * The concatenated (and per-node sorted) adjacency lists of a graph with
+ * \f$n\f$ nodes form a strictly increasing sequence when each neighbor
+ * \f$j\f$ of node \f$i\f$ is written as \f$i \cdot n + j\f$, so the whole
+ * edge set costs only a few bits per edge and adjacency queries reduce to
+ * rank/select operations. This makes very large read-mostly graphs cheap
+ * enough to keep resident on serving nodes.
+ *
+ * Only the structure (and the node objects) are retained: edge payloads
+ * are not stored, so edges read back from this graph are
+ * default-constructed with their src and dest fields set. Undirected
+ * graphs are snapshotted with both directions of each edge present.
+ *
+ * The encoded arrays are written below the given prefix (and are memory
+ * mapped afterwards), mirroring the other succinct structures.
+ */
+template <class Node = default_node, class Edge = default_edge>
+class succinct_graph
+{
+  public:
+    using adjacency_list = std::vector<std::pair<node_id, Edge>>;
+    using node_type = Node;
+    using edge_type = Edge;
+
+    /**
+     * Compiles a succinct snapshot of the given graph, writing the
+     * encoded adjacency structure to the folder denoted by prefix.
+     *
+     * @param prefix The folder to store the encoded structure in
+     * @param g The graph to snapshot
+     */
+    template <class Graph>
+    succinct_graph(const std::string& prefix, const Graph& g)
+        : num_nodes_{g.size()},
+          sarray_{build_sarray(prefix, g)},
+          rank_{prefix, sarray_},
+          select_{prefix, sarray_}
+    {
+        nodes_.reserve(num_nodes_);
+        for (uint64_t i = 0; i < num_nodes_; ++i)
+            nodes_.push_back(g.node(node_id{i}));
+    }
+
+    /**
+     * @param id
+     * @return the Node object that the id represents
+     */
+    const Node& node(node_id id) const
+    {
+        return nodes_[id];
+    }
+
+    /**
+     * @param source
+     * @param dest
+     * @return an optional edge connecting source and dest; since payloads
+     * are not stored, the edge is default-constructed apart from its src
+     * and dest fields
+     */
+    util::optional<Edge> edge(node_id source, node_id dest) const
+    {
+        if (source >= size() || dest >= size())
+            throw graph_exception{"node_id out of range"};
+
+        auto pos = static_cast<uint64_t>(source) * num_nodes_ + dest;
+        if (rank_.rank(pos + 1) == rank_.rank(pos))
+            return util::nullopt;
+
+        Edge e;
+        e.src = source;
+        e.dest = dest;
+        return e;
+    }
+
+    /**
+     * @return the size of this graph (number of nodes), which is the
+     * range for a valid node_id
+     */
+    uint64_t size() const
+    {
+        return num_nodes_;
+    }
+
+    /**
+     * @return the number of stored adjacency entries; for directed graphs
+     * this is the number of edges, for undirected graphs each edge is
+     * counted once per direction
+     */
+    uint64_t num_edges() const
+    {
+        return select_.size();
+    }
+
+    /**
+     * @param id The node id to get the outgoing degree for
+     * @return the number of outgoing edges for the node
+     */
+    uint64_t out_degree(node_id id) const
+    {
+        if (id >= size())
+            throw graph_exception{"node_id out of range"};
+
+        auto base = static_cast<uint64_t>(id) * num_nodes_;
+        return rank_.rank(base + num_nodes_) - rank_.rank(base);
+    }
+
+    /**
+     * @param id The node id to get the adjacent nodes for
+     * @return the adjacency list for the node, materialized from the
+     * encoded structure with default-constructed edge payloads
+     */
+    adjacency_list adjacent(node_id id) const
+    {
+        if (id >= size())
+            throw graph_exception{"node_id out of range"};
+
+        auto base = static_cast<uint64_t>(id) * num_nodes_;
+        auto lo = rank_.rank(base);
+        auto hi = rank_.rank(base + num_nodes_);
+
+        adjacency_list list;
+        list.reserve(hi - lo);
+        for (uint64_t k = lo; k < hi; ++k)
+        {
+            Edge e;
+            e.src = id;
+            e.dest = node_id{select_.select(k) - base};
+            list.emplace_back(e.dest, e);
+        }
+        return list;
+    }
+
+    using node_iterator = typename std::vector<Node>::const_iterator;
+    using const_node_iterator = node_iterator;
+
+    node_iterator begin() const
+    {
+        return nodes_.begin();
+    }
+
+    node_iterator end() const
+    {
+        return nodes_.end();
+    }
+
+    /**
+     * A forward iterator over all (reconstructed) edges in the graph, in
+     * order of increasing (src, dest).
+     */
+    class edge_iterator
+        : public std::iterator<std::forward_iterator_tag, const Edge>
+    {
+      public:
+        edge_iterator(const succinct_graph* handle, uint64_t idx)
+            : handle_{handle}, idx_{idx}
+        {
+            if (idx_ < handle_->num_edges())
+                materialize();
+        }
+
+        friend bool operator==(const edge_iterator& lhs,
+                               const edge_iterator& rhs)
+        {
+            return lhs.handle_ == rhs.handle_ && lhs.idx_ == rhs.idx_;
+        }
+
+        friend bool operator!=(const edge_iterator& lhs,
+                               const edge_iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+        edge_iterator& operator++()
+        {
+            ++idx_;
+            if (idx_ < handle_->num_edges())
+                materialize();
+            return *this;
+        }
+
+        edge_iterator operator++(int)
+        {
+            edge_iterator saved{*this};
+            ++(*this);
+            return saved;
+        }
+
+        const Edge& operator*() const
+        {
+            return edge_;
+        }
+
+        const Edge* operator->() const
+        {
+            return &edge_;
+        }
+
+      private:
+        void materialize()
+        {
+            auto val = handle_->select_.select(idx_);
+            edge_ = Edge{};
+            edge_.src = node_id{val / handle_->num_nodes_};
+            edge_.dest = node_id{val % handle_->num_nodes_};
+        }
+
+        const succinct_graph* handle_;
+        uint64_t idx_;
+        Edge edge_;
+    };
+
+    using const_edge_iterator = edge_iterator;
+
+    edge_iterator edges_begin() const
+    {
+        return {this, 0};
+    }
+
+    edge_iterator edges_end() const
+    {
+        return {this, num_edges()};
+    }
+
+  private:
+    /**
+     * Encodes the concatenated adjacency lists of the graph as an sarray
+     * over the strictly increasing sequence \f$i \cdot n + j\f$.
+     */
+    template <class Graph>
+    static succinct::sarray build_sarray(const std::string& prefix,
+                                         const Graph& g)
+    {
+        auto num_nodes = g.size();
+        if (num_nodes == 0)
+            throw graph_exception{
+                "cannot build a succinct_graph over an empty graph"};
+
+        std::vector<uint64_t> values;
+        for (uint64_t i = 0; i < num_nodes; ++i)
+        {
+            auto base = i * num_nodes;
+            auto start = values.size();
+            for (const auto& pr : g.adjacent(node_id{i}))
+                values.push_back(base + pr.first);
+            // adjacency lists are stored in insertion order upstream
+            std::sort(values.begin() + start, values.end());
+        }
+
+        if (values.empty())
+            throw graph_exception{
+                "cannot build a succinct_graph over a graph with no edges"};
+
+        return succinct::make_sarray(prefix, values.begin(), values.end(),
+                                     num_nodes * num_nodes);
+    }
+
+    /// the number of nodes in the snapshot
+    uint64_t num_nodes_;
+    /// the Elias-Fano encoded adjacency structure
+    succinct::sarray sarray_;
+    /// rank support (adjacency list boundaries and membership queries)
+    succinct::sarray_rank rank_;
+    /// select support (adjacency list contents)
+    succinct::sarray_select select_;
+    /// the node objects, indexed by id
+    std::vector<Node> nodes_;
+};
+}
+}
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file bloom_filter.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_HASHING_BLOOM_FILTER_H_
+#define META_HASHING_BLOOM_FILTER_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/hashing/hash.h"
+#include "meta/io/packed.h"
+
+namespace meta
+{
+namespace hashing
+{
+
+/**
+ * A Bloom filter for cheaply rejecting keys that are definitely absent
+ * from a larger structure before paying for the full probe. contains()
+ * never returns false for an inserted key; for absent keys it returns
+ * true with probability roughly \f$0.61^{b}\f$ for \f$b\f$ bits per key
+ * (about 1% at the default of 10 bits per key).
+ *
+ * The bit positions are derived from two seeded hashes via double
+ * hashing, so lookups cost two hash evaluations regardless of the
+ * number of probe bits.
+ */
+template <class K, class HashAlgorithm = farm_hash_seeded>
+class bloom_filter
+{
+  public:
+    /**
+     * @param num_keys The expected number of distinct keys to insert
+     * @param bits_per_key The number of filter bits to allocate per key
+     */
+    bloom_filter(uint64_t num_keys, uint8_t bits_per_key = 10)
+        : num_bits_{std::max<uint64_t>(num_keys, 1) * bits_per_key},
+          // k = b ln 2 minimizes the false positive rate
+          num_hashes_{std::max<uint8_t>(
+              1, static_cast<uint8_t>(bits_per_key * 0.693))},
+          words_((num_bits_ + 63) / 64, 0)
+    {
+        // nothing
+    }
+
+    /**
+     * Reads a previously saved filter from a stream.
+     * @param stream The stream to read the filter from
+     */
+    template <class InputStream>
+    bloom_filter(InputStream& stream)
+    {
+        io::packed::read(stream, num_bits_);
+        io::packed::read(stream, num_hashes_);
+        words_.resize((num_bits_ + 63) / 64);
+        for (auto& word : words_)
+            io::packed::read(stream, word);
+    }
+
+    /**
+     * Inserts a key into the filter.
+     * @param key The key to insert
+     */
+    void insert(const K& key)
+    {
+        auto h1 = hash1_(key);
+        auto h2 = hash2_(key);
+        for (uint8_t i = 0; i < num_hashes_; ++i)
+        {
+            auto bit = (h1 + i * h2) % num_bits_;
+            words_[bit / 64] |= uint64_t{1} << (bit % 64);
+        }
+    }
+
+    /**
+     * @param key The key to test
+     * @return whether the key might have been inserted; false means the
+     * key definitely was not
+     */
+    bool contains(const K& key) const
+    {
+        auto h1 = hash1_(key);
+        auto h2 = hash2_(key);
+        for (uint8_t i = 0; i < num_hashes_; ++i)
+        {
+            auto bit = (h1 + i * h2) % num_bits_;
+            if (!(words_[bit / 64] & (uint64_t{1} << (bit % 64))))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Writes the filter to a stream to be read back later.
+     * @param stream The stream to write the filter to
+     * @return the number of bytes written
+     */
+    template <class OutputStream>
+    uint64_t save(OutputStream& stream) const
+    {
+        auto bytes = io::packed::write(stream, num_bits_)
+                     + io::packed::write(stream, num_hashes_);
+        for (const auto& word : words_)
+            bytes += io::packed::write(stream, word);
+        return bytes;
+    }
+
+    std::size_t bytes_used() const
+    {
+        return words_.capacity() * sizeof(uint64_t) + sizeof(num_bits_)
+               + sizeof(num_hashes_);
+    }
+
+  private:
+    uint64_t num_bits_;
+    uint8_t num_hashes_;
+    std::vector<uint64_t> words_;
+    seeded_hash<HashAlgorithm> hash1_{47};
+    seeded_hash<HashAlgorithm> hash2_{1953};
+};
+}
+}
+#endif
@@ -5,6 +5,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <type_traits>
@@ -15,6 +16,10 @@
 #include "meta/util/aligned_allocator.h"
 #include "meta/util/optional.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifndef META_HASHING_HASH_STORAGE_H_
 #define META_HASHING_HASH_STORAGE_H_
 
@@ -483,7 +488,7 @@ class storage_base
         stored_type stored(std::forward<Args>(args)...);
         const auto& key = storage_traits<Derived>::get_key(stored);
         auto hc = hash_(key);
-        auto idx = get_idx(key, hc);
+        auto idx = as_derived().get_idx(key, hc);
         as_derived().put(idx, hc, std::move(stored));
 
         return {as_derived(), idx};
@@ -497,7 +502,7 @@ class storage_base
     const_iterator find(const key_type& key) const
     {
         auto hc = hash_(key);
-        auto idx = get_idx(key, hc);
+        auto idx = as_derived().get_idx(key, hc);
 
         if (!as_derived().occupied(idx))
             return end();
@@ -513,7 +518,7 @@ class storage_base
     iterator find(const key_type& key)
     {
         auto hc = hash_(key);
-        auto idx = get_idx(key, hc);
+        auto idx = as_derived().get_idx(key, hc);
 
         if (!as_derived().occupied(idx))
             return end();
@@ -521,6 +526,22 @@ class storage_base
         return {as_derived(), idx};
     }
 
+    /**
+     * Ensures the table can hold num_elements elements without
+     * exceeding the maximum load factor, so a counting loop that knows
+     * (or can estimate) its final cardinality up front can avoid the
+     * intermediate rehashes of element-wise growth.
+     *
+     * @param num_elements The number of elements to make room for
+     */
+    void reserve(std::size_t num_elements)
+    {
+        auto needed = static_cast<std::size_t>(
+            std::ceil(num_elements / max_load_factor()));
+        if (needed > as_derived().capacity())
+            as_derived().resize(needed);
+    }
+
     /**
      * @return whether the table is empty
      */
@@ -1245,6 +1266,460 @@ struct storage_traits<external_key_value_storage<K, V, ProbingStrategy, Hash,
         return st.first;
     }
 };
+
+/**
+ * One-byte-per-slot occupancy/tag metadata for the tagged storage
+ * classes. Empty slots hold a sentinel tag and occupied slots hold the
+ * low seven bits of the key's hash, so a whole group of 16 slots can be
+ * screened against a sought key's tag with a single SSE2 compare before
+ * any full entry is inspected. Because occupancy lives here, the tagged
+ * storages do not need to sacrifice a key sentinel value.
+ */
+class tag_array
+{
+  public:
+    constexpr static std::size_t group_size()
+    {
+        return 16;
+    }
+
+    constexpr static uint8_t empty_tag()
+    {
+        return 0x80;
+    }
+
+    /**
+     * @return the tag for a hash code (its low seven bits, so that a
+     * tag can never collide with the empty sentinel)
+     */
+    static uint8_t tag_for(std::size_t hc)
+    {
+        return static_cast<uint8_t>(hc & 0x7f);
+    }
+
+    /**
+     * @return the smallest multiple of the group size that is at least
+     * the given capacity
+     */
+    static std::size_t round_capacity(std::size_t capacity)
+    {
+        return (capacity + group_size() - 1) & ~(group_size() - 1);
+    }
+
+    /**
+     * @return the index of the lowest set bit in a (nonzero) match mask
+     */
+    static std::size_t lowest_set(uint32_t mask)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<std::size_t>(__builtin_ctz(mask));
+#else
+        std::size_t idx = 0;
+        for (; !(mask & 1); mask >>= 1)
+            ++idx;
+        return idx;
+#endif
+    }
+
+    tag_array(std::size_t capacity) : tags_(capacity, empty_tag())
+    {
+        assert(capacity % group_size() == 0);
+    }
+
+    bool occupied(std::size_t idx) const
+    {
+        return tags_[idx] != empty_tag();
+    }
+
+    void set(std::size_t idx, uint8_t tag)
+    {
+        tags_[idx] = tag;
+    }
+
+    void clear()
+    {
+        std::fill(tags_.begin(), tags_.end(), empty_tag());
+    }
+
+    std::size_t capacity() const
+    {
+        return tags_.size();
+    }
+
+    std::size_t bytes_used() const
+    {
+        return tags_.capacity();
+    }
+
+    /**
+     * @param base The index of the first slot of a group (a multiple of
+     * the group size)
+     * @param tag The tag to look for
+     * @return a 16-bit mask whose i-th bit is set iff slot base + i
+     * holds the tag
+     */
+    uint32_t match(std::size_t base, uint8_t tag) const
+    {
+#if defined(__SSE2__)
+        auto tags = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(tags_.data() + base));
+        auto eq = _mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(tag)));
+        return static_cast<uint32_t>(_mm_movemask_epi8(eq));
+#else
+        uint32_t mask = 0;
+        for (std::size_t i = 0; i < group_size(); ++i)
+            mask |= static_cast<uint32_t>(tags_[base + i] == tag) << i;
+        return mask;
+#endif
+    }
+
+    uint32_t match_empty(std::size_t base) const
+    {
+        return match(base, empty_tag());
+    }
+
+  private:
+    util::aligned_vector<uint8_t> tags_;
+};
+
+/**
+ * Storage class for hash sets that screens probes against a tag_array:
+ * the probing strategy walks aligned groups of 16 slots, and each group
+ * is filtered down to tag-matching candidates with one SSE2 compare
+ * before any key is compared. The probing strategy must yield
+ * group-aligned indices (e.g. probing::group_linear).
+ */
+template <class T, class ProbingStrategy, class Hash, class KeyEqual>
+class tagged_key_storage
+    : public storage_base<tagged_key_storage<T, ProbingStrategy, Hash,
+                                             KeyEqual>>
+{
+  public:
+    using reference = T&;
+    using const_reference = const T&;
+    using vector_type = util::aligned_vector<T>;
+
+    tagged_key_storage(std::size_t capacity)
+        : tags_{tag_array::round_capacity(capacity)},
+          table_(tag_array::round_capacity(capacity)),
+          size_{0}
+    {
+        // tag screening keeps probes cheap even in nearly-full groups,
+        // so run denser than the untagged default
+        this->max_load_factor(0.875);
+    }
+
+    /**
+     * Group-probing override of storage_base::get_idx: within each
+     * group, only slots whose tag matches the key's are compared, and
+     * the probe stops at the first group containing an empty slot.
+     */
+    std::size_t get_idx(const T& key, std::size_t hc) const
+    {
+        auto tag = tag_array::tag_for(hc);
+        ProbingStrategy strategy{hc, capacity()};
+        while (true)
+        {
+            auto base = strategy.probe();
+            auto matches = tags_.match(base, tag);
+            while (matches)
+            {
+                auto idx = base + tag_array::lowest_set(matches);
+                if (this->key_equal(table_[idx], key))
+                    return idx;
+                matches &= matches - 1;
+            }
+
+            auto empties = tags_.match_empty(base);
+            if (empties)
+                return base + tag_array::lowest_set(empties);
+        }
+    }
+
+    bool occupied(std::size_t idx) const
+    {
+        return tags_.occupied(idx);
+    }
+
+    bool equal(std::size_t idx, std::size_t /*hc*/, const_reference key) const
+    {
+        return this->key_equal(table_[idx], key);
+    }
+
+    const_reference operator[](std::size_t idx) const
+    {
+        return table_[idx];
+    }
+
+    reference operator[](std::size_t idx)
+    {
+        return table_[idx];
+    }
+
+    template <class... Args>
+    void put(std::size_t idx, std::size_t hc, Args&&... args)
+    {
+        if (!tags_.occupied(idx))
+            ++size_;
+        table_[idx] = T(std::forward<Args>(args)...);
+        tags_.set(idx, tag_array::tag_for(hc));
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    std::size_t capacity() const
+    {
+        return table_.size();
+    }
+
+    void clear()
+    {
+        std::fill(std::begin(table_), std::end(table_), T{});
+        tags_.clear();
+        size_ = 0;
+    }
+
+    void resize(std::size_t new_cap)
+    {
+        assert(new_cap > capacity());
+        new_cap = tag_array::round_capacity(new_cap);
+
+        vector_type temptable(new_cap);
+        tag_array temptags{new_cap};
+        using std::swap;
+        swap(table_, temptable);
+        swap(tags_, temptags);
+
+        for (std::size_t idx = 0; idx < temptable.size(); ++idx)
+        {
+            if (temptags.occupied(idx))
+            {
+                auto hc = this->hash(temptable[idx]);
+                auto nidx = get_idx(temptable[idx], hc);
+                table_[nidx] = std::move(temptable[idx]);
+                tags_.set(nidx, tag_array::tag_for(hc));
+            }
+        }
+    }
+
+    std::size_t bytes_used() const
+    {
+        return sizeof(T) * table_.capacity() + tags_.bytes_used()
+               + sizeof(std::size_t);
+    }
+
+    std::vector<T> extract_keys()
+    {
+        std::vector<T> res;
+        res.reserve(size_);
+        for (std::size_t idx = 0; idx < table_.size(); ++idx)
+        {
+            if (occupied(idx))
+                res.emplace_back(std::move(table_[idx]));
+        }
+        clear();
+        return res;
+    }
+
+    tag_array tags_;
+    vector_type table_;
+    std::size_t size_;
+};
+
+/**
+ * A specialization of the storage_traits configuration point for
+ * tagged_key_storage.
+ */
+template <class T, class ProbingStrategy, class Hash, class KeyEqual>
+struct storage_traits<tagged_key_storage<T, ProbingStrategy, Hash, KeyEqual>>
+{
+    using type = tagged_key_storage<T, ProbingStrategy, Hash, KeyEqual>;
+    using iterator = key_storage_iterator<type>;
+    using const_iterator = key_storage_iterator<const type>;
+    using stored_type = T;
+    using key_type = T;
+    using probing_strategy = ProbingStrategy;
+    using hash_type = Hash;
+    using equal_type = KeyEqual;
+
+    static const T& get_key(const T& key)
+    {
+        return key;
+    }
+};
+
+/**
+ * Storage class for hash tables that screens probes against a
+ * tag_array; the key, value pairs are stored inline in the table. See
+ * tagged_key_storage for the probing scheme.
+ */
+template <class K, class V, class ProbingStrategy, class Hash, class KeyEqual>
+class tagged_key_value_storage
+    : public storage_base<tagged_key_value_storage<K, V, ProbingStrategy, Hash,
+                                                   KeyEqual>>
+{
+  public:
+    using value_type = kv_pair<K, V>;
+    using const_value_type = kv_pair<K, const V>;
+    using vector_type = util::aligned_vector<std::pair<K, V>>;
+
+    tagged_key_value_storage(std::size_t capacity)
+        : tags_{tag_array::round_capacity(capacity)},
+          table_(tag_array::round_capacity(capacity)),
+          size_{0}
+    {
+        // tag screening keeps probes cheap even in nearly-full groups,
+        // so run denser than the untagged default
+        this->max_load_factor(0.875);
+    }
+
+    /**
+     * Group-probing override of storage_base::get_idx; see
+     * tagged_key_storage::get_idx.
+     */
+    std::size_t get_idx(const K& key, std::size_t hc) const
+    {
+        auto tag = tag_array::tag_for(hc);
+        ProbingStrategy strategy{hc, capacity()};
+        while (true)
+        {
+            auto base = strategy.probe();
+            auto matches = tags_.match(base, tag);
+            while (matches)
+            {
+                auto idx = base + tag_array::lowest_set(matches);
+                if (this->key_equal(table_[idx].first, key))
+                    return idx;
+                matches &= matches - 1;
+            }
+
+            auto empties = tags_.match_empty(base);
+            if (empties)
+                return base + tag_array::lowest_set(empties);
+        }
+    }
+
+    bool occupied(std::size_t idx) const
+    {
+        return tags_.occupied(idx);
+    }
+
+    bool equal(std::size_t idx, std::size_t /*hc*/, const K& key) const
+    {
+        return this->key_equal(table_[idx].first, key);
+    }
+
+    const_value_type operator[](std::size_t idx) const
+    {
+        const auto& pr = table_[idx];
+        return {pr.first, pr.second};
+    }
+
+    value_type operator[](std::size_t idx)
+    {
+        auto& pr = table_[idx];
+        return {pr.first, pr.second};
+    }
+
+    template <class... Args>
+    void put(std::size_t idx, std::size_t hc, Args&&... args)
+    {
+        if (!tags_.occupied(idx))
+            ++size_;
+        table_[idx] = std::pair<K, V>(std::forward<Args>(args)...);
+        tags_.set(idx, tag_array::tag_for(hc));
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    std::size_t capacity() const
+    {
+        return table_.size();
+    }
+
+    void clear()
+    {
+        std::fill(std::begin(table_), std::end(table_), std::pair<K, V>{});
+        tags_.clear();
+        size_ = 0;
+    }
+
+    void resize(std::size_t new_cap)
+    {
+        assert(new_cap > capacity());
+        new_cap = tag_array::round_capacity(new_cap);
+
+        vector_type temptable(new_cap);
+        tag_array temptags{new_cap};
+        using std::swap;
+        swap(table_, temptable);
+        swap(tags_, temptags);
+
+        for (std::size_t idx = 0; idx < temptable.size(); ++idx)
+        {
+            if (temptags.occupied(idx))
+            {
+                auto hc = this->hash(temptable[idx].first);
+                auto nidx = get_idx(temptable[idx].first, hc);
+                table_[nidx] = std::move(temptable[idx]);
+                tags_.set(nidx, tag_array::tag_for(hc));
+            }
+        }
+    }
+
+    std::size_t bytes_used() const
+    {
+        return sizeof(std::pair<K, V>) * table_.capacity()
+               + tags_.bytes_used() + sizeof(std::size_t);
+    }
+
+    vector_type extract() &&
+    {
+        vector_type ret;
+        ret.reserve(size_);
+        for (std::size_t idx = 0; idx < table_.size(); ++idx)
+        {
+            if (occupied(idx))
+                ret.emplace_back(std::move(table_[idx]));
+        }
+        clear();
+        return ret;
+    }
+
+    tag_array tags_;
+    vector_type table_;
+    std::size_t size_;
+};
+
+/**
+ * A specialization of the storage_traits configuration point for
+ * tagged_key_value_storage.
+ */
+template <class K, class V, class ProbingStrategy, class Hash, class KeyEqual>
+struct storage_traits<tagged_key_value_storage<K, V, ProbingStrategy, Hash,
+                                               KeyEqual>>
+{
+    using type = tagged_key_value_storage<K, V, ProbingStrategy, Hash,
+                                          KeyEqual>;
+    using iterator = key_value_storage_iterator<type>;
+    using const_iterator = key_value_storage_iterator<const type>;
+    using stored_type = std::pair<K, V>;
+    using key_type = K;
+    using probing_strategy = ProbingStrategy;
+    using hash_type = Hash;
+    using equal_type = KeyEqual;
+
+    static const key_type& get_key(const stored_type& st)
+    {
+        return st.first;
+    }
+};
 }
 }
 #endif
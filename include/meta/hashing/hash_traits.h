@@ -121,6 +121,39 @@ struct hash_traits<kv_pair<K, V>>
         typename std::conditional<key_traits<K>::inlineable,
                                   key_inlineable_probe_entry, hash_idx>::type;
 };
+
+/**
+ * An alternative traits class that selects the tagged ("Swiss table")
+ * storage classes, which keep a separate one-byte-tag metadata array and
+ * screen 16 slots per probe with a single SIMD compare before touching
+ * any full entries. Since occupancy is tracked by the tags, no sentinel
+ * key value is sacrificed, so these work for any key type (including
+ * non-inlineable ones, whose entries are still stored in the table).
+ *
+ * Use with a group-aligned probing strategy (probing::group_linear); see
+ * the group_probe_map and group_probe_set aliases.
+ */
+template <class T>
+struct tagged_hash_traits
+{
+    template <class ProbingStrategy, class Hash, class KeyEqual>
+    using storage_type = tagged_key_storage<T, ProbingStrategy, Hash, KeyEqual>;
+
+    using probe_entry = T;
+};
+
+/**
+ * Specialization of tagged_hash_traits for the hash *table* classes.
+ */
+template <class K, class V>
+struct tagged_hash_traits<kv_pair<K, V>>
+{
+    template <class ProbingStrategy, class Hash, class KeyEqual>
+    using storage_type
+        = tagged_key_value_storage<K, V, ProbingStrategy, Hash, KeyEqual>;
+
+    using probe_entry = std::pair<K, V>;
+};
 }
 }
 #endif
@@ -0,0 +1,150 @@
+/**
+ * @file hyperloglog.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_HASHING_HYPERLOGLOG_H_
+#define META_HASHING_HYPERLOGLOG_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/hashing/hash.h"
+
+namespace meta
+{
+namespace hashing
+{
+
+/**
+ * A HyperLogLog sketch for estimating the number of distinct keys in a
+ * stream using a small, fixed amount of memory. The typical use in the
+ * toolkit is to maintain a sketch alongside a counting probe_map and
+ * periodically reserve() the map to the estimated cardinality, turning
+ * the element-wise rehash storms of a large counting loop into (at most)
+ * a handful of resizes.
+ *
+ * The standard error of the estimate is roughly \f$1.04/\sqrt{2^p}\f$
+ * for precision \f$p\f$ (about 1.6% at the default precision of 12,
+ * which uses 4 KiB of registers).
+ *
+ * @see http://algo.inria.fr/flajolet/Publications/FlFuGaMe07.pdf
+ */
+template <class K, class Hash = hash<>>
+class hyperloglog
+{
+  public:
+    /**
+     * @param precision The log2 of the number of registers to maintain
+     */
+    hyperloglog(uint8_t precision = 12)
+        : precision_{precision},
+          registers_(std::size_t{1} << precision, 0)
+    {
+        // nothing
+    }
+
+    /**
+     * Observes a key from the stream. Safe to call any number of times
+     * per key; only distinct keys affect the estimate.
+     * @param key The key observed
+     */
+    void insert(const K& key)
+    {
+        auto hc = static_cast<uint64_t>(hash_(key));
+        auto reg = hc >> (64 - precision_);
+        // rank of the leftmost one bit in the remaining hash bits
+        auto rest = hc << precision_;
+        auto rho = rest ? static_cast<uint8_t>(leading_zeroes(rest) + 1)
+                        : static_cast<uint8_t>(64 - precision_ + 1);
+        if (rho > registers_[reg])
+            registers_[reg] = rho;
+    }
+
+    /**
+     * @return the estimated number of distinct keys observed so far
+     */
+    double estimate() const
+    {
+        double sum = 0;
+        std::size_t zeros = 0;
+        for (auto reg : registers_)
+        {
+            sum += std::ldexp(1.0, -reg);
+            zeros += reg == 0;
+        }
+
+        auto m = static_cast<double>(registers_.size());
+        auto raw = alpha(registers_.size()) * m * m / sum;
+
+        // small-range correction: fall back to linear counting while
+        // some registers are still untouched
+        if (raw <= 2.5 * m && zeros > 0)
+            return m * std::log(m / zeros);
+        return raw;
+    }
+
+    /**
+     * Merges another sketch over the same key space into this one, as
+     * if this sketch had observed both streams. The two sketches must
+     * have the same precision.
+     * @param other The sketch to merge in
+     */
+    void merge(const hyperloglog& other)
+    {
+        for (std::size_t i = 0; i < registers_.size(); ++i)
+        {
+            if (other.registers_[i] > registers_[i])
+                registers_[i] = other.registers_[i];
+        }
+    }
+
+    std::size_t bytes_used() const
+    {
+        return registers_.capacity() + sizeof(precision_);
+    }
+
+  private:
+    static uint64_t leading_zeroes(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint64_t>(__builtin_clzll(word));
+#else
+        uint64_t count = 0;
+        for (uint64_t bit = uint64_t{1} << 63; bit && !(word & bit); bit >>= 1)
+            ++count;
+        return count;
+#endif
+    }
+
+    /**
+     * @return the bias correction constant for the given register count
+     */
+    static double alpha(std::size_t m)
+    {
+        switch (m)
+        {
+            case 16:
+                return 0.673;
+            case 32:
+                return 0.697;
+            case 64:
+                return 0.709;
+            default:
+                return 0.7213 / (1.0 + 1.079 / static_cast<double>(m));
+        }
+    }
+
+    Hash hash_;
+    uint8_t precision_;
+    std::vector<uint8_t> registers_;
+};
+}
+}
+#endif
@@ -41,8 +41,10 @@ namespace hashing
  *    and spilling chunks to disk when full
  * 2. Merge chunks and records by the bucket id
  * 3. Sort each bucket by size, writing chunks to disk when buffer is full
- * 4. Merge chunks (no record merging)
- * 5. Find appropriate seed values for each bucket
+ * 4. Merge chunks (no record merging), streaming the size-ordered
+ *    buckets directly into the seed search, which speculatively probes
+ *    seeds for batches of buckets in parallel and commits them in order
+ * 5. (folded into step 4)
  * 6. Compress the seed values
  * 7. Compress the perfect hash function found into a minimal perfect hash
  *
@@ -94,7 +96,6 @@ class perfect_hash_builder
     template <class Iterator>
     void flush_bucket_chunk(Iterator begin, Iterator end);
 
-    void merge_chunks_by_bucket_size();
     void sort_buckets_by_size();
     void construct_perfect_hash();
 
@@ -16,6 +16,7 @@
 #include "meta/io/moveable_stream.h"
 #include "meta/io/packed.h"
 #include "meta/logging/logger.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/succinct/compressed_vector.h"
 #include "meta/succinct/sarray.h"
 #include "meta/util/array_view.h"
@@ -152,7 +153,6 @@ void perfect_hash_builder<K>::write()
 
     merge_chunks_by_bucket_id();
     sort_buckets_by_size();
-    merge_chunks_by_bucket_size();
     construct_perfect_hash();
 
     filesystem::delete_file(opts_.prefix + "/buckets.bin");
@@ -267,44 +267,6 @@ void perfect_hash_builder<K>::flush_bucket_chunk(Iterator begin, Iterator end)
     ++num_chunks_;
 }
 
-template <class K>
-void perfect_hash_builder<K>::merge_chunks_by_bucket_size()
-{
-    std::vector<mph::chunk_iterator<K>> iterators;
-    for (uint64_t i = 0; i < num_chunks_; ++i)
-    {
-        iterators.emplace_back(opts_.prefix + "/chunk-" + std::to_string(i)
-                               + ".bin");
-    }
-
-    std::ofstream output{opts_.prefix + "/buckets.bin", std::ios::binary};
-    util::multiway_merge(
-        iterators.begin(), iterators.end(),
-        // sort records at head of chunks by their size
-        // (descending) rather than their bucket index
-        [](const mph::bucket_record<K>& a, const mph::bucket_record<K>& b)
-        {
-            return a.keys.size() > b.keys.size();
-        },
-        // never merge two records together
-        [](const mph::bucket_record<K>&, const mph::bucket_record<K>&)
-        {
-            return false;
-        },
-        [&](mph::bucket_record<K>&& bucket)
-        {
-            io::packed::write(output, bucket);
-        });
-
-    // delete temporary files
-    for (uint64_t i = 0; i < num_chunks_; ++i)
-    {
-        filesystem::delete_file(opts_.prefix + "/chunk-" + std::to_string(i)
-                                + ".bin");
-    }
-    num_chunks_ = 0;
-}
-
 namespace mph
 {
 template <class K>
@@ -333,6 +295,51 @@ void hashes_to_indices(ForwardIterator begin, ForwardIterator end,
                    });
 }
 
+/**
+ * A bucket along with the state the speculative seed search computes for
+ * it: the (sorted) hashes of its keys and the first seed that was viable
+ * against the occupancy bitmap at the time the search ran.
+ */
+template <class K>
+struct prepared_bucket
+{
+    bucket_record<K> bucket;
+    std::vector<uint64_t> hashes;
+    uint16_t candidate = 0;
+};
+
+/**
+ * Finds the first seed whose slot assignments for this bucket are
+ * pairwise distinct and all unoccupied in the given snapshot of the
+ * occupancy bitmap. Since committed buckets only ever *add* occupied
+ * slots, any seed rejected against the snapshot would also be rejected
+ * later, so the serial commit pass can resume its search from the
+ * returned candidate and still produce exactly the sequential result.
+ *
+ * @return the candidate seed, or 0 if none was viable (the commit pass
+ * will then rediscover the failure and throw)
+ */
+inline uint16_t find_candidate_seed(const std::vector<uint64_t>& hashes,
+                                    const std::vector<bool>& occupied_slots,
+                                    std::size_t num_bins)
+{
+    std::vector<uint64_t> indices(hashes.size());
+    const uint32_t max_probes = std::numeric_limits<uint16_t>::max();
+    for (uint32_t i = 0; i < max_probes; ++i)
+    {
+        hashes_to_indices(hashes.begin(), hashes.end(), indices.begin(), i,
+                          num_bins);
+        std::sort(indices.begin(), indices.end());
+        bool viable = std::adjacent_find(indices.begin(), indices.end())
+                      == indices.end();
+        for (auto it = indices.begin(); viable && it != indices.end(); ++it)
+            viable = !occupied_slots[*it];
+        if (viable)
+            return static_cast<uint16_t>(i);
+    }
+    return 0;
+}
+
 inline bool insert_bucket(std::vector<uint64_t>& indices,
                           std::vector<bool>& occupied_slots, uint64_t idx,
                           uint16_t seed, util::disk_vector<uint16_t>& seeds)
@@ -374,36 +381,127 @@ void perfect_hash_builder<K>::construct_perfect_hash()
                                           num_buckets_};
 
         {
-            mph::chunk_iterator<K> it{opts_.prefix + "/buckets.bin"};
-            printing::progress progress{" > Constructing hash: ",
-                                        it.total_bytes()};
-            for (; it != mph::chunk_iterator<K>{}; ++it)
+            // the seed search consumes the size-sorted chunks directly
+            // from the merge rather than materializing them into a
+            // buckets file first, so only a batch's worth of keys is
+            // ever resident
+            std::vector<mph::chunk_iterator<K>> iterators;
+            for (uint64_t i = 0; i < num_chunks_; ++i)
+                iterators.emplace_back(opts_.prefix + "/chunk-"
+                                       + std::to_string(i) + ".bin");
+
+            parallel::thread_pool pool;
+            std::vector<mph::prepared_bucket<K>> current;
+            std::vector<mph::prepared_bucket<K>> incoming;
+            std::vector<std::future<void>> futures;
+            const std::size_t batch_size
+                = std::max<std::size_t>(1024, 64 * pool.size());
+            current.reserve(batch_size);
+            incoming.reserve(batch_size);
+
+            // hash each bucket's keys and speculatively search for its
+            // first viable seed in parallel; the occupancy bitmap is only
+            // read here, and only between commit passes
+            auto speculate = [&](std::vector<mph::prepared_bucket<K>>& batch)
             {
-                progress(it.bytes_read());
-                const auto& bucket = *it;
-
-                auto hashes = mph::hashes_for_bucket(bucket, bucket_seed_);
-
-                std::vector<uint64_t> indices(bucket.keys.size());
-                bool success = false;
-                const uint16_t max_probes
-                    = std::numeric_limits<uint16_t>::max();
-                for (uint16_t i = 0; i < max_probes && !success; ++i)
+                auto num_tasks = std::max<std::size_t>(pool.size(), 1);
+                auto stride = (batch.size() + num_tasks - 1) / num_tasks;
+                for (std::size_t t = 0; t * stride < batch.size(); ++t)
                 {
-                    auto seed = static_cast<uint64_t>(i);
+                    auto begin = t * stride;
+                    auto end = std::min(begin + stride, batch.size());
+                    futures.emplace_back(pool.submit_task(
+                        [&, begin, end]()
+                        {
+                            for (auto i = begin; i < end; ++i)
+                            {
+                                auto& prep = batch[i];
+                                prep.hashes = mph::hashes_for_bucket(
+                                    prep.bucket, bucket_seed_);
+                                prep.candidate = mph::find_candidate_seed(
+                                    prep.hashes, occupied_slots, num_bins);
+                            }
+                        }));
+                }
+            };
 
-                    mph::hashes_to_indices(hashes.begin(), hashes.end(),
-                                           indices.begin(), seed, num_bins);
+            // commit a speculated batch in bucket order; since occupancy
+            // only grows, resuming each search from the speculative
+            // candidate yields exactly the seeds the serial algorithm
+            // would have found
+            auto commit = [&](std::vector<mph::prepared_bucket<K>>& batch)
+            {
+                for (auto& fut : futures)
+                    fut.get();
+                futures.clear();
 
-                    success = mph::insert_bucket(indices, occupied_slots,
-                                                 bucket.idx, i, seeds);
+                std::vector<uint64_t> indices;
+                for (auto& prep : batch)
+                {
+                    indices.resize(prep.hashes.size());
+                    bool success = false;
+                    const uint32_t max_probes
+                        = std::numeric_limits<uint16_t>::max();
+                    for (uint32_t i = prep.candidate; i < max_probes && !success;
+                         ++i)
+                    {
+                        mph::hashes_to_indices(prep.hashes.begin(),
+                                               prep.hashes.end(),
+                                               indices.begin(), i, num_bins);
+
+                        success = mph::insert_bucket(
+                            indices, occupied_slots, prep.bucket.idx,
+                            static_cast<uint16_t>(i), seeds);
+                    }
+                    if (!success)
+                        throw std::runtime_error{
+                            "could not find a seed for a bucket in "
+                            "minimal perfect hash generation"};
                 }
-                if (!success)
-                    throw std::runtime_error{
-                        "could not find a seed for a bucket in "
-                        "minimal perfect hash generation"};
-            }
+                batch.clear();
+            };
+
+            util::multiway_merge(
+                iterators.begin(), iterators.end(),
+                // sort records at head of chunks by their size
+                // (descending) rather than their bucket index
+                [](const mph::bucket_record<K>& a,
+                   const mph::bucket_record<K>& b)
+                {
+                    return a.keys.size() > b.keys.size();
+                },
+                // never merge two records together
+                [](const mph::bucket_record<K>&, const mph::bucket_record<K>&)
+                {
+                    return false;
+                },
+                [&](mph::bucket_record<K>&& bucket)
+                {
+                    incoming.emplace_back();
+                    incoming.back().bucket = std::move(bucket);
+                    if (incoming.size() == batch_size)
+                    {
+                        // the speculation launched for the previous batch
+                        // ran while the merge above buffered this one
+                        commit(current);
+                        std::swap(current, incoming);
+                        speculate(current);
+                    }
+                });
+
+            commit(current);
+            std::swap(current, incoming);
+            speculate(current);
+            commit(current);
+        }
+
+        // delete temporary files
+        for (uint64_t i = 0; i < num_chunks_; ++i)
+        {
+            filesystem::delete_file(opts_.prefix + "/chunk-"
+                                    + std::to_string(i) + ".bin");
         }
+        num_chunks_ = 0;
 
         LOG(progress) << "> Compressing seeds...\n" << ENDLG;
 
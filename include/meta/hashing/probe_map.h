@@ -65,6 +65,7 @@ class probe_map
     using storage_type::clear;
     using storage_type::bytes_used;
     using storage_type::extract;
+    using storage_type::reserve;
 
     probe_map() : storage_type{8}
     {
@@ -81,6 +82,37 @@ class probe_map
         return emplace(key, value);
     }
 
+    /**
+     * Adds delta to the value stored for key, inserting the key if it
+     * is absent, using a single probe sequence rather than the find +
+     * emplace pair (two probe sequences) that counting loops otherwise
+     * perform through operator[].
+     *
+     * @param key The key whose count should be increased
+     * @param delta The amount to add to the key's value
+     * @return a reference to the updated value
+     */
+    Value& insert_or_add(const Key& key, const Value& delta)
+    {
+        auto hc = storage_type::hash(key);
+        auto idx = storage_type::get_idx(key, hc);
+        if (storage_type::occupied(idx))
+        {
+            auto pr = storage_type::operator[](idx);
+            pr.value() += delta;
+            return pr.value();
+        }
+
+        // new key: a resize invalidates the probed index
+        if (next_load_factor() >= max_load_factor())
+        {
+            storage_type::resize(next_size());
+            idx = storage_type::get_idx(key, hc);
+        }
+        storage_type::put(idx, hc, key, delta);
+        return storage_type::operator[](idx).value();
+    }
+
     Value& operator[](const Key& key)
     {
         auto it = find(key);
@@ -119,6 +151,21 @@ class probe_map
         return it->value();
     }
 };
+
+/**
+ * A probe_map backed by the tagged ("Swiss table") storage: a separate
+ * one-byte-tag metadata array is probed 16 slots at a time with a single
+ * SIMD compare, so most probes never touch a full entry. Most effective
+ * for inlineable keys and miss-heavy workloads (e.g. cooccurrence
+ * counting), where the tag screen replaces a walk over full entries; for
+ * non-inlineable keys like std::string, the default storage's dense side
+ * array and cached-hash screening is usually at least as fast for hits.
+ */
+template <class Key, class Value, class Hash = hash<>,
+          class KeyEqual = std::equal_to<Key>>
+using group_probe_map
+    = probe_map<Key, Value, probing::group_linear, Hash, KeyEqual,
+                tagged_hash_traits<kv_pair<Key, Value>>>;
 }
 }
 #endif
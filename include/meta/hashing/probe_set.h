@@ -68,6 +68,7 @@ class probe_set
     using storage_type::clear;
     using storage_type::bytes_used;
     using storage_type::extract_keys;
+    using storage_type::reserve;
 
     probe_set() : storage_type{8}
     {
@@ -83,6 +84,19 @@ class probe_set
         return emplace(key);
     }
 };
+
+/**
+ * A probe_set backed by the tagged ("Swiss table") storage: a separate
+ * one-byte-tag metadata array is probed 16 slots at a time with a single
+ * SIMD compare, so most probes never touch a full entry. Most effective
+ * for inlineable keys and miss-heavy workloads, where the tag screen
+ * replaces a walk over full entries; for non-inlineable keys like
+ * std::string, the default storage's dense side array and cached-hash
+ * screening is usually at least as fast for hits.
+ */
+template <class Key, class Hash = hash<>, class KeyEqual = std::equal_to<Key>>
+using group_probe_set = probe_set<Key, probing::group_linear, Hash, KeyEqual,
+                                  tagged_hash_traits<Key>>;
 }
 }
 #endif
@@ -147,6 +147,49 @@ class binary_hybrid
     std::size_t max_;
 };
 
+/**
+ * Probes the table in aligned groups of 16 slots, yielding the index of
+ * the first slot of each group in linear group order. This is the
+ * strategy the tagged ("Swiss table") storage classes expect: they
+ * screen all 16 slots of the returned group against a one-byte tag at
+ * once before comparing any keys, so the per-group step costs one SIMD
+ * compare rather than 16 entry probes.
+ *
+ * @note The capacity must be a multiple of the group size (the tagged
+ * storage classes guarantee this).
+ */
+class group_linear
+{
+  public:
+    constexpr static std::size_t group_size()
+    {
+        return 16;
+    }
+
+    group_linear(std::size_t hash, std::size_t capacity)
+        : num_groups_{capacity / group_size()}
+    {
+        // the low seven bits of the hash form the tag, so group
+        // placement uses the remaining bits
+        group_ = (hash >> 7) % num_groups_;
+    }
+
+    /**
+     * @return the index of the first slot of the next group to probe
+     */
+    std::size_t probe()
+    {
+        auto idx = group_ * group_size();
+        if (++group_ == num_groups_)
+            group_ = 0;
+        return idx;
+    }
+
+  private:
+    std::size_t group_;
+    std::size_t num_groups_;
+};
+
 // http://stackoverflow.com/questions/2348187
 //     /moving-from-linear-probing-to-quadratic-probing-hash-collisons
 class quadratic
@@ -27,6 +27,11 @@ namespace index
 /**
  * Decorator class for wrapping indexes with a cache. Like other indexes,
  * you shouldn't construct this directly, but rather use make_index().
+ *
+ * For multi-threaded query serving, caching::concurrent_cache is the
+ * recommended Cache: its find() takes no locks, while splay_cache
+ * serializes every lookup on a global mutex (and mutates the tree even
+ * on reads).
  */
 template <class Index, template <class, class> class Cache>
 class cached_index : public Index
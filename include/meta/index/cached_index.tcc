@@ -4,6 +4,7 @@
  */
 
 #include "meta/index/cached_index.h"
+#include "meta/index/ranker/query_stats.h"
 
 namespace meta
 {
@@ -25,7 +26,11 @@ auto cached_index<Index, Cache>::search_primary(primary_key_type p_id) const
 {
     auto opt = cache_.find(p_id);
     if (opt)
+    {
+        query_stats::record_count(query_stats::counter::cache_hits);
         return *opt;
+    }
+    query_stats::record_count(query_stats::counter::cache_misses);
     auto result = Index::search_primary(p_id);
     cache_.insert(p_id, result);
     return result;
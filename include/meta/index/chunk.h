@@ -67,6 +67,18 @@ class chunk
     /// Calculates the size of the file this chunk represents in bytes.
     void set_size();
 
+    /// @return whether this chunk is Zstandard-compressed on disk,
+    /// determined by its filename suffix
+    bool compressed() const;
+
+    /**
+     * Streams the merge of this chunk's on-disk postings with the given
+     * in-memory postings into the output stream.
+     */
+    template <class InputStream, class OutputStream, class Container>
+    void merge_into(InputStream& my_data, OutputStream& output,
+                    Container& pdata);
+
     /// The path to this chunk file on disk
     std::string path_;
 
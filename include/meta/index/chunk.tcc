@@ -7,6 +7,9 @@
 #include "meta/index/postings_data.h"
 
 #include "meta/io/filesystem.h"
+#if META_HAS_ZSTD
+#include "meta/io/zstdstream.h"
+#endif
 
 namespace meta
 {
@@ -45,15 +48,47 @@ uint64_t chunk<PrimaryKey, SecondaryKey>::size() const
     return size_;
 }
 
+template <class PrimaryKey, class SecondaryKey>
+bool chunk<PrimaryKey, SecondaryKey>::compressed() const
+{
+    return path_.size() > 4
+           && path_.compare(path_.size() - 4, 4, ".zst") == 0;
+}
+
 template <class PrimaryKey, class SecondaryKey>
 template <class Container>
 void chunk<PrimaryKey, SecondaryKey>::memory_merge_with(Container& pdata)
 {
     std::string temp_name = path_ + "_merge";
 
-    std::ifstream my_data{path_, std::ios::binary};
-    std::ofstream output{temp_name, std::ios::binary};
+#if META_HAS_ZSTD
+    if (compressed())
+    {
+        io::zstdifstream my_data{path_};
+        io::zstdofstream output{temp_name};
+        merge_into(my_data, output, pdata);
+    }
+    else
+#endif
+    {
+        std::ifstream my_data{path_, std::ios::binary};
+        std::ofstream output{temp_name, std::ios::binary};
+        merge_into(my_data, output, pdata);
+    }
+
+    filesystem::delete_file(path_);
+    filesystem::rename_file(temp_name, path_);
+    pdata.clear();
 
+    set_size();
+}
+
+template <class PrimaryKey, class SecondaryKey>
+template <class InputStream, class OutputStream, class Container>
+void chunk<PrimaryKey, SecondaryKey>::merge_into(InputStream& my_data,
+                                                 OutputStream& output,
+                                                 Container& pdata)
+{
     postings_data<PrimaryKey, SecondaryKey> my_pd;
     my_pd.read_packed(my_data);
     auto other_pd = pdata.begin();
@@ -94,14 +129,6 @@ void chunk<PrimaryKey, SecondaryKey>::memory_merge_with(Container& pdata)
         other_pd->write_packed(output);
         ++other_pd;
     }
-
-    my_data.close();
-    output.close();
-    filesystem::delete_file(path_);
-    filesystem::rename_file(temp_name, path_);
-    pdata.clear();
-
-    set_size();
 }
 }
 }
@@ -118,9 +118,10 @@ using chunk_reader
  *  paths
  * @return the total number of unique primary keys found during the merging
  */
-template <class PostingsData, class ForwardIterator>
+template <class PostingsData, class ForwardIterator,
+          class ProgressTrait = printing::default_progress_trait>
 uint64_t multiway_merge(std::ostream& outstream, ForwardIterator begin,
-                        ForwardIterator end)
+                        ForwardIterator end, ProgressTrait = ProgressTrait{})
 {
     using input_chunk = chunk_reader<PostingsData>;
     std::vector<input_chunk> to_merge;
@@ -130,7 +131,8 @@ uint64_t multiway_merge(std::ostream& outstream, ForwardIterator begin,
 
     return util::multiway_merge(
         to_merge.begin(), to_merge.end(),
-        [&](PostingsData&& pdata) { pdata.write_packed(outstream); });
+        [&](PostingsData&& pdata) { pdata.write_packed(outstream); },
+        ProgressTrait{});
 }
 }
 }
@@ -63,6 +63,15 @@ class disk_index
      */
     std::string index_name() const;
 
+    /**
+     * Eagerly loads every index component. Components are otherwise
+     * initialized lazily on first access, so opening an index is nearly
+     * instant (useful for health checks and rolling restarts); callers
+     * that want the load paid up front — possibly from a background
+     * thread — should invoke this after make_index().
+     */
+    virtual void warm_up() const;
+
     /**
      * @return the number of documents in this index
      */
@@ -164,6 +173,17 @@ class disk_index
      */
     term_id get_term_id(const std::string& term);
 
+    /**
+     * Resolves a batch of terms to ids in one call, taking the
+     * vocabulary lock once and probing the vocabulary map in sorted
+     * term order (see vocabulary_map::find_batch()).
+     *
+     * @param terms The terms to resolve
+     * @return the term_id for each term, in input order;
+     * out-of-vocabulary terms map to unique_terms()
+     */
+    std::vector<term_id> get_term_ids(const std::vector<std::string>& terms);
+
     /**
      * @param t_id The term_id to get the original text for
      * @return the string representation of the term
@@ -40,7 +40,9 @@ enum index_file
     TERM_IDS_MAPPING,
     TERM_IDS_MAPPING_INVERSE,
     METADATA_DB,
-    METADATA_INDEX
+    METADATA_INDEX,
+    METADATA_LENGTHS,
+    METADATA_UNIQUE_TERMS
 };
 
 /**
@@ -60,18 +62,42 @@ class disk_index::disk_index_impl
     /**
      * Loads the metadata file.
      */
-    void initialize_metadata();
+    void initialize_metadata() const;
 
     /**
      * Loads the doc labels.
      * @param num_docs The number of documents stored in the index
      */
-    void load_labels();
+    void load_labels() const;
 
     /**
      * Loads the term_id mapping.
      */
-    void load_term_id_mapping();
+    void load_term_id_mapping() const;
+
+    /**
+     * Ensures the metadata file is loaded, loading it on first use.
+     * Components are initialized lazily so that opening an index is
+     * nearly instant; only the accessors that actually touch a
+     * component pay for its load.
+     */
+    void ensure_metadata() const;
+
+    /**
+     * Ensures the doc labels are loaded, loading them on first use.
+     */
+    void ensure_labels() const;
+
+    /**
+     * Ensures the term_id mapping is loaded, loading it on first use.
+     */
+    void ensure_term_id_mapping() const;
+
+    /**
+     * Eagerly loads every lazily initialized component, for callers
+     * that want load time paid up front rather than on first access.
+     */
+    void warm_up() const;
 
     /**
      * Loads the label_id mapping.
@@ -113,14 +139,21 @@ class disk_index::disk_index_impl
     /**
      * Maps which class a document belongs to (if any).
      * Each index corresponds to a doc_id (uint64_t).
+     * Mutable (along with the other components and their once flags)
+     * because loading happens lazily from const accessors.
      */
-    util::optional<util::disk_vector<const label_id>> labels_;
+    mutable util::optional<util::disk_vector<const label_id>> labels_;
 
     /// Stores additional metadata for each document
-    util::optional<metadata_file> metadata_;
+    mutable util::optional<metadata_file> metadata_;
 
     /// Maps string terms to term_ids.
-    util::optional<vocabulary_map> term_id_mapping_;
+    mutable util::optional<vocabulary_map> term_id_mapping_;
+
+    /// guards the lazy one-time load of each component
+    mutable std::once_flag labels_init_;
+    mutable std::once_flag metadata_init_;
+    mutable std::once_flag term_id_init_;
 
     /// Assigns an integer to each class label (used for liblinear mappings)
     util::invertible_map<class_label, label_id> label_ids_;
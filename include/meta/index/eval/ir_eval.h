@@ -9,6 +9,8 @@
 #ifndef META_IR_EVAL_H_
 #define META_IR_EVAL_H_
 
+#include <chrono>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
@@ -18,6 +20,8 @@
 #include <vector>
 #include "meta/index/ranker/ranker.h"
 #include "meta/meta.h"
+#include "meta/parallel/thread_pool.h"
+#include "meta/util/time.h"
 
 namespace meta
 {
@@ -33,6 +37,46 @@ class ir_eval
   public:
     using result_type = std::vector<search_result>;
 
+    /**
+     * Statistics for a single query scored by evaluate_batch().
+     */
+    struct query_eval
+    {
+        /// The id of the judged query
+        query_id qid;
+        /// The average precision
+        double avg_p;
+        /// The Normalized Discounted Cumulative Gain
+        double ndcg;
+        /// The F1 score
+        double f1;
+        /// The scoring latency for this query
+        std::chrono::microseconds latency;
+    };
+
+    /**
+     * The results of evaluate_batch(): per-query statistics plus
+     * aggregates computed over them.
+     */
+    struct batch_results
+    {
+        /// The per-query statistics, in query order
+        std::vector<query_eval> queries;
+        /// The Mean Average Precision over the batch
+        double map;
+        /// The Geometric Mean Average Precision over the batch
+        double gmap;
+        /// The mean NDCG over the batch
+        double avg_ndcg;
+
+        /**
+         * @param pct The percentile, in [0, 100]
+         * @return the nearest-rank query latency percentile over the
+         * batch
+         */
+        std::chrono::microseconds latency_percentile(double pct) const;
+    };
+
     /**
      * @param config Configuration group
      */
@@ -122,6 +166,92 @@ class ir_eval
      */
     void reset_stats();
 
+    /**
+     * Scores and judges a whole query batch, sharding the queries across
+     * the given thread pool like ranker::score_batch() but additionally
+     * timing each query. The per-query measures are computed in the
+     * workers from preaggregated judgment maps and the batch aggregates
+     * (MAP, gMAP, mean NDCG) from those per-query statistics, so the
+     * saved scores used by map()/gmap() are untouched. Query ids are
+     * assigned sequentially from first_query in iteration order.
+     *
+     * @param rnk The ranker to score with
+     * @param idx The index the queries run against
+     * @param begin A forward iterator to the beginning of a range of
+     * corpus::document queries
+     * @param end A forward iterator to the end of the above range
+     * @param first_query The query id of the first query in the range
+     * @param pool The thread pool to shard the queries across
+     * @param num_results The number of results to retrieve per query
+     * (which also caps the @k of each measure)
+     * @return the per-query and aggregate statistics for the batch
+     */
+    template <class ForwardIterator>
+    batch_results evaluate_batch(ranker& rnk, inverted_index& idx,
+                                 ForwardIterator begin, ForwardIterator end,
+                                 query_id first_query,
+                                 parallel::thread_pool& pool,
+                                 uint64_t num_results = 10) const
+    {
+        auto num_queries
+            = static_cast<std::size_t>(std::distance(begin, end));
+        std::vector<result_type> rankings(num_queries);
+        std::vector<std::chrono::microseconds> latencies(num_queries);
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(num_queries);
+        std::size_t pos = 0;
+        for (auto query = begin; query != end; ++query, ++pos)
+        {
+            futures.emplace_back(pool.submit_task([&, query, pos]() {
+                latencies[pos] = common::time<std::chrono::microseconds>(
+                    [&]() {
+                        rankings[pos] = rnk.score(idx, *query, num_results);
+                    });
+            }));
+        }
+        for (auto& fut : futures)
+            fut.get();
+
+        return judge_batch(rankings, first_query, latencies, num_results,
+                           pool);
+    }
+
+    /**
+     * Judges a batch of pre-computed rankings (e.g. the output of
+     * ranker::score_batch()), computing the per-query measures in
+     * parallel and the batch aggregates from them. Query ids are
+     * assigned sequentially from first_query in ranking order.
+     *
+     * @param rankings The ranked result list for each query
+     * @param first_query The query id of the first ranking
+     * @param latencies The per-query scoring latencies, if measured
+     * (may be empty)
+     * @param num_docs The @k cutoff for each measure
+     * @param pool The thread pool to judge the queries on
+     * @return the per-query and aggregate statistics for the batch
+     */
+    batch_results
+    judge_batch(const std::vector<result_type>& rankings, query_id first_query,
+                const std::vector<std::chrono::microseconds>& latencies,
+                uint64_t num_docs, parallel::thread_pool& pool) const;
+
+    /**
+     * Scores and judges a whole query batch on a thread pool sized to
+     * the hardware concurrency.
+     * @see evaluate_batch()
+     */
+    template <class ForwardIterator>
+    batch_results evaluate_batch(ranker& rnk, inverted_index& idx,
+                                 ForwardIterator begin, ForwardIterator end,
+                                 query_id first_query,
+                                 uint64_t num_results = 10) const
+    {
+        parallel::thread_pool pool;
+        return evaluate_batch(rnk, idx, begin, end, first_query, pool,
+                              num_results);
+    }
+
   private:
     /**
      * query_id -> (doc_id -> relevance) mapping
@@ -145,6 +275,20 @@ class ir_eval
      */
     double relevant_retrieved(const result_type& results, query_id q_id,
                               uint64_t num_docs) const;
+
+    /**
+     * Computes the average precision for a query without recording it
+     * for map()/gmap(); this is what the (thread-safe) batch driver
+     * uses.
+     */
+    double avg_p_value(const result_type& results, query_id q_id,
+                       uint64_t num_docs) const;
+
+    /**
+     * Computes the aggregate measures of a batch from its per-query
+     * statistics.
+     */
+    void finalize_batch(batch_results& batch) const;
 };
 
 /**
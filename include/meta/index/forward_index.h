@@ -133,6 +133,27 @@ class forward_index : public disk_index
     util::optional<postings_stream<term_id, double>>
     stream_for(doc_id d_id) const;
 
+    /**
+     * Hints to the OS that the postings file will be scanned in doc_id
+     * order, enabling aggressive readahead for sequential consumers like
+     * learn::instance_stream.
+     */
+    void advise_sequential() const;
+
+    /**
+     * Pins the compressed postings file into memory if it fits within
+     * the given budget. Consumers that sweep every document repeatedly
+     * (topic model training, feature selection) then decode postings
+     * straight from RAM with stream_for() instead of taking page-cache
+     * faults on every pass, while the resident footprint stays at the
+     * compressed size.
+     *
+     * @param ram_budget The maximum number of bytes to spend on the
+     * in-memory copy
+     * @return whether the postings are now memory-resident
+     */
+    bool pin_postings(uint64_t ram_budget);
+
     /**
      * @param d_id The document id of the doc to convert to liblinear format
      * @return the string representation liblinear format
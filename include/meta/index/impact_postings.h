@@ -0,0 +1,223 @@
+/**
+ * @file impact_postings.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_IMPACT_POSTINGS_H_
+#define META_INDEX_IMPACT_POSTINGS_H_
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/ranker.h"
+#include "meta/io/mmap_file.h"
+#include "meta/util/disk_vector.h"
+#include "meta/util/optional.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * Uniformly quantizes floating point term impact scores onto a small
+ * integer range so that postings can be stored ordered by impact and
+ * accumulated with integer additions at query time.
+ */
+class impact_quantizer
+{
+  public:
+    /**
+     * @param max_score The largest score that will be quantized
+     * @param num_levels The number of quantization levels (at most 255)
+     */
+    impact_quantizer(float max_score, uint8_t num_levels = 255);
+
+    /**
+     * @param score The score to quantize
+     * @return the impact bucket for the score, in [1, num_levels]
+     */
+    uint8_t quantize(float score) const;
+
+    /**
+     * @param impact The impact bucket
+     * @return the upper edge of the bucket's score range
+     */
+    float dequantize(uint8_t impact) const;
+
+    /**
+     * @return the number of quantization levels
+     */
+    uint8_t num_levels() const;
+
+    /**
+     * @return the maximum score this quantizer covers
+     */
+    float max_score() const;
+
+  private:
+    /// the largest score covered by the quantizer
+    float max_score_;
+    /// the number of quantization levels
+    uint8_t num_levels_;
+};
+
+/**
+ * Writes an impact-ordered postings file. Each list is stored as a
+ * sequence of bands in descending impact order; a band holds a single
+ * impact value followed by the gap-encoded, ascending doc ids that share
+ * it. A byte-location side file indexes the lists by term, mirroring
+ * postings_file_writer.
+ *
+ * Per-list layout: [num_bands] then, per band,
+ * [impact][num_docs][gap-encoded doc ids].
+ */
+class impact_postings_writer
+{
+  public:
+    /**
+     * Opens an impact postings file for writing.
+     * @param filename The filename (prefix) for the postings file
+     * @param unique_keys The number of lists that will be written
+     */
+    impact_postings_writer(const std::string& filename, uint64_t unique_keys);
+
+    /**
+     * Writes the postings for the next term. The postings are grouped
+     * into bands by impact; the input need not be sorted.
+     *
+     * @param postings The (doc id, impact) pairs for the term
+     */
+    void write(std::vector<std::pair<doc_id, uint8_t>>& postings);
+
+  private:
+    std::ofstream output_;
+    util::disk_vector<uint64_t> byte_locations_;
+    uint64_t byte_pos_;
+    uint64_t id_;
+};
+
+/**
+ * Read-only view over an impact-ordered postings file.
+ */
+class impact_postings_file
+{
+  public:
+    /**
+     * A cursor over the bands of a single impact-ordered list.
+     */
+    class stream
+    {
+      public:
+        /**
+         * Decodes the next band of the list into the given buffer.
+         *
+         * @param impact The impact shared by the decoded doc ids
+         * @param docs The buffer to decode the band's doc ids into
+         * @return whether a band was decoded
+         */
+        bool next_band(uint8_t& impact, std::vector<doc_id>& docs);
+
+        /**
+         * @return the impact of the next undecoded band, or 0 if the
+         * list is exhausted
+         */
+        uint8_t peek_impact() const;
+
+      private:
+        friend impact_postings_file;
+        stream(const char* buffer);
+
+        /// the current read position within the list
+        const char* pos_;
+        /// the number of bands remaining
+        uint64_t bands_left_;
+        /// the impact of the next band (0 when exhausted)
+        uint8_t next_impact_;
+    };
+
+    /**
+     * Opens an impact postings file.
+     * @param filename The path (prefix) to the file
+     */
+    impact_postings_file(const std::string& filename);
+
+    /**
+     * @param pk The term to look up
+     * @return a band cursor for the term, if it is in the file
+     */
+    util::optional<stream> find_stream(term_id pk) const;
+
+  private:
+    io::mmap_file postings_;
+    util::disk_vector<const uint64_t> byte_locations_;
+};
+
+/**
+ * Builds an impact-ordered postings file from an inverted index by
+ * scoring every posting with the given ranking function (at unit query
+ * term weight) and quantizing the scores uniformly. Two passes are made
+ * over the index: one to find the maximum score and one to write.
+ *
+ * @param idx The index to build from
+ * @param fn The ranking function whose score_one() defines the impacts
+ * @param filename The filename (prefix) for the impact postings file
+ * @param num_levels The number of quantization levels
+ * @return the quantizer used, for interpreting impacts at query time
+ */
+impact_quantizer build_impact_postings(inverted_index& idx,
+                                       ranking_function& fn,
+                                       const std::string& filename,
+                                       uint8_t num_levels = 255);
+
+/**
+ * Accumulator-based term-at-a-time scorer over impact-ordered postings.
+ * Bands are consumed in descending order of (impact x query term count)
+ * across all query terms, so scoring can be cut off after a postings
+ * budget while retaining the highest-impact contributions; results are
+ * approximate once a cutoff triggers, which is the intended trade for
+ * the latency-bound serving tier.
+ */
+class impact_scorer
+{
+  public:
+    /**
+     * @param postings The impact-ordered postings to score over
+     * @param num_docs The number of documents in the collection
+     */
+    impact_scorer(const impact_postings_file& postings, uint64_t num_docs);
+
+    /**
+     * Scores a query term-at-a-time.
+     *
+     * @param idx The index used to tokenize the query
+     * @param query The query to score
+     * @param num_results The number of results to return
+     * @param postings_budget The maximum number of postings to
+     * accumulate, or 0 for no budget
+     * @return the top documents in descending score order
+     */
+    std::vector<search_result> score(inverted_index& idx,
+                                     const corpus::document& query,
+                                     uint64_t num_results = 10,
+                                     uint64_t postings_budget = 0);
+
+  private:
+    /// the impact-ordered postings file
+    const impact_postings_file& postings_;
+    /// one integer accumulator per document, reused across queries
+    std::vector<uint32_t> accumulators_;
+    /// the documents touched by the current query
+    std::vector<doc_id> touched_;
+};
+}
+}
+#endif
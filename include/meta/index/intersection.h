@@ -0,0 +1,122 @@
+/**
+ * @file intersection.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_INTERSECTION_H_
+#define META_INDEX_INTERSECTION_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/corpus/document.h"
+#include "meta/index/postings_stream.h"
+#include "meta/index/ranker/ranker.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * Intersects a set of postings lists, returning the ids present in every
+ * list in ascending order.
+ *
+ * The lists are processed in ascending document-frequency order so the
+ * rarest list drives the search, and candidates are advanced with the
+ * iterators' skip_to(), which jumps over whole blocks via the inline skip
+ * table and then binary searches within a block. Intersecting a rare term
+ * with a common one therefore costs roughly the rare list's length in
+ * skips rather than a full scan of the common list.
+ *
+ * @param streams The postings lists to intersect
+ * @return the ids common to every list
+ */
+template <class SecondaryKey, class FeatureValue>
+std::vector<SecondaryKey>
+intersect(const std::vector<postings_stream<SecondaryKey, FeatureValue>>&
+              streams)
+{
+    std::vector<SecondaryKey> result;
+    if (streams.empty())
+        return result;
+
+    // rarest list first: it drives the candidates and bounds the result
+    std::vector<const postings_stream<SecondaryKey, FeatureValue>*> order;
+    order.reserve(streams.size());
+    for (const auto& s : streams)
+        order.push_back(&s);
+    std::sort(order.begin(), order.end(),
+              [](const postings_stream<SecondaryKey, FeatureValue>* lhs,
+                 const postings_stream<SecondaryKey, FeatureValue>* rhs) {
+                  return lhs->size() < rhs->size();
+              });
+
+    using iterator =
+        typename postings_stream<SecondaryKey, FeatureValue>::iterator;
+    iterator sentinel;
+
+    std::vector<iterator> its;
+    its.reserve(order.size());
+    for (const auto* s : order)
+    {
+        its.push_back(s->begin());
+        if (its.back() == sentinel)
+            return result;
+    }
+
+    auto candidate = its[0]->first;
+    std::size_t pos = 0;
+    std::size_t agree = 0;
+    while (true)
+    {
+        auto& it = its[pos];
+        it.skip_to(candidate);
+        if (it == sentinel)
+            return result;
+
+        if (it->first == candidate)
+        {
+            if (++agree == its.size())
+            {
+                result.push_back(candidate);
+                candidate
+                    = SecondaryKey{static_cast<uint64_t>(candidate) + 1};
+                agree = 0;
+            }
+        }
+        else
+        {
+            candidate = it->first;
+            agree = 1;
+        }
+        pos = (pos + 1) % its.size();
+    }
+}
+
+/**
+ * Conjunctive (AND-mode) query evaluation: only documents containing
+ * *every* analyzed query term are scored, using the same intersection
+ * strategy as intersect() and scoring each matching document with the
+ * given ranking function. Documents outside the intersection are never
+ * touched, so rare-term-plus-common-term queries cost far less than a
+ * full disjunctive evaluation.
+ *
+ * @param idx The index to evaluate against
+ * @param fn The ranking function used to score the intersection
+ * @param query The query to evaluate
+ * @param num_results The number of results to return
+ * @return the top documents in descending score order
+ */
+std::vector<search_result> conjunctive_score(inverted_index& idx,
+                                             ranking_function& fn,
+                                             const corpus::document& query,
+                                             uint64_t num_results = 10);
+}
+}
+#endif
@@ -131,6 +131,36 @@ class inverted_index : public disk_index
      */
     analyzers::feature_map<uint64_t> tokenize(const corpus::document& doc);
 
+    /**
+     * Eagerly loads every index component, including the postings file.
+     * @see disk_index::warm_up()
+     */
+    void warm_up() const override;
+
+    /**
+     * Compact per-term statistics kept in memory on scoring nodes so
+     * that score setup never has to parse a postings header just to
+     * read them.
+     */
+    struct term_stat
+    {
+        /// the number of documents the term appears in
+        uint64_t doc_count;
+        /// the total number of occurrences of the term
+        uint64_t corpus_term_count;
+        /// the largest in-document count of the term
+        uint64_t max_tf;
+    };
+
+    /**
+     * @param t_id The term to look up
+     * @return the in-memory statistics for the given term. The table is
+     * built on first access by one pass over the postings headers and
+     * costs 24 bytes per unique term; out-of-vocabulary ids return an
+     * all-zero entry.
+     */
+    const term_stat& term_stats(term_id t_id) const;
+
     /**
      * @param t_id The term_id to search for
      * @return the postings data for a given term_id
@@ -144,6 +174,13 @@ class inverted_index : public disk_index
      */
     util::optional<postings_stream<doc_id>> stream_for(term_id t_id) const;
 
+    /**
+     * Hints to the OS to begin reading the postings list for a term in
+     * the background; see postings_file::prefetch().
+     * @param t_id The term_id whose postings list should be read ahead
+     */
+    void prefetch(term_id t_id) const;
+
     /**
      * @param t_id The term to search for
      * @return the document frequency of a term (number of documents it
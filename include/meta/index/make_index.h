@@ -26,6 +26,11 @@ namespace index
 class inverted_index;
 class forward_index;
 
+/// Inverted index using the lock-free concurrent cache; recommended for
+/// multi-threaded query serving
+using concurrent_inverted_index
+    = cached_index<inverted_index, caching::concurrent_cache>;
+
 /// Inverted index using default DBLRU cache
 using dblru_inverted_index
     = cached_index<inverted_index, caching::default_dblru_cache>;
@@ -37,6 +42,10 @@ using splay_inverted_index = cached_index<inverted_index, caching::splay_cache>;
 using memory_forward_index
     = cached_index<forward_index, caching::no_evict_cache>;
 
+/// Forward index using the lock-free concurrent cache
+using concurrent_forward_index
+    = cached_index<forward_index, caching::concurrent_cache>;
+
 /// Forward index using default DBLRU cache
 using dblru_forward_index
     = cached_index<forward_index, caching::default_dblru_cache>;
@@ -0,0 +1,181 @@
+/**
+ * @file metadata_bitmap.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_INDEX_METADATA_BITMAP_H_
+#define META_INDEX_METADATA_BITMAP_H_
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "meta/meta.h"
+
+namespace meta
+{
+namespace index
+{
+
+class disk_index;
+
+/**
+ * A compressed set of document ids supporting membership tests and
+ * skipping, used to push document filters down into ranking. The
+ * document space is partitioned into chunks of 2^16 ids; sparse chunks
+ * store a sorted array of the low 16 bits and dense chunks store a
+ * bitset (the roaring bitmap layout), so the set stays small whether a
+ * filter matches 0.1% or 99% of the collection.
+ */
+class doc_set
+{
+  public:
+    /// The id returned by next_geq() when no document remains
+    const static constexpr uint64_t sentinel
+        = std::numeric_limits<uint64_t>::max();
+
+    /**
+     * Constructs an empty set.
+     */
+    doc_set() = default;
+
+    /**
+     * Compresses a sorted list of unique document ids.
+     * @param docs The sorted document ids the set should contain
+     */
+    explicit doc_set(const std::vector<doc_id>& docs);
+
+    /**
+     * @param d_id The document id to look up
+     * @return whether the set contains the document
+     */
+    bool contains(doc_id d_id) const;
+
+    /**
+     * Makes a doc_set usable directly as a ranker filter function.
+     * @param d_id The document id to look up
+     * @return whether the set contains the document
+     */
+    bool operator()(doc_id d_id) const
+    {
+        return contains(d_id);
+    }
+
+    /**
+     * @param d_id The document id to search from
+     * @return the smallest contained document id that is >= d_id, or
+     * doc_id{sentinel} if there is none
+     */
+    doc_id next_geq(doc_id d_id) const;
+
+    /// @return the number of documents in the set
+    uint64_t size() const;
+
+    /**
+     * @param sets The sets to combine
+     * @return the union of the given sets
+     */
+    static doc_set set_union(const std::vector<const doc_set*>& sets);
+
+    /**
+     * Writes the set to a stream.
+     * @param out The stream to write to
+     */
+    void save(std::ostream& out) const;
+
+    /**
+     * Reads a set from a stream written by save().
+     * @param in The stream to read from
+     */
+    void load(std::istream& in);
+
+  private:
+    /// chunks with at most this many documents use the array layout
+    const static constexpr std::size_t max_array_size = 4096;
+
+    /**
+     * One 2^16-document chunk of the set, identified by the high 48
+     * bits of its document ids. Exactly one of array/bits is used.
+     */
+    struct container
+    {
+        /// the chunk's document ids, shifted right by 16
+        uint64_t key;
+        /// sorted low 16 bits, for sparse chunks
+        std::vector<uint16_t> array;
+        /// 2^16-bit bitset, for dense chunks
+        std::vector<uint64_t> bits;
+    };
+
+    /// appends every document id in the set to a vector, in order
+    void decompress(std::vector<doc_id>& docs) const;
+
+    /// the chunks, sorted by key
+    std::vector<container> containers_;
+
+    /// the total number of documents in the set
+    uint64_t size_ = 0;
+};
+
+/**
+ * Bitmap indexes over one categorical (string) metadata field of an
+ * index: one compressed doc_set per distinct field value, built in one
+ * pass over the index metadata and cached in a <field>.bitmap file in
+ * the index directory. The sets returned by find() and filter() plug
+ * into ranker::score(), where they are intersected with the postings
+ * during traversal instead of being consulted per decoded document.
+ */
+class metadata_bitmap
+{
+  public:
+    /**
+     * Loads (building and saving first if not yet cached) the bitmaps
+     * for a metadata field.
+     * @param idx The index whose metadata should be indexed
+     * @param field The name of the string metadata field
+     */
+    metadata_bitmap(disk_index& idx, const std::string& field);
+
+    /**
+     * @param value The field value to look up
+     * @return the set of documents with this field value, or nullptr if
+     * no document has it
+     */
+    const doc_set* find(const std::string& value) const;
+
+    /**
+     * @param values The field values to accept
+     * @return the set of documents whose field is any of the given
+     * values (values no document has are ignored)
+     */
+    doc_set filter(const std::vector<std::string>& values) const;
+
+    /// @return the number of distinct field values
+    uint64_t num_values() const;
+
+  private:
+    /// builds the bitmaps from the index metadata
+    void build(disk_index& idx, const std::string& field);
+
+    /// the per-value document sets
+    std::unordered_map<std::string, doc_set> bitmaps_;
+};
+
+/**
+ * Basic exception for metadata_bitmap interactions.
+ */
+class metadata_bitmap_exception : public std::runtime_error
+{
+  public:
+    using std::runtime_error::runtime_error;
+};
+}
+}
+#endif
@@ -10,10 +10,15 @@
 #ifndef META_INDEX_METADATA_FILE_H_
 #define META_INDEX_METADATA_FILE_H_
 
+#include <memory>
+#include <vector>
+
 #include "meta/config.h"
 #include "meta/corpus/metadata.h"
 #include "meta/io/mmap_file.h"
 #include "meta/util/disk_vector.h"
+#include "meta/util/optional.h"
+#include "meta/util/string_view.h"
 
 namespace meta
 {
@@ -28,6 +33,20 @@ namespace index
  * - metadata.index: disk vector indexed by document id, denoting the seek
  *   position for each document's metdata in the metadata.db file.
  *
+ * - metadata.lengths, metadata.unique-terms: disk vectors indexed by
+ *   document id holding columnar copies of the two mandatory integer
+ *   fields, so the scoring hot path can read them with a single access
+ *   instead of unpacking a variable-width record from metadata.db.
+ *
+ * - metadata.col.N: one disk vector per user-declared field N, indexed
+ *   by document id. Integer and double fields store their values
+ *   directly; string fields store ids into a dictionary, whose raw
+ *   bytes live in metadata.dict.N with offsets (plus a trailing
+ *   sentinel) in metadata.dict.N.index. These columns make single-field
+ *   access during scoring and filtering a direct indexed load; the
+ *   record-oriented metadata.db remains the fallback for whole-record
+ *   fetches and for indexes built before the columns existed.
+ *
  * - metadata.db: <MDDB>
  *   - <MDDB> => <Header> <DocumentMD>^<NumDocs>
  *   - <Header> => <FieldCount> <FieldHeader>^(<FieldCount> + 2)
@@ -66,18 +85,121 @@ class metadata_file
      */
     corpus::metadata get(doc_id d_id) const;
 
+    /**
+     * Fetches the length of a document from the columnar store without
+     * parsing its metadata record.
+     *
+     * @param d_id The document id to look up
+     * @return the length of the document
+     */
+    uint64_t doc_size(doc_id d_id) const;
+
+    /**
+     * Fetches the number of unique terms in a document from the columnar
+     * store without parsing its metadata record.
+     *
+     * @param d_id The document id to look up
+     * @return the number of unique terms in the document
+     */
+    uint64_t unique_terms(doc_id d_id) const;
+
     /**
      * @return the number of documents in this database
      */
     uint64_t size() const;
 
+    /**
+     * Resolves a field name to its position in the schema. Resolve once
+     * and reuse the position when reading a field for many documents.
+     *
+     * @param name The field name (including "length" and "unique-terms")
+     * @return the field's position, if it exists in the schema
+     */
+    util::optional<uint64_t> field_index(util::string_view name) const;
+
+    /**
+     * @return the schema of this metadata database, including the two
+     * mandatory leading fields
+     */
+    const corpus::metadata::schema_type& schema() const;
+
+    /**
+     * Reads a SIGNED_INT field with a direct columnar load.
+     * @param field The field's position from field_index()
+     * @param d_id The document id to look up
+     * @return the field's value for the document
+     */
+    int64_t signed_value(uint64_t field, doc_id d_id) const;
+
+    /**
+     * Reads an UNSIGNED_INT field with a direct columnar load.
+     * @param field The field's position from field_index()
+     * @param d_id The document id to look up
+     * @return the field's value for the document
+     */
+    uint64_t unsigned_value(uint64_t field, doc_id d_id) const;
+
+    /**
+     * Reads a DOUBLE field with a direct columnar load.
+     * @param field The field's position from field_index()
+     * @param d_id The document id to look up
+     * @return the field's value for the document
+     */
+    double double_value(uint64_t field, doc_id d_id) const;
+
+    /**
+     * Reads a STRING field with a dictionary lookup. The returned view
+     * points into the mapped dictionary and remains valid for the
+     * lifetime of this metadata_file.
+     *
+     * @param field The field's position from field_index()
+     * @param d_id The document id to look up
+     * @return the field's value for the document
+     */
+    util::string_view string_value(uint64_t field, doc_id d_id) const;
+
   private:
+    /// A mapped fixed-width column for one user-declared field
+    struct column
+    {
+        /// values for SIGNED_INT fields
+        std::unique_ptr<util::disk_vector<const int64_t>> signed_vals;
+        /// values for UNSIGNED_INT fields
+        std::unique_ptr<util::disk_vector<const uint64_t>> unsigned_vals;
+        /// values for DOUBLE fields
+        std::unique_ptr<util::disk_vector<const double>> double_vals;
+        /// per-document dictionary ids for STRING fields
+        std::unique_ptr<util::disk_vector<const uint64_t>> dict_ids;
+        /// dictionary string offsets (with a trailing sentinel)
+        std::unique_ptr<util::disk_vector<const uint64_t>> dict_offsets;
+        /// the dictionary's raw string bytes
+        std::unique_ptr<io::mmap_file> dict_bytes;
+    };
+
+    /**
+     * @param field A schema position that must name a user-declared field
+     * of the given type with columnar data present
+     * @param type The expected field type
+     * @return the column for the field
+     */
+    const column& checked_column(uint64_t field,
+                                 corpus::metadata::field_type type) const;
+
     /// the schema for this file
     corpus::metadata::schema_type schema_;
 
     /// the seek positions for every document in this file
     util::disk_vector<const uint64_t> index_;
 
+    /// columnar copy of the document lengths
+    util::disk_vector<const uint64_t> lengths_;
+
+    /// columnar copy of the unique term counts
+    util::disk_vector<const uint64_t> unique_terms_;
+
+    /// the mapped columns for the user-declared fields
+    std::vector<column> columns_;
+
     /// the mapped file for reading metadata from
     io::mmap_file md_db_;
 };
@@ -10,7 +10,11 @@
 #ifndef META_INDEX_METADATA_WRITER_H_
 #define META_INDEX_METADATA_WRITER_H_
 
+#include <fstream>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "meta/config.h"
 #include "meta/corpus/document.h"
@@ -23,7 +27,12 @@ namespace index
 {
 
 /**
- * Writes document metadata into the packed format for the index.
+ * Writes document metadata into the packed format for the index. In
+ * addition to the record-oriented database, every user-declared field is
+ * written as a fixed-width column (one disk_vector per field, with
+ * string fields dictionary-encoded), so readers can load a single
+ * field's value with a direct indexed access instead of unpacking a
+ * variable-width record.
  */
 class metadata_writer
 {
@@ -47,13 +56,47 @@ class metadata_writer
     void write(doc_id d_id, uint64_t length, uint64_t num_unique,
                const std::vector<corpus::metadata::field>& mdata);
 
+    /**
+     * Destroys the writer, finalizing the string dictionaries.
+     */
+    ~metadata_writer();
+
   private:
+    /// The columnar store being built for one user-declared field
+    struct column
+    {
+        /// values for SIGNED_INT fields
+        std::unique_ptr<util::disk_vector<int64_t>> signed_vals;
+        /// values for UNSIGNED_INT fields
+        std::unique_ptr<util::disk_vector<uint64_t>> unsigned_vals;
+        /// values for DOUBLE fields
+        std::unique_ptr<util::disk_vector<double>> double_vals;
+        /// per-document dictionary ids for STRING fields
+        std::unique_ptr<util::disk_vector<uint64_t>> dict_ids;
+        /// dictionary id assignments for STRING fields
+        std::unordered_map<std::string, uint64_t> dict;
+        /// the dictionary's strings, in id order
+        std::vector<std::string> dict_strings;
+    };
+
     /// a lock for thread safety
     std::mutex lock_;
 
     /// the index into the database file
     util::disk_vector<uint64_t> seek_pos_;
 
+    /// columnar copy of the document lengths for fast scoring reads
+    util::disk_vector<uint64_t> lengths_;
+
+    /// columnar copy of the unique term counts for fast scoring reads
+    util::disk_vector<uint64_t> unique_terms_;
+
+    /// the directory the metadata files are written into
+    std::string prefix_;
+
+    /// one columnar store per user-declared field
+    std::vector<column> columns_;
+
     /// the current byte position in the database
     uint64_t byte_pos_;
 
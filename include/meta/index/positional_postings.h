@@ -0,0 +1,183 @@
+/**
+ * @file positional_postings.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_POSITIONAL_POSTINGS_H_
+#define META_INDEX_POSITIONAL_POSTINGS_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "meta/analyzers/token_stream.h"
+#include "meta/config.h"
+#include "meta/corpus/corpus.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/ranker.h"
+#include "meta/io/mmap_file.h"
+#include "meta/util/disk_vector.h"
+#include "meta/util/optional.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * Writes per-term position lists into a compressed positional postings
+ * file stored alongside (but independent of) the main postings. For each
+ * term, the file stores its documents in ascending order; each document
+ * records its gap-encoded id, the number of positions, and the
+ * gap-encoded token positions themselves, all as packed varints. A
+ * parallel "_index" disk_vector maps term ids to byte offsets.
+ *
+ * Keeping positions in a parallel file means the main postings format
+ * (and the chunk/merge pipeline that produces it) is untouched, and
+ * indexes that don't need phrase queries pay nothing.
+ */
+class positional_postings_writer
+{
+  public:
+    /**
+     * @param filename The path to the positional postings file
+     * @param unique_keys The number of terms that will be written
+     */
+    positional_postings_writer(const std::string& filename,
+                               uint64_t unique_keys);
+
+    /**
+     * Writes one term's position lists. Terms must be written in
+     * ascending term id order.
+     *
+     * @param postings The (document, positions) pairs for the term, with
+     * ascending documents and ascending positions within each document
+     */
+    void
+    write(const std::vector<std::pair<doc_id, std::vector<uint64_t>>>&
+              postings);
+
+  private:
+    /// the output stream for the position lists
+    std::ofstream output_;
+    /// byte offsets into the file, indexed by term id
+    util::disk_vector<uint64_t> byte_locations_;
+    /// the current byte position in the file
+    uint64_t byte_pos_;
+    /// the next term id to be written
+    term_id id_;
+};
+
+/**
+ * Reader for the file format written by positional_postings_writer.
+ */
+class positional_postings_file
+{
+  public:
+    /**
+     * A forward cursor over one term's (document, positions) entries.
+     */
+    class stream
+    {
+      public:
+        /**
+         * @param buffer The start of this term's entries in the file
+         */
+        stream(const char* buffer);
+
+        /**
+         * Decodes the next document and its positions.
+         *
+         * @param d_id Set to the next document id
+         * @param positions Filled with the token positions in that document
+         * @return whether another document was available
+         */
+        bool next(doc_id& d_id, std::vector<uint64_t>& positions);
+
+        /**
+         * Advances to the given document, decoding its positions if the
+         * term occurs in it. Targets must be requested in ascending order.
+         *
+         * @param target The document to advance to
+         * @param positions Filled with the positions when the document
+         * contains the term
+         * @return whether the term occurs in the target document
+         */
+        bool find(doc_id target, std::vector<uint64_t>& positions);
+
+      private:
+        /// the read position within the file
+        const char* pos_;
+        /// the number of documents not yet decoded
+        uint64_t docs_left_;
+        /// the last decoded document id (for gap decoding)
+        uint64_t prev_id_;
+        /// a decoded-but-unconsumed document from find(), if any
+        util::optional<doc_id> pending_;
+        /// the positions of the pending document
+        std::vector<uint64_t> pending_positions_;
+    };
+
+    /**
+     * Opens a positional postings file.
+     * @param filename The path to the file
+     */
+    positional_postings_file(const std::string& filename);
+
+    /**
+     * @param pk The term to obtain a position cursor for
+     * @return a stream over the term's positions, if the term exists
+     */
+    util::optional<stream> find_stream(term_id pk) const;
+
+  private:
+    /// the mapped position lists
+    io::mmap_file postings_;
+    /// the byte offsets for each term
+    util::disk_vector<const uint64_t> byte_locations_;
+};
+
+/**
+ * Builds a positional postings file for an existing index by re-tokenizing
+ * the corpus with the given token stream (which should be the same filter
+ * chain the index was built with, so tokens line up with the vocabulary).
+ * Positions for the whole corpus are buffered in memory before writing.
+ *
+ * @param idx The index whose vocabulary maps tokens to term ids
+ * @param docs The corpus to extract positions from
+ * @param stream The token stream used to tokenize each document
+ * @param filename The path for the resulting positional postings file
+ * @return the number of terms written
+ */
+uint64_t build_positional_postings(inverted_index& idx, corpus::corpus& docs,
+                                   analyzers::token_stream& stream,
+                                   const std::string& filename);
+
+/**
+ * Proximity-aware phrase scoring: documents containing every phrase term
+ * are found by intersecting the regular postings lists, scored with the
+ * given ranking function, and then boosted by how tightly the terms
+ * co-occur: a document whose minimal window containing all terms spans
+ * `span` tokens receives an additional
+ * `proximity_weight / (1 + span - num_terms)`, so exact phrase matches
+ * get the full weight and looser co-occurrences decay smoothly.
+ *
+ * @param idx The index to evaluate against
+ * @param positions The positional postings for the index
+ * @param fn The ranking function for the base score
+ * @param phrase The analyzed phrase terms, in order
+ * @param num_results The number of results to return
+ * @param proximity_weight The weight of the proximity boost
+ * @return the top documents in descending score order
+ */
+std::vector<search_result>
+proximity_score(inverted_index& idx, positional_postings_file& positions,
+                ranking_function& fn, const std::vector<std::string>& phrase,
+                uint64_t num_results = 10, float proximity_weight = 1.0f);
+}
+}
+#endif
@@ -17,6 +17,7 @@
 #include "meta/config.h"
 #include "meta/index/postings_stream.h"
 #include "meta/io/packed.h"
+#include "meta/util/buffer_pool.h"
 #include "meta/util/shim.h"
 
 namespace meta
@@ -181,7 +182,12 @@ class postings_buffer
     }
 
   private:
-    /// A simple byte buffer that resizes with a 1.5x policy when full
+    /**
+     * A simple byte buffer that resizes with a 1.5x policy when full. The
+     * underlying storage is recycled through util::buffer_pool, so the
+     * buffers discarded when a chunk is flushed feed the ones the next
+     * chunk needs instead of hitting the allocator.
+     */
     struct char_buffer
     {
         /// Constructs an empty buffer
@@ -198,7 +204,7 @@ class postings_buffer
         {
             if (other.bytes_)
             {
-                bytes_ = make_unique<uint8_t[]>(size_);
+                bytes_ = util::buffer_pool::acquire(size_);
                 std::copy(other.bytes_.get(), other.bytes_.get() + pos_,
                           bytes_.get());
             }
@@ -207,6 +213,13 @@ class postings_buffer
         /// char_buffer can be move constructed
         char_buffer(char_buffer&&) = default;
 
+        /// Destroys the buffer, recycling its storage
+        ~char_buffer()
+        {
+            if (bytes_)
+                util::buffer_pool::release(std::move(bytes_), size_);
+        }
+
         /**
          * @param rhs The buffer to assign into this one
          * @return the current buffer
@@ -246,23 +259,26 @@ class postings_buffer
         }
 
         /**
-         * Resizes the buffer to 1.5x its old size.
+         * Resizes the buffer to (at least) 1.5x its old size.
          */
         void resize()
         {
+            auto old_size = size_;
             if (size_ == 0)
             {
                 size_ = 8;
             }
             else
             {
-                // 1.5x resize
+                // 1.5x resize (the pool rounds up to its size class)
                 size_ += (size_ + 1) / 2;
             }
 
-            auto newbytes = make_unique<uint8_t[]>(size_);
+            auto newbytes = util::buffer_pool::acquire(size_);
             std::copy(bytes_.get(), bytes_.get() + pos_, newbytes.get());
             std::swap(newbytes, bytes_);
+            if (newbytes)
+                util::buffer_pool::release(std::move(newbytes), old_size);
         }
 
         /**
@@ -10,6 +10,8 @@
 #ifndef META_INDEX_POSTINGS_FILE_H_
 #define META_INDEX_POSTINGS_FILE_H_
 
+#include <vector>
+
 #include "meta/config.h"
 #include "meta/index/postings_data.h"
 #include "meta/index/postings_stream.h"
@@ -45,7 +47,10 @@ class postings_file
     }
 
     /**
-     * Obtains a postings stream object for the given primary key.
+     * Obtains a postings stream object for the given primary key. The
+     * stream is an allocation-free view over the mapping, so this is
+     * the preferred read path for query-time code and is safe to call
+     * from any number of threads concurrently.
      * @param pk The primary key to look up
      * @return a postings stream for this primary key, if it is in the
      * postings file
@@ -55,7 +60,7 @@ class postings_file
     {
         if (pk < byte_locations_.size())
             return postings_stream<SecondaryKey, FeatureValue>{
-                postings_.begin() + byte_locations_.at(pk)};
+                base() + byte_locations_.at(pk)};
         return util::nullopt;
     }
 
@@ -80,9 +85,83 @@ class postings_file
         return pdata;
     }
 
+    /**
+     * Copies the compressed postings into an in-memory buffer if the
+     * whole file fits within the given budget. Consumers that sweep the
+     * full file repeatedly (LDA, feature selection) then decode straight
+     * from RAM instead of taking page-cache faults on every pass, while
+     * the resident footprint stays at the compressed size. Pinning is
+     * idempotent; streams obtained afterwards read from the pinned copy.
+     *
+     * @param max_bytes The maximum number of bytes to spend on the copy
+     * @return whether the postings are now memory-resident
+     */
+    bool pin(uint64_t max_bytes)
+    {
+        if (postings_.size() > max_bytes)
+            return false;
+        if (pinned_.empty())
+        {
+            postings_.advise_sequential();
+            pinned_.assign(postings_.begin(),
+                           postings_.begin() + postings_.size());
+        }
+        return true;
+    }
+
+    /**
+     * @return whether the postings are held in a pinned in-memory copy
+     */
+    bool pinned() const
+    {
+        return !pinned_.empty();
+    }
+
+    /**
+     * Hints to the OS that the postings will be scanned sequentially.
+     */
+    void advise_sequential() const
+    {
+        postings_.advise_sequential();
+    }
+
+    /**
+     * Hints to the OS to begin reading the postings list for the given
+     * primary key into the page cache in the background. Issuing
+     * prefetches for several keys before streaming any of them lets a
+     * cold cache fetch the lists concurrently instead of one disk
+     * round trip at a time.
+     *
+     * @param pk The primary key whose postings list should be read
+     * ahead
+     */
+    void prefetch(PrimaryKey pk) const
+    {
+        uint64_t idx{pk};
+        if (pinned() || idx >= byte_locations_.size())
+            return;
+
+        auto begin = byte_locations_.at(idx);
+        auto end = idx + 1 < byte_locations_.size()
+                       ? byte_locations_.at(idx + 1)
+                       : postings_.size();
+        postings_.prefetch(begin, end - begin);
+    }
+
   private:
+    /**
+     * @return the buffer to decode postings from: the pinned in-memory
+     * copy when resident, otherwise the memory mapping
+     */
+    const char* base() const
+    {
+        return pinned_.empty() ? postings_.begin() : pinned_.data();
+    }
+
     io::mmap_file postings_;
     util::disk_vector<const uint64_t> byte_locations_;
+    /// an in-memory copy of the compressed postings, when pinned
+    std::vector<char> pinned_;
 };
 }
 }
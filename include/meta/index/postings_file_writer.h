@@ -10,11 +10,18 @@
 #ifndef META_INDEX_POSTINGS_FILE_WRITER_H_
 #define META_INDEX_POSTINGS_FILE_WRITER_H_
 
+#include <algorithm>
 #include <fstream>
 #include <numeric>
+#include <type_traits>
+#include <vector>
 
 #include "meta/config.h"
+#include "meta/index/postings_stream.h"
+#include "meta/io/buffered_ofstream.h"
 #include "meta/io/packed.h"
+#include "meta/io/packed_block.h"
+#include "meta/succinct/broadword.h"
 #include "meta/util/disk_vector.h"
 
 namespace meta
@@ -26,12 +33,16 @@ template <class PostingsData>
 class postings_file_writer
 {
   public:
+    using count_type = typename PostingsData::count_t;
+    using pair_type = typename PostingsData::pair_t;
+    using feature_value_type = typename pair_type::second_type;
+
     /**
      * Opens a postings file for writing.
      * @param filename The filename (prefix) for the postings file.
      */
     postings_file_writer(const std::string& filename, uint64_t unique_keys)
-        : output_{filename, std::ios::binary},
+        : output_{filename},
           byte_locations_{filename + "_index", unique_keys},
           byte_pos_{0},
           id_{0}
@@ -40,22 +51,272 @@ class postings_file_writer
     }
 
     /**
-     * Writes a postings data object to the file.
+     * Writes a postings data object to the file. Lists that span more
+     * than one block are stored either gap-encoded with an inline skip
+     * table (holding, for each block, its last id, its encoded length in
+     * bytes, and its maximum count) or Elias-Fano encoded when the list
+     * is dense enough for that to be smaller; the representations are
+     * distinguished by a tag byte after the list header (see
+     * postings_stream).
      *
      * @param pdata The postings_data to be written
      */
     void write(const PostingsData& pdata)
     {
         byte_locations_[id_] = byte_pos_;
-        byte_pos_ += pdata.write_packed_counts(output_);
+
+        const auto& counts = pdata.counts();
+        byte_pos_ += io::packed::write(output_, counts.size());
+
+        auto total_counts = std::accumulate(
+            counts.begin(), counts.end(), feature_value_type{0},
+            [](feature_value_type cur, const pair_type& pr) {
+                return cur + pr.second;
+            });
+        byte_pos_ += io::packed::write(output_, total_counts);
+
+        if (counts.size() > io::packed::block_size)
+            byte_pos_ += write_long(counts);
+        else
+            byte_pos_ += write_plain(counts);
+
         ++id_;
     }
 
   private:
-    std::ofstream output_;
+    /// An output adapter for io::packed::write over a byte vector
+    struct buffer_output_stream
+    {
+        void put(char byte)
+        {
+            buffer.push_back(byte);
+        }
+
+        std::vector<char>& buffer;
+    };
+
+    /**
+     * Writes a single-block postings list with no skip table.
+     * @return the number of bytes written
+     */
+    uint64_t write_plain(const count_type& counts)
+    {
+        uint64_t bytes = 0;
+        uint64_t last_id = 0;
+        for (const auto& count : counts)
+        {
+            bytes += io::packed::write(output_, count.first - last_id);
+            bytes += io::packed::write(output_, count.second);
+            last_id = count.first;
+        }
+        return bytes;
+    }
+
+    /**
+     * Writes a multi-block postings list, choosing between the
+     * gap-encoded blocked representation and the Elias-Fano one by
+     * whichever is smaller for this list's density.
+     * @return the number of bytes written
+     */
+    uint64_t write_long(const count_type& counts)
+    {
+        stage_blocked(counts);
+
+        // Elias-Fano beats gap coding once the ids are dense enough; it
+        // only applies to integral counts since they are bit-packed at a
+        // fixed width
+        if (std::is_integral<feature_value_type>::value
+            && elias_fano_bytes(counts) < table_.size() + blocks_.size())
+            return write_elias_fano(counts);
+
+        auto bytes
+            = io::packed::write(output_, postings_rep_blocked);
+        output_.write(table_.data(),
+                      static_cast<std::streamsize>(table_.size()));
+        output_.write(blocks_.data(),
+                      static_cast<std::streamsize>(blocks_.size()));
+        return bytes + table_.size() + blocks_.size();
+    }
+
+    /**
+     * Stages the gap-encoded blocks and their skip table (for each
+     * block: its last id, its encoded length in bytes, and its maximum
+     * count) into in-memory buffers so their sizes are known before
+     * anything is emitted. The table header carries the list-wide
+     * maximum count and the table's byte length so a reader can set up
+     * a stream over the list with pointer arithmetic alone instead of
+     * walking every entry (see postings_stream).
+     */
+    void stage_blocked(const count_type& counts)
+    {
+        auto num_blocks = (counts.size() + io::packed::block_size - 1)
+                          / io::packed::block_size;
+
+        blocks_.clear();
+        table_.clear();
+        entries_.clear();
+        last_ids_.clear();
+        lengths_.clear();
+        maxes_.clear();
+
+        buffer_output_stream stream{blocks_};
+        uint64_t last_id = 0;
+        for (uint64_t block = 0; block < num_blocks; ++block)
+        {
+            auto begin = block * io::packed::block_size;
+            auto end = std::min<uint64_t>(begin + io::packed::block_size,
+                                          counts.size());
+
+            auto block_start = blocks_.size();
+            auto block_max = feature_value_type{0};
+            for (auto i = begin; i < end; ++i)
+            {
+                io::packed::write(stream, counts[i].first - last_id);
+                io::packed::write(stream, counts[i].second);
+                last_id = counts[i].first;
+                block_max = std::max(block_max, counts[i].second);
+            }
+
+            last_ids_.push_back(last_id);
+            lengths_.push_back(blocks_.size() - block_start);
+            maxes_.push_back(block_max);
+        }
+
+        buffer_output_stream entry_stream{entries_};
+        uint64_t prev_last_id = 0;
+        for (uint64_t block = 0; block < num_blocks; ++block)
+        {
+            io::packed::write(entry_stream, last_ids_[block] - prev_last_id);
+            io::packed::write(entry_stream, lengths_[block]);
+            io::packed::write(entry_stream, maxes_[block]);
+            prev_last_id = last_ids_[block];
+        }
+
+        buffer_output_stream table_stream{table_};
+        io::packed::write(table_stream, num_blocks);
+        io::packed::write(table_stream,
+                          *std::max_element(maxes_.begin(), maxes_.end()));
+        io::packed::write(table_stream, entries_.size());
+        table_.insert(table_.end(), entries_.begin(), entries_.end());
+    }
+
+    /**
+     * @return the number of bits needed for the per-number low halves,
+     * mirroring sarray_builder's parameter choice
+     */
+    static uint8_t ef_low_bits(uint64_t universe, uint64_t n)
+    {
+        auto ratio = universe / n;
+        return ratio ? static_cast<uint8_t>(succinct::broadword::msb(ratio))
+                     : 0;
+    }
+
+    /**
+     * @return the number of bytes an Elias-Fano encoding of this list
+     * would occupy, excluding the (small, near-constant) header
+     */
+    uint64_t elias_fano_bytes(const count_type& counts) const
+    {
+        auto n = counts.size();
+        auto universe = static_cast<uint64_t>(counts.back().first) + 1;
+        auto l = ef_low_bits(universe, n);
+        auto max_count = static_cast<uint64_t>(
+            *std::max_element(maxes_.begin(), maxes_.end()));
+        auto w = max_count ? succinct::broadword::msb(max_count) : 1;
+
+        auto high_words = ((universe >> l) + n + 1 + 63) / 64;
+        auto low_words = (n * l + 63) / 64;
+        auto count_words = (n * w + 63) / 64;
+        return 8 * (high_words + low_words + count_words);
+    }
+
+    /**
+     * Writes the Elias-Fano representation of a postings list: a small
+     * header (maximum count and the bit widths), then the high-bits
+     * array of the doc ids, their bit-packed low halves, and the
+     * fixed-width bit-packed counts. Both halves are randomly
+     * accessible, which is what postings_stream's select-based skip_to
+     * relies on.
+     * @return the number of bytes written
+     */
+    uint64_t write_elias_fano(const count_type& counts)
+    {
+        const auto n = counts.size();
+        const auto universe = static_cast<uint64_t>(counts.back().first) + 1;
+        const auto l = ef_low_bits(universe, n);
+        const auto max_count = *std::max_element(maxes_.begin(), maxes_.end());
+        const auto max_int = static_cast<uint64_t>(max_count);
+        const auto w = static_cast<uint8_t>(
+            max_int ? succinct::broadword::msb(max_int) : 1);
+
+        high_words_.assign(((universe >> l) + n + 1 + 63) / 64, 0);
+        low_words_.assign((n * l + 63) / 64, 0);
+        count_words_.assign((n * w + 63) / 64, 0);
+
+        const auto low_mask = l ? (1ull << l) - 1 : 0;
+        uint64_t k = 0;
+        for (const auto& count : counts)
+        {
+            auto id = static_cast<uint64_t>(count.first);
+            set_bit(high_words_, (id >> l) + k);
+            append_bits(low_words_, k * l, id & low_mask, l);
+            append_bits(count_words_, k * w,
+                        static_cast<uint64_t>(count.second), w);
+            ++k;
+        }
+
+        auto bytes = io::packed::write(output_, postings_rep_elias_fano);
+        bytes += io::packed::write(output_, max_count);
+        bytes += io::packed::write(output_, l);
+        bytes += io::packed::write(output_, w);
+        bytes += io::packed::write(output_, high_words_.size());
+        for (const auto* words : {&high_words_, &low_words_, &count_words_})
+        {
+            output_.write(reinterpret_cast<const char*>(words->data()),
+                          static_cast<std::streamsize>(8 * words->size()));
+            bytes += 8 * words->size();
+        }
+        return bytes;
+    }
+
+    static void set_bit(std::vector<uint64_t>& words, uint64_t pos)
+    {
+        words[pos / 64] |= 1ull << (pos % 64);
+    }
+
+    static void append_bits(std::vector<uint64_t>& words, uint64_t pos,
+                            uint64_t value, uint8_t width)
+    {
+        if (!width)
+            return;
+        auto word = pos / 64;
+        auto off = pos % 64;
+        words[word] |= value << off;
+        if (off + width > 64)
+            words[word + 1] |= value >> (64 - off);
+    }
+
+    io::buffered_ofstream output_;
     util::disk_vector<uint64_t> byte_locations_;
     uint64_t byte_pos_;
     uint64_t id_;
+    /// staging buffer for the encoded blocks of the current list
+    std::vector<char> blocks_;
+    /// staging buffer for the skip table of the current list
+    std::vector<char> table_;
+    /// staging buffer for the skip table entries, whose total byte
+    /// length goes into the table header before them
+    std::vector<char> entries_;
+    /// staging buffers for the Elias-Fano bit arrays of the current list
+    std::vector<uint64_t> high_words_;
+    std::vector<uint64_t> low_words_;
+    std::vector<uint64_t> count_words_;
+    /// per-block last ids for the current list
+    std::vector<uint64_t> last_ids_;
+    /// per-block encoded byte lengths for the current list
+    std::vector<uint64_t> lengths_;
+    /// per-block maximum counts for the current list
+    std::vector<feature_value_type> maxes_;
 };
 }
 }
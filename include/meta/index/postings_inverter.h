@@ -23,6 +23,7 @@
 #include "meta/index/chunk.h"
 #include "meta/index/postings_buffer.h"
 #include "meta/parallel/semaphore.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/util/optional.h"
 
 namespace meta
@@ -59,6 +60,15 @@ class postings_inverter
          */
         producer(postings_inverter* parent, uint64_t ram_budget);
 
+        /**
+         * Constructs a producer whose memory usage is tracked against the
+         * parent's global RAM budget rather than a fixed local limit.
+         *
+         * @param parent A back-pointer to the handler this producer is
+         * operating on
+         */
+        producer(postings_inverter* parent);
+
         /**
          * Handler for when a given secondary_key has been processed and is
          * ready to be added to the in-memory chunk.
@@ -80,6 +90,12 @@ class postings_inverter
          */
         void flush_chunk();
 
+        /**
+         * Publishes any change in this producer's buffered bytes to the
+         * parent's global usage counter (arena-tracked producers only).
+         */
+        void sync_usage();
+
         /// Current in-memory chunk
         hashing::probe_set<postings_buffer_type> pdata_;
 
@@ -95,6 +111,12 @@ class postings_inverter
 
         /// Back-pointer to the handler this producer is operating on
         postings_inverter* parent_;
+
+        /// Whether this producer tracks against the parent's global budget
+        bool arena_tracked_{false};
+
+        /// Bytes last published to the parent's global usage counter
+        uint64_t reported_{0};
     };
 
     /**
@@ -114,6 +136,41 @@ class postings_inverter
      */
     producer make_producer(uint64_t ram_budget);
 
+    /**
+     * Creates a producer whose memory usage is tracked against this
+     * inverter's global RAM budget (see ram_budget()). All such producers
+     * share the budget: a producer spills its buffer to disk only when
+     * the *total* buffered bytes across producers exceed the budget and
+     * its own buffer holds a meaningful share, so threads with skewed
+     * term distributions no longer flush prematurely while others sit on
+     * unused headroom.
+     *
+     * @return a new arena-tracked producer
+     */
+    producer make_producer();
+
+    /**
+     * Sets the global RAM budget, in bytes, shared by all arena-tracked
+     * producers. Like the per-producer budgets, this is an *estimate*;
+     * leave some slop to avoid running out of memory.
+     *
+     * @param bytes The total allowed size of all producer buffers
+     */
+    void ram_budget(uint64_t bytes);
+
+    /**
+     * Enables or disables Zstandard compression of the spilled chunks.
+     * Compression happens on the producer thread as a chunk is flushed
+     * and compressed chunks are expanded again just before the final
+     * merge, trading otherwise-idle CPU for spill disk bandwidth; this
+     * helps most on builders whose disks saturate before their cores
+     * do. When the toolkit was built without Zstandard support the
+     * request is ignored with a warning.
+     *
+     * @param compress Whether to compress spilled chunks
+     */
+    void compress_chunks(bool compress);
+
     /**
      * @return the number of chunks this handler has written to disk.
      */
@@ -130,6 +187,19 @@ class postings_inverter
      */
     void merge_chunks();
 
+    /**
+     * Merge the remaining on-disk chunks, passing each merged
+     * postings_data to the given function instead of writing a combined
+     * chunk file. This lets callers stream the merge result directly into
+     * its final format (e.g. the compressed postings file) without an
+     * intermediate on-disk round trip.
+     *
+     * @param fn The function to receive each merged postings_data, in
+     * sorted primary key order
+     */
+    template <class Function>
+    void merge_chunks(Function&& fn);
+
     /**
      * @return the number of unique primary keys seen while merging chunks.
      */
@@ -143,6 +213,48 @@ class postings_inverter
     template <class Allocator>
     void write_chunk(std::vector<postings_buffer_type, Allocator>& pdata);
 
+    /**
+     * Sorts an extracted chunk using the shared sorting pool. String
+     * primary keys are first radix-partitioned into 256 buckets by their
+     * leading byte (which is order preserving), so only small
+     * per-bucket runs need a comparison sort; the buckets concatenate
+     * into a globally sorted chunk that the multiway merge consumes
+     * unchanged. Keys without a usable radix byte fall back to a full
+     * parallel sort. Sorts are serialized across producers since
+     * concurrent merge sorts on one pool can exhaust its workers with
+     * blocked waiters.
+     *
+     * @param pdata The collection of postings_data objects to sort
+     */
+    template <class Allocator>
+    void sort_chunk(std::vector<postings_buffer_type, Allocator>& pdata);
+
+    /**
+     * Drains the chunk queue and, when there are many more chunks than
+     * cores, runs a parallel first merge pass.
+     *
+     * @return the paths of the chunks for the final merge pass
+     */
+    std::vector<std::string> prepare_merge();
+
+    /**
+     * @param delta The (signed) change in buffered bytes to apply to the
+     * global usage counter
+     */
+    void update_ram_usage(int64_t delta);
+
+    /**
+     * @param extra Additional bytes that are about to be buffered
+     * @return whether the global budget would be exceeded
+     */
+    bool memory_exceeded(uint64_t extra = 0) const;
+
+    /**
+     * @return the minimum buffer size an arena-tracked producer must hold
+     * before it is asked to spill (half of its fair share of the budget)
+     */
+    uint64_t spill_threshold() const;
+
     /// The prefix for all chunks to be written
     std::string prefix_;
 
@@ -158,6 +270,24 @@ class postings_inverter
     /// Semaphore used for limiting the number of threads writing to disk
     parallel::semaphore sem_;
 
+    /// Pool shared by the producers for sorting chunks before writing
+    parallel::thread_pool sort_pool_;
+
+    /// Serializes producer sorts on the shared pool
+    std::mutex sort_mutex_;
+
+    /// Global budget, in bytes, shared by arena-tracked producers (0 = unset)
+    uint64_t ram_budget_{0};
+
+    /// Whether spilled chunks are Zstandard-compressed on disk
+    bool compress_chunks_{false};
+
+    /// Bytes currently buffered across all arena-tracked producers
+    std::atomic<int64_t> bytes_used_{0};
+
+    /// Number of currently live arena-tracked producers
+    std::atomic<uint32_t> num_producers_{0};
+
     /// Number of unique primary keys encountered while merging
     util::optional<uint64_t> unique_primary_keys_;
 };
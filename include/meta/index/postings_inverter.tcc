@@ -5,10 +5,18 @@
 
 #include <cassert>
 #include <algorithm>
+#include <array>
+#include <limits>
 
 #include "meta/index/chunk_reader.h"
 #include "meta/index/postings_inverter.h"
 #include "meta/index/disk_index.h"
+#if META_HAS_ZSTD
+#include "meta/io/zstdstream.h"
+#endif
+#include "meta/logging/logger.h"
+#include "meta/util/profile.h"
+#include "meta/parallel/algorithm.h"
 #include "meta/parallel/thread_pool.h"
 
 namespace meta
@@ -16,6 +24,28 @@ namespace meta
 namespace index
 {
 
+namespace detail
+{
+/**
+ * @param key A string primary key
+ * @return the order-preserving radix bucket for the key (its first byte)
+ */
+inline unsigned char radix_byte(const std::string& key)
+{
+    return key.empty() ? 0 : static_cast<unsigned char>(key.front());
+}
+
+/**
+ * Fallback for primary key types without a usable radix byte: everything
+ * lands in one bucket, which makes sort_chunk degrade to a full sort.
+ */
+template <class T>
+unsigned char radix_byte(const T&)
+{
+    return 0;
+}
+}
+
 template <class Index>
 postings_inverter<Index>::producer::producer(postings_inverter* parent,
                                              uint64_t ram_budget)
@@ -25,6 +55,17 @@ postings_inverter<Index>::producer::producer(postings_inverter* parent,
     assert(chunk_size_ < max_size_);
 }
 
+template <class Index>
+postings_inverter<Index>::producer::producer(postings_inverter* parent)
+    : max_size_{std::numeric_limits<uint64_t>::max()},
+      parent_{parent},
+      arena_tracked_{true}
+{
+    chunk_size_ = pdata_.bytes_used();
+    ++parent_->num_producers_;
+    sync_usage();
+}
+
 template <class Index>
 template <class Container>
 void postings_inverter<Index>::producer::
@@ -45,9 +86,13 @@ operator()(const secondary_key_type& key, const Container& counts)
             {
                 // now check if roughly doubling our bytes used is going to
                 // cause problems
-                auto next_chunk_size = chunk_size_ + pdata_.bytes_used()
-                                       + pdata_.bytes_used() / 2;
-                if (next_chunk_size >= max_size_)
+                auto extra = pdata_.bytes_used() + pdata_.bytes_used() / 2;
+                auto over_budget
+                    = arena_tracked_
+                          ? (parent_->memory_exceeded(extra)
+                             && chunk_size_ >= parent_->spill_threshold())
+                          : chunk_size_ + extra >= max_size_;
+                if (over_budget)
                 {
                     // if so, flush the current chunk before carrying on
                     flush_chunk();
@@ -74,8 +119,20 @@ operator()(const secondary_key_type& key, const Container& counts)
             chunk_size_ += it->bytes_used();
         }
 
-        if (chunk_size_ >= max_size_)
+        if (arena_tracked_)
+        {
+            sync_usage();
+            // spill only when the *global* budget is exhausted and this
+            // producer's buffer holds a meaningful share of it; small
+            // buffers keep growing while a skewed sibling spills instead
+            if (parent_->memory_exceeded()
+                && chunk_size_ >= parent_->spill_threshold())
+                flush_chunk();
+        }
+        else if (chunk_size_ >= max_size_)
+        {
             flush_chunk();
+        }
     }
 }
 
@@ -85,9 +142,12 @@ void postings_inverter<Index>::producer::flush_chunk()
     if (pdata_.empty())
         return;
 
+    META_PROFILE_SCOPE("postings_inverter::flush_chunk");
+    META_PROFILE_COUNT("postings_inverter::chunks_flushed", 1);
+
     // extract the keys, emptying the hash set
     auto pdata = pdata_.extract_keys();
-    std::sort(pdata.begin(), pdata.end());
+    parent_->sort_chunk(pdata);
     parent_->write_chunk(pdata);
 
     chunk_size_ = pdata_.bytes_used();
@@ -101,12 +161,32 @@ void postings_inverter<Index>::producer::flush_chunk()
         swap(tmp, pdata_);
         chunk_size_ = pdata_.bytes_used();
     }
+
+    if (arena_tracked_)
+        sync_usage();
+}
+
+template <class Index>
+void postings_inverter<Index>::producer::sync_usage()
+{
+    auto delta = static_cast<int64_t>(chunk_size_)
+                 - static_cast<int64_t>(reported_);
+    if (delta != 0)
+    {
+        parent_->update_ram_usage(delta);
+        reported_ = chunk_size_;
+    }
 }
 
 template <class Index>
 postings_inverter<Index>::producer::~producer()
 {
     flush_chunk();
+    if (arena_tracked_)
+    {
+        parent_->update_ram_usage(-static_cast<int64_t>(reported_));
+        --parent_->num_producers_;
+    }
 }
 
 template <class Index>
@@ -123,6 +203,117 @@ auto postings_inverter<Index>::make_producer(uint64_t ram_budget) -> producer
     return {this, ram_budget};
 }
 
+template <class Index>
+auto postings_inverter<Index>::make_producer() -> producer
+{
+    if (ram_budget_ == 0)
+        throw postings_inverter_exception{
+            "global ram budget must be set before creating arena-tracked "
+            "producers"};
+    return {this};
+}
+
+template <class Index>
+void postings_inverter<Index>::ram_budget(uint64_t bytes)
+{
+    ram_budget_ = bytes;
+}
+
+template <class Index>
+void postings_inverter<Index>::compress_chunks(bool compress)
+{
+#if META_HAS_ZSTD
+    compress_chunks_ = compress;
+#else
+    if (compress)
+        LOG(warning) << "chunk compression requested, but the toolkit was "
+                        "built without Zstandard support; writing chunks "
+                        "uncompressed"
+                     << ENDLG;
+#endif
+}
+
+template <class Index>
+void postings_inverter<Index>::update_ram_usage(int64_t delta)
+{
+    bytes_used_.fetch_add(delta, std::memory_order_relaxed);
+}
+
+template <class Index>
+bool postings_inverter<Index>::memory_exceeded(uint64_t extra) const
+{
+    if (ram_budget_ == 0)
+        return false;
+    auto used = bytes_used_.load(std::memory_order_relaxed);
+    return used > 0 && static_cast<uint64_t>(used) + extra >= ram_budget_;
+}
+
+template <class Index>
+uint64_t postings_inverter<Index>::spill_threshold() const
+{
+    auto producers = std::max(1u, num_producers_.load());
+    return ram_budget_ / (2 * producers);
+}
+
+template <class Index>
+template <class Allocator>
+void postings_inverter<Index>::sort_chunk(
+    std::vector<postings_buffer_type, Allocator>& pdata)
+{
+    std::lock_guard<std::mutex> lock{sort_mutex_};
+
+    std::array<std::size_t, 256> counts{};
+    for (const auto& p : pdata)
+        ++counts[detail::radix_byte(p.primary_key())];
+
+    auto nonempty = static_cast<std::size_t>(
+        std::count_if(counts.begin(), counts.end(),
+                      [](std::size_t count) { return count > 0; }));
+
+    // keys that do not spread across the radix (e.g. numeric primary
+    // keys) gain nothing from partitioning: sort the whole chunk
+    if (nonempty <= 1)
+    {
+        parallel::sort(pdata.begin(), pdata.end(), sort_pool_);
+        return;
+    }
+
+    // scatter into per-bucket runs; the bucket index is monotone in the
+    // primary key, so sorting each run and concatenating in bucket
+    // order yields a globally sorted chunk. The runs are small enough
+    // that each comparison sort usually stays cache resident
+    std::vector<std::vector<postings_buffer_type>> buckets(counts.size());
+    for (std::size_t b = 0; b < counts.size(); ++b)
+    {
+        if (counts[b] > 0)
+            buckets[b].reserve(counts[b]);
+    }
+    for (auto& p : pdata)
+        buckets[detail::radix_byte(p.primary_key())].push_back(std::move(p));
+    pdata.clear();
+
+    // the per-bucket sorts are independent and never block on one
+    // another, so unlike a nested merge sort they can all run on the
+    // pool at once
+    std::vector<std::future<void>> futures;
+    futures.reserve(nonempty);
+    for (auto& bucket : buckets)
+    {
+        if (bucket.empty())
+            continue;
+        futures.emplace_back(sort_pool_.submit_task(
+            [&bucket]() { std::sort(bucket.begin(), bucket.end()); }));
+    }
+    for (auto& fut : futures)
+        fut.get();
+
+    for (auto& bucket : buckets)
+    {
+        for (auto& p : bucket)
+            pdata.push_back(std::move(p));
+    }
+}
+
 template <class Index>
 template <class Allocator>
 void postings_inverter<Index>::write_chunk(
@@ -148,6 +339,18 @@ void postings_inverter<Index>::write_chunk(
     {
         std::string chunk_name
             = prefix_ + "/chunk-" + std::to_string(chunk_num);
+#if META_HAS_ZSTD
+        if (compress_chunks_)
+        {
+            // compressing here keeps the cost on the producer thread,
+            // which would otherwise be stalled on the spill write anyway
+            chunk_name += ".zst";
+            io::zstdofstream outfile{chunk_name};
+            for (auto& p : pdata)
+                p.write_packed(outfile);
+        }
+        else
+#endif
         {
             std::ofstream outfile{chunk_name, std::ios::binary};
             for (auto& p : pdata)
@@ -168,7 +371,7 @@ void postings_inverter<Index>::write_chunk(
 }
 
 template <class Index>
-void postings_inverter<Index>::merge_chunks()
+std::vector<std::string> postings_inverter<Index>::prepare_merge()
 {
     std::vector<std::string> to_merge;
     to_merge.reserve(chunks_.size());
@@ -178,11 +381,86 @@ void postings_inverter<Index>::merge_chunks()
         chunks_.pop();
     }
 
+#if META_HAS_ZSTD
+    if (compress_chunks_)
+    {
+        // the multiway merge scans its inputs through the memory-mapped
+        // read path, so compressed chunks are expanded first; each
+        // chunk's frames decompress in parallel
+        for (auto& path : to_merge)
+        {
+            auto plain = path.substr(0, path.size() - 4);
+            io::parallel_decompress(path, plain);
+            filesystem::delete_file(path);
+            path = std::move(plain);
+        }
+    }
+#endif
+
+    // when there are many more chunks than cores, do a parallel first
+    // pass that merges groups of chunks into one intermediate chunk per
+    // thread (keeping the same chunk framing); the final pass then only
+    // has to merge a handful of large inputs
+    auto num_threads
+        = std::max(1u, std::thread::hardware_concurrency());
+    if (to_merge.size() > 2 * num_threads)
+    {
+        auto group_size
+            = (to_merge.size() + num_threads - 1) / num_threads;
+
+        std::vector<std::string> intermediates;
+        std::vector<std::future<void>> futures;
+        parallel::thread_pool pool{num_threads};
+        for (std::size_t group = 0; group * group_size < to_merge.size();
+             ++group)
+        {
+            auto begin = to_merge.begin()
+                         + static_cast<std::ptrdiff_t>(group * group_size);
+            auto end = to_merge.begin()
+                       + static_cast<std::ptrdiff_t>(std::min(
+                             (group + 1) * group_size, to_merge.size()));
+            auto path
+                = prefix_ + "/chunk-merged-" + std::to_string(group);
+            intermediates.push_back(path);
+            futures.emplace_back(pool.submit_task([=]() {
+                std::ofstream outfile{path, std::ios::binary};
+                multiway_merge<index_pdata_type>(
+                    outfile, begin, end, printing::no_progress_trait{});
+            }));
+        }
+        for (auto& fut : futures)
+            fut.get();
+
+        to_merge = std::move(intermediates);
+    }
+
+    return to_merge;
+}
+
+template <class Index>
+void postings_inverter<Index>::merge_chunks()
+{
+    auto to_merge = prepare_merge();
     std::ofstream outfile{prefix_ + "/postings.index", std::ios::binary};
     unique_primary_keys_ = multiway_merge<index_pdata_type>(
         outfile, to_merge.begin(), to_merge.end());
 }
 
+template <class Index>
+template <class Function>
+void postings_inverter<Index>::merge_chunks(Function&& fn)
+{
+    auto to_merge = prepare_merge();
+
+    std::vector<chunk_reader<index_pdata_type>> chunks;
+    chunks.reserve(to_merge.size());
+    for (const auto& path : to_merge)
+        chunks.emplace_back(path);
+
+    unique_primary_keys_ = util::multiway_merge(chunks.begin(), chunks.end(),
+                                                std::forward<Function>(fn));
+}
+
 template <class Index>
 uint64_t postings_inverter<Index>::unique_primary_keys() const
 {
@@ -10,12 +10,17 @@
 #ifndef META_INDEX_POSTINGS_STREAM_H_
 #define META_INDEX_POSTINGS_STREAM_H_
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <iterator>
 #include <tuple>
 #include <utility>
 
 #include "meta/config.h"
 #include "meta/io/packed.h"
+#include "meta/io/packed_block.h"
+#include "meta/succinct/broadword.h"
 #include "meta/util/optional.h"
 
 namespace meta
@@ -23,10 +28,24 @@ namespace meta
 namespace index
 {
 
+/// Representation tag for multi-block lists: gap-encoded blocks behind an
+/// inline skip table (see postings_file_writer)
+const constexpr uint8_t postings_rep_blocked = 0;
+/// Representation tag for multi-block lists: Elias-Fano encoded doc ids
+/// with fixed-width bit-packed counts
+const constexpr uint8_t postings_rep_elias_fano = 1;
+
 /**
  * A stream for extracting the postings list for a specific key in a
  * postings file. This can be used instead of postings_data to avoid
  * reading in the entire postings list into memory at once.
+ *
+ * A stream is an immutable, allocation-free view over the memory-mapped
+ * postings: construction is a constant number of header reads and
+ * pointer arithmetic, and all decode state lives inside the iterators.
+ * Any number of threads may therefore stream the same list (or
+ * different lists of the same file) concurrently, each with its own
+ * stream or iterator, with no synchronization.
  */
 template <class SecondaryKey, class FeatureValue = uint64_t>
 class postings_stream
@@ -61,6 +80,49 @@ class postings_stream
 
         io::packed::read(stream, size_);
         io::packed::read(stream, total_counts_);
+
+        // multi-block lists carry a representation tag after the header:
+        // either gap-encoded blocks behind an inline skip table, or an
+        // Elias-Fano encoding for dense lists (see postings_file_writer)
+        if (size_ > io::packed::block_size)
+        {
+            uint8_t rep;
+            io::packed::read(stream, rep);
+            if (rep == postings_rep_elias_fano)
+            {
+                ef_ = true;
+                uint64_t num_high_words;
+                io::packed::read(stream, max_count_);
+                io::packed::read(stream, ef_low_bits_);
+                io::packed::read(stream, ef_count_bits_);
+                io::packed::read(stream, num_high_words);
+
+                ef_high_ = stream.input_;
+                ef_low_ = ef_high_ + 8 * num_high_words;
+                ef_counts_
+                    = ef_low_ + 8 * ((size_ * ef_low_bits_ + 63) / 64);
+                stream.input_
+                    = ef_counts_ + 8 * ((size_ * ef_count_bits_ + 63) / 64);
+            }
+            else
+            {
+                // the table header carries the list-wide maximum count
+                // and the table's byte length, so setting up costs a
+                // handful of varint reads no matter how long the list is
+                uint64_t table_bytes;
+                io::packed::read(stream, num_blocks_);
+                io::packed::read(stream, max_count_);
+                io::packed::read(stream, table_bytes);
+                skips_ = stream.input_;
+                stream.input_ += table_bytes;
+            }
+        }
+        else
+        {
+            // without a skip table, the total is still a valid (if
+            // loose) upper bound on any single count
+            max_count_ = total_counts_;
+        }
         start_ = stream.input_;
     }
 
@@ -72,7 +134,10 @@ class postings_stream
      */
     postings_stream(const char* buffer, uint64_t size,
                     FeatureValue total_counts)
-        : start_{buffer}, size_{size}, total_counts_{total_counts}
+        : start_{buffer},
+          size_{size},
+          total_counts_{total_counts},
+          max_count_{total_counts}
     {
         // nothing
     }
@@ -94,6 +159,16 @@ class postings_stream
         return total_counts_;
     }
 
+    /**
+     * @return an upper bound on the count of any single SecondaryKey in
+     * this postings list, computed from the skip table's block maxima
+     * when available
+     */
+    FeatureValue max_count() const
+    {
+        return max_count_;
+    }
+
     /**
      * Writes this postings stream to an output stream in packed format.
      * @return the number of bytes written
@@ -142,11 +217,11 @@ class postings_stream
             }
             else
             {
-                uint64_t id;
-                io::packed::read(stream_, id);
-                // gap encoding
-                count_.first += id;
-                io::packed::read(stream_, count_.second);
+                if (block_pos_ == block_len_)
+                    refill();
+                count_.first = SecondaryKey{ids_[block_pos_]};
+                count_.second = counts_[block_pos_];
+                ++block_pos_;
                 ++pos_;
             }
             return *this;
@@ -169,6 +244,89 @@ class postings_stream
             return &count_;
         }
 
+        /**
+         * Advances the iterator to the first entry whose id is at least
+         * the given id, using the skip table (when present) to jump over
+         * whole blocks that cannot contain it. The iterator is left at
+         * the end of the list if no such entry exists.
+         *
+         * @param target The id to skip forward to
+         */
+        void skip_to(SecondaryKey target)
+        {
+            auto tgt = static_cast<uint64_t>(target);
+            if (!stream_.input_ || static_cast<uint64_t>(count_.first) >= tgt)
+                return;
+
+            if (ef_)
+            {
+                skip_to_ef(tgt);
+                return;
+            }
+
+            // without a skip table all we can do is scan forward
+            if (!skips_)
+            {
+                while (stream_.input_
+                       && static_cast<uint64_t>(count_.first) < tgt)
+                    ++(*this);
+                return;
+            }
+
+            // fast-forward within the currently decoded block if it can
+            // contain the target
+            if (block_pos_ < block_len_ && ids_[block_len_ - 1] >= tgt)
+            {
+                land_in_block(tgt);
+                return;
+            }
+
+            // exhaust the current block, then skip whole undecoded
+            // blocks whose last id falls below the target
+            pos_ += block_len_ - block_pos_;
+            block_pos_ = block_len_;
+            while (blocks_left_ > 0)
+            {
+                char_input_stream skip_stream{skips_};
+                uint64_t delta;
+                uint64_t length;
+                FeatureValue max;
+                io::packed::read(skip_stream, delta);
+                io::packed::read(skip_stream, length);
+                io::packed::read(skip_stream, max);
+                if (skip_last_id_ + delta >= tgt)
+                    break;
+
+                skips_ = skip_stream.input_;
+                skip_last_id_ += delta;
+                prev_id_ = skip_last_id_;
+                stream_.input_ += length;
+                --blocks_left_;
+                pos_ += std::min(io::packed::block_size, size_ - pos_);
+            }
+
+            if (pos_ == size_)
+            {
+                stream_ = {nullptr};
+                size_ = 0;
+                pos_ = 0;
+                return;
+            }
+
+            refill();
+            land_in_block(tgt);
+        }
+
+        /**
+         * @return the maximum count within the current block, for use as
+         * a block-local upper bound when pruning. Lists without a skip
+         * table report zero, meaning the bound is unknown.
+         */
+        FeatureValue block_max_count() const
+        {
+            return block_max_;
+        }
+
         bool operator==(const iterator& other)
         {
             return std::tie(stream_.input_, size_, pos_)
@@ -181,19 +339,270 @@ class postings_stream
         }
 
       private:
-        iterator(const char* start, uint64_t size)
+        iterator(const char* start, uint64_t size, const char* skips,
+                 uint64_t num_blocks)
             : stream_{start},
               size_{size},
               pos_{0},
-              count_{std::make_pair(SecondaryKey{0}, 0.0)}
+              count_{std::make_pair(SecondaryKey{0}, 0.0)},
+              skips_{skips},
+              blocks_left_{num_blocks}
         {
             ++(*this);
         }
 
+        iterator(const char* high, const char* low, const char* counts,
+                 uint64_t size, uint8_t low_bits, uint8_t count_bits,
+                 FeatureValue max_count)
+            : stream_{high},
+              size_{size},
+              pos_{0},
+              count_{std::make_pair(SecondaryKey{0}, 0.0)},
+              block_max_{max_count},
+              ef_{true},
+              ef_high_{high},
+              ef_low_{low},
+              ef_counts_{counts},
+              ef_low_bits_{low_bits},
+              ef_count_bits_{count_bits},
+              ef_cur_word_{load_word(high, 0)}
+        {
+            ++(*this);
+        }
+
+        /**
+         * Bulk-decodes the next block of postings from the raw buffer
+         * into the cache-aligned id and count buffers, converting the
+         * gap-encoded ids to absolute ids as it goes. When a skip table
+         * is present, its entry for this block is consumed to keep the
+         * skip cursor in step and to surface the block's maximum count.
+         */
+        void refill()
+        {
+            if (ef_)
+            {
+                refill_ef();
+                return;
+            }
+
+            if (skips_)
+            {
+                char_input_stream skip_stream{skips_};
+                uint64_t delta;
+                uint64_t length;
+                io::packed::read(skip_stream, delta);
+                io::packed::read(skip_stream, length);
+                io::packed::read(skip_stream, block_max_);
+                skips_ = skip_stream.input_;
+                skip_last_id_ += delta;
+                --blocks_left_;
+            }
+
+            block_len_ = std::min(io::packed::block_size, size_ - pos_);
+            auto input = stream_.input_;
+            for (uint64_t i = 0; i < block_len_; ++i)
+            {
+                input = io::packed::decode_value(input, ids_[i]);
+                input = io::packed::decode_value(input, counts_[i]);
+            }
+            stream_.input_ = input;
+            prev_id_ = io::packed::accumulate_gaps(ids_.data(), block_len_,
+                                                   prev_id_);
+            block_pos_ = 0;
+        }
+
+        static uint64_t load_word(const char* base, uint64_t idx)
+        {
+            uint64_t word;
+            std::memcpy(&word, base + 8 * idx, 8);
+            return word;
+        }
+
+        static uint64_t extract_bits(const char* base, uint64_t bit_pos,
+                                     uint8_t width)
+        {
+            if (!width)
+                return 0;
+            auto word = bit_pos / 64;
+            auto off = bit_pos % 64;
+            auto bits = load_word(base, word) >> off;
+            if (off + width > 64)
+                bits |= load_word(base, word + 1) << (64 - off);
+            if (width == 64)
+                return bits;
+            return bits & ((1ull << width) - 1);
+        }
+
+        /**
+         * Bulk-decodes the next block of an Elias-Fano encoded list into
+         * the id and count buffers. Ids come out absolute: the high half
+         * is recovered by walking the set bits of the high array, the
+         * low half and the count are fixed-width bit extractions.
+         */
+        void refill_ef()
+        {
+            block_len_ = std::min(io::packed::block_size, size_ - pos_);
+            for (uint64_t i = 0; i < block_len_; ++i)
+            {
+                auto k = pos_ + i;
+                while (!ef_cur_word_)
+                    ef_cur_word_ = load_word(ef_high_, ++ef_word_idx_);
+                auto bit = ef_word_idx_ * 64
+                           + succinct::broadword::lsb(ef_cur_word_);
+                ef_cur_word_ &= ef_cur_word_ - 1;
+                ef_scan_pos_ = bit + 1;
+
+                ids_[i] = ((bit - k) << ef_low_bits_)
+                          | extract_bits(ef_low_, k * ef_low_bits_,
+                                         ef_low_bits_);
+                counts_[i] = static_cast<FeatureValue>(extract_bits(
+                    ef_counts_, k * ef_count_bits_, ef_count_bits_));
+            }
+            block_pos_ = 0;
+        }
+
+        /**
+         * Skip on an Elias-Fano encoded list: a select-0 over the high
+         * bits (a popcount word walk) jumps the decode cursor directly
+         * to the first element in the target's high-bits bucket, so the
+         * cost is independent of how many postings are skipped.
+         */
+        void skip_to_ef(uint64_t tgt)
+        {
+            // fast-forward within the currently decoded block if it can
+            // contain the target
+            if (block_pos_ < block_len_ && ids_[block_len_ - 1] >= tgt)
+            {
+                land_in_block(tgt);
+                return;
+            }
+
+            // account for decoded-but-unconsumed entries so pos_ always
+            // matches the decode cursor at refill time
+            pos_ += block_len_ - block_pos_;
+            block_pos_ = block_len_ = 0;
+
+            auto h = tgt >> ef_low_bits_;
+            auto zeros = ef_scan_pos_ - pos_;
+            if (h > zeros)
+            {
+                // find the h-th zero of the high bits from the scan
+                // cursor, one popcount per word
+                auto need = h - zeros;
+                auto off = ef_scan_pos_ - ef_word_idx_ * 64;
+                auto word_zeros = (64 - off)
+                                  - succinct::broadword::popcount(ef_cur_word_);
+                while (need > word_zeros)
+                {
+                    need -= word_zeros;
+                    pos_ += succinct::broadword::popcount(ef_cur_word_);
+                    ef_cur_word_ = load_word(ef_high_, ++ef_word_idx_);
+                    ef_scan_pos_ = ef_word_idx_ * 64;
+                    off = 0;
+                    word_zeros
+                        = 64 - succinct::broadword::popcount(ef_cur_word_);
+                }
+
+                // every one after that zero belongs to a bucket >= h
+                auto inverted = ~ef_cur_word_ & (~uint64_t{0} << off);
+                auto zero_pos
+                    = ef_word_idx_ * 64
+                      + succinct::broadword::select_in_word(inverted, need - 1);
+                auto after = zero_pos + 1;
+                pos_ = after - h;
+                if (pos_ >= size_)
+                {
+                    stream_ = {nullptr};
+                    size_ = 0;
+                    pos_ = 0;
+                    return;
+                }
+
+                ef_scan_pos_ = after;
+                ef_word_idx_ = after / 64;
+                ef_cur_word_ = load_word(ef_high_, ef_word_idx_);
+                if (auto rem = after % 64)
+                    ef_cur_word_ &= ~uint64_t{0} << rem;
+            }
+
+            while (true)
+            {
+                if (pos_ == size_)
+                {
+                    stream_ = {nullptr};
+                    size_ = 0;
+                    pos_ = 0;
+                    return;
+                }
+                refill_ef();
+                if (ids_[block_len_ - 1] >= tgt)
+                    break;
+                pos_ += block_len_;
+                block_pos_ = block_len_;
+            }
+            land_in_block(tgt);
+        }
+
+        /**
+         * Positions the iterator on the first entry in the current block
+         * whose id is at least the target. The caller guarantees such an
+         * entry exists.
+         */
+        void land_in_block(uint64_t tgt)
+        {
+            auto begin = ids_.begin()
+                         + static_cast<std::ptrdiff_t>(block_pos_);
+            auto end
+                = ids_.begin() + static_cast<std::ptrdiff_t>(block_len_);
+            auto it = std::lower_bound(begin, end, tgt);
+            auto idx = static_cast<uint64_t>(it - ids_.begin());
+            pos_ += idx + 1 - block_pos_;
+            block_pos_ = idx + 1;
+            count_.first = SecondaryKey{ids_[idx]};
+            count_.second = counts_[idx];
+        }
+
         char_input_stream stream_;
         uint64_t size_;
         uint64_t pos_;
         value_type count_;
+        /// decoded (still gap-encoded until accumulated) ids for the block
+        alignas(64) std::array<uint64_t, io::packed::block_size> ids_;
+        /// decoded counts for the block
+        alignas(64) std::array<FeatureValue, io::packed::block_size> counts_;
+        /// number of entries decoded into the current block
+        uint64_t block_len_ = 0;
+        /// position of the next entry to consume from the current block
+        uint64_t block_pos_ = 0;
+        /// the last absolute id handed out, for gap accumulation
+        uint64_t prev_id_ = 0;
+        /// cursor into the skip table entry for the next undecoded block
+        const char* skips_ = nullptr;
+        /// the number of blocks that have not yet been decoded or skipped
+        uint64_t blocks_left_ = 0;
+        /// the last id of the most recent block consumed from the table
+        uint64_t skip_last_id_ = 0;
+        /// the maximum count within the current block (0 if unknown);
+        /// for Elias-Fano lists this is the list-wide maximum
+        FeatureValue block_max_{};
+        /// whether this list is Elias-Fano encoded
+        bool ef_ = false;
+        /// the high-bits array of the encoded ids
+        const char* ef_high_ = nullptr;
+        /// the bit-packed low halves of the encoded ids
+        const char* ef_low_ = nullptr;
+        /// the fixed-width bit-packed counts
+        const char* ef_counts_ = nullptr;
+        /// bits per low half
+        uint8_t ef_low_bits_ = 0;
+        /// bits per count
+        uint8_t ef_count_bits_ = 0;
+        /// the word of the high-bits array the scan cursor is inside of
+        uint64_t ef_word_idx_ = 0;
+        /// that word with all consumed ones cleared
+        uint64_t ef_cur_word_ = 0;
+        /// the bit position just past the last consumed one
+        uint64_t ef_scan_pos_ = 0;
     };
 
     /**
@@ -201,7 +610,10 @@ class postings_stream
      */
     iterator begin() const
     {
-        return {start_, size_};
+        if (ef_)
+            return {ef_high_,     ef_low_,        ef_counts_, size_,
+                    ef_low_bits_, ef_count_bits_, max_count_};
+        return {start_, size_, skips_, num_blocks_};
     }
 
     /**
@@ -216,6 +628,24 @@ class postings_stream
     const char* start_;
     uint64_t size_;
     FeatureValue total_counts_;
+    /// the start of the inline skip table, if this list has one
+    const char* skips_ = nullptr;
+    /// the number of blocks in this list (0 when there is no skip table)
+    uint64_t num_blocks_ = 0;
+    /// an upper bound on any single count in this list
+    FeatureValue max_count_{};
+    /// whether this list is Elias-Fano encoded
+    bool ef_ = false;
+    /// the high-bits array of the encoded ids
+    const char* ef_high_ = nullptr;
+    /// the bit-packed low halves of the encoded ids
+    const char* ef_low_ = nullptr;
+    /// the fixed-width bit-packed counts
+    const char* ef_counts_ = nullptr;
+    /// bits per low half
+    uint8_t ef_low_bits_ = 0;
+    /// bits per count
+    uint8_t ef_count_bits_ = 0;
 };
 }
 }
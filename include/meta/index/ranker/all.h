@@ -4,6 +4,8 @@
 #include "meta/index/ranker/jelinek_mercer.h"
 #include "meta/index/ranker/lm_ranker.h"
 #include "meta/index/ranker/okapi_bm25.h"
+#include "meta/index/ranker/okapi_bm25f.h"
 #include "meta/index/ranker/pivoted_length.h"
 #include "meta/index/ranker/kl_divergence_prf.h"
+#include "meta/index/ranker/ltr_reranker.h"
 #include "meta/index/ranker/rocchio.h"
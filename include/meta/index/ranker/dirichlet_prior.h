@@ -66,6 +66,14 @@ class dirichlet_prior : public language_model_ranker
      */
     float doc_constant(const score_data& sd) const override;
 
+    /**
+     * Dispatches into detail::daat_rank() so score_one() is statically
+     * bound inside the scoring loop.
+     */
+    std::vector<search_result>
+    rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                    const filter_function_type& filter) override;
+
   private:
     /// the Dirichlet prior parameter
     const float mu_;
@@ -0,0 +1,77 @@
+/**
+ * @file feedback.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_RANKER_FEEDBACK_H_
+#define META_INDEX_RANKER_FEEDBACK_H_
+
+#include "meta/config.h"
+#include "meta/hashing/probe_map.h"
+#include "meta/index/ranker/ranker.h"
+
+namespace meta
+{
+namespace index
+{
+namespace feedback
+{
+
+/**
+ * Fingerprints one retrieval pass for the feedback distribution cache:
+ * the (sorted) query term weights, the index name, and the ids of the
+ * retrieved feedback documents. Two passes with the same fingerprint are
+ * guaranteed to produce the same feedback term distribution, so the
+ * model estimation and its forward index reads can be skipped on a hit.
+ *
+ * @param ctx The ranker_context the first pass was scored with
+ * @param fb_docs The feedback documents retrieved by the first pass
+ * @return the fingerprint
+ */
+uint64_t fingerprint(const ranker_context& ctx,
+                     const std::vector<search_result>& fb_docs);
+
+/**
+ * Runs the first retrieval pass for a feedback ranker, recording the
+ * candidate set (every document matching at least one query term and
+ * accepted by the filter) as a side effect. The second pass over the
+ * expanded query is then restricted to this set, so its cost is bounded
+ * by the documents the original query already touched instead of the
+ * (much larger) union of the expansion terms' postings.
+ *
+ * @param initial The wrapped first-pass ranker
+ * @param ctx The ranker_context for the original query (consumed)
+ * @param k The number of feedback documents to retrieve
+ * @param filter The filter function to be used
+ * @param candidates Output parameter for the recorded candidate set
+ * @return the top k documents under the wrapped ranker
+ */
+std::vector<search_result>
+initial_pass(ranker& initial, ranker_context& ctx, uint64_t k,
+             const ranker::filter_function_type& filter, doc_set& candidates);
+
+/**
+ * Scores an expanded query against only the first-pass candidate set.
+ * The set is pushed down into the postings traversal, so each expansion
+ * term's postings are skipped through via skip_to() over the candidates
+ * instead of being decoded in full.
+ *
+ * @param initial The wrapped ranker to score with
+ * @param idx The index to score against
+ * @param query The expanded query
+ * @param candidates The first-pass candidate set
+ * @param num_results The number of results to return
+ * @return the top documents under the expanded query
+ */
+std::vector<search_result>
+second_pass(ranker& initial, inverted_index& idx,
+            const hashing::probe_map<term_id, float>& query,
+            const doc_set& candidates, uint64_t num_results);
+}
+}
+}
+#endif
@@ -68,6 +68,14 @@ class jelinek_mercer : public language_model_ranker
      */
     float doc_constant(const score_data& sd) const override;
 
+    /**
+     * Dispatches into detail::daat_rank() so score_one() is statically
+     * bound inside the scoring loop.
+     */
+    std::vector<search_result>
+    rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                    const filter_function_type& filter) override;
+
   private:
     /// the JM parameter
     const float lambda_;
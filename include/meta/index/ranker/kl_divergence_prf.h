@@ -10,6 +10,11 @@
 #ifndef META_INDEX_KL_DIVERGENCE_PRF_H_
 #define META_INDEX_KL_DIVERGENCE_PRF_H_
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "meta/caching/concurrent_cache.h"
 #include "meta/index/ranker/lm_ranker.h"
 #include "meta/index/ranker/ranker_factory.h"
 
@@ -41,6 +46,11 @@ namespace index
  * method = "dirichlet-prior" # the initial model used to retrieve documents
  * # other parameters for that initial retrieval method
  * ~~~
+ *
+ * The second retrieval pass is restricted to the documents matching the
+ * original query (see feedback::second_pass()), and the learned feedback
+ * term distributions are cached per query fingerprint, so repeated
+ * queries skip the EM step entirely.
  */
 class kl_divergence_prf : public ranker
 {
@@ -63,6 +73,12 @@ class kl_divergence_prf : public ranker
      */
     const static constexpr uint64_t default_max_terms = 50;
 
+    /**
+     * The number of feedback term distributions cached per ranker
+     * instance.
+     */
+    const static constexpr uint64_t default_cache_size = 256;
+
     kl_divergence_prf(std::shared_ptr<forward_index> fwd);
 
     kl_divergence_prf(std::shared_ptr<forward_index> fwd,
@@ -80,12 +96,19 @@ class kl_divergence_prf : public ranker
          const filter_function_type& filter) override;
 
   private:
+    /// a feedback term distribution: the top terms and their weights
+    using feedback_terms = std::vector<std::pair<term_id, float>>;
+
     std::shared_ptr<forward_index> fwd_;
     std::unique_ptr<language_model_ranker> initial_ranker_;
     const float alpha_;
     const float lambda_;
     const uint64_t k_;
     const uint64_t max_terms_;
+
+    /// cached feedback term distributions, keyed by query fingerprint
+    caching::concurrent_cache<uint64_t, std::shared_ptr<const feedback_terms>>
+        fb_cache_{default_cache_size};
 };
 
 /**
@@ -0,0 +1,146 @@
+/**
+ * @file ltr_reranker.h
+ * @author Sean Massung
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_LTR_RERANKER_H_
+#define META_LTR_RERANKER_H_
+
+#include <memory>
+#include <vector>
+
+#include "meta/index/ranker/ranker.h"
+#include "meta/learn/instance.h"
+#include "meta/learn/loss/least_squares.h"
+#include "meta/learn/loss/loss_function_factory.h"
+#include "meta/learn/sgd.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * The per-document feature vector extracted for learning to rank: one
+ * feature per base ranking function, plus the matched-query-term
+ * fraction, (log-damped) document length statistics, and the first
+ * stage's score and reciprocal rank.
+ */
+struct ltr_candidate
+{
+    /// the document these features describe
+    doc_id d_id;
+
+    /// the first-stage retrieval score
+    float first_stage_score;
+
+    /// the dense feature vector (see ltr_reranker::num_features())
+    learn::feature_vector features;
+};
+
+/**
+ * A second-stage, learning-to-rank pass over the top k results of a
+ * first-stage retrieval, applied in-process so reranking costs neither
+ * a result serialization nor a service hop.
+ *
+ * Features for every surviving candidate are extracted in a single
+ * document-at-a-time traversal restricted to the candidate set (the
+ * postings are read once no matter how many ranking functions
+ * contribute features, following score_multi()), and the reranking
+ * model is a linear learn::sgd_model trained online through
+ * train_one() with a pluggable loss function against whatever
+ * relevance signal is available (judgments, clicks).
+ */
+class ltr_reranker
+{
+  public:
+    /// how deep into the first-stage results rerank() looks by default
+    const static constexpr uint64_t default_rerank_depth = 100;
+
+    /**
+     * @param feature_rankers The ranking functions whose scores become
+     * features; their score_one() must be evaluable against this index
+     * @param loss The loss function to train the linear model with
+     * @param options Options for the underlying sgd_model
+     */
+    ltr_reranker(std::vector<std::unique_ptr<ranking_function>> feature_rankers,
+                 std::unique_ptr<learn::loss::loss_function> loss
+                 = learn::loss::make_loss_function<learn::loss::least_squares>(),
+                 learn::sgd_model::options_type options = {});
+
+    /**
+     * Loads a reranker (feature rankers, loss, and model) from a stream.
+     */
+    ltr_reranker(std::istream& in);
+
+    /**
+     * Saves the reranker to a stream.
+     */
+    void save(std::ostream& out) const;
+
+    /**
+     * @return the number of features each candidate vector contains:
+     * one per feature ranker plus the five fixed features
+     */
+    std::size_t num_features() const;
+
+    /**
+     * Extracts feature vectors for a set of first-stage results in one
+     * postings traversal over the candidate documents.
+     *
+     * @param idx The index the results came from
+     * @param query The query that produced them
+     * @param results The first-stage results to featurize
+     * @return a candidate per result, in result order
+     */
+    std::vector<ltr_candidate>
+    extract(inverted_index& idx, const corpus::document& query,
+            const std::vector<search_result>& results) const;
+
+    /**
+     * @param candidate The candidate to score
+     * @return the linear model's score for the candidate
+     */
+    double predict(const ltr_candidate& candidate) const;
+
+    /**
+     * Reorders the top of a first-stage result list by the model's
+     * scores. Only the first `depth` results are featurized and
+     * reordered; any tail beyond the depth keeps its first-stage order.
+     *
+     * @param idx The index the results came from
+     * @param query The query that produced them
+     * @param results The first-stage results
+     * @param depth How many leading results to rerank
+     * @return the reranked results
+     */
+    std::vector<search_result>
+    rerank(inverted_index& idx, const corpus::document& query,
+           std::vector<search_result> results,
+           uint64_t depth = default_rerank_depth) const;
+
+    /**
+     * Performs one online training step against a relevance signal.
+     *
+     * @param candidate The judged candidate
+     * @param relevance The relevance signal for the candidate
+     * @return the loss incurred for this example
+     */
+    double train_one(const ltr_candidate& candidate, double relevance);
+
+  private:
+    /// the ranking functions whose scores become features
+    std::vector<std::unique_ptr<ranking_function>> rankers_;
+
+    /// the loss to train with
+    std::unique_ptr<learn::loss::loss_function> loss_;
+
+    /// the linear reranking model
+    std::unique_ptr<learn::sgd_model> model_;
+};
+}
+}
+#endif
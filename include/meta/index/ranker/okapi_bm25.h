@@ -67,6 +67,22 @@ class okapi_bm25 : public ranking_function
      */
     float score_one(const score_data& sd) override;
 
+    /**
+     * BM25 is nondecreasing in doc_term_count and nonincreasing in
+     * doc_size, so the best-case statistics the ranker fills in give a
+     * valid term upper bound for WAND pruning.
+     * @param sd score_data describing the term's best case
+     */
+    float score_upper_bound(const score_data& sd) override;
+
+    /**
+     * Dispatches into detail::daat_rank() so score_one() is statically
+     * bound inside the scoring loop.
+     */
+    std::vector<search_result>
+    rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                    const filter_function_type& filter) override;
+
     void save(std::ostream& out) const override;
 
   private:
@@ -0,0 +1,130 @@
+/**
+ * @file okapi_bm25f.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_OKAPI_BM25F_H_
+#define META_OKAPI_BM25F_H_
+
+#include "meta/index/ranker/ranker.h"
+#include "meta/index/ranker/ranker_factory.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * The BM25F weighted-field scoring function. Each query term's frequency
+ * in a document is accumulated over the per-field postings emitted by
+ * field_analyzer (plus, optionally, the un-fielded content terms), with a
+ * per-field weight applied before the usual BM25 saturation. All fields
+ * live in one index under one document space, so a query is scored over
+ * every field in a single document-at-a-time postings traversal rather
+ * than by federating one index per field.
+ *
+ * This is the simplified BM25F of Robertson et al. where the length
+ * normalization is shared across fields (per-field document lengths are
+ * not stored in the index). Query terms that never occur in any
+ * document's main content are dropped during query processing and are
+ * thus not scored, even if they occur in a field.
+ *
+ * Required config parameters:
+ * ~~~toml
+ * [ranker]
+ * method = "bm25f"
+ * [[ranker.fields]]
+ * field = "title"
+ * weight = 2.0
+ * ~~~
+ *
+ * Optional config parameters:
+ * ~~~toml
+ * content-weight = 1.0 # weight of the un-fielded content terms; 0 skips
+ * k1 = 1.2
+ * b = 0.75
+ * k3 = 500.0
+ * ~~~
+ */
+class okapi_bm25f : public ranker
+{
+  public:
+    /// The identifier for this ranker.
+    const static util::string_view id;
+
+    /// Default weight of the un-fielded content terms
+    const static constexpr float default_content_weight = 1.0f;
+
+    /// Default k1, doc term smoothing
+    const static constexpr float default_k1 = 1.2f;
+
+    /// Default b, length normalization
+    const static constexpr float default_b = 0.75f;
+
+    /// Default k3, query term smoothing
+    const static constexpr float default_k3 = 500.0f;
+
+    /**
+     * A per-field term frequency weight.
+     */
+    struct field_weight
+    {
+        /// The metadata field name, as configured for field_analyzer
+        std::string field;
+        /// The weight applied to term frequencies from this field
+        float weight;
+    };
+
+    /**
+     * @param fields The fields to score and their weights
+     * @param content_weight The weight of the un-fielded content terms
+     * @param k1 Doc term smoothing
+     * @param b Length normalization
+     * @param k3 Query term smoothing
+     */
+    okapi_bm25f(std::vector<field_weight> fields,
+                float content_weight = default_content_weight,
+                float k1 = default_k1, float b = default_b,
+                float k3 = default_k3);
+
+    /**
+     * Loads an okapi_bm25f ranker from a stream.
+     * @param in The stream to read from
+     */
+    okapi_bm25f(std::istream& in);
+
+    void save(std::ostream& out) const override;
+
+    std::vector<search_result> rank(ranker_context& ctx, uint64_t num_results,
+                                    const filter_function_type& filter)
+        override;
+
+  private:
+    /// The fields to score and their weights
+    std::vector<field_weight> fields_;
+
+    /// The weight of the un-fielded content terms (0 disables them)
+    const float content_weight_;
+
+    /// Doc term smoothing
+    const float k1_;
+
+    /// Length normalization
+    const float b_;
+
+    /// Query term smoothing
+    const float k3_;
+};
+
+/**
+ * Specialization of the factory method used to create okapi_bm25f
+ * rankers.
+ */
+template <>
+std::unique_ptr<ranker> make_ranker<okapi_bm25f>(const cpptoml::table&);
+}
+}
+#endif
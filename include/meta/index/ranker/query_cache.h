@@ -0,0 +1,117 @@
+/**
+ * @file query_cache.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_RANKER_QUERY_CACHE_H_
+#define META_INDEX_RANKER_QUERY_CACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "meta/caching/concurrent_cache.h"
+#include "meta/config.h"
+#include "meta/index/ranker/ranker.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * A results cache that sits in front of ranker::score for workloads with
+ * many duplicate queries. Queries are fingerprinted by hashing the
+ * *analyzed* term multiset (so trivial variations that tokenize the same
+ * way share an entry) together with the ranker's saved parameters and the
+ * requested number of results. Cached top-k vectors expire after a TTL
+ * and whenever the cache's index generation is bumped, so results can be
+ * invalidated when the underlying index is rebuilt or appended to.
+ *
+ * The cache is safe for concurrent use from multiple query threads; the
+ * hit path is lock-free (see caching::concurrent_cache).
+ */
+class query_cache
+{
+  public:
+    /**
+     * @param max_size The (approximate) maximum number of cached result
+     * vectors
+     * @param ttl How long a cached result may be served before it expires
+     */
+    query_cache(uint64_t max_size,
+                std::chrono::seconds ttl = std::chrono::seconds{300});
+
+    /**
+     * Scores a query, serving the result from the cache if an unexpired
+     * entry for the same fingerprint exists and scoring (then caching)
+     * otherwise.
+     *
+     * @param r The ranker to score with on a miss
+     * @param idx The index to score against
+     * @param query The query to score
+     * @param num_results The number of results to return
+     * @return the top documents in descending score order
+     */
+    std::vector<search_result> score(ranker& r, inverted_index& idx,
+                                     const corpus::document& query,
+                                     uint64_t num_results = 10);
+
+    /**
+     * Invalidates every cached result by advancing the index generation;
+     * call this after the underlying index changes.
+     */
+    void bump_generation();
+
+    /**
+     * @return the number of queries served from the cache
+     */
+    uint64_t hits() const;
+
+    /**
+     * @return the number of queries that had to be scored
+     */
+    uint64_t misses() const;
+
+  private:
+    /// a cached result vector along with its expiration information
+    struct entry
+    {
+        std::vector<search_result> results;
+        uint64_t generation;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    /**
+     * @param r The ranker whose parameters form part of the key
+     * @param idx The index used to analyze the query
+     * @param query The query to fingerprint
+     * @param num_results The requested result count
+     * @return the fingerprint for this (query, ranker, k) combination
+     */
+    uint64_t fingerprint(ranker& r, inverted_index& idx,
+                         const corpus::document& query,
+                         uint64_t num_results) const;
+
+    /// the cached result vectors, keyed by fingerprint
+    caching::concurrent_cache<uint64_t, std::shared_ptr<const entry>> cache_;
+
+    /// how long entries remain servable
+    std::chrono::seconds ttl_;
+
+    /// the current index generation; stale entries are treated as misses
+    std::atomic<uint64_t> generation_{0};
+
+    /// the number of queries served from the cache
+    std::atomic<uint64_t> hits_{0};
+
+    /// the number of queries that required scoring
+    std::atomic<uint64_t> misses_{0};
+};
+}
+}
+#endif
@@ -0,0 +1,213 @@
+/**
+ * @file query_stats.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_INDEX_QUERY_STATS_H_
+#define META_INDEX_QUERY_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * Opt-in, low-overhead instrumentation for query scoring. When enabled,
+ * ranker::score() records per-phase latencies and candidate/cache
+ * counters into lock-free per-thread collectors; collect() merges them
+ * into a snapshot of log-scale latency histograms so tail behavior (p99
+ * spikes and the like) can be inspected without attaching a profiler to
+ * a production box.
+ *
+ * When disabled (the default), the hot path pays only a relaxed atomic
+ * load per phase, so it is safe to leave the instrumentation points
+ * compiled in everywhere.
+ */
+class query_stats
+{
+  public:
+    /**
+     * The phases of query evaluation that are timed. Postings decode is
+     * folded into the scoring phase: decoding is interleaved per-posting
+     * with score_one() in document-at-a-time ranking, and timing each
+     * posting individually would cost more than it reveals.
+     */
+    enum class phase : uint8_t
+    {
+        /// fetching the postings streams for the query terms
+        fetch = 0,
+        /// the document-at-a-time scoring loop
+        score,
+        /// extracting the sorted top-k from the result heap
+        heap,
+        /// the whole of ranker::score()
+        total
+    };
+    const static std::size_t num_phases = 4;
+
+    /**
+     * Event counters accumulated alongside the latency histograms.
+     */
+    enum class counter : uint8_t
+    {
+        /// queries scored
+        queries = 0,
+        /// documents entering the scoring loop
+        candidates,
+        /// postings lists served from a cached_index's cache
+        cache_hits,
+        /// postings lists that had to be read from the index
+        cache_misses
+    };
+    const static std::size_t num_counters = 4;
+
+    /**
+     * A latency histogram with power-of-two microsecond buckets: bucket
+     * b counts observations in [2^b, 2^(b+1)) microseconds.
+     */
+    struct histogram
+    {
+        const static std::size_t num_buckets = 32;
+
+        std::array<uint64_t, num_buckets> buckets;
+        /// the number of observations
+        uint64_t count;
+        /// the sum of all observations, in microseconds
+        uint64_t total;
+
+        histogram();
+
+        /**
+         * @param usecs An observed latency, in microseconds
+         */
+        void add(uint64_t usecs);
+
+        /**
+         * @param other Another histogram to accumulate into this one
+         */
+        void merge(const histogram& other);
+
+        /**
+         * @param q The desired quantile, in [0, 1]
+         * @return an upper bound, in microseconds, on the q-th quantile
+         * of the observations (the top of the bucket containing it)
+         */
+        uint64_t quantile(double q) const;
+    };
+
+    /**
+     * A merged view over every thread's collector.
+     */
+    struct snapshot
+    {
+        std::array<histogram, num_phases> phases;
+        std::array<uint64_t, num_counters> counters;
+
+        snapshot();
+    };
+
+    /**
+     * Turns recording on.
+     */
+    static void enable();
+
+    /**
+     * Turns recording off. Accumulated statistics are retained.
+     */
+    static void disable();
+
+    /**
+     * @return whether recording is currently on
+     */
+    static bool enabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Records a phase latency into this thread's collector. A no-op when
+     * recording is off.
+     *
+     * @param p The phase that was timed
+     * @param usecs The elapsed time, in microseconds
+     */
+    static void record_time(phase p, uint64_t usecs);
+
+    /**
+     * Adds to an event counter in this thread's collector. A no-op when
+     * recording is off.
+     *
+     * @param c The counter to add to
+     * @param num The amount to add
+     */
+    static void record_count(counter c, uint64_t num = 1);
+
+    /**
+     * @return a snapshot merging the statistics recorded by every thread
+     */
+    static snapshot collect();
+
+    /**
+     * Zeroes the statistics of every thread's collector.
+     */
+    static void reset();
+
+    /**
+     * Times one phase over its lifetime (or until stop()) and records
+     * the result. Reads the clock only when recording is on.
+     */
+    class scoped_timer
+    {
+      public:
+        scoped_timer(phase p) : phase_{p}, active_{enabled()}
+        {
+            if (active_)
+                start_ = std::chrono::steady_clock::now();
+        }
+
+        ~scoped_timer()
+        {
+            stop();
+        }
+
+        /**
+         * Records the elapsed time now instead of at destruction.
+         */
+        void stop()
+        {
+            if (active_)
+            {
+                auto elapsed = std::chrono::steady_clock::now() - start_;
+                record_time(
+                    phase_,
+                    static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            elapsed)
+                            .count()));
+                active_ = false;
+            }
+        }
+
+      private:
+        std::chrono::steady_clock::time_point start_;
+        phase phase_;
+        bool active_;
+    };
+
+  private:
+    /// whether instrumentation points should record anything
+    static std::atomic<bool> enabled_;
+};
+}
+}
+#endif
@@ -9,11 +9,21 @@
 #ifndef META_RANKER_H_
 #define META_RANKER_H_
 
+#include <chrono>
+#include <future>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "meta/index/inverted_index.h"
+#include "meta/index/metadata_bitmap.h"
+#include "meta/index/ranker/query_stats.h"
+#include "meta/index/score_data.h"
 #include "meta/meta.h"
+#include "meta/parallel/thread_pool.h"
+#include "meta/util/fixed_heap.h"
 
 namespace meta
 {
@@ -64,6 +74,7 @@ struct postings_context
     float query_term_weight;
     uint64_t doc_count;
     uint64_t corpus_term_count;
+    uint64_t max_tf;
 
     postings_context(postings_stream<doc_id> strm, float qtf, term_id term)
         : stream{std::move(strm)},
@@ -72,7 +83,27 @@ struct postings_context
           t_id{term},
           query_term_weight{qtf},
           doc_count{stream.size()},
-          corpus_term_count{stream.total_counts()}
+          corpus_term_count{stream.total_counts()},
+          max_tf{stream.max_count()}
+    {
+        // nothing
+    }
+
+    /**
+     * Constructor for callers that already have the term's statistics
+     * in memory (see inverted_index::term_stats()), avoiding the
+     * postings header reads the other constructor performs.
+     */
+    postings_context(postings_stream<doc_id> strm, float qtf, term_id term,
+                     const inverted_index::term_stat& stats)
+        : stream{std::move(strm)},
+          begin{stream.begin()},
+          end{stream.end()},
+          t_id{term},
+          query_term_weight{qtf},
+          doc_count{stats.doc_count},
+          corpus_term_count{stats.corpus_term_count},
+          max_tf{stats.max_tf}
     {
         // nothing
     }
@@ -89,6 +120,108 @@ inline term_id get_term_id(disk_index&, term_id tid)
 }
 }
 
+/**
+ * Collection-wide statistics injected into scoring when a query fans
+ * out across several index shards (e.g. through segmented_index). The
+ * per-shard values of the same statistics make scores incomparable
+ * between shards, so a broker aggregates them once per query and every
+ * shard scores against the aggregate.
+ */
+struct corpus_stats
+{
+    /**
+     * Statistics for one query term, aggregated across shards.
+     */
+    struct term_stats
+    {
+        /// the number of documents the term appears in
+        uint64_t doc_count;
+        /// the total number of occurrences of the term
+        uint64_t corpus_term_count;
+    };
+
+    /// the total number of documents
+    uint64_t num_docs;
+
+    /// the total number of term occurrences
+    uint64_t total_corpus_terms;
+
+    /// the aggregated statistics for each query term
+    std::unordered_map<std::string, term_stats> terms;
+
+    /// @return the average document length across the collection
+    float avg_doc_length() const
+    {
+        return static_cast<float>(total_corpus_terms) / num_docs;
+    }
+};
+
+/**
+ * A per-query time/work budget for anytime ranking. When the budget
+ * runs out mid-traversal, scoring stops and the best-so-far top k is
+ * returned instead of the exact answer: under a traffic spike, slightly
+ * worse results now beat perfect results after the client has given up.
+ * Either limit may be left at its zero default to disable it.
+ */
+struct score_budget
+{
+    /// the maximum number of postings to score (0 = unlimited)
+    uint64_t max_postings = 0;
+
+    /// wall-clock limit on the traversal (zero = unlimited)
+    std::chrono::microseconds deadline{0};
+
+    /// set on return: whether the budget cut the traversal short, in
+    /// which case the results are best-so-far rather than exact
+    bool degraded = false;
+};
+
+/**
+ * Reusable per-query scoring buffers. Every allocation ranking makes in
+ * steady state — the postings cursors, the top-k heap, and the WAND
+ * bookkeeping vectors — draws from and returns to one of these instead
+ * of the heap, so a thread that scores through the same scratch pays
+ * its allocations only on the first few queries. A scratch may be used
+ * by one query at a time; pool one per thread.
+ *
+ * The result vector handed back by a scratch-scored query *is* the
+ * heap buffer; move it back into results once consumed to complete the
+ * cycle:
+ *
+ * ~~~cpp
+ * ranker::scratch scratch;
+ * for (const auto& query : queries)
+ * {
+ *     auto results = rnk.score(idx, query, scratch);
+ *     consume(results);
+ *     scratch.results = std::move(results);
+ * }
+ * ~~~
+ */
+struct ranker_scratch
+{
+    /// the postings cursors (reused by ranker_context)
+    std::vector<detail::postings_context> postings;
+
+    /// the top-k heap buffer, returned to the caller as the results
+    std::vector<search_result> results;
+
+    /// per-term score upper bounds (used by WAND pruning)
+    std::vector<float> bounds;
+
+    /// term traversal order (used by WAND pruning)
+    std::vector<std::size_t> order;
+
+    /// empties every buffer, keeping its capacity
+    void clear()
+    {
+        postings.clear();
+        results.clear();
+        bounds.clear();
+        order.clear();
+    }
+};
+
 /**
  * Stores a list of postings_stream and other relevant information for
  * performing document-at-a-time ranking. You should not generally have to
@@ -106,9 +239,52 @@ struct ranker_context
     ranker_context(inverted_index& inv, ForwardIterator begin,
                    ForwardIterator end, FilterFunction&& filter)
         : idx(inv), cur_doc{idx.num_docs()}
+    {
+        init(begin, end, std::forward<FilterFunction>(filter));
+    }
+
+    /**
+     * Constructor that borrows its postings buffer from a scratch
+     * (returning it on destruction), so repeated queries through the
+     * same scratch reuse its capacity instead of reallocating.
+     */
+    template <class ForwardIterator, class FilterFunction>
+    ranker_context(inverted_index& inv, ForwardIterator begin,
+                   ForwardIterator end, FilterFunction&& filter,
+                   ranker_scratch& s)
+        : idx(inv), cur_doc{idx.num_docs()}, scratch{&s}
+    {
+        postings = std::move(s.postings);
+        postings.clear();
+        init(begin, end, std::forward<FilterFunction>(filter));
+    }
+
+    ~ranker_context()
+    {
+        if (scratch)
+        {
+            postings.clear();
+            scratch->postings = std::move(postings);
+        }
+    }
+
+  private:
+    template <class ForwardIterator, class FilterFunction>
+    void init(ForwardIterator begin, ForwardIterator end,
+              FilterFunction&& filter)
     {
         postings.reserve(static_cast<std::size_t>(std::distance(begin, end)));
 
+        // issue readahead hints for every term's postings list before
+        // opening any stream: on a cold cache this overlaps the disk
+        // reads for a multi-term query instead of serializing them
+        for (auto it = begin; it != end; ++it)
+        {
+            using kv_traits = hashing::kv_traits<
+                typename std::decay<decltype(*it)>::type>;
+            inv.prefetch(detail::get_term_id(inv, kv_traits::key(*it)));
+        }
+
         query_length = 0.0;
         for (; begin != end; ++begin)
         {
@@ -123,7 +299,10 @@ struct ranker_context
             if (!pstream)
                 continue;
 
-            postings.emplace_back(*pstream, kv_traits::value(count), term);
+            // term statistics come from the in-memory table rather than
+            // the postings header
+            postings.emplace_back(*pstream, kv_traits::value(count), term,
+                                  inv.term_stats(term));
 
             while (postings.back().begin != postings.back().end
                    && !filter(postings.back().begin->first))
@@ -137,12 +316,106 @@ struct ranker_context
         }
     }
 
+  public:
     inverted_index& idx;
     std::vector<detail::postings_context> postings;
     float query_length;
     doc_id cur_doc;
+
+    /**
+     * Optional pre-computed filter set that is intersected with the
+     * postings during traversal: rejected runs of documents are jumped
+     * over via skip_to() instead of being stepped through one posting
+     * at a time. When set, it must accept exactly the documents the
+     * filter callback accepts. Set by ranker::score() when scoring with
+     * a doc_set filter.
+     */
+    const doc_set* pushdown = nullptr;
+
+    /**
+     * Optional collection-wide statistics that replace this index's own
+     * statistics during scoring, so scores computed on one shard of a
+     * collection are comparable with the other shards'. Set by
+     * ranker::score() when scoring with a corpus_stats.
+     */
+    const corpus_stats* global = nullptr;
+
+    /**
+     * Optional per-query budget consulted during traversal. Set by
+     * ranker::score() when scoring with a score_budget; its degraded
+     * flag is raised if the traversal stops early.
+     */
+    score_budget* budget = nullptr;
+
+    /// when a budgeted traversal must stop (set when budget has a deadline)
+    std::chrono::steady_clock::time_point stop_time{};
+
+    /**
+     * Optional scratch whose buffers back this query. The postings
+     * buffer is returned on destruction; the scoring loops reuse the
+     * remaining buffers directly.
+     */
+    ranker_scratch* scratch = nullptr;
 };
 
+namespace detail
+{
+/**
+ * Applies a score_budget to a constructed context before ranking
+ * begins. The terms are reordered rarest first and, when the posting
+ * budget cannot cover every list, the longest (lowest-impact) lists
+ * are shed entirely so the budget is spent on the highest-IDF terms.
+ * Sets ctx.budget and, for deadline budgets, ctx.stop_time.
+ */
+void apply_budget(ranker_context& ctx, score_budget& budget);
+
+/**
+ * Checks a budgeted traversal for exhaustion, raising the degraded
+ * flag when it trips. The posting-count check is an integer compare;
+ * the wall clock is consulted only once every 64 candidate documents
+ * to keep it off the hot path.
+ */
+inline bool budget_exhausted(ranker_context& ctx, uint64_t postings_scored,
+                             uint64_t candidates)
+{
+    auto& budget = *ctx.budget;
+    if (budget.max_postings > 0 && postings_scored >= budget.max_postings)
+    {
+        budget.degraded = true;
+        return true;
+    }
+    if (budget.deadline.count() > 0 && (candidates & 0x3f) == 0
+        && std::chrono::steady_clock::now() >= ctx.stop_time)
+    {
+        budget.degraded = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Advances a postings cursor past the current document to the next one
+ * accepted by the filter. With a pushdown set, rejected runs are jumped
+ * over via skip_to() instead of stepping posting-by-posting.
+ */
+inline void advance(detail::postings_context& pc,
+                    const std::function<bool(doc_id)>& filter,
+                    const doc_set* pushdown)
+{
+    ++pc.begin;
+    if (pushdown)
+    {
+        while (pc.begin != pc.end && !pushdown->contains(pc.begin->first))
+            pc.begin.skip_to(pushdown->next_geq(pc.begin->first));
+    }
+    else
+    {
+        while (pc.begin != pc.end && !filter(pc.begin->first))
+            ++pc.begin;
+    }
+}
+}
+
 /**
  * Exception class for ranker interactions.
  */
@@ -161,6 +434,9 @@ class ranker
   public:
     using filter_function_type = std::function<bool(doc_id did)>;
 
+    /// reusable per-query scoring buffers; pool one per thread
+    using scratch = ranker_scratch;
+
     static bool passthrough(doc_id)
     {
         return true;
@@ -180,7 +456,47 @@ class ranker
     score(inverted_index& idx, ForwardIterator begin, ForwardIterator end,
           uint64_t num_results = 10, Function&& filter = passthrough)
     {
+        query_stats::scoped_timer total{query_stats::phase::total};
+        query_stats::record_count(query_stats::counter::queries);
+
+        query_stats::scoped_timer fetch{query_stats::phase::fetch};
         ranker_context ctx{idx, begin, end, filter};
+        fetch.stop();
+
+        return rank(ctx, num_results, filter);
+    }
+
+    /**
+     * Scores a query using the given scratch's pooled buffers, making
+     * steady-state scoring through the same scratch allocation-free:
+     * the postings cursors, top-k heap, and pruning bookkeeping all
+     * reuse the scratch's capacity. The returned vector is the
+     * scratch's result buffer; move it back into scratch.results once
+     * consumed to complete the cycle. One scratch serves one query at
+     * a time — pool one per thread.
+     *
+     * @param idx The index this ranker is operating on
+     * @param begin A forward iterator to the beginning of the term
+     * weights (pairs of std::string or term_id and a weight)
+     * @param end A forward iterator to the end of the above range
+     * @param s The scratch whose buffers to score with
+     * @param num_results The number of results to return in the vector
+     * @param filter A filtering function to apply to each doc_id; returns
+     * true if the document should be included in results
+     */
+    template <class ForwardIterator, class Function = bool (*)(doc_id)>
+    std::vector<search_result>
+    score(inverted_index& idx, ForwardIterator begin, ForwardIterator end,
+          scratch& s, uint64_t num_results = 10,
+          Function&& filter = passthrough)
+    {
+        query_stats::scoped_timer total{query_stats::phase::total};
+        query_stats::record_count(query_stats::counter::queries);
+
+        query_stats::scoped_timer fetch{query_stats::phase::fetch};
+        ranker_context ctx{idx, begin, end, filter, s};
+        fetch.stop();
+
         return rank(ctx, num_results, filter);
     }
 
@@ -196,6 +512,160 @@ class ranker
           uint64_t num_results = 10,
           const filter_function_type& filter = [](doc_id) { return true; });
 
+    /**
+     * Scores a query given directly as (term_id, weight) pairs,
+     * skipping tokenization and vocabulary map lookups entirely.
+     * Intended for programmatic callers (k-NN over already-analyzed
+     * documents, batch evaluation) that hold term ids; string queries
+     * that recur should be resolved once up front with
+     * disk_index::get_term_ids() and scored through this overload.
+     *
+     * @param idx The index this ranker is operating on
+     * @param query The query as (term_id, weight) pairs
+     * @param num_results The number of results to return in the vector
+     * @param filter A filtering function to apply to each doc_id; returns
+     * true if the document should be included in results
+     */
+    std::vector<search_result>
+    score(inverted_index& idx,
+          const std::vector<std::pair<term_id, float>>& query,
+          uint64_t num_results = 10,
+          const filter_function_type& filter = [](doc_id) { return true; });
+
+    /**
+     * Scores a query given directly as (term_id, weight) pairs using a
+     * scratch's pooled buffers. Combined with pre-resolved term ids,
+     * this is the allocation-free steady-state scoring path (the
+     * string-query overloads still allocate while tokenizing).
+     *
+     * @param idx The index this ranker is operating on
+     * @param query The query as (term_id, weight) pairs
+     * @param s The scratch whose buffers to score with
+     * @param num_results The number of results to return in the vector
+     * @param filter A filtering function to apply to each doc_id; returns
+     * true if the document should be included in results
+     */
+    std::vector<search_result>
+    score(inverted_index& idx,
+          const std::vector<std::pair<term_id, float>>& query, scratch& s,
+          uint64_t num_results = 10,
+          const filter_function_type& filter = [](doc_id) { return true; });
+
+    /**
+     * Scores a query against only the documents in a pre-computed
+     * filter set (e.g. one field value from a metadata_bitmap). Unlike
+     * the filter callback overload, the set is pushed down into the
+     * postings traversal: every cursor skips directly to the next
+     * accepted document, so highly selective filters ("search within
+     * category X") do not pay to step through the documents they
+     * reject.
+     *
+     * @param idx The index this ranker is operating on
+     * @param query The current query
+     * @param filter The set of documents to score
+     * @param num_results The number of results to return in the vector
+     */
+    std::vector<search_result> score(inverted_index& idx,
+                                     const corpus::document& query,
+                                     const doc_set& filter,
+                                     uint64_t num_results = 10);
+
+    /**
+     * Scores a query under a per-query time/work budget, returning the
+     * best-so-far top k if the budget runs out mid-traversal (anytime
+     * ranking). Terms are considered rarest first, so if the posting
+     * budget cannot cover every list the highest-impact (highest-IDF)
+     * terms are the ones that get scored. On return, budget.degraded
+     * reports whether the results are best-so-far rather than exact.
+     *
+     * @param idx The index this ranker is operating on
+     * @param query The current query
+     * @param budget The time/work budget for this query
+     * @param num_results The number of results to return in the vector
+     * @param filter A filtering function to apply to each doc_id; returns
+     * true if the document should be included in results
+     */
+    std::vector<search_result>
+    score(inverted_index& idx, const corpus::document& query,
+          score_budget& budget, uint64_t num_results = 10,
+          const filter_function_type& filter = [](doc_id) { return true; });
+
+    /**
+     * Scores a query against one shard of a collection using
+     * collection-wide statistics, so the scores are comparable across
+     * shards: the aggregated document frequencies, collection term
+     * counts, document count, and average document length replace the
+     * shard's own during scoring.
+     *
+     * @param idx The shard this ranker is operating on
+     * @param query The current query
+     * @param stats The collection-wide statistics for the query
+     * @param num_results The number of results to return in the vector
+     */
+    std::vector<search_result> score(inverted_index& idx,
+                                     const corpus::document& query,
+                                     const corpus_stats& stats,
+                                     uint64_t num_results = 10);
+
+    /**
+     * Scores a batch of queries in parallel, sharding the queries across
+     * the given thread pool. Each worker scores with its own score_data
+     * and postings streams, so throughput scales with the number of
+     * threads for index-bound workloads. The filter (shared across
+     * workers) must be safe to invoke concurrently, as must the index
+     * and this ranker; every ranking function shipped with MeTA is
+     * stateless during scoring.
+     *
+     * @param idx The index these queries are running on
+     * @param begin A forward iterator to the beginning of a range of
+     * corpus::document queries
+     * @param end A forward iterator to the end of the above range
+     * @param pool The thread pool to shard the queries across
+     * @param num_results The number of results to return per query
+     * @param filter A filtering function to apply to each doc_id
+     * @return the results for each query, in query order
+     */
+    template <class ForwardIterator, class Function = bool (*)(doc_id)>
+    std::vector<std::vector<search_result>>
+    score_batch(inverted_index& idx, ForwardIterator begin,
+                ForwardIterator end, parallel::thread_pool& pool,
+                uint64_t num_results = 10, Function&& filter = passthrough)
+    {
+        auto num_queries
+            = static_cast<std::size_t>(std::distance(begin, end));
+        std::vector<std::vector<search_result>> all_results(num_queries);
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(num_queries);
+        std::size_t pos = 0;
+        for (auto query = begin; query != end; ++query, ++pos)
+        {
+            futures.emplace_back(pool.submit_task([&, query, pos]() {
+                all_results[pos] = score(idx, *query, num_results, filter);
+            }));
+        }
+        for (auto& fut : futures)
+            fut.get();
+
+        return all_results;
+    }
+
+    /**
+     * Scores a batch of queries in parallel on a thread pool sized to
+     * the hardware concurrency.
+     * @see score_batch()
+     */
+    template <class ForwardIterator, class Function = bool (*)(doc_id)>
+    std::vector<std::vector<search_result>>
+    score_batch(inverted_index& idx, ForwardIterator begin,
+                ForwardIterator end, uint64_t num_results = 10,
+                Function&& filter = passthrough)
+    {
+        parallel::thread_pool pool;
+        return score_batch(idx, begin, end, pool, num_results,
+                           std::forward<Function>(filter));
+    }
+
     /**
      * Default destructor.
      */
@@ -240,10 +710,248 @@ class ranking_function : public ranker
      */
     virtual float initial_score(const score_data& sd) const;
 
+    /**
+     * Computes an upper bound on score_one() over every document for the
+     * term described by sd. The caller fills in doc_term_count with the
+     * maximum count of the term in any document (and sets doc_size and
+     * doc_unique_terms to match the smallest document that could hold
+     * it), so rankers whose score is nondecreasing in doc_term_count and
+     * nonincreasing in doc_size can simply evaluate score_one(sd).
+     *
+     * The default implementation returns infinity, which keeps rank()
+     * safe-to-k for rankers without a usable bound by disabling pruning
+     * on their terms.
+     *
+     * @param sd The score_data describing the term's best case
+     */
+    virtual float score_upper_bound(const score_data& sd);
+
+    /**
+     * @return whether WAND dynamic pruning is used when ranking
+     */
+    bool wand_pruning() const;
+
+    /**
+     * Enables or disables WAND dynamic pruning. When enabled, rank()
+     * uses the per-term bounds from score_upper_bound() (refined with
+     * the per-block maxima from the postings skip tables) to skip
+     * documents that cannot enter the current top k. Results are
+     * identical to exhaustive scoring down to the requested number of
+     * results.
+     *
+     * @param enable Whether to enable pruning
+     */
+    void wand_pruning(bool enable);
+
     virtual std::vector<search_result>
     rank(ranker_context& ctx, uint64_t num_results,
          const filter_function_type& filter) override final;
+
+    /**
+     * The exhaustive document-at-a-time loop used by rank() when WAND
+     * pruning is disabled. The base implementation dispatches to
+     * score_one() virtually per (term, document) pair; concrete rankers
+     * shipped with MeTA override this with a one-line dispatch into
+     * detail::daat_rank() so their score_one() is statically bound (and
+     * inlined) inside the loop. Custom rankers that do not override it
+     * simply keep the virtual path.
+     */
+    virtual std::vector<search_result>
+    rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                    const filter_function_type& filter);
+
+  private:
+    /**
+     * Document-at-a-time scoring with WAND-style pivoting and block-max
+     * refinement.
+     */
+    std::vector<search_result> wand_rank(ranker_context& ctx,
+                                         uint64_t num_results,
+                                         const filter_function_type& filter);
+
+    /// whether rank() should use dynamic pruning
+    bool wand_pruning_ = false;
 };
+
+namespace detail
+{
+/// statically binds score_one() for a concrete ranker type; the generic
+/// instantiation over ranking_function itself stays a virtual call
+template <class RankingFunction>
+inline float invoke_score_one(RankingFunction& fn, const score_data& sd,
+                              std::false_type)
+{
+    return fn.RankingFunction::score_one(sd);
+}
+
+inline float invoke_score_one(ranking_function& fn, const score_data& sd,
+                              std::true_type)
+{
+    return fn.score_one(sd);
+}
+
+template <class RankingFunction>
+inline float invoke_initial_score(const RankingFunction& fn,
+                                  const score_data& sd, std::false_type)
+{
+    return fn.RankingFunction::initial_score(sd);
+}
+
+inline float invoke_initial_score(const ranking_function& fn,
+                                  const score_data& sd, std::true_type)
+{
+    return fn.initial_score(sd);
+}
+
+/**
+ * The exhaustive document-at-a-time traversal, templated over the
+ * concrete ranking function so that score_one() and initial_score()
+ * are statically bound — and thus inlinable — inside the hot loop
+ * instead of costing a virtual call per (term, document) pair.
+ * Concrete rankers dispatch here from their rank_exhaustive()
+ * override; the instantiation over ranking_function itself is the
+ * fully virtual fallback used for custom rankers.
+ */
+template <class RankingFunction>
+std::vector<search_result>
+daat_rank(RankingFunction& fn, ranker_context& ctx, uint64_t num_results,
+          const ranker::filter_function_type& filter)
+{
+    using generic = std::is_same<RankingFunction, ranking_function>;
+
+    // a subclass that overrides score_one() without overriding
+    // rank_exhaustive() inherits its base's specialization; fall back
+    // to the fully virtual loop so the subclass override is honored
+    if (!generic::value && typeid(fn) != typeid(RankingFunction))
+        return fn.ranking_function::rank_exhaustive(ctx, num_results, filter);
+
+    query_stats::scoped_timer score_timer{query_stats::phase::score};
+    uint64_t candidates = 0;
+    uint64_t postings_scored = 0;
+
+    score_data sd{ctx.idx,
+                  ctx.global ? ctx.global->avg_doc_length()
+                             : ctx.idx.avg_doc_length(),
+                  ctx.global ? ctx.global->num_docs : ctx.idx.num_docs(),
+                  ctx.global ? ctx.global->total_corpus_terms
+                             : ctx.idx.total_corpus_terms(),
+                  ctx.query_length};
+
+    // with a scratch, the heap adopts the pooled result buffer; the
+    // extracted results hand it back to the caller
+    std::vector<search_result> heap_buffer;
+    if (ctx.scratch)
+        heap_buffer = std::move(ctx.scratch->results);
+    auto results = util::make_fixed_heap<search_result>(
+        num_results,
+        [](const search_result& a, const search_result& b) {
+            // comparison is reversed since we want a min-heap
+            return a.score > b.score;
+        },
+        std::move(heap_buffer));
+
+    doc_id next_doc{ctx.idx.num_docs()};
+    while (ctx.cur_doc < ctx.idx.num_docs())
+    {
+        if (ctx.budget
+            && budget_exhausted(ctx, postings_scored, candidates))
+            break;
+
+        sd.d_id = ctx.cur_doc;
+        sd.doc_size = ctx.idx.doc_size(ctx.cur_doc);
+        sd.doc_unique_terms = ctx.idx.unique_terms(ctx.cur_doc);
+
+        auto score = invoke_initial_score(fn, sd, generic{});
+        for (auto& pc : ctx.postings)
+        {
+            if (pc.begin == pc.end)
+                continue;
+
+            if (pc.begin->first == ctx.cur_doc)
+            {
+                // set up this term
+                sd.t_id = pc.t_id;
+                sd.query_term_weight = pc.query_term_weight;
+                sd.doc_count = pc.doc_count;
+                sd.corpus_term_count = pc.corpus_term_count;
+                sd.doc_term_count = pc.begin->second;
+
+                score += invoke_score_one(fn, sd, generic{});
+                ++postings_scored;
+
+                // advance over this position in the current postings context
+                // until the next valid document
+                advance(pc, filter, ctx.pushdown);
+            }
+
+            if (pc.begin != pc.end)
+            {
+                // check if the document in the next position is the
+                // smallest accepted doc_id
+                if (pc.begin->first < next_doc)
+                    next_doc = pc.begin->first;
+            }
+        }
+
+        results.emplace(ctx.cur_doc, score);
+        ++candidates;
+        ctx.cur_doc = next_doc;
+        next_doc = doc_id{ctx.idx.num_docs()};
+    }
+
+    score_timer.stop();
+    query_stats::record_count(query_stats::counter::candidates, candidates);
+
+    query_stats::scoped_timer heap_timer{query_stats::phase::heap};
+    return results.extract_top();
+}
+}
+
+/**
+ * Scores one query with several ranking functions in a single
+ * document-at-a-time postings traversal. The postings lists are read and
+ * decoded once; at each candidate document every ranker's score_one() is
+ * evaluated against the shared score_data and accumulated into that
+ * ranker's own heap. This amortizes the dominant postings cost when the
+ * same query is scored under several models (e.g. ranker A/B
+ * experiments), where calling ranker::score() per model would re-read
+ * identical postings.
+ *
+ * Scoring is always exhaustive: per-ranker WAND pruning settings are
+ * ignored since a document skippable under one model may matter to
+ * another.
+ *
+ * @param ctx The ranker_context holding the postings lists (consumed)
+ * @param rankers The ranking functions to score with
+ * @param num_results The number of search results to return per ranker
+ * @param filter The filter function to be used
+ * @return the results for each ranker, in ranker order
+ */
+std::vector<std::vector<search_result>>
+score_multi(ranker_context& ctx,
+            const std::vector<ranking_function*>& rankers,
+            uint64_t num_results,
+            const ranker::filter_function_type& filter);
+
+/**
+ * Scores one query document with several ranking functions in a single
+ * postings traversal.
+ * @see score_multi()
+ *
+ * @param idx The index to score the query against
+ * @param query The current query
+ * @param rankers The ranking functions to score with
+ * @param num_results The number of search results to return per ranker
+ * @param filter A filtering function to apply to each doc_id; returns
+ * true if the document should be included in results
+ * @return the results for each ranker, in ranker order
+ */
+std::vector<std::vector<search_result>>
+score_multi(inverted_index& idx, const corpus::document& query,
+            const std::vector<ranking_function*>& rankers,
+            uint64_t num_results = 10,
+            const ranker::filter_function_type& filter
+            = [](doc_id) { return true; });
 }
 }
 #endif
@@ -10,6 +10,11 @@
 #ifndef META_INDEX_ROCCHIO_H_
 #define META_INDEX_ROCCHIO_H_
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "meta/caching/concurrent_cache.h"
 #include "meta/index/ranker/ranker_factory.h"
 
 namespace meta
@@ -43,6 +48,11 @@ namespace index
  * # other parameters for that ranker
  * ~~~
  *
+ * The second retrieval pass is restricted to the documents matching the
+ * original query (see feedback::second_pass()), and the computed
+ * centroid terms are cached per query fingerprint, so repeated queries
+ * skip the forward index reads entirely.
+ *
  * @see https://en.wikipedia.org/wiki/Rocchio_algorithm
  */
 class rocchio : public ranker
@@ -66,6 +76,12 @@ class rocchio : public ranker
      */
     const static constexpr uint64_t default_max_terms = 50;
 
+    /**
+     * The number of feedback term distributions cached per ranker
+     * instance.
+     */
+    const static constexpr uint64_t default_cache_size = 256;
+
     rocchio(std::shared_ptr<forward_index> fwd);
 
     rocchio(std::shared_ptr<forward_index> fwd,
@@ -82,12 +98,19 @@ class rocchio : public ranker
          const filter_function_type& filter) override;
 
   private:
+    /// a feedback term distribution: the top terms and their weights
+    using feedback_terms = std::vector<std::pair<term_id, float>>;
+
     std::shared_ptr<forward_index> fwd_;
     std::unique_ptr<ranker> initial_ranker_;
     const float alpha_;
     const float beta_;
     const uint64_t k_;
     const uint64_t max_terms_;
+
+    /// cached feedback term distributions, keyed by query fingerprint
+    caching::concurrent_cache<uint64_t, std::shared_ptr<const feedback_terms>>
+        fb_cache_{default_cache_size};
 };
 
 /**
@@ -0,0 +1,190 @@
+/**
+ * @file segmented_index.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_SEGMENTED_INDEX_H_
+#define META_INDEX_SEGMENTED_INDEX_H_
+
+#include <memory>
+#include <vector>
+
+#include "cpptoml.h"
+#include "meta/config.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/ranker.h"
+#include "meta/parallel/thread_pool.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * An append-only collection of inverted index segments. New documents
+ * are indexed into a fresh segment with append() instead of triggering a
+ * rebuild of the whole collection; queries fan out across the segments
+ * and the per-segment results are merged by score. Document ids are
+ * global: each segment's local ids are offset by the number of documents
+ * in the segments before it.
+ *
+ * Scoring uses collection-wide statistics (document frequencies,
+ * average lengths) aggregated across the segments once per query, so a
+ * document's score does not depend on which segment holds it and the
+ * merged per-segment top-k lists are directly comparable.
+ */
+class segmented_index
+{
+  public:
+    /**
+     * Basic exception for segmented_index interactions.
+     */
+    class exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * Opens (or creates) the segment collection described by the
+     * configuration; segments live underneath the configured index
+     * directory. Any existing segments are loaded.
+     *
+     * @param config The configuration for this collection
+     */
+    segmented_index(const cpptoml::table& config);
+
+    /**
+     * Indexes a batch of new documents into a fresh segment. Existing
+     * segments are untouched, so the cost is proportional to the batch
+     * size rather than the collection size.
+     *
+     * @param docs The new documents to index
+     */
+    void append(corpus::corpus& docs);
+
+    /**
+     * @return the total number of documents across all segments
+     */
+    uint64_t num_docs() const;
+
+    /**
+     * @return the number of segments in the collection
+     */
+    uint64_t num_segments() const;
+
+    /**
+     * @param d_id The global document id to fetch metadata for
+     * @return the metadata for the document, from its owning segment
+     */
+    corpus::metadata metadata(doc_id d_id) const;
+
+    /**
+     * Scores a query against every segment and merges the per-segment
+     * results by score.
+     *
+     * @param r The ranker to score with
+     * @param query The query to score
+     * @param num_results The number of results to return
+     * @return the top documents (global ids) in descending score order
+     */
+    std::vector<search_result> score(ranker& r,
+                                     const corpus::document& query,
+                                     uint64_t num_results = 10);
+
+    /**
+     * Scores a query against every segment concurrently, one pool task
+     * per segment, so the query's latency tracks the slowest segment
+     * rather than the sum of all of them.
+     *
+     * @param r The ranker to score with
+     * @param query The query to score
+     * @param pool The thread pool to fan the segments out on
+     * @param num_results The number of results to return
+     * @return the top documents (global ids) in descending score order
+     */
+    std::vector<search_result> score(ranker& r,
+                                     const corpus::document& query,
+                                     parallel::thread_pool& pool,
+                                     uint64_t num_results = 10);
+
+    /**
+     * Rewrites the collection into a single maximally-compacted
+     * segment: the per-segment postings are merged term by term into
+     * one freshly delta-compressed postings file (in the regular block
+     * format) with a newly packed vocabulary, and the per-document
+     * metadata and labels are concatenated into one set of files in
+     * global id order. Queries served afterwards touch exactly one
+     * segment, so the fan-out and statistics-aggregation overhead of a
+     * fragmented collection disappears until the next append().
+     * Intended for off-peak maintenance windows; the collection is
+     * unusable while the swap at the end of the rewrite is in flight.
+     */
+    void optimize();
+
+    /**
+     * Aggregates collection-wide scoring statistics for a query's terms
+     * by summing each segment's document frequencies and term counts.
+     *
+     * @param query The query whose terms need statistics
+     * @return the aggregated statistics, for passing to ranker::score()
+     */
+    corpus_stats stats_for(const corpus::document& query);
+
+  private:
+    /**
+     * Loads the segments recorded in the segment manifest, if any.
+     */
+    void load_segments();
+
+    /**
+     * @param segment The segment number
+     * @return the configuration for the given segment's index
+     */
+    std::shared_ptr<cpptoml::table> segment_config(uint64_t segment) const;
+
+    /**
+     * Merges every segment's postings, term by term, into one compacted
+     * postings file and freshly packed vocabulary for optimize().
+     * @param out_dir The directory of the segment being built
+     */
+    void merge_postings(const std::string& out_dir) const;
+
+    /**
+     * Concatenates every segment's per-document metadata and labels
+     * into the given directory in global id order for optimize(). The
+     * segments are expected to share one metadata schema, which holds
+     * whenever they were created through append() with one
+     * configuration.
+     * @param out_dir The directory of the segment being built
+     */
+    void merge_metadata(const std::string& out_dir) const;
+
+    /**
+     * Offsets each segment's local document ids into the global id
+     * space, merges the partial result lists by score, and truncates.
+     *
+     * @param partials The per-segment result lists, indexed by segment
+     * @param num_results The number of results to keep
+     * @return the merged top documents in descending score order
+     */
+    std::vector<search_result>
+    merge_results(std::vector<std::vector<search_result>>& partials,
+                  uint64_t num_results) const;
+
+    /// the configuration for the collection
+    std::shared_ptr<cpptoml::table> config_;
+    /// the root directory for the collection
+    std::string prefix_;
+    /// the open segments, in creation order
+    std::vector<std::shared_ptr<inverted_index>> segments_;
+    /// the global doc id offset of each segment
+    std::vector<uint64_t> offsets_;
+};
+}
+}
+#endif
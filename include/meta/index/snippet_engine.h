@@ -0,0 +1,145 @@
+/**
+ * @file snippet_engine.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_INDEX_SNIPPET_ENGINE_H_
+#define META_INDEX_SNIPPET_ENGINE_H_
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "meta/io/mmap_file.h"
+#include "meta/meta.h"
+#include "meta/util/disk_vector.h"
+#include "meta/util/string_view.h"
+
+namespace meta
+{
+namespace index
+{
+
+class disk_index;
+
+/**
+ * Generates highlighted result snippets from documents' stored full text
+ * using an index-time sidecar of per-document sentence byte offsets.
+ * The sidecar (snippets.bin plus its index, in the index directory) is
+ * built in one pass over the "content" metadata — the offsets are
+ * delta-packed per document and located through a disk_vector of
+ * per-document byte positions — so picking and highlighting the
+ * best-matching sentence window at query time is a pair of mmap reads
+ * and one scan over the window text, with no re-tokenization of the
+ * document.
+ *
+ * Requires the index to have been built with store-full-text enabled.
+ */
+class snippet_engine
+{
+  public:
+    /**
+     * A highlighted window of a document.
+     */
+    struct snippet
+    {
+        /// The window text, with query term matches highlighted
+        std::string text;
+        /// The byte position of the window in the document content
+        uint64_t begin;
+        /// One past the last byte of the window
+        uint64_t end;
+        /// The window's match score (0 if no query term occurs)
+        double score;
+    };
+
+    /**
+     * Opens the sentence offset sidecar for an index, building and
+     * saving it first if it does not exist yet.
+     * @param idx The index to generate snippets for
+     */
+    snippet_engine(disk_index& idx);
+
+    /**
+     * @param d_id The document to generate a snippet for
+     * @param terms The query terms to match (matched as whole words,
+     * case-insensitively)
+     * @param window_size The number of consecutive sentences per window
+     * @param pre The marker inserted before each matched term
+     * @param post The marker inserted after each matched term
+     * @return the best-matching window of the document; if no window
+     * matches, the document's first window with a score of 0
+     */
+    snippet best_snippet(doc_id d_id, const std::vector<std::string>& terms,
+                         uint64_t window_size = 2,
+                         const std::string& pre = "**",
+                         const std::string& post = "**") const;
+
+    /**
+     * Splits text into sentences with a lightweight boundary scan
+     * (sentence-final punctuation followed by whitespace, or a blank
+     * line).
+     *
+     * @param content The text to split
+     * @return the byte offset of each sentence start, followed by the
+     * size of the text (so consecutive entries delimit one sentence)
+     */
+    static std::vector<uint64_t> sentence_offsets(util::string_view content);
+
+    /**
+     * Picks and highlights the best window of consecutive sentences.
+     * Each sentence scores the number of query term occurrences plus a
+     * bonus per distinct matched term; ties go to the earliest window.
+     *
+     * @param content The full document text
+     * @param offsets Its sentence offsets, as from sentence_offsets()
+     * @param terms The query terms to match
+     * @param window_size The number of consecutive sentences per window
+     * @param pre The marker inserted before each matched term
+     * @param post The marker inserted after each matched term
+     * @return the best-matching window
+     */
+    static snippet best_window(util::string_view content,
+                               const std::vector<uint64_t>& offsets,
+                               const std::vector<std::string>& terms,
+                               uint64_t window_size, const std::string& pre,
+                               const std::string& post);
+
+  private:
+    /**
+     * Builds the sidecar files if they are not present.
+     * @param idx The index to build from
+     * @return the path to the sidecar's packed offsets file
+     */
+    static std::string ensure_built(disk_index& idx);
+
+    /**
+     * @param d_id The document to read offsets for
+     * @return the document's sentence offset table from the sidecar
+     */
+    std::vector<uint64_t> offsets_for(doc_id d_id) const;
+
+    /// The index snippets are generated for
+    disk_index& idx_;
+
+    /// The delta-packed per-document sentence offset tables
+    io::mmap_file offsets_;
+
+    /// The byte position of each document's table in the offsets file
+    util::disk_vector<uint64_t> index_;
+};
+
+/**
+ * Basic exception for snippet_engine interactions.
+ */
+class snippet_engine_exception : public std::runtime_error
+{
+  public:
+    using std::runtime_error::runtime_error;
+};
+}
+}
+#endif
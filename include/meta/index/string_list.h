@@ -15,6 +15,8 @@
 #include "meta/config.h"
 #include "meta/io/mmap_file.h"
 #include "meta/util/disk_vector.h"
+#include "meta/util/optional.h"
+#include "meta/util/string_view.h"
 
 namespace meta
 {
@@ -26,10 +28,21 @@ namespace index
  * persisted to disk. This class provides read-only
  * access---string_list_writer provides write-only access and is to be used
  * for building the string list and associated index this class reads.
+ *
+ * Strings are stored in front-coded blocks of 16: the first string of
+ * each block is stored whole, and each subsequent string stores only the
+ * length of the prefix it shares with its predecessor plus its remaining
+ * suffix. Vocabularies with long shared prefixes (URLs, n-grams) shrink
+ * several-fold, and a lookup touches one block instead of paging through
+ * the whole flat file. The index file holds one offset per block rather
+ * than one per string.
  */
 class string_list
 {
   public:
+    /// The number of strings per front-coded block
+    const static uint64_t block_size = 16;
+
     /**
      * Constructs the string list
      * @param path The path to where this object is stored
@@ -48,9 +61,19 @@ class string_list
 
     /**
      * @param idx
-     * @return the string at a given index.
+     * @return the string at a given index, decoded from its block
+     */
+    std::string at(uint64_t idx) const;
+
+    /**
+     * Locates a string by binary search over the block heads. This
+     * requires the list to have been written in sorted order; on
+     * unsorted lists the result is meaningless.
+     *
+     * @param elem The string to locate
+     * @return the index of the string, if present
      */
-    const char* at(uint64_t idx) const;
+    util::optional<uint64_t> find(util::string_view elem) const;
 
     /**
      * @return the number of strings in the list.
@@ -58,10 +81,16 @@ class string_list
     uint64_t size() const;
 
   private:
-    /// The file containing the strings.
+    /**
+     * @param block The block number
+     * @return a view of the (uncompressed) first string of the block
+     */
+    util::string_view block_head(uint64_t block) const;
+
+    /// The file containing the front-coded blocks.
     io::mmap_file string_file_;
 
-    /// An index that gives the starting byte for each index.
+    /// The total string count followed by the starting byte of each block.
     util::disk_vector<uint64_t> index_;
 };
 }
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "meta/config.h"
 #include "meta/io/moveable_stream.h"
@@ -27,6 +28,11 @@ namespace index
  * A class for writing large lists of strings to disk with an associated
  * index file for fast random access. This class is used for writing the
  * output format read by the string_list class.
+ *
+ * The strings are stored in front-coded blocks of string_list::block_size
+ * entries, so they are buffered in memory until the writer is destroyed
+ * (front-coding an entry requires its predecessor, but insert() may be
+ * called in any order).
  */
 class string_list_writer
 {
@@ -50,6 +56,12 @@ class string_list_writer
      */
     string_list_writer& operator=(string_list_writer&&);
 
+    /**
+     * Destroys the writer, front-coding the buffered strings out to
+     * disk.
+     */
+    ~string_list_writer();
+
     /**
      * Sets the string at idx to be elem.
      * @param idx
@@ -58,17 +70,26 @@ class string_list_writer
     void insert(uint64_t idx, const std::string& elem);
 
   private:
+    /**
+     * Encodes the buffered strings into front-coded blocks and fills in
+     * the block index.
+     */
+    void flush();
+
     /// Writes are internally synchronized
     std::mutex mutex_;
 
-    /// The file containing the strings
+    /// The file containing the front-coded blocks
     io::mofstream string_file_;
 
-    /// Keeps track of the write position
-    uint64_t write_pos_;
+    /// The strings, buffered until flush
+    std::vector<std::string> strings_;
 
-    /// Index vector---stores byte positions
+    /// The total string count followed by the starting byte of each block
     util::disk_vector<uint64_t> index_;
+
+    /// Whether the buffered strings have been written out already
+    bool flushed_;
 };
 }
 }
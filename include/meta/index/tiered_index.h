@@ -0,0 +1,121 @@
+/**
+ * @file tiered_index.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_TIERED_INDEX_H_
+#define META_INDEX_TIERED_INDEX_H_
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "cpptoml.h"
+#include "meta/config.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/ranker.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * A federation of inverted indexes ordered by decreasing document
+ * quality (e.g. PageRank or recency), queried with early exit: the small
+ * high-value tier is scored first, and lower tiers are consulted only
+ * when it produces fewer than the requested number of good results.
+ * When most queries can be answered from the top tier, the big tail
+ * tiers are never touched at all.
+ *
+ * Tiers are declared in the configuration as an array of tables, highest
+ * quality first; each tier is a regular inverted_index built from its
+ * slice of the collection:
+ *
+ * ~~~toml
+ * [[tiers]]
+ * index = "high-tier"
+ * [[tiers]]
+ * index = "tail-tier"
+ * ~~~
+ *
+ * Document ids are global: each tier's local ids are offset by the
+ * number of documents in the tiers before it. As with segmented_index,
+ * scoring statistics are per-tier.
+ */
+class tiered_index
+{
+  public:
+    /**
+     * Basic exception for tiered_index interactions.
+     */
+    class exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * Opens the tiers declared in the configuration, highest quality
+     * first.
+     *
+     * @param config The configuration for this collection
+     */
+    tiered_index(const cpptoml::table& config);
+
+    /**
+     * @return the total number of documents across all tiers
+     */
+    uint64_t num_docs() const;
+
+    /**
+     * @return the number of tiers
+     */
+    uint64_t num_tiers() const;
+
+    /**
+     * @param d_id The global document id to fetch metadata for
+     * @return the metadata for the document, from its owning tier
+     */
+    corpus::metadata metadata(doc_id d_id) const;
+
+    /**
+     * Scores a query with early exit: tiers are consulted in quality
+     * order, stopping as soon as num_results documents scoring at least
+     * cutoff have been found. A cutoff of the default lowest float
+     * accepts any match, so the fall-through condition is simply "fewer
+     * than k results".
+     *
+     * @param r The ranker to score with
+     * @param query The query to score
+     * @param num_results The number of results to return
+     * @param cutoff The minimum score for a result to count as "good"
+     * when deciding whether to descend to the next tier
+     * @return the top documents (global ids) in descending score order
+     */
+    std::vector<search_result>
+    score(ranker& r, const corpus::document& query, uint64_t num_results = 10,
+          float cutoff = std::numeric_limits<float>::lowest());
+
+  private:
+    /**
+     * @param tier The tier's configuration table
+     * @return the full configuration for the given tier's index
+     */
+    std::shared_ptr<cpptoml::table>
+    tier_config(const cpptoml::table& tier) const;
+
+    /// the configuration for the collection
+    std::shared_ptr<cpptoml::table> config_;
+    /// the open tiers, highest quality first
+    std::vector<std::shared_ptr<inverted_index>> tiers_;
+    /// the global doc id offset of each tier
+    std::vector<uint64_t> offsets_;
+};
+}
+}
+#endif
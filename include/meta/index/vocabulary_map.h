@@ -10,10 +10,13 @@
 #ifndef META_VOCABULARY_MAP_H_
 #define META_VOCABULARY_MAP_H_
 
+#include <vector>
+
 #include "meta/config.h"
 #include "meta/io/mmap_file.h"
 #include "meta/util/disk_vector.h"
 #include "meta/util/optional.h"
+#include "meta/util/string_view.h"
 
 namespace meta
 {
@@ -59,10 +62,13 @@ class vocabulary_map
 
     /**
      * Convenience wrapper for comparing the term with strings in the tree.
+     * The comparison is done directly against the mapped file contents, so
+     * no copies are made.
+     *
      * @param term  the term we are looking for
      * @param other the string in the tree we are considering
      */
-    int compare(const std::string& term, const char* other) const;
+    int compare(util::string_view term, const char* other) const;
 
   public:
     /**
@@ -88,10 +94,27 @@ class vocabulary_map
     vocabulary_map& operator=(vocabulary_map&&) = default;
 
     /**
-     * Finds the given term in the tree, if it exists.
+     * Finds the given term in the tree, if it exists. The search operates
+     * directly on the memory mapped tree file: no syscalls are made and no
+     * strings are copied.
+     *
      * @param term the term to find an id for
      */
-    util::optional<term_id> find(const std::string& term) const;
+    util::optional<term_id> find(util::string_view term) const;
+
+    /**
+     * Resolves a batch of terms in one call. The probes are issued in
+     * sorted term order (the results are still returned in input
+     * order), so consecutive lookups revisit the same upper tree
+     * blocks and sweep the leaf level mostly front to back instead of
+     * bouncing around the file; duplicate terms are resolved once.
+     *
+     * @param terms the terms to find ids for
+     * @return the id for each term, in input order; absent for
+     * out-of-vocabulary terms
+     */
+    std::vector<util::optional<term_id>>
+    find_batch(const std::vector<std::string>& terms) const;
 
     /**
      * Finds the term associated with the given id. No bounds checking is
@@ -102,6 +125,16 @@ class vocabulary_map
      */
     std::string find_term(term_id t_id) const;
 
+    /**
+     * Finds the term associated with the given id without copying it; the
+     * returned view points into the memory mapped tree file and is valid
+     * for the lifetime of this vocabulary_map. No bounds checking is
+     * performed.
+     *
+     * @param t_id the term id to find the string representation of
+     */
+    util::string_view find_term_view(term_id t_id) const;
+
     /**
      * The number of terms in the map.
      */
@@ -14,6 +14,7 @@
 #include <fstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "meta/config.h"
 
@@ -72,9 +73,12 @@ class vocabulary_map_writer
 
     /**
      * The destructor for a vocabulary_map_writer flushes the last leaf
-     * node and builds the internal structure---as such, it may block for
-     * a period of time while finalizing the tree structure. This may be
-     * changed in the future.
+     * node and builds the internal structure. Since terms arrive fully
+     * sorted, the tree is bulk-loaded bottom-up: the head term and
+     * position of every node are remembered as the nodes stream out, so
+     * each internal level is packed in one in-memory pass (with the
+     * node serialization parallelized across a thread pool) instead of
+     * re-reading the level below from disk.
      */
     ~vocabulary_map_writer();
 
@@ -124,8 +128,18 @@ class vocabulary_map_writer
     /// The remaining space in the block currently being written
     uint16_t remaining_block_space_;
 
-    /// Number of written nodes to be "merged" when writing the next level
-    uint64_t written_nodes_;
+    /// The head term and file position of one written node
+    struct node_head
+    {
+        /// The first term stored in the node
+        std::string term;
+
+        /// The absolute file position of the node
+        uint64_t pos;
+    };
+
+    /// The head of every node in the level currently being written
+    std::vector<node_head> level_heads_;
 };
 
 /**
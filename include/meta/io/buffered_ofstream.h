@@ -0,0 +1,123 @@
+/**
+ * @file buffered_ofstream.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_IO_BUFFERED_OFSTREAM_H_
+#define META_IO_BUFFERED_OFSTREAM_H_
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace io
+{
+
+/**
+ * A thin output wrapper around std::ofstream that stages bytes in a
+ * large in-memory buffer before handing them to the stream in bulk.
+ * io::packed::write emits values one byte at a time; through an ostream,
+ * every one of those bytes pays for a sentry and a virtual streambuf
+ * call, which dominates postings serialization. Here put() is an inline
+ * store into the buffer, so packed encoding proceeds at memcpy speed and
+ * the underlying stream only sees buffer-sized writes.
+ *
+ * The buffer is flushed when full, on explicit flush(), and on
+ * destruction. Bulk writes at least as large as the buffer bypass it
+ * (after flushing any staged bytes, to preserve ordering) and go to the
+ * stream directly.
+ */
+class buffered_ofstream
+{
+  public:
+    /**
+     * Opens a file for buffered binary writing.
+     * @param filename The path to the file to write
+     * @param buffer_size The size of the staging buffer
+     */
+    buffered_ofstream(const std::string& filename,
+                      std::size_t buffer_size = 64 * 1024)
+        : output_{filename, std::ios::binary}, buffer_(buffer_size), pos_{0}
+    {
+        // nothing
+    }
+
+    /**
+     * Flushes any remaining staged bytes before closing the file.
+     */
+    ~buffered_ofstream()
+    {
+        flush();
+    }
+
+    buffered_ofstream(const buffered_ofstream&) = delete;
+    buffered_ofstream& operator=(const buffered_ofstream&) = delete;
+
+    /**
+     * Writes a single byte.
+     * @param byte The byte to write
+     */
+    void put(char byte)
+    {
+        if (pos_ == buffer_.size())
+            flush();
+        buffer_[pos_++] = byte;
+    }
+
+    /**
+     * Writes a block of bytes.
+     * @param data The start of the block
+     * @param count The number of bytes to write
+     */
+    void write(const char* data, std::streamsize count)
+    {
+        auto bytes = static_cast<std::size_t>(count);
+        if (bytes >= buffer_.size())
+        {
+            flush();
+            output_.write(data, count);
+            return;
+        }
+
+        if (pos_ + bytes > buffer_.size())
+            flush();
+        std::memcpy(&buffer_[pos_], data, bytes);
+        pos_ += bytes;
+    }
+
+    /**
+     * Hands all staged bytes to the underlying stream.
+     */
+    void flush()
+    {
+        if (pos_ > 0)
+        {
+            output_.write(buffer_.data(), static_cast<std::streamsize>(pos_));
+            pos_ = 0;
+        }
+    }
+
+    /**
+     * @return whether the underlying stream is in a good state
+     */
+    explicit operator bool() const
+    {
+        return static_cast<bool>(output_);
+    }
+
+  private:
+    std::ofstream output_;
+    std::vector<char> buffer_;
+    std::size_t pos_;
+};
+}
+}
+#endif
@@ -82,13 +82,29 @@ bool exists(const std::string& path);
 uint64_t file_size(const std::string& filename);
 
 /**
- * Copies a file source to file dest.
+ * Copies a file source to file dest. On Linux, the copy is performed
+ * with a reflink (FICLONE) when the filesystem supports sharing extents
+ * (XFS, btrfs), falling back to an in-kernel copy_file_range and
+ * finally to a buffered userspace copy.
  * @param source The source file
  * @param dest The destination file
  * @return whether the copy was successful
  */
 bool copy_file(const std::string& source, const std::string& dest);
 
+/**
+ * Recursively copies the directory tree rooted at source into dest
+ * (which must not yet exist), creating the directory skeleton first and
+ * then copying the files in parallel with copy_file(). When source
+ * names a regular file, this is equivalent to copy_file(). Throws
+ * filesystem_exception if any file fails to copy.
+ *
+ * @param source The root of the tree to copy
+ * @param dest The destination root
+ * @return the number of files and directories that were created
+ */
+std::uintmax_t copy_tree(const std::string& source, const std::string& dest);
+
 /**
  * @param in_name The filename to read
  * @return string content from the given file
@@ -0,0 +1,216 @@
+/**
+ * @file flat_file.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_IO_FLAT_FILE_H_
+#define META_IO_FLAT_FILE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/io/mmap_file.h"
+#include "meta/util/array_view.h"
+#include "meta/util/string_view.h"
+
+namespace meta
+{
+namespace io
+{
+
+/**
+ * Basic exception for flat_file interactions.
+ */
+class flat_file_exception : public std::runtime_error
+{
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * Writes a flat, sectioned binary file for models and other large state
+ * that should load via mmap instead of element-wise deserialization.
+ *
+ * The layout is a small magic/version header, then each section's raw
+ * bytes padded to an 8-byte boundary, then a table recording every
+ * section's name, byte range, and CRC-32 checksum. Since payloads are
+ * aligned and contiguous, a reader (flat_file) can hand out zero-copy
+ * views over arrays of trivially-copyable types without parsing
+ * anything but the table.
+ */
+class flat_file_writer
+{
+  public:
+    /**
+     * Opens a flat file for writing.
+     * @param path The path to the file to create
+     */
+    flat_file_writer(const std::string& path);
+
+    /**
+     * Finalizes the file if close() was not called explicitly.
+     */
+    ~flat_file_writer();
+
+    flat_file_writer(const flat_file_writer&) = delete;
+    flat_file_writer& operator=(const flat_file_writer&) = delete;
+
+    /**
+     * Writes a section of raw bytes. Section names must be unique
+     * within a file.
+     *
+     * @param name The name used to locate this section at load time
+     * @param data The start of the section's bytes
+     * @param size The number of bytes in the section
+     */
+    void write_section(util::string_view name, const char* data,
+                       uint64_t size);
+
+    /**
+     * Writes a section holding an array of a trivially-copyable type.
+     *
+     * @param name The name used to locate this section at load time
+     * @param data The array to write
+     */
+    template <class T>
+    void write_section(util::string_view name, util::array_view<const T> data)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "flat_file sections must hold trivially-copyable "
+                      "types");
+        write_section(name, reinterpret_cast<const char*>(data.begin()),
+                      sizeof(T) * data.size());
+    }
+
+    /**
+     * Writes the section table and patches the header. Called from the
+     * destructor if not invoked explicitly; explicit use allows error
+     * checking.
+     */
+    void close();
+
+  private:
+    /// one section table entry
+    struct section_info
+    {
+        std::string name;
+        uint64_t offset;
+        uint64_t size;
+        uint32_t checksum;
+    };
+
+    std::ofstream output_;
+    std::vector<section_info> sections_;
+    uint64_t pos_;
+    bool closed_;
+};
+
+/**
+ * A read-only, mmap-backed view over a file written by flat_file_writer.
+ * Opening only parses the section table; section payloads are faulted in
+ * lazily by the OS as they are touched, so opening a multi-gigabyte
+ * model is effectively instant. Checksums are likewise verified on
+ * demand via verify().
+ */
+class flat_file
+{
+  public:
+    /**
+     * Opens a flat file, validating its magic, version, and section
+     * table.
+     * @param path The path to the file to open
+     */
+    flat_file(const std::string& path);
+
+    /**
+     * Move constructor.
+     */
+    flat_file(flat_file&&) = default;
+
+    /**
+     * Move assignment operator.
+     */
+    flat_file& operator=(flat_file&&) = default;
+
+    /**
+     * @param name The name of the section to look up
+     * @return whether a section with this name exists
+     */
+    bool has_section(util::string_view name) const;
+
+    /**
+     * @param name The name of the section to look up
+     * @return a zero-copy view over the section's bytes; an exception
+     * is thrown if the section does not exist
+     */
+    util::string_view section(util::string_view name) const;
+
+    /**
+     * @param name The name of the section to look up
+     * @return a zero-copy view over the section interpreted as an array
+     * of T; an exception is thrown if the section does not exist or its
+     * size is not a multiple of sizeof(T)
+     */
+    template <class T>
+    util::array_view<const T> section_as(util::string_view name) const
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "flat_file sections must hold trivially-copyable "
+                      "types");
+        auto bytes = section(name);
+        if (bytes.size() % sizeof(T) != 0)
+            throw flat_file_exception{"section size is not a multiple of the "
+                                      "requested element size"};
+        return {reinterpret_cast<const T*>(bytes.data()),
+                bytes.size() / sizeof(T)};
+    }
+
+    /**
+     * Recomputes the checksum of one section and compares it against
+     * the stored one. This faults in the whole section.
+     *
+     * @param name The name of the section to verify
+     * @return whether the stored and recomputed checksums match
+     */
+    bool verify(util::string_view name) const;
+
+    /**
+     * @return whether every section's checksum matches
+     */
+    bool verify() const;
+
+    /**
+     * @return the number of sections in this file
+     */
+    std::size_t num_sections() const;
+
+    /**
+     * @return the names of the sections, in file order
+     */
+    const std::vector<std::string>& section_names() const;
+
+  private:
+    /// one parsed section table entry
+    struct section_info
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t checksum;
+    };
+
+    mmap_file file_;
+    std::vector<std::string> names_;
+    std::vector<section_info> sections_;
+    std::unordered_map<std::string, std::size_t> index_;
+};
+}
+}
+#endif
@@ -72,6 +72,39 @@ class mmap_file
      */
     char* begin() const;
 
+    /**
+     * Hints to the OS that the mapping will be read sequentially, so it
+     * can prefetch aggressively and drop pages behind the scan. A no-op
+     * on platforms without madvise support.
+     */
+    void advise_sequential() const;
+
+    /**
+     * Hints to the OS that the mapping will be accessed at random
+     * offsets, so speculative readahead around each fault is wasted
+     * work. A no-op on platforms without madvise support.
+     */
+    void advise_random() const;
+
+    /**
+     * Hints to the OS that the mapping should be backed by transparent
+     * huge pages where possible, reducing TLB pressure for large,
+     * hot mappings. A no-op on platforms without MADV_HUGEPAGE.
+     */
+    void advise_hugepage() const;
+
+    /**
+     * Hints to the OS to begin reading the given byte range into the
+     * page cache in the background. The call returns immediately, so
+     * issuing hints for several ranges up front lets the disk reads
+     * overlap instead of faulting in one at a time. A no-op on
+     * platforms without madvise support.
+     *
+     * @param offset The offset of the first byte to read ahead
+     * @param length The number of bytes to read ahead
+     */
+    void prefetch(uint64_t offset, uint64_t length) const;
+
   private:
     /// Filename of the text file
     std::string path_;
@@ -117,6 +150,15 @@ class mmap_ifstream
     int get();
     void close();
 
+    /**
+     * Hints to the OS to read ahead the given byte range of the stream
+     * in the background. A no-op if the stream is closed.
+     *
+     * @param offset The offset of the first byte to read ahead
+     * @param length The number of bytes to read ahead
+     */
+    void prefetch(std::size_t offset, std::size_t length) const;
+
   private:
     util::optional<mmap_file> file_;
     std::size_t pos_;
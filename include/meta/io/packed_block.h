@@ -0,0 +1,204 @@
+/**
+ * @file packed_block.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_IO_PACKED_BLOCK_H_
+#define META_IO_PACKED_BLOCK_H_
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "meta/config.h"
+#include "meta/util/likely.h"
+
+namespace meta
+{
+namespace io
+{
+namespace packed
+{
+
+/// The number of postings entries decoded per block refill.
+const constexpr uint64_t block_size = 128;
+
+namespace detail
+{
+/**
+ * Decodes a single packed unsigned integer directly from a raw byte
+ * buffer. Values that fit in one byte (the overwhelmingly common case for
+ * gap-encoded ids and term counts) take a single well-predicted branch.
+ *
+ * @param input The raw buffer to decode from
+ * @param value The element to write into
+ * @return the buffer position following the decoded value
+ */
+inline const char* decode_one(const char* input, uint64_t& value)
+{
+    auto byte = static_cast<uint8_t>(*input++);
+    value = byte & 127;
+    if (META_LIKELY(byte < 128))
+        return input;
+
+    uint8_t shift = 7;
+    do
+    {
+        byte = static_cast<uint8_t>(*input++);
+        value |= static_cast<uint64_t>(byte & 127) << shift;
+        shift += 7;
+    } while (byte & 128);
+    return input;
+}
+}
+
+/**
+ * Bulk-decodes a run of packed unsigned integers from a raw byte buffer.
+ * This is the bulk equivalent of io::packed::read() for buffers that are
+ * already resident in memory (e.g. a mapped postings file): the decode
+ * loop is unrolled and operates on raw pointers so the compiler can keep
+ * the cursor and accumulators in registers across the whole block.
+ *
+ * @param input The raw buffer to decode from
+ * @param output The array to decode into
+ * @param n The number of values to decode
+ * @return the buffer position following the decoded values
+ */
+template <class T>
+typename std::enable_if<std::is_unsigned<T>::value, const char*>::type
+decode_block(const char* input, T* output, uint64_t n)
+{
+    uint64_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        uint64_t v0;
+        uint64_t v1;
+        uint64_t v2;
+        uint64_t v3;
+        input = detail::decode_one(input, v0);
+        input = detail::decode_one(input, v1);
+        input = detail::decode_one(input, v2);
+        input = detail::decode_one(input, v3);
+        output[i] = static_cast<T>(v0);
+        output[i + 1] = static_cast<T>(v1);
+        output[i + 2] = static_cast<T>(v2);
+        output[i + 3] = static_cast<T>(v3);
+    }
+    for (; i < n; ++i)
+    {
+        uint64_t v;
+        input = detail::decode_one(input, v);
+        output[i] = static_cast<T>(v);
+    }
+    return input;
+}
+
+namespace detail
+{
+/**
+ * Decodes a single zig-zag encoded signed integer from a raw byte buffer.
+ *
+ * @param input The raw buffer to decode from
+ * @param value The element to write into
+ * @return the buffer position following the decoded value
+ */
+inline const char* decode_one_signed(const char* input, int64_t& value)
+{
+    uint64_t elem;
+    input = decode_one(input, elem);
+    value = static_cast<int64_t>(elem >> 1) ^ -static_cast<int64_t>(elem & 1);
+    return input;
+}
+}
+
+/**
+ * Bulk-decodes a run of packed floating point values (stored as
+ * mantissa/exponent pairs) from a raw byte buffer.
+ *
+ * @param input The raw buffer to decode from
+ * @param output The array to decode into
+ * @param n The number of values to decode
+ * @return the buffer position following the decoded values
+ */
+template <class T>
+typename std::enable_if<std::is_floating_point<T>::value, const char*>::type
+decode_block(const char* input, T* output, uint64_t n)
+{
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        int64_t mantissa;
+        int64_t exponent;
+        input = detail::decode_one_signed(input, mantissa);
+        input = detail::decode_one_signed(input, exponent);
+        output[i] = static_cast<T>(
+            std::ldexp(static_cast<double>(mantissa),
+                       static_cast<int>(exponent)));
+    }
+    return input;
+}
+
+/**
+ * Decodes a single packed unsigned integer from a raw byte buffer. This
+ * is the single-value counterpart of decode_block() for use in loops that
+ * interleave values of different types.
+ *
+ * @param input The raw buffer to decode from
+ * @param value The element to write into
+ * @return the buffer position following the decoded value
+ */
+template <class T>
+typename std::enable_if<std::is_unsigned<T>::value, const char*>::type
+decode_value(const char* input, T& value)
+{
+    uint64_t elem;
+    input = detail::decode_one(input, elem);
+    value = static_cast<T>(elem);
+    return input;
+}
+
+/**
+ * Decodes a single packed floating point value from a raw byte buffer.
+ *
+ * @param input The raw buffer to decode from
+ * @param value The element to write into
+ * @return the buffer position following the decoded value
+ */
+template <class T>
+typename std::enable_if<std::is_floating_point<T>::value, const char*>::type
+decode_value(const char* input, T& value)
+{
+    int64_t mantissa;
+    int64_t exponent;
+    input = detail::decode_one_signed(input, mantissa);
+    input = detail::decode_one_signed(input, exponent);
+    value = static_cast<T>(
+        std::ldexp(static_cast<double>(mantissa), static_cast<int>(exponent)));
+    return input;
+}
+
+/**
+ * Turns a block of gap-encoded ids into absolute ids via an unrolled
+ * prefix sum.
+ *
+ * @param gaps The gaps to accumulate over (modified in place)
+ * @param n The number of gaps in the block
+ * @param base The id the first gap is relative to
+ * @return the last absolute id in the block
+ */
+inline uint64_t accumulate_gaps(uint64_t* gaps, uint64_t n, uint64_t base)
+{
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        base += gaps[i];
+        gaps[i] = base;
+    }
+    return base;
+}
+}
+}
+}
+#endif
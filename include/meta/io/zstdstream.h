@@ -0,0 +1,142 @@
+/**
+ * @file zstdstream.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_ZSTDSTREAM_H_
+#define META_UTIL_ZSTDSTREAM_H_
+
+#include <zstd.h>
+
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace io
+{
+
+class zstd_exception : public std::runtime_error
+{
+  public:
+    zstd_exception(const std::string& msg, std::size_t code)
+        : std::runtime_error{msg}, code_{code}
+    {
+        // nothing
+    }
+
+    std::size_t code() const
+    {
+        return code_;
+    }
+
+  private:
+    std::size_t code_;
+};
+
+/**
+ * A streambuf for Zstandard-compressed files, with the same interface as
+ * xzstreambuf. When writing, the output is cut into independent frames
+ * every frame_size bytes of uncompressed input; a multi-frame archive
+ * decompresses identically through the streaming interface, but its
+ * frames can also be located cheaply from the frame headers and
+ * decompressed in parallel (see parallel_decompress() below).
+ */
+class zstdstreambuf : public std::streambuf
+{
+  public:
+    zstdstreambuf(const char* filename, const char* openmode,
+                  std::size_t buffer_size = 128 * 1024,
+                  uint64_t frame_size = 4 * 1024 * 1024);
+
+    ~zstdstreambuf();
+
+    int_type underflow() override;
+
+    int_type overflow(int_type ch) override;
+
+    int sync() override;
+
+    bool is_open() const;
+
+    uint64_t bytes_read() const;
+
+  private:
+    bool write_out(const ZSTD_outBuffer& out);
+
+    bool end_frame();
+
+    bool reading_;
+    std::vector<char> in_buffer_;
+    std::vector<char> out_buffer_;
+    FILE* file_;
+    uint64_t bytes_read_;
+    /// uncompressed bytes fed into the current frame so far
+    uint64_t frame_bytes_;
+    /// number of finished frames written so far
+    uint64_t frames_written_;
+    /// uncompressed bytes after which the current frame is closed
+    uint64_t frame_size_;
+    ZSTD_CStream* cstream_;
+    ZSTD_DStream* dstream_;
+    ZSTD_inBuffer in_;
+};
+
+class zstdifstream : public std::istream
+{
+  public:
+    explicit zstdifstream(std::string name);
+
+    zstdstreambuf* rdbuf() const;
+
+    void flush();
+
+    uint64_t bytes_read() const;
+
+  private:
+    zstdstreambuf buffer_;
+};
+
+class zstdofstream : public std::ostream
+{
+  public:
+    explicit zstdofstream(std::string name);
+
+    zstdstreambuf* rdbuf() const;
+
+    void flush();
+
+  private:
+    zstdstreambuf buffer_;
+};
+
+/**
+ * Decompresses a (possibly multi-frame) Zstandard archive into the given
+ * output file, decompressing the frames in parallel. The frame
+ * boundaries are located by walking the frame headers (a metadata-only
+ * scan), so archives written through zstdofstream decompress with one
+ * task per frame; single-frame archives degrade to a sequential
+ * decompression.
+ *
+ * @param input_path The path to the compressed archive
+ * @param output_path The path for the decompressed output
+ * @param num_threads The maximum number of concurrent decompression tasks
+ * @return the total number of uncompressed bytes written
+ */
+uint64_t parallel_decompress(
+    const std::string& input_path, const std::string& output_path,
+    std::size_t num_threads = std::thread::hardware_concurrency());
+}
+}
+#endif
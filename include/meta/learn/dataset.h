@@ -18,6 +18,7 @@
 #include "meta/index/inverted_index.h"
 #include "meta/index/postings_data.h"
 #include "meta/learn/instance.h"
+#include "meta/util/memory_accounting.h"
 #include "meta/util/progress.h"
 #include "meta/util/range.h"
 
@@ -27,7 +28,9 @@ namespace learn
 {
 /**
  * Represents an in-memory view of a set of documents for running learning
- * algorithms over.
+ * algorithms over. Instance access and sizing are virtual so that
+ * derived classes (like disk_dataset) can supply instances from other
+ * storage while remaining usable through dataset_view.
  */
 class dataset
 {
@@ -62,6 +65,7 @@ class dataset
             auto stream = idx->stream_for(*begin);
             instances_.emplace_back(doc, stream->begin(), stream->end());
         }
+        charge_instances();
     }
 
     /**
@@ -104,6 +108,7 @@ class dataset
         auto id = 0_inst_id;
         for (; begin != end; ++begin, ++id)
             instances_.emplace_back(id, *begin);
+        charge_instances();
     }
 
     /**
@@ -119,6 +124,7 @@ class dataset
         auto id = 0_inst_id;
         for (; begin != end; ++begin, ++id)
             instances_.emplace_back(id, featurizer(*begin));
+        charge_instances();
     }
 
     /**
@@ -156,7 +162,7 @@ class dataset
     /**
      * @return the size of the dataset
      */
-    size_type size() const
+    virtual size_type size() const
     {
         return instances_.size();
     }
@@ -177,12 +183,40 @@ class dataset
      *
      * @return the instance at that index in the dataset
      */
-    const instance_type& operator()(size_type index) const
+    virtual const instance_type& operator()(size_type index) const
     {
         return instances_.at(index);
     }
 
+    virtual ~dataset() = default;
+
+  protected:
+    /**
+     * Constructor for derived classes that supply their own instance
+     * storage.
+     */
+    dataset(size_type total_features) : total_features_{total_features}
+    {
+        // nothing
+    }
+
   private:
+    /**
+     * Charges the (approximate) bytes held by the loaded instances to
+     * the dataset's memory account for as long as this dataset lives,
+     * so loaded training data shows up in memory::memory_report().
+     */
+    void charge_instances()
+    {
+        auto bytes = instances_.capacity() * sizeof(instance_type);
+        for (const auto& inst : instances_)
+            bytes += inst.weights.size()
+                     * sizeof(std::pair<feature_id, double>);
+        charge_.add(bytes);
+    }
+
+    /// the bytes held by instances_, charged for this dataset's lifetime
+    memory::scoped_charge charge_{memory::component("learn::dataset")};
     /// the instances themselves
     std::vector<instance_type> instances_;
     /// the total number of unique features in the dataset
@@ -56,10 +56,13 @@ class dataset_view
 
     template <class RandomEngine>
     dataset_view(const dataset& dset, RandomEngine&& rng)
-        : dataset_view{dset, dset.begin(), dset.end(),
-                       std::forward<RandomEngine>(rng)}
+        : dset_{&dset},
+          indices_(dset.size()),
+          rng_(std::forward<RandomEngine>(rng))
     {
-        // nothing
+        // avoid dset.begin()/end() here so that datasets with virtual
+        // storage (e.g. disk_dataset) can be viewed in full
+        std::iota(indices_.begin(), indices_.end(), 0);
     }
 
     template <class RandomEngine>
@@ -139,6 +142,19 @@ class dataset_view
             return ret;
         }
 
+        iterator& operator--()
+        {
+            --it_;
+            return *this;
+        }
+
+        iterator operator--(int)
+        {
+            auto ret = *this;
+            --(*this);
+            return ret;
+        }
+
         iterator& operator+=(difference_type n)
         {
             it_ += n;
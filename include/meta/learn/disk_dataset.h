@@ -0,0 +1,125 @@
+/**
+ * @file disk_dataset.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_LEARN_DISK_DATASET_H_
+#define META_LEARN_DISK_DATASET_H_
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/io/mmap_file.h"
+#include "meta/learn/dataset.h"
+
+namespace meta
+{
+namespace learn
+{
+
+/**
+ * A dataset whose instances live in a packed on-disk file instead of
+ * RAM. The file is written once at construction (delta-encoded feature
+ * ids and packed weights per instance) and then memory mapped, so the
+ * operating system manages residency: datasets larger than physical
+ * memory page in and out without the swapping collapse caused by the
+ * fully materialized std::vector<instance> of the base class.
+ *
+ * instance::weights decodes lazily on access: operator() decodes the
+ * requested instance from the mapped bytes and keeps a bounded LRU
+ * cache of hot decoded instances, so repeated epochs over a shuffled
+ * working set mostly hit the cache. A returned instance reference stays
+ * valid until its entry is evicted, i.e. for at least cache_size
+ * subsequent accesses to distinct instances.
+ *
+ * Use through dataset_view like any other dataset; the packed file and
+ * its offsets sidecar (path + ".index") are reused on reconstruction if
+ * they already exist.
+ */
+class disk_dataset : public dataset
+{
+  public:
+    /// The default number of decoded instances kept in memory
+    const static constexpr uint64_t default_cache_size = 4096;
+
+    /**
+     * Creates (or reopens) a packed on-disk dataset from a
+     * forward_index and a range of doc_ids.
+     *
+     * @param idx The forward_index to read instances from
+     * @param begin The beginning of the range of doc_ids
+     * @param end The end of the range of doc_ids
+     * @param path The path for the packed instance file
+     * @param cache_size The maximum number of decoded instances to keep
+     */
+    template <class ForwardIterator>
+    disk_dataset(std::shared_ptr<index::forward_index> idx,
+                 ForwardIterator begin, ForwardIterator end,
+                 const std::string& path,
+                 uint64_t cache_size = default_cache_size)
+        : disk_dataset{std::move(idx), std::vector<doc_id>(begin, end), path,
+                       cache_size}
+    {
+        // nothing
+    }
+
+    /**
+     * Reopens a previously written packed dataset without needing the
+     * originating index.
+     *
+     * @param path The path for the packed instance file
+     * @param cache_size The maximum number of decoded instances to keep
+     */
+    disk_dataset(const std::string& path,
+                 uint64_t cache_size = default_cache_size);
+
+    size_type size() const override;
+
+    const instance_type& operator()(size_type index) const override;
+
+  private:
+    disk_dataset(std::shared_ptr<index::forward_index> idx,
+                 std::vector<doc_id> docs, const std::string& path,
+                 uint64_t cache_size);
+
+    /**
+     * Writes the packed instance file and its offsets sidecar.
+     */
+    static size_type write_packed(index::forward_index& idx,
+                                  const std::vector<doc_id>& docs,
+                                  const std::string& path);
+
+    /**
+     * Loads the offsets sidecar and maps the instance file.
+     */
+    void open(const std::string& path);
+
+    /**
+     * Decodes the instance at the given index from the mapped bytes.
+     */
+    instance_type decode(size_type index) const;
+
+    /// The memory mapped packed instance file
+    util::optional<io::mmap_file> data_;
+
+    /// Byte offset of each instance in the mapped file
+    std::vector<uint64_t> offsets_;
+
+    /// The maximum number of decoded instances kept in memory
+    uint64_t cache_size_;
+
+    /// Decoded instances in most- to least-recently used order
+    mutable std::list<std::pair<size_type, instance_type>> cache_;
+
+    /// Locates an index's entry in the cache list
+    mutable std::unordered_map<size_type, decltype(cache_)::iterator> cached_;
+};
+}
+}
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file instance_stream.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_LEARN_INSTANCE_STREAM_H_
+#define META_LEARN_INSTANCE_STREAM_H_
+
+#include <memory>
+
+#include "meta/config.h"
+#include "meta/index/forward_index.h"
+#include "meta/learn/instance.h"
+
+namespace meta
+{
+namespace learn
+{
+
+/**
+ * A single-pass, out-of-core view over the documents of a forward_index.
+ * Unlike dataset, which materializes every document's feature_vector in
+ * RAM up front, instance_stream decodes one instance at a time from the
+ * memory mapped postings file in doc_id order and retains nothing, so
+ * collections far larger than memory can be consumed at disk bandwidth.
+ * The postings mapping is advised for sequential access on construction
+ * so the OS prefetches ahead of the scan and drops pages behind it.
+ *
+ * Intended for streaming learners (e.g. sgd-based classifiers) that only
+ * need each training example once per pass; re-iterate by constructing a
+ * fresh begin() iterator for each pass.
+ */
+class instance_stream
+{
+  public:
+    /**
+     * An input iterator over the instances of the index.
+     */
+    class iterator
+    {
+      public:
+        using value_type = instance;
+        using reference = const instance&;
+        using pointer = const instance*;
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+
+        /**
+         * Constructs the past-the-end iterator.
+         */
+        iterator() : idx_{nullptr}, instance_{0_inst_id}
+        {
+            // nothing
+        }
+
+        /**
+         * @param idx The index to iterate over, starting at doc_id 0
+         */
+        iterator(const index::forward_index* idx)
+            : idx_{idx}, instance_{0_inst_id}
+        {
+            load();
+        }
+
+        reference operator*() const
+        {
+            return instance_;
+        }
+
+        pointer operator->() const
+        {
+            return &instance_;
+        }
+
+        iterator& operator++()
+        {
+            instance_.id = instance_id{instance_.id + 1};
+            load();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return idx_ == other.idx_
+                   && (!idx_ || instance_.id == other.instance_.id);
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+      private:
+        /**
+         * Decodes the current document's feature vector, or becomes the
+         * past-the-end iterator when the index is exhausted.
+         */
+        void load()
+        {
+            auto d_id = doc_id{static_cast<uint64_t>(instance_.id)};
+            if (static_cast<uint64_t>(d_id) >= idx_->num_docs())
+            {
+                idx_ = nullptr;
+                return;
+            }
+
+            auto stream = idx_->stream_for(d_id);
+            instance_.weights = feature_vector{stream->begin(),
+                                               stream->end()};
+        }
+
+        /// the index being iterated (nullptr when past the end)
+        const index::forward_index* idx_;
+        /// the current instance, reused between increments
+        instance instance_;
+    };
+
+    /**
+     * @param idx The forward index to stream instances from
+     */
+    instance_stream(std::shared_ptr<index::forward_index> idx)
+        : idx_{std::move(idx)}
+    {
+        idx_->advise_sequential();
+    }
+
+    /**
+     * @return an iterator positioned at the first document
+     */
+    iterator begin() const
+    {
+        return {idx_.get()};
+    }
+
+    /**
+     * @return the past-the-end iterator
+     */
+    iterator end() const
+    {
+        return {};
+    }
+
+    /**
+     * @return the number of instances this stream will yield
+     */
+    uint64_t size() const
+    {
+        return idx_->num_docs();
+    }
+
+  private:
+    /// the index the instances are streamed from
+    std::shared_ptr<index::forward_index> idx_;
+};
+}
+}
+#endif
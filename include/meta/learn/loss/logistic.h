@@ -35,6 +35,20 @@ struct logistic : public loss_function
 
     double loss(double prediction, double expected) const override;
     double derivative(double prediction, double expected) const override;
+
+    /**
+     * Batch overrides using the fast exp/log approximations from
+     * math/fastapprox.h, since the per-instance std::exp dominates
+     * mini-batch training with this loss. The approximation error is
+     * well below the noise floor of stochastic training.
+     */
+    void evaluate(util::array_view<const double> predictions,
+                  util::array_view<const double> expected,
+                  util::array_view<double> out) const override;
+    void evaluate_derivative(util::array_view<const double> predictions,
+                             util::array_view<const double> expected,
+                             util::array_view<double> out) const override;
+
     void save(std::ostream& out) const override;
 };
 }
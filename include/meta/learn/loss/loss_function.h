@@ -12,6 +12,8 @@
 #include <ostream>
 #include <string>
 
+#include "meta/util/array_view.h"
+
 namespace meta
 {
 namespace learn
@@ -53,11 +55,42 @@ struct loss_function
      */
     virtual double derivative(double prediction, double expected) const = 0;
 
+    /**
+     * Evaluates the loss for a batch of predictions at once, writing
+     * loss(predictions[i], expected[i]) into out[i]. The default
+     * implementation is a scalar loop over loss(); loss functions with
+     * transcendental math override this with approximate vectorized
+     * kernels for use in mini-batch training.
+     *
+     * @param predictions The predictions obtained from the model
+     * @param expected The expected values of the model's predictions
+     * @param out The buffer to write the losses into (same length)
+     */
+    virtual void evaluate(util::array_view<const double> predictions,
+                          util::array_view<const double> expected,
+                          util::array_view<double> out) const;
+
+    /**
+     * Evaluates the loss derivative for a batch of predictions at once,
+     * writing derivative(predictions[i], expected[i]) into out[i]. The
+     * default implementation is a scalar loop over derivative().
+     *
+     * @param predictions The predictions obtained from the model
+     * @param expected The expected values of the model's predictions
+     * @param out The buffer to write the derivatives into (same length)
+     */
+    virtual void
+    evaluate_derivative(util::array_view<const double> predictions,
+                        util::array_view<const double> expected,
+                        util::array_view<double> out) const;
+
     /**
      * Saves the loss function to a stream.
      * @param out The stream to write to
      */
     virtual void save(std::ostream& out) const = 0;
+
+    virtual ~loss_function() = default;
 };
 }
 }
@@ -9,11 +9,13 @@
 #ifndef META_LEARN_SGD_H_
 #define META_LEARN_SGD_H_
 
+#include <utility>
 #include <vector>
 
 #include "meta/config.h"
 #include "meta/learn/dataset.h"
 #include "meta/learn/loss/loss_function.h"
+#include "meta/util/aligned_allocator.h"
 
 namespace meta
 {
@@ -163,6 +165,35 @@ class sgd_model
     double train_one(const feature_vector& x, double expected_label,
                      const loss::loss_function& loss);
 
+    /**
+     * Updates the model with a mini-batch of instances in one step.
+     * Gradients for the whole batch are accumulated into a dense,
+     * cache-aligned buffer and applied with a single pass over the
+     * touched features, so the L2 scale shrinking and the
+     * renormalization check are paid once per batch rather than once
+     * per instance. The update uses the mean gradient of the batch,
+     * with the same normalized adaptive gradient bookkeeping as
+     * train_one().
+     *
+     * @param begin The beginning of the range of instances
+     * @param end The end of the range of instances
+     * @param loss The loss function to use for the update
+     * @param labeler A unary function object to convert an instance ->
+     *  double label
+     *
+     * @return the total loss incurred for this batch
+     */
+    template <class ForwardIterator, class LabelFunction>
+    double train_batch(ForwardIterator begin, ForwardIterator end,
+                       const loss::loss_function& loss,
+                       LabelFunction&& labeler)
+    {
+        batch_.clear();
+        for (; begin != end; ++begin)
+            batch_.emplace_back(&begin->weights, labeler(*begin));
+        return train_batch_impl(loss);
+    }
+
   private:
     /**
      * Per-feature representation of the weight vector.
@@ -203,6 +234,8 @@ class sgd_model
 
     void penalize(weight_type& weight_val);
 
+    double train_batch_impl(const loss::loss_function& loss);
+
     void reset();
 
     double l2norm() const;
@@ -232,6 +265,25 @@ class sgd_model
 
     /// The total number of observed examples
     std::size_t t_;
+
+    /// Dense accumulator for mini-batch gradients, aligned for
+    /// vectorized access; lazily sized to match weights_
+    util::aligned_vector<double> grad_;
+
+    /// Marks features with accumulated gradient in the current batch
+    std::vector<uint8_t> in_batch_;
+
+    /// The features touched by the current batch, for sparse apply
+    std::vector<std::size_t> touched_;
+
+    /// Scratch storage for the instances of the current batch
+    std::vector<std::pair<const feature_vector*, double>> batch_;
+
+    /// Scratch storage for batched loss evaluation
+    std::vector<double> predictions_;
+    std::vector<double> expected_;
+    std::vector<double> derivatives_;
+    std::vector<double> losses_;
 };
 }
 }
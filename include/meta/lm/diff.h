@@ -114,6 +114,40 @@ class diff
      */
     void set_function_words(const cpptoml::table& config);
 
+    /**
+     * Per-position language model scores and states for the sentence
+     * currently being edited. Candidates differ from that sentence by a
+     * single edit, so they can be scored by rescoring only from the edit
+     * point until the threaded state matches a cached one again, reusing
+     * the cached prefix and suffix sums for the rest of the sentence.
+     */
+    struct sentence_cache
+    {
+        /// states[i] is the state before scoring token i (size() + 1 many)
+        std::vector<lm_state> states;
+
+        /// prefix[i] is the total log prob of tokens [0, i)
+        std::vector<double> prefix;
+    };
+
+    /**
+     * @param sent The sentence to score token by token
+     * @return the cached per-position scores and states for the sentence
+     */
+    sentence_cache cache_sentence(const sentence& sent) const;
+
+    /**
+     * @param cache The cache of the sentence the edit was applied to
+     * @param sent The edited sentence
+     * @param edit_idx The index of the edit in the edited sentence
+     * @param shift The offset of the edited sentence's tokens relative to
+     * the original after the edit point (+1 insert, -1 remove, 0
+     * substitute)
+     * @return the log prob of the edited sentence
+     */
+    double incremental_score(const sentence_cache& cache, const sentence& sent,
+                             uint64_t edit_idx, int64_t shift) const;
+
     /**
      * @param sent
      * @param candidates
@@ -123,41 +157,46 @@ class diff
     void step(const sentence& sent, PQ& candidates, size_t depth);
 
     /**
+     * @param cache
      * @param sent
      * @param idx
      * @param candidates
      * @param depth
      */
     template <class PQ>
-    void insert(const sentence& sent, size_t idx, PQ& candidates,
-                uint64_t depth);
+    void insert(const sentence_cache& cache, const sentence& sent, size_t idx,
+                PQ& candidates, uint64_t depth);
 
     /**
+     * @param cache
      * @param sent
      * @param candidates
      * @param depth
      */
     template <class PQ>
-    void lm_ops(const sentence& sent, PQ& candidates, uint64_t depth);
+    void lm_ops(const sentence_cache& cache, const sentence& sent,
+                PQ& candidates, uint64_t depth);
     /**
+     * @param cache
      * @param sent
      * @param idx
      * @param candidates
      * @param depth
      */
     template <class PQ>
-    void remove(const sentence& sent, size_t idx, PQ& candidates,
-                uint64_t depth);
+    void remove(const sentence_cache& cache, const sentence& sent, size_t idx,
+                PQ& candidates, uint64_t depth);
 
     /**
+     * @param cache
      * @param sent
      * @param idx
      * @param candidates
      * @param depth
      */
     template <class PQ>
-    void substitute(const sentence& sent, size_t idx, PQ& candidates,
-                    uint64_t depth);
+    void substitute(const sentence_cache& cache, const sentence& sent,
+                    size_t idx, PQ& candidates, uint64_t depth);
 
     /**
      * @param candidates
@@ -166,6 +205,15 @@ class diff
     template <class PQ>
     void add(PQ& candidates, const sentence& sent);
 
+    /**
+     * Adds a candidate whose log prob was computed incrementally.
+     * @param candidates
+     * @param sent
+     * @param log_prob
+     */
+    template <class PQ>
+    void add(PQ& candidates, const sentence& sent, double log_prob);
+
     language_model lm_;
 
     uint64_t n_val_;
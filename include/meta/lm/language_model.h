@@ -51,6 +51,8 @@ class language_model_exception : public std::runtime_error
  * ~~~toml
  * [language-model]
  * arpa-file = "path-to-arpa-file" # if no binary files have yet been created
+ * quantize-bits = 0 # 8 or 16 stores values as codebook indices of that
+ *                   # width (chosen when converting the .arpa file)
  * ~~~
  */
 class language_model
@@ -125,12 +127,45 @@ class language_model
     float score(const lm_state& in_state, term_id token,
                 lm_state& out_state) const;
 
+    /**
+     * Returns the score according to the language model for generating
+     * the next token given the current state in_state. The context needed
+     * for scoring the next word is written to out_state. Incremental
+     * decoders should prefer threading states through this function (or
+     * its term_id overload) over rescoring a growing sentence, which
+     * recomputes the full context at every position.
+     *
+     * @param in_state The context, which is either just <s> or was
+     * filled for you by a previous call to score()
+     * @param token The next token to score (as a string)
+     * @param out_state Storage to write the state for the next query to
+     *
+     * @return \f$p(w_n \mid w_1, \ldots, w_{n-1})\f$
+     */
+    float score(const lm_state& in_state, const std::string& token,
+                lm_state& out_state) const;
+
+    /**
+     * Scores every hypothesis in an n-best list, deduplicating shared
+     * prefixes: a trie is built over the hypothesis tokens and each
+     * unique extension is scored exactly once, with its state carried
+     * in the trie node. N-best lists from beam decoders share most of
+     * their prefixes, so this does far less work than calling
+     * log_prob() per hypothesis.
+     *
+     * @param hypotheses The n-best list to rescore
+     * @return the log probability of each hypothesis, in input order
+     */
+    std::vector<float>
+    rescore_nbest(const std::vector<sentence>& hypotheses) const;
+
   private:
     /**
      * Reads precomputed LM data into this object.
      * @param arpa_file The path to the ARPA-formatted file
+     * @param quant_bits The width of the quantized values (0, 8, or 16)
      */
-    void read_arpa_format(const std::string& arpa_file);
+    void read_arpa_format(const std::string& arpa_file, uint8_t quant_bits);
 
     /**
      * Internal log_prob that takes a token_list
@@ -0,0 +1,80 @@
+/**
+ * @file quantize.h
+ * @author Sean Massung
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_LM_QUANTIZE_H_
+#define META_LM_QUANTIZE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace lm
+{
+namespace quantize
+{
+
+/**
+ * Builds an equal-frequency codebook of at most max_bins values. When
+ * there are no more than max_bins distinct values the quantization is
+ * lossless; otherwise each code maps to the mean of one equal-count bin.
+ * The returned codebook is sorted, so decoding is an array lookup and
+ * encoding is a binary search for the nearest value.
+ *
+ * @param values The values to be quantized
+ * @param max_bins The maximum codebook size (e.g. 256 for 8-bit codes)
+ * @return the codebook, one float per code
+ */
+inline std::vector<float> build_codebook(std::vector<float> values,
+                                         std::size_t max_bins)
+{
+    std::sort(values.begin(), values.end());
+
+    std::vector<float> book{values};
+    book.erase(std::unique(book.begin(), book.end()), book.end());
+    if (book.size() <= max_bins)
+        return book;
+
+    book.clear();
+    for (std::size_t bin = 0; bin < max_bins; ++bin)
+    {
+        auto begin = bin * values.size() / max_bins;
+        auto end = (bin + 1) * values.size() / max_bins;
+        auto sum = std::accumulate(values.begin() + begin,
+                                   values.begin() + end, 0.0);
+        book.push_back(static_cast<float>(sum / (end - begin)));
+    }
+    book.erase(std::unique(book.begin(), book.end()), book.end());
+    return book;
+}
+
+/**
+ * @param book A codebook created with build_codebook()
+ * @param value The value to quantize
+ * @return the code of the codebook value nearest to the given value
+ */
+inline uint64_t encode(const std::vector<float>& book, float value)
+{
+    auto it = std::lower_bound(book.begin(), book.end(), value);
+    if (it == book.end())
+        return book.size() - 1;
+    if (it == book.begin())
+        return 0;
+    if (value - *(it - 1) <= *it - value)
+        --it;
+    return static_cast<uint64_t>(std::distance(book.begin(), it));
+}
+}
+}
+}
+#endif
@@ -10,7 +10,9 @@
 #ifndef META_STATIC_PROBE_MAP_H_
 #define META_STATIC_PROBE_MAP_H_
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "meta/config.h"
 #include "meta/lm/lm_node.h"
@@ -29,6 +31,12 @@ namespace lm
  * table. The values of (prob, backoff) are stored as two packed floats in a
  * uint64_t. The use of uint64_t allows storage to exist in a util::disk_vector,
  * which makes loading after the initial creation relatively fast.
+ *
+ * Optionally, the values can be quantized to 8- or 16-bit codebook indices
+ * (equal-frequency binning at build time, lookup-table dequantization at
+ * query time). Quantized tables store the keys and the codes in separate
+ * arrays, so probing touches half as many bytes per slot and more of a
+ * hot table fits in cache; the codes add only 2 or 4 bytes per slot.
  */
 class static_probe_map
 {
@@ -40,15 +48,30 @@ class static_probe_map
      * @param num_elems The number of elements that will be stored in this map.
      * Note that the storage required will be more than this amount in order to
      * have an acceptable load factor. If num_elems is zero, binary LM files
-     * are loaded.
+     * are loaded (including the quantization codebooks if the table was
+     * built with quantization).
+     * @param quant_bits 0 to store exact packed floats, or 8 or 16 to
+     * store codebook indices of that width; when nonzero, quantize() must
+     * be called before the first insert()
      */
-    static_probe_map(const std::string& filename, uint64_t num_elems = 0);
+    static_probe_map(const std::string& filename, uint64_t num_elems = 0,
+                     uint8_t quant_bits = 0);
 
     /**
      * Default move constructor.
      */
     static_probe_map(static_probe_map&&) = default;
 
+    /**
+     * Builds the quantization codebooks from the values that will later
+     * be inserted and writes them alongside the table file. Only valid
+     * (and required) for tables created with nonzero quant_bits.
+     *
+     * @param probs All probability values that will be inserted
+     * @param backoffs All backoff values that will be inserted
+     */
+    void quantize(std::vector<float> probs, std::vector<float> backoffs);
+
     /**
      * @param key The key to search for in the map (vector of word ids)
      * @return an optional language model node containing the probability and
@@ -77,8 +100,30 @@ class static_probe_map
     /// A seed for the string hash function
     static constexpr uint64_t seed_ = 0x2bedf99b3aa222d9;
 
+    /// The filename the table was created with
+    std::string filename_;
+
     /// The internal map representing std::string -> lm_node pairs
-    util::disk_vector<uint64_t> table_;
+    /// (interleaved [hash, value] slots; null when quantized)
+    std::unique_ptr<util::disk_vector<uint64_t>> table_;
+
+    /// The key hashes of a quantized table, one per slot
+    std::unique_ptr<util::disk_vector<uint64_t>> keys_;
+
+    /// The packed (prob, backoff) codes of an 8-bit quantized table
+    std::unique_ptr<util::disk_vector<uint16_t>> codes8_;
+
+    /// The packed (prob, backoff) codes of a 16-bit quantized table
+    std::unique_ptr<util::disk_vector<uint32_t>> codes16_;
+
+    /// The number of bits per quantized value (0 when not quantized)
+    uint8_t quant_bits_ = 0;
+
+    /// The probability value for each probability code
+    std::vector<float> prob_book_;
+
+    /// The backoff value for each backoff code
+    std::vector<float> backoff_book_;
 };
 
 /**
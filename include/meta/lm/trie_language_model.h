@@ -0,0 +1,222 @@
+/**
+ * @file trie_language_model.h
+ * @author Sean Massung
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_LM_TRIE_LANGUAGE_MODEL_H_
+#define META_LM_TRIE_LANGUAGE_MODEL_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cpptoml.h"
+#include "meta/config.h"
+#include "meta/lm/lm_node.h"
+#include "meta/lm/lm_state.h"
+#include "meta/lm/sentence.h"
+#include "meta/succinct/compressed_vector.h"
+#include "meta/util/disk_vector.h"
+#include "meta/util/optional.h"
+
+namespace meta
+{
+namespace lm
+{
+
+/**
+ * An ngram language model class that stores its ngrams in a reverse trie
+ * (in the style of KenLM's trie data structure). An ngram
+ * \f$w_1, \ldots, w_n\f$ is stored along the path
+ * \f$w_n \rightarrow w_{n-1} \rightarrow \cdots \rightarrow w_1\f$, so
+ * scoring a token walks backward through its context and all of the
+ * context suffixes needed for backoff share one traversal. Every array in
+ * the structure (child words, child ranges and the quantized
+ * probability/backoff values of the middle and highest orders) is
+ * bit-packed with succinct::compressed_vector, so the binary
+ * representation is typically several times smaller than the hashed
+ * representation used by lm::language_model while returning the same
+ * scores up to quantization error. Probabilities and backoffs for orders
+ * above unigrams are quantized to at most 256 distinct values per order
+ * with equal-frequency binning; unigram values are stored exactly.
+ *
+ * This class requires the ARPA input to satisfy the suffix property: if
+ * \f$w_1, \ldots, w_n\f$ is listed, then \f$w_2, \ldots, w_n\f$ must be
+ * listed as well. Models produced by KenLM and SRILM satisfy this.
+ *
+ * @see https://kheafield.com/code/kenlm/
+ *
+ * Required config parameters:
+ * ~~~toml
+ * [language-model]
+ * binary-file-prefix = "path-to-binary-files"
+ * # only this key is needed if the LM is already binarized
+ * ~~~
+ *
+ * Optional config parameters:
+ * ~~~toml
+ * [language-model]
+ * arpa-file = "path-to-arpa-file" # if no binary files have yet been created
+ * ~~~
+ */
+class trie_language_model
+{
+  public:
+    /**
+     * Creates an N-gram language model based on the corpus specified in the
+     * config file.
+     */
+    trie_language_model(const cpptoml::table& config);
+
+    /**
+     * Default move constructor.
+     */
+    trie_language_model(trie_language_model&&) = default;
+
+    /**
+     * Convert a unigram into its vocabulary id.
+     * @param token The unigram to look up
+     * @return the vocabulary id for this token
+     */
+    term_id index(const std::string& token) const;
+
+    /**
+     * @return the vocabulary id for the <unk> token
+     */
+    term_id unk() const;
+
+    /**
+     * Returns the score according to the language model for generating
+     * the next token given the current state in_state. The context needed
+     * for scoring the next word is written to out_state.
+     *
+     * @param in_state The context, which is either just <s> or was
+     * filled for you by a previous call to score()
+     * @param token The next token to score (as a word index)
+     * @param out_state Storage to write the state for the next query to
+     *
+     * @return \f$p(w_n \mid w_1, \ldots, w_{n-1})\f$
+     */
+    float score(const lm_state& in_state, term_id token,
+                lm_state& out_state) const;
+
+    /**
+     * @param tokens A sequence of n tokens (one sentence)
+     * @return the log probability of the likelihood of this sentence
+     */
+    float log_prob(const sentence& tokens) const;
+
+    /**
+     * @param sentence A sequence of tokens
+     * @return the perplexity of this token sequence given the current language
+     * model: \f$ \sqrt[n]{\prod_{i=1}^n\frac{1}{p(w_i|w_{i-n}\cdots w_{i-1})}}
+     * \f$
+     */
+    float perplexity(const sentence& tokens) const;
+
+    /**
+     * @param sentence A sequence of tokens
+     * @return the perplexity of this token sequence given the current language
+     * model normalized by the length of the sequence
+     */
+    float perplexity_per_word(const sentence& tokens) const;
+
+  private:
+    /**
+     * The bit-packed arrays for one order above unigrams. Orders below
+     * the highest store child ranges and backoff values; the highest
+     * order stores only child words and probabilities.
+     */
+    struct order_storage
+    {
+        /// The oldest word of each ngram, grouped by parent node
+        std::unique_ptr<succinct::compressed_vector> words;
+
+        /// Child range offsets into the next order (absent at order N)
+        std::unique_ptr<succinct::compressed_vector> children;
+
+        /// Quantized probability codes, one per ngram
+        std::unique_ptr<succinct::compressed_vector> probs;
+
+        /// Quantized backoff codes, one per ngram (absent at order N)
+        std::unique_ptr<succinct::compressed_vector> backoffs;
+
+        /// The probability value for each probability code
+        std::vector<float> prob_book;
+
+        /// The backoff value for each backoff code
+        std::vector<float> backoff_book;
+    };
+
+    /**
+     * Builds the trie from an ARPA-formatted file and writes the binary
+     * representation under the configured prefix.
+     * @param arpa_file The path to the ARPA-formatted file
+     */
+    void build(const std::string& arpa_file);
+
+    /**
+     * Loads a previously built binary trie from the configured prefix.
+     */
+    void load_binary();
+
+    /**
+     * Loads unigram vocabulary from text file
+     */
+    void load_vocab();
+
+    /**
+     * Finds the trie node for an ngram one word longer than the given
+     * node by binary searching the node's child range.
+     *
+     * @param order The order (ngram length) of the given node
+     * @param node The index of the node within its order
+     * @param word The word to extend the ngram with (at the oldest
+     * position)
+     * @return the index of the child within order + 1, if it exists
+     */
+    util::optional<uint64_t> find_child(uint64_t order, uint64_t node,
+                                        term_id word) const;
+
+    /**
+     * @param order The order (ngram length) of the given node
+     * @param node The index of the node within its order
+     * @return the backoff weight stored on that node
+     */
+    float backoff(uint64_t order, uint64_t node) const;
+
+    uint64_t N_; /// The "n" value for this n-gram language model
+
+    /// Exact unigram (prob, backoff) nodes, indexed by word id
+    std::unique_ptr<util::disk_vector<uint64_t>> unigrams_;
+
+    /// Child range offsets from unigrams into the bigram arrays
+    std::unique_ptr<succinct::compressed_vector> unigram_children_;
+
+    /// Storage for orders 2 through N; index i holds order i + 2
+    std::vector<order_storage> orders_;
+
+    std::unordered_map<std::string, term_id> vocabulary_;
+
+    std::string prefix_;
+
+    term_id unk_id_;
+};
+
+/**
+ * Basic exception for trie_language_model interactions.
+ */
+class trie_language_model_exception : public std::runtime_error
+{
+  public:
+    using std::runtime_error::runtime_error;
+};
+}
+}
+
+#endif
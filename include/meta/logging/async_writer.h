@@ -0,0 +1,138 @@
+/**
+ * @file async_writer.h
+ * @author Chase Geigle
+ * An asynchronous backend for the logging interface.
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_LOGGING_ASYNC_WRITER_H_
+#define META_LOGGING_ASYNC_WRITER_H_
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "meta/config.h"
+#include "meta/logging/logger.h"
+#include "meta/parallel/mpmc_queue.h"
+
+namespace meta
+{
+namespace logging
+{
+
+/**
+ * Decouples log formatting and I/O from the logging thread. While an
+ * async_writer is alive, logging threads only copy the line's payload
+ * into a lock-free ring (parallel::mpmc_queue); a dedicated writer
+ * thread replays the lines through the logger's sinks, so a stray
+ * info-level log in a parallel region no longer stalls workers on the
+ * stream. When the ring is momentarily full, the logging thread falls
+ * back to the old synchronous write rather than dropping the line.
+ *
+ * Install after adding sinks and before logging threads start; destroy
+ * (or flush()) after they stop to guarantee everything reached the
+ * sinks:
+ *
+ * ~~~cpp
+ * logging::set_cerr_logging();
+ * logging::async_writer writer; // logging is now non-blocking
+ * ~~~
+ */
+class async_writer
+{
+  public:
+    /**
+     * Installs this writer as the given logger's backend.
+     *
+     * @param log The logger to take over (the global one by default)
+     * @param capacity The staging ring's capacity, in log lines
+     */
+    async_writer(logger& log = get_logger(), std::size_t capacity = 1024)
+        : log_(log), queue_{capacity}, staged_{0}, written_{0}
+    {
+        writer_ = std::thread{[this]() { drain(); }};
+        log_.set_write_hook([this](const logger::log_line& ll) {
+            // count before pushing so flush() never observes a staged
+            // line as already written
+            staged_.fetch_add(1, std::memory_order_acq_rel);
+            if (queue_.try_push(
+                    record{ll.severity(), ll.line(), ll.file(), ll.str()}))
+                return true;
+            staged_.fetch_sub(1, std::memory_order_acq_rel);
+            return false;
+        });
+    }
+
+    async_writer(const async_writer&) = delete;
+    async_writer& operator=(const async_writer&) = delete;
+
+    /**
+     * Uninstalls the hook, drains every staged line, and joins the
+     * writer thread.
+     */
+    ~async_writer()
+    {
+        log_.set_write_hook(nullptr);
+        queue_.close();
+        writer_.join();
+    }
+
+    /**
+     * Blocks until every line staged so far has been written to the
+     * sinks.
+     */
+    void flush()
+    {
+        auto staged = staged_.load(std::memory_order_acquire);
+        while (written_.load(std::memory_order_acquire) < staged)
+            std::this_thread::yield();
+    }
+
+  private:
+    /// The payload of one staged log line
+    struct record
+    {
+        logger::severity_level sev;
+        std::size_t line;
+        std::string file;
+        std::string msg;
+    };
+
+    /**
+     * The writer thread's loop: replay each staged line through the
+     * sinks as if it had been written synchronously.
+     */
+    void drain()
+    {
+        record rec;
+        while (queue_.pop(rec))
+        {
+            logger::log_line ll{log_, rec.sev, rec.line, rec.file};
+            ll << rec.msg;
+            log_.write_direct(ll);
+            written_.fetch_add(1, std::memory_order_acq_rel);
+        }
+    }
+
+    /// The logger whose sinks we write to
+    logger& log_;
+
+    /// The lock-free staging ring
+    parallel::mpmc_queue<record> queue_;
+
+    /// The number of lines staged into the ring so far
+    std::atomic<std::size_t> staged_;
+
+    /// The number of staged lines written to the sinks so far
+    std::atomic<std::size_t> written_;
+
+    /// The dedicated writer thread
+    std::thread writer_;
+};
+}
+}
+#endif
@@ -358,11 +358,46 @@ class logger
     }
 
     /**
-     * Writes the given log_line to all sinks.
+     * Convenience typedef for functions that intercept log lines before
+     * they reach the sinks. A hook returning true claims the line; a
+     * hook returning false (e.g. an async writer whose queue is full)
+     * falls back to the synchronous path.
+     */
+    using write_hook = std::function<bool(const log_line&)>;
+
+    /**
+     * Installs (or, with an empty function, removes) a write hook.
+     * Hooks must be installed before logging threads start and removed
+     * after they stop; the logger does not synchronize hook swaps
+     * against concurrent writes.
+     *
+     * @param hook The hook to install
+     */
+    void set_write_hook(write_hook hook)
+    {
+        hook_ = std::move(hook);
+    }
+
+    /**
+     * Writes the given log_line to all sinks, routing it through the
+     * write hook first when one is installed.
      *
      * @param line The log_line to write
      */
     void write_to_sinks(const log_line& line)
+    {
+        if (hook_ && hook_(line))
+            return;
+        write_direct(line);
+    }
+
+    /**
+     * Writes the given log_line to all sinks, bypassing any write
+     * hook. Used by async backends to deliver claimed lines.
+     *
+     * @param line The log_line to write
+     */
+    void write_direct(const log_line& line)
     {
         for (sink& s : sinks_)
             s.write(line);
@@ -373,6 +408,11 @@ class logger
      * The list of sinks to write to.
      */
     std::vector<sink> sinks_;
+
+    /**
+     * The (optional) write hook.
+     */
+    write_hook hook_;
 };
 
 /**
@@ -424,10 +464,33 @@ inline void set_cerr_logging(logging::logger::severity_level sev
 }
 }
 
+// Numeric mirrors of logger::severity_level, usable in preprocessor
+// arithmetic so hot-path log statements can be stripped at compile time.
+#define META_LOG_SEVERITY_progress 0
+#define META_LOG_SEVERITY_trace 1
+#define META_LOG_SEVERITY_debug 2
+#define META_LOG_SEVERITY_info 3
+#define META_LOG_SEVERITY_warning 4
+#define META_LOG_SEVERITY_error 5
+#define META_LOG_SEVERITY_fatal 6
+
+// Define (e.g. -DMETA_LOG_MIN_SEVERITY=META_LOG_SEVERITY_warning) to
+// compile out every LOG() statement below the given severity: the
+// stream expression becomes dead code behind a constant-false branch
+// and its arguments are never evaluated.
+#ifndef META_LOG_MIN_SEVERITY
+#define META_LOG_MIN_SEVERITY META_LOG_SEVERITY_progress
+#endif
+
 #define LOG(sev)                                                               \
-    logging::logger::log_line(logging::get_logger(),                           \
-                              logging::logger::severity_level::sev, __LINE__,  \
-                              __FILE__)
+    if (META_LOG_SEVERITY_##sev < META_LOG_MIN_SEVERITY)                       \
+    {                                                                          \
+        /* stripped at compile time */                                         \
+    }                                                                          \
+    else                                                                       \
+        logging::logger::log_line(logging::get_logger(),                       \
+                                  logging::logger::severity_level::sev,        \
+                                  __LINE__, __FILE__)
 #define ENDLG logging::logger::log_line::endlg
 #define LOG_FUNCTION_START()                                                   \
     LOG(trace) << "entering " << __func__ << "()" << ENDLG
@@ -0,0 +1,107 @@
+/**
+ * @file compute_backend.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_MATH_COMPUTE_BACKEND_H_
+#define META_MATH_COMPUTE_BACKEND_H_
+
+#include <cstddef>
+#include <memory>
+
+#include "meta/config.h"
+#include "meta/util/string_view.h"
+
+namespace meta
+{
+namespace math
+{
+
+/**
+ * An offload point for the toolkit's dense hot kernels. The interface
+ * is deliberately block-oriented — a matrix of contiguous rows scored
+ * against one query, a batch of AdaGrad row updates staged into one
+ * flat gradient block — so a device backend can move each call's data
+ * in bulk transfers rather than element-wise. Callers keep their data
+ * in util::aligned_allocator buffers, which are safe to hand to either
+ * backend.
+ *
+ * The CPU backend (the default, and the only one unless the toolkit is
+ * configured with META_ENABLE_CUDA) runs the same vectorizable loops
+ * the call sites used before this layer existed, so unconfigured
+ * builds pay only one virtual call per *block*. The CUDA backend is
+ * selected automatically at startup when it was compiled in and a
+ * usable device is present.
+ */
+class compute_backend
+{
+  public:
+    virtual ~compute_backend() = default;
+
+    /**
+     * @return a human-readable name for this backend ("cpu", "cuda")
+     */
+    virtual util::string_view name() const = 0;
+
+    /**
+     * Scores a query against every row of a row-major matrix:
+     * out[r] = matrix_row_r . query.
+     *
+     * @param matrix The row-major matrix, num_rows * dim contiguous values
+     * @param num_rows The number of rows
+     * @param dim The number of columns (and the query length)
+     * @param query The query vector
+     * @param out An output buffer of num_rows scores
+     */
+    virtual void dot_products(const double* matrix, std::size_t num_rows,
+                              std::size_t dim, const double* query,
+                              double* out) const = 0;
+
+    /**
+     * Applies a batch of AdaGrad row updates. For each update u and
+     * dimension i, with w = weights + row_offsets[u] and
+     * a = gradsq + row_offsets[u] and g = grads + u * dim:
+     *
+     *     w[i] -= g[i] / sqrt(a[i]);  a[i] += g[i] * g[i]
+     *
+     * Offsets are element offsets into the weight/accumulator tables,
+     * so strided row layouts (e.g. interleaved target/context rows with
+     * trailing bias slots) stage naturally. Offsets within one batch
+     * must not alias.
+     *
+     * @param weights The weight table
+     * @param gradsq The matching AdaGrad accumulator table
+     * @param row_offsets The element offset of each updated row
+     * @param grads The gradient block, num_updates * dim contiguous values
+     * @param num_updates The number of row updates in the batch
+     * @param dim The length of each row
+     */
+    virtual void adagrad_apply(double* weights, double* gradsq,
+                               const std::size_t* row_offsets,
+                               const double* grads, std::size_t num_updates,
+                               std::size_t dim) const = 0;
+
+    /**
+     * @return the process-wide backend: the device backend when one was
+     * compiled in and a usable device exists, the CPU backend otherwise
+     */
+    static const compute_backend& instance();
+
+    /**
+     * @return the CPU backend, regardless of build configuration
+     */
+    static const compute_backend& cpu();
+};
+
+#if META_HAS_CUDA
+/**
+ * @return a CUDA backend, or nullptr when no usable device is present
+ */
+std::unique_ptr<compute_backend> make_cuda_compute_backend();
+#endif
+}
+}
+#endif
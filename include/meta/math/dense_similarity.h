@@ -0,0 +1,235 @@
+/**
+ * @file dense_similarity.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_MATH_DENSE_SIMILARITY_H_
+#define META_MATH_DENSE_SIMILARITY_H_
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/util/aligned_allocator.h"
+#include "meta/util/array_view.h"
+#include "meta/util/fixed_heap.h"
+
+namespace meta
+{
+namespace math
+{
+namespace dense
+{
+
+/**
+ * The shared "compare one vector to many" kernel. Every dense scoring
+ * path in the toolkit (centroid classification, embedding nearest
+ * neighbors, reranking over dense representations) should funnel
+ * through these functions rather than hand-rolling its own dot product
+ * loop, so they all benefit from the same blocked, vectorizable inner
+ * loops. Explicit intrinsics are deliberately avoided: the loops run
+ * over contiguous doubles with independent accumulators, which the
+ * compiler vectorizes for whatever instruction set it targets.
+ */
+
+/**
+ * @param a The first vector
+ * @param b The second vector
+ * @param dim The length of both vectors
+ * @return their inner product
+ */
+inline double dot(const double* a, const double* b, std::size_t dim)
+{
+    // four independent accumulators break the addition dependency
+    // chain, letting the compiler keep multiple vector lanes in flight
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    std::size_t i = 0;
+    for (; i + 4 <= dim; i += 4)
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < dim; ++i)
+        s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+/**
+ * A (row index, score) pair produced by the top-k scans.
+ */
+struct scored_row
+{
+    std::size_t row;
+    double score;
+};
+
+/**
+ * Scores a query against every row of a row-major matrix.
+ *
+ * @param matrix The row-major matrix, num_rows * dim contiguous values
+ * @param num_rows The number of rows
+ * @param dim The number of columns (and the query length)
+ * @param query The query vector
+ * @param out An output buffer of num_rows scores
+ */
+inline void dot_products(const double* matrix, std::size_t num_rows,
+                         std::size_t dim, const double* query, double* out)
+{
+    for (std::size_t row = 0; row < num_rows; ++row)
+        out[row] = dot(matrix + row * dim, query, dim);
+}
+
+/**
+ * Scores a query against every row of a row-major matrix and returns
+ * the k best rows in descending score order.
+ *
+ * @param matrix The row-major matrix, num_rows * dim contiguous values
+ * @param num_rows The number of rows
+ * @param dim The number of columns (and the query length)
+ * @param query The query vector
+ * @param k The number of rows to return
+ * @return the top k rows by inner product
+ */
+inline std::vector<scored_row> top_k(const double* matrix,
+                                     std::size_t num_rows, std::size_t dim,
+                                     const double* query, std::size_t k)
+{
+    auto results = util::make_fixed_heap<scored_row>(
+        k, [](const scored_row& a, const scored_row& b) {
+            // comparison is reversed since we want a min-heap
+            return a.score > b.score;
+        });
+    for (std::size_t row = 0; row < num_rows; ++row)
+        results.emplace(scored_row{row, dot(matrix + row * dim, query, dim)});
+    return results.extract_top();
+}
+
+/**
+ * An owning row collection for repeated one-against-many scoring, as
+ * used for class centroids: rows live in one aligned, contiguous
+ * buffer, and their norms are precomputed once so cosine scores cost
+ * one dot product per row at query time. Queries may be dense or
+ * sparse.
+ */
+class dense_scorer
+{
+  public:
+    /**
+     * Constructs an empty collection of zero-dimensional rows; assign
+     * over it with a properly dimensioned one before use.
+     */
+    dense_scorer() : dim_{0}
+    {
+        // nothing
+    }
+
+    /**
+     * @param dim The dimensionality of every row
+     */
+    dense_scorer(std::size_t dim) : dim_{dim}
+    {
+        // nothing
+    }
+
+    /**
+     * Copies a row into the collection.
+     *
+     * @param row The row values, dim of them
+     * @return the index the row is stored at
+     */
+    std::size_t add_row(util::array_view<const double> row)
+    {
+        matrix_.insert(matrix_.end(), row.begin(), row.end());
+        norms_.push_back(std::sqrt(dot(row.begin(), row.begin(), dim_)));
+        return norms_.size() - 1;
+    }
+
+    /**
+     * @return the number of rows stored
+     */
+    std::size_t num_rows() const
+    {
+        return norms_.size();
+    }
+
+    /**
+     * @return the dimensionality of the rows
+     */
+    std::size_t dim() const
+    {
+        return dim_;
+    }
+
+    /**
+     * @param row A row index
+     * @return the L2 norm of that row, as precomputed at add_row() time
+     */
+    double norm(std::size_t row) const
+    {
+        return norms_[row];
+    }
+
+    /**
+     * Scores a dense query against every row.
+     *
+     * @param query The query vector, dim long
+     * @param out An output buffer of num_rows() scores
+     */
+    void score(const double* query, double* out) const
+    {
+        dot_products(matrix_.data(), num_rows(), dim_, query, out);
+    }
+
+    /**
+     * Scores a sparse query against every row. Query features at or
+     * beyond dim() (e.g. terms unseen when the rows were built) are
+     * skipped, matching a dense query that is zero there.
+     *
+     * @param begin The beginning of a range of (feature, weight) pairs
+     * @param end The end of the range
+     * @param out An output buffer of num_rows() scores
+     */
+    template <class ForwardIterator>
+    void score_sparse(ForwardIterator begin, ForwardIterator end,
+                      double* out) const
+    {
+        std::fill(out, out + num_rows(), 0.0);
+        for (; begin != end; ++begin)
+        {
+            auto feature = static_cast<std::size_t>(begin->first);
+            if (feature >= dim_)
+                continue;
+            auto weight = static_cast<double>(begin->second);
+            for (std::size_t row = 0; row < num_rows(); ++row)
+                out[row] += weight * matrix_[row * dim_ + feature];
+        }
+    }
+
+    /**
+     * @param query The query vector, dim long
+     * @param k The number of rows to return
+     * @return the top k rows by inner product
+     */
+    std::vector<scored_row> top_k(const double* query, std::size_t k) const
+    {
+        return dense::top_k(matrix_.data(), num_rows(), dim_, query, k);
+    }
+
+  private:
+    /// the dimensionality of every row
+    std::size_t dim_;
+    /// the rows, row-major and contiguous
+    util::aligned_vector<double> matrix_;
+    /// the precomputed L2 norm of each row
+    std::vector<double> norms_;
+};
+}
+}
+}
+#endif
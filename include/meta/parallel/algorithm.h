@@ -15,6 +15,7 @@
 #include "meta/config.h"
 #include "meta/parallel/parallel_for.h"
 #include "meta/parallel/thread_pool.h"
+#include "meta/util/array_view.h"
 
 namespace meta
 {
@@ -65,10 +66,12 @@ reduction(Iterator begin, Iterator end, thread_pool& pool, LocalStorage&& ls_fn,
               return local_storage;
           });
 
-    // reduction phase
+    // reduction phase; joining through the pool keeps nested use safe
+    pool.wait(futures[0]);
     auto local_storage = futures[0].get();
     for (auto it = ++futures.begin(); it != futures.end(); ++it)
     {
+        pool.wait(*it);
         red_fn(local_storage, it->get());
     }
     return local_storage;
@@ -103,6 +106,9 @@ void merge_sort(RandomIt begin, RandomIt end, thread_pool& pool,
                    comp);
     });
     merge_sort(mid, end, pool, avail_threads / 2, comp);
+    // this runs on a worker, so help-run the other half rather than
+    // blocking in get() with it still queued on our own deque
+    pool.wait(t1);
     t1.get();
     std::inplace_merge(begin, mid, end, comp);
 }
@@ -122,6 +128,7 @@ void sort(RandomIt begin, RandomIt end, thread_pool& pool, Compare comp)
 {
     auto fut = pool.submit_task(
         [&]() { detail::merge_sort(begin, end, pool, pool.size(), comp); });
+    pool.wait(fut);
     fut.get();
 }
 
@@ -140,6 +147,87 @@ void sort(RandomIt begin, RandomIt end, thread_pool& pool)
     using value_type = typename std::iterator_traits<RandomIt>::value_type;
     return sort(begin, end, pool, std::less<value_type>{});
 }
+
+/**
+ * Invokes a function once for every maximal run of adjacent equal
+ * elements in a *sorted* range, distributing the runs across a thread
+ * pool. The range is split into several blocks per worker (so stealing
+ * can rebalance skewed group sizes), with block boundaries advanced to
+ * the next group boundary so that each group is passed to exactly one
+ * invocation as a contiguous util::array_view.
+ *
+ * The function may be invoked concurrently from multiple threads, so any
+ * shared state it touches must be synchronized; groups themselves are
+ * disjoint.
+ *
+ * @param items A view over the sorted elements to group
+ * @param pool The thread pool to run on
+ * @param equal The binary predicate defining key equality for adjacent
+ * elements
+ * @param fn The unary function receiving each group as an array_view
+ */
+template <class T, class Equal, class Function>
+void for_each_group(util::array_view<T> items, thread_pool& pool, Equal&& equal,
+                    Function&& fn)
+{
+    if (items.size() == 0)
+        return;
+
+    auto num_blocks = pool.size() * 4;
+    auto block_size = std::max<std::size_t>(1, items.size() / num_blocks);
+
+    std::vector<std::future<void>> futures;
+    std::size_t block = 0;
+    std::size_t begin = 0;
+    while (begin < items.size())
+    {
+        auto end = std::min(begin + block_size, items.size());
+        // extend the block to the end of its last group so no group
+        // straddles two blocks
+        while (end < items.size()
+               && equal(items.begin()[end - 1], items.begin()[end]))
+            ++end;
+
+        futures.emplace_back(pool.submit_task(
+            [&items, &equal, &fn, begin, end]() {
+                auto first = begin;
+                for (auto i = begin + 1; i <= end; ++i)
+                {
+                    if (i == end
+                        || !equal(items.begin()[i - 1], items.begin()[i]))
+                    {
+                        fn(util::array_view<T>{items.begin() + first,
+                                               i - first});
+                        first = i;
+                    }
+                }
+            },
+            block++));
+        begin = end;
+    }
+
+    for (auto& fut : futures)
+    {
+        pool.wait(fut);
+        fut.get();
+    }
+}
+
+/**
+ * Invokes a function once for every maximal run of adjacent equal
+ * elements in a *sorted* range, using operator== for key equality.
+ *
+ * @param items A view over the sorted elements to group
+ * @param pool The thread pool to run on
+ * @param fn The unary function receiving each group as an array_view
+ */
+template <class T, class Function>
+void for_each_group(util::array_view<T> items, thread_pool& pool, Function&& fn)
+{
+    for_each_group(items, pool, std::equal_to<typename std::remove_const<
+                                    T>::type>{},
+                   std::forward<Function>(fn));
+}
 }
 }
 #endif
@@ -0,0 +1,303 @@
+/**
+ * @file mpmc_queue.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_PARALLEL_MPMC_QUEUE_H_
+#define META_PARALLEL_MPMC_QUEUE_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace parallel
+{
+
+/**
+ * A bounded, lock-free multi-producer/multi-consumer ring queue, for
+ * handing work between pipeline stages without convoying on a mutex.
+ * This is the classic bounded MPMC design of Dmitry Vyukov: each slot
+ * carries a sequence number that tells producers and consumers whether
+ * it is ready for them, so both sides make progress with a single
+ * compare-and-swap and never take a lock.
+ *
+ * The queue supports a close() operation for pipeline shutdown:
+ * consumers calling pop() drain the remaining elements and then receive
+ * false once the queue is closed and empty. Producers must finish all
+ * push() calls before closing.
+ *
+ * Blocking push()/pop() spin with std::this_thread::yield() rather than
+ * sleeping on a condition variable; stages are expected to be busy in
+ * the steady state, with blocking only at the ends of a run.
+ */
+template <class T>
+class mpmc_queue
+{
+  public:
+    /**
+     * @param capacity The minimum number of elements the queue can hold;
+     * rounded up to a power of two
+     */
+    explicit mpmc_queue(std::size_t capacity)
+        : enqueue_pos_{0}, dequeue_pos_{0}, closed_{false}
+    {
+        std::size_t cap = 2;
+        while (cap < capacity)
+            cap *= 2;
+        mask_ = cap - 1;
+        cells_ = std::unique_ptr<cell[]>{new cell[cap]};
+        for (std::size_t i = 0; i < cap; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    /**
+     * Destroys any elements left in the queue. Must not race with
+     * concurrent operations.
+     */
+    ~mpmc_queue()
+    {
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        auto end = enqueue_pos_.load(std::memory_order_relaxed);
+        for (; pos != end; ++pos)
+            item(pos)->~T();
+    }
+
+    /**
+     * Attempts to push an element without blocking.
+     *
+     * @param value The element to push; left untouched when the queue is
+     * full
+     * @return whether the element was pushed
+     */
+    bool try_push(T&& value)
+    {
+        cell* c;
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            c = &cells_[pos & mask_];
+            auto seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq)
+                        - static_cast<std::intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                // the slot is still occupied by an element from the
+                // previous lap: the queue is full
+                return false;
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        new (item_storage(pos)) T(std::move(value));
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Attempts to pop an element without blocking.
+     *
+     * @param out Where to place the popped element
+     * @return whether an element was popped
+     */
+    bool try_pop(T& out)
+    {
+        cell* c;
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            c = &cells_[pos & mask_];
+            auto seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq)
+                        - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                // the slot has not been filled yet: the queue is empty
+                return false;
+            }
+            else
+            {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(*item(pos));
+        item(pos)->~T();
+        c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pushes an element, spinning until space is available. Must not be
+     * called after close().
+     *
+     * @param value The element to push
+     */
+    void push(T value)
+    {
+        assert(!closed_.load(std::memory_order_relaxed));
+        while (!try_push(std::move(value)))
+            std::this_thread::yield();
+    }
+
+    /**
+     * Pops an element, spinning until one is available or the queue is
+     * closed and fully drained.
+     *
+     * @param out Where to place the popped element
+     * @return whether an element was popped (false means the queue is
+     * closed and empty)
+     */
+    bool pop(T& out)
+    {
+        while (true)
+        {
+            if (try_pop(out))
+                return true;
+            if (closed_.load(std::memory_order_acquire) && size_approx() == 0)
+                return false;
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Pushes elements from a range until the queue fills up.
+     *
+     * @param first The iterator to the beginning of the range
+     * @param last The iterator to the end of the range
+     * @return an iterator to the first element that was not pushed
+     */
+    template <class Iterator>
+    Iterator try_push_batch(Iterator first, Iterator last)
+    {
+        for (; first != last; ++first)
+        {
+            if (!try_push(std::move(*first)))
+                break;
+        }
+        return first;
+    }
+
+    /**
+     * Pops up to max elements into an output iterator without blocking.
+     *
+     * @param out The output iterator to write popped elements to
+     * @param max The maximum number of elements to pop
+     * @return the number of elements popped
+     */
+    template <class OutputIterator>
+    std::size_t try_pop_batch(OutputIterator out, std::size_t max)
+    {
+        std::size_t popped = 0;
+        T value;
+        while (popped < max && try_pop(value))
+        {
+            *out = std::move(value);
+            ++out;
+            ++popped;
+        }
+        return popped;
+    }
+
+    /**
+     * Marks the queue as closed. Consumers drain the remaining elements
+     * and then see pop() return false. All push() calls must have
+     * completed before this is called.
+     */
+    void close()
+    {
+        closed_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @return whether the queue has been closed
+     */
+    bool closed() const
+    {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return the approximate number of elements in the queue; exact
+     * only when no operations are concurrently in flight
+     */
+    std::size_t size_approx() const
+    {
+        auto enq = enqueue_pos_.load(std::memory_order_relaxed);
+        auto deq = dequeue_pos_.load(std::memory_order_relaxed);
+        return enq >= deq ? enq - deq : 0;
+    }
+
+    /**
+     * @return the capacity of the queue
+     */
+    std::size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+  private:
+    /// one slot of the ring: a sequence number plus element storage
+    struct cell
+    {
+        std::atomic<std::size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    void* item_storage(std::size_t pos)
+    {
+        return &cells_[pos & mask_].storage;
+    }
+
+    T* item(std::size_t pos)
+    {
+        return reinterpret_cast<T*>(&cells_[pos & mask_].storage);
+    }
+
+    /// the ring of slots
+    std::unique_ptr<cell[]> cells_;
+    /// the ring index mask (capacity - 1)
+    std::size_t mask_;
+    /// padding to keep the producer and consumer cursors off the same
+    /// cache line
+    char pad0_[64];
+    /// the producer cursor
+    std::atomic<std::size_t> enqueue_pos_;
+    char pad1_[64];
+    /// the consumer cursor
+    std::atomic<std::size_t> dequeue_pos_;
+    char pad2_[64];
+    /// whether the queue has been closed for pipeline shutdown
+    std::atomic<bool> closed_;
+};
+}
+}
+#endif
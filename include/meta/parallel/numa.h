@@ -0,0 +1,235 @@
+/**
+ * @file numa.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_PARALLEL_NUMA_H_
+#define META_PARALLEL_NUMA_H_
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/parallel/parallel_for.h"
+#include "meta/parallel/thread_pool.h"
+
+namespace meta
+{
+namespace parallel
+{
+
+/**
+ * The NUMA layout of the machine: which logical cpus belong to which
+ * memory node. On Linux this is read from sysfs; elsewhere (or when
+ * sysfs is unavailable) every cpu is reported on a single node, so code
+ * written against the topology degrades gracefully on uniform-memory
+ * machines.
+ */
+class numa_topology
+{
+  public:
+    numa_topology()
+    {
+#ifdef __linux__
+        for (std::size_t node = 0;; ++node)
+        {
+            std::ifstream cpulist{"/sys/devices/system/node/node"
+                                  + std::to_string(node) + "/cpulist"};
+            if (!cpulist)
+                break;
+            std::string list;
+            std::getline(cpulist, list);
+            auto cpus = parse_cpulist(list);
+            if (!cpus.empty())
+                node_cpus_.push_back(std::move(cpus));
+        }
+#endif
+        if (node_cpus_.empty())
+        {
+            std::vector<unsigned> cpus(
+                std::max(1u, std::thread::hardware_concurrency()));
+            for (unsigned i = 0; i < cpus.size(); ++i)
+                cpus[i] = i;
+            node_cpus_.push_back(std::move(cpus));
+        }
+    }
+
+    /**
+     * @return the number of memory nodes on this machine
+     */
+    std::size_t num_nodes() const
+    {
+        return node_cpus_.size();
+    }
+
+    /**
+     * @param node The node to look up
+     * @return the logical cpu ids belonging to that node
+     */
+    const std::vector<unsigned>& cpus(std::size_t node) const
+    {
+        return node_cpus_.at(node);
+    }
+
+    /**
+     * @return one cpu_binding per logical cpu, grouped by node, suitable
+     * for constructing a pinned thread_pool covering the whole machine
+     */
+    std::vector<cpu_binding> bindings() const
+    {
+        std::vector<cpu_binding> binds;
+        for (std::size_t node = 0; node < node_cpus_.size(); ++node)
+        {
+            for (auto cpu : node_cpus_[node])
+                binds.push_back({cpu, node});
+        }
+        return binds;
+    }
+
+  private:
+    /**
+     * Parses sysfs cpulist syntax ("0-3,8-11") into cpu ids.
+     * @param list The cpulist string
+     * @return the cpu ids it denotes
+     */
+    static std::vector<unsigned> parse_cpulist(const std::string& list)
+    {
+        std::vector<unsigned> cpus;
+        std::size_t pos = 0;
+        while (pos < list.size())
+        {
+            auto comma = list.find(',', pos);
+            auto token = list.substr(pos, comma - pos);
+            auto dash = token.find('-');
+            if (dash == std::string::npos)
+            {
+                if (!token.empty() && std::isdigit(token[0]))
+                    cpus.push_back(
+                        static_cast<unsigned>(std::stoul(token)));
+            }
+            else
+            {
+                auto first = std::stoul(token.substr(0, dash));
+                auto last = std::stoul(token.substr(dash + 1));
+                for (auto cpu = first; cpu <= last; ++cpu)
+                    cpus.push_back(static_cast<unsigned>(cpu));
+            }
+            if (comma == std::string::npos)
+                break;
+            pos = comma + 1;
+        }
+        return cpus;
+    }
+
+    /// the cpu ids of each node
+    std::vector<std::vector<unsigned>> node_cpus_;
+};
+
+/**
+ * Splits [begin, end) into one contiguous subrange per memory node,
+ * sized proportionally to the number of the pool's workers on each
+ * node. Pairs for nodes with no workers are empty ranges.
+ *
+ * @param begin The beginning of the range
+ * @param end The ending of the range
+ * @param pool The (NUMA-pinned) pool the work will run on
+ * @return a subrange per node, in node order
+ */
+template <class Iterator>
+std::vector<std::pair<Iterator, Iterator>>
+numa_partition(Iterator begin, Iterator end, const thread_pool& pool)
+{
+    using difference_type =
+        typename std::iterator_traits<Iterator>::difference_type;
+
+    std::vector<std::pair<Iterator, Iterator>> parts;
+    auto total = std::distance(begin, end);
+    difference_type assigned = 0;
+    for (std::size_t node = 0; node < pool.num_nodes(); ++node)
+    {
+        auto share = static_cast<difference_type>(
+            static_cast<double>(pool.workers_on_node(node).size())
+            / pool.size() * total);
+        if (node + 1 == pool.num_nodes())
+            share = total - assigned;
+        auto first = begin;
+        std::advance(begin, share);
+        parts.emplace_back(first, begin);
+        assigned += share;
+    }
+    return parts;
+}
+
+/**
+ * Runs the given function over the range in parallel with owner-computes
+ * placement: the range is partitioned across memory nodes and each
+ * node's share is submitted with affinity to that node's workers. With a
+ * pool that is not NUMA-pinned (one node) this is plain parallel_for.
+ *
+ * Placement is best-effort: a fully idle worker will still steal across
+ * nodes rather than sit idle.
+ *
+ * @param begin The first element to operate on
+ * @param end One past the last element to operate on
+ * @param pool The pool to use, ideally thread_pool{topology.bindings()}
+ * @param func The function to perform on each element
+ */
+template <class Iterator, class Function>
+void numa_parallel_for(Iterator begin, Iterator end, thread_pool& pool,
+                       Function func)
+{
+    if (pool.num_nodes() <= 1)
+        return parallel_for(begin, end, pool, func);
+
+    std::vector<std::future<void>> futures;
+    auto parts = numa_partition(begin, end, pool);
+    for (std::size_t node = 0; node < parts.size(); ++node)
+    {
+        const auto& workers = pool.workers_on_node(node);
+        if (workers.empty())
+            continue;
+
+        // a few blocks per worker, as in parallel_for, so stealing
+        // within the node rebalances skewed costs; every block's
+        // affinity names one of this node's workers
+        using difference_type =
+            typename std::iterator_traits<Iterator>::difference_type;
+        auto node_begin = parts[node].first;
+        auto node_end = parts[node].second;
+        auto num_blocks = workers.size() * 4;
+        auto block_size = std::max<difference_type>(
+            1, std::distance(node_begin, node_end)
+                   / static_cast<difference_type>(num_blocks));
+
+        std::size_t block = 0;
+        while (node_begin != node_end)
+        {
+            auto remaining = std::distance(node_begin, node_end);
+            auto step = std::min(block_size, remaining);
+            auto first = node_begin;
+            std::advance(node_begin, step);
+            auto last = node_begin;
+            futures.emplace_back(pool.submit_task(
+                [first, last, &func]() { std::for_each(first, last, func); },
+                workers[block++ % workers.size()]));
+        }
+    }
+    for (auto& fut : futures)
+    {
+        pool.wait(fut);
+        fut.get();
+    }
+}
+}
+}
+#endif
@@ -24,29 +24,35 @@ namespace parallel
 {
 
 /**
- * Runs the given function on sub-ranges of [begin, end) in parallel.
+ * Runs the given function on sub-ranges of [begin, end) in parallel,
+ * splitting the range into the requested number of blocks. Each block is
+ * submitted with its index as an affinity hint so blocks spread evenly
+ * across the pool's workers before any stealing occurs.
+ *
  * @param begin The beginning of the range
  * @param end The ending of the range
  * @param pool The thread_pool to run on
+ * @param num_blocks The number of sub-ranges to create
  * @param fn The binary function that operates over iterator ranges
  */
 template <class Iterator, class Function>
 std::vector<std::future<
     typename std::result_of<Function(Iterator, Iterator)>::type>>
-for_each_block(Iterator begin, Iterator end, thread_pool& pool, Function&& fn)
+for_each_block(Iterator begin, Iterator end, thread_pool& pool,
+               std::size_t num_blocks, Function&& fn)
 {
     using difference_type =
         typename std::iterator_traits<Iterator>::difference_type;
     using result_type =
         typename std::result_of<Function(Iterator, Iterator)>::type;
 
-    auto pool_size = static_cast<difference_type>(pool.size());
-    auto block_size = std::distance(begin, end) / pool_size;
+    auto blocks = static_cast<difference_type>(num_blocks);
+    auto block_size = std::distance(begin, end) / blocks;
 
     Iterator last = begin;
     if (block_size > 0)
     {
-        std::advance(last, (pool_size - 1) * block_size);
+        std::advance(last, (blocks - 1) * block_size);
     }
     else
     {
@@ -55,21 +61,42 @@ for_each_block(Iterator begin, Iterator end, thread_pool& pool, Function&& fn)
     }
 
     std::vector<std::future<result_type>> futures;
-    // first p - 1 groups
+    std::size_t block = 0;
+    // first num_blocks - 1 groups
     for (; begin != last; std::advance(begin, block_size))
     {
-        futures.emplace_back(pool.submit_task([=]() {
-            auto mylast = begin;
-            std::advance(mylast, block_size);
-            return fn(begin, mylast);
-        }));
+        futures.emplace_back(pool.submit_task(
+            [=]() {
+                auto mylast = begin;
+                std::advance(mylast, block_size);
+                return fn(begin, mylast);
+            },
+            block++));
     }
     // last group
-    futures.emplace_back(pool.submit_task([=]() { return fn(begin, end); }));
+    futures.emplace_back(
+        pool.submit_task([=]() { return fn(begin, end); }, block));
 
     return futures;
 }
 
+/**
+ * Runs the given function on sub-ranges of [begin, end) in parallel, one
+ * block per worker thread.
+ * @param begin The beginning of the range
+ * @param end The ending of the range
+ * @param pool The thread_pool to run on
+ * @param fn The binary function that operates over iterator ranges
+ */
+template <class Iterator, class Function>
+std::vector<std::future<
+    typename std::result_of<Function(Iterator, Iterator)>::type>>
+for_each_block(Iterator begin, Iterator end, thread_pool& pool, Function&& fn)
+{
+    return for_each_block(begin, end, pool, pool.size(),
+                          std::forward<Function>(fn));
+}
+
 /**
  * Runs the given function on the range denoted by begin and end in parallel.
  * @param begin The first element to operate on
@@ -94,12 +121,20 @@ template <class Iterator, class Function>
 void parallel_for(Iterator begin, Iterator end, thread_pool& pool,
                   Function func)
 {
-    auto futures
-        = for_each_block(begin, end, pool, [&](Iterator tbegin, Iterator tend) {
-              std::for_each(tbegin, tend, func);
-          });
+    // several blocks per worker: if per-element costs are skewed, idle
+    // workers steal the leftover blocks instead of waiting on the
+    // slowest thread
+    auto futures = for_each_block(begin, end, pool, pool.size() * 4,
+                                  [&](Iterator tbegin, Iterator tend) {
+                                      std::for_each(tbegin, tend, func);
+                                  });
+    // join through the pool so nesting is safe: a parallel_for run from
+    // inside a worker task helps run its own blocks instead of sleeping
     for (auto& fut : futures)
+    {
+        pool.wait(fut);
         fut.get();
+    }
 }
 }
 }
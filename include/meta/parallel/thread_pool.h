@@ -13,6 +13,9 @@
 #ifndef META_THREAD_POOL_H_
 #define META_THREAD_POOL_H_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <future>
@@ -22,15 +25,41 @@
 #include <vector>
 
 #include "meta/config.h"
+#include "meta/parallel/work_stealing_queue.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace meta
 {
 namespace parallel
 {
 
+/**
+ * Describes one pinned worker: the logical cpu it runs on and the memory
+ * node that cpu belongs to. See parallel/numa.h for obtaining these from
+ * the machine's topology.
+ */
+struct cpu_binding
+{
+    /// the logical cpu id to pin to
+    unsigned cpu;
+    /// the memory node that cpu belongs to
+    std::size_t node;
+};
+
 /**
  * Represents a collection of a fixed number of threads, which tasks can be
  * added to.
+ *
+ * Scheduling is work-stealing: each worker owns a lock-free Chase-Lev
+ * deque and runs its own tasks in LIFO order, stealing the oldest task
+ * from a sibling only when its deque is empty. Tasks submitted from
+ * outside the pool land in small per-worker inboxes (round-robin by
+ * default, or directed via an affinity hint), so unrelated submitters
+ * never contend on a single shared queue.
  */
 class thread_pool
 {
@@ -40,15 +69,53 @@ class thread_pool
      * with; by default, the hardware concurrency.
      */
     thread_pool(size_t num_threads = std::thread::hardware_concurrency())
-        : running_(true)
+        : queues_(num_threads),
+          inboxes_(num_threads),
+          node_of_(num_threads, 0),
+          num_nodes_{1},
+          pending_{0},
+          next_inbox_{0},
+          running_(true)
     {
         for (size_t i = 0; i < num_threads; ++i)
             threads_.push_back(
-                std::thread{std::bind(&thread_pool::worker, this)});
+                std::thread{std::bind(&thread_pool::worker, this, i)});
+    }
+
+    /**
+     * Constructs a pool with one worker per binding, each pinned to its
+     * cpu (where the platform supports pinning) and tagged with its
+     * memory node for NUMA-aware scheduling; see parallel/numa.h.
+     *
+     * @param bindings The cpu/node assignment for each worker
+     */
+    thread_pool(const std::vector<cpu_binding>& bindings)
+        : queues_(bindings.size()),
+          inboxes_(bindings.size()),
+          num_nodes_{1},
+          pending_{0},
+          next_inbox_{0},
+          running_(true)
+    {
+        node_of_.reserve(bindings.size());
+        for (const auto& binding : bindings)
+        {
+            node_of_.push_back(binding.node);
+            num_nodes_ = std::max(num_nodes_, binding.node + 1);
+        }
+
+        for (size_t i = 0; i < bindings.size(); ++i)
+        {
+            auto cpu = bindings[i].cpu;
+            threads_.push_back(std::thread{[this, i, cpu]() {
+                pin_to_cpu(cpu);
+                worker(i);
+            }});
+        }
     }
 
     /**
-     * Destructor; joins all threads.
+     * Destructor; finishes all queued tasks and joins all threads.
      */
     ~thread_pool()
     {
@@ -62,7 +129,17 @@ class thread_pool
     }
 
     /**
-     * Adds a task to the thread_pool.
+     * Adds a task to the thread_pool. When called from one of the pool's
+     * own workers, the task goes onto that worker's deque (keeping
+     * parent and child tasks cache-hot); otherwise it is handed to the
+     * workers round-robin.
+     *
+     * A worker task that needs the results of tasks it submitted to its
+     * own pool must join them with wait(), not by blocking in
+     * std::future::get(): a sleeping worker runs nothing, so once every
+     * worker blocks on children that are still sitting in the pool's
+     * queues, no thread is left to run them and the pool deadlocks.
+     *
      * @param func The function (task) to add
      * @return a std::future that wraps the return value of the task for
      * retrieval later
@@ -70,6 +147,26 @@ class thread_pool
     template <class Function>
     std::future<typename std::result_of<Function()>::type>
     submit_task(Function func)
+    {
+        return submit_task(std::move(func),
+                           next_inbox_.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    /**
+     * Adds a task to the thread_pool with an affinity hint: the task is
+     * placed with worker `affinity % size()` unless the calling thread
+     * is already a worker of this pool, whose own deque always wins. The
+     * hint influences only initial placement; an idle worker may still
+     * steal the task.
+     *
+     * @param func The function (task) to add
+     * @param affinity The index of the preferred worker
+     * @return a std::future that wraps the return value of the task for
+     * retrieval later
+     */
+    template <class Function>
+    std::future<typename std::result_of<Function()>::type>
+    submit_task(Function func, std::size_t affinity)
     {
         using result_type = typename std::result_of<Function()>::type;
 
@@ -77,14 +174,64 @@ class thread_pool
             new concrete_task<result_type>(func));
 
         auto future = task->get_future();
+
+        auto& id = local_id();
+        if (id.pool == this)
+        {
+            queues_[id.index].push(task.release());
+        }
+        else
+        {
+            auto& inbox = inboxes_[affinity % inboxes_.size()];
+            std::unique_lock<std::mutex> lock(inbox.mutex);
+            inbox.tasks.push(std::move(task));
+        }
+
         {
             std::unique_lock<std::mutex> lock(mutex_);
-            tasks_.push(std::move(task));
+            pending_.fetch_add(1, std::memory_order_relaxed);
         }
         cond_.notify_one();
         return future;
     }
 
+    /**
+     * Blocks until the given future is ready. When the calling thread is
+     * one of this pool's own workers, queued pool tasks are run on this
+     * thread while it waits, so a task may safely fan out into the same
+     * pool and join its children here; see submit_task() for why a plain
+     * std::future::get() from a worker can deadlock instead. From any
+     * other thread this is equivalent to future.wait().
+     *
+     * @param future The future to wait on
+     */
+    template <class R>
+    void wait(const std::future<R>& future)
+    {
+        auto& id = local_id();
+        if (id.pool != this)
+        {
+            future.wait();
+            return;
+        }
+
+        while (future.wait_for(std::chrono::seconds(0))
+               != std::future_status::ready)
+        {
+            if (auto tsk = find_task(id.index))
+            {
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                tsk->run();
+            }
+            else
+            {
+                // nothing runnable anywhere: the future's task is in
+                // flight on another worker, so just stay off the cpu
+                std::this_thread::yield();
+            }
+        }
+    }
+
     /**
      * @return a vector of the thread_ids from the current pool
      */
@@ -101,8 +248,7 @@ class thread_pool
      */
     size_t tasks() const
     {
-        std::unique_lock<std::mutex> lock(mutex_);
-        return tasks_.size();
+        return pending_.load(std::memory_order_relaxed);
     }
 
     /**
@@ -113,6 +259,40 @@ class thread_pool
         return threads_.size();
     }
 
+    /**
+     * @return the number of distinct memory nodes the workers span (1
+     * unless the pool was constructed from cpu_bindings)
+     */
+    size_t num_nodes() const
+    {
+        return num_nodes_;
+    }
+
+    /**
+     * @param worker The worker index
+     * @return the memory node that worker is pinned to
+     */
+    size_t node_of(size_t worker) const
+    {
+        return node_of_.at(worker);
+    }
+
+    /**
+     * @param node The memory node
+     * @return the indices of the workers pinned to that node, usable as
+     * affinity hints for submit_task()
+     */
+    std::vector<size_t> workers_on_node(size_t node) const
+    {
+        std::vector<size_t> workers;
+        for (size_t i = 0; i < node_of_.size(); ++i)
+        {
+            if (node_of_[i] == node)
+                workers.push_back(i);
+        }
+        return workers;
+    }
+
   private:
     /**
      * A generic task object.
@@ -169,36 +349,155 @@ class thread_pool
     };
 
     /**
-     * Function invoked by the worker threads to process tasks off the
-     * internal queue.
+     * A mutex-protected queue for tasks submitted from outside the pool.
+     * Contention here is minimal since each worker has its own and
+     * external submissions are spread across them.
+     */
+    struct inbox
+    {
+        /// guards tasks
+        std::mutex mutex;
+        /// the externally submitted tasks destined for this worker
+        std::queue<std::unique_ptr<task>> tasks;
+    };
+
+    /**
+     * Identifies which pool (if any) the current thread is a worker of,
+     * so submissions from within a task can bypass the inboxes.
+     */
+    struct worker_id
+    {
+        /// the pool this thread belongs to, or nullptr
+        thread_pool* pool;
+        /// this thread's index within the pool
+        std::size_t index;
+    };
+
+    /**
+     * Pins the calling thread to one logical cpu. A no-op on platforms
+     * without affinity support.
+     * @param cpu The logical cpu id
      */
-    void worker()
+    static void pin_to_cpu(unsigned cpu)
     {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpu;
+#endif
+    }
+
+    /**
+     * @return the calling thread's worker identity
+     */
+    static worker_id& local_id()
+    {
+        static thread_local worker_id id{nullptr, 0};
+        return id;
+    }
+
+    /**
+     * Finds the next task for a worker: its own deque first (LIFO), then
+     * its inbox, then steals from siblings' deques and inboxes (FIFO).
+     *
+     * @param index The calling worker's index
+     * @return the task to run, or nullptr if none was found
+     */
+    std::unique_ptr<task> find_task(std::size_t index)
+    {
+        task* stolen;
+        if (queues_[index].pop(stolen))
+            return std::unique_ptr<task>{stolen};
+
+        if (auto tsk = check_inbox(index))
+            return tsk;
+
+        for (std::size_t i = 1; i < queues_.size(); ++i)
+        {
+            if (queues_[(index + i) % queues_.size()].steal(stolen))
+                return std::unique_ptr<task>{stolen};
+        }
+
+        // affinity is only a hint: drain someone else's inbox rather
+        // than idle while they are stuck in a long task
+        for (std::size_t i = 1; i < inboxes_.size(); ++i)
+        {
+            if (auto tsk = check_inbox((index + i) % inboxes_.size()))
+                return tsk;
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @param index The inbox to check
+     * @return the oldest task in that inbox, or nullptr if it was empty
+     */
+    std::unique_ptr<task> check_inbox(std::size_t index)
+    {
+        auto& inbox = inboxes_[index];
+        std::unique_lock<std::mutex> lock(inbox.mutex);
+        if (inbox.tasks.empty())
+            return nullptr;
+        auto tsk = std::move(inbox.tasks.front());
+        inbox.tasks.pop();
+        return tsk;
+    }
+
+    /**
+     * Function invoked by the worker threads to process tasks.
+     *
+     * @param index This worker's index within the pool
+     */
+    void worker(std::size_t index)
+    {
+        auto& id = local_id();
+        id.pool = this;
+        id.index = index;
+
         while (true)
         {
-            std::unique_ptr<task> task;
+            if (auto tsk = find_task(index))
             {
-                std::unique_lock<std::mutex> lock(mutex_);
-                while (running_ && tasks_.empty())
-                    cond_.wait(lock);
-                if (!running_ && tasks_.empty())
-                    return;
-                task = std::move(tasks_.front());
-                tasks_.pop();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                tsk->run();
+                continue;
             }
-            task->run();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!running_ && pending_.load(std::memory_order_relaxed) == 0)
+                return;
+            cond_.wait(lock, [&]() {
+                return !running_
+                       || pending_.load(std::memory_order_relaxed) > 0;
+            });
         }
     }
 
     /// the threads in the pool
     std::vector<std::thread> threads_;
-    /// the queue containing the tasks to be run
-    std::queue<std::unique_ptr<task>> tasks_;
+    /// the per-worker work-stealing deques
+    std::vector<work_stealing_queue<task*>> queues_;
+    /// the per-worker inboxes for external submissions
+    std::vector<inbox> inboxes_;
+
+    /// the memory node of each worker (all 0 when not NUMA-pinned)
+    std::vector<size_t> node_of_;
+    /// the number of distinct memory nodes the workers span
+    size_t num_nodes_;
+
+    /// the total number of queued-but-not-started tasks across the pool
+    std::atomic<size_t> pending_;
+    /// round-robin counter for external submissions without a hint
+    std::atomic<size_t> next_inbox_;
 
     /// whether or not the pool is currently running
     bool running_;
 
-    /// the mutex to wrap queue operations
+    /// the mutex guarding running_ and the sleep/wake protocol
     mutable std::mutex mutex_;
     /// the condition variable that workers sleep on when waiting for work
     std::condition_variable cond_;
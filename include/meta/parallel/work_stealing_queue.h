@@ -0,0 +1,208 @@
+/**
+ * @file work_stealing_queue.h
+ * @author Chase Geigle
+ * @see "Dynamic Circular Work-Stealing Deque" by Chase and Lev
+ * @see "Correct and Efficient Work-Stealing for Weak Memory Models" by Le
+ * et al. for the fence placement used here
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_PARALLEL_WORK_STEALING_QUEUE_H_
+#define META_PARALLEL_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace parallel
+{
+
+/**
+ * A lock-free, single-owner work-stealing deque (Chase-Lev). The owning
+ * thread pushes and pops from the bottom in LIFO order without
+ * synchronization in the common case; any other thread may steal from the
+ * top. The element type must be trivially copyable (in practice, a
+ * pointer), since stolen slots may be read concurrently with the owner
+ * overwriting them.
+ */
+template <class T>
+class work_stealing_queue
+{
+  public:
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "work_stealing_queue elements must be trivially copyable");
+
+    /**
+     * @param initial_capacity The starting ring buffer size; must be a
+     * power of two
+     */
+    work_stealing_queue(std::size_t initial_capacity = 64)
+        : top_{0}, bottom_{0}
+    {
+        buffers_.emplace_back(new ring_buffer{initial_capacity});
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    work_stealing_queue(const work_stealing_queue&) = delete;
+    work_stealing_queue& operator=(const work_stealing_queue&) = delete;
+
+    /**
+     * Pushes an element onto the bottom of the deque. May only be called
+     * by the owning thread.
+     * @param value The element to push
+     */
+    void push(T value)
+    {
+        auto b = bottom_.load(std::memory_order_relaxed);
+        auto t = top_.load(std::memory_order_acquire);
+        auto* buf = buffer_.load(std::memory_order_relaxed);
+
+        if (b - t > static_cast<std::int64_t>(buf->capacity) - 1)
+            buf = grow(t, b);
+
+        buf->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Pops the most recently pushed element. May only be called by the
+     * owning thread.
+     *
+     * @param value Set to the popped element on success
+     * @return whether an element was popped
+     */
+    bool pop(T& value)
+    {
+        auto b = bottom_.load(std::memory_order_relaxed) - 1;
+        auto* buf = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top_.load(std::memory_order_relaxed);
+
+        bool popped = false;
+        if (t <= b)
+        {
+            value = buf->get(b);
+            popped = true;
+            if (t == b)
+            {
+                // last element: race against stealers for it
+                if (!top_.compare_exchange_strong(t, t + 1,
+                                                  std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+                    popped = false;
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return popped;
+    }
+
+    /**
+     * Steals the oldest element. May be called from any thread. A false
+     * return means the deque appeared empty or the steal lost a race;
+     * callers treat both as "try elsewhere".
+     *
+     * @param value Set to the stolen element on success
+     * @return whether an element was stolen
+     */
+    bool steal(T& value)
+    {
+        auto t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = bottom_.load(std::memory_order_acquire);
+
+        if (t < b)
+        {
+            auto* buf = buffer_.load(std::memory_order_acquire);
+            value = buf->get(t);
+            if (top_.compare_exchange_strong(t, t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @return an estimate of the number of queued elements; only exact
+     * when no other thread is concurrently stealing
+     */
+    std::size_t size() const
+    {
+        auto b = bottom_.load(std::memory_order_relaxed);
+        auto t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+  private:
+    /**
+     * A fixed-capacity circular buffer of atomic slots. Indices wrap via
+     * a power-of-two mask.
+     */
+    struct ring_buffer
+    {
+        ring_buffer(std::size_t cap)
+            : capacity{cap}, mask{cap - 1}, data{new std::atomic<T>[cap]}
+        {
+            // nothing
+        }
+
+        void put(std::int64_t i, T value)
+        {
+            data[static_cast<std::size_t>(i) & mask].store(
+                value, std::memory_order_relaxed);
+        }
+
+        T get(std::int64_t i) const
+        {
+            return data[static_cast<std::size_t>(i) & mask].load(
+                std::memory_order_relaxed);
+        }
+
+        const std::size_t capacity;
+        const std::size_t mask;
+        std::unique_ptr<std::atomic<T>[]> data;
+    };
+
+    /**
+     * Doubles the ring buffer, copying the live range. Retired buffers
+     * are kept until destruction since a concurrent steal may still be
+     * reading through an old pointer.
+     */
+    ring_buffer* grow(std::int64_t t, std::int64_t b)
+    {
+        auto* old = buffer_.load(std::memory_order_relaxed);
+        buffers_.emplace_back(new ring_buffer{old->capacity * 2});
+        auto* buf = buffers_.back().get();
+        for (auto i = t; i < b; ++i)
+            buf->put(i, old->get(i));
+        buffer_.store(buf, std::memory_order_release);
+        return buf;
+    }
+
+    /// index of the oldest element (stolen end)
+    std::atomic<std::int64_t> top_;
+    /// index one past the newest element (owner's end)
+    std::atomic<std::int64_t> bottom_;
+    /// the current ring buffer
+    std::atomic<ring_buffer*> buffer_;
+    /// every buffer ever allocated, retained for concurrent readers
+    std::vector<std::unique_ptr<ring_buffer>> buffers_;
+};
+}
+}
+#endif
@@ -122,6 +122,19 @@ class sr_parser
      */
     parse_tree parse(const sequence::sequence& sentence) const;
 
+    /**
+     * Parses a batch of POS-tagged sentences in parallel across a thread
+     * pool. The model is read-only during parsing, so the sentences are
+     * simply partitioned among the pool's threads.
+     *
+     * @param sentences The sentences to be parsed
+     * @param pool The thread pool to parse the sentences with
+     * @return the parse trees for the sentences, in the same order
+     */
+    std::vector<parse_tree>
+    parse_batch(const std::vector<sequence::sequence>& sentences,
+                parallel::thread_pool& pool) const;
+
     /**
      * Trains a model on the given parse trees using the supplied training
      * options.
@@ -142,9 +155,11 @@ class sr_parser
     using feature_vector = std::unordered_map<std::string, float>;
 
     /**
-     * A single weight vector for a specific transition.
+     * A single weight vector for a specific transition. This matches the
+     * row type of the underlying linear_model, whose short rows are
+     * stored with inline small-buffer storage.
      */
-    using weight_vector = util::sparse_vector<trans_id, float>;
+    using weight_vector = util::small_sparse_vector<trans_id, float>;
 
     /**
      * A collection of weight vectors by feature type.
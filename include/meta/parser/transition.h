@@ -10,6 +10,7 @@
 #define META_PARSER_TRANSITION_H_
 
 #include "meta/config.h"
+#include "meta/hashing/hash.h"
 #include "meta/meta.h"
 #include "meta/util/comparable.h"
 #include "meta/util/optional.h"
@@ -96,6 +97,32 @@ class transition : public util::comparable<transition>
     util::optional<class_label> label_;
 };
 
+/**
+ * Computes the hash of a transition using the given hash algorithm. The
+ * label only contributes to the hash for the transition types that carry
+ * one.
+ *
+ * @param h The hash algorithm state
+ * @param trans The transition to hash
+ */
+template <class HashAlgorithm>
+void hash_append(HashAlgorithm& h, const transition& trans)
+{
+    using hashing::hash_append;
+    hash_append(h, trans.type());
+    switch (trans.type())
+    {
+        case transition::type_t::REDUCE_L:
+        case transition::type_t::REDUCE_R:
+        case transition::type_t::UNARY:
+            hash_append(h, trans.label());
+            break;
+
+        default:
+            break;
+    }
+}
+
 /**
  * Prints a transition to the stream.
  * @param os The stream to print to
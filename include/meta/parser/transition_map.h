@@ -10,8 +10,8 @@
 #define META_PARSER_TRANSITION_MAP_H_
 
 #include "meta/config.h"
+#include "meta/hashing/probe_map.h"
 #include "meta/parser/transition.h"
-#include "meta/util/sparse_vector.h"
 
 namespace meta
 {
@@ -74,12 +74,15 @@ class transition_map
     void load(std::istream& store);
 
     /**
-     * The map from transition to id.
+     * The map from transition to id, stored in a flat open-addressing
+     * table so lookups never chase pointers or compare against more
+     * than a handful of keys.
      */
-    util::sparse_vector<transition, trans_id> map_;
+    hashing::probe_map<transition, trans_id> map_;
 
     /**
-     * The "map" from id to transition.
+     * The dense array from id to transition; ids are assigned
+     * contiguously, so the decode path is a single unchecked index.
      */
     std::vector<transition> transitions_;
 };
@@ -121,6 +121,25 @@ class node
      */
     virtual ~node() = default;
 
+    /**
+     * Allocates a node from a thread-local pool. Tree transforms and
+     * parser state updates churn through huge numbers of small node
+     * allocations, so nodes are carved out of larger slabs and recycled
+     * through free lists instead of hitting the general-purpose
+     * allocator for every node.
+     *
+     * @param size The number of bytes to allocate
+     */
+    static void* operator new(std::size_t size);
+
+    /**
+     * Returns a node's storage to the thread-local pool.
+     *
+     * @param ptr The storage to return
+     * @param size The size of the storage
+     */
+    static void operator delete(void* ptr, std::size_t size);
+
   private:
     /**
      * The category for this node
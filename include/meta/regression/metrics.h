@@ -114,6 +114,15 @@ class metrics_accumulator
      */
     double r2_score() const;
 
+    /**
+     * Absorbs another accumulator's response pairs, for combining
+     * accumulators filled by separate threads over disjoint parts of a
+     * prediction set.
+     *
+     * @param other The accumulator to absorb
+     */
+    void merge(const metrics_accumulator& other);
+
     /**
      * Obtains a metrics object from this metrics_accumulator.
      */
@@ -10,6 +10,7 @@
 #ifndef META_REGRESSION_REGRESSOR_H_
 #define META_REGRESSION_REGRESSOR_H_
 
+#include "meta/parallel/thread_pool.h"
 #include "meta/regression/metrics.h"
 #include "meta/regression/regression_dataset_view.h"
 
@@ -53,6 +54,19 @@ class regressor
      */
     virtual metrics test(dataset_view_type docs) const;
 
+    /**
+     * Predicts responses for a collection of documents with the
+     * predictions sharded across a thread pool; each thread fills its
+     * own metrics accumulator and the accumulators are merged at the
+     * end, so the result is identical (up to floating point summation
+     * order) to the sequential overload.
+     *
+     * @param docs The documents to predict
+     * @param pool The thread pool to shard the predictions across
+     * @return the regression metrics for that subset of the data
+     */
+    metrics test(dataset_view_type docs, parallel::thread_pool& pool) const;
+
     /**
      * Saves the model to the output stream.
      * @param out The stream to write the model to
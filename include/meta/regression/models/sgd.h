@@ -11,6 +11,7 @@
 #define META_REGRESSION_SGD_H_
 
 #include "meta/learn/sgd.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/regression/models/regressor.h"
 #include "meta/regression/regressor_factory.h"
 
@@ -75,6 +76,34 @@ class sgd : public regressor
      */
     void train(dataset_view_type docs);
 
+    /**
+     * Trains the model over the dataset using Hogwild-style lock-free
+     * parallel stochastic gradient descent: the pool's threads each
+     * process a shard of the (shuffled) data per epoch, updating the
+     * shared weight vector concurrently without synchronization. For
+     * sparse data, concurrent updates rarely touch the same weights and
+     * the occasional lost update does not affect convergence; dense
+     * data should prefer the sequential train() overload. Convergence
+     * is checked once per epoch against the average epoch loss.
+     *
+     * @see https://arxiv.org/abs/1106.5730
+     *
+     * @param docs The training documents
+     * @param pool The thread pool to shard each epoch across
+     */
+    void train(dataset_view_type docs, parallel::thread_pool& pool);
+
+    /**
+     * Trains the model on the dataset in mini-batches via
+     * sgd_model::train_batch(), so the regularization bookkeeping is
+     * paid once per batch and the batched gradient accumulation runs
+     * over a dense buffer. Convergence is checked once per epoch.
+     *
+     * @param docs The training documents
+     * @param batch_size The number of instances per mini-batch
+     */
+    void train_minibatch(dataset_view_type docs, std::size_t batch_size);
+
     /**
      * Trains the model on a single instance.
      * @param doc The document to learn from
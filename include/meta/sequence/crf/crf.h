@@ -10,6 +10,10 @@
 #ifndef META_SEQUENCE_CRF_H_
 #define META_SEQUENCE_CRF_H_
 
+#include <thread>
+#include <unordered_map>
+
+#include "meta/parallel/thread_pool.h"
 #include "meta/sequence/observation.h"
 #include "meta/sequence/sequence.h"
 #include "meta/sequence/sequence_analyzer.h"
@@ -108,6 +112,16 @@ class crf
          * calibration.
          */
         uint64_t calibration_trials = 10;
+
+        /**
+         * The number of sequences to process per gradient update. The
+         * forward-backward passes are independent per sequence, so the
+         * sequences of a batch are scored concurrently and their merged
+         * sparse gradients are applied once per batch (with the scale
+         * decay for the l2 regularizer also applied once per batch). A
+         * batch size of 1 gives plain sequence-at-a-time SGD.
+         */
+        uint64_t batch_size = 1;
     };
 
     /**
@@ -282,6 +296,44 @@ class crf
     double iteration(parameters params, uint64_t iter, const sequence& seq,
                      scorer& scorer);
 
+    /**
+     * Performs a single minibatch update within a training epoch. The
+     * sequences of the batch are scored concurrently on the thread pool
+     * against the current weights, accumulating per-thread sparse
+     * gradients that are then merged and applied once.
+     *
+     * @param params The learning parameters
+     * @param iter The current number of total iterations (\f$t\f$)
+     * @param indices The shuffled indices into the training examples
+     * @param start The index of the first sequence of the batch
+     * @param end One past the index of the last sequence of the batch
+     * @param examples The training examples
+     * @param scorers The thread-local scorers to re-use
+     * @param pool The thread pool to score the batch on
+     * @return the loss summed over the sequences in the batch
+     */
+    double batch_iteration(
+        parameters params, uint64_t iter, const std::vector<uint64_t>& indices,
+        uint64_t start, uint64_t end, const std::vector<sequence>& examples,
+        std::unordered_map<std::thread::id, scorer>& scorers,
+        parallel::thread_pool& pool);
+
+    /**
+     * Computes the gradient contribution of a single sequence into the
+     * given buffers instead of applying it to the weights directly, so
+     * that a batch of gradients can be merged and applied at once.
+     *
+     * @param seq The sequence to use
+     * @param gain The amount to scale the gradient by
+     * @param scr The scorer holding the sequence's marginals
+     * @param obs_grad Buffer for the observation weight gradient
+     * @param trans_grad Buffer for the transition weight gradient (one
+     * entry per transition feature)
+     */
+    void gradient(const sequence& seq, double gain, const scorer& scr,
+                  std::unordered_map<crf_feature_id, double>& obs_grad,
+                  std::vector<double>& trans_grad) const;
+
     /**
      * Updates the model parameters based on the observation expectation
      * part of the gradient.
@@ -363,10 +415,13 @@ class crf
 
     /// the current decay factor applied to all of the weights
     double scale_;
+    /// incremented whenever every weight changes at once (reset() or
+    /// rescale()), signaling scorers to discard their weight caches
+    uint64_t weight_version_ = 0;
     /// the number of allowed labels
     uint64_t num_labels_;
     /// the prefix (folder) where model files are to be stored
-    const std::string& prefix_;
+    const std::string prefix_;
 };
 }
 }
@@ -11,6 +11,7 @@
 #define META_SEQUENCE_CRF_SCORER_H_
 
 #include "meta/sequence/crf/crf.h"
+#include "meta/util/arena.h"
 
 namespace meta
 {
@@ -48,6 +49,26 @@ class crf::scorer
      */
     void state_scores(const crf& model, const sequence& seq);
 
+    /**
+     * Refreshes the cached observation feature scores for the features
+     * occurring in the given sequence. Must be called after a gradient
+     * update, which only touches the weights for that sequence's
+     * features.
+     *
+     * @param model The model whose weights were updated
+     * @param seq The sequence whose features were touched
+     */
+    void invalidate(const crf& model, const sequence& seq);
+
+    /**
+     * Refreshes the cached observation feature scores for an explicit
+     * list of features, for use after a merged minibatch update.
+     *
+     * @param model The model whose weights were updated
+     * @param feats The features whose weights were touched
+     */
+    void invalidate(const crf& model, const std::vector<feature_id>& feats);
+
     /**
      * Computes the forward trellis.
      */
@@ -143,6 +164,17 @@ class crf::scorer
      */
     void state_marginals();
 
+    /**
+     * Rebuilds the entire observation feature score cache from the
+     * model weights.
+     */
+    void rebuild_cache(const crf& model);
+
+    /**
+     * Recopies the cached (label, weight) list for a single feature.
+     */
+    void refresh_feature(const crf& model, feature_id fid);
+
     /// Stores the state scores in log-domain
     double_matrix state_;
     /// Stores the state scores
@@ -151,6 +183,23 @@ class crf::scorer
     double_matrix trans_;
     /// Stores the transition scores
     double_matrix trans_exp_;
+    /// Stores the transposed transition scores, so the forward trellis
+    /// can read a destination label's incoming scores contiguously
+    double_matrix trans_exp_t_;
+
+    /// Cached (label, unscaled weight) lists per observation feature.
+    /// Observation features are static across iterations, so these only
+    /// change when a gradient update touches the feature's weights (see
+    /// invalidate()) or when every weight changes at once (tracked via
+    /// the model's weight version).
+    std::vector<std::vector<std::pair<label_id, double>>> obs_cache_;
+    /// The model weight version obs_cache_ was built against
+    uint64_t cache_version_ = 0;
+
+    /// Scratch arena for the forward/backward trellises, reset at the
+    /// start of each score() call so steady-state training allocates no
+    /// trellis memory from the heap
+    util::arena arena_;
 
     /// Stores the forward trellis, if computed
     util::optional<forward_trellis> fwd_;
@@ -35,6 +35,20 @@ class crf::tagger
      */
     void tag(sequence& seq);
 
+    /**
+     * Finds the n best taggings of a sequence using n-best Viterbi
+     * decoding. The sequence itself is left untouched; each result
+     * pairs one label per observation with the score of that path.
+     * Results are in descending order of score, so the first entry
+     * matches what tag() would assign.
+     *
+     * @param seq The sequence to be tagged
+     * @param n The number of taggings to return
+     * @return the n best label sequences and their scores
+     */
+    std::vector<std::pair<std::vector<label_id>, double>>
+    tag_nbest(const sequence& seq, uint64_t n);
+
   private:
     class impl;
     /// the scorer used internally to run viterbi
@@ -39,6 +39,19 @@ class crf::viterbi_scorer
      */
     viterbi_trellis viterbi(const sequence& seq);
 
+    /**
+     * Runs the n-best Viterbi algorithm to produce a trellis whose
+     * nodes each keep a ranked back-pointer list for the top n paths
+     * ending there. The forward pass is shared across all n hypotheses,
+     * so this costs roughly a factor of n over a single Viterbi pass
+     * instead of n full decodes.
+     *
+     * @param seq The sequence to score
+     * @param n The number of hypotheses to keep per node
+     * @return a trellis with ranked back-pointer lists
+     */
+    nbest_trellis viterbi_nbest(const sequence& seq, uint64_t n);
+
   private:
     /// the internal scorer used
     crf::scorer scorer_;
@@ -0,0 +1,110 @@
+/**
+ * @file feature_cache.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_SEQUENCE_FEATURE_CACHE_H_
+#define META_SEQUENCE_FEATURE_CACHE_H_
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/sequence/sequence_analyzer.h"
+#include "meta/util/disk_vector.h"
+
+namespace meta
+{
+namespace sequence
+{
+
+/**
+ * A one-time featurization cache for multi-epoch sequence training.
+ * Analyzing a sequence regenerates every observation feature string,
+ * which is identical work on every epoch; a feature_cache runs the
+ * analyzer's static observation functions over the training set once
+ * and persists the resulting feature vectors as packed, mmap-backed
+ * arrays (util::disk_vector). Later epochs call fill() to restore a
+ * sequence's static features with a flat array walk, then run only the
+ * analyzer's dynamic observation functions (if any) via
+ * sequence_analyzer::analyze_dynamic().
+ *
+ * The cache stores feature ids, so it is only valid for the analyzer
+ * (and feature mapping) it was built with.
+ */
+class feature_cache
+{
+  public:
+    /**
+     * Builds a cache at the given prefix by running the analyzer's
+     * static observation functions over every sequence once. The
+     * sequences' observations are left featurized and labeled, so the
+     * first epoch can consume them directly.
+     *
+     * @param prefix The folder to store the cache files in
+     * @param sequences The training sequences to featurize
+     * @param analyzer The analyzer to featurize them with
+     */
+    feature_cache(const std::string& prefix, std::vector<sequence>& sequences,
+                  sequence_analyzer& analyzer);
+
+    /**
+     * Opens an existing cache from the given prefix.
+     *
+     * @param prefix The folder the cache files were stored in
+     */
+    explicit feature_cache(const std::string& prefix);
+
+    /**
+     * @return the number of cached sequences
+     */
+    uint64_t size() const;
+
+    /**
+     * Restores the cached static features onto every observation of the
+     * given sequence. The sequence must be the one that was cached at
+     * this index during construction.
+     *
+     * @param seq_index The index of the sequence in the cached set
+     * @param seq The sequence to restore features onto
+     */
+    void fill(uint64_t seq_index, sequence& seq) const;
+
+    /**
+     * Exception thrown during interactions with feature_caches.
+     */
+    class exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+  private:
+    /**
+     * Featurizes the sequences and writes the packed arrays; returns
+     * the prefix so the constructor can delegate to the reopening one.
+     */
+    static std::string write_cache(const std::string& prefix,
+                                   std::vector<sequence>& sequences,
+                                   sequence_analyzer& analyzer);
+
+    /// Maps a sequence index to its first observation index
+    util::disk_vector<const uint64_t> seq_offsets_;
+
+    /// Maps an observation index to its first entry in ids_/values_
+    util::disk_vector<const uint64_t> offsets_;
+
+    /// All cached feature ids, observation-major
+    util::disk_vector<const uint64_t> ids_;
+
+    /// The value for each entry of ids_
+    util::disk_vector<const double> values_;
+};
+}
+}
+#endif
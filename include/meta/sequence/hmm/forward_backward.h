@@ -10,7 +10,10 @@
 #ifndef META_SEQUENCE_HMM_FORWARD_BACKWARD_H_
 #define META_SEQUENCE_HMM_FORWARD_BACKWARD_H_
 
+#include <numeric>
+
 #include "meta/config.h"
+#include "meta/math/fastapprox.h"
 #include "meta/sequence/markov_model.h"
 #include "meta/sequence/trellis.h"
 
@@ -30,6 +33,29 @@ namespace hmm
  */
 struct scaling_forward_backward
 {
+    /**
+     * Copies the transition matrix out of the model so that the inner
+     * loops below read it contiguously instead of calling through the
+     * model accessor for every (time, state, state) triple.
+     *
+     * @param hmm The model
+     * @param transpose Whether to transpose the matrix, so that row i
+     * holds the probabilities of transitioning *into* state i
+     */
+    template <class HMM>
+    static util::dense_matrix<double> transitions(const HMM& hmm,
+                                                  bool transpose)
+    {
+        util::dense_matrix<double> trans{hmm.num_states(), hmm.num_states()};
+        for (state_id s_i{0}; s_i < hmm.num_states(); ++s_i)
+            for (state_id s_j{0}; s_j < hmm.num_states(); ++s_j)
+                trans(s_i, s_j) = hmm.trans_prob(s_i, s_j);
+
+        if (transpose)
+            return trans.transpose();
+        return trans;
+    }
+
     template <class HMM>
     static util::dense_matrix<double>
     output_probabilities(const HMM& hmm, const typename HMM::sequence_type& seq)
@@ -63,18 +89,24 @@ struct scaling_forward_backward
         // normalize to avoid underflow
         fwd.normalize(0);
 
+        // transposed so each destination state reads its incoming
+        // probabilities contiguously
+        auto trans = transitions(hmm, true);
+
+        std::vector<double> prev(hmm.num_states());
         // compute remaining columns using the recursive formulation
         for (uint64_t t = 1; t < seq.size(); ++t)
         {
+            for (label_id j{0}; j < hmm.num_states(); ++j)
+                prev[j] = fwd.probability(t - 1, j);
+
             for (label_id i{0}; i < hmm.num_states(); ++i)
             {
                 state_id s_i{i};
-                double sum = 0;
-                for (label_id j{0}; j < hmm.num_states(); ++j)
-                {
-                    state_id s_j{j};
-                    sum += fwd.probability(t - 1, j) * hmm.trans_prob(s_j, s_i);
-                }
+                // contiguous multiply-accumulate over the source
+                // states, which the compiler can vectorize
+                auto sum = std::inner_product(trans.begin(s_i), trans.end(s_i),
+                                              prev.begin(), 0.0);
                 fwd.probability(t, i, sum * output_probs(t, s_i));
             }
             // normalize to avoid underflow
@@ -98,25 +130,29 @@ struct scaling_forward_backward
             bwd.probability(seq.size() - 1, i, 1);
         }
 
+        auto trans = transitions(hmm, false);
+
+        std::vector<double> next(hmm.num_states());
         // fill in the remaining columns of the trellis from back to front
         for (uint64_t k = 1; k < seq.size(); ++k)
         {
             assert(seq.size() - 1 >= k);
             uint64_t t = seq.size() - 1 - k;
 
+            // hoist the per-destination factors, which are shared by
+            // every source state at this time step
+            for (label_id j{0}; j < hmm.num_states(); ++j)
+            {
+                state_id s_j{j};
+                next[j] = bwd.probability(t + 1, j) * output_probs(t + 1, s_j);
+            }
+            auto norm = fwd.normalizer(t + 1);
+
             for (label_id i{0}; i < hmm.num_states(); ++i)
             {
                 state_id s_i{i};
-
-                double sum = 0;
-                for (label_id j{0}; j < hmm.num_states(); ++j)
-                {
-                    state_id s_j{j};
-
-                    sum += bwd.probability(t + 1, j) * hmm.trans_prob(s_i, s_j)
-                           * output_probs(t + 1, s_j);
-                }
-                auto norm = fwd.normalizer(t + 1);
+                auto sum = std::inner_product(trans.begin(s_i), trans.end(s_i),
+                                              next.begin(), 0.0);
                 bwd.probability(t, i, norm * sum);
             }
         }
@@ -153,6 +189,36 @@ struct scaling_forward_backward
                                  const util::dense_matrix<double>& gamma,
                                  const util::dense_matrix<double>& output_probs)
     {
+        auto trans = transitions(hmm, false);
+
+        // accumulate the transition count contributions for the whole
+        // sequence locally so that each (i, j) count is incremented only
+        // once; time is the outer loop so the inner loop over
+        // destination states is contiguous
+        util::dense_matrix<double> xi{hmm.num_states(), hmm.num_states()};
+        std::vector<double> next(hmm.num_states());
+        for (uint64_t t = 0; t + 1 < seq.size(); ++t)
+        {
+            // per-destination factors, shared by every source state
+            for (label_id j{0}; j < hmm.num_states(); ++j)
+            {
+                state_id s_j{j};
+                next[j] = output_probs(t + 1, s_j) * fwd.normalizer(t + 1)
+                          * bwd.probability(t + 1, j);
+            }
+
+            for (label_id i{0}; i < hmm.num_states(); ++i)
+            {
+                state_id s_i{i};
+                auto scale = gamma(t, s_i) / bwd.probability(t, i);
+                for (label_id j{0}; j < hmm.num_states(); ++j)
+                {
+                    state_id s_j{j};
+                    xi(s_i, s_j) += scale * trans(s_i, s_j) * next[j];
+                }
+            }
+        }
+
         // add expected counts to the new parameters
         for (label_id i{0}; i < hmm.num_states(); ++i)
         {
@@ -165,17 +231,8 @@ struct scaling_forward_backward
             for (label_id j{0}; j < hmm.num_states(); ++j)
             {
                 state_id s_j{j};
-
-                for (uint64_t t = 0; t < seq.size() - 1; ++t)
-                {
-                    auto xi_tij
-                        = (gamma(t, s_i) * hmm.trans_prob(s_i, s_j)
-                           * output_probs(t + 1, s_j) * fwd.normalizer(t + 1)
-                           * bwd.probability(t + 1, j))
-                          / bwd.probability(t, i);
-
-                    counts.model_counts.increment_transition(s_i, s_j, xi_tij);
-                }
+                counts.model_counts.increment_transition(s_i, s_j,
+                                                         xi(s_i, s_j));
             }
 
             // add expected counts for observation probabilities
@@ -210,14 +267,47 @@ struct logarithm_forward_backward
     {
         auto max_it = std::max_element(begin, end);
 
+        // fastexp is accurate to within about 1e-6 relative error, which
+        // is tolerable here: the shifted terms are all <= 0, so terms
+        // small enough to be affected by float underflow are negligible
+        // against the maximal term anyway
         auto shifted_sum_exp
             = std::accumulate(begin, end, 0.0, [=](double accum, double val) {
-                  return accum + std::exp(val - *max_it);
+                  return accum
+                         + fastapprox::fastexp(
+                               static_cast<float>(val - *max_it));
               });
 
         return *max_it + std::log(shifted_sum_exp);
     }
 
+    /**
+     * Copies the log transition matrix out of the model so that the
+     * inner loops below read it contiguously instead of taking a
+     * logarithm for every (time, state, state) triple.
+     *
+     * @param hmm The model
+     * @param transpose Whether to transpose the matrix, so that row i
+     * holds the log probabilities of transitioning *into* state i
+     */
+    template <class HMM>
+    static util::dense_matrix<double> log_transitions(const HMM& hmm,
+                                                      bool transpose)
+    {
+        util::dense_matrix<double> trans{hmm.num_states(), hmm.num_states()};
+        for (state_id s_i{0}; s_i < hmm.num_states(); ++s_i)
+        {
+            for (state_id s_j{0}; s_j < hmm.num_states(); ++s_j)
+            {
+                if (transpose)
+                    trans(s_j, s_i) = std::log(hmm.trans_prob(s_i, s_j));
+                else
+                    trans(s_i, s_j) = std::log(hmm.trans_prob(s_i, s_j));
+            }
+        }
+        return trans;
+    }
+
     template <class HMM>
     static util::dense_matrix<double>
     output_probabilities(const HMM& hmm, const typename HMM::sequence_type& seq)
@@ -250,19 +340,26 @@ struct logarithm_forward_backward
                                       + output_log_probs(0, s));
         }
 
+        // transposed so each destination state reads its incoming log
+        // probabilities contiguously
+        auto trans = log_transitions(hmm, true);
+
+        std::vector<double> prev(hmm.num_states());
         std::vector<double> scratch(hmm.num_states());
         // compute remaining columns using the recursive formulation
         for (uint64_t t = 1; t < seq.size(); ++t)
         {
+            for (label_id j{0}; j < hmm.num_states(); ++j)
+                prev[j] = fwd.probability(t - 1, j);
+
             for (label_id i{0}; i < hmm.num_states(); ++i)
             {
                 state_id s_i{i};
-                for (label_id j{0}; j < hmm.num_states(); ++j)
-                {
-                    state_id s_j{j};
-                    scratch[j] = fwd.probability(t - 1, j)
-                                 + std::log(hmm.trans_prob(s_j, s_i));
-                }
+                std::transform(trans.begin(s_i), trans.end(s_i), prev.begin(),
+                               scratch.begin(),
+                               [](double log_aji, double alpha) {
+                                   return alpha + log_aji;
+                               });
                 fwd.probability(t, i,
                                 log_sum_exp(scratch.begin(), scratch.end())
                                     + output_log_probs(t, s_i));
@@ -286,6 +383,9 @@ struct logarithm_forward_backward
             bwd.probability(seq.size() - 1, i, 0);
         }
 
+        auto trans = log_transitions(hmm, false);
+
+        std::vector<double> next(hmm.num_states());
         std::vector<double> scratch(hmm.num_states());
         // fill in the remaining columns of the trellis from back to front
         for (uint64_t k = 1; k < seq.size(); ++k)
@@ -293,16 +393,23 @@ struct logarithm_forward_backward
             assert(seq.size() - 1 >= k);
             uint64_t t = seq.size() - 1 - k;
 
+            // hoist the per-destination terms, which are shared by every
+            // source state at this time step
+            for (label_id j{0}; j < hmm.num_states(); ++j)
+            {
+                state_id s_j{j};
+                next[j] = bwd.probability(t + 1, j)
+                          + output_log_probs(t + 1, s_j);
+            }
+
             for (label_id i{0}; i < hmm.num_states(); ++i)
             {
                 state_id s_i{i};
-                for (label_id j{0}; j < hmm.num_states(); ++j)
-                {
-                    state_id s_j{j};
-                    scratch[j] = bwd.probability(t + 1, j)
-                                 + std::log(hmm.trans_prob(s_i, s_j))
-                                 + output_log_probs(t + 1, s_j);
-                }
+                std::transform(trans.begin(s_i), trans.end(s_i), next.begin(),
+                               scratch.begin(),
+                               [](double log_aij, double beta) {
+                                   return log_aij + beta;
+                               });
                 bwd.probability(t, i,
                                 log_sum_exp(scratch.begin(), scratch.end()));
             }
@@ -340,6 +447,39 @@ struct logarithm_forward_backward
                      const util::dense_matrix<double>& log_gamma,
                      const util::dense_matrix<double>& output_log_probs)
     {
+        auto trans = log_transitions(hmm, false);
+
+        // accumulate the transition count contributions for the whole
+        // sequence locally so that each (i, j) count is incremented only
+        // once; time is the outer loop so the inner loop over
+        // destination states is contiguous. The log xi terms are always
+        // <= 0, so fastexp's float range and ~1e-6 relative error are
+        // tolerable for these (normalized) counts.
+        util::dense_matrix<double> xi{hmm.num_states(), hmm.num_states()};
+        std::vector<double> next(hmm.num_states());
+        for (uint64_t t = 0; t + 1 < seq.size(); ++t)
+        {
+            // per-destination terms, shared by every source state
+            for (label_id j{0}; j < hmm.num_states(); ++j)
+            {
+                state_id s_j{j};
+                next[j] = output_log_probs(t + 1, s_j)
+                          + bwd.probability(t + 1, j);
+            }
+
+            for (label_id i{0}; i < hmm.num_states(); ++i)
+            {
+                state_id s_i{i};
+                auto base = log_gamma(t, s_i) - bwd.probability(t, i);
+                for (label_id j{0}; j < hmm.num_states(); ++j)
+                {
+                    state_id s_j{j};
+                    xi(s_i, s_j) += fastapprox::fastexp(static_cast<float>(
+                        base + trans(s_i, s_j) + next[j]));
+                }
+            }
+        }
+
         for (label_id i{0}; i < hmm.num_states(); ++i)
         {
             state_id s_i{i};
@@ -352,17 +492,8 @@ struct logarithm_forward_backward
             for (label_id j{0}; j < hmm.num_states(); ++j)
             {
                 state_id s_j{j};
-
-                for (uint64_t t = 0; t < seq.size() - 1; ++t)
-                {
-                    auto log_xi_tij
-                        = log_gamma(t, s_i) + std::log(hmm.trans_prob(s_i, s_j))
-                          + output_log_probs(t + 1, s_j)
-                          + bwd.probability(t + 1, j) - bwd.probability(t, i);
-
-                    counts.model_counts.increment_transition(
-                        s_i, s_j, std::exp(log_xi_tij));
-                }
+                counts.model_counts.increment_transition(s_i, s_j,
+                                                         xi(s_i, s_j));
             }
 
             // add expected counts for observation probabilities
@@ -13,6 +13,7 @@
 
 #include "meta/classify/models/linear_model.h"
 #include "meta/config.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/sequence/sequence_analyzer.h"
 
 namespace meta
@@ -41,6 +42,14 @@ class perceptron
          * examples during training.
          */
         std::random_device::result_type seed = std::random_device{}();
+
+        /**
+         * Where to store the one-time featurization cache reused across
+         * training epochs (removed when training finishes). An empty
+         * path disables the cache and re-analyzes every sequence each
+         * epoch.
+         */
+        std::string cache_path = "perceptron-feature-cache";
     };
 
     /**
@@ -61,11 +70,26 @@ class perceptron
      */
     void tag(sequence& seq) const;
 
+    /**
+     * Tags a batch of sequences in parallel across a thread pool. The
+     * model is read-only during tagging, so the sequences are simply
+     * partitioned among the pool's threads.
+     *
+     * @param sequences The sequences to be tagged
+     * @param pool The thread pool to tag the sequences with
+     */
+    void tag_batch(std::vector<sequence>& sequences,
+                   parallel::thread_pool& pool) const;
+
     /**
      * Trains the tagger on a set of sequences using the given options. The
      * sequences given for training will be analyzed by the tagger
      * internally, so they do not need to be analyzed ahead of time.
      *
+     * Weight averaging is lazy: a weight only pays averaging cost on
+     * the steps that change it, and the model is compacted into its
+     * contiguous (frozen) inference form once training finishes.
+     *
      * @param sequences The training data
      * @param options THe training options
      */
@@ -63,6 +63,17 @@ class sequence_analyzer
      */
     sequence_analyzer(const std::string& prefix);
 
+    /**
+     * Constructs a new sequence analyzer that hashes feature strings
+     * into a fixed feature space instead of interning them, eliminating
+     * the feature map lookup on the analysis path entirely. Hashed
+     * analyzers never allocate while analyzing and their feature space
+     * is fixed at num_buckets.
+     *
+     * @param num_buckets The size of the hashed feature space
+     */
+    explicit sequence_analyzer(uint64_t num_buckets);
+
     /**
      * Sequence analyzers may be copy constructed.
      */
@@ -130,6 +141,28 @@ class sequence_analyzer
      */
     void analyze(sequence& sequence, uint64_t idx) const;
 
+    /**
+     * Runs only the static observation functions over a single point in
+     * a sequence, replacing its features. Static features depend only
+     * on the symbols of the sequence, so the result can be computed
+     * once and cached (see feature_cache) across training epochs.
+     *
+     * @param sequence The sequence to be analyzed
+     * @param idx The position in the sequence to be analyzed
+     */
+    void analyze_static(sequence& sequence, uint64_t idx);
+
+    /**
+     * Runs only the dynamic observation functions over a single point
+     * in a sequence, *appending* to its existing features. Call after
+     * restoring the static features (e.g. from a feature_cache) to
+     * complete the featurization for this pass.
+     *
+     * @param sequence The sequence to be analyzed
+     * @param idx The position in the sequence to be analyzed
+     */
+    void analyze_dynamic(sequence& sequence, uint64_t idx);
+
     /**
      * Looks up the feature id for the given string representation. If one
      * doesn't exist, it will assign the next feature_id to this string
@@ -151,7 +184,17 @@ class sequence_analyzer
     feature_id feature(const std::string& feature) const;
 
     /**
-     * @return the number of feature_ids used so far to describe observations
+     * Freezes the feature set: lookups of unseen features no longer
+     * intern them (they behave as in the const overload), so a frozen
+     * analyzer never allocates during analysis. Has no effect on hashed
+     * analyzers, which never intern anything.
+     */
+    void freeze();
+
+    /**
+     * @return the number of feature_ids used so far to describe
+     * observations (or the size of the feature space for hashed
+     * analyzers)
      */
     uint64_t num_features() const;
 
@@ -194,6 +237,21 @@ class sequence_analyzer
         obs_fns_.emplace_back(std::forward<Function>(function));
     }
 
+    /**
+     * Adds a *dynamic* observation function: one whose output depends
+     * on state that changes between analysis passes (e.g. the labels of
+     * earlier observations during greedy tagging). Dynamic functions
+     * are excluded from analyze_static() and thus from featurization
+     * caches; they always run in analyze() and analyze_dynamic().
+     *
+     * @param function The function to add
+     */
+    template <class Function>
+    void add_dynamic_observation_function(Function&& function)
+    {
+        dyn_obs_fns_.emplace_back(std::forward<Function>(function));
+    }
+
     /**
      * Interface class used for analyzing observations inside
      * user-provided feature functions.
@@ -333,13 +391,38 @@ class sequence_analyzer
     void add_feature(observation& obs, const std::string& feature,
                      double weight = 1.0);
 
-    /// The observation functions
+    /**
+     * Interns (if needed) and assigns the label for an observation from
+     * its tag.
+     * @param sequence The sequence being analyzed
+     * @param t The position in the sequence
+     */
+    void assign_label(sequence& sequence, uint64_t t);
+
+    /// The (static) observation functions
     std::vector<std::function<void(const sequence&, uint64_t, collector&)>>
         obs_fns_;
 
-    /// The feature_id mapping (string to id)
+    /// The dynamic observation functions (excluded from analyze_static())
+    std::vector<std::function<void(const sequence&, uint64_t, collector&)>>
+        dyn_obs_fns_;
+
+    /**
+     * Hashes a feature string into the fixed feature space.
+     * @param feat The string representation of the feature
+     * @return the hashed feature id
+     */
+    feature_id hashed_feature(const std::string& feat) const;
+
+    /// The feature_id mapping (string to id); unused in hashed mode
     std::unordered_map<std::string, feature_id> feature_id_mapping_;
 
+    /// The size of the hashed feature space (0 = interning mode)
+    uint64_t hash_space_ = 0;
+
+    /// Whether unseen features should no longer be interned
+    bool frozen_ = false;
+
     /// The label_id mapping (tag_t to label_id)
     util::invertible_map<tag_t, label_id> label_id_mapping_;
 };
@@ -349,6 +432,15 @@ class sequence_analyzer
  * tagging. Uses a predefined set of observation functions.
  */
 sequence_analyzer default_pos_analyzer();
+
+/**
+ * Constructs a part-of-speech tagging analyzer that hashes its features
+ * into a fixed feature space of the given size rather than interning
+ * feature strings.
+ *
+ * @param num_buckets The size of the hashed feature space
+ */
+sequence_analyzer default_pos_analyzer(uint64_t num_buckets);
 }
 }
 #endif
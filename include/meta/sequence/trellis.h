@@ -16,6 +16,7 @@
 #include "meta/config.h"
 #include "meta/meta.h"
 #include "meta/sequence/observation.h"
+#include "meta/util/arena.h"
 #include "meta/util/dense_matrix.h"
 
 namespace meta
@@ -25,12 +26,16 @@ namespace sequence
 
 /**
  * Basic trellis for holding score data for the forward/backward algorithm.
+ *
+ * Trellises are built once per sequence and die with it, so every
+ * variant can optionally draw its storage from a util::arena that the
+ * caller resets between sequences instead of hitting the heap each time.
  */
 class trellis
 {
   protected:
     /// storage for the scores
-    util::dense_matrix<double> trellis_;
+    util::dense_matrix<double, util::arena_allocator<double>> trellis_;
 
   public:
     /**
@@ -42,6 +47,16 @@ class trellis
      */
     trellis(uint64_t size, uint64_t labels);
 
+    /**
+     * Constructs a new trellis drawing its storage from the given arena,
+     * which must outlive the trellis.
+     *
+     * @param size The number of time steps
+     * @param labels The number of labels associated with each time step
+     * @param arena The arena for the scratch storage
+     */
+    trellis(uint64_t size, uint64_t labels, util::arena& arena);
+
     /**
      * @return The number of time steps in the trellis.
      */
@@ -75,7 +90,7 @@ class forward_trellis : public trellis
 {
   private:
     /// storage for the normalizers for each time step
-    std::vector<double> normalizers_;
+    std::vector<double, util::arena_allocator<double>> normalizers_;
 
   public:
     /**
@@ -87,6 +102,16 @@ class forward_trellis : public trellis
      */
     forward_trellis(uint64_t size, uint64_t labels);
 
+    /**
+     * Constructs a forward_trellis drawing its storage from the given
+     * arena, which must outlive the trellis.
+     *
+     * @param size The number of time steps
+     * @param labels The number of labels
+     * @param arena The arena for the scratch storage
+     */
+    forward_trellis(uint64_t size, uint64_t labels, util::arena& arena);
+
     /**
      * @param idx The time step
      * @return the normalizer used for the given time step
@@ -110,7 +135,7 @@ class viterbi_trellis : public trellis
 {
   private:
     /// storage for the back pointers
-    util::dense_matrix<label_id> paths_;
+    util::dense_matrix<label_id, util::arena_allocator<label_id>> paths_;
 
   public:
     /**
@@ -122,6 +147,16 @@ class viterbi_trellis : public trellis
      */
     viterbi_trellis(uint64_t size, uint64_t labels);
 
+    /**
+     * Constructs a viterbi_trellis drawing its storage from the given
+     * arena, which must outlive the trellis.
+     *
+     * @param size The number of time steps
+     * @param labels The number of labels
+     * @param arena The arena for the scratch storage
+     */
+    viterbi_trellis(uint64_t size, uint64_t labels, util::arena& arena);
+
     /**
      * Sets the back pointer for the given time step and label to the
      * given label.
@@ -140,6 +175,74 @@ class viterbi_trellis : public trellis
      */
     const label_id& previous_tag(uint64_t idx, const label_id& current) const;
 };
+
+/**
+ * Special trellis for n-best Viterbi decoding. Instead of a single score
+ * and back pointer per node, each node stores a ranked list of the top n
+ * partial-path hypotheses ending there, each with a back pointer to the
+ * (label, rank) pair it extends at the previous time step.
+ */
+class nbest_trellis
+{
+  public:
+    /**
+     * A single partial-path hypothesis ending at a node.
+     */
+    struct backpointer
+    {
+        /// the score of the partial path ending at this node
+        double score;
+        /// the label of the previous node on the path
+        label_id previous;
+        /// the rank of the hypothesis extended at the previous node
+        uint64_t rank;
+    };
+
+    /**
+     * Constructs an nbest_trellis with the given number of time steps
+     * and labels, keeping up to n hypotheses per node.
+     *
+     * @param size The number of time steps
+     * @param labels The number of labels
+     * @param n The number of hypotheses to keep per node
+     */
+    nbest_trellis(uint64_t size, uint64_t labels, uint64_t n);
+
+    /**
+     * @return The number of time steps in the trellis.
+     */
+    uint64_t size() const;
+
+    /**
+     * @return the maximum number of hypotheses kept per node
+     */
+    uint64_t num_best() const;
+
+    /**
+     * Sets the hypothesis list for the given time step and label.
+     *
+     * @param idx The time step
+     * @param tag The label
+     * @param hyps The hypotheses, in descending order of score
+     */
+    void hypotheses(uint64_t idx, const label_id& tag,
+                    std::vector<backpointer> hyps);
+
+    /**
+     * @param idx The time step
+     * @param tag The label
+     * @return the ranked hypothesis list for the given time step and label
+     */
+    const std::vector<backpointer>& hypotheses(uint64_t idx,
+                                               const label_id& tag) const;
+
+  private:
+    /// storage for the ranked hypotheses of each node
+    util::dense_matrix<std::vector<backpointer>> hypotheses_;
+
+    /// the maximum number of hypotheses per node
+    uint64_t n_;
+};
 }
 }
 #endif
@@ -0,0 +1,196 @@
+/**
+ * @file dd_sketch.h
+ * @author Chase Geigle
+ *
+ * All files in META are released under the MIT license. For more details,
+ * consult the file LICENSE in the root of the project.
+ */
+
+#ifndef META_STATS_DD_SKETCH_H_
+#define META_STATS_DD_SKETCH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace stats
+{
+
+/**
+ * A streaming quantile sketch in the style of DDSketch: observations are
+ * counted in logarithmically spaced buckets, so any quantile can be
+ * answered with a guaranteed relative error (1% by default) from bounded
+ * memory, and two sketches over disjoint streams merge exactly by adding
+ * bucket counts. This complements running_stats, which only tracks
+ * moments: tail quantiles (p99 and beyond) of latency distributions are
+ * invisible to a mean/stddev summary.
+ *
+ * When the bucket budget is exceeded, the lowest buckets are collapsed
+ * together, sacrificing accuracy at the cheap end of the distribution
+ * while the upper quantiles keep their guarantee.
+ */
+class dd_sketch
+{
+  public:
+    /**
+     * Basic exception for dd_sketch interactions.
+     */
+    class exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * Constructs an empty sketch.
+     *
+     * @param relative_accuracy The guaranteed relative error of
+     * quantile(), in (0, 1)
+     * @param max_buckets The bucket budget before low buckets collapse
+     */
+    dd_sketch(double relative_accuracy = 0.01,
+              std::size_t max_buckets = 2048);
+
+    /**
+     * Adds an observation to the sketch. Non-positive values are
+     * counted in a dedicated zero bucket.
+     *
+     * @param value The value to be added
+     * @param count The number of times to add it
+     */
+    void add(double value, uint64_t count = 1);
+
+    /**
+     * Adds a raw bucket count, for ingesting externally accumulated
+     * logarithmic buckets (see concurrent_dd_sketch::snapshot()).
+     *
+     * @param index The bucket index, as computed by bucket_index()
+     * @param count The number of observations in that bucket
+     */
+    void add_bucket(int32_t index, uint64_t count);
+
+    /**
+     * Merges another sketch's observations into this one.
+     *
+     * @param other The sketch to merge in; it must have been constructed
+     * with the same relative accuracy
+     */
+    void merge(const dd_sketch& other);
+
+    /**
+     * @param q The desired quantile, in [0, 1]
+     * @return a value within the configured relative error of the q-th
+     * quantile of the observations (0 if the sketch is empty)
+     */
+    double quantile(double q) const;
+
+    /**
+     * @return the total number of observations add()ed
+     */
+    uint64_t size() const;
+
+    /**
+     * @return the configured relative accuracy
+     */
+    double relative_accuracy() const;
+
+    /**
+     * @param value A positive value
+     * @return the index of the logarithmic bucket that counts it
+     */
+    int32_t bucket_index(double value) const;
+
+  private:
+    /**
+     * @param index A bucket index
+     * @return the representative value for that bucket (within the
+     * relative accuracy of everything the bucket counts)
+     */
+    double bucket_value(int32_t index) const;
+
+    /**
+     * Collapses the lowest buckets until the budget is respected.
+     */
+    void collapse();
+
+    /// the configured relative error bound
+    double relative_accuracy_;
+    /// the logarithmic base: (1 + accuracy) / (1 - accuracy)
+    double gamma_;
+    /// 1 / log(gamma), for computing bucket indexes
+    double inv_log_gamma_;
+    /// the bucket budget
+    std::size_t max_buckets_;
+    /// observation counts per logarithmic bucket, in index order
+    std::map<int32_t, uint64_t> buckets_;
+    /// observations of non-positive values
+    uint64_t zero_count_;
+    /// the total number of observations
+    uint64_t count_;
+    /// the smallest and largest values seen, for clamping quantiles
+    double min_;
+    double max_;
+};
+
+/**
+ * A fixed-footprint, thread-safe front end for dd_sketch, for always-on
+ * instrumentation: add() is one relaxed atomic increment on a
+ * preallocated bucket array, with the writing threads spread over a few
+ * shards to keep hot buckets from bouncing between cores. snapshot()
+ * folds the shards into a dd_sketch for querying; it can run at any
+ * time without pausing the writers.
+ *
+ * Values outside the trackable range are clamped to the extreme
+ * buckets, so the configured range only bounds where the accuracy
+ * guarantee applies.
+ */
+class concurrent_dd_sketch
+{
+  public:
+    /**
+     * Constructs an empty concurrent sketch.
+     *
+     * @param relative_accuracy The guaranteed relative error of
+     * quantiles, in (0, 1)
+     * @param min_trackable The smallest positive value of interest
+     * @param max_trackable The largest value of interest
+     */
+    concurrent_dd_sketch(double relative_accuracy = 0.01,
+                         double min_trackable = 1e-6,
+                         double max_trackable = 1e9);
+
+    /**
+     * Adds an observation. Safe to call concurrently from any thread.
+     *
+     * @param value The value to be added
+     */
+    void add(double value);
+
+    /**
+     * @return a dd_sketch merging every shard's counts at some point
+     * during the call
+     */
+    dd_sketch snapshot() const;
+
+  private:
+    /// the number of independently written bucket arrays
+    const static std::size_t num_shards = 16;
+
+    /// a prototype sketch holding the bucket geometry
+    dd_sketch proto_;
+    /// the bucket index of min_trackable
+    int32_t base_index_;
+    /// the number of buckets per shard (plus one zero bucket in front)
+    std::size_t num_buckets_;
+    /// the per-shard bucket counts
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+};
+}
+}
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file space_saving.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_STATS_SPACE_SAVING_H_
+#define META_STATS_SPACE_SAVING_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace stats
+{
+
+/**
+ * A SpaceSaving heavy-hitters summary: frequency counting over a stream
+ * with a fixed number of counters. When a new key arrives and every
+ * counter is taken, the minimum counter is evicted and the new key
+ * inherits its count, recording the inherited amount as that key's
+ * error. Reported counts are therefore upper bounds on the true
+ * frequencies, over by at most the recorded error, and any key whose
+ * true frequency exceeds N/m (for N observations and m counters) is
+ * guaranteed to be present. This makes the summary a sound candidate
+ * generator for an exact second pass.
+ *
+ * The counters are kept in a min-heap on count with a hash index from
+ * key to heap slot, so increments and evictions are logarithmic in the
+ * number of counters.
+ *
+ * @see https://doi.org/10.1007/978-3-540-30570-5_27
+ */
+template <class Key>
+class space_saving
+{
+  public:
+    /**
+     * Basic exception for space_saving interactions.
+     */
+    class exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * One monitored key: its estimated count and the amount of that
+     * count that may be inherited overestimation.
+     */
+    struct counter
+    {
+        Key key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    /**
+     * Constructs an empty summary.
+     *
+     * @param max_counters The (fixed) number of counters to maintain
+     */
+    space_saving(std::size_t max_counters) : max_counters_{max_counters}
+    {
+        if (!max_counters_)
+            throw exception{"space_saving requires at least one counter"};
+        heap_.reserve(max_counters_);
+    }
+
+    /**
+     * Observes a key, optionally with a weight.
+     *
+     * @param key The key observed
+     * @param by The number of occurrences to record
+     */
+    void increment(const Key& key, uint64_t by = 1)
+    {
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            heap_[it->second].count += by;
+            sift_down(it->second);
+        }
+        else if (heap_.size() < max_counters_)
+        {
+            heap_.push_back(counter{key, by, 0});
+            index_[key] = heap_.size() - 1;
+            sift_up(heap_.size() - 1);
+        }
+        else
+        {
+            // evict the minimum counter: the new key inherits its count
+            // as overestimation error
+            auto& root = heap_[0];
+            index_.erase(root.key);
+            root.error = root.count;
+            root.count += by;
+            root.key = key;
+            index_[key] = 0;
+            sift_down(0);
+        }
+    }
+
+    /**
+     * Folds another summary into this one by replaying its counters as
+     * weighted observations. Since the other summary's counts are upper
+     * bounds themselves, the merged counts remain upper bounds on the
+     * true frequencies of the combined stream; this is how per-shard
+     * summaries are combined into one candidate set.
+     *
+     * @param other The summary to merge in
+     */
+    void merge(const space_saving& other)
+    {
+        for (const auto& ctr : other.heap_)
+            increment(ctr.key, ctr.count);
+    }
+
+    /**
+     * @return the monitored counters, sorted by descending count
+     */
+    std::vector<counter> counters() const
+    {
+        auto result = heap_;
+        std::sort(result.begin(), result.end(),
+                  [](const counter& a, const counter& b) {
+                      return a.count > b.count;
+                  });
+        return result;
+    }
+
+    /**
+     * @return the number of keys currently monitored
+     */
+    std::size_t size() const
+    {
+        return heap_.size();
+    }
+
+    /**
+     * @return the number of counters this summary maintains
+     */
+    std::size_t max_counters() const
+    {
+        return max_counters_;
+    }
+
+  private:
+    void swap_slots(std::size_t a, std::size_t b)
+    {
+        std::swap(heap_[a], heap_[b]);
+        index_[heap_[a].key] = a;
+        index_[heap_[b].key] = b;
+    }
+
+    void sift_up(std::size_t i)
+    {
+        while (i > 0)
+        {
+            auto parent = (i - 1) / 2;
+            if (heap_[parent].count <= heap_[i].count)
+                break;
+            swap_slots(i, parent);
+            i = parent;
+        }
+    }
+
+    void sift_down(std::size_t i)
+    {
+        while (true)
+        {
+            auto smallest = i;
+            auto left = 2 * i + 1;
+            auto right = 2 * i + 2;
+            if (left < heap_.size()
+                && heap_[left].count < heap_[smallest].count)
+                smallest = left;
+            if (right < heap_.size()
+                && heap_[right].count < heap_[smallest].count)
+                smallest = right;
+            if (smallest == i)
+                return;
+            swap_slots(i, smallest);
+            i = smallest;
+        }
+    }
+
+    /// the counters, as a min-heap on count
+    std::vector<counter> heap_;
+    /// maps each monitored key to its heap slot
+    std::unordered_map<Key, std::size_t> index_;
+    /// the fixed counter budget
+    std::size_t max_counters_;
+};
+}
+}
+#endif
@@ -14,6 +14,11 @@
 
 #include "meta/config.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define META_BROADWORD_X64_DISPATCH 1
+#include <immintrin.h>
+#endif
+
 namespace meta
 {
 namespace succinct
@@ -133,13 +138,48 @@ inline uint64_t bytes_sum(uint64_t word)
     return word * ones_step_8 >> 56;
 }
 
-inline uint64_t popcount(uint64_t word)
+#if META_BROADWORD_X64_DISPATCH
+namespace detail
+{
+/**
+ * Hardware implementations of the hot leaf operations. These carry
+ * instruction-set target attributes so the translation unit can still be
+ * compiled for a generic x86-64 baseline; callers must check the
+ * corresponding CPU feature at runtime before dispatching here.
+ */
+__attribute__((target("popcnt"))) inline uint64_t popcount_hw(uint64_t word)
 {
-#if META_BROADWORD_USE_POPCOUNT
     return static_cast<uint64_t>(__builtin_popcountll(word));
-#else
-    return bytes_sum(byte_counts(word));
+}
+
+__attribute__((target("bmi2"))) inline uint64_t
+select_in_word_hw(uint64_t word, uint64_t k)
+{
+    // deposit a single bit onto the k-th one of word, then locate it
+    return static_cast<uint64_t>(__builtin_ctzll(_pdep_u64(1ull << k, word)));
+}
+
+inline bool have_popcnt()
+{
+    static const bool avail = __builtin_cpu_supports("popcnt");
+    return avail;
+}
+
+inline bool have_bmi2()
+{
+    static const bool avail = __builtin_cpu_supports("bmi2");
+    return avail;
+}
+}
+#endif
+
+inline uint64_t popcount(uint64_t word)
+{
+#if META_BROADWORD_X64_DISPATCH
+    if (detail::have_popcnt())
+        return detail::popcount_hw(word);
 #endif
+    return bytes_sum(byte_counts(word));
 }
 
 inline uint64_t lsb(uint64_t word)
@@ -156,17 +196,17 @@ inline uint64_t msb(uint64_t word)
 
 inline uint64_t select_in_word(uint64_t word, uint64_t k)
 {
+#if META_BROADWORD_X64_DISPATCH
+    if (detail::have_bmi2())
+        return detail::select_in_word_hw(word, k);
+#endif
     uint64_t byte_sums = byte_counts(word) * ones_step_8;
 
     const uint64_t k_step_8 = k * ones_step_8;
     const uint64_t geq_k_step_8
         = (((k_step_8 | msbs_step_8) - byte_sums) & msbs_step_8);
-#if META_BROADWORD_USE_POPCOUNT
-    const uint64_t place = intrinsics::popcount(geq_k_step_8) * 8;
-#else
     const uint64_t place
         = ((geq_k_step_8 >> 7) * ones_step_8 >> 53) & ~uint64_t(0x7);
-#endif
     const uint64_t byte_rank
         = k - (((byte_sums << 8) >> place) & uint64_t(0xFF));
     return place + select_in_byte[((word >> place) & 0xFF) | (byte_rank << 8)];
@@ -11,6 +11,7 @@
 #define META_SUCCINCT_COMPRESSED_VECTOR_H_
 
 #include <fstream>
+#include <memory>
 
 #include "meta/config.h"
 #include "meta/succinct/bit_vector.h"
@@ -36,6 +37,22 @@ class compressed_vector
 
     uint64_t operator[](uint64_t i) const;
 
+    /**
+     * Decodes a run of consecutive elements into a caller-provided
+     * buffer. One select query lands on the first element; every
+     * subsequent boundary comes from walking the set bits of the
+     * position index a word at a time, so the per-element cost for a
+     * block (64 or more values) is a couple of broadword ops instead of
+     * two select queries. This is the preferred way to scan the vector.
+     *
+     * @param start The index of the first element to decode
+     * @param count The number of elements to decode
+     * @param out The buffer to decode into (must hold count values)
+     * @return the number of elements decoded, which is smaller than
+     * count only when the run extends past the end of the vector
+     */
+    uint64_t decode(uint64_t start, uint64_t count, uint64_t* out) const;
+
     uint64_t size() const;
 
   private:
@@ -44,39 +61,44 @@ class compressed_vector
     sarray_select select_;
 };
 
-template <class ForwardIterator>
-void make_compressed_vector(const std::string& prefix, ForwardIterator begin,
-                            ForwardIterator end)
+/**
+ * Single-pass, out-of-core builder for a compressed_vector. Values are
+ * appended one at a time and their bits stream directly to disk, so the
+ * full sequence never needs to be resident; only the per-element bit
+ * lengths are staged (in a packed temporary file) to build the position
+ * index once the total counts are known. The destructor finalizes the
+ * structure on disk under the prefix given at construction.
+ */
+class compressed_vector_builder
 {
-    filesystem::make_directory(prefix);
-    std::ofstream bv_stream{prefix + "/compressed-vec.bin", std::ios::binary};
-    auto bv_builder = make_bit_vector_builder(bv_stream);
+  public:
+    compressed_vector_builder(const std::string& prefix);
 
-    uint64_t num_elems = 0;
-    uint64_t num_bits = 0;
-    for (auto it = begin; it != end; ++it)
-    {
-        uint64_t word = *it;
-        num_bits += (word) ? broadword::msb(word) : 1;
-        ++num_elems;
-    }
+    /**
+     * Appends a value to the vector being built.
+     * @param word The value to append
+     */
+    void operator()(uint64_t word);
 
-    {
-        filesystem::make_directory(prefix + "/sarray");
-        sarray_builder s_builder{prefix + "/sarray", num_elems + 1, num_bits};
-        s_builder(bv_builder.total_bits());
-        for (auto it = begin; it != end; ++it)
-        {
-            uint64_t word = *it;
-            uint64_t len = (word) ? broadword::msb(word) : 1;
-            bv_builder.write_bits({word, static_cast<uint8_t>(len)});
+    ~compressed_vector_builder();
 
-            s_builder(bv_builder.total_bits());
-        }
-    }
+  private:
+    using builder_type = bit_vector_builder<detail::ostream_word_writer>;
+
+    std::string prefix_;
+    std::ofstream bv_stream_;
+    std::ofstream len_stream_;
+    std::unique_ptr<builder_type> bv_builder_;
+    uint64_t num_elems_ = 0;
+};
 
-    sarray select{prefix + "/sarray"};
-    sarray_select{prefix + "/sarray", select};
+template <class ForwardIterator>
+void make_compressed_vector(const std::string& prefix, ForwardIterator begin,
+                            ForwardIterator end)
+{
+    compressed_vector_builder builder{prefix};
+    for (; begin != end; ++begin)
+        builder(*begin);
 }
 }
 }
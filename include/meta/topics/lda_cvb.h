@@ -71,6 +71,8 @@ class lda_cvb : public lda_model
     virtual double compute_doc_topic_probability(doc_id doc,
                                                  topic_id topic) const override;
 
+    virtual double doc_topic_prior() const override;
+
   protected:
     /**
      * Initializes the parameters randomly.
@@ -103,6 +105,12 @@ class lda_cvb : public lda_model
      * The topic distributions for each document, \f$\theta_d\f$.
      */
     std::vector<stats::multinomial<topic_id>> theta_;
+
+    /**
+     * The symmetric Dirichlet hyperparameter \f$\alpha\f$ on the
+     * topic proportions.
+     */
+    double alpha_;
 };
 }
 }
@@ -10,12 +10,15 @@
 #ifndef META_LDA_GIBBS_H_
 #define META_LDA_GIBBS_H_
 
+#include <future>
 #include <random>
 
 #include "meta/config.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/stats/multinomial.h"
 #include "meta/topics/lda_model.h"
 #include "meta/util/dense_matrix.h"
+#include "meta/util/sparse_vector.h"
 
 namespace meta
 {
@@ -85,6 +88,55 @@ class lda_gibbs : public lda_model
     virtual double compute_doc_topic_probability(doc_id doc,
                                                  topic_id topic) const override;
 
+    virtual double doc_topic_prior() const override;
+
+    /**
+     * Enables periodic checkpointing during run(): after every `period`
+     * iterations, the topic assignments are snapshotted and written to
+     * `prefix + ".chk"` on a background thread while sampling continues,
+     * so a checkpoint costs one in-memory copy of the assignment vector
+     * rather than a synchronous disk write. The file is written to a
+     * temporary name and renamed into place, so a crash mid-write never
+     * clobbers the previous checkpoint.
+     *
+     * @param period The number of iterations between checkpoints (0
+     * disables checkpointing)
+     * @param prefix The prefix for the checkpoint file
+     */
+    void checkpoint_every(uint64_t period, const std::string& prefix);
+
+    /**
+     * Synchronously writes a checkpoint of the current sampler state to
+     * the given file.
+     *
+     * @param filename The file to write the checkpoint to
+     */
+    void write_checkpoint(const std::string& filename) const;
+
+    /**
+     * Restores the sampler from a checkpoint: the topic assignments are
+     * loaded and all count structures are rebuilt from them, and a
+     * following call to run() skips initialization and continues from
+     * the checkpointed iteration. Virtual so that descendants can
+     * restore any additional state of their own.
+     *
+     * @param filename The checkpoint file to restore from
+     */
+    virtual void resume(const std::string& filename);
+
+    /**
+     * Enables hyperparameter optimization during run(): after every
+     * `period` iterations, the document-topic prior is re-estimated as
+     * an *asymmetric* \f$\mathbf{\alpha}\f$ via Minka's fixed-point
+     * update over the current topic assignments. Learned (rather than
+     * fixed symmetric) priors typically need fewer topics and fewer
+     * iterations to reach the same likelihood.
+     *
+     * @param period The number of iterations between updates (0
+     * disables optimization)
+     */
+    void optimize_alpha_every(uint64_t period);
+
   protected:
     /**
      * Samples a topic from the full conditional distribution
@@ -96,8 +148,32 @@ class lda_gibbs : public lda_model
      * @param term The term we are sampling a topic assignment for
      * @param doc The document the term resides in
      * @return the topic sampled the given (term, doc) pair
+     *
+     * The base implementation uses the SparseLDA decomposition of Yao,
+     * Mimno, and McCallum, splitting the full conditional into a
+     * smoothing-only bucket (whose mass is cached and updated as counts
+     * change), a document bucket over the topics present in the
+     * document, and a topic-word bucket over the topics in which the
+     * word occurs. The per-token cost is then proportional to the
+     * number of *nonzero* doc/word topic counts rather than the total
+     * number of topics. It assumes the symmetric Dirichlet priors set
+     * up by the constructor; subclasses whose counts live elsewhere
+     * (like parallel_lda_gibbs) should override this and fall back to
+     * sample_topic_dense().
+     */
+    virtual topic_id sample_topic(term_id term, doc_id doc);
+
+    /**
+     * Samples a topic from the full conditional by explicitly
+     * evaluating compute_sampling_weight() for every topic. This is the
+     * fallback for subclasses that override compute_sampling_weight()
+     * and thus invalidate the sparse bucket decomposition.
+     *
+     * @param term The term we are sampling a topic assignment for
+     * @param doc The document the term resides in
+     * @return the topic sampled the given (term, doc) pair
      */
-    topic_id sample_topic(term_id term, doc_id doc);
+    topic_id sample_topic_dense(term_id term, doc_id doc);
 
     /**
      * Computes a weight proportional to \f$P(z_i = j | w, \boldsymbol{z})\f$.
@@ -150,6 +226,11 @@ class lda_gibbs : public lda_model
 
     /**
      * @return \f$\log P(\mathbf{w} \mid \mathbf{z})\f$
+     *
+     * The value is maintained incrementally from the sampling deltas
+     * (every count update shifts it by a single log ratio), so querying
+     * it after each iteration for convergence monitoring is free rather
+     * than an extra full pass over the topic-term counts.
      */
     double corpus_log_likelihood() const;
 
@@ -187,6 +268,104 @@ class lda_gibbs : public lda_model
      * The random number generator for the sampler.
      */
     std::mt19937_64 rng_;
+
+    /**
+     * The initial symmetric Dirichlet hyperparameter for \f$\theta\f$.
+     * The live (possibly asymmetric, if optimize_alpha_every() was
+     * used) parameters are alpha_vec_; this value remains the pseudo
+     * counts baked into the theta_ priors and is subtracted back out
+     * wherever raw counts are needed.
+     */
+    double alpha_;
+
+    /**
+     * The symmetric Dirichlet hyperparameter for \f$\phi\f$.
+     */
+    double beta_;
+
+    /**
+     * The per-topic document-topic hyperparameters
+     * \f$\mathbf{\alpha}\f$. Initialized symmetric; updated in place
+     * by optimize_alpha().
+     */
+    std::vector<double> alpha_vec_;
+
+    /**
+     * The cached sum \f$\sum_t \alpha_t\f$.
+     */
+    double alpha_sum_;
+
+    /**
+     * The nonzero topic counts for each word, indexed by term_id and
+     * kept in sync with phi_. This is the inverted view of the
+     * topic-word counts that lets the sparse sampler (and the alias
+     * proposals in lda_light) touch only topics where
+     * \f$n_{w,t} > 0\f$.
+     */
+    std::vector<util::sparse_vector<topic_id, uint64_t>> word_topic_counts_;
+
+    /**
+     * The number of iterations already completed, either in this run or
+     * restored from a checkpoint. run() continues from here and skips
+     * initialization when nonzero.
+     */
+    uint64_t completed_iterations_ = 0;
+
+    /**
+     * The cached \f$\log P(\mathbf{w} \mid \mathbf{z})\f$ under the
+     * current counts, updated in {in,de}crease_counts(). Starts at 0,
+     * which is the exact value when all counts are empty.
+     */
+    double log_likelihood_ = 0;
+
+  private:
+    /**
+     * Recomputes the cached smoothing-bucket mass from scratch. Called
+     * once per iteration to bound the floating point drift from the
+     * incremental updates made in {in,de}crease_counts().
+     */
+    void refresh_smoothing_sum();
+
+    /**
+     * Re-estimates alpha_vec_ with Minka's fixed-point iteration over
+     * histograms of the current document-topic counts, then refreshes
+     * the cached smoothing mass.
+     */
+    void optimize_alpha();
+
+    /// Iterations between alpha updates; 0 disables optimization
+    uint64_t optimize_alpha_period_ = 0;
+
+    /**
+     * Snapshots the topic assignments and hands them to the checkpoint
+     * thread for writing, waiting for any still-outstanding write
+     * first.
+     */
+    void write_checkpoint_async();
+
+    /// Iterations between checkpoints; 0 disables checkpointing
+    uint64_t checkpoint_period_ = 0;
+
+    /// The prefix for the checkpoint file
+    std::string checkpoint_prefix_;
+
+    /// A single background thread for checkpoint writes
+    parallel::thread_pool checkpoint_pool_{1};
+
+    /// The in-flight checkpoint write, if any
+    std::future<void> checkpoint_future_;
+
+    /**
+     * Cached mass of the smoothing-only bucket,
+     * \f$\sum_t \alpha\beta / (V\beta + n_t)\f$.
+     */
+    double smoothing_sum_;
+
+    /// Scratch space for the document bucket of the sparse sampler.
+    std::vector<std::pair<topic_id, double>> doc_weights_;
+
+    /// Scratch space for the topic-word bucket of the sparse sampler.
+    std::vector<std::pair<topic_id, double>> word_weights_;
 };
 }
 }
@@ -0,0 +1,127 @@
+/**
+ * @file topics/lda_light.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_LDA_LIGHT_H_
+#define META_LDA_LIGHT_H_
+
+#include "meta/config.h"
+#include "meta/topics/lda_gibbs.h"
+#include "meta/util/alias_table.h"
+
+namespace meta
+{
+namespace topics
+{
+
+/**
+ * An LDA topic model implemented with the LightLDA sampler: a
+ * Metropolis-Hastings chain per token that alternates between a
+ * document proposal (drawn in O(1) from the current topic assignments)
+ * and a word proposal (drawn in O(1) from a per-word alias table over
+ * the nonzero topic counts, rebuilt lazily once per sweep). Acceptance
+ * is computed against the true collapsed conditional, so the stale
+ * proposals do not bias the chain. This gives O(1) amortized cost per
+ * token, which matters once the topic count grows past what even
+ * sparse samplers handle comfortably.
+ *
+ * @see https://arxiv.org/abs/1412.1576
+ */
+class lda_light : public lda_gibbs
+{
+  public:
+    /** use same constructor from base class */
+    using lda_gibbs::lda_gibbs;
+
+    /**
+     * Destructor: virtual for potential subclassing.
+     */
+    virtual ~lda_light() = default;
+
+    /**
+     * Restores the sampler from a checkpoint, additionally sizing the
+     * word proposal cache that initialize() would normally create.
+     */
+    virtual void resume(const std::string& filename) override;
+
+  protected:
+    /**
+     * Initializes the sampler with uniform random topic assignments.
+     * The online initialization used by the Gibbs samplers would cost
+     * O(K) per token; random initialization is the standard choice for
+     * Metropolis-Hastings samplers and mixes comparably.
+     */
+    virtual void initialize() override;
+
+    /**
+     * Performs a sweep of Metropolis-Hastings sampling over every
+     * token. This does not delegate to sample_topic(): the proposals
+     * need the topic being resampled to seed the chain, which the
+     * sample_topic() interface does not carry.
+     *
+     * @param iter The iteration number
+     * @param init Unused; initialization is fully random
+     */
+    virtual void perform_iteration(uint64_t iter, bool init = false) override;
+
+  private:
+    /**
+     * A cached proposal distribution for one word: an alias table over
+     * the snapshot of its nonzero topic counts plus the snapshot itself
+     * (needed to evaluate the proposal density in the acceptance
+     * ratio).
+     */
+    struct word_proposal
+    {
+        /// Alias table over the nonzero entries of counts
+        util::alias_table table;
+        /// The snapshot of n_{w,t} the table was built from
+        util::sparse_vector<topic_id, uint64_t> counts;
+        /// Total mass of the snapshot (sum of raw counts)
+        double mass = 0;
+        /// The sweep this proposal was built during (0 = never)
+        uint64_t sweep = 0;
+    };
+
+    /**
+     * Runs the per-token Metropolis-Hastings chain, alternating doc and
+     * word proposals, and returns the final state.
+     *
+     * @param term The term being resampled
+     * @param doc The document the term resides in
+     * @param old_topic The topic assignment being replaced (seeds the
+     * chain)
+     * @return the sampled topic
+     */
+    topic_id sample_topic_light(term_id term, doc_id doc, topic_id old_topic);
+
+    /**
+     * @return the word proposal for the given term, rebuilding it if it
+     * is stale for the current sweep
+     */
+    const word_proposal& proposal(term_id term);
+
+    /**
+     * @return the unnormalized collapsed conditional
+     * \f$(n_{d,t} + \alpha)(n_{w,t} + \beta) / (n_t + V\beta)\f$
+     */
+    double full_conditional(term_id term, doc_id doc, topic_id topic) const;
+
+    /// The cached word proposals, indexed by term_id
+    std::vector<word_proposal> proposals_;
+
+    /// The current sweep number, used to invalidate word proposals
+    uint64_t sweep_ = 0;
+
+    /// The number of Metropolis-Hastings steps per token
+    const uint64_t mh_steps_ = 4;
+};
+}
+}
+
+#endif
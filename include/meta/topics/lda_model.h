@@ -12,6 +12,8 @@
 
 #include "meta/config.h"
 #include "meta/index/forward_index.h"
+#include "meta/learn/instance.h"
+#include "meta/parallel/thread_pool.h"
 
 MAKE_NUMERIC_IDENTIFIER(topic_id, uint64_t)
 
@@ -25,7 +27,7 @@ namespace topics
  *
  * Required config parameters (for use with the ./lda executable):
  * ~~~toml
- * inference = "inference-method" # gibbs, pargibbs, cvb, scvb
+ * inference = "inference-method" # gibbs, pargibbs, lightlda, cvb, scvb
  * max-iters = 1000
  * alpha = 1.0
  * beta = 1.0
@@ -82,6 +84,30 @@ class lda_model
      */
     void save_topic_term_distributions(const std::string& filename) const;
 
+    /**
+     * Saves the topic proportions \f$\theta_d\f$ for each document to
+     * the given file as an io::flat_file: a "dims" section holding the
+     * number of documents and topics, and a "theta" section holding the
+     * dense probability matrix in document-major order. The matrix can
+     * be loaded zero-copy via flat_file::section_as<double>().
+     *
+     * @param filename The file to save \f$\theta\f$ to
+     */
+    void save_doc_topic_distributions_binary(const std::string& filename) const;
+
+    /**
+     * Saves the term distributions \f$\phi_j\f$ for each topic to the
+     * given file as an io::flat_file: a "dims" section holding the
+     * number of topics and terms, and a "phi" section holding the dense
+     * probability matrix in topic-major order. Unlike the plain-text
+     * format, this writes the raw probabilities rather than the
+     * normalized relevance scores.
+     *
+     * @param filename The file to save \f$\phi\f$ to
+     */
+    void
+    save_topic_term_distributions_binary(const std::string& filename) const;
+
     /**
      * Saves the current model to a set of files beginning with prefix:
      * prefix.phi, prefix.theta, and prefix.terms.
@@ -110,6 +136,39 @@ class lda_model
     virtual double compute_doc_topic_probability(doc_id doc,
                                                  topic_id topic) const = 0;
 
+    /**
+     * Infers the topic proportions for a single unseen document with
+     * fixed-model CVB0: the trained topic-term distributions are read
+     * through compute_term_topic_probability() and only the document's
+     * own tokens are iterated, so this is a lightweight hot path rather
+     * than a training run. Thread-safe as long as no training is in
+     * progress.
+     *
+     * @param doc The term vector of the document to infer topics for
+     * @param n_iters The number of CVB0 sweeps over the document
+     * @return the inferred topic distribution \f$\theta\f$
+     */
+    std::vector<double> infer(const learn::feature_vector& doc,
+                              uint64_t n_iters) const;
+
+    /**
+     * Batched variant of infer(), parallelized over the documents.
+     *
+     * @param docs The term vectors of the documents to infer topics for
+     * @param n_iters The number of CVB0 sweeps over each document
+     * @param pool The thread pool to parallelize over
+     * @return the inferred topic distribution for each document
+     */
+    std::vector<std::vector<double>>
+    infer(const std::vector<learn::feature_vector>& docs, uint64_t n_iters,
+          parallel::thread_pool& pool) const;
+
+    /**
+     * @return the symmetric Dirichlet hyperparameter \f$\alpha\f$ on
+     * the document-topic proportions; used by fixed-model inference
+     */
+    virtual double doc_topic_prior() const = 0;
+
     /**
      * @return the number of topics in this model
      */
@@ -11,7 +11,9 @@
 #define META_TOPICS_LDA_SCVB_H_
 
 #include "meta/config.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/topics/lda_model.h"
+#include "meta/util/sparse_vector.h"
 
 namespace meta
 {
@@ -23,6 +25,13 @@ namespace topics
  * variational Bayes for inference. Specifically, it uses the SCVB0
  * algorithm detailed in Foulds et. al.
  *
+ * Mini-batches are streamed directly from the forward_index postings in
+ * sequential disk order (wrapping around the corpus), and the next
+ * mini-batch is prefetched on a background thread while the current one
+ * is being processed. Only the K x V expected-counts matrix, the
+ * per-document topic counts, and the two in-flight mini-batch buffers
+ * are ever resident, so the corpus itself never needs to fit in memory.
+ *
  * @see http://dl.acm.org/citation.cfm?id=2487575.2487697
  */
 class lda_scvb : public lda_model
@@ -70,7 +79,29 @@ class lda_scvb : public lda_model
     virtual double compute_doc_topic_probability(doc_id doc,
                                                  topic_id topic) const override;
 
+    virtual double doc_topic_prior() const override;
+
   private:
+    /**
+     * A mini-batch of documents pulled from the forward_index: for each
+     * document, its id, its size, and a copy of its term counts. Copying
+     * the postings out lets the prefetch thread touch the index while
+     * the compute thread works purely from this buffer.
+     */
+    struct minibatch
+    {
+        /// One buffered document: (id, size, term counts)
+        struct document
+        {
+            doc_id id;
+            uint64_t size;
+            std::vector<std::pair<term_id, double>> counts;
+        };
+
+        /// The buffered documents for this mini-batch
+        std::vector<document> docs;
+    };
+
     /**
      * Initialize the model with random parameters.
      *
@@ -78,19 +109,105 @@ class lda_scvb : public lda_model
      */
     void initialize(std::mt19937& gen);
 
+    /**
+     * Reads the next minibatch_size_ documents (wrapping around the end
+     * of the corpus) from the forward_index in sequential disk order.
+     *
+     * @param start The document to start reading from
+     * @return the buffered mini-batch
+     */
+    minibatch load_minibatch(doc_id start) const;
+
     /**
      * Performs one iteration (e.g., one minibatch) of the inference algorithm.
      * @param iter The iteration number
-     * @param docs Contains the minibatch in indexes [0, minibatch_size_]
+     * @param batch The buffered mini-batch to process
      */
-    void perform_iteration(uint64_t iter, const std::vector<doc_id>& docs);
+    void perform_iteration(uint64_t iter, const minibatch& batch);
+
+    /**
+     * A single background thread used to prefetch the next mini-batch
+     * while the current one is being processed.
+     */
+    parallel::thread_pool prefetch_pool_{1};
+
+    /**
+     * Hybrid storage for the K x V expected topic-term counts: a dense
+     * block for a fixed-size set of hot words plus sparse rows for the
+     * long tail, with a per-topic scale factor so decaying a whole row
+     * by (1 - lr) is O(1) instead of O(V). For the heavy-tailed
+     * vocabularies we train on, the tail rows stay short and resident
+     * memory drops several-fold compared to a dense K x V matrix.
+     */
+    class topic_term_storage
+    {
+      public:
+        topic_term_storage() = default;
+
+        /**
+         * @param num_topics The number of topics (rows)
+         * @param num_words The vocabulary size
+         * @param hot_size The number of words stored densely
+         */
+        topic_term_storage(std::size_t num_topics, std::size_t num_words,
+                           std::size_t hot_size);
+
+        /**
+         * @return the expected count for the (topic, term) pair
+         */
+        double get(topic_id topic, term_id term) const;
+
+        /**
+         * Sets the expected count for the (topic, term) pair.
+         */
+        void set(topic_id topic, term_id term, double value);
+
+        /**
+         * Multiplies every entry of a topic's row by the given factor.
+         * O(1): the factor is folded into the row's scale and applied
+         * lazily on access.
+         */
+        void scale(topic_id topic, double factor);
+
+        /**
+         * Re-ranks the vocabulary by total expected mass across topics
+         * and rebuilds the hot set from the top words, migrating
+         * entries between the dense block and the sparse tail rows.
+         */
+        void rebucket();
+
+      private:
+        /// Sentinel for "not a hot word" in hot_slot_
+        static const uint64_t npos = static_cast<uint64_t>(-1);
+
+        /**
+         * Folds a row's scale factor back into its stored values;
+         * called when the scale risks underflow.
+         */
+        void materialize(topic_id topic);
+
+        /// Dense slot for each term, or npos if it is in the tail
+        std::vector<uint64_t> hot_slot_;
+
+        /// The term stored in each dense slot
+        std::vector<term_id> hot_words_;
+
+        /// Dense rows over the hot slots, indexed [topic][slot]
+        std::vector<std::vector<double>> dense_;
+
+        /// Sparse tail rows, indexed by topic
+        std::vector<util::sparse_vector<term_id, double>> sparse_;
+
+        /// Lazy per-topic multiplier over the stored values
+        std::vector<double> scale_;
+    };
 
     /**
      * Contains the expected counts for each word being assigned a given
-     * topic.  Indexed as `topic_term_count_[k][w]` where `k` is a
+     * topic, accessed as `topic_term_count_.get(k, w)` where `k` is a
      * `topic_id` and `w` is a `term_id`.
      */
-    std::vector<std::vector<double>> topic_term_count_;
+    topic_term_storage topic_term_count_;
 
     /**
      * Contains the expected counts for each topic being assigned in a
@@ -112,6 +229,9 @@ class lda_scvb : public lda_model
     const double beta_;
     /// The size of the minibatches
     const uint64_t minibatch_size_;
+
+    /// The number of minibatches between hot-set re-bucketing passes
+    const uint64_t rebucket_period_ = 100;
 };
 }
 }
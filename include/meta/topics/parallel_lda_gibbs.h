@@ -25,6 +25,14 @@ namespace topics
  * An LDA topic model implemented using the Approximate Distributed LDA
  * algorithm. Based on the algorithm detailed by David Newman et. al.
  *
+ * Every piece of state touched on the per-token sampling path is
+ * thread-local: each thread samples against its own topic-term count
+ * deltas, scratch weight buffer, and random number generator. The only
+ * shared writes during an iteration are the \f$\theta_d\f$ updates
+ * (each document is owned by exactly one thread) and an atomic progress
+ * counter; the count deltas are merged into the shared \f$\phi\f$
+ * counts once per iteration.
+ *
  * @see http://www.jmlr.org/papers/volume10/newman09a/newman09a.pdf
  */
 class parallel_lda_gibbs : public lda_gibbs
@@ -38,6 +46,13 @@ class parallel_lda_gibbs : public lda_gibbs
      */
     virtual ~parallel_lda_gibbs() = default;
 
+    /**
+     * Restores the sampler from a checkpoint, additionally setting up
+     * the per-thread sampling state that initialize() would normally
+     * create.
+     */
+    virtual void resume(const std::string& filename) override;
+
   protected:
     virtual void initialize() override;
 
@@ -55,29 +70,42 @@ class parallel_lda_gibbs : public lda_gibbs
      */
     virtual void perform_iteration(uint64_t iter, bool init = false) override;
 
-    virtual void decrease_counts(topic_id topic, term_id term,
-                                 doc_id doc) override;
+    /**
+     * The thread pool used for parallelization.
+     */
+    parallel::thread_pool pool_;
+
+  private:
+    /**
+     * Per-thread sampling state: the local topic-term count deltas
+     * (merged into phi_ once per iteration), a scratch buffer for the
+     * dense full conditional, and a private random number generator so
+     * threads never contend on (or race over) the shared one.
+     */
+    struct thread_state
+    {
+        /// Difference in topic-term counts, indexed by topic
+        std::vector<stats::multinomial<term_id>> phi_diff;
 
-    virtual void increase_counts(topic_id topic, term_id term,
-                                 doc_id doc) override;
+        /// Scratch space for the per-token full conditional
+        std::vector<double> weights;
 
-    virtual double compute_sampling_weight(term_id term, doc_id doc,
-                                           topic_id topic) const override;
+        /// This thread's private random number generator
+        std::mt19937_64 rng;
+    };
 
     /**
-     * The thread pool used for parallelization.
+     * Creates (or resets) the sampling state for each of the pool's
+     * threads.
      */
-    parallel::thread_pool pool_;
+    void init_thread_states();
 
     /**
-     * Stores the difference in topic_term counts on a per-thread basis
-     * for use in the reduction step.
-     *
-     * Indexed as [thread_id][topic]
+     * The per-thread sampling state, indexed by thread id. Populated
+     * once in initialize() or resume(); only read (never resized)
+     * during iterations, so concurrent lookups are safe.
      */
-    std::unordered_map<std::thread::id,
-                       std::vector<stats::multinomial<term_id>>>
-        phi_diffs_;
+    std::unordered_map<std::thread::id, thread_state> states_;
 };
 }
 }
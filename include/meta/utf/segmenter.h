@@ -45,6 +45,22 @@ class segmenter
          */
         segment(int32_t begin, int32_t end);
 
+        /**
+         * @return the starting index of the segment
+         */
+        int32_t begin() const
+        {
+            return begin_;
+        }
+
+        /**
+         * @return the ending index of the segment
+         */
+        int32_t end() const
+        {
+            return end_;
+        }
+
       private:
         friend segmenter;
         // using int32_t here because of ICU, which accepts only int32_t as
@@ -126,6 +142,21 @@ class segmenter
      */
     std::vector<segment> words(const segment& seg) const;
 
+    /**
+     * Bulk segmentation: obtains both the sentence and the word
+     * boundaries of the entire content in one pass. This is equivalent
+     * to calling sentences() and then words() on each sentence segment,
+     * but opens the ICU text buffer once for the whole document rather
+     * than once per sentence, and writes into caller-provided vectors
+     * so their storage can be reused from one document to the next.
+     *
+     * @param sentences Filled with the sentence segments of the content
+     * @param words Filled with the word segments of the content, in
+     * order; each word lies entirely within one sentence segment
+     */
+    void bulk_segment(std::vector<segment>& sentences,
+                      std::vector<segment>& words) const;
+
     /**
      * @return the content associated with a given segment as a utf-8
      * encoded string
@@ -0,0 +1,124 @@
+/**
+ * @file alias_table.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_ALIAS_TABLE_H_
+#define META_UTIL_ALIAS_TABLE_H_
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace util
+{
+
+/**
+ * An alias table for drawing samples from a discrete distribution in
+ * O(1) time after O(n) construction, using Vose's method.
+ *
+ * @see http://www.keithschwarz.com/darts-dice-coins/
+ */
+class alias_table
+{
+  public:
+    /**
+     * Constructs an empty table; operator() may not be called until a
+     * non-empty table has been assigned over it.
+     */
+    alias_table() = default;
+
+    /**
+     * Constructs the table from a list of (unnormalized) weights.
+     *
+     * @param weights The weight for each outcome; need not sum to one
+     */
+    explicit alias_table(const std::vector<double>& weights)
+        : prob_(weights.size()), alias_(weights.size())
+    {
+        double total = 0;
+        for (const auto& weight : weights)
+            total += weight;
+
+        std::vector<std::size_t> small;
+        std::vector<std::size_t> large;
+        small.reserve(weights.size());
+        large.reserve(weights.size());
+
+        for (std::size_t i = 0; i < weights.size(); ++i)
+        {
+            prob_[i] = weights[i] * weights.size() / total;
+            if (prob_[i] < 1.0)
+                small.push_back(i);
+            else
+                large.push_back(i);
+        }
+
+        while (!small.empty() && !large.empty())
+        {
+            auto less = small.back();
+            small.pop_back();
+            auto more = large.back();
+
+            alias_[less] = more;
+            prob_[more] = (prob_[more] + prob_[less]) - 1.0;
+            if (prob_[more] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+
+        // anything left over has probability (numerically) one
+        for (auto idx : large)
+            prob_[idx] = 1.0;
+        for (auto idx : small)
+            prob_[idx] = 1.0;
+    }
+
+    /**
+     * Draws an outcome index from the distribution.
+     *
+     * @param gen The random number generator to use
+     * @return an index in [0, size())
+     */
+    template <class Generator>
+    std::size_t operator()(Generator&& gen) const
+    {
+        std::uniform_real_distribution<double> dist{
+            0, static_cast<double>(prob_.size())};
+        auto draw = dist(gen);
+        auto idx = static_cast<std::size_t>(draw);
+        // use the fractional part of the draw for the coin flip to
+        // avoid consuming a second random number
+        if (draw - idx < prob_[idx])
+            return idx;
+        return alias_[idx];
+    }
+
+    /**
+     * @return the number of outcomes in the distribution
+     */
+    std::size_t size() const
+    {
+        return prob_.size();
+    }
+
+  private:
+    /// The probability of keeping each column's own outcome
+    std::vector<double> prob_;
+
+    /// The alias outcome for each column
+    std::vector<std::size_t> alias_;
+};
+}
+}
+#endif
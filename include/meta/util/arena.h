@@ -0,0 +1,207 @@
+/**
+ * @file arena.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_ARENA_H_
+#define META_UTIL_ARENA_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace util
+{
+
+/**
+ * A bump-pointer allocator over a chain of fixed-size blocks, for
+ * per-unit-of-work scratch memory that dies all at once. Allocation is a
+ * pointer increment; individual frees are no-ops; reset() rewinds the
+ * arena and reuses its blocks for the next unit of work, so steady-state
+ * processing performs no heap traffic at all.
+ *
+ * The arena itself is not thread safe; the intended pattern is one arena
+ * per worker thread (or per object processed), reset between units of
+ * work.
+ */
+class arena
+{
+  public:
+    /**
+     * @param block_size The size of each chained block; allocations
+     * larger than this get a dedicated block
+     */
+    explicit arena(std::size_t block_size = 64 * 1024)
+        : block_size_{block_size}, current_{0}, offset_{0}
+    {
+        blocks_.push_back(make_block(block_size_));
+    }
+
+    arena(arena&&) = default;
+    arena& operator=(arena&&) = default;
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    /**
+     * Allocates scratch memory from the arena. The memory is valid until
+     * reset() is called or the arena is destroyed.
+     *
+     * @param bytes The number of bytes to allocate
+     * @param align The required alignment
+     * @return the allocation
+     */
+    void* allocate(std::size_t bytes,
+                   std::size_t align = alignof(std::max_align_t))
+    {
+        auto* blk = &blocks_[current_];
+        auto base = reinterpret_cast<std::uintptr_t>(blk->data.get());
+        auto aligned = ((base + offset_ + align - 1) & ~(align - 1)) - base;
+        if (aligned + bytes > blk->size)
+        {
+            // move to the next block (reusing blocks retained by
+            // reset()), or chain a new one
+            ++current_;
+            if (current_ == blocks_.size())
+                blocks_.push_back(
+                    make_block(std::max(block_size_, bytes + align)));
+            else if (blocks_[current_].size < bytes + align)
+                blocks_[current_] = make_block(std::max(block_size_,
+                                                        bytes + align));
+            blk = &blocks_[current_];
+            base = reinterpret_cast<std::uintptr_t>(blk->data.get());
+            aligned = ((base + align - 1) & ~(align - 1)) - base;
+        }
+        offset_ = aligned + bytes;
+        return blk->data.get() + aligned;
+    }
+
+    /**
+     * Rewinds the arena to empty, retaining its blocks for reuse by the
+     * next unit of work. All outstanding allocations are invalidated.
+     */
+    void reset()
+    {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    /**
+     * @return the total bytes of block storage the arena currently owns
+     */
+    std::size_t capacity() const
+    {
+        std::size_t total = 0;
+        for (const auto& blk : blocks_)
+            total += blk.size;
+        return total;
+    }
+
+  private:
+    /// one chained allocation block
+    struct block
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    /**
+     * @param size The block size
+     * @return a freshly allocated block
+     */
+    static block make_block(std::size_t size)
+    {
+        return {std::unique_ptr<char[]>{new char[size]}, size};
+    }
+
+    /// the size used for new blocks
+    std::size_t block_size_;
+    /// the index of the block currently being bumped
+    std::size_t current_;
+    /// the bump offset within the current block
+    std::size_t offset_;
+    /// the chain of blocks
+    std::vector<block> blocks_;
+};
+
+/**
+ * A std-compatible allocator adapter over an arena, so standard
+ * containers can use arena scratch memory. A default-constructed
+ * arena_allocator falls back to the heap, which lets container members
+ * be declared with this allocator type while still supporting
+ * default-constructed (non-arena) instances.
+ *
+ * deallocate() is a no-op when arena-backed: memory is reclaimed by
+ * arena::reset(). Containers that grow geometrically will therefore
+ * leave their old buffers in the arena until the next reset; reserve
+ * up-front where sizes are known.
+ */
+template <class T>
+class arena_allocator
+{
+  public:
+    using value_type = T;
+
+    /**
+     * Constructs an allocator that falls back to the heap.
+     */
+    arena_allocator() = default;
+
+    /**
+     * Constructs an allocator drawing from the given arena, which must
+     * outlive every container using the allocator.
+     * @param a The arena to draw from
+     */
+    arena_allocator(arena& a) : arena_{&a}
+    {
+        // nothing
+    }
+
+    template <class U>
+    arena_allocator(const arena_allocator<U>& other) : arena_{other.arena_}
+    {
+        // nothing
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (arena_)
+            return static_cast<T*>(
+                arena_->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t)
+    {
+        if (!arena_)
+            ::operator delete(ptr);
+    }
+
+    /// the arena drawn from, or nullptr for the heap fallback
+    arena* arena_ = nullptr;
+};
+
+template <class T, class U>
+bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs)
+{
+    return lhs.arena_ == rhs.arena_;
+}
+
+template <class T, class U>
+bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+}
+}
+#endif
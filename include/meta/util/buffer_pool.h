@@ -0,0 +1,134 @@
+/**
+ * @file buffer_pool.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_BUFFER_POOL_H_
+#define META_UTIL_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "meta/config.h"
+#include "meta/util/shim.h"
+
+namespace meta
+{
+namespace util
+{
+
+/**
+ * A thread-caching freelist of byte buffers, bucketed into power-of-two
+ * size classes. Callers acquire() a buffer of at least the requested size
+ * and release() it back when done; buffers released on a thread are
+ * handed back out by later acquires on that thread instead of going
+ * through the allocator. This flattens the malloc/free churn of
+ * steady-state indexing, where short-lived buffers of the same few sizes
+ * are created and destroyed once per document.
+ *
+ * Each thread's cache is capped, and buffers larger than the biggest
+ * cached size class bypass the cache entirely, so idle threads hold only
+ * a bounded amount of recycled memory.
+ */
+class buffer_pool
+{
+  public:
+    /**
+     * Obtains a buffer of at least size bytes, reusing a cached buffer
+     * when one is available. The argument is rounded up in place to the
+     * capacity actually obtained, which must be passed back to release().
+     *
+     * @param size The minimum required size, in bytes; updated to the
+     * capacity of the returned buffer
+     * @return the buffer
+     */
+    static std::unique_ptr<uint8_t[]> acquire(std::size_t& size)
+    {
+        auto cls = size_class(size);
+        if (cls > max_class)
+            return make_unique<uint8_t[]>(size);
+
+        size = std::size_t{1} << cls;
+        auto& cache = local_cache();
+        auto& list = cache.lists[cls - min_class];
+        if (!list.empty())
+        {
+            auto buffer = std::move(list.back());
+            list.pop_back();
+            cache.cached_bytes -= size;
+            return buffer;
+        }
+        return make_unique<uint8_t[]>(size);
+    }
+
+    /**
+     * Returns a buffer obtained from acquire() to the calling thread's
+     * cache. Buffers outside the cached size classes, or arriving when
+     * the cache is at its byte cap, are simply freed.
+     *
+     * @param buffer The buffer to recycle
+     * @param size The capacity that acquire() reported for this buffer
+     */
+    static void release(std::unique_ptr<uint8_t[]> buffer, std::size_t size)
+    {
+        auto cls = size_class(size);
+        if (cls > max_class)
+            return;
+
+        auto& cache = local_cache();
+        if (cache.cached_bytes + size <= max_cached_bytes)
+        {
+            cache.lists[cls - min_class].push_back(std::move(buffer));
+            cache.cached_bytes += size;
+        }
+    }
+
+  private:
+    /// The smallest cached size class (\f$2^3 = 8\f$ bytes)
+    static const std::size_t min_class = 3;
+    /// The largest cached size class (\f$2^{16} = 64\f$ KiB)
+    static const std::size_t max_class = 16;
+    /// The maximum number of bytes cached per thread (4 MiB)
+    static const std::size_t max_cached_bytes = std::size_t{1} << 22;
+
+    /// The per-size-class freelists for one thread
+    struct thread_cache
+    {
+        /// One freelist per size class in [min_class, max_class]
+        std::vector<std::unique_ptr<uint8_t[]>>
+            lists[max_class - min_class + 1];
+        /// The total bytes currently held across all freelists
+        std::size_t cached_bytes = 0;
+    };
+
+    /**
+     * @param size A buffer size in bytes
+     * @return the index of the smallest power-of-two size class that can
+     * hold size bytes (at least min_class)
+     */
+    static std::size_t size_class(std::size_t size)
+    {
+        std::size_t cls = min_class;
+        while ((std::size_t{1} << cls) < size)
+            ++cls;
+        return cls;
+    }
+
+    /**
+     * @return the calling thread's cache
+     */
+    static thread_cache& local_cache()
+    {
+        static thread_local thread_cache cache;
+        return cache;
+    }
+};
+}
+}
+#endif
@@ -11,10 +11,13 @@
 #define META_UTIL_DENSE_MATRIX_H_
 
 #include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "meta/config.h"
 #include "meta/io/packed.h"
+#include "meta/util/aligned_allocator.h"
 
 namespace meta
 {
@@ -24,9 +27,10 @@ namespace util
 /**
  * Simple wrapper class for representing a dense matrix laid out in
  * row-major order (that is, its internal representation is a linear array
- * of the rows).
+ * of the rows). The allocator parameter allows the storage to be drawn
+ * from, e.g., a util::arena for short-lived matrices.
  */
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class dense_matrix
 {
   public:
@@ -66,6 +70,16 @@ class dense_matrix
      */
     dense_matrix(uint64_t rows, uint64_t columns);
 
+    /**
+     * Constructs a dense_matrix drawing its storage from the given
+     * allocator.
+     *
+     * @param rows The desired number of rows
+     * @param columns The desired number of columns
+     * @param alloc The allocator for the storage
+     */
+    dense_matrix(uint64_t rows, uint64_t columns, const Allocator& alloc);
+
     /**
      * Resizes the dense_matrix to have the specified number of rows and
      * columns. *All* elements are reset to be value initialized, not just
@@ -94,8 +108,9 @@ class dense_matrix
      */
     const T& operator()(uint64_t row, uint64_t column) const;
 
-    using row_iterator = typename std::vector<T>::iterator;
-    using const_row_iterator = typename std::vector<T>::const_iterator;
+    using row_iterator = typename std::vector<T, Allocator>::iterator;
+    using const_row_iterator =
+        typename std::vector<T, Allocator>::const_iterator;
 
     /**
      * @param row The row index
@@ -131,6 +146,28 @@ class dense_matrix
      */
     uint64_t columns() const;
 
+    /**
+     * Computes the transpose of the matrix using a blocked traversal,
+     * so both the source and destination are walked in cache-sized
+     * tiles instead of striding a full row apart on every element.
+     *
+     * @return the transposed matrix
+     */
+    dense_matrix transpose() const;
+
+    /**
+     * @return the sum of each row, indexed by row
+     */
+    std::vector<T> row_sums() const;
+
+    /**
+     * Computes the sum of each column in a single row-major pass, so no
+     * strided column walks are needed.
+     *
+     * @return the sum of each column, indexed by column
+     */
+    std::vector<T> column_sums() const;
+
     template <class OutputStream>
     friend uint64_t packed_write(OutputStream& os, const dense_matrix& mat)
     {
@@ -147,10 +184,245 @@ class dense_matrix
 
   private:
     /// the underlying storage for the matrix
-    std::vector<T> storage_;
+    std::vector<T, Allocator> storage_;
     /// the number of columns in the matrix
     uint64_t columns_;
 };
+
+/**
+ * A non-owning strided view over row-major matrix storage. The row
+ * stride may exceed the number of columns, which allows viewing padded
+ * storage (see padded_matrix) where each row begins on a cache-line
+ * boundary. Use matrix_view<const T> for read-only access.
+ */
+template <class T>
+class matrix_view
+{
+  public:
+    /**
+     * Creates a view over raw storage.
+     *
+     * @param data A pointer to the first element
+     * @param rows The number of rows
+     * @param columns The number of columns
+     * @param stride The number of elements between consecutive rows
+     */
+    matrix_view(T* data, uint64_t rows, uint64_t columns, uint64_t stride)
+        : data_{data}, rows_{rows}, columns_{columns}, stride_{stride}
+    {
+        // nothing
+    }
+
+    /**
+     * Creates an unpadded view over a dense_matrix.
+     *
+     * @param mat The matrix to view
+     */
+    template <class Allocator>
+    matrix_view(dense_matrix<typename std::remove_const<T>::type, Allocator>&
+                    mat)
+        : matrix_view{&mat(0, 0), mat.rows(), mat.columns(), mat.columns()}
+    {
+        // nothing
+    }
+
+    /**
+     * Creates an unpadded read-only view over a dense_matrix. Only
+     * available for matrix_view<const T>.
+     *
+     * @param mat The matrix to view
+     */
+    template <class Allocator,
+              class U = T,
+              class = typename std::enable_if<std::is_const<U>::value>::type>
+    matrix_view(const dense_matrix<typename std::remove_const<T>::type,
+                                   Allocator>& mat)
+        : matrix_view{&mat(0, 0), mat.rows(), mat.columns(), mat.columns()}
+    {
+        // nothing
+    }
+
+    /**
+     * Obtains the column-th element of the row-th row.
+     *
+     * @param row The row index
+     * @param column The column index
+     * @return a reference to the element at that position
+     */
+    T& operator()(uint64_t row, uint64_t column) const
+    {
+        return data_[row * stride_ + column];
+    }
+
+    /**
+     * @param row The row index
+     * @return a pointer to the start of the row-th row
+     */
+    T* begin(uint64_t row) const
+    {
+        return data_ + row * stride_;
+    }
+
+    /**
+     * @param row The row index
+     * @return a pointer to one past the last *column* of the row-th row
+     * (padding elements are not included)
+     */
+    T* end(uint64_t row) const
+    {
+        return data_ + row * stride_ + columns_;
+    }
+
+    /**
+     * @return the number of rows in the view
+     */
+    uint64_t rows() const
+    {
+        return rows_;
+    }
+
+    /**
+     * @return the number of columns in the view
+     */
+    uint64_t columns() const
+    {
+        return columns_;
+    }
+
+    /**
+     * @return the number of elements between consecutive rows
+     */
+    uint64_t stride() const
+    {
+        return stride_;
+    }
+
+  private:
+    /// the first element of the viewed storage
+    T* data_;
+    /// the number of rows
+    uint64_t rows_;
+    /// the number of columns
+    uint64_t columns_;
+    /// the number of elements between consecutive rows
+    uint64_t stride_;
+};
+
+/**
+ * A row-major matrix whose rows are padded out to cache-line
+ * boundaries and whose storage is cache-line aligned, so every row
+ * begins on its own cache line. Useful when different threads own
+ * different rows (no false sharing) and for vectorized kernels that
+ * want aligned row loads. Elements are value-initialized.
+ */
+template <class T>
+class padded_matrix
+{
+  public:
+    /// the cache line size assumed for padding, in bytes
+    const static constexpr uint64_t cache_line_size = 64;
+
+    /**
+     * Constructs a padded_matrix with the specified number of rows and
+     * columns.
+     *
+     * @param rows The desired number of rows
+     * @param columns The desired number of columns
+     */
+    padded_matrix(uint64_t rows, uint64_t columns)
+        : rows_{rows}, columns_{columns}, stride_{padded_stride(columns)},
+          storage_(rows * stride_)
+    {
+        // nothing
+    }
+
+    /**
+     * @param columns A number of columns
+     * @return the smallest stride >= columns that is a whole number of
+     * cache lines
+     */
+    static uint64_t padded_stride(uint64_t columns)
+    {
+        const auto per_line = cache_line_size / sizeof(T) > 0
+                                  ? cache_line_size / sizeof(T)
+                                  : 1;
+        return (columns + per_line - 1) / per_line * per_line;
+    }
+
+    /**
+     * Obtains the column-th element of the row-th row.
+     *
+     * @param row The row index
+     * @param column The column index
+     * @return a reference to the element at that position
+     */
+    T& operator()(uint64_t row, uint64_t column)
+    {
+        return storage_[row * stride_ + column];
+    }
+
+    /**
+     * Obtains the column-th element of the row-th row.
+     *
+     * @param row The row index
+     * @param column The column index
+     * @return a const reference to the element at that position
+     */
+    const T& operator()(uint64_t row, uint64_t column) const
+    {
+        return storage_[row * stride_ + column];
+    }
+
+    /**
+     * @return a strided view over the matrix
+     */
+    matrix_view<T> view()
+    {
+        return {storage_.data(), rows_, columns_, stride_};
+    }
+
+    /**
+     * @return a read-only strided view over the matrix
+     */
+    matrix_view<const T> view() const
+    {
+        return {storage_.data(), rows_, columns_, stride_};
+    }
+
+    /**
+     * @return the number of rows in the matrix
+     */
+    uint64_t rows() const
+    {
+        return rows_;
+    }
+
+    /**
+     * @return the number of columns in the matrix
+     */
+    uint64_t columns() const
+    {
+        return columns_;
+    }
+
+    /**
+     * @return the number of elements between consecutive rows
+     */
+    uint64_t stride() const
+    {
+        return stride_;
+    }
+
+  private:
+    /// the number of rows
+    uint64_t rows_;
+    /// the number of columns
+    uint64_t columns_;
+    /// the number of elements between consecutive rows
+    uint64_t stride_;
+    /// the cache-line aligned storage
+    aligned_vector<T> storage_;
+};
 }
 }
 
@@ -3,6 +3,9 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
+#include <numeric>
+
 #include "meta/util/dense_matrix.h"
 
 namespace meta
@@ -10,73 +13,131 @@ namespace meta
 namespace util
 {
 
-template <class T>
-dense_matrix<T>::dense_matrix(uint64_t rows, uint64_t columns)
+template <class T, class Allocator>
+dense_matrix<T, Allocator>::dense_matrix(uint64_t rows, uint64_t columns)
     : storage_(rows * columns), columns_{columns}
 {
     // nothing: use the fact that std::vector<T> value initializes all
     // elements on construction
 }
 
-template <class T>
-T& dense_matrix<T>::operator()(uint64_t row, uint64_t column)
+template <class T, class Allocator>
+dense_matrix<T, Allocator>::dense_matrix(uint64_t rows, uint64_t columns,
+                                         const Allocator& alloc)
+    : storage_(rows * columns, T{}, alloc), columns_{columns}
+{
+    // nothing
+}
+
+template <class T, class Allocator>
+T& dense_matrix<T, Allocator>::operator()(uint64_t row, uint64_t column)
 {
     return storage_[row * columns_ + column];
 }
 
-template <class T>
-const T& dense_matrix<T>::operator()(uint64_t row, uint64_t column) const
+template <class T, class Allocator>
+const T& dense_matrix<T, Allocator>::operator()(uint64_t row,
+                                                uint64_t column) const
 {
     return storage_[row * columns_ + column];
 }
 
-template <class T>
-void dense_matrix<T>::resize(uint64_t rows, uint64_t columns)
+template <class T, class Allocator>
+void dense_matrix<T, Allocator>::resize(uint64_t rows, uint64_t columns)
 {
     storage_.resize(rows * columns);
     std::fill(storage_.begin(), storage_.end(), T{});
     columns_ = columns;
 }
 
-template <class T>
-auto dense_matrix<T>::begin(uint64_t row) -> row_iterator
+template <class T, class Allocator>
+auto dense_matrix<T, Allocator>::begin(uint64_t row) -> row_iterator
 {
     using diff_type = typename row_iterator::difference_type;
     return storage_.begin() + static_cast<diff_type>(row * columns_);
 }
 
-template <class T>
-auto dense_matrix<T>::begin(uint64_t row) const -> const_row_iterator
+template <class T, class Allocator>
+auto dense_matrix<T, Allocator>::begin(uint64_t row) const
+    -> const_row_iterator
 {
     using diff_type = typename const_row_iterator::difference_type;
     return storage_.begin() + static_cast<diff_type>(row * columns_);
 }
 
-template <class T>
-auto dense_matrix<T>::end(uint64_t row) -> row_iterator
+template <class T, class Allocator>
+auto dense_matrix<T, Allocator>::end(uint64_t row) -> row_iterator
 {
     using diff_type = typename row_iterator::difference_type;
     return storage_.begin() + static_cast<diff_type>((row + 1) * columns_);
 }
 
-template <class T>
-auto dense_matrix<T>::end(uint64_t row) const -> const_row_iterator
+template <class T, class Allocator>
+auto dense_matrix<T, Allocator>::end(uint64_t row) const -> const_row_iterator
 {
     using diff_type = typename const_row_iterator::difference_type;
     return storage_.begin() + static_cast<diff_type>((row + 1) * columns_);
 }
 
-template <class T>
-uint64_t dense_matrix<T>::rows() const
+template <class T, class Allocator>
+uint64_t dense_matrix<T, Allocator>::rows() const
 {
     return storage_.size() / columns_;
 }
 
-template <class T>
-uint64_t dense_matrix<T>::columns() const
+template <class T, class Allocator>
+uint64_t dense_matrix<T, Allocator>::columns() const
 {
     return columns_;
 }
 
+template <class T, class Allocator>
+auto dense_matrix<T, Allocator>::transpose() const -> dense_matrix
+{
+    dense_matrix result{columns_, rows(), storage_.get_allocator()};
+
+    // tile the traversal so the strided writes into the result stay
+    // within a cache-sized block of rows at a time
+    const uint64_t block = 32;
+    auto num_rows = rows();
+    for (uint64_t rb = 0; rb < num_rows; rb += block)
+    {
+        auto rend = std::min(rb + block, num_rows);
+        for (uint64_t cb = 0; cb < columns_; cb += block)
+        {
+            auto cend = std::min(cb + block, columns_);
+            for (uint64_t r = rb; r < rend; ++r)
+                for (uint64_t c = cb; c < cend; ++c)
+                    result(c, r) = (*this)(r, c);
+        }
+    }
+    return result;
+}
+
+template <class T, class Allocator>
+std::vector<T> dense_matrix<T, Allocator>::row_sums() const
+{
+    std::vector<T> sums(rows());
+    for (uint64_t r = 0; r < sums.size(); ++r)
+        sums[r] = std::accumulate(begin(r), end(r), T{});
+    return sums;
+}
+
+template <class T, class Allocator>
+std::vector<T> dense_matrix<T, Allocator>::column_sums() const
+{
+    // accumulate row-major: every row pass walks both the storage and
+    // the sums vector sequentially
+    std::vector<T> sums(columns_);
+    auto num_rows = rows();
+    for (uint64_t r = 0; r < num_rows; ++r)
+    {
+        auto it = begin(r);
+        for (uint64_t c = 0; c < columns_; ++c, ++it)
+            sums[c] += *it;
+    }
+    return sums;
+}
+
 }
 }
@@ -110,6 +110,38 @@ class disk_vector
      */
     uint64_t size() const;
 
+    /**
+     * Hints to the OS that the mapping will be scanned sequentially. A
+     * no-op on platforms without madvise support.
+     */
+    void advise_sequential() const;
+
+    /**
+     * Hints to the OS that the mapping will be accessed at random
+     * indices, so speculative readahead around each fault is wasted
+     * work. A no-op on platforms without madvise support.
+     */
+    void advise_random() const;
+
+    /**
+     * Hints to the OS that the mapping should be backed by transparent
+     * huge pages where possible. A no-op on platforms without
+     * MADV_HUGEPAGE.
+     */
+    void advise_hugepage() const;
+
+    /**
+     * Hints to the OS to begin reading the given element range into the
+     * page cache in the background; the call returns immediately. Used
+     * at index open to pre-fault small, always-hot vectors (e.g. the
+     * vocabulary and metadata indexes) while larger structures stay
+     * lazily paged.
+     *
+     * @param begin_idx The index of the first element to read ahead
+     * @param count The number of elements to read ahead
+     */
+    void prefetch(uint64_t begin_idx, uint64_t count) const;
+
     using iterator = T*;
     using const_iterator = const T*;
 
@@ -5,6 +5,8 @@
 
 #include "meta/io/filesystem.h"
 #include "meta/util/disk_vector.h"
+#include "meta/util/memory_accounting.h"
+#include <algorithm>
 #include <sys/stat.h>
 
 namespace meta
@@ -63,6 +65,9 @@ disk_vector<T>::disk_vector(const std::string& path, uint64_t size /* = 0 */)
 
     if (start_ == MAP_FAILED)
         throw disk_vector_exception{"error memory-mapping the file " + path_};
+
+    memory::component("util::disk_vector (mapped)")
+        .allocated(sizeof(T) * size_);
 }
 
 template <class T>
@@ -85,6 +90,8 @@ disk_vector<T>& disk_vector<T>::operator=(disk_vector&& other)
             munmap(const_cast<typename std::remove_const<T>::type*>(start_),
                    sizeof(T) * size_);
             close(file_desc_);
+            memory::component("util::disk_vector (mapped)")
+                .released(sizeof(T) * size_);
         }
         path_ = std::move(other.path_);
         start_ = std::move(other.start_);
@@ -103,6 +110,8 @@ disk_vector<T>::~disk_vector()
     munmap(const_cast<typename std::remove_const<T>::type*>(start_),
            sizeof(T) * size_);
     close(file_desc_);
+    memory::component("util::disk_vector (mapped)")
+        .released(sizeof(T) * size_);
 }
 
 template <class T>
@@ -145,6 +154,58 @@ uint64_t disk_vector<T>::size() const
     return size_;
 }
 
+template <class T>
+void disk_vector<T>::advise_sequential() const
+{
+#ifdef MADV_SEQUENTIAL
+    if (start_)
+        madvise(const_cast<typename std::remove_const<T>::type*>(start_),
+                sizeof(T) * size_, MADV_SEQUENTIAL);
+#endif
+}
+
+template <class T>
+void disk_vector<T>::advise_random() const
+{
+#ifdef MADV_RANDOM
+    if (start_)
+        madvise(const_cast<typename std::remove_const<T>::type*>(start_),
+                sizeof(T) * size_, MADV_RANDOM);
+#endif
+}
+
+template <class T>
+void disk_vector<T>::advise_hugepage() const
+{
+#ifdef MADV_HUGEPAGE
+    if (start_)
+        madvise(const_cast<typename std::remove_const<T>::type*>(start_),
+                sizeof(T) * size_, MADV_HUGEPAGE);
+#endif
+}
+
+template <class T>
+void disk_vector<T>::prefetch(uint64_t begin_idx, uint64_t count) const
+{
+#ifdef MADV_WILLNEED
+    if (!start_ || begin_idx >= size_)
+        return;
+
+    auto offset = sizeof(T) * begin_idx;
+    auto length = sizeof(T) * std::min(count, size_ - begin_idx);
+
+    // madvise requires a page-aligned starting address
+    const uint64_t page_size = 4096;
+    auto aligned = offset & ~(page_size - 1);
+    auto base = reinterpret_cast<char*>(
+        const_cast<typename std::remove_const<T>::type*>(start_));
+    madvise(base + aligned, length + (offset - aligned), MADV_WILLNEED);
+#else
+    (void)begin_idx;
+    (void)count;
+#endif
+}
+
 template <class T>
 template <class, class>
 auto disk_vector<T>::begin() -> iterator
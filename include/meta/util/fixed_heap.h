@@ -44,6 +44,18 @@ class fixed_heap
      */
     fixed_heap(uint64_t max_elems, Comp comp);
 
+    /**
+     * Constructs a heap that adopts an existing buffer for its storage,
+     * reusing its capacity. The buffer is cleared; its elements are not
+     * candidates. Callers that pool their result vectors can pass them
+     * back in here to make repeated top-k extraction allocation-free.
+     *
+     * @param max_elems
+     * @param comp The priority comparison function for elements in this heap
+     * @param buffer The buffer to adopt as backing storage
+     */
+    fixed_heap(uint64_t max_elems, Comp comp, std::vector<T>&& buffer);
+
     /**
      * @param elem The element to insert; it may or may not be inserted
      * depending on the size and priority of other elements in the heap
@@ -57,6 +69,38 @@ class fixed_heap
     template <class... Args>
     void emplace(Args&&... args);
 
+    /**
+     * Inserts a batch of candidates. Once the heap is full, each candidate
+     * is filtered against the current threshold with a single comparison
+     * before any heap operation is performed, so batches dominated by
+     * low-priority elements are cheap.
+     *
+     * @param first The beginning of the range of candidates
+     * @param last The end of the range of candidates
+     */
+    template <class ForwardIterator>
+    void insert(ForwardIterator first, ForwardIterator last);
+
+    /**
+     * @return whether this heap has reached max_elems() elements
+     */
+    bool full() const;
+
+    /**
+     * @return the lowest-priority element currently retained: the
+     * threshold a new candidate must beat to enter the heap. This is a
+     * constant-time read (the root of the min-heap) intended for
+     * WAND-style pruning in scoring loops; the heap must be non-empty.
+     */
+    const T& top() const;
+
+    /**
+     * @param elem The candidate element
+     * @return whether pushing elem would modify the heap, at the cost of
+     * (at most) a single comparison
+     */
+    bool would_push(const T& elem) const;
+
     /**
      * @return the current number of elements in this heap; will always be less
      * than or equal to max_elems()
@@ -74,6 +118,14 @@ class fixed_heap
      */
     std::vector<T> extract_top();
 
+    /**
+     * Clears the heap and returns the top elements in sorted order,
+     * sorting the buffer directly instead of popping the heap
+     * element-by-element.
+     * @return the top elements in sorted order
+     */
+    std::vector<T> finalize_sorted();
+
     /**
      * @return a const_iterator to the beginning of the fixed_heap
      * @note the heap is not fully sorted
@@ -103,6 +155,20 @@ fixed_heap<T, BinaryFunction> make_fixed_heap(uint64_t max_elems,
     return fixed_heap<T, BinaryFunction>(max_elems,
                                          std::forward<BinaryFunction>(bf));
 }
+
+/**
+ * Constructs a fixed_heap that adopts an existing (cleared) buffer for
+ * its storage, reusing its capacity.
+ */
+template <class T, class BinaryFunction>
+fixed_heap<T, BinaryFunction> make_fixed_heap(uint64_t max_elems,
+                                              BinaryFunction&& bf,
+                                              std::vector<T>&& buffer)
+{
+    return fixed_heap<T, BinaryFunction>(max_elems,
+                                         std::forward<BinaryFunction>(bf),
+                                         std::move(buffer));
+}
 }
 }
 
@@ -17,31 +17,88 @@ fixed_heap<T, Comp>::fixed_heap(uint64_t max_elems, Comp comp)
     // nothing
 }
 
+template <class T, class Comp>
+fixed_heap<T, Comp>::fixed_heap(uint64_t max_elems, Comp comp,
+                                std::vector<T>&& buffer)
+    : max_elems_{max_elems}, comp_(comp), pq_{std::move(buffer)}
+{
+    pq_.clear();
+}
+
 template <class T, class Comp>
 template <class... Args>
 void fixed_heap<T, Comp>::emplace(Args&&... args)
 {
-    pq_.emplace_back(std::forward<Args>(args)...);
-    std::push_heap(pq_.begin(), pq_.end(), comp_);
-    if (size() > max_elems())
+    if (max_elems_ == 0)
+        return;
+    if (full())
     {
+        T elem(std::forward<Args>(args)...);
+        // single-comparison rejection: the common case in top-k scoring
+        if (!comp_(elem, pq_.front()))
+            return;
         std::pop_heap(pq_.begin(), pq_.end(), comp_);
-        pq_.pop_back();
+        pq_.back() = std::move(elem);
+        std::push_heap(pq_.begin(), pq_.end(), comp_);
+    }
+    else
+    {
+        pq_.emplace_back(std::forward<Args>(args)...);
+        std::push_heap(pq_.begin(), pq_.end(), comp_);
     }
 }
 
 template <class T, class Comp>
 void fixed_heap<T, Comp>::push(const T& elem)
 {
-    pq_.push_back(elem);
-    std::push_heap(pq_.begin(), pq_.end(), comp_);
-    if (size() > max_elems())
+    if (max_elems_ == 0)
+        return;
+    if (full())
     {
+        // single-comparison rejection: the common case in top-k scoring
+        if (!comp_(elem, pq_.front()))
+            return;
         std::pop_heap(pq_.begin(), pq_.end(), comp_);
-        pq_.pop_back();
+        pq_.back() = elem;
+        std::push_heap(pq_.begin(), pq_.end(), comp_);
+    }
+    else
+    {
+        pq_.push_back(elem);
+        std::push_heap(pq_.begin(), pq_.end(), comp_);
     }
 }
 
+template <class T, class Comp>
+template <class ForwardIterator>
+void fixed_heap<T, Comp>::insert(ForwardIterator first, ForwardIterator last)
+{
+    if (!full())
+        pq_.reserve(max_elems_ + 1);
+    for (; first != last; ++first)
+        push(*first);
+}
+
+template <class T, class Comp>
+bool fixed_heap<T, Comp>::full() const
+{
+    return size() >= max_elems_;
+}
+
+template <class T, class Comp>
+const T& fixed_heap<T, Comp>::top() const
+{
+    return pq_.front();
+}
+
+template <class T, class Comp>
+bool fixed_heap<T, Comp>::would_push(const T& elem) const
+{
+    if (max_elems_ == 0)
+        return false;
+    return !full() || comp_(elem, pq_.front());
+}
+
 template <class T, class Comp>
 auto fixed_heap<T, Comp>::size() const -> size_type
 {
@@ -57,13 +114,16 @@ auto fixed_heap<T, Comp>::max_elems() const -> size_type
 template <class T, class Comp>
 std::vector<T> fixed_heap<T, Comp>::extract_top()
 {
-    using diff_type = typename decltype(pq_.begin())::difference_type;
-    for (size_type i = 0; i < pq_.size(); ++i)
-        std::pop_heap(pq_.begin(), pq_.end() - static_cast<diff_type>(i),
-                      comp_);
+    return finalize_sorted();
+}
 
+template <class T, class Comp>
+std::vector<T> fixed_heap<T, Comp>::finalize_sorted()
+{
+    // a direct sort of the buffer beats popping the heap k times
+    std::sort(pq_.begin(), pq_.end(), comp_);
     std::vector<T> result = std::move(pq_);
-    assert(pq_.empty());
+    pq_.clear();
     return result;
 }
 
@@ -0,0 +1,296 @@
+/**
+ * @file memory_accounting.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_MEMORY_ACCOUNTING_H_
+#define META_UTIL_MEMORY_ACCOUNTING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "meta/config.h"
+
+namespace meta
+{
+namespace memory
+{
+
+/**
+ * Live/peak byte counters for one component of the toolkit. Updates are
+ * relaxed atomics, cheap enough to leave on in production; the intended
+ * use is attributing an OOM (or a steadily climbing resident set) to
+ * the subsystem that owns the bytes, not exact heap bookkeeping.
+ *
+ * Accounts are created through component() and live for the duration of
+ * the program.
+ */
+class account
+{
+  public:
+    /**
+     * @param name The name this account reports under
+     */
+    explicit account(std::string name) : name_{std::move(name)}
+    {
+        // nothing
+    }
+
+    account(const account&) = delete;
+    account& operator=(const account&) = delete;
+
+    /**
+     * Charges bytes to this account.
+     * @param bytes The number of bytes that were allocated
+     */
+    void allocated(std::size_t bytes)
+    {
+        auto live = live_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto peak = peak_.load(std::memory_order_relaxed);
+        while (live > peak
+               && !peak_.compare_exchange_weak(peak, live,
+                                               std::memory_order_relaxed))
+        {
+            // racing update lost; peak was reloaded by the exchange
+        }
+    }
+
+    /**
+     * Releases bytes from this account.
+     * @param bytes The number of bytes that were freed
+     */
+    void released(std::size_t bytes)
+    {
+        live_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    const std::string& name() const
+    {
+        return name_;
+    }
+
+    /**
+     * @return the bytes currently charged to this account
+     */
+    uint64_t live() const
+    {
+        return live_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return the largest number of bytes ever simultaneously charged to
+     * this account
+     */
+    uint64_t peak() const
+    {
+        return peak_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// the name this account reports under
+    const std::string name_;
+    /// the bytes currently charged
+    std::atomic<uint64_t> live_{0};
+    /// the high-water mark of live_
+    std::atomic<uint64_t> peak_{0};
+};
+
+/**
+ * Fetches (creating on first use) the account for the named component.
+ * The lookup takes a lock, so callers on hot paths should fetch once
+ * and keep the reference; the returned account is valid forever.
+ *
+ * @param name The component name, e.g. "util::disk_vector"
+ * @return the account for that component
+ */
+account& component(const std::string& name);
+
+/**
+ * An allocator adapter that charges its allocations to a component
+ * account and forwards the storage itself to an underlying allocator.
+ * Drop-in for any container with an allocator parameter (dense_matrix,
+ * the hash storages, std::vector) when its memory should show up in
+ * memory_report().
+ */
+template <class T, class BaseAlloc = std::allocator<T>>
+class tracking_allocator
+{
+  public:
+    using value_type = T;
+
+    /**
+     * @param acct The account to charge
+     * @param base The allocator that provides the storage
+     */
+    explicit tracking_allocator(account& acct,
+                                const BaseAlloc& base = BaseAlloc{})
+        : acct_{&acct}, base_{base}
+    {
+        // nothing
+    }
+
+    template <class U, class UBase>
+    tracking_allocator(const tracking_allocator<U, UBase>& other)
+        : acct_{&other.charged_account()}, base_{other.base()}
+    {
+        // nothing
+    }
+
+    template <class U>
+    struct rebind
+    {
+        using other = tracking_allocator<
+            U, typename std::allocator_traits<BaseAlloc>::template rebind_alloc<U>>;
+    };
+
+    T* allocate(std::size_t n)
+    {
+        auto ptr = base_.allocate(n);
+        acct_->allocated(n * sizeof(T));
+        return ptr;
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        base_.deallocate(p, n);
+        acct_->released(n * sizeof(T));
+    }
+
+    account& charged_account() const
+    {
+        return *acct_;
+    }
+
+    const BaseAlloc& base() const
+    {
+        return base_;
+    }
+
+  private:
+    /// the account charged for this allocator's storage
+    account* acct_;
+    /// the allocator that provides the storage
+    BaseAlloc base_;
+};
+
+template <class T, class U, class TBase, class UBase>
+bool operator==(const tracking_allocator<T, TBase>& a,
+                const tracking_allocator<U, UBase>& b)
+{
+    return &a.charged_account() == &b.charged_account()
+           && a.base() == b.base();
+}
+
+template <class T, class U, class TBase, class UBase>
+bool operator!=(const tracking_allocator<T, TBase>& a,
+                const tracking_allocator<U, UBase>& b)
+{
+    return !(a == b);
+}
+
+/**
+ * Charges bytes to an account for as long as the holder lives, for
+ * components whose footprint is easier to estimate in bulk than to
+ * intercept allocation by allocation (e.g. a loaded dataset). Copies
+ * charge the same amount again, mirroring the copied storage.
+ */
+class scoped_charge
+{
+  public:
+    /**
+     * @param acct The account to charge
+     */
+    explicit scoped_charge(account& acct) : acct_{&acct}, bytes_{0}
+    {
+        // nothing
+    }
+
+    scoped_charge(const scoped_charge& other)
+        : acct_{other.acct_}, bytes_{0}
+    {
+        add(other.bytes_);
+    }
+
+    scoped_charge(scoped_charge&& other)
+        : acct_{other.acct_}, bytes_{other.bytes_}
+    {
+        other.bytes_ = 0;
+    }
+
+    scoped_charge& operator=(scoped_charge other)
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~scoped_charge()
+    {
+        release();
+    }
+
+    void swap(scoped_charge& other)
+    {
+        std::swap(acct_, other.acct_);
+        std::swap(bytes_, other.bytes_);
+    }
+
+    /**
+     * @param bytes Additional bytes to charge until destruction
+     */
+    void add(std::size_t bytes)
+    {
+        acct_->allocated(bytes);
+        bytes_ += bytes;
+    }
+
+    /**
+     * Releases everything charged so far, before destruction.
+     */
+    void release()
+    {
+        acct_->released(bytes_);
+        bytes_ = 0;
+    }
+
+  private:
+    /// the account charged
+    account* acct_;
+    /// the bytes charged so far
+    std::size_t bytes_;
+};
+
+/**
+ * One component's row in a memory report.
+ */
+struct report_entry
+{
+    std::string name;
+    uint64_t live;
+    uint64_t peak;
+};
+
+/**
+ * @return every component's live and peak bytes, sorted by descending
+ * live bytes
+ */
+std::vector<report_entry> memory_report();
+
+/**
+ * Writes every component's live and peak bytes to the given stream,
+ * sorted by descending live bytes.
+ *
+ * @param os The stream to report to
+ */
+void memory_report(std::ostream& os);
+}
+}
+#endif
@@ -11,6 +11,7 @@
 #define META_UTIL_MULTIWAY_MERGE_H_
 
 #include <cstdint>
+#include <future>
 #include <iterator>
 #include <numeric>
 #include <utility>
@@ -21,6 +22,8 @@
 #include "meta/io/mmap_file.h"
 #include "meta/io/moveable_stream.h"
 #include "meta/io/packed.h"
+#include "meta/parallel/thread_pool.h"
+#include "meta/util/profile.h"
 #include "meta/util/progress.h"
 
 namespace meta
@@ -28,6 +31,107 @@ namespace meta
 namespace util
 {
 
+namespace detail
+{
+
+/**
+ * A tournament (loser) tree over the head Records of a set of
+ * ChunkIterators. Extracting the minimum and replaying the tournament
+ * after its chunk advances costs O(log chunks) comparisons per output
+ * Record, instead of the O(chunks log chunks) re-sort the merge loop
+ * used to do. Ties between chunks are broken by chunk index, so the
+ * merge order (and thus the output) is deterministic.
+ */
+template <class ChunkIterator, class Compare>
+class loser_tree
+{
+  public:
+    loser_tree(std::vector<std::reference_wrapper<ChunkIterator>>& chunks,
+               Compare& comp)
+        : chunks_(chunks), comp_(comp), num_leaves_{1}
+    {
+        while (num_leaves_ < std::max<std::size_t>(1, chunks_.size()))
+            num_leaves_ <<= 1;
+        losers_.assign(num_leaves_, chunks_.size());
+        losers_[0] = run_tournament(1);
+    }
+
+    /**
+     * @return whether the winning chunk still has a Record to consume
+     */
+    bool has_winner() const
+    {
+        return alive(losers_[0]);
+    }
+
+    /**
+     * @return the index of the chunk holding the smallest head Record
+     */
+    std::size_t winner() const
+    {
+        return losers_[0];
+    }
+
+    /**
+     * Replays the matches along the winner's path to the root after its
+     * chunk has been advanced (or exhausted).
+     */
+    void replay()
+    {
+        auto winner = losers_[0];
+        for (auto node = (num_leaves_ + winner) / 2; node >= 1; node /= 2)
+        {
+            if (before(losers_[node], winner))
+                std::swap(winner, losers_[node]);
+        }
+        losers_[0] = winner;
+    }
+
+  private:
+    /// @return the winner of the subtree rooted at node, recording losers
+    std::size_t run_tournament(std::size_t node)
+    {
+        if (node >= num_leaves_)
+            return node - num_leaves_;
+
+        auto left = run_tournament(2 * node);
+        auto right = run_tournament(2 * node + 1);
+        if (before(right, left))
+            std::swap(left, right);
+        losers_[node] = right;
+        return left;
+    }
+
+    /// @return whether chunk idx exists and still has a Record
+    bool alive(std::size_t idx) const
+    {
+        return idx < chunks_.size()
+               && !(chunks_[idx].get() == ChunkIterator{});
+    }
+
+    /// @return whether chunk a's head Record precedes chunk b's
+    bool before(std::size_t a, std::size_t b) const
+    {
+        if (!alive(a))
+            return false;
+        if (!alive(b))
+            return true;
+        if (comp_(*chunks_[a].get(), *chunks_[b].get()))
+            return true;
+        if (comp_(*chunks_[b].get(), *chunks_[a].get()))
+            return false;
+        return a < b;
+    }
+
+    std::vector<std::reference_wrapper<ChunkIterator>>& chunks_;
+    Compare& comp_;
+    /// number of leaves (chunk slots) in the tree, a power of two
+    std::size_t num_leaves_;
+    /// loser indexes per internal node; slot 0 holds the overall winner
+    std::vector<std::size_t> losers_;
+};
+}
+
 /**
  * A generic algorithm for performing an N-way merge on a collection of
  * sorted "chunks".
@@ -120,47 +224,41 @@ uint64_t multiway_merge(ForwardIterator begin, ForwardIterator end,
     for (; begin != end; ++begin)
         to_merge.emplace_back(*begin);
 
-    auto chunk_iter_comp = [&](const ChunkIterator& a, const ChunkIterator& b) {
-        return record_comp(*a, *b);
+    detail::loser_tree<ChunkIterator, Compare> tree{to_merge, record_comp};
+
+    auto advance = [&](std::size_t idx) {
+        auto& iter = to_merge[idx].get();
+        auto before = iter.bytes_read();
+        ++iter;
+        total_read += iter.bytes_read() - before;
     };
 
     uint64_t unique_records = 0;
-    while (!to_merge.empty())
+    while (tree.has_winner())
     {
+        META_PROFILE_SCOPE("multiway_merge::record");
         progress(total_read);
         ++unique_records;
+        META_PROFILE_COUNT("multiway_merge::records", 1);
 
-        std::sort(to_merge.begin(), to_merge.end(), chunk_iter_comp);
-
-        // gather all Records that match the smallest Record, reading in a
-        // new Record from the corresponding ChunkIterator
-        auto range = std::equal_range(to_merge.begin(), to_merge.end(),
-                                      to_merge.front(), chunk_iter_comp);
-
-        auto merged = std::move(*(*range.first).get());
-        auto before = (*range.first).get().bytes_read();
-        ++(*range.first).get();
-        total_read += ((*range.first).get().bytes_read() - before);
-        ++range.first;
-        std::for_each(range.first, range.second, [&](ChunkIterator& iter) {
-            if (should_merge(merged, *iter))
-            {
-                merged.merge_with(std::move(*iter));
-                auto before = iter.bytes_read();
-                ++iter;
-                total_read += (iter.bytes_read() - before);
-            }
-        });
+        // extract the smallest Record, then keep merging in the new
+        // minimum for as long as it matches
+        auto idx = tree.winner();
+        auto merged = std::move(*to_merge[idx].get());
+        advance(idx);
+        tree.replay();
+
+        while (tree.has_winner()
+               && should_merge(merged, *to_merge[tree.winner()].get()))
+        {
+            auto next = tree.winner();
+            merged.merge_with(std::move(*to_merge[next].get()));
+            advance(next);
+            tree.replay();
+        }
 
         // write out merged record
         output(std::move(merged));
-
-        // remove all empty ChunkIterators from the input
-        to_merge.erase(std::remove_if(to_merge.begin(), to_merge.end(),
-                                      [](const ChunkIterator& iter) {
-                                          return iter == ChunkIterator{};
-                                      }),
-                       to_merge.end());
     }
 
     return unique_records;
@@ -183,6 +281,51 @@ uint64_t multiway_merge(ForwardIterator begin, ForwardIterator end,
                           std::forward<RecordHandler>(output), ProgressTrait{});
 }
 
+/**
+ * Runs several independent multiway_merges concurrently, one per group
+ * of chunks. Useful when a caller has partitioned its records into
+ * disjoint groups (e.g. by key range) whose merges do not interact: the
+ * groups then merge in parallel instead of back to back.
+ *
+ * GroupForwardIterator must dereference to a container of ChunkIterators.
+ * HandlerFactory is called (from the submitting thread) with each
+ * group's index and must return the RecordHandler to use for that group;
+ * the handlers run concurrently, so they must not share mutable state
+ * without synchronization. Per-merge progress output is suppressed.
+ *
+ * @param begin The beginning of the range of chunk groups
+ * @param end The end of the range of chunk groups
+ * @param make_handler The factory for per-group RecordHandlers
+ * @param num_threads The maximum number of concurrent merges
+ * @return the total number of unique Records written across all groups
+ */
+template <class GroupForwardIterator, class HandlerFactory>
+uint64_t concurrent_multiway_merge(
+    GroupForwardIterator begin, GroupForwardIterator end,
+    HandlerFactory&& make_handler,
+    std::size_t num_threads = std::thread::hardware_concurrency())
+{
+    parallel::thread_pool pool{std::max<std::size_t>(1, num_threads)};
+
+    std::vector<std::future<uint64_t>> results;
+    std::size_t group_idx = 0;
+    for (; begin != end; ++begin, ++group_idx)
+    {
+        auto* group = &*begin;
+        auto handler = make_handler(group_idx);
+        results.emplace_back(pool.submit_task([group, handler]() mutable {
+            return multiway_merge(std::begin(*group), std::end(*group),
+                                  std::move(handler),
+                                  printing::no_progress_trait{});
+        }));
+    }
+
+    uint64_t unique_records = 0;
+    for (auto& result : results)
+        unique_records += result.get();
+    return unique_records;
+}
+
 /**
  * A simple implementation of the ChunkIterator concept that reads Records
  * from a binary file using io::packed::read.
@@ -201,7 +344,8 @@ class chunk_iterator
     chunk_iterator(const std::string& filename)
         : input_{filename},
           bytes_read_{0},
-          total_bytes_{filesystem::file_size(filename)}
+          total_bytes_{filesystem::file_size(filename)},
+          next_prefetch_{0}
     {
         ++(*this);
     }
@@ -223,6 +367,14 @@ class chunk_iterator
             return *this;
         }
 
+        // keep half a window of readahead in flight ahead of the scan
+        // so record decoding overlaps the next window's disk reads
+        if (next_prefetch_ < bytes_read_ + prefetch_window() / 2)
+        {
+            input_.prefetch(next_prefetch_, prefetch_window());
+            next_prefetch_ += prefetch_window();
+        }
+
         bytes_read_ += io::packed::read(input_, record_);
         return *this;
     }
@@ -260,10 +412,17 @@ class chunk_iterator
     }
 
   private:
+    /// The size of the OS readahead window issued ahead of the scan
+    constexpr static uint64_t prefetch_window()
+    {
+        return 1024 * 1024;
+    }
+
     io::mmap_ifstream input_;
     Record record_;
     uint64_t bytes_read_;
     uint64_t total_bytes_;
+    uint64_t next_prefetch_;
 };
 
 template <class Record>
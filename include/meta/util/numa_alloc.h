@@ -0,0 +1,96 @@
+/**
+ * @file numa_alloc.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ *
+ * Page-granular allocation helpers that place memory on a specific NUMA
+ * node, for owner-computes data layouts with the NUMA-pinned thread pool
+ * (see parallel/numa.h). On platforms without memory-policy support the
+ * node argument is ignored and placement falls back to the OS default
+ * (first touch on Linux), so callers need no platform checks.
+ */
+
+#ifndef META_UTIL_NUMA_ALLOC_H_
+#define META_UTIL_NUMA_ALLOC_H_
+
+#include <cstddef>
+#include <cstdlib>
+
+#include "meta/config.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace meta
+{
+namespace util
+{
+
+/**
+ * Allocates zero-initialized, page-aligned memory preferentially placed
+ * on the given memory node. Memory from this function must be released
+ * with numa_free().
+ *
+ * The placement policy is "preferred" rather than strict: if the node's
+ * memory is exhausted the kernel falls back to another node instead of
+ * failing the allocation.
+ *
+ * @param size The number of bytes to allocate
+ * @param node The memory node to place the pages on
+ * @return the allocation, or nullptr on failure
+ */
+inline void* numa_alloc_on_node(std::size_t size, std::size_t node)
+{
+#ifndef _WIN32
+    void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+        return nullptr;
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 8 * sizeof(unsigned long))
+    {
+        // MPOL_PREFERRED == 1; called via syscall() to avoid a hard
+        // libnuma dependency. Failure just means default placement.
+        unsigned long nodemask = 1UL << node;
+        ::syscall(SYS_mbind, ptr, size, 1, &nodemask,
+                  8 * sizeof(nodemask), 0);
+    }
+#else
+    (void)node;
+#endif
+    return ptr;
+#else
+    (void)node;
+    return std::calloc(1, size);
+#endif
+}
+
+/**
+ * Releases memory obtained from numa_alloc_on_node().
+ *
+ * @param ptr The allocation to release
+ * @param size The size passed at allocation time
+ */
+inline void numa_free(void* ptr, std::size_t size)
+{
+    if (!ptr)
+        return;
+#ifndef _WIN32
+    ::munmap(ptr, size);
+#else
+    (void)size;
+    std::free(ptr);
+#endif
+}
+}
+}
+#endif
@@ -0,0 +1,269 @@
+/**
+ * @file profile.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_PROFILE_H_
+#define META_UTIL_PROFILE_H_
+
+#include <iosfwd>
+
+#include "meta/config.h"
+
+#if META_PROFILE_HOOKS
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "meta/stats/dd_sketch.h"
+#include "meta/stats/running_stats.h"
+#endif
+
+namespace meta
+{
+namespace profile
+{
+
+#if META_PROFILE_HOOKS
+
+/// the sampling period for scoped timers: one in every this many
+/// executions of an instrumented scope (per thread) is timed
+const constexpr uint64_t sample_period = 1000;
+
+/**
+ * @return the CPU's cycle counter on x86, or the steady clock in
+ * nanoseconds elsewhere. Only differences of nearby readings are
+ * meaningful; report() calibrates them into wall-clock time.
+ */
+inline uint64_t cycle_count()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * A named event counter. add() is one relaxed atomic increment, so
+ * counters are always-on (unsampled) even in hot loops. Counters are
+ * meant to be function-local statics created through META_PROFILE_COUNT;
+ * they register themselves with the reporting registry and live for the
+ * duration of the program.
+ */
+class counter
+{
+  public:
+    /**
+     * @param name The name the counter reports under; must outlive the
+     * counter (string literals only)
+     */
+    explicit counter(const char* name);
+
+    /**
+     * @param amount The amount to add to the counter
+     */
+    void add(uint64_t amount)
+    {
+        count_.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    const char* name() const
+    {
+        return name_;
+    }
+
+    uint64_t value() const
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// the name this counter reports under
+    const char* name_;
+    /// the accumulated count, across all threads
+    std::atomic<uint64_t> count_{0};
+};
+
+/**
+ * The per-site accumulator behind a scoped timer: a concurrent quantile
+ * sketch of the sampled durations (one relaxed atomic increment per
+ * recording) plus moment statistics. Like counters, timer sites are
+ * function-local statics created through META_PROFILE_SCOPE and register
+ * themselves with the reporting registry.
+ */
+class timer_site
+{
+  public:
+    /**
+     * @param name The name the site reports under; must outlive the
+     * site (string literals only)
+     */
+    explicit timer_site(const char* name);
+
+    /**
+     * @return whether this execution of the scope should be timed: one
+     * in every sample_period executions per thread
+     */
+    static bool sample()
+    {
+        static thread_local uint64_t ticks = 0;
+        return ticks++ % sample_period == 0;
+    }
+
+    /**
+     * @param cycles The sampled duration, in cycle_count() units
+     */
+    void record(uint64_t cycles)
+    {
+        auto value = static_cast<double>(cycles);
+        sketch_.add(value);
+        std::lock_guard<std::mutex> lock{mutex_};
+        stats_.add(value);
+    }
+
+    const char* name() const
+    {
+        return name_;
+    }
+
+    /**
+     * @return a quantile sketch over the sampled durations, in
+     * cycle_count() units
+     */
+    stats::dd_sketch sketch() const
+    {
+        return sketch_.snapshot();
+    }
+
+    /**
+     * @return the moment statistics of the sampled durations, in
+     * cycle_count() units
+     */
+    stats::running_stats moments() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return stats_;
+    }
+
+  private:
+    /// the name this site reports under
+    const char* name_;
+    /// quantiles of the sampled durations; cycles span a wide range, so
+    /// the trackable window is stretched well past the default
+    stats::concurrent_dd_sketch sketch_{0.01, 1.0, 1e12};
+    /// moment statistics of the sampled durations
+    stats::running_stats stats_;
+    /// guards stats_, which is not thread safe; recordings are sampled,
+    /// so contention here is negligible
+    mutable std::mutex mutex_;
+};
+
+/**
+ * Times one execution of an instrumented scope when the per-thread
+ * sampler selects it; unsampled executions pay one thread-local
+ * increment and a branch.
+ */
+class scoped_timer
+{
+  public:
+    explicit scoped_timer(timer_site& site)
+        : site_{timer_site::sample() ? &site : nullptr},
+          start_{site_ ? cycle_count() : 0}
+    {
+        // nothing
+    }
+
+    ~scoped_timer()
+    {
+        if (site_)
+            site_->record(cycle_count() - start_);
+    }
+
+    scoped_timer(const scoped_timer&) = delete;
+    scoped_timer& operator=(const scoped_timer&) = delete;
+
+  private:
+    /// the site to record into, or nullptr when unsampled
+    timer_site* site_;
+    /// the cycle counter at construction (sampled executions only)
+    uint64_t start_;
+};
+
+/**
+ * Writes every counter and timer site to the given stream: counter
+ * totals, and per-site sample counts, means, and p50/p99/p99.9
+ * latencies calibrated into microseconds. Sites instantiated in more
+ * than one translation unit (e.g. from templates) are merged by name.
+ *
+ * @param os The stream to report to
+ */
+void report(std::ostream& os);
+
+#else
+
+/**
+ * The no-op stand-in when profiling hooks are compiled out, so callers
+ * can request a report unconditionally.
+ *
+ * @param os The stream to report to
+ */
+inline void report(std::ostream&)
+{
+    // nothing
+}
+
+#endif
+}
+}
+
+#if META_PROFILE_HOOKS
+
+#define META_PROFILE_PASTE_IMPL(x, y) x##y
+#define META_PROFILE_PASTE(x, y) META_PROFILE_PASTE_IMPL(x, y)
+
+/**
+ * Adds to a named event counter: always-on, one relaxed atomic
+ * increment. Compiles to nothing when profiling hooks are disabled.
+ */
+#define META_PROFILE_COUNT(name, amount)                                   \
+    do                                                                     \
+    {                                                                      \
+        static ::meta::profile::counter META_PROFILE_PASTE(                \
+            meta_profile_counter_, __LINE__){name};                        \
+        META_PROFILE_PASTE(meta_profile_counter_, __LINE__).add(amount);   \
+    } while (0)
+
+/**
+ * Times the enclosing scope under the given name, sampled per thread at
+ * 1/sample_period. Compiles to nothing when profiling hooks are
+ * disabled.
+ */
+#define META_PROFILE_SCOPE(name)                                           \
+    static ::meta::profile::timer_site META_PROFILE_PASTE(                 \
+        meta_profile_site_, __LINE__){name};                               \
+    ::meta::profile::scoped_timer META_PROFILE_PASTE(meta_profile_timer_,  \
+                                                     __LINE__)             \
+    {                                                                      \
+        META_PROFILE_PASTE(meta_profile_site_, __LINE__)                   \
+    }
+
+#else
+
+#define META_PROFILE_COUNT(name, amount) static_cast<void>(0)
+#define META_PROFILE_SCOPE(name)
+
+#endif
+#endif
@@ -29,6 +29,14 @@ namespace printing
  * Simple class for reporting progress of lengthy operations. Inspired by
  * noamraph/tqdm.
  *
+ * Updating a progress object is a single relaxed atomic store; all
+ * formatting and terminal output happens on one shared reporter thread
+ * that samples the active counters. Nested progress bars (e.g. a corpus
+ * pass inside an index build inside a cross-validation fold) form a
+ * stack: the innermost bar owns the terminal line, and the enclosing bar
+ * resumes when it finishes, so nested operations no longer interleave
+ * their output.
+ *
  * @see https://github.com/noamraph/tqdm/
  */
 class progress
@@ -60,9 +68,9 @@ class progress
     ~progress();
 
     /**
-     * Updates the progress indicator. Since progress is printed
-     * asynchronously, you may not immediately see results after calling
-     * this function, but they will be reflected in the next update tick.
+     * Updates the progress indicator. This is a single relaxed atomic
+     * store; the shared reporter thread picks the new value up on its
+     * next sampling tick.
      * @param iter The current iteration number to update to
      */
     void operator()(uint64_t iter);
@@ -78,19 +86,10 @@ class progress
     static void clear();
 
   private:
-    void print();
-    void progress_thread();
-
-    /// The background thread for printing progress updates
-    std::thread thread_;
-    /// The mutex for the condition variable.
-    std::mutex mutex_;
-    /// The condition variable used by the background thread for sleeping
-    std::condition_variable cond_var_;
-    /// The output line
-    std::string output_;
-    /// The length of the prefix
-    const std::size_t prefix_len_;
+    friend class progress_registry;
+
+    /// The string printed before the bar
+    std::string prefix_;
     /// The start time of the job.
     const std::chrono::steady_clock::time_point start_;
     /// The current iteration number.
@@ -101,6 +100,8 @@ class progress
     const int interval_;
     /// Whether or not we should print an endline when done.
     bool endline_;
+    /// Whether end() has already run for this bar
+    bool finished_;
 };
 
 /**
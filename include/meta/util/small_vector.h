@@ -0,0 +1,433 @@
+/**
+ * @file small_vector.h
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_SMALL_VECTOR_H_
+#define META_UTIL_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "meta/config.h"
+#include "meta/io/packed.h"
+
+namespace meta
+{
+namespace util
+{
+
+/**
+ * A vector with small-buffer optimization: the first N elements are
+ * stored in situ, avoiding any heap allocation for the short vectors
+ * that dominate sparse feature data. Once the size exceeds N, storage
+ * spills to the heap and behaves like a regular vector.
+ *
+ * Only the parts of the std::vector interface needed by sparse_vector
+ * and friends are provided; iterators are raw pointers and are
+ * invalidated by any operation that changes the size.
+ */
+template <class T, std::size_t N>
+class small_vector
+{
+  public:
+    static_assert(N > 0, "small_vector requires a nonzero inline capacity");
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    small_vector() : data_{inline_data()}, size_{0}, capacity_{N}
+    {
+        // nothing
+    }
+
+    /**
+     * Creates a small_vector with size value-initialized elements.
+     * @param size The number of elements
+     */
+    explicit small_vector(size_type size) : small_vector{}
+    {
+        reserve(size);
+        for (size_type i = 0; i < size; ++i)
+            new (data_ + i) T();
+        size_ = size;
+    }
+
+    /**
+     * Creates a small_vector from a pair of iterators.
+     * @param first The iterator to the beginning of the sequence
+     * @param last The iterator to the end of the sequence
+     */
+    template <class Iter>
+    small_vector(Iter first, Iter last) : small_vector{}
+    {
+        reserve(static_cast<size_type>(std::distance(first, last)));
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    small_vector(std::initializer_list<T> init)
+        : small_vector{init.begin(), init.end()}
+    {
+        // nothing
+    }
+
+    small_vector(const small_vector& other) : small_vector{}
+    {
+        reserve(other.size_);
+        for (size_type i = 0; i < other.size_; ++i)
+            new (data_ + i) T(other.data_[i]);
+        size_ = other.size_;
+    }
+
+    small_vector(small_vector&& other) : small_vector{}
+    {
+        steal(other);
+    }
+
+    small_vector& operator=(const small_vector& other)
+    {
+        if (this != &other)
+        {
+            small_vector temp{other};
+            *this = std::move(temp);
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other)
+    {
+        if (this != &other)
+        {
+            destroy();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~small_vector()
+    {
+        destroy();
+    }
+
+    iterator begin()
+    {
+        return data_;
+    }
+
+    const_iterator begin() const
+    {
+        return data_;
+    }
+
+    const_iterator cbegin() const
+    {
+        return data_;
+    }
+
+    iterator end()
+    {
+        return data_ + size_;
+    }
+
+    const_iterator end() const
+    {
+        return data_ + size_;
+    }
+
+    const_iterator cend() const
+    {
+        return data_ + size_;
+    }
+
+    T& operator[](size_type idx)
+    {
+        return data_[idx];
+    }
+
+    const T& operator[](size_type idx) const
+    {
+        return data_[idx];
+    }
+
+    T& front()
+    {
+        return data_[0];
+    }
+
+    const T& front() const
+    {
+        return data_[0];
+    }
+
+    T& back()
+    {
+        return data_[size_ - 1];
+    }
+
+    const T& back() const
+    {
+        return data_[size_ - 1];
+    }
+
+    T* data()
+    {
+        return data_;
+    }
+
+    const T* data() const
+    {
+        return data_;
+    }
+
+    size_type size() const
+    {
+        return size_;
+    }
+
+    size_type capacity() const
+    {
+        return capacity_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    /**
+     * @return whether the elements currently live in the inline buffer
+     */
+    bool is_inline() const
+    {
+        return data_ == inline_data();
+    }
+
+    void reserve(size_type size)
+    {
+        if (size > capacity_)
+            grow(size);
+    }
+
+    void clear()
+    {
+        for (size_type i = 0; i < size_; ++i)
+            data_[i].~T();
+        size_ = 0;
+    }
+
+    /**
+     * Moves the elements back into the inline buffer if they fit;
+     * otherwise a no-op (heap storage is not reallocated downward).
+     */
+    void shrink_to_fit()
+    {
+        if (is_inline() || size_ > N)
+            return;
+
+        auto* old = data_;
+        data_ = inline_data();
+        for (size_type i = 0; i < size_; ++i)
+        {
+            new (data_ + i) T(std::move(old[i]));
+            old[i].~T();
+        }
+        ::operator delete(old);
+        capacity_ = N;
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args)
+    {
+        if (size_ == capacity_)
+            grow(capacity_ * 2);
+        new (data_ + size_) T(std::forward<Args>(args)...);
+        ++size_;
+    }
+
+    void pop_back()
+    {
+        data_[--size_].~T();
+    }
+
+    /**
+     * Constructs an element before the given position, shifting later
+     * elements up by one.
+     */
+    template <class... Args>
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+        auto idx = static_cast<size_type>(pos - data_);
+        if (idx == size_)
+        {
+            emplace_back(std::forward<Args>(args)...);
+        }
+        else
+        {
+            if (size_ == capacity_)
+                grow(capacity_ * 2);
+            new (data_ + size_) T(std::move(data_[size_ - 1]));
+            std::move_backward(data_ + idx, data_ + size_ - 1, data_ + size_);
+            data_[idx] = T(std::forward<Args>(args)...);
+            ++size_;
+        }
+        return data_ + idx;
+    }
+
+    iterator erase(iterator pos)
+    {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(iterator first, iterator last)
+    {
+        auto removed = static_cast<size_type>(last - first);
+        std::move(last, end(), first);
+        for (auto it = end() - removed; it != end(); ++it)
+            it->~T();
+        size_ -= removed;
+        return first;
+    }
+
+    template <class OutputStream>
+    friend uint64_t packed_write(OutputStream& os, const small_vector& vec)
+    {
+        using meta::io::packed::packed_write;
+        auto bytes = packed_write(os, vec.size());
+        for (const auto& v : vec)
+            bytes += packed_write(os, v);
+        return bytes;
+    }
+
+    template <class InputStream>
+    friend uint64_t packed_read(InputStream& is, small_vector& vec)
+    {
+        using meta::io::packed::packed_read;
+        uint64_t size;
+        auto bytes = packed_read(is, size);
+        vec.clear();
+        vec.reserve(size);
+        for (uint64_t i = 0; i < size; ++i)
+        {
+            T val;
+            bytes += packed_read(is, val);
+            vec.emplace_back(std::move(val));
+        }
+        return bytes;
+    }
+
+  private:
+    T* inline_data()
+    {
+        return reinterpret_cast<T*>(&inline_storage_);
+    }
+
+    const T* inline_data() const
+    {
+        return reinterpret_cast<const T*>(&inline_storage_);
+    }
+
+    /**
+     * Moves another small_vector's contents into this (empty) one,
+     * stealing the heap buffer when there is one.
+     */
+    void steal(small_vector& other)
+    {
+        if (other.is_inline())
+        {
+            for (size_type i = 0; i < other.size_; ++i)
+                new (data_ + i) T(std::move(other.data_[i]));
+            size_ = other.size_;
+            other.clear();
+        }
+        else
+        {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_data();
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    }
+
+    /**
+     * Reallocates storage to hold at least new_cap elements.
+     */
+    void grow(size_type new_cap)
+    {
+        new_cap = std::max(new_cap, capacity_ * 2);
+        auto* fresh
+            = static_cast<T*>(::operator new(new_cap * sizeof(T)));
+        for (size_type i = 0; i < size_; ++i)
+        {
+            new (fresh + i) T(std::move(data_[i]));
+            data_[i].~T();
+        }
+        if (!is_inline())
+            ::operator delete(data_);
+        data_ = fresh;
+        capacity_ = new_cap;
+    }
+
+    /**
+     * Destroys all elements and releases any heap storage.
+     */
+    void destroy()
+    {
+        clear();
+        if (!is_inline())
+            ::operator delete(data_);
+        data_ = inline_data();
+        capacity_ = N;
+    }
+
+    /// the elements, pointing into inline_storage_ until spilled
+    T* data_;
+    /// the number of live elements
+    size_type size_;
+    /// the current storage capacity
+    size_type capacity_;
+    /// in-situ storage for the first N elements
+    typename std::aligned_storage<sizeof(T[N]), alignof(T)>::type
+        inline_storage_;
+};
+
+template <class T, std::size_t N>
+bool operator==(const small_vector<T, N>& lhs, const small_vector<T, N>& rhs)
+{
+    return lhs.size() == rhs.size()
+           && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, std::size_t N>
+bool operator!=(const small_vector<T, N>& lhs, const small_vector<T, N>& rhs)
+{
+    return !(lhs == rhs);
+}
+}
+}
+#endif
@@ -16,6 +16,7 @@
 
 #include "meta/config.h"
 #include "meta/io/packed.h"
+#include "meta/util/small_vector.h"
 
 namespace meta
 {
@@ -26,13 +27,18 @@ namespace util
  * Represents a sparse vector, indexed by type Index and storing values of
  * type Value. This stores the elements in the vector in sorted order by
  * the Index type.
+ *
+ * The backing container is configurable; the small_sparse_vector alias
+ * uses a small_vector so that short vectors (like per-feature weight
+ * rows) avoid heap allocation entirely.
  */
-template <class Index, class Value>
+template <class Index, class Value,
+          class Container = std::vector<std::pair<Index, Value>>>
 class sparse_vector
 {
   public:
     using pair_type = std::pair<Index, Value>;
-    using container_type = std::vector<pair_type>;
+    using container_type = Container;
     using iterator = typename container_type::iterator;
     using const_iterator = typename container_type::const_iterator;
 
@@ -183,6 +189,32 @@ class sparse_vector
      */
     iterator erase(iterator first, iterator last);
 
+    /**
+     * Merges a sorted sequence of (index, value) pairs into the vector
+     * in a single linear pass, summing the values of indices present on
+     * both sides. This is much faster than element-wise operator[] when
+     * combining whole feature maps, which performs a binary search (and
+     * potentially a mid-vector insertion) per element.
+     *
+     * @param first The iterator to the beginning of the sorted sequence
+     * @param last The iterator to the end of the sorted sequence
+     */
+    template <class ForwardIterator>
+    void merge_sorted(ForwardIterator first, ForwardIterator last);
+
+    /**
+     * Merges a sorted sequence of (index, value) pairs into the vector,
+     * transforming each incoming value before accumulating it (e.g. to
+     * apply a scale factor or negation).
+     *
+     * @param first The iterator to the beginning of the sorted sequence
+     * @param last The iterator to the end of the sorted sequence
+     * @param xform The transformation to apply to each incoming value
+     */
+    template <class ForwardIterator, class ValueTransform>
+    void merge_sorted(ForwardIterator first, ForwardIterator last,
+                      ValueTransform&& xform);
+
     sparse_vector& operator+=(const sparse_vector& rhs);
     sparse_vector& operator-=(const sparse_vector& rhs);
 
@@ -205,51 +237,66 @@ class sparse_vector
     container_type storage_;
 };
 
-template <class Index, class Value>
-sparse_vector<Index, Value> operator+(const sparse_vector<Index, Value>& lhs,
-                                      const sparse_vector<Index, Value>& rhs)
+/**
+ * A sparse_vector whose first N elements are stored in situ, avoiding
+ * heap allocation for the short vectors that dominate feature data.
+ */
+template <class Index, class Value, std::size_t N = 8>
+using small_sparse_vector
+    = sparse_vector<Index, Value, small_vector<std::pair<Index, Value>, N>>;
+
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>
+operator+(const sparse_vector<Index, Value, Container>& lhs,
+          const sparse_vector<Index, Value, Container>& rhs)
 {
-    return sparse_vector<Index, Value>(lhs) += rhs;
+    return sparse_vector<Index, Value, Container>(lhs) += rhs;
 }
 
-template <class Index, class Value>
-sparse_vector<Index, Value> operator+(sparse_vector<Index, Value>&& lhs,
-                                      const sparse_vector<Index, Value>& rhs)
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>
+operator+(sparse_vector<Index, Value, Container>&& lhs,
+          const sparse_vector<Index, Value, Container>& rhs)
 {
     return lhs += rhs;
 }
 
-template <class Index, class Value>
-sparse_vector<Index, Value> operator+(const sparse_vector<Index, Value>& lhs,
-                                      sparse_vector<Index, Value>&& rhs)
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>
+operator+(const sparse_vector<Index, Value, Container>& lhs,
+          sparse_vector<Index, Value, Container>&& rhs)
 {
     return rhs += lhs;
 }
 
-template <class Index, class Value>
-sparse_vector<Index, Value> operator+(sparse_vector<Index, Value>&& lhs,
-                                      sparse_vector<Index, Value>&& rhs)
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>
+operator+(sparse_vector<Index, Value, Container>&& lhs,
+          sparse_vector<Index, Value, Container>&& rhs)
 {
     return lhs += rhs;
 }
 
-template <class Index, class Value>
-sparse_vector<Index, Value> operator-(const sparse_vector<Index, Value>& lhs,
-                                      const sparse_vector<Index, Value>& rhs)
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>
+operator-(const sparse_vector<Index, Value, Container>& lhs,
+          const sparse_vector<Index, Value, Container>& rhs)
 {
-    return sparse_vector<Index, Value>(lhs) -= rhs;
+    return sparse_vector<Index, Value, Container>(lhs) -= rhs;
 }
 
-template <class Index, class Value>
-sparse_vector<Index, Value> operator-(sparse_vector<Index, Value>&& lhs,
-                                      const sparse_vector<Index, Value>& rhs)
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>
+operator-(sparse_vector<Index, Value, Container>&& lhs,
+          const sparse_vector<Index, Value, Container>& rhs)
 {
     return lhs -= rhs;
 }
 
-template <class Index, class Value>
-sparse_vector<Index, Value> operator-(sparse_vector<Index, Value>&& lhs,
-                                      sparse_vector<Index, Value>&& rhs)
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>
+operator-(sparse_vector<Index, Value, Container>&& lhs,
+          sparse_vector<Index, Value, Container>&& rhs)
 {
     return lhs -= rhs;
 }
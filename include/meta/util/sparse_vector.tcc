@@ -12,22 +12,23 @@ namespace meta
 namespace util
 {
 
-template <class Index, class Value>
-sparse_vector<Index, Value>::sparse_vector(uint64_t size) : storage_(size)
+template <class Index, class Value, class Container>
+sparse_vector<Index, Value, Container>::sparse_vector(uint64_t size)
+    : storage_(size)
 {
     // nothing
 }
 
-template <class Index, class Value>
+template <class Index, class Value, class Container>
 template <class Iter>
-sparse_vector<Index, Value>::sparse_vector(Iter begin, Iter end)
+sparse_vector<Index, Value, Container>::sparse_vector(Iter begin, Iter end)
     : storage_{begin, end}
 {
     // nothing
 }
 
-template <class Index, class Value>
-Value& sparse_vector<Index, Value>::operator[](const Index& index)
+template <class Index, class Value, class Container>
+Value& sparse_vector<Index, Value, Container>::operator[](const Index& index)
 {
     auto it = std::lower_bound(
         std::begin(storage_), std::end(storage_), index,
@@ -49,8 +50,8 @@ Value& sparse_vector<Index, Value>::operator[](const Index& index)
     }
 }
 
-template <class Index, class Value>
-Value sparse_vector<Index, Value>::at(const Index& index) const
+template <class Index, class Value, class Container>
+Value sparse_vector<Index, Value, Container>::at(const Index& index) const
 {
     auto it = std::lower_bound(
         std::begin(storage_), std::end(storage_), index,
@@ -61,8 +62,8 @@ Value sparse_vector<Index, Value>::at(const Index& index) const
     return it->second;
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::find(const Index& index) const
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::find(const Index& index) const
     -> const_iterator
 {
     auto it = std::lower_bound(
@@ -75,33 +76,33 @@ auto sparse_vector<Index, Value>::find(const Index& index) const
     return it;
 }
 
-template <class Index, class Value>
+template <class Index, class Value, class Container>
 template <class... Ts>
-void sparse_vector<Index, Value>::emplace_back(Ts&&... ts)
+void sparse_vector<Index, Value, Container>::emplace_back(Ts&&... ts)
 {
     storage_.emplace_back(std::forward<Ts>(ts)...);
 }
 
-template <class Index, class Value>
-void sparse_vector<Index, Value>::reserve(uint64_t size)
+template <class Index, class Value, class Container>
+void sparse_vector<Index, Value, Container>::reserve(uint64_t size)
 {
     storage_.reserve(size);
 }
 
-template <class Index, class Value>
-void sparse_vector<Index, Value>::clear()
+template <class Index, class Value, class Container>
+void sparse_vector<Index, Value, Container>::clear()
 {
     storage_.clear();
 }
 
-template <class Index, class Value>
-void sparse_vector<Index, Value>::shrink_to_fit()
+template <class Index, class Value, class Container>
+void sparse_vector<Index, Value, Container>::shrink_to_fit()
 {
     storage_.shrink_to_fit();
 }
 
-template <class Index, class Value>
-void sparse_vector<Index, Value>::condense()
+template <class Index, class Value, class Container>
+void sparse_vector<Index, Value, Container>::condense()
 {
     Value default_value{};
 
@@ -114,32 +115,33 @@ void sparse_vector<Index, Value>::condense()
     shrink_to_fit();
 }
 
-template <class Index, class Value>
-uint64_t sparse_vector<Index, Value>::size() const
+template <class Index, class Value, class Container>
+uint64_t sparse_vector<Index, Value, Container>::size() const
 {
     return storage_.size();
 }
 
-template <class Index, class Value>
-uint64_t sparse_vector<Index, Value>::capacity() const
+template <class Index, class Value, class Container>
+uint64_t sparse_vector<Index, Value, Container>::capacity() const
 {
     return storage_.capacity();
 }
 
-template <class Index, class Value>
-bool sparse_vector<Index, Value>::empty() const
+template <class Index, class Value, class Container>
+bool sparse_vector<Index, Value, Container>::empty() const
 {
     return storage_.empty();
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::contents() const -> const container_type&
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::contents() const
+    -> const container_type&
 {
     return storage_;
 }
 
-template <class Index, class Value>
-void sparse_vector<Index, Value>::contents(container_type cont)
+template <class Index, class Value, class Container>
+void sparse_vector<Index, Value, Container>::contents(container_type cont)
 {
     storage_ = std::move(cont);
     std::sort(std::begin(storage_), std::end(storage_),
@@ -148,136 +150,123 @@ void sparse_vector<Index, Value>::contents(container_type cont)
               });
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::begin() -> iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::begin() -> iterator
 {
     return std::begin(storage_);
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::begin() const -> const_iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::begin() const -> const_iterator
 {
     return std::begin(storage_);
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::cbegin() const -> const_iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::cbegin() const -> const_iterator
 {
     return storage_.cbegin();
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::end() -> iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::end() -> iterator
 {
     return std::end(storage_);
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::end() const -> const_iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::end() const -> const_iterator
 {
     return std::end(storage_);
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::cend() const -> const_iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::cend() const -> const_iterator
 {
     return storage_.cend();
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::erase(iterator pos) -> iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::erase(iterator pos) -> iterator
 {
     return storage_.erase(pos);
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::erase(iterator first, iterator last)
-    -> iterator
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::erase(iterator first,
+                                                   iterator last) -> iterator
 {
     return storage_.erase(first, last);
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::operator+=(const sparse_vector& rhs)
-    -> sparse_vector&
+template <class Index, class Value, class Container>
+template <class ForwardIterator>
+void sparse_vector<Index, Value, Container>::merge_sorted(
+    ForwardIterator first, ForwardIterator last)
 {
-    // use index into the current vector so that we can properly handle
-    // invalidation of iterators during the loop
-    uint64_t idx = 0;
-    uint64_t end = size();
-
-    auto second_it = rhs.begin();
-    auto second_end = rhs.end();
+    merge_sorted(first, last, [](const Value& val) { return val; });
+}
 
-    while (idx != end && second_it != second_end)
+template <class Index, class Value, class Container>
+template <class ForwardIterator, class ValueTransform>
+void sparse_vector<Index, Value, Container>::merge_sorted(
+    ForwardIterator first, ForwardIterator last, ValueTransform&& xform)
+{
+    if (first == last)
+        return;
+
+    // single linear merge pass into fresh storage: this avoids the
+    // binary search and mid-vector insertion that element-wise
+    // operator[] accumulation would perform for every element
+    container_type merged;
+    merged.reserve(size()
+                   + static_cast<uint64_t>(std::distance(first, last)));
+
+    auto it = storage_.begin();
+    auto end_it = storage_.end();
+    while (it != end_it && first != last)
     {
-        if (storage_[idx].first == second_it->first)
+        if (it->first == first->first)
         {
-            storage_[idx].second += second_it->second;
-            ++idx;
-            ++second_it;
+            merged.emplace_back(it->first, it->second);
+            merged.back().second += xform(first->second);
+            ++it;
+            ++first;
         }
-        else if (storage_[idx].first < second_it->first)
+        else if (it->first < first->first)
         {
-            ++idx;
+            merged.emplace_back(it->first, it->second);
+            ++it;
         }
         else
         {
-            using diff_type = typename iterator::difference_type;
-            storage_.emplace(begin() + static_cast<diff_type>(idx),
-                             second_it->first, second_it->second);
-            ++idx;
-            ++second_it;
+            merged.emplace_back(first->first, xform(first->second));
+            ++first;
         }
     }
 
-    for (; second_it != second_end; ++second_it)
-    {
-        storage_.emplace_back(second_it->first, second_it->second);
-    }
+    for (; it != end_it; ++it)
+        merged.emplace_back(it->first, it->second);
+    for (; first != last; ++first)
+        merged.emplace_back(first->first, xform(first->second));
 
-    return *this;
+    storage_ = std::move(merged);
 }
 
-template <class Index, class Value>
-auto sparse_vector<Index, Value>::operator-=(const sparse_vector& rhs)
-    -> sparse_vector&
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::operator+=(
+    const sparse_vector& rhs) -> sparse_vector&
 {
-    // use index into the current vector so that we can properly handle
-    // invalidation of iterators during the loop
-    uint64_t idx = 0;
-    uint64_t end = size();
-
-    auto second_it = rhs.begin();
-    auto second_end = rhs.end();
-
-    while (idx != end && second_it != second_end)
-    {
-        if (storage_[idx].first == second_it->first)
-        {
-            storage_[idx].second -= second_it->second;
-            ++idx;
-            ++second_it;
-        }
-        else if (storage_[idx].first < second_it->first)
-        {
-            ++idx;
-        }
-        else
-        {
-            using diff_type = typename iterator::difference_type;
-            storage_.emplace(begin() + static_cast<diff_type>(idx),
-                             second_it->first, -second_it->second);
-            ++idx;
-            ++second_it;
-        }
-    }
-
-    for (; second_it != second_end; ++second_it)
-    {
-        storage_.emplace_back(second_it->first, -second_it->second);
-    }
+    merge_sorted(rhs.begin(), rhs.end());
+    return *this;
+}
 
+template <class Index, class Value, class Container>
+auto sparse_vector<Index, Value, Container>::operator-=(
+    const sparse_vector& rhs) -> sparse_vector&
+{
+    merge_sorted(rhs.begin(), rhs.end(),
+                 [](const Value& val) { return -val; });
     return *this;
 }
 }
@@ -12,6 +12,7 @@
 #include "meta/analyzers/filters/list_filter.h"
 #include "meta/analyzers/filters/lowercase_filter.h"
 #include "meta/analyzers/filters/porter2_filter.h"
+#include "meta/analyzers/fused_unigram_chain.h"
 #include "meta/analyzers/tokenizers/icu_tokenizer.h"
 #include "meta/corpus/document.h"
 #include "cpptoml.h"
@@ -30,6 +31,11 @@ std::string get_content(const corpus::document& doc)
         throw analyzer_exception{
             "document content was not populated for analysis"};
 
+    // fast path: when the content is already utf-8, hand it off without
+    // the ICU transcoding round trip
+    if (doc.encoding() == "utf-8")
+        return doc.content();
+
     return utf::to_utf8(doc.content(), doc.encoding());
 }
 
@@ -63,9 +69,12 @@ std::unique_ptr<token_stream> default_filter_chain(const cpptoml::table& config)
 std::unique_ptr<token_stream>
 default_unigram_chain(const cpptoml::table& config)
 {
-    // suppress "<s>", "</s>"
-    auto tokenizer = make_unique<tokenizers::icu_tokenizer>(true);
-    return add_default_filters(std::move(tokenizer), config);
+    auto stopwords = config.get_as<std::string>("stop-words");
+
+    // the fused implementation produces the same tokens as building the
+    // chain filter-by-filter, but runs every stage in one loop instead
+    // of a virtual call per token per filter
+    return make_unique<fused_unigram_chain>(*stopwords);
 }
 
 std::unique_ptr<token_stream> load_filter(std::unique_ptr<token_stream> src,
@@ -21,6 +21,7 @@ void analyzer_factory::register_analyzer()
 analyzer_factory::analyzer_factory()
 {
     // built-in analyzers
+    register_analyzer<field_analyzer>();
     register_analyzer<ngram_word_analyzer>();
 }
 }
@@ -0,0 +1,98 @@
+/**
+ * @file field_analyzer.cpp
+ * @author Chase Geigle
+ */
+
+#include <string>
+
+#include "cpptoml.h"
+#include "meta/analyzers/field_analyzer.h"
+#include "meta/corpus/document.h"
+
+namespace meta
+{
+namespace analyzers
+{
+
+const util::string_view field_analyzer::id = "field";
+
+field_analyzer::field_analyzer(std::string field, uint64_t field_index,
+                               std::unique_ptr<token_stream> stream)
+    : field_{std::move(field)},
+      field_index_{field_index},
+      stream_{std::move(stream)}
+{
+    // nothing
+}
+
+field_analyzer::field_analyzer(const field_analyzer& other)
+    : field_{other.field_},
+      field_index_{other.field_index_},
+      stream_{other.stream_->clone()}
+{
+    // nothing
+}
+
+std::string field_analyzer::field_term(const std::string& field,
+                                       const std::string& term)
+{
+    return field + ":" + term;
+}
+
+void field_analyzer::tokenize(const corpus::document& doc, featurizer& counts)
+{
+    // documents without metadata (e.g. queries) have nothing to analyze
+    if (field_index_ >= doc.mdata().size())
+        return;
+
+    const auto& fld = doc.mdata()[field_index_];
+    if (fld.type != corpus::metadata::field_type::STRING)
+        return;
+
+    stream_->set_content(std::string{fld.str});
+    while (*stream_)
+        counts(field_term(field_, stream_->next().to_string()), 1ul);
+}
+
+template <>
+std::unique_ptr<analyzer> make_analyzer<field_analyzer>(
+    const cpptoml::table& global, const cpptoml::table& config)
+{
+    auto field = config.get_as<std::string>("field");
+    if (!field)
+        throw analyzer_exception{
+            "field name needed for field analyzer in config file"};
+
+    // resolve the field's position in the corpus' metadata schema
+    auto prefix = global.get_as<std::string>("prefix");
+    auto dataset = global.get_as<std::string>("dataset");
+    auto corp = global.get_as<std::string>("corpus");
+    if (!prefix || !dataset || !corp)
+        throw analyzer_exception{
+            "prefix, dataset, and corpus needed for field analyzer"};
+
+    auto corpus_config
+        = cpptoml::parse_file(*prefix + "/" + *dataset + "/" + *corp);
+    auto schema = corpus::metadata_schema(*corpus_config);
+
+    auto pos = schema.size();
+    for (std::size_t i = 0; i < schema.size(); ++i)
+    {
+        if (schema[i].name == *field)
+        {
+            pos = i;
+            break;
+        }
+    }
+    if (pos == schema.size())
+        throw analyzer_exception{"metadata field \"" + *field
+                                 + "\" not present in corpus schema"};
+    if (schema[pos].type != corpus::metadata::field_type::STRING)
+        throw analyzer_exception{"metadata field \"" + *field
+                                 + "\" is not a string field"};
+
+    auto filts = load_filters(global, config);
+    return make_unique<field_analyzer>(*field, pos, std::move(filts));
+}
+}
+}
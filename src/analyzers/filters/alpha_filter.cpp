@@ -34,11 +34,12 @@ void alpha_filter::set_content(std::string&& content)
     next_token();
 }
 
-std::string alpha_filter::next()
+util::string_view alpha_filter::next()
 {
-    auto tok = std::move(*token_);
+    using std::swap;
+    swap(current_, *token_);
     next_token();
-    return tok;
+    return current_;
 }
 
 void alpha_filter::next_token()
@@ -49,11 +50,12 @@ void alpha_filter::next_token()
         if (tok.size() <= 4 && tok.size() >= 3
             && (tok == "<s>" || tok == "</s>"))
         {
-            token_ = std::move(tok);
+            token_ = tok.to_string();
             return;
         }
 
-        auto filt = utf::remove_if(tok, [](uint32_t codepoint)
+        scratch_.assign(tok.data(), tok.size());
+        auto filt = utf::remove_if(scratch_, [](uint32_t codepoint)
                                    {
                                        return !utf::isalpha(codepoint)
                                               && codepoint != '\'';
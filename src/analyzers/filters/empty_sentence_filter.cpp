@@ -47,21 +47,22 @@ void empty_sentence_filter::next_token()
 
     while (*source_)
     {
-        first_ = source_->next();
+        first_ = source_->next().to_string();
         if (!*source_ || *first_ != "<s>")
             return;
-        second_ = source_->next();
+        second_ = source_->next().to_string();
         if (*second_ != "</s>")
             return;
         first_ = second_ = util::nullopt;
     }
 }
 
-std::string empty_sentence_filter::next()
+util::string_view empty_sentence_filter::next()
 {
-    auto tok = *first_;
+    using std::swap;
+    swap(current_, *first_);
     next_token();
-    return tok;
+    return current_;
 }
 
 empty_sentence_filter::operator bool() const
@@ -34,7 +34,7 @@ void english_normalizer::set_content(std::string&& content)
     source_->set_content(std::move(content));
 }
 
-std::string english_normalizer::next()
+util::string_view english_normalizer::next()
 {
     // if we have buffered tokens, keep returning them until we have
     // exhausted the buffer
@@ -68,17 +68,17 @@ english_normalizer::operator bool() const
     return !tokens_.empty() || *source_;
 }
 
-bool english_normalizer::is_whitespace(const std::string& token) const
+bool english_normalizer::is_whitespace(util::string_view token) const
 {
     auto space = [](char c) { return std::isspace(c); };
     return std::all_of(token.begin(), token.end(), space);
 }
 
-void english_normalizer::parse_token(const std::string& token)
+void english_normalizer::parse_token(util::string_view token)
 {
     if (token.length() < 2)
     {
-        tokens_.push_back(token);
+        tokens_.emplace_back(token.begin(), token.end());
         return;
     }
 
@@ -115,7 +115,7 @@ void english_normalizer::parse_token(const std::string& token)
 }
 
 uint64_t english_normalizer::starting_quotes(uint64_t start,
-                                             const std::string& token)
+                                             util::string_view token)
 {
     if (token[start] == '"')
     {
@@ -138,16 +138,17 @@ bool english_normalizer::is_quote(char c)
 }
 
 uint64_t english_normalizer::strip_dashes(uint64_t start,
-                                          const std::string& token)
+                                          util::string_view token)
 {
     auto idx = start + 1;
     while (idx < token.length() && token[idx] == '-')
         ++idx;
-    tokens_.emplace_back(token, start, idx - start);
+    auto sub = token.substr(start, idx - start);
+    tokens_.emplace_back(sub.begin(), sub.end());
     return idx;
 }
 
-uint64_t english_normalizer::word(uint64_t start, const std::string& token)
+uint64_t english_normalizer::word(uint64_t start, util::string_view token)
 {
     // special case leading dashes: if there are consecutive ones, we want
     // to strip them out into their own token
@@ -167,7 +168,8 @@ uint64_t english_normalizer::word(uint64_t start, const std::string& token)
             // or something
 
             // place the current token, before the dash, into the buffer
-            tokens_.emplace_back(token, start, idx - start);
+            auto sub = token.substr(start, idx - start);
+            tokens_.emplace_back(sub.begin(), sub.end());
             // place the dashes onto the buffer
             start = strip_dashes(idx, token);
         }
@@ -179,15 +181,16 @@ uint64_t english_normalizer::word(uint64_t start, const std::string& token)
         ++idx;
     }
 
-    tokens_.emplace_back(token, start, idx - start);
+    auto sub = token.substr(start, idx - start);
+    tokens_.emplace_back(sub.begin(), sub.end());
     return idx;
 }
 
-std::string english_normalizer::current_token()
+util::string_view english_normalizer::current_token()
 {
-    auto token = tokens_.front();
+    current_ = std::move(tokens_.front());
     tokens_.pop_front();
-    return token;
+    return current_;
 }
 }
 }
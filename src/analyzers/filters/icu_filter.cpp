@@ -36,11 +36,12 @@ void icu_filter::set_content(std::string&& content)
     next_token();
 }
 
-std::string icu_filter::next()
+util::string_view icu_filter::next()
 {
-    auto tok = *token_;
+    using std::swap;
+    swap(current_, *token_);
     next_token();
-    return tok;
+    return current_;
 }
 
 void icu_filter::next_token()
@@ -50,13 +51,14 @@ void icu_filter::next_token()
         auto tok = source_->next();
         if (tok == "<s>" || tok == "</s>")
         {
-            token_ = tok;
+            token_ = tok.to_string();
             return;
         }
-        auto trans = trans_(tok);
+        scratch_.assign(tok.data(), tok.size());
+        auto trans = trans_(scratch_);
         if (!trans.empty())
         {
-            token_ = trans;
+            token_ = std::move(trans);
             return;
         }
     }
@@ -42,11 +42,12 @@ void length_filter::set_content(std::string&& content)
     next_token();
 }
 
-std::string length_filter::next()
+util::string_view length_filter::next()
 {
-    auto tok = std::move(*token_);
+    using std::swap;
+    swap(current_, *token_);
     next_token();
-    return tok;
+    return current_;
 }
 
 length_filter::operator bool() const
@@ -65,18 +66,18 @@ void length_filter::next_token()
     while (*source_)
     {
         auto tok = source_->next();
+        // copy into the buffered token up front; its capacity is reused
+        // from one token to the next
+        if (token_)
+            token_->assign(tok.data(), tok.size());
+        else
+            token_ = tok.to_string();
         if (tok.size() <= 4 && tok.size() >= 3
             && (tok == "<s>" || tok == "</s>"))
-        {
-            token_ = std::move(tok);
             return;
-        }
-        auto len = utf::length(tok);
+        auto len = utf::length(*token_);
         if (len >= min_length_ && len <= max_length_)
-        {
-            token_ = std::move(tok);
             return;
-        }
     }
     token_ = util::nullopt;
 }
@@ -47,11 +47,12 @@ void list_filter::set_content(std::string&& content)
     next_token();
 }
 
-std::string list_filter::next()
+util::string_view list_filter::next()
 {
-    auto tok = std::move(*token_);
+    using std::swap;
+    swap(current_, *token_);
     next_token();
-    return tok;
+    return current_;
 }
 
 list_filter::operator bool() const
@@ -70,22 +71,22 @@ void list_filter::next_token()
     while (*source_)
     {
         auto tok = source_->next();
-        auto found = list_.find(tok) != list_.end();
+        // copy into the buffered token up front; its capacity is reused
+        // from one token to the next
+        if (token_)
+            token_->assign(tok.data(), tok.size());
+        else
+            token_ = tok.to_string();
+        auto found = list_.find(*token_) != list_.end();
         switch (method_)
         {
             case type::ACCEPT:
                 if (found)
-                {
-                    token_ = std::move(tok);
                     return;
-                }
                 break;
             case type::REJECT:
                 if (!found)
-                {
-                    token_ = std::move(tok);
                     return;
-                }
                 break;
             default:
                 throw token_stream_exception{"invalid method"};
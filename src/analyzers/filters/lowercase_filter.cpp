@@ -34,9 +34,12 @@ void lowercase_filter::set_content(std::string&& content)
     source_->set_content(std::move(content));
 }
 
-std::string lowercase_filter::next()
+util::string_view lowercase_filter::next()
 {
-    return utf::foldcase(source_->next());
+    auto tok = source_->next();
+    scratch_.assign(tok.data(), tok.size());
+    token_ = utf::foldcase(scratch_);
+    return token_;
 }
 
 lowercase_filter::operator bool() const
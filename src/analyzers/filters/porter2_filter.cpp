@@ -13,6 +13,12 @@ namespace analyzers
 namespace filters
 {
 
+namespace
+{
+/// The number of tokens pulled from the source and stemmed per block
+const std::size_t block_size = 64;
+}
+
 const util::string_view porter2_filter::id = "porter2-filter";
 
 porter2_filter::porter2_filter(std::unique_ptr<token_stream> source)
@@ -22,7 +28,12 @@ porter2_filter::porter2_filter(std::unique_ptr<token_stream> source)
 }
 
 porter2_filter::porter2_filter(const porter2_filter& other)
-    : source_{other.source_->clone()}, token_{other.token_}
+    : source_{other.source_->clone()},
+      block_{other.block_},
+      count_{other.count_},
+      pos_{other.pos_},
+      has_token_{other.has_token_},
+      current_{other.current_}
 {
     // nothing
 }
@@ -30,34 +41,60 @@ porter2_filter::porter2_filter(const porter2_filter& other)
 void porter2_filter::set_content(std::string&& content)
 {
     source_->set_content(std::move(content));
+    count_ = pos_ = 0;
     next_token();
 }
 
-std::string porter2_filter::next()
+util::string_view porter2_filter::next()
 {
-    auto tok = *token_;
+    using std::swap;
+    swap(current_, block_[pos_]);
+    ++pos_;
     next_token();
-    return tok;
+    return current_;
 }
 
 void porter2_filter::next_token()
 {
-    while (*source_)
+    while (true)
     {
-        auto tok = source_->next();
-        porter2::stem(tok);
-        if (!tok.empty())
+        // skip over tokens the stemmer reduced to nothing
+        for (; pos_ < count_; ++pos_)
         {
-            token_ = std::move(tok);
+            if (!block_[pos_].empty())
+            {
+                has_token_ = true;
+                return;
+            }
+        }
+
+        if (!*source_)
+        {
+            has_token_ = false;
             return;
         }
+
+        // refill: copy a block of tokens out of the source, then stem
+        // them all at once; assigning into the existing slots reuses
+        // their capacity from one block to the next
+        if (block_.size() < block_size)
+            block_.resize(block_size);
+        count_ = 0;
+        while (count_ < block_size && *source_)
+        {
+            auto tok = source_->next();
+            block_[count_++].assign(tok.data(), tok.size());
+        }
+        porter2::stem_batch(block_.begin(),
+                            block_.begin()
+                                + static_cast<std::ptrdiff_t>(count_));
+        pos_ = 0;
     }
-    token_ = util::nullopt;
 }
 
 porter2_filter::operator bool() const
 {
-    return static_cast<bool>(token_);
+    return has_token_;
 }
 }
 }
@@ -8,6 +8,7 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include <utility>
 #include <unordered_map>
 #include "meta/analyzers/filters/porter2_stemmer.h"
@@ -54,15 +55,30 @@ bool replace_if_exists(std::string& word, meta::util::string_view suffix,
     if (idx < start)
         return false;
 
-    auto diff = static_cast<std::string::iterator::difference_type>(idx);
-    if (std::equal(word.begin() + diff, word.end(), suffix.begin()))
+    // memcmp compares the suffix word-at-a-time rather than
+    // character-by-character
+    if (std::memcmp(word.data() + idx, suffix.data(), suffix.size()) == 0)
     {
-        word.replace(idx, suffix.size(), replacement.data());
+        word.replace(idx, suffix.size(), replacement.data(),
+                     replacement.size());
         return true;
     }
     return false;
 }
 
+using suffix_sub
+    = std::pair<meta::util::string_view, meta::util::string_view>;
+
+template <size_t N>
+bool replace_first(std::string& word, const suffix_sub (&subs)[N],
+                   size_t start)
+{
+    for (const auto& sub : subs)
+        if (replace_if_exists(word, sub.first, sub.second, start))
+            return true;
+    return false;
+}
+
 size_t get_start_r1(const std::string& word)
 {
     // special cases
@@ -90,10 +106,9 @@ size_t get_start_r2(const std::string& word, size_t startR1)
 
 bool ends_with(meta::util::string_view word, meta::util::string_view str)
 {
-    if (word.size() < str.size())
-        return false;
-
-    return word.substr(word.size() - str.size()) == str;
+    return word.size() >= str.size()
+           && std::memcmp(word.data() + (word.size() - str.size()),
+                          str.data(), str.size()) == 0;
 }
 
 bool ends_in_double(const std::string& word)
@@ -325,19 +340,52 @@ void step1c(std::string& word)
 */
 void step2(std::string& word, size_t startR1)
 {
-    static const std::pair<meta::util::string_view, meta::util::string_view>
-        subs[] = {{"ational", "ate"}, {"tional", "tion"}, {"enci", "ence"},
-                  {"anci", "ance"},   {"abli", "able"},   {"entli", "ent"},
-                  {"izer", "ize"},    {"ization", "ize"}, {"ation", "ate"},
-                  {"ator", "ate"},    {"alism", "al"},    {"aliti", "al"},
-                  {"alli", "al"},     {"fulness", "ful"}, {"ousli", "ous"},
-                  {"ousness", "ous"}, {"iveness", "ive"}, {"iviti", "ive"},
-                  {"biliti", "ble"},  {"bli", "ble"},     {"fulli", "ful"},
-                  {"lessli", "less"}};
-
-    for (auto& sub : subs)
-        if (replace_if_exists(word, sub.first, sub.second, startR1))
+    // the suffix tables are bucketed by the final character of the word
+    // so that each word is compared against only the suffixes that could
+    // possibly match it, rather than scanning the full table
+    static const suffix_sub i_subs[]
+        = {{"enci", "ence"},  {"anci", "ance"},  {"abli", "able"},
+           {"entli", "ent"},  {"aliti", "al"},   {"alli", "al"},
+           {"ousli", "ous"},  {"iviti", "ive"},  {"biliti", "ble"},
+           {"bli", "ble"},    {"fulli", "ful"},  {"lessli", "less"}};
+    static const suffix_sub l_subs[]
+        = {{"ational", "ate"}, {"tional", "tion"}};
+    static const suffix_sub n_subs[]
+        = {{"ization", "ize"}, {"ation", "ate"}};
+    static const suffix_sub s_subs[]
+        = {{"fulness", "ful"}, {"ousness", "ous"}, {"iveness", "ive"}};
+    static const suffix_sub m_subs[] = {{"alism", "al"}};
+    static const suffix_sub r_subs[] = {{"izer", "ize"}, {"ator", "ate"}};
+
+    if (word.empty())
+        return;
+
+    switch (word.back())
+    {
+        case 'i':
+            if (replace_first(word, i_subs, startR1))
+                return;
+            break;
+        // the logi/li handling below only applies to words ending in
+        // 'i', so every other bucket is done after its own table
+        case 'l':
+            replace_first(word, l_subs, startR1);
             return;
+        case 'n':
+            replace_first(word, n_subs, startR1);
+            return;
+        case 's':
+            replace_first(word, s_subs, startR1);
+            return;
+        case 'm':
+            replace_first(word, m_subs, startR1);
+            return;
+        case 'r':
+            replace_first(word, r_subs, startR1);
+            return;
+        default:
+            return;
+    }
 
     if (!replace_if_exists(word, "logi", "log", startR1 - 1))
     {
@@ -370,14 +418,37 @@ void step2(std::string& word, size_t startR1)
 */
 void step3(std::string& word, size_t startR1, size_t startR2)
 {
-    static const std::pair<meta::util::string_view, meta::util::string_view>
-        subs[] = {{"ational", "ate"}, {"tional", "tion"}, {"alize", "al"},
-                  {"icate", "ic"},    {"iciti", "ic"},    {"ical", "ic"},
-                  {"ful", ""},        {"ness", ""}};
+    static const suffix_sub l_subs[]
+        = {{"ational", "ate"}, {"tional", "tion"}, {"ical", "ic"},
+           {"ful", ""}};
+    static const suffix_sub e_subs[] = {{"alize", "al"}, {"icate", "ic"}};
+    static const suffix_sub i_subs[] = {{"iciti", "ic"}};
+    static const suffix_sub s_subs[] = {{"ness", ""}};
+
+    if (word.empty())
+        return;
 
-    for (auto& sub : subs)
-        if (replace_if_exists(word, sub.first, sub.second, startR1))
-            return;
+    switch (word.back())
+    {
+        case 'l':
+            if (replace_first(word, l_subs, startR1))
+                return;
+            break;
+        case 'e':
+            if (replace_first(word, e_subs, startR1))
+                return;
+            break;
+        case 'i':
+            if (replace_first(word, i_subs, startR1))
+                return;
+            break;
+        case 's':
+            if (replace_first(word, s_subs, startR1))
+                return;
+            break;
+        default:
+            break;
+    }
 
     replace_if_exists(word, "ative", "", startR2);
 }
@@ -395,24 +466,54 @@ void step3(std::string& word, size_t startR1, size_t startR2)
 */
 void step4(std::string& word, size_t startR2)
 {
-    static const std::pair<meta::util::string_view, meta::util::string_view>
-        subs[] = {{"al", ""},    {"ance", ""}, {"ence", ""}, {"er", ""},
-                  {"ic", ""},    {"able", ""}, {"ible", ""}, {"ant", ""},
-                  {"ement", ""}, {"ment", ""}, {"ism", ""},  {"ate", ""},
-                  {"iti", ""},   {"ous", ""},  {"ive", ""},  {"ize", ""}};
-
-    for (auto& sub : subs)
-        if (replace_if_exists(word, sub.first, sub.second, startR2))
-            return;
+    static const suffix_sub e_subs[]
+        = {{"ance", ""}, {"ence", ""}, {"able", ""}, {"ible", ""},
+           {"ate", ""},  {"ive", ""},  {"ize", ""}};
+    static const suffix_sub t_subs[]
+        = {{"ant", ""}, {"ement", ""}, {"ment", ""}};
+
+    if (word.empty())
+        return;
 
-    // make sure we only choose the longest suffix
-    if (!ends_with(word, "ement") && !ends_with(word, "ment"))
-        if (replace_if_exists(word, "ent", "", startR2))
+    switch (word.back())
+    {
+        case 'l':
+            replace_if_exists(word, "al", "", startR2);
+            return;
+        case 'e':
+            replace_first(word, e_subs, startR2);
+            return;
+        case 'r':
+            replace_if_exists(word, "er", "", startR2);
+            return;
+        case 'c':
+            replace_if_exists(word, "ic", "", startR2);
+            return;
+        case 'm':
+            replace_if_exists(word, "ism", "", startR2);
+            return;
+        case 'i':
+            replace_if_exists(word, "iti", "", startR2);
+            return;
+        case 's':
+            replace_if_exists(word, "ous", "", startR2);
             return;
+        case 't':
+            if (replace_first(word, t_subs, startR2))
+                return;
 
-    // short circuit
-    replace_if_exists(word, "sion", "s", startR2 - 1)
-        || replace_if_exists(word, "tion", "t", startR2 - 1);
+            // make sure we only choose the longest suffix
+            if (!ends_with(word, "ement") && !ends_with(word, "ment"))
+                replace_if_exists(word, "ent", "", startR2);
+            return;
+        case 'n':
+            // short circuit
+            replace_if_exists(word, "sion", "s", startR2 - 1)
+                || replace_if_exists(word, "tion", "t", startR2 - 1);
+            return;
+        default:
+            return;
+    }
 }
 
 /*
@@ -477,6 +578,18 @@ void stem(std::string& word)
     std::replace(word.begin(), word.end(), 'Y', 'y');
     return;
 }
+
+void stem_batch(std::vector<std::string>::iterator first,
+                std::vector<std::string>::iterator last)
+{
+    for (; first != last; ++first)
+        stem(*first);
+}
+
+void stem_batch(std::vector<std::string>& words)
+{
+    stem_batch(words.begin(), words.end());
+}
 }
 }
 }
@@ -34,7 +34,7 @@ void ptb_normalizer::set_content(std::string&& content)
     source_->set_content(std::move(content));
 }
 
-std::string ptb_normalizer::next()
+util::string_view ptb_normalizer::next()
 {
     // if we have buffered tokens, keep returning them until we have
     // exhausted the buffer
@@ -66,9 +66,12 @@ std::string ptb_normalizer::next()
                 return current_token();
             }
 
+            // parse_token() may read ahead and invalidate the view, so
+            // check for the sentence end marker before handing it off
+            auto end_marker = nxt == "</s>";
             parse_token(nxt);
 
-            if (nxt == "</s>")
+            if (end_marker)
                 return current_token();
         }
 
@@ -87,14 +90,19 @@ ptb_normalizer::operator bool() const
     return !tokens_.empty() || (*source_);
 }
 
-std::string ptb_normalizer::current_token()
+util::string_view ptb_normalizer::current_token()
 {
-    auto token = tokens_.front();
+    current_ = std::move(tokens_.front());
     tokens_.pop_front();
-    return token;
+    return current_;
 }
 
-void ptb_normalizer::parse_token(const std::string& token)
+void ptb_normalizer::buffer_token(util::string_view token)
+{
+    tokens_.emplace_back(token.begin(), token.end());
+}
+
+void ptb_normalizer::parse_token(util::string_view token)
 {
     /// @see http://www.cis.upenn.edu/~treebank/tokenizer.sed
     if (token == "(")
@@ -134,8 +142,8 @@ void ptb_normalizer::parse_token(const std::string& token)
         // possessive or close single quote
         if (apos == token.length() - 1 && token.length() > 1)
         {
-            tokens_.push_back(token.substr(0, apos));
-            tokens_.push_back(token.substr(apos));
+            buffer_token(token.substr(0, apos));
+            buffer_token(token.substr(apos));
             return;
         }
         else if (apos + 1 == token.length() - 1)
@@ -145,16 +153,16 @@ void ptb_normalizer::parse_token(const std::string& token)
             // as in it's, I'm, we'd
             if (after == 's' || after == 'm' || after == 'd')
             {
-                tokens_.push_back(token.substr(0, apos));
-                tokens_.push_back(token.substr(apos));
+                buffer_token(token.substr(0, apos));
+                buffer_token(token.substr(apos));
                 return;
             }
             // n't
             else if (after == 't' && apos != 0
                      && std::tolower(token.at(apos - 1)) == 'n')
             {
-                tokens_.push_back(token.substr(0, apos - 1));
-                tokens_.push_back(token.substr(apos - 1));
+                buffer_token(token.substr(0, apos - 1));
+                buffer_token(token.substr(apos - 1));
                 return;
             }
         }
@@ -166,35 +174,37 @@ void ptb_normalizer::parse_token(const std::string& token)
             if ((after1 == 'l' && after2 == 'l')
                 || ((after1 == 'r' || after1 == 'v') && after2 == 'e'))
             {
-                tokens_.push_back(token.substr(0, apos));
-                tokens_.push_back(token.substr(apos));
+                buffer_token(token.substr(0, apos));
+                buffer_token(token.substr(apos));
                 return;
             }
         }
     }
 
-    auto lower = token;
-    std::transform(token.begin(), token.end(), lower.begin(), [](char c)
+    std::string lower{token.begin(), token.end()};
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](char c)
                    {
         return std::tolower(c);
     });
 
     if (lower.find("d'ye") != lower.npos)
     {
-        tokens_.push_back(token.substr(0, token.find("'") + 1));
+        buffer_token(token.substr(0, token.find("'") + 1));
         tokens_.push_back("ye");
         return;
     }
     else if (lower == "more'n")
     {
-        tokens_.push_back(token.substr(0, token.find("'")));
+        buffer_token(token.substr(0, token.find("'")));
         tokens_.push_back("'n");
         return;
     }
     else if (token == "'" && *source_)
     {
+        // note: fetching the lookahead token invalidates the token view,
+        // but we know it was a lone apostrophe
         auto nxt = source_->next();
-        auto lnxt = nxt;
+        std::string lnxt{nxt.begin(), nxt.end()};
         std::transform(lnxt.begin(), lnxt.end(), lnxt.begin(), [](char c)
                        {
             return std::tolower(c);
@@ -205,24 +215,24 @@ void ptb_normalizer::parse_token(const std::string& token)
             std::string apot = "'";
             apot += nxt.at(0);
             tokens_.push_back(apot);
-            tokens_.push_back(nxt.substr(1));
+            buffer_token(nxt.substr(1));
             return;
         }
 
-        tokens_.push_back(token);
+        tokens_.push_back("'");
         parse_token(nxt);
         return;
     }
     else if (lower == "cannot" || lower == "gimme" || lower == "gonna"
              || lower == "lemme" || lower == "wanna")
     {
-        tokens_.push_back(token.substr(0, 3));
-        tokens_.push_back(token.substr(3));
+        buffer_token(token.substr(0, 3));
+        buffer_token(token.substr(3));
         return;
     }
 
     // if all checks passed through, then leave the token alone
-    tokens_.push_back(token);
+    buffer_token(token);
 }
 }
 }
@@ -96,7 +96,7 @@ void sentence_boundary::load_heuristics(const cpptoml::table& config)
     heuristics_loaded = true;
 }
 
-std::string sentence_boundary::next()
+util::string_view sentence_boundary::next()
 {
     if (tokens_.empty())
     {
@@ -104,7 +104,8 @@ std::string sentence_boundary::next()
         // in source
         if (!*source_)
             throw token_stream_exception{"next() called with empty source"};
-        tokens_.emplace_back(source_->next());
+        auto tok = source_->next();
+        tokens_.emplace_back(tok.begin(), tok.end());
     }
 
     if (!possible_punc(tokens_.front()) || (prev_ && !possible_end(*prev_)))
@@ -118,7 +119,10 @@ std::string sentence_boundary::next()
         return current_token();
     }
 
-    auto token = source_->next();
+    // copy the lookahead token, since fetching another token from the
+    // source invalidates the view
+    auto tok = source_->next();
+    std::string token{tok.begin(), tok.end()};
 
     // we only break sentences after whitespace
     if (token != " ")
@@ -135,7 +139,8 @@ std::string sentence_boundary::next()
         return current_token();
     }
 
-    auto start_token = source_->next();
+    auto start_view = source_->next();
+    std::string start_token{start_view.begin(), start_view.end()};
     if (!possible_start(start_token))
     {
         tokens_.emplace_back(std::move(token));
@@ -157,12 +162,12 @@ sentence_boundary::operator bool() const
     return !tokens_.empty() || *source_;
 }
 
-std::string sentence_boundary::current_token()
+util::string_view sentence_boundary::current_token()
 {
-    auto token = tokens_.front();
-    prev_ = token;
+    current_ = std::move(tokens_.front());
+    prev_ = current_;
     tokens_.pop_front();
-    return token;
+    return current_;
 }
 
 bool sentence_boundary::possible_punc(const std::string& token)
@@ -0,0 +1,97 @@
+/**
+ * @file fused_unigram_chain.cpp
+ * @author Chase Geigle
+ */
+
+#include <fstream>
+
+#include "meta/analyzers/filters/porter2_stemmer.h"
+#include "meta/analyzers/fused_unigram_chain.h"
+#include "meta/utf/utf.h"
+
+namespace meta
+{
+namespace analyzers
+{
+
+const util::string_view fused_unigram_chain::id = "default-unigram-chain";
+
+fused_unigram_chain::fused_unigram_chain(const std::string& stopword_file)
+    : tokenizer_{true} // suppress "<s>", "</s>"
+{
+    std::ifstream file{stopword_file};
+    if (!file)
+        throw token_stream_exception{"invalid stopword file: "
+                                     + stopword_file};
+
+    std::string line;
+    while (std::getline(file, line))
+        stopwords_.emplace(std::move(line));
+}
+
+fused_unigram_chain::fused_unigram_chain(const fused_unigram_chain& other)
+    : tokenizer_{other.tokenizer_},
+      stopwords_{other.stopwords_},
+      token_{other.token_},
+      has_token_{other.has_token_}
+{
+    // nothing
+}
+
+void fused_unigram_chain::set_content(std::string&& content)
+{
+    tokenizer_.set_content(std::move(content));
+    next_token();
+}
+
+util::string_view fused_unigram_chain::next()
+{
+    using std::swap;
+    swap(current_, token_);
+    next_token();
+    return current_;
+}
+
+void fused_unigram_chain::next_token()
+{
+    while (tokenizer_)
+    {
+        auto tok = tokenizer_.next();
+
+        // lowercase
+        scratch_.assign(tok.data(), tok.size());
+        token_ = utf::foldcase(scratch_);
+
+        // alpha (keeping apostrophes, as alpha_filter does)
+        token_ = utf::remove_if(token_, [](uint32_t codepoint) {
+            return !utf::isalpha(codepoint) && codepoint != '\'';
+        });
+        if (token_.empty())
+            continue;
+
+        // length
+        auto len = utf::length(token_);
+        if (len < 2 || len > 35)
+            continue;
+
+        // stopwords
+        if (stopwords_.find(token_) != stopwords_.end())
+            continue;
+
+        // porter2, stemming in place
+        filters::porter2::stem(token_);
+        if (token_.empty())
+            continue;
+
+        has_token_ = true;
+        return;
+    }
+    has_token_ = false;
+}
+
+fused_unigram_chain::operator bool() const
+{
+    return has_token_;
+}
+}
+}
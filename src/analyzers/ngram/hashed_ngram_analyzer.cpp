@@ -0,0 +1,103 @@
+/**
+ * @file hashed_ngram_analyzer.cpp
+ * @author Chase Geigle
+ */
+
+#include <deque>
+
+#include "cpptoml.h"
+#include "meta/analyzers/ngram/hashed_ngram_analyzer.h"
+#include "meta/analyzers/token_stream.h"
+#include "meta/corpus/document.h"
+#include "meta/hashing/hash.h"
+#include "meta/util/shim.h"
+
+namespace meta
+{
+namespace analyzers
+{
+
+hashed_ngram_analyzer::hashed_ngram_analyzer(
+    uint16_t n, uint8_t bits, std::unique_ptr<token_stream> stream)
+    : n_{n},
+      mask_{bits >= 64 ? static_cast<uint64_t>(-1) : (1ull << bits) - 1},
+      stream_{std::move(stream)}
+{
+    if (bits == 0)
+        throw analyzer_exception{
+            "hashed ngram analyzer requires a positive bit width"};
+}
+
+hashed_ngram_analyzer::hashed_ngram_analyzer(const hashed_ngram_analyzer& other)
+    : n_{other.n_}, mask_{other.mask_}, stream_{other.stream_->clone()}
+{
+    // nothing
+}
+
+learn::feature_vector hashed_ngram_analyzer::analyze(
+    const corpus::document& doc)
+{
+    stream_->set_content(get_content(doc));
+    learn::feature_vector counts;
+    std::deque<uint64_t> window;
+    while (*stream_)
+    {
+        auto tok = stream_->next();
+        hashing::farm_hash tok_hash;
+        tok_hash(tok.data(), tok.size());
+        window.push_back(static_cast<uint64_t>(tok_hash));
+        if (window.size() == n_)
+        {
+            uint64_t id;
+            if (n_ == 1)
+            {
+                id = window.front();
+            }
+            else
+            {
+                // combine the per-token hashes instead of hashing a
+                // concatenated string; each token's bytes are only
+                // hashed once no matter how many n-grams it is part of
+                hashing::farm_hash hash;
+                for (auto h : window)
+                    hash(&h, sizeof(h));
+                id = static_cast<uint64_t>(hash);
+            }
+            counts[learn::feature_id{id & mask_}] += 1;
+            window.pop_front();
+        }
+    }
+    return counts;
+}
+
+uint16_t hashed_ngram_analyzer::n_value() const
+{
+    return n_;
+}
+
+uint64_t hashed_ngram_analyzer::num_features() const
+{
+    return mask_ + 1;
+}
+
+std::unique_ptr<hashed_ngram_analyzer>
+make_hashed_ngram_analyzer(const cpptoml::table& global,
+                           const cpptoml::table& config)
+{
+    auto n_val = config.get_as<int64_t>("ngram");
+    if (!n_val)
+        throw analyzer_exception{
+            "ngram size needed for hashed ngram analyzer in config file"};
+
+    auto bits = config.get_as<int64_t>("hash-bits").value_or(18);
+    if (bits < 1 || bits > 64)
+        throw analyzer_exception{
+            "hash-bits for hashed ngram analyzer must be between 1 and 64"};
+
+    auto filts = load_filters(global, config);
+    return make_unique<hashed_ngram_analyzer>(
+        static_cast<uint16_t>(*n_val), static_cast<uint8_t>(bits),
+        std::move(filts));
+}
+}
+}
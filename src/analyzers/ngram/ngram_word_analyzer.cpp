@@ -3,6 +3,7 @@
  * @author Sean Massung
  */
 
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -35,10 +36,13 @@ void ngram_word_analyzer::tokenize(const corpus::document& doc,
                                    featurizer& counts)
 {
     stream_->set_content(get_content(doc));
-    std::deque<std::string> tokens;
+    arena_.reset();
+    std::deque<std::string, util::arena_allocator<std::string>> tokens{
+        util::arena_allocator<std::string>{arena_}};
     while (*stream_)
     {
-        tokens.emplace_back(stream_->next());
+        auto tok = stream_->next();
+        tokens.emplace_back(tok.begin(), tok.end());
         if (tokens.size() == this->n_value())
         {
             auto combined = std::move(tokens.front());
@@ -27,12 +27,12 @@ void character_tokenizer::set_content(std::string&& content)
     content_ = std::move(content);
 }
 
-std::string character_tokenizer::next()
+util::string_view character_tokenizer::next()
 {
     if (!*this)
         throw token_stream_exception{"next() called with no tokens left"};
 
-    return {content_[idx_++]};
+    return {content_.data() + idx_++, 1};
 }
 
 character_tokenizer::operator bool() const
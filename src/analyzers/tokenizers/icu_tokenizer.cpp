@@ -11,6 +11,7 @@
 #include "meta/utf/segmenter.h"
 #include "meta/utf/utf.h"
 #include "meta/util/pimpl.tcc"
+#include "meta/util/profile.h"
 
 namespace meta
 {
@@ -54,13 +55,18 @@ class icu_tokenizer::impl
         std::replace_if(content.begin(), content.end(), pred, ' ');
 
         segmenter_.set_content(content);
-        for (const auto& sentence : segmenter_.sentences())
+        // one bulk pass over the document; the scratch vectors are
+        // reused from one document to the next
+        segmenter_.bulk_segment(sentences_, words_);
+        auto word = words_.begin();
+        for (const auto& sentence : sentences_)
         {
             if (!suppress_tags_)
                 tokens_.emplace_back("<s>");
-            for (const auto& word : segmenter_.words(sentence))
+            for (; word != words_.end() && word->end() <= sentence.end();
+                 ++word)
             {
-                auto wrd = segmenter_.content(word);
+                auto wrd = segmenter_.content(*word);
                 if (wrd.empty())
                     continue;
 
@@ -81,15 +87,16 @@ class icu_tokenizer::impl
     }
 
     /**
-     * @return the next token
+     * @return the next token, viewed from a buffer that is reused by the
+     * following call
      */
-    std::string next()
+    util::string_view next()
     {
         if (!*this)
             throw token_stream_exception{"next() called with no tokens left"};
-        auto result = std::move(tokens_.front());
+        current_ = std::move(tokens_.front());
         tokens_.pop_front();
-        return result;
+        return current_;
     }
 
     /**
@@ -107,8 +114,17 @@ class icu_tokenizer::impl
     /// UTF segmenter to use for this tokenizer
     utf::segmenter segmenter_;
 
+    /// Scratch storage for the sentence segments of the current document
+    std::vector<utf::segmenter::segment> sentences_;
+
+    /// Scratch storage for the word segments of the current document
+    std::vector<utf::segmenter::segment> words_;
+
     /// Buffered tokens
     std::deque<std::string> tokens_;
+
+    /// The most recently emitted token
+    std::string current_;
 };
 
 icu_tokenizer::icu_tokenizer(bool suppress_tags) : impl_{suppress_tags}
@@ -136,8 +152,10 @@ void icu_tokenizer::set_content(std::string&& content)
     impl_->set_content(std::move(content));
 }
 
-std::string icu_tokenizer::next()
+util::string_view icu_tokenizer::next()
 {
+    META_PROFILE_SCOPE("icu_tokenizer::next");
+    META_PROFILE_COUNT("icu_tokenizer::tokens", 1);
     return impl_->next();
 }
 
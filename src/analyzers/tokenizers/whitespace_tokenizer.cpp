@@ -40,7 +40,7 @@ void whitespace_tokenizer::consume_adjacent_whitespace()
     });
 }
 
-std::string whitespace_tokenizer::next()
+util::string_view whitespace_tokenizer::next()
 {
     if (!*this)
         throw token_stream_exception{"next() called with no tokens left"};
@@ -54,7 +54,9 @@ std::string whitespace_tokenizer::next()
         else
         {
             // all whitespace chars are their own token
-            return std::string(1, *it_++);
+            util::string_view ret{&*it_, 1};
+            ++it_;
+            return ret;
         }
     }
 
@@ -64,7 +66,7 @@ std::string whitespace_tokenizer::next()
     it_ = std::find_if(it_, content_.cend(), [](char c) {
         return std::isspace(c);
     });
-    std::string ret{begin, it_};
+    util::string_view ret{&*begin, static_cast<std::size_t>(it_ - begin)};
     assert(!ret.empty());
 
     if (suppress_whitespace_)
@@ -0,0 +1,201 @@
+/**
+ * @file bench_analyzers.cpp
+ * @author Chase Geigle
+ *
+ * Microbenchmark for the tokenizers and filters in meta::analyzers.
+ * Runs each tokenizer by itself, then the default unigram chain one
+ * filter at a time, attributing the incremental cost of each stage so
+ * that throughput regressions show up at commit time rather than in a
+ * nightly index build.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "cpptoml.h"
+#include "meta/analyzers/filters/all.h"
+#include "meta/analyzers/fused_unigram_chain.h"
+#include "meta/analyzers/token_stream.h"
+#include "meta/analyzers/tokenizers/character_tokenizer.h"
+#include "meta/analyzers/tokenizers/icu_tokenizer.h"
+#include "meta/analyzers/tokenizers/whitespace_tokenizer.h"
+#include "meta/io/filesystem.h"
+#include "meta/logging/logger.h"
+#include "meta/util/shim.h"
+
+using namespace meta;
+
+namespace
+{
+struct result
+{
+    std::string name;
+    uint64_t tokens;
+    double seconds;
+};
+
+/**
+ * Drains the given stream over the text `iters` times and returns the
+ * token count and elapsed wall time.
+ */
+result bench(const std::string& name,
+             std::unique_ptr<analyzers::token_stream> stream,
+             const std::string& text, uint64_t iters)
+{
+    using namespace std::chrono;
+    uint64_t tokens = 0;
+    auto start = steady_clock::now();
+    for (uint64_t i = 0; i < iters; ++i)
+    {
+        stream->set_content(std::string{text});
+        while (*stream)
+        {
+            stream->next();
+            ++tokens;
+        }
+    }
+    auto elapsed = duration_cast<duration<double>>(steady_clock::now() - start);
+    return {name, tokens, elapsed.count()};
+}
+
+void report(const result& res, const result* prev = nullptr)
+{
+    auto toks_per_sec = static_cast<double>(res.tokens) / res.seconds;
+    std::cout << std::left << std::setw(28) << res.name << std::right
+              << std::setw(12) << res.tokens << " tokens " << std::setw(10)
+              << std::fixed << std::setprecision(1) << (res.seconds * 1000)
+              << " ms " << std::setw(12) << std::setprecision(0)
+              << toks_per_sec << " tokens/sec";
+    if (prev)
+    {
+        // incremental cost of this stage relative to the chain prefix
+        // that feeds it, in nanoseconds per *input* token
+        auto delta = res.seconds - prev->seconds;
+        auto ns_per_tok = delta * 1e9 / static_cast<double>(prev->tokens);
+        std::cout << " (+" << std::setprecision(1) << ns_per_tok
+                  << " ns/input token)";
+    }
+    std::cout << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " text-file stopwords-file [boundaries-dir] [iters]"
+                  << std::endl;
+        std::cerr << "e.g.: " << argv[0]
+                  << " ../data/sample-document.txt"
+                     " ../data/lemur-stopwords.txt"
+                     " ../data/sentence-boundaries 50"
+                  << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging();
+
+    std::string text = filesystem::file_text(argv[1]);
+    std::string stopwords{argv[2]};
+    std::string boundaries = argc > 3 ? argv[3] : "";
+    uint64_t iters = argc > 4 ? std::stoul(argv[4]) : 50;
+
+    using namespace analyzers;
+
+    std::cout << "tokenizers:" << std::endl;
+    report(bench("whitespace_tokenizer",
+                 make_unique<tokenizers::whitespace_tokenizer>(), text,
+                 iters));
+    report(bench("character_tokenizer",
+                 make_unique<tokenizers::character_tokenizer>(), text,
+                 iters));
+    report(bench("icu_tokenizer", make_unique<tokenizers::icu_tokenizer>(),
+                 text, iters));
+
+    // the default unigram chain, one filter at a time; each stage's
+    // incremental cost is attributed against the prefix that feeds it
+    std::cout << std::endl << "default unigram chain, by stage:" << std::endl;
+    auto tokenizer
+        = []() { return make_unique<tokenizers::icu_tokenizer>(true); };
+
+    auto prev = bench("icu_tokenizer(no tags)", tokenizer(), text, iters);
+    report(prev);
+
+    auto lower = [&]() {
+        return make_unique<filters::lowercase_filter>(tokenizer());
+    };
+    auto cur = bench("+ lowercase_filter", lower(), text, iters);
+    report(cur, &prev);
+    prev = cur;
+
+    auto alpha = [&]() {
+        return make_unique<filters::alpha_filter>(lower());
+    };
+    cur = bench("+ alpha_filter", alpha(), text, iters);
+    report(cur, &prev);
+    prev = cur;
+
+    auto length = [&]() {
+        return make_unique<filters::length_filter>(alpha(), 2, 35);
+    };
+    cur = bench("+ length_filter", length(), text, iters);
+    report(cur, &prev);
+    prev = cur;
+
+    auto list = [&]() {
+        return make_unique<filters::list_filter>(length(), stopwords);
+    };
+    cur = bench("+ list_filter", list(), text, iters);
+    report(cur, &prev);
+    prev = cur;
+
+    auto porter2 = [&]() {
+        return make_unique<filters::porter2_filter>(list());
+    };
+    cur = bench("+ porter2_filter", porter2(), text, iters);
+    report(cur, &prev);
+    prev = cur;
+
+    std::cout << std::endl << "fused chain:" << std::endl;
+    report(bench("fused_unigram_chain",
+                 make_unique<fused_unigram_chain>(stopwords), text, iters),
+           &prev);
+
+    // other representative filters over the plain tokenizer
+    std::cout << std::endl << "other filters:" << std::endl;
+    prev = bench("icu_tokenizer", make_unique<tokenizers::icu_tokenizer>(),
+                 text, iters);
+    report(bench("+ english_normalizer",
+                 make_unique<filters::english_normalizer>(
+                     make_unique<tokenizers::icu_tokenizer>()),
+                 text, iters),
+           &prev);
+    report(bench("+ empty_sentence_filter",
+                 make_unique<filters::empty_sentence_filter>(
+                     make_unique<tokenizers::icu_tokenizer>()),
+                 text, iters),
+           &prev);
+
+    if (!boundaries.empty())
+    {
+        auto config = cpptoml::make_table();
+        config->insert("punctuation",
+                       boundaries + "/sentence-punctuation.txt");
+        config->insert("start-exceptions",
+                       boundaries + "/sentence-start-exceptions.txt");
+        config->insert("end-exceptions",
+                       boundaries + "/sentence-end-exceptions.txt");
+        filters::sentence_boundary::load_heuristics(*config);
+        report(bench("+ sentence_boundary",
+                     make_unique<filters::sentence_boundary>(
+                         make_unique<tokenizers::icu_tokenizer>()),
+                     text, iters),
+               &prev);
+    }
+
+    return 0;
+}
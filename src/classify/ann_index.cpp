@@ -0,0 +1,293 @@
+/**
+ * @file ann_index.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include "meta/classify/ann_index.h"
+#include "meta/io/packed.h"
+
+namespace meta
+{
+namespace classify
+{
+
+namespace
+{
+/**
+ * Dot product of two sparse vectors via a merge over their sorted
+ * contents.
+ */
+double dot_product(const learn::feature_vector& a,
+                   const learn::feature_vector& b)
+{
+    auto dot = 0.0;
+    auto a_it = a.begin();
+    auto b_it = b.begin();
+    while (a_it != a.end() && b_it != b.end())
+    {
+        if (a_it->first < b_it->first)
+            ++a_it;
+        else if (b_it->first < a_it->first)
+            ++b_it;
+        else
+        {
+            dot += a_it->second * b_it->second;
+            ++a_it;
+            ++b_it;
+        }
+    }
+    return dot;
+}
+
+/**
+ * Scales a sparse vector to unit L2 norm (no-op for zero vectors).
+ */
+void unit_normalize(learn::feature_vector& vec)
+{
+    auto norm = 0.0;
+    for (const auto& pr : vec)
+        norm += pr.second * pr.second;
+    if (norm <= 0)
+        return;
+    norm = std::sqrt(norm);
+    for (auto& pr : vec)
+        pr.second /= norm;
+}
+}
+
+ann_index::ann_index(
+    std::vector<std::pair<doc_id, learn::feature_vector>> vectors,
+    options_type options)
+    : num_probes_{options.num_probes}
+{
+    vectors_.reserve(vectors.size());
+    ids_.reserve(vectors.size());
+    for (auto& pr : vectors)
+    {
+        ids_.push_back(pr.first);
+        vectors_.emplace_back(std::move(pr.second));
+        unit_normalize(vectors_.back());
+    }
+
+    auto num_clusters = options.num_clusters;
+    if (num_clusters == 0)
+        num_clusters = static_cast<uint64_t>(
+            std::ceil(std::sqrt(static_cast<double>(vectors_.size()))));
+    num_clusters = std::max<uint64_t>(
+        1, std::min<uint64_t>(num_clusters, vectors_.size()));
+
+    build_clusters(num_clusters, options.max_iters);
+}
+
+void ann_index::build_clusters(uint64_t num_clusters, uint64_t max_iters)
+{
+    // seed the centroids with a deterministic random sample for
+    // reproducibility between runs
+    std::vector<uint64_t> indices(vectors_.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::mt19937 rng{47};
+    std::shuffle(indices.begin(), indices.end(), rng);
+
+    centroids_.assign(indices.begin(),
+                      indices.begin() + static_cast<std::ptrdiff_t>(
+                                            num_clusters));
+    for (std::size_t i = 0; i < num_clusters; ++i)
+        centroids_[i] = vectors_[indices[i]];
+
+    std::vector<uint64_t> assignment(vectors_.size(), 0);
+    for (uint64_t iter = 0; iter < max_iters; ++iter)
+    {
+        // assignment step: each vector moves to its most similar
+        // centroid
+        bool changed = false;
+        for (uint64_t v = 0; v < vectors_.size(); ++v)
+        {
+            uint64_t best = assignment[v];
+            auto best_sim = std::numeric_limits<double>::lowest();
+            for (uint64_t c = 0; c < centroids_.size(); ++c)
+            {
+                auto sim = dot_product(vectors_[v], centroids_[c]);
+                if (sim > best_sim)
+                {
+                    best_sim = sim;
+                    best = c;
+                }
+            }
+            if (best != assignment[v])
+            {
+                assignment[v] = best;
+                changed = true;
+            }
+        }
+        if (iter > 0 && !changed)
+            break;
+
+        // update step: spherical k-means takes the normalized mean of
+        // each cluster's members; empty clusters keep their centroid
+        for (uint64_t c = 0; c < centroids_.size(); ++c)
+        {
+            std::vector<std::pair<learn::feature_id, double>> sum;
+            for (uint64_t v = 0; v < vectors_.size(); ++v)
+            {
+                if (assignment[v] != c)
+                    continue;
+                sum.insert(sum.end(), vectors_[v].begin(), vectors_[v].end());
+            }
+            if (sum.empty())
+                continue;
+
+            std::sort(sum.begin(), sum.end(),
+                      [](const std::pair<learn::feature_id, double>& a,
+                         const std::pair<learn::feature_id, double>& b)
+                      {
+                          return a.first < b.first;
+                      });
+            std::vector<std::pair<learn::feature_id, double>> combined;
+            for (const auto& pr : sum)
+            {
+                if (!combined.empty() && combined.back().first == pr.first)
+                    combined.back().second += pr.second;
+                else
+                    combined.push_back(pr);
+            }
+            centroids_[c].contents(std::move(combined));
+            unit_normalize(centroids_[c]);
+        }
+    }
+
+    clusters_.assign(centroids_.size(), {});
+    for (uint64_t v = 0; v < vectors_.size(); ++v)
+        clusters_[assignment[v]].push_back(v);
+}
+
+std::vector<std::pair<doc_id, double>>
+ann_index::query(const learn::feature_vector& query, uint64_t k) const
+{
+    auto normed = query;
+    unit_normalize(normed);
+
+    // rank the centroids and probe the closest clusters
+    std::vector<std::pair<double, uint64_t>> centroid_sims;
+    centroid_sims.reserve(centroids_.size());
+    for (uint64_t c = 0; c < centroids_.size(); ++c)
+        centroid_sims.emplace_back(dot_product(normed, centroids_[c]), c);
+
+    auto num_probes = std::min<uint64_t>(num_probes_, centroids_.size());
+    std::partial_sort(centroid_sims.begin(),
+                      centroid_sims.begin()
+                          + static_cast<std::ptrdiff_t>(num_probes),
+                      centroid_sims.end(),
+                      std::greater<std::pair<double, uint64_t>>{});
+
+    std::vector<std::pair<double, uint64_t>> candidates;
+    for (uint64_t p = 0; p < num_probes; ++p)
+    {
+        for (auto v : clusters_[centroid_sims[p].second])
+            candidates.emplace_back(dot_product(normed, vectors_[v]), v);
+    }
+
+    auto num_results = std::min<uint64_t>(k, candidates.size());
+    std::partial_sort(candidates.begin(),
+                      candidates.begin()
+                          + static_cast<std::ptrdiff_t>(num_results),
+                      candidates.end(),
+                      std::greater<std::pair<double, uint64_t>>{});
+
+    std::vector<std::pair<doc_id, double>> results;
+    results.reserve(num_results);
+    for (uint64_t i = 0; i < num_results; ++i)
+        results.emplace_back(ids_[candidates[i].second], candidates[i].first);
+    return results;
+}
+
+uint64_t ann_index::size() const
+{
+    return vectors_.size();
+}
+
+namespace
+{
+void write_vector(std::ostream& out, const learn::feature_vector& vec)
+{
+    io::packed::write(out, vec.size());
+    for (const auto& pr : vec)
+    {
+        io::packed::write(out, static_cast<uint64_t>(pr.first));
+        io::packed::write(out, pr.second);
+    }
+}
+
+learn::feature_vector read_vector(std::istream& in)
+{
+    auto size = io::packed::read<uint64_t>(in);
+    std::vector<std::pair<learn::feature_id, double>> contents;
+    contents.reserve(size);
+    for (uint64_t i = 0; i < size; ++i)
+    {
+        auto idx = io::packed::read<uint64_t>(in);
+        auto val = io::packed::read<double>(in);
+        contents.emplace_back(learn::feature_id{idx}, val);
+    }
+    learn::feature_vector vec;
+    vec.contents(std::move(contents));
+    return vec;
+}
+}
+
+void ann_index::save(std::ostream& out) const
+{
+    io::packed::write(out, vectors_.size());
+    for (uint64_t v = 0; v < vectors_.size(); ++v)
+    {
+        io::packed::write(out, ids_[v]);
+        write_vector(out, vectors_[v]);
+    }
+
+    io::packed::write(out, centroids_.size());
+    for (const auto& centroid : centroids_)
+        write_vector(out, centroid);
+
+    for (const auto& cluster : clusters_)
+    {
+        io::packed::write(out, cluster.size());
+        for (auto v : cluster)
+            io::packed::write(out, v);
+    }
+
+    io::packed::write(out, num_probes_);
+}
+
+ann_index::ann_index(std::istream& in)
+{
+    auto num_vectors = io::packed::read<uint64_t>(in);
+    ids_.reserve(num_vectors);
+    vectors_.reserve(num_vectors);
+    for (uint64_t v = 0; v < num_vectors; ++v)
+    {
+        ids_.push_back(io::packed::read<doc_id>(in));
+        vectors_.push_back(read_vector(in));
+    }
+
+    auto num_clusters = io::packed::read<uint64_t>(in);
+    centroids_.reserve(num_clusters);
+    for (uint64_t c = 0; c < num_clusters; ++c)
+        centroids_.push_back(read_vector(in));
+
+    clusters_.resize(num_clusters);
+    for (auto& cluster : clusters_)
+    {
+        auto size = io::packed::read<uint64_t>(in);
+        cluster.reserve(size);
+        for (uint64_t i = 0; i < size; ++i)
+            cluster.push_back(io::packed::read<uint64_t>(in));
+    }
+
+    io::packed::read(in, num_probes_);
+}
+}
+}
@@ -8,6 +8,8 @@
 #include "meta/logging/logger.h"
 #include "meta/classify/classifier/classifier.h"
 #include "meta/classify/classifier_factory.h"
+#include "meta/classify/concurrent_confusion_matrix.h"
+#include "meta/parallel/parallel_for.h"
 
 namespace meta
 {
@@ -16,13 +18,66 @@ namespace classify
 
 confusion_matrix classifier::test(dataset_view_type docs) const
 {
+    parallel::thread_pool pool;
+    auto predicted = classify_batch(docs, pool);
 
-    confusion_matrix matrix;
-    for (const auto& instance : docs)
-        matrix.add(predicted_label{classify(instance.weights)},
-                   docs.label(instance));
+    // the label set is known up front, so the counts can be accumulated
+    // into a dense atomic matrix from all of the workers at once
+    std::vector<class_label> labels;
+    labels.reserve(docs.total_labels());
+    for (auto it = docs.labels_begin(); it != docs.labels_end(); ++it)
+        labels.push_back(it->first);
+    concurrent_confusion_matrix matrix{std::move(labels)};
 
-    return matrix;
+    auto begin = docs.begin();
+    auto futures = parallel::for_each_block(
+        begin, docs.end(), pool,
+        [&](dataset_view_type::iterator tbegin,
+            dataset_view_type::iterator tend)
+        {
+            for (auto it = tbegin; it != tend; ++it)
+                matrix.add(
+                    predicted_label{
+                        predicted[static_cast<std::size_t>(it - begin)]},
+                    docs.label(*it));
+        });
+    for (auto& fut : futures)
+    {
+        pool.wait(fut);
+        fut.get();
+    }
+
+    return matrix.matrix();
+}
+
+std::vector<class_label>
+classifier::classify_batch(const dataset_view_type& docs,
+                           parallel::thread_pool& pool) const
+{
+    std::vector<class_label> labels(docs.size());
+    auto begin = docs.begin();
+    auto futures = parallel::for_each_block(
+        begin, docs.end(), pool,
+        [&](dataset_view_type::iterator tbegin,
+            dataset_view_type::iterator tend)
+        {
+            for (auto it = tbegin; it != tend; ++it)
+                labels[static_cast<std::size_t>(it - begin)]
+                    = classify(it->weights);
+        });
+    for (auto& fut : futures)
+    {
+        pool.wait(fut);
+        fut.get();
+    }
+    return labels;
+}
+
+std::vector<class_label>
+classifier::classify_batch(const dataset_view_type& docs) const
+{
+    parallel::thread_pool pool;
+    return classify_batch(docs, pool);
 }
 
 confusion_matrix cross_validate(const cpptoml::table& config,
@@ -36,5 +91,18 @@ confusion_matrix cross_validate(const cpptoml::table& config,
         },
         std::move(docs), k, even_split);
 }
+
+confusion_matrix cross_validate(const cpptoml::table& config,
+                                classifier::dataset_view_type docs, size_t k,
+                                parallel::thread_pool& pool,
+                                bool even_split /* = false */)
+{
+    return cross_validate(
+        [&](multiclass_dataset_view fold)
+        {
+            return make_classifier(config, std::move(fold));
+        },
+        std::move(docs), k, pool, even_split);
+}
 }
 }
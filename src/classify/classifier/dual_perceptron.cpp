@@ -73,6 +73,7 @@ dual_perceptron::dual_perceptron(std::istream& in)
             auto weight = io::packed::read<double>(in);
             map_ref.emplace_back(fid, weight);
         }
+        evaluator_.add(id, map_ref);
     }
 
     // kernel function
@@ -143,7 +144,10 @@ void dual_perceptron::train(multiclass_dataset_view docs)
                 ++error_count;
                 // memorize the training instance if we haven't already
                 if (svs_.find(instance.id) == svs_.end())
+                {
                     svs_[instance.id] = instance.weights;
+                    evaluator_.add(instance.id, instance.weights);
+                }
 
                 decrease_weight(guess, instance.id);
                 weights_[actual][instance.id]++;
@@ -167,6 +171,8 @@ void dual_perceptron::decrease_weight(const class_label& label,
 
 class_label dual_perceptron::classify(const feature_vector& doc) const
 {
+    evaluator_.set_query(doc);
+
     class_label best_label = weights_.begin()->first;
     double best_dot = 0;
     for (const auto& w : weights_)
@@ -175,7 +181,7 @@ class_label dual_perceptron::classify(const feature_vector& doc) const
         for (const auto& mistakes : w.second)
         {
             dot += mistakes.second
-                   * ((*kernel_)(doc, svs_.at(mistakes.first)) + bias_);
+                   * (evaluator_.eval(*kernel_, mistakes.first) + bias_);
         }
         dot *= alpha_;
         if (dot > best_dot)
@@ -22,7 +22,9 @@ const util::string_view knn::id = "knn";
 
 knn::knn(multiclass_dataset_view docs,
          std::shared_ptr<index::inverted_index> idx, uint16_t k,
-         std::unique_ptr<index::ranker> ranker, bool weighted /* = false */)
+         std::unique_ptr<index::ranker> ranker, bool weighted /* = false */,
+         util::optional<ann_index::options_type> ann_options
+         /* = util::nullopt */)
     : inv_idx_{std::move(idx)},
       k_{k},
       ranker_{std::move(ranker)},
@@ -31,6 +33,15 @@ knn::knn(multiclass_dataset_view docs,
     legal_docs_.reserve(docs.size());
     for (const auto& instance : docs)
         legal_docs_.insert(doc_id(instance.id));
+
+    if (ann_options)
+    {
+        std::vector<std::pair<doc_id, learn::feature_vector>> vectors;
+        vectors.reserve(docs.size());
+        for (const auto& instance : docs)
+            vectors.emplace_back(doc_id(instance.id), instance.weights);
+        ann_ = ann_index{std::move(vectors), *ann_options};
+    }
 }
 
 knn::knn(std::istream& in)
@@ -51,6 +62,9 @@ knn::knn(std::istream& in)
         auto id = io::packed::read<doc_id>(in);
         legal_docs_.insert(id);
     }
+
+    if (io::packed::read<bool>(in))
+        ann_ = ann_index{in};
 }
 
 void knn::save(std::ostream& out) const
@@ -65,6 +79,10 @@ void knn::save(std::ostream& out) const
     io::packed::write(out, legal_docs_.size());
     for (const auto& doc : legal_docs_)
         io::packed::write(out, doc);
+
+    io::packed::write(out, static_cast<bool>(ann_));
+    if (ann_)
+        ann_->save(out);
 }
 
 class_label knn::classify(const feature_vector& instance) const
@@ -74,6 +92,16 @@ class_label knn::classify(const feature_vector& instance) const
             "k must be smaller than the "
             "number of documents in the index (training documents)"};
 
+    if (ann_)
+    {
+        auto neighbors = ann_->query(instance, k_);
+        std::vector<index::search_result> scored;
+        scored.reserve(neighbors.size());
+        for (const auto& pr : neighbors)
+            scored.emplace_back(pr.first, static_cast<float>(pr.second));
+        return vote(scored);
+    }
+
     analyzers::feature_map<uint64_t> query(instance.size());
     for (const auto& count : instance)
         query[inv_idx_->term_text(count.first)] += count.second;
@@ -85,6 +113,11 @@ class_label knn::classify(const feature_vector& instance) const
             return legal_docs_.find(d_id) != legal_docs_.end();
         });
 
+    return vote(scored);
+}
+
+class_label knn::vote(const std::vector<index::search_result>& scored) const
+{
     std::unordered_map<class_label, double> counts;
     for (auto& s : scored)
     {
@@ -158,8 +191,22 @@ std::unique_ptr<classifier> make_multi_index_classifier<knn>(
             "knn requires a ranker to be specified in its configuration"};
 
     auto use_weighted = config.get_as<bool>("weighted").value_or(false);
+
+    util::optional<ann_index::options_type> ann_options;
+    if (config.get_as<bool>("ann").value_or(false))
+    {
+        ann_options = ann_index::options_type{};
+        if (auto clusters = config.get_as<int64_t>("ann-clusters"))
+            ann_options->num_clusters = static_cast<uint64_t>(*clusters);
+        if (auto max_iters = config.get_as<int64_t>("ann-max-iters"))
+            ann_options->max_iters = static_cast<uint64_t>(*max_iters);
+        if (auto nprobe = config.get_as<int64_t>("ann-nprobe"))
+            ann_options->num_probes = static_cast<uint64_t>(*nprobe);
+    }
+
     return make_unique<knn>(std::move(training), std::move(inv_idx), *k,
-                            index::make_ranker(*ranker), use_weighted);
+                            index::make_ranker(*ranker), use_weighted,
+                            std::move(ann_options));
 }
 }
 }
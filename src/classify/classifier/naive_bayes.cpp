@@ -7,6 +7,7 @@
 #include "cpptoml.h"
 #include "meta/classify/classifier/naive_bayes.h"
 #include "meta/io/packed.h"
+#include "meta/parallel/algorithm.h"
 
 namespace meta
 {
@@ -71,16 +72,104 @@ void naive_bayes::save(std::ostream& os) const
     class_probs_.save(os);
 }
 
+namespace
+{
+using instance_type = naive_bayes::dataset_view_type::instance_type;
+
+/// per-thread dense count arrays for the small-vocabulary fast path:
+/// one row of feature counts per class plus a document count per class
+struct dense_counts
+{
+    dense_counts(std::size_t num_labels, std::size_t num_features)
+        : term(num_labels * num_features), cls(num_labels)
+    {
+        // nothing
+    }
+
+    std::vector<double> term;
+    std::vector<double> cls;
+};
+
+/// per-thread sparse counts for large vocabularies; the multinomials
+/// carry no prior, so merging them into the prior-smoothed model
+/// distributions adds raw counts only
+struct sparse_counts
+{
+    util::sparse_vector<class_label, stats::multinomial<term_id>> term;
+    stats::multinomial<class_label> cls;
+};
+}
+
 void naive_bayes::train(const dataset_view_type& docs)
 {
-    for (const auto& instance : docs)
+    parallel::thread_pool pool;
+
+    // counting is embarrassingly parallel: each thread accumulates
+    // counts over its shard of the dataset and the partials are merged
+    // at the end. Small (e.g. feature-selected) vocabularies use dense
+    // per-thread arrays so each token is an indexed add instead of a
+    // hash probe; the cap bounds the per-thread footprint at ~8MB.
+    const uint64_t dense_limit = 1ull << 20;
+    if (docs.total_labels() * docs.total_features() <= dense_limit)
     {
-        for (const auto& p : instance.weights)
+        auto num_features = docs.total_features();
+        auto totals = parallel::reduction(
+            docs.begin(), docs.end(), pool,
+            [&]() { return dense_counts{docs.total_labels(), num_features}; },
+            [&](dense_counts& local, const instance_type& instance)
+            {
+                auto row = static_cast<std::size_t>(
+                    docs.label_id_for(docs.label(instance)));
+                auto* counts = local.term.data() + row * num_features;
+                for (const auto& p : instance.weights)
+                    counts[p.first] += p.second;
+                local.cls[row] += 1;
+            },
+            [](dense_counts& total, const dense_counts& partial)
+            {
+                for (std::size_t i = 0; i < total.term.size(); ++i)
+                    total.term[i] += partial.term[i];
+                for (std::size_t i = 0; i < total.cls.size(); ++i)
+                    total.cls[i] += partial.cls[i];
+            });
+
+        for (auto it = docs.labels_begin(); it != docs.labels_end(); ++it)
         {
-            term_probs_[docs.label(instance)].increment(p.first, p.second);
-            assert(term_probs_[docs.label(instance)].probability(p.first) > 0);
+            const auto& lbl = it->first;
+            auto row = static_cast<std::size_t>(it->second);
+            auto& dist = term_probs_[lbl];
+            const auto* counts = totals.term.data() + row * num_features;
+            for (std::size_t f = 0; f < num_features; ++f)
+            {
+                if (counts[f] > 0)
+                    dist.increment(term_id{f}, counts[f]);
+            }
+            if (totals.cls[row] > 0)
+                class_probs_.increment(lbl, totals.cls[row]);
         }
-        class_probs_.increment(docs.label(instance), 1);
+    }
+    else
+    {
+        auto totals = parallel::reduction(
+            docs.begin(), docs.end(), pool, []() { return sparse_counts{}; },
+            [&](sparse_counts& local, const instance_type& instance)
+            {
+                auto lbl = docs.label(instance);
+                auto& dist = local.term[lbl];
+                for (const auto& p : instance.weights)
+                    dist.increment(p.first, p.second);
+                local.cls.increment(lbl, 1);
+            },
+            [](sparse_counts& total, const sparse_counts& partial)
+            {
+                for (const auto& cls : partial.term)
+                    total.term[cls.first] += cls.second;
+                total.cls += partial.cls;
+            });
+
+        for (const auto& cls : totals.term)
+            term_probs_[cls.first] += cls.second;
+        class_probs_ += totals.cls;
     }
 }
 
@@ -114,6 +203,56 @@ class_label naive_bayes::classify(const feature_vector& instance) const
     return label;
 }
 
+std::vector<class_label>
+naive_bayes::classify_batch(const dataset_view_type& docs,
+                            parallel::thread_pool& pool) const
+{
+    // the per-class setup is identical for every instance in the
+    // batch, so compute the log priors and distribution pointers once
+    // instead of per prediction
+    struct class_model
+    {
+        const class_label* label;
+        const stats::multinomial<term_id>* dist;
+        double log_prior;
+    };
+    std::vector<class_model> models;
+    models.reserve(term_probs_.size());
+    for (const auto& cls : term_probs_)
+        models.push_back({&cls.first, &cls.second,
+                          std::log(class_probs_.probability(cls.first))});
+
+    std::vector<class_label> labels(docs.size());
+    auto begin = docs.begin();
+    auto futures = parallel::for_each_block(
+        begin, docs.end(), pool,
+        [&](dataset_view_type::iterator tbegin,
+            dataset_view_type::iterator tend)
+        {
+            for (auto it = tbegin; it != tend; ++it)
+            {
+                const class_label* best_label = nullptr;
+                double best = std::numeric_limits<double>::lowest();
+                for (const auto& model : models)
+                {
+                    double sum = model.log_prior;
+                    for (const auto& t : it->weights)
+                        sum += t.second
+                               * std::log(model.dist->probability(t.first));
+                    if (sum > best)
+                    {
+                        best = sum;
+                        best_label = model.label;
+                    }
+                }
+                labels[static_cast<std::size_t>(it - begin)] = *best_label;
+            }
+        });
+    for (auto& fut : futures)
+        fut.get();
+    return labels;
+}
+
 template <>
 std::unique_ptr<classifier>
     make_classifier<naive_bayes>(const cpptoml::table& config,
@@ -3,6 +3,7 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 
@@ -43,6 +44,8 @@ nearest_centroid::nearest_centroid(multiclass_dataset_view docs,
     for (auto& centroid : centroids_)
         for (auto& term_pair : centroid.second)
             term_pair.second /= docs_per_class[centroid.first];
+
+    pack_centroids();
 }
 
 nearest_centroid::nearest_centroid(std::istream& in)
@@ -66,6 +69,31 @@ nearest_centroid::nearest_centroid(std::istream& in)
             map_ref.emplace(id, weight);
         }
     }
+
+    pack_centroids();
+}
+
+void nearest_centroid::pack_centroids()
+{
+    std::size_t dim = 0;
+    for (const auto& centroid : centroids_)
+        for (const auto& term_pair : centroid.second)
+            dim = std::max(dim,
+                           static_cast<std::size_t>(term_pair.first) + 1);
+
+    scorer_ = math::dense::dense_scorer{dim};
+    row_labels_.clear();
+    row_labels_.reserve(centroids_.size());
+
+    std::vector<double> row(dim);
+    for (const auto& centroid : centroids_)
+    {
+        std::fill(row.begin(), row.end(), 0.0);
+        for (const auto& term_pair : centroid.second)
+            row[term_pair.first] = term_pair.second;
+        scorer_.add_row({row.data(), row.size()});
+        row_labels_.push_back(centroid.first);
+    }
 }
 
 void nearest_centroid::save(std::ostream& out) const
@@ -89,53 +117,37 @@ void nearest_centroid::save(std::ostream& out) const
 
 class_label nearest_centroid::classify(const feature_vector& instance) const
 {
-    double best_score = std::numeric_limits<double>::lowest();
-    class_label best_label;
-
     // convert to TF-IDF representation
     double num_docs = inv_idx_->num_docs();
     auto counts(instance);
+    double doc_mag = 0.0;
     for (auto& count : counts)
+    {
         count.second *= std::log(num_docs / inv_idx_->doc_freq(count.first));
+        doc_mag += count.second * count.second;
+    }
+    doc_mag = std::sqrt(doc_mag);
 
-    for (auto& centroid : centroids_)
+    // one pass of the dense kernel scores the query against every
+    // centroid; dividing by the precomputed norms gives cosines
+    std::vector<double> scores(scorer_.num_rows());
+    scorer_.score_sparse(counts.begin(), counts.end(), scores.data());
+
+    double best_score = std::numeric_limits<double>::lowest();
+    class_label best_label;
+    for (std::size_t row = 0; row < scores.size(); ++row)
     {
-        double score
-            = cosine_sim(counts.begin(), counts.end(), centroid.second);
+        auto score = scores[row] / (doc_mag * scorer_.norm(row));
         if (score > best_score)
         {
             best_score = score;
-            best_label = centroid.first;
+            best_label = row_labels_[row];
         }
     }
 
     return best_label;
 }
 
-template <class ForwardIterator>
-double nearest_centroid::cosine_sim(
-    ForwardIterator begin, ForwardIterator end,
-    const std::unordered_map<term_id, double>& centroid) const
-{
-    double centroid_mag = 0.0;
-    for (const auto& pair : centroid)
-        centroid_mag += pair.second * pair.second;
-
-    double dot = 0.0;
-    double doc_mag = 0.0;
-    for (; begin != end; ++begin)
-    {
-        doc_mag += begin->second * begin->second;
-        auto it = centroid.find(begin->first);
-        if (it != centroid.end())
-            dot += it->second * begin->second;
-    }
-
-    centroid_mag = std::sqrt(centroid_mag);
-    doc_mag = std::sqrt(doc_mag);
-    return dot / (doc_mag * centroid_mag);
-}
-
 template <>
 std::unique_ptr<classifier> make_multi_index_classifier<nearest_centroid>(
     const cpptoml::table&, multiclass_dataset_view training,
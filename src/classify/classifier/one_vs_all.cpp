@@ -16,6 +16,18 @@ namespace classify
 const util::string_view one_vs_all::id = "one-vs-all";
 
 one_vs_all::one_vs_all(multiclass_dataset_view docs, const cpptoml::table& base)
+{
+    init(docs, base);
+}
+
+one_vs_all::one_vs_all(multiclass_dataset_view docs,
+                       std::shared_ptr<const cpptoml::table> base)
+    : base_config_{std::move(base)}
+{
+    init(docs, *base_config_);
+}
+
+void one_vs_all::init(multiclass_dataset_view& docs, const cpptoml::table& base)
 {
     classifiers_.reserve(docs.total_labels());
     for (auto it = docs.labels_begin(), end = docs.labels_end(); it != end;
@@ -60,6 +72,29 @@ void one_vs_all::save(std::ostream& out) const
 
 void one_vs_all::train(dataset_view_type docs)
 {
+    // labels appearing for the first time in this data delta need their
+    // own binary classifier; this requires the base configuration, which
+    // only exists if we were constructed from one
+    for (auto it = docs.labels_begin(), end = docs.labels_end(); it != end;
+         ++it)
+    {
+        auto lbl = it->first;
+        if (classifiers_.find(lbl) != classifiers_.end())
+            continue;
+
+        if (!base_config_)
+            throw classifier_exception{
+                "cannot incrementally train one_vs_all on unseen label \""
+                + static_cast<const std::string&>(lbl)
+                + "\" without a retained base configuration"};
+
+        binary_dataset_view bdv{docs, [&, lbl](const instance_type& instance)
+                                {
+                                    return docs.label(instance) == lbl;
+                                }};
+        classifiers_[lbl] = make_binary_classifier(*base_config_, bdv);
+    }
+
     parallel::parallel_for(
         classifiers_.begin(), classifiers_.end(),
         [&](std::pair<const class_label, std::unique_ptr<binary_classifier>>&
@@ -116,6 +151,50 @@ class_label one_vs_all::classify(const feature_vector& doc) const
     return best_label;
 }
 
+std::vector<class_label>
+one_vs_all::classify_batch(const dataset_view_type& docs,
+                           parallel::thread_pool& pool) const
+{
+    // flatten the model table once per batch so the per-instance argmax
+    // walks a contiguous list instead of re-traversing the hash table
+    struct model_entry
+    {
+        const class_label* label;
+        const binary_classifier* model;
+    };
+    std::vector<model_entry> models;
+    models.reserve(classifiers_.size());
+    for (const auto& pr : classifiers_)
+        models.push_back({&pr.first, pr.second.get()});
+
+    std::vector<class_label> labels(docs.size());
+    auto begin = docs.begin();
+    auto futures = parallel::for_each_block(
+        begin, docs.end(), pool,
+        [&](dataset_view_type::iterator tbegin,
+            dataset_view_type::iterator tend)
+        {
+            for (auto it = tbegin; it != tend; ++it)
+            {
+                const class_label* best_label = nullptr;
+                double best = std::numeric_limits<double>::lowest();
+                for (const auto& entry : models)
+                {
+                    auto prediction = entry.model->predict(it->weights);
+                    if (prediction > best)
+                    {
+                        best = prediction;
+                        best_label = entry.label;
+                    }
+                }
+                labels[static_cast<std::size_t>(it - begin)] = *best_label;
+            }
+        });
+    for (auto& fut : futures)
+        fut.get();
+    return labels;
+}
+
 template <>
 std::unique_ptr<classifier>
     make_classifier<one_vs_all>(const cpptoml::table& config,
@@ -125,7 +204,8 @@ std::unique_ptr<classifier>
     if (!base)
         throw classifier_factory::exception{
             "one-vs-all missing base-classifier parameter in config file"};
-    return make_unique<one_vs_all>(std::move(training), *base);
+    // retain the base configuration for incremental training
+    return make_unique<one_vs_all>(std::move(training), std::move(base));
 }
 }
 }
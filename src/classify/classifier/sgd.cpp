@@ -3,12 +3,14 @@
  * @author Chase Geigle
  */
 
+#include <cmath>
 #include <numeric>
 #include <random>
 
 #include "meta/classify/classifier/sgd.h"
 #include "meta/learn/loss/loss_function_factory.h"
 #include "meta/index/postings_data.h"
+#include "meta/parallel/algorithm.h"
 
 namespace meta
 {
@@ -91,6 +93,35 @@ void sgd::train(binary_dataset_view docs)
     }
 }
 
+void sgd::train(binary_dataset_view docs, parallel::thread_pool& pool)
+{
+    double prev_avg_loss = 0;
+    for (size_t iter = 0; iter < max_iter_; ++iter)
+    {
+        docs.shuffle();
+        // Hogwild: each thread trains on its shard against the shared
+        // model with no locking; per-thread losses are reduced at the
+        // epoch boundary
+        auto total_loss = parallel::reduction(
+            docs.begin(), docs.end(), pool, []() { return 0.0; },
+            [&](double& local_loss, const instance_type& instance)
+            {
+                local_loss += model_.train_one(
+                    instance.weights, docs.label(instance) ? +1 : -1, *loss_);
+            },
+            [](double& total, double partial)
+            {
+                total += partial;
+            });
+
+        auto avg_loss = total_loss / docs.size();
+        if (prev_avg_loss > 0
+            && std::abs(prev_avg_loss - avg_loss) / prev_avg_loss < gamma_)
+            return;
+        prev_avg_loss = avg_loss;
+    }
+}
+
 void sgd::train_one(const feature_vector& doc, bool label)
 {
     model_.train_one(doc, label ? +1 : -1, *loss_);
@@ -7,6 +7,12 @@
 #include "meta/classify/classifier/svm_wrapper.h"
 #include "meta/utf/utf.h"
 
+#if META_HAS_LIBSVM
+#include <cstring>
+#include "linear.h"
+#include "svm.h"
+#endif
+
 namespace meta
 {
 namespace classify
@@ -14,6 +20,243 @@ namespace classify
 
 const util::string_view svm_wrapper::id = "libsvm";
 
+#if META_HAS_LIBSVM
+namespace detail
+{
+/**
+ * Owns an in-process liblinear or libsvm model together with the
+ * converted training problem. The node storage must outlive the model:
+ * libsvm's support vectors are pointers into the training nodes rather
+ * than copies.
+ */
+class svm_bridge
+{
+  public:
+    /**
+     * Trains a model in memory, converting the dataset to the solver's
+     * problem representation without touching the filesystem. The
+     * parameters mirror the defaults of the svm-train/train binaries
+     * the shell-out path invokes with the same kernel options.
+     */
+    svm_bridge(const multiclass_dataset_view& docs, svm_wrapper::kernel k)
+        : linear_{k == svm_wrapper::kernel::None}
+    {
+        // count nodes up front so the arrays never reallocate once
+        // pointers into them have been taken
+        std::size_t num_nodes = 0;
+        for (const auto& instance : docs)
+            num_nodes += instance.weights.size() + 1;
+
+        y_.reserve(docs.size());
+        if (linear_)
+        {
+            lin_nodes_.reserve(num_nodes);
+            lin_x_.reserve(docs.size());
+            for (const auto& instance : docs)
+            {
+                lin_x_.push_back(lin_nodes_.data() + lin_nodes_.size());
+                for (const auto& p : instance.weights)
+                {
+                    ::feature_node node;
+                    node.index = static_cast<int>(p.first) + 1;
+                    node.value = p.second;
+                    lin_nodes_.push_back(node);
+                }
+                ::feature_node sentinel;
+                sentinel.index = -1;
+                sentinel.value = 0;
+                lin_nodes_.push_back(sentinel);
+
+                // SVM multiclass has label_ids starting at 1
+                y_.push_back(static_cast<double>(
+                                 docs.label_id_for(docs.label(instance)))
+                             + 1);
+            }
+
+            ::problem prob;
+            std::memset(&prob, 0, sizeof(prob));
+            prob.l = static_cast<int>(docs.size());
+            prob.n = static_cast<int>(docs.total_features());
+            prob.y = y_.data();
+            prob.x = lin_x_.data();
+            prob.bias = -1;
+
+            ::parameter param;
+            std::memset(&param, 0, sizeof(param));
+            param.solver_type = L2R_L2LOSS_SVC_DUAL;
+            param.C = 1;
+            param.eps = 0.1;
+            param.p = 0.1;
+
+            // the binaries' output was redirected to /dev/null; keep
+            // the in-process solver quiet too
+            ::set_print_string_function([](const char*) {});
+
+            lin_model_ = ::train(&prob, &param);
+            ::destroy_param(&param);
+        }
+        else
+        {
+            svm_nodes_.reserve(num_nodes);
+            svm_x_.reserve(docs.size());
+            for (const auto& instance : docs)
+            {
+                svm_x_.push_back(svm_nodes_.data() + svm_nodes_.size());
+                for (const auto& p : instance.weights)
+                {
+                    ::svm_node node;
+                    node.index = static_cast<int>(p.first) + 1;
+                    node.value = p.second;
+                    svm_nodes_.push_back(node);
+                }
+                ::svm_node sentinel;
+                sentinel.index = -1;
+                sentinel.value = 0;
+                svm_nodes_.push_back(sentinel);
+
+                y_.push_back(static_cast<double>(
+                                 docs.label_id_for(docs.label(instance)))
+                             + 1);
+            }
+
+            ::svm_problem prob;
+            std::memset(&prob, 0, sizeof(prob));
+            prob.l = static_cast<int>(docs.size());
+            prob.y = y_.data();
+            prob.x = svm_x_.data();
+
+            ::svm_parameter param;
+            std::memset(&param, 0, sizeof(param));
+            param.svm_type = C_SVC;
+            switch (k)
+            {
+                case svm_wrapper::kernel::Quadratic:
+                    param.kernel_type = POLY;
+                    param.degree = 2;
+                    break;
+                case svm_wrapper::kernel::Cubic:
+                    param.kernel_type = POLY;
+                    param.degree = 3;
+                    break;
+                case svm_wrapper::kernel::Quartic:
+                    param.kernel_type = POLY;
+                    param.degree = 4;
+                    break;
+                case svm_wrapper::kernel::Sigmoid:
+                    param.kernel_type = SIGMOID;
+                    break;
+                default:
+                    param.kernel_type = RBF;
+                    break;
+            }
+            param.gamma = 1.0 / docs.total_features();
+            param.cache_size = 100;
+            param.eps = 1e-3;
+            param.C = 1;
+            param.shrinking = 1;
+
+            ::svm_set_print_string_function([](const char*) {});
+
+            svm_model_ = ::svm_train(&prob, &param);
+            ::svm_destroy_param(&param);
+        }
+    }
+
+    /**
+     * Loads a previously saved model from a file on disk (the format the
+     * solvers themselves define, as written by save_to()).
+     */
+    svm_bridge(const std::string& model_file, bool linear) : linear_{linear}
+    {
+        if (linear_)
+            lin_model_ = ::load_model(model_file.c_str());
+        else
+            svm_model_ = ::svm_load_model(model_file.c_str());
+    }
+
+    svm_bridge(const svm_bridge&) = delete;
+    svm_bridge& operator=(const svm_bridge&) = delete;
+
+    ~svm_bridge()
+    {
+        if (lin_model_)
+            ::free_and_destroy_model(&lin_model_);
+        if (svm_model_)
+            ::svm_free_and_destroy_model(&svm_model_);
+    }
+
+    /// @return whether a model is actually held (e.g. loading can fail)
+    bool valid() const
+    {
+        return lin_model_ != nullptr || svm_model_ != nullptr;
+    }
+
+    /**
+     * Predicts the 1-based label_id for a single instance entirely in
+     * memory.
+     */
+    double predict_one(const learn::feature_vector& doc) const
+    {
+        if (linear_)
+        {
+            std::vector<::feature_node> nodes;
+            nodes.reserve(doc.size() + 1);
+            for (const auto& p : doc)
+            {
+                ::feature_node node;
+                node.index = static_cast<int>(p.first) + 1;
+                node.value = p.second;
+                nodes.push_back(node);
+            }
+            ::feature_node sentinel;
+            sentinel.index = -1;
+            sentinel.value = 0;
+            nodes.push_back(sentinel);
+            return ::predict(lin_model_, nodes.data());
+        }
+
+        std::vector<::svm_node> nodes;
+        nodes.reserve(doc.size() + 1);
+        for (const auto& p : doc)
+        {
+            ::svm_node node;
+            node.index = static_cast<int>(p.first) + 1;
+            node.value = p.second;
+            nodes.push_back(node);
+        }
+        ::svm_node sentinel;
+        sentinel.index = -1;
+        sentinel.value = 0;
+        nodes.push_back(sentinel);
+        return ::svm_predict(svm_model_, nodes.data());
+    }
+
+    /// writes the model in the solver's own format for serialization
+    void save_to(const std::string& path) const
+    {
+        if (linear_)
+            ::save_model(path.c_str(), lin_model_);
+        else
+            ::svm_save_model(path.c_str(), svm_model_);
+    }
+
+  private:
+    /// whether this is a liblinear (vs libsvm) model
+    bool linear_;
+    /// the training labels, shared by both solvers
+    std::vector<double> y_;
+
+    std::vector<::feature_node> lin_nodes_;
+    std::vector<::feature_node*> lin_x_;
+    ::model* lin_model_ = nullptr;
+
+    std::vector<::svm_node> svm_nodes_;
+    std::vector<::svm_node*> svm_x_;
+    ::svm_model* svm_model_ = nullptr;
+};
+}
+#endif
+
 decltype(svm_wrapper::options_) svm_wrapper::options_
     = {{svm_wrapper::kernel::None, ""},
        {svm_wrapper::kernel::Quadratic, " -t 1 -d 2 "},
@@ -39,6 +282,11 @@ svm_wrapper::svm_wrapper(dataset_view_type docs, const std::string& svm_path,
     else
         executable_ = "libsvm/build/svm-";
 
+#if META_HAS_LIBSVM
+    // train against the linked solvers entirely in memory: no
+    // temporary files and no child processes
+    bridge_ = std::make_shared<detail::svm_bridge>(docs, kernel_);
+#else
     {
         std::ofstream out{"svm-train"};
         for (const auto& instance : docs)
@@ -59,6 +307,7 @@ svm_wrapper::svm_wrapper(dataset_view_type docs, const std::string& svm_path,
     command += " > NUL 2>&1\"";
 #endif
     system(command.c_str());
+#endif
 }
 
 svm_wrapper::svm_wrapper(std::istream& in)
@@ -72,14 +321,25 @@ svm_wrapper::svm_wrapper(std::istream& in)
     for (std::size_t i = 0; i < size; ++i)
         io::packed::read(in, labels_[i]);
 
-    std::ofstream out{"svm-train.model"};
-    auto model_lines = io::packed::read<std::size_t>(in);
-    std::string line;
-    for (std::size_t i = 0; i < model_lines; ++i)
     {
-        std::getline(in, line);
-        out << line << "\n";
+        std::ofstream out{"svm-train.model"};
+        auto model_lines = io::packed::read<std::size_t>(in);
+        std::string line;
+        for (std::size_t i = 0; i < model_lines; ++i)
+        {
+            std::getline(in, line);
+            out << line << "\n";
+        }
     }
+
+#if META_HAS_LIBSVM
+    // pick the model back up in-process so predictions skip the
+    // binaries; fall back to the shell-out path if loading fails
+    auto bridge = std::make_shared<detail::svm_bridge>(
+        "svm-train.model", kernel_ == kernel::None);
+    if (bridge->valid())
+        bridge_ = std::move(bridge);
+#endif
 }
 
 void svm_wrapper::save(std::ostream& out) const
@@ -94,6 +354,14 @@ void svm_wrapper::save(std::ostream& out) const
     for (const auto& lbl : labels_)
         io::packed::write(out, lbl);
 
+#if META_HAS_LIBSVM
+    // an in-process model has never touched the disk; write it out in
+    // the solver's own format so the line-based serialization below
+    // (and older toolkit builds) can read it
+    if (bridge_)
+        bridge_->save_to("svm-train.model");
+#endif
+
     auto num_lines = filesystem::num_lines("svm-train.model");
     io::packed::write(out, num_lines);
     std::ifstream in{"svm-train.model"};
@@ -107,6 +375,15 @@ void svm_wrapper::save(std::ostream& out) const
 
 class_label svm_wrapper::classify(const feature_vector& doc) const
 {
+#if META_HAS_LIBSVM
+    if (bridge_)
+    {
+        auto lbl = static_cast<std::size_t>(bridge_->predict_one(doc));
+        assert(lbl > 0);
+        return labels_.at(lbl - 1);
+    }
+#endif
+
     // create input for liblinear
     {
         std::ofstream out{"svm-input"};
@@ -146,6 +423,22 @@ class_label svm_wrapper::classify(const feature_vector& doc) const
 
 confusion_matrix svm_wrapper::test(multiclass_dataset_view docs) const
 {
+#if META_HAS_LIBSVM
+    if (bridge_)
+    {
+        confusion_matrix matrix;
+        for (const auto& instance : docs)
+        {
+            auto value
+                = static_cast<std::size_t>(bridge_->predict_one(instance.weights));
+            assert(value > 0);
+            predicted_label predicted{labels_.at(value - 1)};
+            matrix.add(predicted, docs.label(instance));
+        }
+        return matrix;
+    }
+#endif
+
     // create input for liblinear/libsvm
     {
         std::ofstream out{"svm-input"};
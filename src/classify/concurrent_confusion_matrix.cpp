@@ -0,0 +1,144 @@
+/**
+ * @file concurrent_confusion_matrix.cpp
+ * @author Sean Massung
+ */
+
+#include <algorithm>
+
+#include "meta/classify/concurrent_confusion_matrix.h"
+
+namespace meta
+{
+namespace classify
+{
+
+concurrent_confusion_matrix::concurrent_confusion_matrix(
+    std::vector<class_label> labels)
+    : labels_{std::move(labels)}
+{
+    std::sort(labels_.begin(), labels_.end());
+    labels_.erase(std::unique(labels_.begin(), labels_.end()), labels_.end());
+
+    ids_.reserve(labels_.size());
+    for (size_t i = 0; i < labels_.size(); ++i)
+        ids_[labels_[i]] = i;
+
+    // value-initialized, so every count starts at zero
+    counts_ = std::unique_ptr<std::atomic<size_t>[]>{
+        new std::atomic<size_t>[labels_.size() * labels_.size()]()};
+}
+
+auto concurrent_confusion_matrix::metrics_for(size_t idx) const -> class_metrics
+{
+    auto n = labels_.size();
+    size_t predicted = 0; // row sum: everything predicted as idx
+    size_t actual = 0;    // column sum: everything truly idx
+    for (size_t i = 0; i < n; ++i)
+    {
+        predicted += counts_[idx * n + i].load(std::memory_order_relaxed);
+        actual += counts_[i * n + idx].load(std::memory_order_relaxed);
+    }
+    auto correct
+        = static_cast<double>(counts_[idx * n + idx].load(
+            std::memory_order_relaxed));
+
+    class_metrics m{0.0, 0.0, 0.0};
+    if (predicted != 0)
+        m.precision = correct / predicted;
+    if (actual != 0)
+        m.recall = correct / actual;
+    if (m.precision + m.recall != 0.0)
+        m.f1 = (2.0 * m.precision * m.recall) / (m.precision + m.recall);
+    return m;
+}
+
+double concurrent_confusion_matrix::accuracy() const
+{
+    auto n = labels_.size();
+    size_t correct = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < n * n; ++i)
+        total += counts_[i].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i)
+        correct += counts_[i * n + i].load(std::memory_order_relaxed);
+    return static_cast<double>(correct) / total;
+}
+
+double concurrent_confusion_matrix::f1_score() const
+{
+    auto p = precision();
+    auto r = recall();
+    if (p + r != 0.0)
+        return (2.0 * p * r) / (p + r);
+
+    return 0.0;
+}
+
+double concurrent_confusion_matrix::f1_score(const class_label& lbl) const
+{
+    return metrics_for(ids_.at(lbl)).f1;
+}
+
+double concurrent_confusion_matrix::precision() const
+{
+    auto n = labels_.size();
+    size_t total = 0;
+    for (size_t i = 0; i < n * n; ++i)
+        total += counts_[i].load(std::memory_order_relaxed);
+
+    double sum = 0.0; // weighted sum of per-class precision by class dist
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t actual = 0;
+        for (size_t j = 0; j < n; ++j)
+            actual += counts_[j * n + i].load(std::memory_order_relaxed);
+        sum += (static_cast<double>(actual) / total) * metrics_for(i).precision;
+    }
+    return sum;
+}
+
+double concurrent_confusion_matrix::precision(const class_label& lbl) const
+{
+    return metrics_for(ids_.at(lbl)).precision;
+}
+
+double concurrent_confusion_matrix::recall() const
+{
+    auto n = labels_.size();
+    size_t total = 0;
+    for (size_t i = 0; i < n * n; ++i)
+        total += counts_[i].load(std::memory_order_relaxed);
+
+    double sum = 0.0; // weighted sum of per-class recall by class dist
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t actual = 0;
+        for (size_t j = 0; j < n; ++j)
+            actual += counts_[j * n + i].load(std::memory_order_relaxed);
+        sum += (static_cast<double>(actual) / total) * metrics_for(i).recall;
+    }
+    return sum;
+}
+
+double concurrent_confusion_matrix::recall(const class_label& lbl) const
+{
+    return metrics_for(ids_.at(lbl)).recall;
+}
+
+confusion_matrix concurrent_confusion_matrix::matrix() const
+{
+    auto n = labels_.size();
+    confusion_matrix matrix;
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            auto count = counts_[i * n + j].load(std::memory_order_relaxed);
+            if (count > 0)
+                matrix.add(predicted_label{labels_[i]}, labels_[j], count);
+        }
+    }
+    return matrix;
+}
+}
+}
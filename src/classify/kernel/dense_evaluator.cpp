@@ -0,0 +1,76 @@
+/**
+ * @file dense_evaluator.cpp
+ * @author Chase Geigle
+ */
+
+#include "meta/classify/kernel/dense_evaluator.h"
+
+namespace meta
+{
+namespace classify
+{
+namespace kernel
+{
+
+namespace
+{
+double norm_squared(const feature_vector& vec)
+{
+    auto norm = 0.0;
+    for (const auto& pr : vec)
+        norm += pr.second * pr.second;
+    return norm;
+}
+}
+
+void dense_evaluator::add(learn::instance_id id, feature_vector vec)
+{
+    // keep the dense buffer wide enough for every registered feature
+    if (!vec.empty())
+    {
+        auto max_fid = (--vec.end())->first;
+        if (max_fid >= query_.size())
+            query_.resize(max_fid + 1, 0.0);
+    }
+
+    auto norm = norm_squared(vec);
+    vectors_[id] = entry{std::move(vec), norm};
+}
+
+bool dense_evaluator::contains(learn::instance_id id) const
+{
+    return vectors_.find(id) != vectors_.end();
+}
+
+void dense_evaluator::set_query(const feature_vector& query)
+{
+    for (auto fid : nonzero_)
+        query_[fid] = 0.0;
+    nonzero_.clear();
+
+    query_norm_sq_ = 0;
+    for (const auto& pr : query)
+    {
+        if (pr.first >= query_.size())
+            query_.resize(pr.first + 1, 0.0);
+        query_[pr.first] = pr.second;
+        nonzero_.push_back(pr.first);
+        query_norm_sq_ += pr.second * pr.second;
+    }
+}
+
+double dense_evaluator::eval(const kernel& kern, learn::instance_id id) const
+{
+    const auto& ent = vectors_.at(id);
+
+    // sparse-dense dot product: one linear scan over the registered
+    // vector's contiguous contents, indexing into the dense query
+    auto dot = 0.0;
+    for (const auto& pr : ent.vec)
+        dot += pr.second * query_[pr.first];
+
+    return kern.from_linear(dot, query_norm_sq_, ent.norm_sq);
+}
+}
+}
+}
@@ -34,6 +34,12 @@ double polynomial::operator()(const feature_vector& first,
     return std::pow(util::dot_product(first, second) + c_, power_);
 }
 
+double polynomial::from_linear(double dot, double /* first_norm_sq */,
+                               double /* second_norm_sq */) const
+{
+    return std::pow(dot + c_, power_);
+}
+
 void polynomial::save(std::ostream& out) const
 {
     io::packed::write(out, id);
@@ -71,6 +71,13 @@ double radial_basis::operator()(const feature_vector& first,
     return std::exp(gamma_ * dist);
 }
 
+double radial_basis::from_linear(double dot, double first_norm_sq,
+                                 double second_norm_sq) const
+{
+    // ||x - z||^2 = ||x||^2 + ||z||^2 - 2 x^T z
+    return std::exp(gamma_ * (first_norm_sq + second_norm_sq - 2 * dot));
+}
+
 template <>
 std::unique_ptr<kernel> make_kernel<radial_basis>(const cpptoml::table& config)
 {
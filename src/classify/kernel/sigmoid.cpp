@@ -32,6 +32,12 @@ double sigmoid::operator()(const feature_vector& first,
     return std::tanh(alpha_ * util::dot_product(first, second) + c_);
 }
 
+double sigmoid::from_linear(double dot, double /* first_norm_sq */,
+                            double /* second_norm_sq */) const
+{
+    return std::tanh(alpha_ * dot + c_);
+}
+
 void sigmoid::save(std::ostream& out) const
 {
     io::packed::write(out, id);
@@ -23,6 +23,7 @@ corpus_factory::corpus_factory()
     reg<file_corpus>();
     reg<line_corpus>();
     reg<gz_corpus>();
+    reg<frame_corpus>();
     reg<libsvm_corpus>();
 }
 
@@ -60,6 +61,26 @@ std::unique_ptr<corpus> make_corpus(const cpptoml::table& config)
         = corpus_config->get_as<bool>("store-full-text").value_or(false);
     result->set_store_full_text(store_full_text);
 
+    auto num_shards
+        = corpus_config->get_as<uint64_t>("num-shards").value_or(0);
+    if (num_shards > 0)
+    {
+        auto shard = corpus_config->get_as<uint64_t>("shard");
+        if (!shard)
+            throw corpus_exception{
+                "shard missing from corpus configuration file "
+                "(required when num-shards is set)"};
+        result = make_unique<shard_corpus>(std::move(result), *shard,
+                                           num_shards);
+    }
+
+    // wrap last: the decorator starts reading as soon as it exists, so
+    // the underlying corpus must be fully configured by this point
+    auto prefetch
+        = corpus_config->get_as<uint64_t>("prefetch-size").value_or(0);
+    if (prefetch > 0)
+        return make_unique<prefetch_corpus>(std::move(result), prefetch);
+
     return result;
 }
 }
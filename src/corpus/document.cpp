@@ -27,6 +27,23 @@ void document::content(const std::string& content,
                        const std::string& encoding /* = "utf-8" */)
 {
     content_ = content;
+    content_provider_ = nullptr;
+    encoding_ = encoding;
+}
+
+void document::content(std::string&& content,
+                       const std::string& encoding /* = "utf-8" */)
+{
+    content_ = std::move(content);
+    content_provider_ = nullptr;
+    encoding_ = encoding;
+}
+
+void document::content_provider(std::function<std::string()> provider,
+                                const std::string& encoding /* = "utf-8" */)
+{
+    content_provider_ = std::move(provider);
+    content_ = util::nullopt;
     encoding_ = encoding;
 }
 
@@ -39,6 +56,13 @@ const std::string& document::content() const
 {
     if (content_)
         return *content_;
+    if (content_provider_)
+    {
+        // materialize once; later accesses hit the cached string
+        content_ = content_provider_();
+        content_provider_ = nullptr;
+        return *content_;
+    }
     throw corpus_exception{"there is no content for the requested document"};
 }
 
@@ -54,7 +78,8 @@ doc_id document::id() const
 
 bool document::contains_content() const
 {
-    return static_cast<bool>(content_);
+    return static_cast<bool>(content_)
+           || static_cast<bool>(content_provider_);
 }
 
 void document::label(class_label label)
@@ -55,18 +55,22 @@ document file_corpus::next()
 {
     document doc{doc_id{cur_}, docs_[cur_].second};
 
-    if (!filesystem::file_exists(prefix_ + docs_[cur_].first))
+    auto path = prefix_ + docs_[cur_].first;
+    if (!filesystem::file_exists(path))
         throw corpus_exception{"file \"" + docs_[cur_].first
                                + "\" does not exist"};
 
-    doc.content(filesystem::file_text(prefix_ + docs_[cur_].first), encoding());
+    // read lazily: consumers that stream or never touch the text skip
+    // the up-front read, and pipelines pull the file on their own thread
+    doc.content_provider([path]() { return filesystem::file_text(path); },
+                         encoding());
 
     auto mdata = next_metadata();
     if (store_full_text())
         mdata.insert(mdata.begin(), metadata::field{doc.content()});
 
     // add "path" metadata manually
-    mdata.insert(mdata.begin(), metadata::field{prefix_ + docs_[cur_].first});
+    mdata.insert(mdata.begin(), metadata::field{path});
     doc.mdata(std::move(mdata));
 
     ++cur_;
@@ -0,0 +1,368 @@
+/**
+ * @file frame_corpus.cpp
+ * @author Chase Geigle
+ */
+
+#include "meta/corpus/frame_corpus.h"
+#include "meta/io/packed.h"
+#include "meta/util/shim.h"
+
+#if META_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace meta
+{
+namespace corpus
+{
+
+namespace
+{
+/**
+ * Minimal input stream over an in-memory buffer for io::packed::read.
+ */
+struct char_input_stream
+{
+    char get()
+    {
+        return *input_++;
+    }
+
+    const char* input_;
+};
+
+/**
+ * Minimal output stream over a std::string for io::packed::write.
+ */
+struct string_output_stream
+{
+    void put(char c)
+    {
+        out_->push_back(c);
+    }
+
+    std::string* out_;
+};
+}
+
+const util::string_view frame_corpus::id = "frame-corpus";
+
+frame_corpus::frame_corpus(const std::string& file,
+                           std::string encoding /* = "utf-8" */)
+    : corpus{std::move(encoding)},
+      file_{file},
+      cur_id_{0},
+      num_docs_{0},
+      docs_per_block_{0},
+      cur_block_{0},
+      pos_{nullptr},
+      pos_doc_{0}
+{
+#if META_HAS_ZSTD
+    std::ifstream index{file_ + ".frames.index", std::ios::binary};
+    if (!index)
+        throw corpus_exception{"frame corpus index missing: " + file_
+                               + ".frames.index"};
+
+    io::packed::read(index, num_docs_);
+    io::packed::read(index, docs_per_block_);
+    if (docs_per_block_ == 0)
+        throw corpus_exception{"corrupted frame corpus index: " + file_
+                               + ".frames.index"};
+
+    uint64_t num_fields;
+    io::packed::read(index, num_fields);
+    schema_.reserve(num_fields);
+    for (uint64_t i = 0; i < num_fields; ++i)
+    {
+        std::string name;
+        uint64_t type;
+        io::packed::read(index, name);
+        io::packed::read(index, type);
+        schema_.emplace_back(std::move(name),
+                             static_cast<metadata::field_type>(type));
+    }
+
+    uint64_t num_blocks;
+    io::packed::read(index, num_blocks);
+    blocks_.reserve(num_blocks);
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        block_info info;
+        io::packed::read(index, info.offset);
+        io::packed::read(index, info.compressed_size);
+        io::packed::read(index, info.uncompressed_size);
+        blocks_.push_back(info);
+    }
+    if (!index)
+        throw corpus_exception{"corrupted frame corpus index: " + file_
+                               + ".frames.index"};
+
+    // no block loaded yet
+    cur_block_ = blocks_.size();
+
+    frames_.open(file_ + ".frames", std::ios::binary);
+    if (!frames_)
+        throw corpus_exception{"frame corpus data missing: " + file_
+                               + ".frames"};
+#else
+    throw corpus_exception{"frame-corpus requires the toolkit to be built "
+                           "with zstd support"};
+#endif
+}
+
+bool frame_corpus::has_next() const
+{
+    return cur_id_ < num_docs_;
+}
+
+document frame_corpus::next()
+{
+    return decode(cur_id_++);
+}
+
+uint64_t frame_corpus::size() const
+{
+    return num_docs_;
+}
+
+metadata::schema_type frame_corpus::schema() const
+{
+    auto schema = schema_;
+    if (store_full_text())
+        schema.insert(
+            schema.begin(),
+            metadata::field_info{"content", metadata::field_type::STRING});
+    return schema;
+}
+
+document frame_corpus::fetch(doc_id d_id)
+{
+    if (d_id >= num_docs_)
+        throw corpus_exception{"document id out of range for frame corpus: "
+                               + std::to_string(d_id)};
+    return decode(d_id);
+}
+
+void frame_corpus::load_block(uint64_t block)
+{
+#if META_HAS_ZSTD
+    if (cur_block_ != block)
+    {
+        const auto& info = blocks_[block];
+
+        std::vector<char> compressed(info.compressed_size);
+        frames_.clear();
+        frames_.seekg(static_cast<std::streamoff>(info.offset));
+        frames_.read(compressed.data(),
+                     static_cast<std::streamsize>(info.compressed_size));
+        if (!frames_)
+            throw corpus_exception{"failed reading block from " + file_
+                                   + ".frames"};
+
+        payload_.resize(info.uncompressed_size);
+        auto result
+            = ZSTD_decompress(&payload_[0], payload_.size(),
+                              compressed.data(), compressed.size());
+        if (ZSTD_isError(result) || result != info.uncompressed_size)
+            throw corpus_exception{"corrupted block in " + file_ + ".frames"};
+
+        cur_block_ = block;
+    }
+#endif
+    pos_ = payload_.data();
+    pos_doc_ = block * docs_per_block_;
+}
+
+document frame_corpus::decode(doc_id d_id)
+{
+    auto block = d_id / docs_per_block_;
+    if (cur_block_ != block || pos_doc_ > d_id)
+        load_block(block);
+
+    char_input_stream stream{pos_};
+    while (true)
+    {
+        std::string label;
+        std::string content;
+        io::packed::read(stream, label);
+        io::packed::read(stream, content);
+
+        std::vector<metadata::field> mdata;
+        mdata.reserve(schema_.size());
+        for (const auto& finfo : schema_)
+        {
+            switch (finfo.type)
+            {
+                case metadata::field_type::SIGNED_INT:
+                {
+                    int64_t val;
+                    io::packed::read(stream, val);
+                    mdata.emplace_back(val);
+                    break;
+                }
+
+                case metadata::field_type::UNSIGNED_INT:
+                {
+                    uint64_t val;
+                    io::packed::read(stream, val);
+                    mdata.emplace_back(val);
+                    break;
+                }
+
+                case metadata::field_type::DOUBLE:
+                {
+                    double val;
+                    io::packed::read(stream, val);
+                    mdata.emplace_back(val);
+                    break;
+                }
+
+                case metadata::field_type::STRING:
+                {
+                    std::string val;
+                    io::packed::read(stream, val);
+                    mdata.emplace_back(std::move(val));
+                    break;
+                }
+            }
+        }
+
+        pos_ = stream.input_;
+        auto id = pos_doc_++;
+
+        if (id < d_id)
+            continue;
+
+        document doc{d_id, class_label{std::move(label)}};
+        doc.content(std::move(content), encoding());
+        if (store_full_text())
+            mdata.insert(mdata.begin(), metadata::field{doc.content()});
+        doc.mdata(std::move(mdata));
+        return doc;
+    }
+}
+
+void frame_corpus::build(corpus& docs, const std::string& file,
+                         uint64_t docs_per_block /* = 512 */)
+{
+#if META_HAS_ZSTD
+    if (docs_per_block == 0)
+        throw corpus_exception{"docs-per-block must be nonzero"};
+
+    auto schema = docs.schema();
+
+    std::ofstream frames{file + ".frames", std::ios::binary};
+    if (!frames)
+        throw corpus_exception{"failed to create " + file + ".frames"};
+
+    std::vector<block_info> blocks;
+    std::string payload;
+    std::vector<char> compressed;
+    string_output_stream out{&payload};
+    uint64_t offset = 0;
+    uint64_t num_docs = 0;
+    uint64_t in_block = 0;
+
+    auto flush_block = [&]() {
+        compressed.resize(ZSTD_compressBound(payload.size()));
+        auto csize = ZSTD_compress(compressed.data(), compressed.size(),
+                                   payload.data(), payload.size(), 3);
+        if (ZSTD_isError(csize))
+            throw corpus_exception{std::string{"zstd compression failed: "}
+                                   + ZSTD_getErrorName(csize)};
+
+        frames.write(compressed.data(), static_cast<std::streamsize>(csize));
+        blocks.push_back({offset, csize, payload.size()});
+        offset += csize;
+        payload.clear();
+        in_block = 0;
+    };
+
+    while (docs.has_next())
+    {
+        auto doc = docs.next();
+        io::packed::write(out,
+                          static_cast<const std::string&>(doc.label()));
+        io::packed::write(out, doc.content());
+
+        const auto& mdata = doc.mdata();
+        if (mdata.size() != schema.size())
+            throw corpus_exception{
+                "document metadata does not match the corpus schema"};
+
+        for (std::size_t i = 0; i < schema.size(); ++i)
+        {
+            switch (schema[i].type)
+            {
+                case metadata::field_type::SIGNED_INT:
+                    io::packed::write(out, mdata[i].sign_int);
+                    break;
+
+                case metadata::field_type::UNSIGNED_INT:
+                    io::packed::write(out, mdata[i].usign_int);
+                    break;
+
+                case metadata::field_type::DOUBLE:
+                    io::packed::write(out, mdata[i].doub);
+                    break;
+
+                case metadata::field_type::STRING:
+                    io::packed::write(out, mdata[i].str);
+                    break;
+            }
+        }
+
+        ++num_docs;
+        if (++in_block == docs_per_block)
+            flush_block();
+    }
+    if (in_block > 0)
+        flush_block();
+
+    std::ofstream index{file + ".frames.index", std::ios::binary};
+    if (!index)
+        throw corpus_exception{"failed to create " + file + ".frames.index"};
+
+    io::packed::write(index, num_docs);
+    io::packed::write(index, docs_per_block);
+    io::packed::write(index, static_cast<uint64_t>(schema.size()));
+    for (const auto& finfo : schema)
+    {
+        io::packed::write(index, finfo.name);
+        io::packed::write(index, static_cast<uint64_t>(finfo.type));
+    }
+    io::packed::write(index, static_cast<uint64_t>(blocks.size()));
+    for (const auto& info : blocks)
+    {
+        io::packed::write(index, info.offset);
+        io::packed::write(index, info.compressed_size);
+        io::packed::write(index, info.uncompressed_size);
+    }
+#else
+    (void)docs;
+    (void)docs_per_block;
+    throw corpus_exception{"cannot build " + file
+                           + ".frames: the toolkit was built without zstd "
+                             "support"};
+#endif
+}
+
+template <>
+std::unique_ptr<corpus> make_corpus<frame_corpus>(util::string_view prefix,
+                                                  util::string_view dataset,
+                                                  const cpptoml::table& config)
+{
+    auto encoding = config.get_as<std::string>("encoding").value_or("utf-8");
+
+    // string_view doesn't have operator+ overloads...
+    auto filename = prefix.to_string();
+    filename += "/";
+    filename.append(dataset.data(), dataset.size());
+    filename += "/";
+    filename.append(dataset.data(), dataset.size());
+
+    return make_unique<frame_corpus>(filename, encoding);
+}
+}
+}
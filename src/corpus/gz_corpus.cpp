@@ -5,6 +5,10 @@
 
 #include "meta/corpus/gz_corpus.h"
 #include "meta/io/filesystem.h"
+#include "meta/io/gzstream.h"
+#if META_HAS_ZSTD
+#include "meta/io/zstdstream.h"
+#endif
 #include "meta/util/shim.h"
 
 namespace meta
@@ -12,6 +16,26 @@ namespace meta
 namespace corpus
 {
 
+namespace
+{
+
+/**
+ * @param prefix The path to the compressed file, without its compression
+ * suffix
+ * @return a stream over the Zstandard-compressed file if one exists (and
+ * the toolkit was built with zstd support), falling back to the
+ * gzip-compressed file
+ */
+std::unique_ptr<std::istream> open_compressed(const std::string& prefix)
+{
+#if META_HAS_ZSTD
+    if (filesystem::file_exists(prefix + ".zst"))
+        return make_unique<io::zstdifstream>(prefix + ".zst");
+#endif
+    return make_unique<io::gzifstream>(prefix + ".gz");
+}
+}
+
 const util::string_view gz_corpus::id = "gz-corpus";
 
 gz_corpus::gz_corpus(const std::string& file, std::string encoding,
@@ -19,8 +43,8 @@ gz_corpus::gz_corpus(const std::string& file, std::string encoding,
     : corpus{std::move(encoding)},
       cur_id_{0},
       num_lines_{num_docs},
-      corpus_stream_{file + ".gz"},
-      class_stream_{file + ".labels.gz"}
+      corpus_stream_{open_compressed(file)},
+      class_stream_{open_compressed(file + ".labels")}
 {
     // nothing
 }
@@ -34,14 +58,14 @@ document gz_corpus::next()
 {
     class_label label{"[none]"};
 
-    if (class_stream_)
-        std::getline(class_stream_, static_cast<std::string&>(label));
+    if (*class_stream_)
+        std::getline(*class_stream_, static_cast<std::string&>(label));
 
     std::string line;
-    std::getline(corpus_stream_, line);
+    std::getline(*corpus_stream_, line);
 
     document doc{cur_id_++, label};
-    doc.content(line, encoding());
+    doc.content(std::move(line), encoding());
 
     auto mdata = next_metadata();
     if (store_full_text())
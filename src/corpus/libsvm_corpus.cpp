@@ -18,19 +18,45 @@ const util::string_view libsvm_corpus::id = "libsvm-corpus";
 libsvm_corpus::libsvm_corpus(const std::string& file,
                              label_type type /* = label_type::CLASSIFICATION */,
                              uint64_t num_docs /* = 0 */)
+    : libsvm_corpus{std::vector<std::string>{file}, type, num_docs}
+{
+    // nothing
+}
+
+libsvm_corpus::libsvm_corpus(std::vector<std::string> files,
+                             label_type type /* = label_type::CLASSIFICATION */,
+                             uint64_t num_docs /* = 0 */)
     : corpus{"utf-8"},
       cur_id_{0},
       lbl_type_{type},
       num_lines_{num_docs},
-      input_{file}
+      files_{std::move(files)},
+      cur_file_{0}
 {
-    // if we couldn't determine the number of lines in the constructor, we have
-    // to count newlines
+    if (files_.empty())
+        throw corpus_exception{"libsvm-corpus requires at least one file"};
+
+    // if we weren't told the number of lines, we have to count newlines
     if (num_lines_ == 0)
-        num_lines_ = filesystem::num_lines(file);
+    {
+        for (const auto& file : files_)
+            num_lines_ += filesystem::num_lines(file);
+    }
+
+    input_.open(files_[cur_file_]);
 
     // read first document
-    std::getline(input_, next_content_);
+    buffer_next();
+}
+
+void libsvm_corpus::buffer_next()
+{
+    while (!std::getline(input_, next_content_)
+           && cur_file_ + 1 < files_.size())
+    {
+        ++cur_file_;
+        input_ = std::ifstream{files_[cur_file_]};
+    }
 }
 
 bool libsvm_corpus::has_next() const
@@ -60,7 +86,7 @@ document libsvm_corpus::next()
     doc.mdata(std::move(mdata));
 
     // buffer in next document
-    std::getline(input_, next_content_);
+    buffer_next();
 
     return doc;
 }
@@ -88,12 +114,27 @@ std::unique_ptr<corpus> make_corpus<libsvm_corpus>(util::string_view prefix,
                                                    const cpptoml::table& config)
 {
     // string_view doesn't have operator+ overloads...
-    auto filename = prefix.to_string();
-    filename += "/";
-    filename.append(dataset.data(), dataset.size());
-    filename += "/";
-    filename.append(dataset.data(), dataset.size());
-    filename += ".dat";
+    auto folder = prefix.to_string();
+    folder += "/";
+    folder.append(dataset.data(), dataset.size());
+    folder += "/";
+
+    // either a list of sharded files (in document order) or the single
+    // default <dataset>.dat
+    std::vector<std::string> files;
+    auto file_list = config.get_array_of<std::string>("files");
+    if (file_list && !file_list->empty())
+    {
+        for (const auto& file : *file_list)
+            files.emplace_back(folder + file);
+    }
+    else
+    {
+        auto filename = folder;
+        filename.append(dataset.data(), dataset.size());
+        filename += ".dat";
+        files.emplace_back(std::move(filename));
+    }
 
     auto lbl_type = libsvm_corpus::label_type::CLASSIFICATION;
     auto cfg_lbl_type = config.get_as<std::string>("label-type");
@@ -111,9 +152,9 @@ std::unique_ptr<corpus> make_corpus<libsvm_corpus>(util::string_view prefix,
 
     auto lines = config.get_as<uint64_t>("num-docs");
     if (!lines)
-        return make_unique<libsvm_corpus>(filename, lbl_type);
+        return make_unique<libsvm_corpus>(std::move(files), lbl_type);
     else
-        return make_unique<libsvm_corpus>(filename, lbl_type, *lines);
+        return make_unique<libsvm_corpus>(std::move(files), lbl_type, *lines);
 }
 }
 }
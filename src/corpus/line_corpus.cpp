@@ -55,7 +55,7 @@ document line_corpus::next()
         throw corpus_exception{"error parsing line_corpus line "
                                + std::to_string(cur_id_)};
 
-    doc.content(content, encoding());
+    doc.content(std::move(content), encoding());
     auto mdata = next_metadata();
     if (store_full_text())
         mdata.insert(mdata.begin(), metadata::field{doc.content()});
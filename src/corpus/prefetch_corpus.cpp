@@ -0,0 +1,89 @@
+/**
+ * @file prefetch_corpus.cpp
+ * @author Chase Geigle
+ */
+
+#include "meta/corpus/prefetch_corpus.h"
+
+namespace meta
+{
+namespace corpus
+{
+
+prefetch_corpus::prefetch_corpus(std::unique_ptr<corpus> backing,
+                                 uint64_t buffer_size /* = 1024 */)
+    : corpus{backing->encoding()},
+      backing_{std::move(backing)},
+      size_{backing_->size()},
+      schema_{backing_->schema()},
+      delivered_{0},
+      stop_{false},
+      queue_{buffer_size}
+{
+    set_store_full_text(backing_->store_full_text());
+    thread_ = std::thread{[this]() { read(); }};
+}
+
+prefetch_corpus::~prefetch_corpus()
+{
+    stop_.store(true, std::memory_order_release);
+    // unblock a reader stuck on a full queue by discarding buffered
+    // documents; the queue frees anything left over
+    document doc;
+    while (queue_.try_pop(doc))
+        ;
+    thread_.join();
+}
+
+void prefetch_corpus::read()
+{
+    try
+    {
+        while (backing_->has_next())
+        {
+            auto doc = backing_->next();
+            while (!queue_.try_push(std::move(doc)))
+            {
+                if (stop_.load(std::memory_order_acquire))
+                    return;
+                std::this_thread::yield();
+            }
+        }
+    }
+    catch (...)
+    {
+        error_ = std::current_exception();
+    }
+    queue_.close();
+}
+
+bool prefetch_corpus::has_next() const
+{
+    return delivered_ < size_;
+}
+
+document prefetch_corpus::next()
+{
+    document doc;
+    if (!queue_.pop(doc))
+    {
+        if (error_)
+            std::rethrow_exception(error_);
+        throw corpus_exception{
+            "prefetch_corpus::next() called with no documents remaining"};
+    }
+    ++delivered_;
+    return doc;
+}
+
+uint64_t prefetch_corpus::size() const
+{
+    return size_;
+}
+
+metadata::schema_type prefetch_corpus::schema() const
+{
+    return schema_;
+}
+}
+}
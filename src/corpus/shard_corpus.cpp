@@ -0,0 +1,84 @@
+/**
+ * @file shard_corpus.cpp
+ * @author Chase Geigle
+ */
+
+#include "meta/corpus/shard_corpus.h"
+
+namespace meta
+{
+namespace corpus
+{
+
+shard_corpus::shard_corpus(std::unique_ptr<corpus> backing, uint64_t shard,
+                           uint64_t num_shards)
+    : corpus{backing->encoding()},
+      backing_{std::move(backing)},
+      shard_{shard},
+      num_shards_{num_shards},
+      consumed_{0},
+      delivered_{0}
+{
+    if (num_shards_ == 0)
+        throw corpus_exception{"shard_corpus requires at least one shard"};
+    if (shard_ >= num_shards_)
+        throw corpus_exception{"shard " + std::to_string(shard_)
+                               + " out of range for "
+                               + std::to_string(num_shards_) + " shards"};
+
+    auto total = backing_->size();
+    begin_ = shard_ * total / num_shards_;
+    end_ = (shard_ + 1) * total / num_shards_;
+}
+
+bool shard_corpus::has_next() const
+{
+    return delivered_ < size();
+}
+
+document shard_corpus::next()
+{
+    // fast-forward the serial backing corpus to the start of our range
+    while (consumed_ < begin_)
+    {
+        backing_->next();
+        ++consumed_;
+    }
+
+    auto global = backing_->next();
+    ++consumed_;
+
+    // renumber with a shard-local id; base() recovers the global id
+    document doc{doc_id{global.id() - begin_}, global.label()};
+    doc.content(std::string{global.content()}, encoding());
+    doc.mdata(std::vector<metadata::field>{global.mdata()});
+    ++delivered_;
+    return doc;
+}
+
+uint64_t shard_corpus::size() const
+{
+    return end_ - begin_;
+}
+
+metadata::schema_type shard_corpus::schema() const
+{
+    return backing_->schema();
+}
+
+uint64_t shard_corpus::shard() const
+{
+    return shard_;
+}
+
+uint64_t shard_corpus::num_shards() const
+{
+    return num_shards_;
+}
+
+doc_id shard_corpus::base() const
+{
+    return doc_id{begin_};
+}
+}
+}
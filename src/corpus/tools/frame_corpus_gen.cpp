@@ -0,0 +1,49 @@
+/**
+ * @file frame_corpus_gen.cpp
+ * @author Chase Geigle
+ *
+ * Converts any configured corpus into a framed corpus container
+ * (independently compressed blocks with a block offset index), which
+ * supports both sequential streaming and random document fetch.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "cpptoml.h"
+#include "meta/corpus/corpus_factory.h"
+#include "meta/corpus/frame_corpus.h"
+
+using namespace meta;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage:\t" << argv[0] << " configFile [docsPerBlock]"
+                  << std::endl;
+        return 1;
+    }
+
+    auto config = cpptoml::parse_file(argv[1]);
+    auto prefix = config->get_as<std::string>("prefix");
+    if (!prefix)
+        throw std::runtime_error{"prefix missing from configuration file"};
+
+    auto dataset = config->get_as<std::string>("dataset");
+    if (!dataset)
+        throw std::runtime_error{"dataset missing from configuration file"};
+
+    uint64_t docs_per_block = 512;
+    if (argc == 3)
+        docs_per_block = std::stoull(argv[2]);
+
+    auto docs = corpus::make_corpus(*config);
+    auto out = *prefix + "/" + *dataset + "/" + *dataset;
+
+    std::cout << "Writing " << docs->size() << " documents to " << out
+              << ".frames" << std::endl;
+    corpus::frame_corpus::build(*docs, out, docs_per_block);
+
+    return 0;
+}
@@ -7,18 +7,147 @@
  * project.
  */
 
+#include <limits>
+
 #include "meta/embeddings/cooccurrence_counter.h"
 #include "meta/analyzers/analyzer.h"
 #include "meta/embeddings/cooccur_iterator.h"
+#include "meta/hashing/hash.h"
 #include "meta/logging/logger.h"
 #include "meta/util/printing.h"
 #include "meta/util/progress.h"
+#include "meta/util/shim.h"
 
 namespace meta
 {
 namespace embeddings
 {
 
+namespace
+{
+/**
+ * A small count-min sketch with conservative updates, used to estimate
+ * pair frequencies so that only pairs from the frequent head are
+ * admitted to the non-spilling accumulator.
+ */
+class frequency_sketch
+{
+  public:
+    frequency_sketch() : counts_(num_rows * width, 0)
+    {
+        // nothing
+    }
+
+    /**
+     * Records one observation of the hashed key.
+     * @return the new frequency estimate
+     */
+    uint32_t observe(uint64_t hash)
+    {
+        auto delta = (hash >> 32) | 1;
+        uint32_t est = std::numeric_limits<uint32_t>::max();
+        for (std::size_t row = 0; row < num_rows; ++row)
+            est = std::min(est,
+                           counts_[row * width
+                                   + ((hash + row * delta) & (width - 1))]);
+
+        // conservative update: only the minimal counters grow, which
+        // tightens the estimates for everything that collides with a
+        // heavy hitter
+        for (std::size_t row = 0; row < num_rows; ++row)
+        {
+            auto& count
+                = counts_[row * width + ((hash + row * delta) & (width - 1))];
+            if (count == est)
+                ++count;
+        }
+        return est + 1;
+    }
+
+    static std::size_t bytes()
+    {
+        return num_rows * width * sizeof(uint32_t);
+    }
+
+  private:
+    const static std::size_t num_rows = 4;
+    const static std::size_t width = 1 << 18;
+    std::vector<uint32_t> counts_;
+};
+
+/**
+ * A fixed-capacity open-addressing accumulator for the frequent-pair
+ * head. Admitted entries never move and the table is only drained when
+ * counting finishes, so the hottest pairs accumulate entirely in memory
+ * instead of being spilled to disk and re-merged over and over.
+ */
+class head_accumulator
+{
+  public:
+    using count_t = std::pair<cooccurrence_key, double>;
+
+    head_accumulator(std::size_t max_bytes)
+    {
+        std::size_t cap = 1;
+        while (cap * 2 * sizeof(count_t) <= max_bytes)
+            cap *= 2;
+        slots_.resize(cap,
+                      count_t{hashing::key_traits<cooccurrence_key>::sentinel(),
+                              0.0});
+        mask_ = cap - 1;
+    }
+
+    /**
+     * @return whether the pair was accumulated; false means the probe
+     * window was full of other keys and the caller should take the
+     * spill path instead
+     */
+    bool increment(const cooccurrence_key& key, double weight, uint64_t hash)
+    {
+        auto idx = hash & mask_;
+        for (std::size_t probe = 0; probe < max_probe; ++probe)
+        {
+            auto& slot = slots_[idx];
+            if (slot.first == key)
+            {
+                slot.second += weight;
+                return true;
+            }
+            if (slot.first
+                == hashing::key_traits<cooccurrence_key>::sentinel())
+            {
+                slot.first = key;
+                slot.second = weight;
+                return true;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        return false;
+    }
+
+    /**
+     * Moves all accumulated pairs out of the table.
+     */
+    std::vector<count_t> extract()
+    {
+        std::vector<count_t> items;
+        for (const auto& slot : slots_)
+        {
+            if (!(slot.first
+                  == hashing::key_traits<cooccurrence_key>::sentinel()))
+                items.push_back(slot);
+        }
+        slots_.clear();
+        return items;
+    }
+
+  private:
+    const static std::size_t max_probe = 16;
+    std::vector<count_t> slots_;
+    std::size_t mask_;
+};
+}
+
 class cooccurrence_buffer
 {
   public:
@@ -29,11 +158,19 @@ class cooccurrence_buffer
                         const analyzers::token_stream& stream)
         : counter_{counter},
           max_bytes_{max_bytes},
-          cooccurrences_{
-              static_cast<std::size_t>(max_bytes_ / sizeof(count_t))},
           stream_{stream.clone()}
     {
-        // nothing
+        // the two-level combiner only pays for itself when there is a
+        // reasonable amount of headroom beyond the sketch; with tiny
+        // budgets everything takes the spill path as before
+        if (max_bytes_ >= 8 * frequency_sketch::bytes())
+        {
+            sketch_ = make_unique<frequency_sketch>();
+            head_ = make_unique<head_accumulator>(max_bytes_ / 4);
+            max_bytes_ -= frequency_sketch::bytes() + max_bytes_ / 4;
+        }
+        cooccurrences_
+            = map_t{static_cast<std::size_t>(max_bytes_ / sizeof(count_t))};
     }
 
     cooccurrence_buffer(cooccurrence_buffer&&) = default;
@@ -41,6 +178,7 @@ class cooccurrence_buffer
 
     ~cooccurrence_buffer()
     {
+        drain_head();
         flush();
         --counter_->num_tokenizing_;
     }
@@ -74,6 +212,18 @@ class cooccurrence_buffer
     void operator()(uint64_t target, uint64_t context, double weight)
     {
         cooccurrence_key key{target, context};
+
+        // pairs from the estimated frequent head accumulate in the
+        // fixed-size table, which never flushes mid-run; everything
+        // else (the long tail) takes the spill path
+        if (sketch_)
+        {
+            auto hashed = hash_(key);
+            if (sketch_->observe(hashed) >= head_threshold
+                && head_->increment(key, weight, hashed))
+                return;
+        }
+
         auto it = cooccurrences_.find(key);
         if (it == cooccurrences_.end())
         {
@@ -87,6 +237,32 @@ class cooccurrence_buffer
     }
 
   private:
+    /**
+     * Folds the head accumulator back into the spill path when counting
+     * finishes, so its contents reach disk through the normal chunk
+     * machinery.
+     */
+    void drain_head()
+    {
+        if (!head_)
+            return;
+        for (const auto& item : head_->extract())
+        {
+            auto it = cooccurrences_.find(item.first);
+            if (it == cooccurrences_.end())
+            {
+                maybe_flush();
+                cooccurrences_[item.first] = item.second;
+            }
+            else
+            {
+                it->value() += item.second;
+            }
+        }
+        head_ = nullptr;
+        sketch_ = nullptr;
+    }
+
     void maybe_flush()
     {
         // check if inserting a new cooccurrence would cause a resize
@@ -106,10 +282,16 @@ class cooccurrence_buffer
 
     friend class cooccurrence_counter;
 
+    /// Estimated frequency at or above which a pair is treated as head
+    const static uint32_t head_threshold = 32;
+
     cooccurrence_counter* counter_;
-    const std::size_t max_bytes_;
+    std::size_t max_bytes_;
     map_t cooccurrences_;
     std::unique_ptr<analyzers::token_stream> stream_;
+    hashing::hash<> hash_;
+    std::unique_ptr<frequency_sketch> sketch_;
+    std::unique_ptr<head_accumulator> head_;
 };
 
 namespace
@@ -121,11 +303,10 @@ load_vocab(const std::string& filename)
 
     std::ifstream input{filename, std::ios::binary};
     auto size = io::packed::read<uint64_t>(input);
-    auto reserve_size = static_cast<std::size_t>(
-        std::ceil(size / map_type::default_max_load_factor()));
 
     printing::progress progress{" > Loading vocab: ", size};
-    map_type vocab{reserve_size};
+    map_type vocab;
+    vocab.reserve(static_cast<std::size_t>(size));
     for (uint64_t tid{0}; tid < size; ++tid)
     {
         progress(tid);
@@ -195,7 +376,7 @@ void cooccurrence_counter::count(corpus::corpus& docs,
                 else
                 {
                     // ignore out-of-vocabulary words
-                    auto it = vocab_.find(tok);
+                    auto it = vocab_.find(tok.to_string());
                     if (it == vocab_.end())
                         continue;
 
@@ -324,15 +505,72 @@ void cooccurrence_counter::maybe_merge()
 
 cooccurrence_counter::~cooccurrence_counter()
 {
-    std::vector<embeddings::destructive_cooccur_iterator> chunks;
-
-    chunks.reserve(chunks_.size());
+    std::vector<cooccurrence_chunk> remaining;
+    remaining.reserve(chunks_.size());
     while (!chunks_.empty())
     {
-        chunks.emplace_back(chunks_.top().path);
+        remaining.push_back(chunks_.top());
         chunks_.pop();
     }
 
+    // when many chunks survive to the end, pre-merge them in parallel:
+    // each thread merges its own (size-balanced) group down to a single
+    // chunk, leaving only a handful of inputs for the sequential final
+    // pass below
+    if (remaining.size() > 2 * pool_.size() && pool_.size() > 1)
+    {
+        auto num_groups = std::min(pool_.size(), remaining.size() / 2);
+        std::vector<std::vector<std::string>> groups(num_groups);
+        std::vector<uint64_t> group_sizes(num_groups, 0);
+
+        // chunks are already ordered largest-first; always hand the
+        // next chunk to the lightest group
+        for (const auto& chunk : remaining)
+        {
+            auto lightest = static_cast<std::size_t>(
+                std::distance(group_sizes.begin(),
+                              std::min_element(group_sizes.begin(),
+                                               group_sizes.end())));
+            groups[lightest].push_back(chunk.path);
+            group_sizes[lightest] += chunk.size;
+        }
+
+        LOG(info) << "Pre-merging " << remaining.size() << " chunks in "
+                  << num_groups << " parallel groups..." << ENDLG;
+
+        std::vector<std::future<cooccurrence_chunk>> futures;
+        futures.reserve(num_groups);
+        for (auto& group : groups)
+        {
+            auto filename = prefix_ + "/chunk-" + std::to_string(chunk_num_++);
+            futures.emplace_back(pool_.submit_task([group, filename]() {
+                std::vector<embeddings::destructive_cooccur_iterator> its;
+                its.reserve(group.size());
+                for (const auto& path : group)
+                    its.emplace_back(path);
+
+                uint64_t total_bytes = 0;
+                std::ofstream output{filename, std::ios::binary};
+                util::multiway_merge(its.begin(), its.end(),
+                                     [&](cooccur_record&& record) {
+                                         total_bytes += io::packed::write(
+                                             output, record);
+                                     },
+                                     printing::no_progress_trait{});
+                return cooccurrence_chunk{filename, total_bytes};
+            }));
+        }
+
+        remaining.clear();
+        for (auto& fut : futures)
+            remaining.push_back(fut.get());
+    }
+
+    std::vector<embeddings::destructive_cooccur_iterator> chunks;
+    chunks.reserve(remaining.size());
+    for (const auto& chunk : remaining)
+        chunks.emplace_back(chunk.path);
+
     std::ofstream output{prefix_ + "/cooccur.bin", std::ios::binary};
     auto num_records = util::multiway_merge(
         chunks.begin(), chunks.end(),
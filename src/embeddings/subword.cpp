@@ -0,0 +1,47 @@
+/**
+ * @file subword.cpp
+ * @author Chase Geigle
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#include <string>
+
+#include "meta/embeddings/subword.h"
+#include "meta/hashing/hashes/murmur_hash.h"
+
+namespace meta
+{
+namespace embeddings
+{
+
+std::vector<uint64_t> subword_buckets(util::string_view word,
+                                      uint64_t num_buckets,
+                                      std::size_t min_ngram,
+                                      std::size_t max_ngram)
+{
+    std::vector<uint64_t> buckets;
+    if (num_buckets == 0)
+        return buckets;
+
+    auto padded = "<" + word.to_string() + ">";
+    for (auto n = min_ngram; n <= max_ngram && n <= padded.size(); ++n)
+    {
+        for (std::size_t i = 0; i + n <= padded.size(); ++i)
+        {
+            // skip the n-gram spanning the whole padded word: that
+            // surface form is already represented by the word vector
+            if (i == 0 && n == padded.size())
+                continue;
+
+            hashing::murmur_hash<8> hash{0x9e3779b97f4a7c15ULL};
+            hash(padded.data() + i, n);
+            buckets.push_back(static_cast<uint64_t>(hash) % num_buckets);
+        }
+    }
+    return buckets;
+}
+}
+}
@@ -0,0 +1,421 @@
+/**
+ * @file bench_embeddings.cpp
+ * @author Chase Geigle
+ *
+ * Benchmark and quality harness for trained word embeddings. Loads a
+ * model from the usual [embeddings] configuration, optionally scores it
+ * against standard analogy and word-similarity suites, measures lookup
+ * and top-k throughput, and emits a single JSON object on stdout so
+ * quality and speed can be tracked together when the training pipeline
+ * changes.
+ *
+ * The optional [embeddings.bench] table recognizes:
+ *   analogy-file    questions in the Google analogy format
+ *                   ("a b c d" per line; ": section" headers skipped)
+ *   similarity-file scored word pairs ("w1 w2 score" per line)
+ *   num-lookups     number of at() calls to time (default 100000)
+ *   num-queries     number of top_k() calls to time (default 100)
+ *   top-k           the k used for the timed queries (default 10)
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "cpptoml.h"
+#include "meta/embeddings/word_embeddings.h"
+#include "meta/logging/logger.h"
+#include "meta/math/vector.h"
+
+using namespace meta;
+
+namespace
+{
+
+/**
+ * @return the peak resident set size of this process in kilobytes, or 0
+ * if the platform provides no way to query it
+ */
+uint64_t peak_rss_kb()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+    return 0;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+double cosine(util::array_view<const double> a,
+              util::array_view<const double> b)
+{
+    double dot = 0.0;
+    double norm_a = 0.0;
+    double norm_b = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        dot += a[i] * b[i];
+        norm_a += a[i] * a[i];
+        norm_b += b[i] * b[i];
+    }
+    if (norm_a == 0 || norm_b == 0)
+        return 0.0;
+    return dot / (std::sqrt(norm_a) * std::sqrt(norm_b));
+}
+
+/**
+ * @return the (tie-averaged) ranks of the given values
+ */
+std::vector<double> ranks(const std::vector<double>& values)
+{
+    std::vector<std::size_t> order(values.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t a, std::size_t b) {
+                  return values[a] < values[b];
+              });
+
+    std::vector<double> result(values.size());
+    std::size_t i = 0;
+    while (i < order.size())
+    {
+        auto j = i;
+        while (j + 1 < order.size()
+               && values[order[j + 1]] == values[order[i]])
+            ++j;
+        // ties share the average of the ranks they span
+        auto rank = (i + j) / 2.0 + 1.0;
+        for (auto k = i; k <= j; ++k)
+            result[order[k]] = rank;
+        i = j + 1;
+    }
+    return result;
+}
+
+/**
+ * @return the Spearman rank correlation between the two value lists
+ */
+double spearman(const std::vector<double>& xs, const std::vector<double>& ys)
+{
+    auto rx = ranks(xs);
+    auto ry = ranks(ys);
+
+    auto n = static_cast<double>(rx.size());
+    auto mean = (n + 1) / 2.0;
+    double cov = 0.0;
+    double var_x = 0.0;
+    double var_y = 0.0;
+    for (std::size_t i = 0; i < rx.size(); ++i)
+    {
+        cov += (rx[i] - mean) * (ry[i] - mean);
+        var_x += (rx[i] - mean) * (rx[i] - mean);
+        var_y += (ry[i] - mean) * (ry[i] - mean);
+    }
+    if (var_x == 0 || var_y == 0)
+        return 0.0;
+    return cov / std::sqrt(var_x * var_y);
+}
+
+std::string lowercase(std::string word)
+{
+    std::transform(word.begin(), word.end(), word.begin(), [](char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return word;
+}
+
+/**
+ * Looks up a word and copies its vector out, flagging OOV terms.
+ * Copying decouples the result from the thread-local buffers the
+ * quantized and subword paths return views into.
+ */
+bool lookup(const embeddings::word_embeddings& model, const std::string& word,
+            std::size_t& tid, std::vector<double>& vec)
+{
+    auto e = model.at(lowercase(word));
+    if (e.tid == model.vocab_size())
+        return false;
+    tid = e.tid;
+    vec.assign(e.v.begin(), e.v.end());
+    return true;
+}
+
+struct analogy_result
+{
+    uint64_t total = 0;
+    uint64_t skipped = 0;
+    uint64_t correct = 0;
+};
+
+/**
+ * Scores "a is to b as c is to ?" questions: the query b - a + c is
+ * answered with the best-scoring word among the top results that is not
+ * one of the three question words.
+ */
+analogy_result eval_analogies(const embeddings::word_embeddings& model,
+                              const std::string& path)
+{
+    std::ifstream input{path};
+    analogy_result result;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.empty() || line.front() == ':')
+            continue;
+
+        std::istringstream iss{line};
+        std::string a, b, c, d;
+        if (!(iss >> a >> b >> c >> d))
+            continue;
+
+        ++result.total;
+
+        std::size_t tid_a, tid_b, tid_c, tid_d;
+        std::vector<double> va, vb, vc, vd;
+        if (!lookup(model, a, tid_a, va) || !lookup(model, b, tid_b, vb)
+            || !lookup(model, c, tid_c, vc) || !lookup(model, d, tid_d, vd))
+        {
+            ++result.skipped;
+            continue;
+        }
+
+        using namespace meta::math::operators;
+        auto query = vb - va + vc;
+        auto len = l2norm(query);
+        for (auto& weight : query)
+            weight /= len;
+
+        // k = 4 is enough to find one word that isn't a, b, or c
+        for (const auto& scored :
+             model.top_k({query.data(), query.size()}, 4))
+        {
+            if (scored.e.tid == tid_a || scored.e.tid == tid_b
+                || scored.e.tid == tid_c)
+                continue;
+            if (scored.e.tid == tid_d)
+                ++result.correct;
+            break;
+        }
+    }
+    return result;
+}
+
+struct similarity_result
+{
+    uint64_t total = 0;
+    uint64_t skipped = 0;
+    double spearman = 0;
+};
+
+similarity_result eval_similarity(const embeddings::word_embeddings& model,
+                                  const std::string& path)
+{
+    std::ifstream input{path};
+    similarity_result result;
+
+    std::vector<double> human;
+    std::vector<double> predicted;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream iss{line};
+        std::string first, second;
+        double score;
+        if (!(iss >> first >> second >> score))
+            continue;
+
+        ++result.total;
+
+        std::size_t tid_first, tid_second;
+        std::vector<double> v_first, v_second;
+        if (!lookup(model, first, tid_first, v_first)
+            || !lookup(model, second, tid_second, v_second))
+        {
+            ++result.skipped;
+            continue;
+        }
+
+        human.push_back(score);
+        predicted.push_back(cosine({v_first.data(), v_first.size()},
+                                   {v_second.data(), v_second.size()}));
+    }
+
+    if (!human.empty())
+        result.spearman = spearman(human, predicted);
+    return result;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " config.toml" << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging();
+
+    auto config = cpptoml::parse_file(argv[1]);
+    auto embed_cfg = config->get_table("embeddings");
+    if (!embed_cfg)
+    {
+        std::cerr << "Missing [embeddings] configuration in " << argv[1]
+                  << std::endl;
+        return 1;
+    }
+
+    uint64_t num_lookups = 100000;
+    uint64_t num_queries = 100;
+    std::size_t top_k = 10;
+    std::string analogy_file;
+    std::string similarity_file;
+    if (auto bench_cfg = embed_cfg->get_table("bench"))
+    {
+        num_lookups
+            = bench_cfg->get_as<uint64_t>("num-lookups").value_or(num_lookups);
+        num_queries
+            = bench_cfg->get_as<uint64_t>("num-queries").value_or(num_queries);
+        top_k = bench_cfg->get_as<std::size_t>("top-k").value_or(top_k);
+        analogy_file
+            = bench_cfg->get_as<std::string>("analogy-file").value_or("");
+        similarity_file
+            = bench_cfg->get_as<std::string>("similarity-file").value_or("");
+    }
+
+    auto load_start = std::chrono::steady_clock::now();
+    auto model = embeddings::load_embeddings(*embed_cfg);
+    auto load_seconds = seconds_since(load_start);
+
+    auto vocab = model.vocab_size();
+    auto dims = model.vector_size();
+
+    std::mt19937_64 rng{42};
+    std::uniform_int_distribution<std::size_t> pick{0, vocab - 1};
+
+    // quality suites (optional)
+    analogy_result analogies;
+    if (!analogy_file.empty())
+    {
+        LOG(info) << "Scoring analogy suite: " << analogy_file << ENDLG;
+        analogies = eval_analogies(model, analogy_file);
+    }
+
+    similarity_result similarity;
+    if (!similarity_file.empty())
+    {
+        LOG(info) << "Scoring similarity suite: " << similarity_file << ENDLG;
+        similarity = eval_similarity(model, similarity_file);
+    }
+
+    // lookup throughput over a random sample of the vocabulary
+    std::vector<std::string> words(num_lookups);
+    for (auto& word : words)
+        word = model.term(pick(rng)).to_string();
+
+    LOG(info) << "Timing lookups..." << ENDLG;
+    double checksum = 0;
+    auto lookup_start = std::chrono::steady_clock::now();
+    for (const auto& word : words)
+        checksum += model.at(word).v[0];
+    auto lookup_seconds = seconds_since(lookup_start);
+
+    // top-k throughput, single-query and batched, over copies of random
+    // in-vocabulary vectors
+    std::vector<std::vector<double>> queries(num_queries);
+    for (auto& query : queries)
+    {
+        auto e = model.at(model.term(pick(rng)));
+        query.assign(e.v.begin(), e.v.end());
+    }
+
+    LOG(info) << "Timing top_k..." << ENDLG;
+    auto single_start = std::chrono::steady_clock::now();
+    for (const auto& query : queries)
+        checksum += model.top_k({query.data(), query.size()}, top_k)
+                        .front()
+                        .score;
+    auto single_seconds = seconds_since(single_start);
+
+    std::vector<util::array_view<const double>> views;
+    views.reserve(queries.size());
+    for (const auto& query : queries)
+        views.push_back({query.data(), query.size()});
+
+    auto batch_start = std::chrono::steady_clock::now();
+    auto batched = model.top_k(views, top_k);
+    auto batch_seconds = seconds_since(batch_start);
+    checksum += batched.front().front().score;
+
+    std::cout << "{\n"
+              << "  \"config\": {\n"
+              << "    \"vocab_size\": " << vocab << ",\n"
+              << "    \"vector_size\": " << dims << ",\n"
+              << "    \"num_lookups\": " << num_lookups << ",\n"
+              << "    \"num_queries\": " << num_queries << ",\n"
+              << "    \"top_k\": " << top_k << "\n"
+              << "  },\n";
+
+    if (!analogy_file.empty())
+    {
+        auto answered = analogies.total - analogies.skipped;
+        std::cout << "  \"analogy\": {\n"
+                  << "    \"total\": " << analogies.total << ",\n"
+                  << "    \"skipped\": " << analogies.skipped << ",\n"
+                  << "    \"correct\": " << analogies.correct << ",\n"
+                  << "    \"accuracy\": "
+                  << (answered ? static_cast<double>(analogies.correct)
+                                     / answered
+                               : 0.0)
+                  << "\n  },\n";
+    }
+
+    if (!similarity_file.empty())
+    {
+        std::cout << "  \"similarity\": {\n"
+                  << "    \"total\": " << similarity.total << ",\n"
+                  << "    \"skipped\": " << similarity.skipped << ",\n"
+                  << "    \"spearman\": " << similarity.spearman
+                  << "\n  },\n";
+    }
+
+    std::cout << "  \"throughput\": {\n"
+              << "    \"load_seconds\": " << load_seconds << ",\n"
+              << "    \"lookups_per_sec\": " << num_lookups / lookup_seconds
+              << ",\n"
+              << "    \"top_k_per_sec\": " << num_queries / single_seconds
+              << ",\n"
+              << "    \"batched_top_k_per_sec\": "
+              << num_queries / batch_seconds << "\n"
+              << "  },\n"
+              << "  \"peak_rss_kb\": " << peak_rss_kb() << "\n"
+              << "}" << std::endl;
+
+    // keep the timed calls from being optimized away
+    if (checksum == std::numeric_limits<double>::infinity())
+        return 2;
+
+    return 0;
+}
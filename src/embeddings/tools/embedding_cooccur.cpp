@@ -11,12 +11,42 @@
 #include "cpptoml.h"
 #include "meta/analyzers/analyzer.h"
 #include "meta/corpus/corpus_factory.h"
+#include "meta/embeddings/cooccur_iterator.h"
 #include "meta/embeddings/cooccurrence_counter.h"
 #include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
 #include "meta/logging/logger.h"
+#include "meta/util/multiway_merge.h"
 
 using namespace meta;
 
+/**
+ * Merges the previous sorted cooccurrence matrix with the freshly
+ * counted delta: both files are already sorted by (target, context), so
+ * one multiway_merge pass sums the weights of matching pairs. The cost
+ * is proportional to the two files, not to recounting the full corpus.
+ */
+void merge_with_base(const std::string& base, const std::string& delta,
+                     const std::string& output_path)
+{
+    std::vector<embeddings::destructive_cooccur_iterator> chunks;
+    chunks.reserve(2);
+    chunks.emplace_back(base);
+    chunks.emplace_back(delta);
+
+    uint64_t num_records = 0;
+    {
+        std::ofstream output{output_path, std::ios::binary};
+        num_records = util::multiway_merge(
+            chunks.begin(), chunks.end(),
+            [&](embeddings::cooccur_record&& record) {
+                io::packed::write(output, record);
+            });
+    }
+    LOG(info) << "Merged cooccurrence matrix elements: " << num_records
+              << ENDLG;
+}
+
 int main(int argc, char** argv)
 {
     if (argc < 2)
@@ -62,6 +92,19 @@ int main(int argc, char** argv)
         = embed_cfg->get_as<std::size_t>("num-threads")
               .value_or(std::max(1u, std::thread::hardware_concurrency()));
 
+    // in incremental mode, the corpus in the configuration is a delta:
+    // the existing matrix is set aside, the delta is counted on its own,
+    // and the two sorted files are merged afterwards
+    auto incremental = embed_cfg->get_as<bool>("incremental").value_or(false);
+    auto cooccur_path = prefix + "/cooccur.bin";
+    auto base_path = prefix + "/cooccur.base.tmp";
+    bool have_base = false;
+    if (incremental && filesystem::file_exists(cooccur_path))
+    {
+        filesystem::rename_file(cooccur_path, base_path);
+        have_base = true;
+    }
+
     {
         embeddings::cooccurrence_counter::configuration cooccur_config;
         cooccur_config.prefix = prefix;
@@ -77,5 +120,14 @@ int main(int argc, char** argv)
         counter.count(*docs, *stream);
     }
 
+    if (have_base)
+    {
+        auto merged_path = prefix + "/cooccur.merged.tmp";
+        filesystem::rename_file(cooccur_path, prefix + "/cooccur.delta.tmp");
+        merge_with_base(base_path, prefix + "/cooccur.delta.tmp",
+                        merged_path);
+        filesystem::rename_file(merged_path, cooccur_path);
+    }
+
     return 0;
 }
@@ -5,13 +5,19 @@
  * This tool builds the vocabulary file for the other word embedding tools.
  */
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include "cpptoml.h"
 #include "meta/analyzers/all.h"
 #include "meta/analyzers/token_stream.h"
 #include "meta/corpus/corpus_factory.h"
+#include "meta/hashing/hyperloglog.h"
 #include "meta/hashing/probe_map.h"
 #include "meta/io/packed.h"
 #include "meta/logging/logger.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/util/progress.h"
 
 using namespace meta;
@@ -38,27 +44,101 @@ int main(int argc, char** argv)
     auto max_size = vocab_cfg->get_as<int64_t>("max-size")
                         .value_or(std::numeric_limits<int64_t>::max());
 
+    auto num_threads
+        = embed_cfg->get_as<std::size_t>("num-threads")
+              .value_or(std::max(1u, std::thread::hardware_concurrency()));
+
     auto stream = analyzers::load_filters(*config, *embed_cfg);
-    hashing::probe_map<std::string, uint64_t> vocab;
+
+    /// Per-thread counting state: a cloned filter chain and an exact
+    /// frequency map over the documents this thread consumed
+    struct local_vocab
+    {
+        std::unique_ptr<analyzers::token_stream> stream;
+        hashing::probe_map<std::string, uint64_t> counts;
+        /// cardinality sketch used to presize counts ahead of growth
+        hashing::hyperloglog<std::string> sketch;
+        uint64_t num_tokens = 0;
+    };
+
+    parallel::thread_pool pool{num_threads};
+    std::vector<local_vocab> locals(pool.size());
+    std::atomic<std::size_t> next_local{0};
+    std::mutex io_mutex;
 
     {
         auto docs = corpus::make_corpus(*config);
         printing::progress progress{" > Building vocabulary: ", docs->size()};
-        for (uint64_t i = 0; docs->has_next(); ++i)
-        {
-            progress(i);
-            auto doc = docs->next();
-            stream->set_content(analyzers::get_content(doc));
+        corpus::parallel_consume(
+            *docs, pool,
+            [&]() {
+                auto idx = next_local++;
+                locals[idx].stream = stream->clone();
+                return idx;
+            },
+            [&](std::size_t idx, const corpus::document& doc) {
+                auto& local = locals[idx];
+                {
+                    std::lock_guard<std::mutex> lock{io_mutex};
+                    progress(doc.id());
+                }
+
+                local.stream->set_content(analyzers::get_content(doc));
+                while (*local.stream)
+                {
+                    auto tok = local.stream->next().to_string();
+                    local.sketch.insert(tok);
+                    local.counts.insert_or_add(tok, 1);
+
+                    // periodically jump the table straight to the
+                    // estimated final size instead of rehashing
+                    // through every intermediate capacity
+                    if (++local.num_tokens % 65536 == 0)
+                        local.counts.reserve(static_cast<std::size_t>(
+                            local.sketch.estimate()));
+                }
+            });
+    }
 
-            while (*stream)
-                ++vocab[stream->next()];
+    using count_t = std::pair<std::string, uint64_t>;
+
+    // merge the per-thread maps, applying the min-count threshold as
+    // part of the merge: each key is owned by the first map containing
+    // it, its total is summed across the later maps, and sub-threshold
+    // words (the singleton-heavy tail) are never materialized in the
+    // merged list
+    LOG(progress) << "> Merging thread-local vocabularies...\n" << ENDLG;
+    uint64_t total_unique = 0;
+    std::vector<count_t> items;
+    for (std::size_t i = 0; i < locals.size(); ++i)
+    {
+        for (const auto& kv : locals[i].counts)
+        {
+            bool owned = true;
+            for (std::size_t j = 0; j < i && owned; ++j)
+                owned = locals[j].counts.find(kv.key())
+                        == locals[j].counts.end();
+            if (!owned)
+                continue;
+
+            ++total_unique;
+            auto total = kv.value();
+            for (std::size_t j = i + 1; j < locals.size(); ++j)
+            {
+                auto it = locals[j].counts.find(kv.key());
+                if (it != locals[j].counts.end())
+                    total += it->value();
+            }
+
+            if (total >= static_cast<uint64_t>(min_count))
+                items.emplace_back(kv.key(), total);
         }
     }
+    locals.clear();
 
-    LOG(info) << "Found " << vocab.size() << " unique words" << ENDLG;
+    LOG(info) << "Found " << total_unique << " unique words" << ENDLG;
 
     LOG(progress) << "> Sorting vocab...\n" << ENDLG;
-    auto items = std::move(vocab).extract();
 
     auto begin = std::begin(items);
     auto end = std::end(items);
@@ -66,8 +146,6 @@ int main(int argc, char** argv)
     if (items.size() > static_cast<std::size_t>(max_size))
         middle = begin + max_size;
 
-    using count_t = std::pair<std::string, uint64_t>;
-
     // partial sort to avoid doing redundant work if our desired vocab
     // size is smaller than items.size()
     std::partial_sort(begin, middle, end, [](const count_t& a, const count_t& b)
@@ -75,17 +153,7 @@ int main(int argc, char** argv)
                           return a.second > b.second;
                       });
 
-    // truncate the vocabulary if needed: locate the position one past the
-    // last element that is greater than the threshold value
-    auto it
-        = std::lower_bound(begin, middle, static_cast<uint64_t>(min_count) - 1,
-                           [](const count_t& a, uint64_t thresh)
-                           {
-                               // comparison is reversed since we're
-                               // working on reverse-sorted data
-                               return a.second > thresh;
-                           });
-
+    auto it = middle;
     auto size = static_cast<uint64_t>(std::distance(begin, it));
 
     LOG(info) << "Vocab truncated to size " << size << ENDLG;
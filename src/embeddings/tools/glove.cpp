@@ -8,25 +8,34 @@
  * @see http://nlp.stanford.edu/projects/glove/
  */
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_set>
 
 #include "cpptoml.h"
 #include "meta/embeddings/cooccur_iterator.h"
+#include "meta/embeddings/subword.h"
 #include "meta/io/filesystem.h"
 #include "meta/io/packed.h"
 #include "meta/logging/logger.h"
+#include "meta/math/compute_backend.h"
 #include "meta/parallel/thread_pool.h"
 #include "meta/util/aligned_allocator.h"
 #include "meta/util/array_view.h"
 #include "meta/util/printing.h"
 #include "meta/util/progress.h"
 #include "meta/util/random.h"
+#include "meta/util/shim.h"
 #include "meta/util/time.h"
 
 using namespace meta;
 
-std::size_t shuffle_partition(const std::string& prefix, std::size_t max_ram,
-                              std::size_t num_partitions)
+std::size_t shuffle_partition(
+    const std::string& prefix, std::size_t max_ram, std::size_t num_partitions,
+    std::function<std::size_t(const embeddings::cooccur_record&)> route = {})
 {
     using namespace embeddings;
 
@@ -118,10 +127,12 @@ std::size_t shuffle_partition(const std::string& prefix, std::size_t max_ram,
             if (i == 0)
                 break;
 
-            // partition the records into the output files randomly
+            // partition the records into the output files, either
+            // randomly or via the caller's routing function
             for (std::size_t j = 0; j < i; ++j)
             {
-                auto idx = random::bounded_rand(engine, outputs.size());
+                auto idx = route ? route(records[j])
+                                 : random::bounded_rand(engine, outputs.size());
                 io::packed::write(outputs[idx], records[j]);
             }
         }
@@ -168,6 +179,13 @@ class glove_trainer
 
         auto num_rare = embed_cfg.get_as<uint64_t>("unk-num-avg").value_or(100);
 
+        num_buckets_
+            = embed_cfg.get_as<uint64_t>("subword-buckets").value_or(0);
+        min_ngram_
+            = embed_cfg.get_as<std::size_t>("subword-min-ngram").value_or(3);
+        max_ngram_
+            = embed_cfg.get_as<std::size_t>("subword-max-ngram").value_or(6);
+
         if (!filesystem::file_exists(prefix + "/vocab.bin"))
         {
             LOG(fatal) << "Vocabulary has not yet been generated, please "
@@ -185,9 +203,32 @@ class glove_trainer
             throw glove_exception{"no cooccurrence matrix found in " + prefix};
         }
 
+        // with word sharding enabled, every word is owned by one thread
+        // (round-robin by id, since the vocabulary is frequency-sorted
+        // and contiguous ranges would be badly unbalanced): records are
+        // routed to the shard owning their target word, so each target
+        // row is only ever written by its owner, and context-row
+        // gradients for remote words travel through per-shard queues
+        // instead of hammering one shared table from every socket
+        if (embed_cfg.get_as<bool>("shard-words").value_or(false))
+        {
+            num_shards_ = num_threads;
+            queues_.reserve(num_shards_);
+            for (std::size_t s = 0; s < num_shards_; ++s)
+                queues_.push_back(make_unique<shard_queue>());
+        }
+
         // shuffle the data and partition it into equal parts for each
-        // thread
-        auto total_records = shuffle_partition(prefix, max_ram, num_threads);
+        // thread (or into per-shard parts when word sharding is on)
+        std::function<std::size_t(const embeddings::cooccur_record&)> route;
+        if (num_shards_ > 0)
+        {
+            route = [this](const embeddings::cooccur_record& record) {
+                return shard_of(record.target);
+            };
+        }
+        auto total_records
+            = shuffle_partition(prefix, max_ram, num_threads, route);
 
         std::size_t num_words = 0;
         {
@@ -214,9 +255,50 @@ class glove_trainer
             });
         }
 
+        // with subword hashing enabled, precompute each word's char
+        // n-gram bucket ids and allocate the shared bucket table
+        if (num_buckets_ > 0)
+        {
+            std::ifstream vocab{prefix + "/vocab.bin", std::ios::binary};
+            io::packed::read<std::size_t>(vocab);
+
+            word_buckets_.resize(num_words);
+            std::string word;
+            for (auto& buckets : word_buckets_)
+            {
+                io::packed::read(vocab, word);
+                // discard the count
+                io::packed::read<std::size_t>(vocab);
+                buckets = embeddings::subword_buckets(word, num_buckets_,
+                                                      min_ngram_, max_ngram_);
+            }
+
+            subword_weights_.resize(num_buckets_ * vector_size_);
+            subword_gradsq_.resize(num_buckets_ * vector_size_, 1.0);
+            std::mt19937 engine{std::random_device{}()};
+            std::generate(subword_weights_.begin(), subword_weights_.end(),
+                          [&]() {
+                              auto rnd = random::bounded_rand(engine, 65536);
+                              return (rnd / 65536.0 - 0.5)
+                                     / (vector_size_ + 1);
+                          });
+        }
+
+        // in warm-start mode, resume from the saved weight and AdaGrad
+        // state of the previous run (if any) instead of the random
+        // initialization, so refreshes on a grown cooccurrence matrix
+        // converge in a handful of iterations
+        auto warm_start
+            = embed_cfg.get_as<bool>("warm-start").value_or(false);
+        if (warm_start && load_state(prefix, num_words))
+            LOG(info) << "Resuming from saved GloVe training state" << ENDLG;
+
         // train using the specified number of threads
         train(prefix, num_threads, iters, total_records);
 
+        if (warm_start)
+            save_state(prefix, num_words);
+
         // delete the temporary shuffled cooccurrence files
         for (std::size_t i = 0; i < num_threads; ++i)
             filesystem::delete_file(prefix + "/cooccur-shuf."
@@ -280,6 +362,91 @@ class glove_trainer
     }
 
   private:
+    /**
+     * A context-row gradient routed to the shard that owns the word:
+     * the raw gradient vector and bias delta are shipped, and the owner
+     * applies them against its own AdaGrad accumulators.
+     */
+    struct context_update
+    {
+        uint64_t term;
+        double bias_grad;
+        std::vector<double> grad;
+    };
+
+    /// The pending cross-shard context updates for one shard
+    struct shard_queue
+    {
+        std::mutex mutex;
+        std::vector<context_update> updates;
+    };
+
+    /**
+     * @return the shard owning the given word (round-robin by id, so
+     * the frequency-sorted vocabulary spreads evenly)
+     */
+    std::size_t shard_of(uint64_t term) const
+    {
+        return term % num_shards_;
+    }
+
+    /**
+     * Applies all pending cross-shard context updates for the given
+     * shard. Called by the owning thread between record blocks and once
+     * sequentially at the end of each iteration.
+     */
+    void drain_queue(std::size_t shard)
+    {
+        std::vector<context_update> pending;
+        {
+            std::lock_guard<std::mutex> lock{queues_[shard]->mutex};
+            pending.swap(queues_[shard]->updates);
+        }
+
+        if (pending.empty())
+            return;
+
+        // stage the drained updates as flat gradient blocks so the
+        // compute backend can apply each batch in a single call; the
+        // same element offset indexes a context row in both weights_
+        // and grad_squared_. AdaGrad updates do not commute, so a
+        // repeated term flushes the batch before joining a new one —
+        // offsets within one backend call never alias
+        std::vector<std::size_t> offsets;
+        util::aligned_vector<double> grads;
+        std::unordered_set<uint64_t> seen;
+
+        auto flush = [&]() {
+            if (offsets.empty())
+                return;
+            math::compute_backend::instance().adagrad_apply(
+                weights_.data(), grad_squared_.data(), offsets.data(),
+                grads.data(), offsets.size(), vector_size_);
+            offsets.clear();
+            grads.clear();
+            seen.clear();
+        };
+
+        for (const auto& update : pending)
+        {
+            if (!seen.insert(update.term).second)
+            {
+                flush();
+                seen.insert(update.term);
+            }
+            offsets.push_back((update.term * 2 + 1) * (vector_size_ + 1));
+            grads.insert(grads.end(), update.grad.begin(), update.grad.end());
+        }
+        flush();
+
+        for (const auto& update : pending)
+        {
+            update_weight(&context_bias(update.term),
+                          &context_bias_gradsq(update.term),
+                          update.bias_grad);
+        }
+    }
+
     util::array_view<double> target_gradsq(uint64_t term)
     {
         return {grad_squared_.data() + (term * 2 * (vector_size_ + 1)),
@@ -324,6 +491,11 @@ class glove_trainer
             auto elapsed = common::time([&]() {
                 for (auto& fut : futures)
                     total_cost += fut.get();
+
+                // every thread is done producing, so flush whatever is
+                // still sitting in the cross-shard queues
+                for (std::size_t s = 0; s < num_shards_; ++s)
+                    drain_queue(s);
             });
             progress.end();
 
@@ -346,6 +518,122 @@ class glove_trainer
         *gradsq += grad * grad;
     }
 
+    /**
+     * Applies the AdaGrad update for a single cooccurrence record over
+     * the two embedding rows and returns its contribution to the cost.
+     * The dot product, gradient, and accumulator updates are written as
+     * plain index loops over the raw rows (the storage is 64-byte
+     * aligned via util::aligned_vector and the rows never alias, since
+     * target and context vectors occupy distinct rows even for the same
+     * word), so compilers vectorize all three; with FMA available the
+     * whole kernel runs as fused wide operations.
+     */
+    double update_rows(uint64_t target_term, uint64_t context_term,
+                       double cooccur, std::size_t shard)
+    {
+        const auto size = vector_size_;
+        double* t = target_vector(target_term).begin();
+        double* c = context_vector(context_term).begin();
+        double* tg = target_gradsq(target_term).begin();
+        double* cg = context_gradsq(context_term).begin();
+
+        // with subword hashing, the effective target vector is the word
+        // vector plus the sum of its char n-gram bucket vectors
+        const std::vector<uint64_t>* buckets = nullptr;
+        const double* tv = t;
+        if (num_buckets_ > 0 && !word_buckets_[target_term].empty())
+        {
+            buckets = &word_buckets_[target_term];
+            static thread_local std::vector<double> composed;
+            composed.assign(t, t + size);
+            for (auto b : *buckets)
+            {
+                const double* sub = subword_weights_.data() + b * size;
+                for (std::size_t i = 0; i < size; ++i)
+                    composed[i] += sub[i];
+            }
+            tv = composed.data();
+        }
+
+        double dot = 0.0;
+        for (std::size_t i = 0; i < size; ++i)
+            dot += tv[i] * c[i];
+
+        auto diff = dot + target_bias(target_term)
+                    + context_bias(context_term) - std::log(cooccur);
+        auto weighted_diff = cost_weight(cooccur) * diff;
+        auto delta = weighted_diff * learning_rate_;
+
+        // the gradient w.r.t. the composed target vector applies to the
+        // word row and to every bucket row, each with its own AdaGrad
+        // accumulator; the buckets go first, while the context row
+        // still holds its pre-update values
+        if (buckets)
+        {
+            for (auto b : *buckets)
+            {
+                double* sub = subword_weights_.data() + b * size;
+                double* subg = subword_gradsq_.data() + b * size;
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    auto grad = delta * c[i];
+                    sub[i] -= grad / std::sqrt(subg[i]);
+                    subg[i] += grad * grad;
+                }
+            }
+        }
+
+        if (num_shards_ > 0 && shard_of(context_term) != shard)
+        {
+            // the context row belongs to another shard: apply the
+            // target side locally and ship the context gradient to the
+            // owner's queue. The deferred application adds a little
+            // gradient staleness, which SGD tolerates, in exchange for
+            // every row only ever being written by its owning thread.
+            context_update update;
+            update.term = context_term;
+            update.bias_grad = delta;
+            update.grad.resize(size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                auto target_grad = delta * c[i];
+                update.grad[i] = delta * tv[i];
+                t[i] -= target_grad / std::sqrt(tg[i]);
+                tg[i] += target_grad * target_grad;
+            }
+            update_weight(&target_bias(target_term),
+                          &target_bias_gradsq(target_term), delta);
+
+            auto& queue = *queues_[shard_of(context_term)];
+            std::lock_guard<std::mutex> lock{queue.mutex};
+            queue.updates.push_back(std::move(update));
+        }
+        else
+        {
+            // update the embedding vectors: each element reads both
+            // rows before writing either, so there are no
+            // cross-iteration dependencies
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                auto target_grad = delta * c[i];
+                auto context_grad = delta * tv[i];
+                t[i] -= target_grad / std::sqrt(tg[i]);
+                c[i] -= context_grad / std::sqrt(cg[i]);
+                tg[i] += target_grad * target_grad;
+                cg[i] += context_grad * context_grad;
+            }
+
+            // update the bias terms
+            update_weight(&target_bias(target_term),
+                          &target_bias_gradsq(target_term), delta);
+            update_weight(&context_bias(context_term),
+                          &context_bias_gradsq(context_term), delta);
+        }
+
+        // cost is weighted squared difference
+        return 0.5 * weighted_diff * diff;
+    }
+
     double train_thread(const std::string& prefix, std::size_t thread_id,
                         printing::progress& progress,
                         std::atomic_size_t& records)
@@ -355,51 +643,39 @@ class glove_trainer
         cooccur_iterator iter{prefix + "/cooccur-shuf."
                               + std::to_string(thread_id) + ".bin"};
 
+        // records are processed in small blocks ordered by target word:
+        // the file is globally shuffled for SGD, so sorting within a
+        // window this size keeps hot target rows resident in cache
+        // without meaningfully de-randomizing the update order
+        const std::size_t block_size = 1024;
+        std::vector<cooccur_record> block;
+        block.reserve(block_size);
+
         double cost = 0.0;
 
-        for (; iter != cooccur_iterator{}; ++iter)
+        while (iter != cooccur_iterator{})
         {
-            progress(records++);
-            auto record = *iter;
-
-            auto diff = score(record.target, record.context)
-                        - std::log(record.weight);
-            auto weighted_diff = cost_weight(record.weight) * diff;
-
-            // cost is weighted squared difference
-            cost += 0.5 * weighted_diff * diff;
-
-            auto delta = weighted_diff * learning_rate_;
-
-            auto target = target_vector(record.target);
-            auto targ_gradsq = target_gradsq(record.target);
-            auto context = context_vector(record.context);
-            auto ctx_gradsq = context_gradsq(record.context);
-
-            auto target_it = target.begin();
-            auto target_grad_it = targ_gradsq.begin();
-            auto context_it = context.begin();
-            auto context_grad_it = ctx_gradsq.begin();
-            auto target_end = target.end();
-
-            // update the embedding vectors
-            while (target_it != target_end)
+            block.clear();
+            for (; block.size() < block_size && iter != cooccur_iterator{};
+                 ++iter)
+                block.push_back(*iter);
+
+            std::sort(block.begin(), block.end(),
+                      [](const cooccur_record& a, const cooccur_record& b) {
+                          return a.target < b.target;
+                      });
+
+            // apply any context updates other shards have routed here
+            // before touching our own rows again
+            if (num_shards_ > 0)
+                drain_queue(thread_id);
+
+            for (const auto& record : block)
             {
-                auto target_grad = delta * *context_it;
-                auto context_grad = delta * *target_it;
-                update_weight(target_it, target_grad_it, target_grad);
-                update_weight(context_it, context_grad_it, context_grad);
-                ++target_it;
-                ++target_grad_it;
-                ++context_it;
-                ++context_grad_it;
+                progress(records++);
+                cost += update_rows(record.target, record.context,
+                                    record.weight, thread_id);
             }
-
-            // update the bias terms
-            update_weight(&target_bias(record.target),
-                          &target_bias_gradsq(record.target), delta);
-            update_weight(&context_bias(record.context),
-                          &context_bias_gradsq(record.context), delta);
         }
 
         return cost;
@@ -408,15 +684,17 @@ class glove_trainer
     void save(const std::string& prefix, uint64_t num_words,
               uint64_t num_rare) const
     {
-        // target embeddings
+        // target embeddings (composed with their subword buckets, if
+        // subword hashing was enabled)
         {
             std::ofstream output{prefix + "/embeddings.target.bin",
                                  std::ios::binary};
             printing::progress progress{" > Saving target embeddings: ",
                                         num_words};
             io::packed::write(output, vector_size_);
-            save_embeddings(output, num_words, num_rare, progress,
-                            [&](uint64_t term) { return target_vector(term); });
+            save_embeddings(
+                output, num_words, num_rare, progress,
+                [&](uint64_t term) { return composed_target(term); });
         }
 
         // context embeddings
@@ -431,6 +709,113 @@ class glove_trainer
                 output, num_words, num_rare, progress,
                 [&](uint64_t term) { return context_vector(term); });
         }
+
+        // the subword bucket table, for composing vectors for
+        // out-of-vocabulary words at lookup time. The rows are written
+        // unnormalized: lookups normalize the composed sum, matching
+        // the normalization applied to the stored word vectors.
+        if (num_buckets_ > 0)
+        {
+            std::ofstream output{prefix + "/embeddings.subword.bin",
+                                 std::ios::binary};
+            printing::progress progress{" > Saving subword embeddings: ",
+                                        num_buckets_};
+            io::packed::write(output, vector_size_);
+            io::packed::write(output, num_buckets_);
+            io::packed::write(output, min_ngram_);
+            io::packed::write(output, max_ngram_);
+            for (uint64_t b = 0; b < num_buckets_; ++b)
+            {
+                progress(b);
+                for (std::size_t i = 0; i < vector_size_; ++i)
+                    io::packed::write(output,
+                                      subword_weights_[b * vector_size_ + i]);
+            }
+        }
+    }
+
+    /**
+     * Restores the raw weights and AdaGrad accumulators saved by a
+     * previous warm-start run. Returns false (leaving the random
+     * initialization in place) when no state file exists or its shape
+     * does not match the current configuration.
+     */
+    bool load_state(const std::string& prefix, std::size_t num_words)
+    {
+        std::ifstream state{prefix + "/glove.state.bin", std::ios::binary};
+        if (!state)
+            return false;
+
+        if (io::packed::read<std::size_t>(state) != vector_size_
+            || io::packed::read<std::size_t>(state) != num_words
+            || io::packed::read<uint64_t>(state) != num_buckets_)
+        {
+            LOG(warning) << "Saved GloVe state does not match the current "
+                            "configuration; starting from scratch"
+                         << ENDLG;
+            return false;
+        }
+
+        for (auto& weight : weights_)
+            weight = io::packed::read<double>(state);
+        for (auto& gradsq : grad_squared_)
+            gradsq = io::packed::read<double>(state);
+        for (auto& weight : subword_weights_)
+            weight = io::packed::read<double>(state);
+        for (auto& gradsq : subword_gradsq_)
+            gradsq = io::packed::read<double>(state);
+
+        if (!state)
+            throw glove_exception{"glove state file ended unexpectedly"};
+        return true;
+    }
+
+    /**
+     * Saves the raw weights and AdaGrad accumulators so a later run can
+     * resume where this one left off. Written to a temporary name and
+     * renamed into place so an interrupted write never clobbers the
+     * previous state.
+     */
+    void save_state(const std::string& prefix, std::size_t num_words) const
+    {
+        auto tmp = prefix + "/glove.state.tmp";
+        {
+            std::ofstream state{tmp, std::ios::binary};
+            io::packed::write(state, vector_size_);
+            io::packed::write(state, num_words);
+            io::packed::write(state, num_buckets_);
+            for (auto weight : weights_)
+                io::packed::write(state, weight);
+            for (auto gradsq : grad_squared_)
+                io::packed::write(state, gradsq);
+            for (auto weight : subword_weights_)
+                io::packed::write(state, weight);
+            for (auto gradsq : subword_gradsq_)
+                io::packed::write(state, gradsq);
+        }
+        filesystem::delete_file(prefix + "/glove.state.bin");
+        filesystem::rename_file(tmp, prefix + "/glove.state.bin");
+    }
+
+    /**
+     * @return the target vector for the term plus the sum of its
+     * subword bucket vectors (a copy, since the composition has no
+     * contiguous backing row)
+     */
+    std::vector<double> composed_target(uint64_t term) const
+    {
+        auto tv = target_vector(term);
+        std::vector<double> out{tv.begin(), tv.end()};
+        if (num_buckets_ > 0)
+        {
+            for (auto b : word_buckets_[term])
+            {
+                const double* sub = subword_weights_.data() + b * vector_size_;
+                for (std::size_t i = 0; i < vector_size_; ++i)
+                    out[i] += sub[i];
+            }
+        }
+        return out;
     }
 
     template <class VectorFetcher>
@@ -474,6 +859,27 @@ class glove_trainer
 
     util::aligned_vector<double> weights_;
     util::aligned_vector<double> grad_squared_;
+
+    /// Hashed char n-gram bucket vectors shared across all words
+    util::aligned_vector<double> subword_weights_;
+    util::aligned_vector<double> subword_gradsq_;
+
+    /// The precomputed bucket ids for each word in the vocabulary
+    std::vector<std::vector<uint64_t>> word_buckets_;
+
+    /// The size of the subword bucket table (0 disables subwords)
+    uint64_t num_buckets_;
+
+    /// The number of word shards (0 disables word sharding)
+    std::size_t num_shards_ = 0;
+
+    /// The cross-shard context update queues, one per shard
+    std::vector<std::unique_ptr<shard_queue>> queues_;
+
+    /// The smallest and largest char n-gram lengths to extract
+    std::size_t min_ngram_;
+    std::size_t max_ngram_;
+
     std::size_t vector_size_;
     double xmax_;
     double scale_;
@@ -7,12 +7,21 @@
  * project.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "meta/embeddings/subword.h"
 #include "meta/embeddings/word_embeddings.h"
 #include "meta/io/filesystem.h"
 #include "meta/io/packed.h"
+#include "meta/math/compute_backend.h"
+#include "meta/math/dense_similarity.h"
 #include "meta/math/vector.h"
 #include "meta/util/fixed_heap.h"
 #include "meta/util/progress.h"
+#include "meta/util/shim.h"
 
 namespace meta
 {
@@ -82,6 +91,119 @@ word_embeddings::word_embeddings(std::istream& vocab, std::istream& first,
     }
 }
 
+word_embeddings::word_embeddings(std::istream& vocab,
+                                 const std::string& mmap_prefix)
+    : vector_size_{read_meta_vector_size(mmap_prefix + ".meta")},
+      id_to_term_(io::packed::read<std::size_t>(vocab)),
+      term_to_id_{static_cast<std::size_t>(std::ceil(
+          id_to_term_.size() / vocab_type::default_max_load_factor()))}
+{
+    load_vocab(vocab);
+
+    std::ifstream meta{mmap_prefix + ".meta", std::ios::binary};
+    io::packed::read<std::size_t>(meta); // vector size, already consumed
+    auto rows = io::packed::read<std::size_t>(meta);
+    if (rows != id_to_term_.size() + 1)
+        throw word_embeddings_exception{
+            "mapped embeddings do not match the vocabulary"};
+
+    if (io::packed::read<uint64_t>(meta) != 0)
+    {
+        quant_min_.resize(vector_size_);
+        quant_scale_.resize(vector_size_);
+        for (auto& min : quant_min_)
+            min = io::packed::read<double>(meta);
+        for (auto& scale : quant_scale_)
+            scale = io::packed::read<double>(meta);
+        quantized_ = make_unique<util::disk_vector<const uint8_t>>(
+            mmap_prefix + ".bin");
+    }
+    else
+    {
+        mmap_vectors_ = make_unique<util::disk_vector<const double>>(
+            mmap_prefix + ".bin");
+    }
+}
+
+std::size_t word_embeddings::read_meta_vector_size(const std::string& filename)
+{
+    std::ifstream meta{filename, std::ios::binary};
+    if (!meta)
+        throw word_embeddings_exception{"missing mapped metadata file: "
+                                        + filename};
+    return io::packed::read<std::size_t>(meta);
+}
+
+void word_embeddings::save_mmap(const std::string& mmap_prefix,
+                                bool quantize) const
+{
+    auto rows = id_to_term_.size() + 1;
+
+    std::vector<double> mins;
+    std::vector<double> scales;
+    if (quantize)
+    {
+        mins.assign(vector_size_, std::numeric_limits<double>::max());
+        std::vector<double> maxs(vector_size_,
+                                 std::numeric_limits<double>::lowest());
+        for (std::size_t tid = 0; tid < rows; ++tid)
+        {
+            auto vec = vector(tid);
+            for (std::size_t i = 0; i < vector_size_; ++i)
+            {
+                mins[i] = std::min(mins[i], vec[i]);
+                maxs[i] = std::max(maxs[i], vec[i]);
+            }
+        }
+        scales.resize(vector_size_);
+        for (std::size_t i = 0; i < vector_size_; ++i)
+            scales[i] = (maxs[i] - mins[i]) / 255.0;
+    }
+
+    {
+        std::ofstream meta{mmap_prefix + ".meta", std::ios::binary};
+        io::packed::write(meta, vector_size_);
+        io::packed::write(meta, rows);
+        io::packed::write(meta, static_cast<uint64_t>(quantize ? 1 : 0));
+        if (quantize)
+        {
+            for (auto min : mins)
+                io::packed::write(meta, min);
+            for (auto scale : scales)
+                io::packed::write(meta, scale);
+        }
+    }
+
+    if (quantize)
+    {
+        util::disk_vector<uint8_t> out{mmap_prefix + ".bin",
+                                       rows * vector_size_};
+        for (std::size_t tid = 0; tid < rows; ++tid)
+        {
+            auto vec = vector(tid);
+            for (std::size_t i = 0; i < vector_size_; ++i)
+            {
+                double code = 0;
+                if (scales[i] > 0)
+                    code = std::round((vec[i] - mins[i]) / scales[i]);
+                out[tid * vector_size_ + i] = static_cast<uint8_t>(
+                    std::max(0.0, std::min(255.0, code)));
+            }
+        }
+    }
+    else
+    {
+        util::disk_vector<double> out{mmap_prefix + ".bin",
+                                      rows * vector_size_};
+        for (std::size_t tid = 0; tid < rows; ++tid)
+        {
+            auto vec = vector(tid);
+            std::copy(vec.begin(), vec.end(),
+                      &out[tid * vector_size_]);
+        }
+    }
+}
+
 void word_embeddings::load_vocab(std::istream& vocab)
 {
     printing::progress progress{" > Loading vocab: ", id_to_term_.size()};
@@ -106,20 +228,79 @@ util::array_view<double> word_embeddings::vector(std::size_t tid)
 
 util::array_view<const double> word_embeddings::vector(std::size_t tid) const
 {
+    if (mmap_vectors_)
+        return {&(*mmap_vectors_)[tid * vector_size_], vector_size_};
+
+    if (quantized_)
+    {
+        // dequantize into a thread-local scratch row; the view is valid
+        // until the next lookup on this thread
+        static thread_local std::vector<double> scratch;
+        scratch.resize(vector_size_);
+        const uint8_t* codes = &(*quantized_)[tid * vector_size_];
+        for (std::size_t i = 0; i < vector_size_; ++i)
+            scratch[i] = quant_min_[i] + quant_scale_[i] * codes[i];
+        return {scratch.data(), vector_size_};
+    }
+
     return {embeddings_.data() + tid * vector_size_, vector_size_};
 }
 
+void word_embeddings::load_subwords(std::istream& subwords)
+{
+    if (io::packed::read<std::size_t>(subwords) != vector_size_)
+        throw word_embeddings_exception{"mismatched subword vector size"};
+
+    io::packed::read(subwords, num_subword_buckets_);
+    io::packed::read(subwords, min_ngram_);
+    io::packed::read(subwords, max_ngram_);
+
+    subword_vectors_.resize(num_subword_buckets_ * vector_size_);
+    for (auto& weight : subword_vectors_)
+        weight = io::packed::read<double>(subwords);
+
+    if (!subwords)
+        throw word_embeddings_exception{
+            "subword stream ended unexpectedly"};
+}
+
 embedding word_embeddings::at(util::string_view term) const
 {
-    std::size_t tid;
     auto v_it = term_to_id_.find(term);
-    if (v_it == term_to_id_.end())
-    {
-        tid = id_to_term_.size();
-    }
-    else
+    if (v_it != term_to_id_.end())
+        return {v_it->value(), vector(v_it->value())};
+
+    auto tid = id_to_term_.size();
+    if (num_subword_buckets_ > 0)
     {
-        tid = v_it->value();
+        auto buckets
+            = subword_buckets(term, num_subword_buckets_, min_ngram_,
+                              max_ngram_);
+        if (!buckets.empty())
+        {
+            // compose the OOV vector from its n-gram buckets into a
+            // thread-local row and normalize it to match the stored
+            // vectors; the view is valid until the next lookup on this
+            // thread
+            static thread_local std::vector<double> scratch;
+            scratch.assign(vector_size_, 0.0);
+            for (auto b : buckets)
+            {
+                const double* sub
+                    = subword_vectors_.data() + b * vector_size_;
+                for (std::size_t i = 0; i < vector_size_; ++i)
+                    scratch[i] += sub[i];
+            }
+
+            auto len = std::sqrt(std::inner_product(
+                scratch.begin(), scratch.end(), scratch.begin(), 0.0));
+            if (len > 0)
+            {
+                for (auto& weight : scratch)
+                    weight /= len;
+            }
+            return {tid, {scratch.data(), vector_size_}};
+        }
     }
     return {tid, vector(tid)};
 }
@@ -131,27 +312,298 @@ util::string_view word_embeddings::term(std::size_t tid) const
     return id_to_term_[tid];
 }
 
+namespace
+{
+struct by_score
+{
+    bool operator()(const scored_embedding& a, const scored_embedding& b) const
+    {
+        return a.score > b.score;
+    }
+};
+}
+
+const double* word_embeddings::raw_row(std::size_t tid) const
+{
+    if (mmap_vectors_)
+        return &(*mmap_vectors_)[tid * vector_size_];
+    if (quantized_)
+        return nullptr;
+    return embeddings_.data() + tid * vector_size_;
+}
+
+std::vector<scored_embedding>
+word_embeddings::scan_top_k(util::array_view<const double> query,
+                            std::size_t k,
+                            const std::vector<std::size_t>* candidates) const
+{
+    util::fixed_heap<scored_embedding, by_score> results{k, by_score{}};
+
+    // +1 for <unk>
+    auto num = candidates ? candidates->size() : id_to_term_.size() + 1;
+
+    if (quantized_)
+    {
+        // score directly against the codes: q . v factors into a fixed
+        // offset q . min plus a per-dimension scaled integer dot, so no
+        // row is ever dequantized during the scan
+        auto base = std::inner_product(query.begin(), query.end(),
+                                       quant_min_.begin(), 0.0);
+        std::vector<double> scaled(vector_size_);
+        for (std::size_t i = 0; i < vector_size_; ++i)
+            scaled[i] = query[i] * quant_scale_[i];
+
+        for (std::size_t idx = 0; idx < num; ++idx)
+        {
+            auto tid = candidates ? (*candidates)[idx] : idx;
+            const uint8_t* codes = &(*quantized_)[tid * vector_size_];
+            double score = base;
+            for (std::size_t i = 0; i < vector_size_; ++i)
+                score += scaled[i] * codes[i];
+
+            embedding e{tid, {nullptr, nullptr}};
+            results.push({e, score});
+        }
+
+        // dequantize just the winners into a thread-local arena so the
+        // returned views outlive the call
+        auto top = results.extract_top();
+        static thread_local std::vector<double> arena;
+        arena.resize(top.size() * vector_size_);
+        for (std::size_t i = 0; i < top.size(); ++i)
+        {
+            const uint8_t* codes = &(*quantized_)[top[i].e.tid * vector_size_];
+            double* out = arena.data() + i * vector_size_;
+            for (std::size_t j = 0; j < vector_size_; ++j)
+                out[j] = quant_min_[j] + quant_scale_[j] * codes[j];
+            top[i].e.v = {out, vector_size_};
+        }
+        return top;
+    }
+
+    const double* q = query.begin();
+    if (!candidates)
+    {
+        // a full scan walks contiguous rows, so hand the compute
+        // backend whole blocks of the matrix at a time and only push
+        // the returned scores
+        const auto& backend = math::compute_backend::instance();
+        constexpr std::size_t block_rows = 4096;
+        std::vector<double> scores(block_rows);
+        for (std::size_t start = 0; start < num; start += block_rows)
+        {
+            auto rows = std::min(block_rows, num - start);
+            backend.dot_products(raw_row(start), rows, vector_size_, q,
+                                 scores.data());
+            for (std::size_t r = 0; r < rows; ++r)
+            {
+                auto tid = start + r;
+                embedding e{tid, {raw_row(tid), vector_size_}};
+                results.push({e, scores[r]});
+            }
+        }
+        return results.extract_top();
+    }
+
+    // scattered candidate rows run the shared dense kernel one row at
+    // a time
+    for (std::size_t idx = 0; idx < num; ++idx)
+    {
+        auto tid = (*candidates)[idx];
+        const double* row = raw_row(tid);
+        auto score = math::dense::dot(q, row, vector_size_);
+
+        embedding e{tid, {row, vector_size_}};
+        results.push({e, score});
+    }
+
+    return results.extract_top();
+}
+
 std::vector<scored_embedding>
 word_embeddings::top_k(util::array_view<const double> query,
                        std::size_t k) const
 {
-    auto results = util::make_fixed_heap<scored_embedding>(
-        k, [](const scored_embedding& a, const scored_embedding& b) {
-            return a.score > b.score;
-        });
+    return scan_top_k(query, k, nullptr);
+}
+
+std::vector<std::vector<scored_embedding>> word_embeddings::top_k(
+    const std::vector<util::array_view<const double>>& queries,
+    std::size_t k) const
+{
+    std::vector<std::vector<scored_embedding>> all;
+    all.reserve(queries.size());
 
+    if (quantized_)
+    {
+        for (const auto& query : queries)
+            all.push_back(scan_top_k(query, k, nullptr));
+
+        // each scan decoded its winners into the shared per-thread
+        // arena, so re-decode every winner into one batch arena to keep
+        // the earlier queries' views from dangling
+        static thread_local std::vector<double> arena;
+        std::size_t total = 0;
+        for (const auto& result : all)
+            total += result.size();
+        arena.resize(total * vector_size_);
+        std::size_t row = 0;
+        for (auto& result : all)
+        {
+            for (auto& scored : result)
+            {
+                const uint8_t* codes
+                    = &(*quantized_)[scored.e.tid * vector_size_];
+                double* out = arena.data() + row * vector_size_;
+                for (std::size_t j = 0; j < vector_size_; ++j)
+                    out[j] = quant_min_[j] + quant_scale_[j] * codes[j];
+                scored.e.v = {out, vector_size_};
+                ++row;
+            }
+        }
+        return all;
+    }
+
+    std::vector<util::fixed_heap<scored_embedding, by_score>> heaps;
+    heaps.reserve(queries.size());
+    for (std::size_t qi = 0; qi < queries.size(); ++qi)
+        heaps.emplace_back(k, by_score{});
+
+    // one pass over the matrix: each row is scored against every query
+    // while it is still in cache
     // +1 for <unk>
     for (std::size_t tid = 0; tid < id_to_term_.size() + 1; ++tid)
     {
-        auto vec = vector(tid);
-        auto score
-            = std::inner_product(query.begin(), query.end(), vec.begin(), 0.0);
+        const double* row = raw_row(tid);
+        for (std::size_t qi = 0; qi < queries.size(); ++qi)
+        {
+            auto score
+                = math::dense::dot(queries[qi].begin(), row, vector_size_);
 
-        embedding e{tid, vec};
-        results.push({e, score});
+            heaps[qi].push({embedding{tid, {row, vector_size_}}, score});
+        }
     }
 
-    return results.extract_top();
+    for (auto& heap : heaps)
+        all.push_back(heap.extract_top());
+    return all;
+}
+
+void word_embeddings::build_clusters(std::size_t num_clusters,
+                                     std::size_t kmeans_iters)
+{
+    auto rows = id_to_term_.size() + 1;
+    num_clusters = std::max<std::size_t>(1, std::min(num_clusters, rows));
+
+    auto normalize = [&](std::size_t c) {
+        double* cen = centroids_.data() + c * vector_size_;
+        double norm = 0.0;
+        for (std::size_t i = 0; i < vector_size_; ++i)
+            norm += cen[i] * cen[i];
+        norm = std::sqrt(norm);
+        if (norm > 0)
+        {
+            for (std::size_t i = 0; i < vector_size_; ++i)
+                cen[i] /= norm;
+        }
+    };
+
+    // seed the centroids with evenly spaced rows
+    centroids_.assign(num_clusters * vector_size_, 0.0);
+    for (std::size_t c = 0; c < num_clusters; ++c)
+    {
+        auto vec = vector(c * rows / num_clusters);
+        std::copy(vec.begin(), vec.end(),
+                  centroids_.data() + c * vector_size_);
+        normalize(c);
+    }
+
+    for (std::size_t iter = 0; iter < kmeans_iters; ++iter)
+    {
+        cluster_members_.assign(num_clusters, {});
+        for (std::size_t tid = 0; tid < rows; ++tid)
+        {
+            auto vec = vector(tid);
+            std::size_t best = 0;
+            double best_score = std::numeric_limits<double>::lowest();
+            for (std::size_t c = 0; c < num_clusters; ++c)
+            {
+                const double* cen = centroids_.data() + c * vector_size_;
+                auto score
+                    = math::dense::dot(cen, vec.begin(), vector_size_);
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best = c;
+                }
+            }
+            cluster_members_[best].push_back(tid);
+        }
+
+        if (iter + 1 == kmeans_iters)
+            break;
+
+        // recompute each centroid as the renormalized mean of its
+        // members; empty clusters keep their previous centroid
+        for (std::size_t c = 0; c < num_clusters; ++c)
+        {
+            if (cluster_members_[c].empty())
+                continue;
+
+            double* cen = centroids_.data() + c * vector_size_;
+            std::fill(cen, cen + vector_size_, 0.0);
+            for (auto tid : cluster_members_[c])
+            {
+                auto vec = vector(tid);
+                for (std::size_t i = 0; i < vector_size_; ++i)
+                    cen[i] += vec[i];
+            }
+            normalize(c);
+        }
+    }
+}
+
+std::vector<scored_embedding>
+word_embeddings::top_k_approx(util::array_view<const double> query,
+                              std::size_t k, std::size_t nprobe) const
+{
+    if (cluster_members_.empty())
+        return scan_top_k(query, k, nullptr);
+
+    auto num_clusters = cluster_members_.size();
+    nprobe = std::max<std::size_t>(1, std::min(nprobe, num_clusters));
+
+    // rank the coarse centroids against the query
+    std::vector<std::pair<double, std::size_t>> ranked(num_clusters);
+    for (std::size_t c = 0; c < num_clusters; ++c)
+    {
+        const double* cen = centroids_.data() + c * vector_size_;
+        double score = 0.0;
+        for (std::size_t i = 0; i < vector_size_; ++i)
+            score += query[i] * cen[i];
+        ranked[c] = {score, c};
+    }
+    std::partial_sort(ranked.begin(),
+                      ranked.begin() + static_cast<std::ptrdiff_t>(nprobe),
+                      ranked.end(),
+                      [](const std::pair<double, std::size_t>& a,
+                         const std::pair<double, std::size_t>& b) {
+                          return a.first > b.first;
+                      });
+
+    std::size_t total = 0;
+    for (std::size_t p = 0; p < nprobe; ++p)
+        total += cluster_members_[ranked[p].second].size();
+
+    std::vector<std::size_t> candidates;
+    candidates.reserve(total);
+    for (std::size_t p = 0; p < nprobe; ++p)
+    {
+        const auto& members = cluster_members_[ranked[p].second];
+        candidates.insert(candidates.end(), members.begin(), members.end());
+    }
+
+    return scan_top_k(query, k, &candidates);
 }
 
 std::size_t word_embeddings::vector_size() const
@@ -159,35 +611,33 @@ std::size_t word_embeddings::vector_size() const
     return vector_size_;
 }
 
-word_embeddings load_embeddings(const cpptoml::table& config)
+std::size_t word_embeddings::vocab_size() const
 {
-    auto prefix = config.get_as<std::string>("prefix");
-    if (!prefix)
-        throw word_embeddings_exception{
-            "missing prefix key in configuration file"};
-
-    if (!filesystem::exists(*prefix))
-        throw word_embeddings_exception{"embeddings directory does not exist: "
-                                        + *prefix};
+    return id_to_term_.size();
+}
 
-    std::ifstream vocab{*prefix + "/vocab.bin", std::ios::binary};
+namespace
+{
+word_embeddings load_packed_embeddings(const std::string& prefix,
+                                       const std::string& mode)
+{
+    std::ifstream vocab{prefix + "/vocab.bin", std::ios::binary};
     if (!vocab)
         throw word_embeddings_exception{"missing vocabulary file in: "
-                                        + *prefix};
+                                        + prefix};
 
-    std::ifstream target{*prefix + "/embeddings.target.bin", std::ios::binary};
-    std::ifstream context{*prefix + "/embeddings.context.bin",
+    std::ifstream target{prefix + "/embeddings.target.bin", std::ios::binary};
+    std::ifstream context{prefix + "/embeddings.context.bin",
                           std::ios::binary};
 
-    auto mode = config.get_as<std::string>("mode").value_or("average");
     if (mode == "average")
     {
         if (!target)
             throw word_embeddings_exception{"missing target vectors in: "
-                                            + *prefix};
+                                            + prefix};
         if (!context)
             throw word_embeddings_exception{"missing context vectors in: "
-                                            + *prefix};
+                                            + prefix};
 
         return {vocab, target, context};
     }
@@ -195,7 +645,7 @@ word_embeddings load_embeddings(const cpptoml::table& config)
     {
         if (!target)
             throw word_embeddings_exception{"missing target vectors in: "
-                                            + *prefix};
+                                            + prefix};
 
         return {vocab, target};
     }
@@ -203,7 +653,7 @@ word_embeddings load_embeddings(const cpptoml::table& config)
     {
         if (!context)
             throw word_embeddings_exception{"missing context vectors in: "
-                                            + *prefix};
+                                            + prefix};
 
         return {vocab, context};
     }
@@ -212,5 +662,56 @@ word_embeddings load_embeddings(const cpptoml::table& config)
         throw word_embeddings_exception{"invalid mode key in configuration"};
     }
 }
+
+void attach_subwords(word_embeddings& embeddings, const std::string& prefix)
+{
+    std::ifstream subwords{prefix + "/embeddings.subword.bin",
+                           std::ios::binary};
+    if (subwords)
+        embeddings.load_subwords(subwords);
+}
+}
+
+word_embeddings load_embeddings(const cpptoml::table& config)
+{
+    auto prefix = config.get_as<std::string>("prefix");
+    if (!prefix)
+        throw word_embeddings_exception{
+            "missing prefix key in configuration file"};
+
+    if (!filesystem::exists(*prefix))
+        throw word_embeddings_exception{"embeddings directory does not exist: "
+                                        + *prefix};
+
+    auto mode = config.get_as<std::string>("mode").value_or("average");
+    auto format = config.get_as<std::string>("format").value_or("binary");
+
+    if (format == "binary")
+    {
+        auto embeddings = load_packed_embeddings(*prefix, mode);
+        attach_subwords(embeddings, *prefix);
+        return embeddings;
+    }
+
+    if (format != "mmap")
+        throw word_embeddings_exception{"invalid format key in configuration"};
+
+    auto quantize = config.get_as<bool>("quantize").value_or(false);
+    auto mmap_prefix
+        = *prefix + "/embeddings." + mode + (quantize ? ".q8" : ".f64");
+
+    // one-time conversion from the packed format; afterwards startup
+    // only reads the vocabulary and maps the vectors
+    if (!filesystem::file_exists(mmap_prefix + ".meta"))
+        load_packed_embeddings(*prefix, mode).save_mmap(mmap_prefix, quantize);
+
+    std::ifstream vocab{*prefix + "/vocab.bin", std::ios::binary};
+    if (!vocab)
+        throw word_embeddings_exception{"missing vocabulary file in: "
+                                        + *prefix};
+    word_embeddings embeddings{vocab, mmap_prefix};
+    attach_subwords(embeddings, *prefix);
+    return embeddings;
+}
 }
 }
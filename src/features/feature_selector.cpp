@@ -7,6 +7,8 @@
 #include "meta/features/feature_selector.h"
 #include "meta/io/packed.h"
 #include "meta/parallel/parallel_for.h"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 
@@ -30,51 +32,85 @@ feature_selector::feature_selector(const std::string& prefix,
 void feature_selector::score_all()
 {
     using pair_t = std::pair<term_id, double>;
-    using pair_c = std::pair<uint64_t, std::vector<pair_t>>;
 
-    std::vector<pair_c> scores;
-    std::vector<class_label> labels(total_labels_);
+    std::vector<term_id> terms;
+    terms.reserve(total_features_);
+    term_prob_.each_seen_event(
+        [&](const term_id& tid) { terms.push_back(tid); });
 
-    uint64_t lbl_id = 0;
-    uint64_t num_processed = 0;
+    std::vector<class_label> labels;
+    labels.reserve(total_labels_);
+    class_prob_.each_seen_event(
+        [&](const class_label& lbl) { labels.push_back(lbl); });
 
-    printing::progress prog{" > Calculating feature scores: ", total_features_};
+    printing::progress prog{" > Calculating feature scores: ",
+                            labels.size() * terms.size()};
+    std::atomic<uint64_t> num_processed{0};
 
-    class_prob_.each_seen_event([&](const class_label& lbl) {
-        std::vector<pair_t> class_scores;
-
-        term_prob_.each_seen_event([&](const term_id& tid) {
-            class_scores.push_back(std::make_pair(tid, score(lbl, tid)));
-
-            prog(++num_processed);
-        });
-
-        scores.push_back(std::make_pair(lbl_id, class_scores));
-
-        // map lbl_id to lbl
-        labels[lbl_id++] = lbl;
-    });
-
-    prog.end();
-
-    parallel::parallel_for(scores.begin(), scores.end(), [&](pair_c& c_scores) {
-        std::sort(c_scores.second.begin(), c_scores.second.end(),
-                  [](const pair_t& a, const pair_t& b) {
-                      return a.second > b.second;
-                  });
-
-        std::ofstream out{prefix_ + "/" + std::to_string(c_scores.first + 1)
-                              + ".bin",
+    parallel::thread_pool pool;
+    std::vector<pair_t> class_scores(terms.size());
+    for (uint64_t lbl_id = 0; lbl_id < labels.size(); ++lbl_id)
+    {
+        // score the term space in parallel; each term's score is
+        // independent, so threads write disjoint slots
+        for (std::size_t i = 0; i < terms.size(); ++i)
+            class_scores[i].first = terms[i];
+
+        parallel::parallel_for(class_scores.begin(), class_scores.end(), pool,
+                               [&](pair_t& term_score) {
+                                   term_score.second
+                                       = score(labels[lbl_id],
+                                               term_score.first);
+                                   prog(++num_processed);
+                               });
+
+        // sort per-thread-sized chunks in parallel, then stream a
+        // multiway merge of the sorted runs straight to disk instead of
+        // one giant sort
+        auto comp = [](const pair_t& a, const pair_t& b) {
+            return a.second > b.second;
+        };
+
+        using iterator = std::vector<pair_t>::iterator;
+        std::vector<std::pair<iterator, iterator>> runs;
+        auto futures = parallel::for_each_block(
+            class_scores.begin(), class_scores.end(), pool,
+            [&](iterator begin, iterator end) {
+                std::sort(begin, end, comp);
+                return std::make_pair(begin, end);
+            });
+        for (auto& fut : futures)
+            runs.push_back(fut.get());
+
+        std::ofstream out{prefix_ + "/" + std::to_string(lbl_id + 1) + ".bin",
                           std::ios::binary};
-
-        io::packed::write(out, labels[c_scores.first]);
-
-        for (auto& score : c_scores.second)
+        io::packed::write(out, labels[lbl_id]);
+
+        auto heap_comp = [&](const std::pair<iterator, iterator>& a,
+                             const std::pair<iterator, iterator>& b) {
+            // max-heap on the head of each run
+            return comp(*b.first, *a.first);
+        };
+        runs.erase(std::remove_if(runs.begin(), runs.end(),
+                                  [](const std::pair<iterator, iterator>& run) {
+                                      return run.first == run.second;
+                                  }),
+                   runs.end());
+        std::make_heap(runs.begin(), runs.end(), heap_comp);
+        while (!runs.empty())
         {
-            io::packed::write(out, score.first);
-            io::packed::write(out, score.second);
+            std::pop_heap(runs.begin(), runs.end(), heap_comp);
+            auto& run = runs.back();
+            io::packed::write(out, run.first->first);
+            io::packed::write(out, run.first->second);
+            if (++run.first == run.second)
+                runs.pop_back();
+            else
+                std::push_heap(runs.begin(), runs.end(), heap_comp);
         }
-    });
+    }
+
+    prog.end();
 }
 
 void feature_selector::select(uint64_t features_per_class /* = 20 */)
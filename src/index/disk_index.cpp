@@ -32,8 +32,14 @@ std::string disk_index::index_name() const
     return impl_->index_name_;
 }
 
+void disk_index::warm_up() const
+{
+    impl_->warm_up();
+}
+
 term_id disk_index::get_term_id(const std::string& term)
 {
+    impl_->ensure_term_id_mapping();
     std::lock_guard<std::mutex> lock{impl_->mutex_};
 
     auto termID = impl_->term_id_mapping_->find(term);
@@ -44,13 +50,30 @@ term_id disk_index::get_term_id(const std::string& term)
     return term_id{size};
 }
 
+std::vector<term_id>
+disk_index::get_term_ids(const std::vector<std::string>& terms)
+{
+    impl_->ensure_term_id_mapping();
+    std::lock_guard<std::mutex> lock{impl_->mutex_};
+
+    auto found = impl_->term_id_mapping_->find_batch(terms);
+
+    term_id oov{impl_->term_id_mapping_->size()};
+    std::vector<term_id> ids;
+    ids.reserve(found.size());
+    for (const auto& t_id : found)
+        ids.push_back(t_id ? *t_id : oov);
+    return ids;
+}
+
 class_label disk_index::label(doc_id d_id) const
 {
-    return class_label_from_id(impl_->labels_->at(d_id));
+    return class_label_from_id(lbl_id(d_id));
 }
 
 label_id disk_index::lbl_id(doc_id d_id) const
 {
+    impl_->ensure_labels();
     return impl_->labels_->at(d_id);
 }
 
@@ -80,26 +103,31 @@ std::vector<class_label> disk_index::class_labels() const
 
 corpus::metadata disk_index::metadata(doc_id d_id) const
 {
+    impl_->ensure_metadata();
     return impl_->metadata_->get(d_id);
 }
 
 uint64_t disk_index::unique_terms(doc_id d_id) const
 {
-    return *metadata(d_id).get<uint64_t>("unique-terms");
+    impl_->ensure_metadata();
+    return impl_->metadata_->unique_terms(d_id);
 }
 
 uint64_t disk_index::unique_terms() const
 {
+    impl_->ensure_term_id_mapping();
     return impl_->term_id_mapping_->size();
 }
 
 uint64_t disk_index::doc_size(doc_id d_id) const
 {
-    return *metadata(d_id).get<uint64_t>("length");
+    impl_->ensure_metadata();
+    return impl_->metadata_->doc_size(d_id);
 }
 
 uint64_t disk_index::num_docs() const
 {
+    impl_->ensure_metadata();
     return impl_->metadata_->size();
 }
 
@@ -111,6 +139,7 @@ std::string disk_index::doc_name(doc_id d_id) const
 
 std::string disk_index::doc_path(doc_id d_id) const
 {
+    impl_->ensure_metadata();
     if (auto path = impl_->metadata_->get(d_id).get<std::string>("path"))
         return *path;
     return "[none]";
@@ -128,7 +157,8 @@ std::vector<doc_id> disk_index::docs() const
 const std::vector<const char*> disk_index::disk_index_impl::files
     = {"/docs.labels",          "/labelids.mapping", "/postings.index",
        "/postings.index_index", "/termids.mapping",  "/termids.mapping.inverse",
-       "/metadata.db",          "/metadata.index"};
+       "/metadata.db",          "/metadata.index",   "/metadata.lengths",
+       "/metadata.unique-terms"};
 
 label_id disk_index::disk_index_impl::get_label_id(const class_label& lbl)
 {
@@ -144,22 +174,53 @@ label_id disk_index::disk_index_impl::get_label_id(const class_label& lbl)
         return label_ids_.get_value(lbl);
 }
 
-void disk_index::disk_index_impl::initialize_metadata()
+void disk_index::disk_index_impl::initialize_metadata() const
 {
     metadata_ = {index_name_};
 }
 
-void disk_index::disk_index_impl::load_labels()
+void disk_index::disk_index_impl::load_labels() const
 {
     labels_
         = util::disk_vector<const label_id>{index_name_ + files[DOC_LABELS]};
 }
 
-void disk_index::disk_index_impl::load_term_id_mapping()
+void disk_index::disk_index_impl::load_term_id_mapping() const
 {
     term_id_mapping_ = vocabulary_map{index_name_ + files[TERM_IDS_MAPPING]};
 }
 
+void disk_index::disk_index_impl::ensure_metadata() const
+{
+    std::call_once(metadata_init_, [this]() {
+        if (!metadata_)
+            initialize_metadata();
+    });
+}
+
+void disk_index::disk_index_impl::ensure_labels() const
+{
+    std::call_once(labels_init_, [this]() {
+        if (!labels_)
+            load_labels();
+    });
+}
+
+void disk_index::disk_index_impl::ensure_term_id_mapping() const
+{
+    std::call_once(term_id_init_, [this]() {
+        if (!term_id_mapping_)
+            load_term_id_mapping();
+    });
+}
+
+void disk_index::disk_index_impl::warm_up() const
+{
+    ensure_metadata();
+    ensure_term_id_mapping();
+    ensure_labels();
+}
+
 void disk_index::disk_index_impl::load_label_id_mapping()
 {
     map::load_mapping(label_ids_, index_name_ + files[LABEL_IDS_MAPPING]);
@@ -172,11 +233,13 @@ void disk_index::disk_index_impl::save_label_id_mapping()
 
 uint64_t disk_index::disk_index_impl::total_unique_terms() const
 {
+    ensure_term_id_mapping();
     return term_id_mapping_->size();
 }
 
 label_id disk_index::disk_index_impl::doc_label_id(doc_id id) const
 {
+    ensure_labels();
     return labels_->at(id);
 }
 
@@ -191,6 +254,7 @@ std::vector<class_label> disk_index::disk_index_impl::class_labels() const
 
 std::string disk_index::term_text(term_id t_id) const
 {
+    impl_->ensure_term_id_mapping();
     if (t_id >= impl_->term_id_mapping_->size())
         return "";
     return impl_->term_id_mapping_->find_term(t_id);
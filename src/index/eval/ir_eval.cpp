@@ -161,13 +161,18 @@ double ir_eval::ndcg(const std::vector<search_result>& results, query_id q_id,
 
 double ir_eval::avg_p(const std::vector<search_result>& results, query_id q_id,
                       uint64_t num_docs)
+{
+    auto avgp = avg_p_value(results, q_id, num_docs);
+    scores_.push_back(avgp);
+    return avgp;
+}
+
+double ir_eval::avg_p_value(const std::vector<search_result>& results,
+                            query_id q_id, uint64_t num_docs) const
 {
     const auto& ht = qrels_.find(q_id);
     if (ht == qrels_.end() || results.empty())
-    {
-        scores_.push_back(0.0);
         return 0.0;
-    }
 
     // the total number of *possible* relevant documents given the num_docs
     // cutoff point
@@ -188,7 +193,6 @@ double ir_eval::avg_p(const std::vector<search_result>& results, query_id q_id,
             break;
     }
 
-    scores_.push_back(avgp / total_relevant);
     return avgp / total_relevant;
 }
 
@@ -240,5 +244,83 @@ void ir_eval::reset_stats()
 {
     scores_.clear();
 }
+
+ir_eval::batch_results
+ir_eval::judge_batch(const std::vector<result_type>& rankings,
+                     query_id first_query,
+                     const std::vector<std::chrono::microseconds>& latencies,
+                     uint64_t num_docs, parallel::thread_pool& pool) const
+{
+    batch_results batch;
+    batch.queries.resize(rankings.size());
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(rankings.size());
+    for (std::size_t pos = 0; pos < rankings.size(); ++pos)
+    {
+        futures.emplace_back(pool.submit_task([&, pos]() {
+            auto qid = query_id{static_cast<uint64_t>(first_query) + pos};
+            auto& stats = batch.queries[pos];
+            stats.qid = qid;
+            stats.avg_p = avg_p_value(rankings[pos], qid, num_docs);
+            stats.ndcg = ndcg(rankings[pos], qid, num_docs);
+            stats.f1 = f1(rankings[pos], qid, num_docs);
+            stats.latency = pos < latencies.size()
+                                ? latencies[pos]
+                                : std::chrono::microseconds{0};
+        }));
+    }
+    for (auto& fut : futures)
+        fut.get();
+
+    finalize_batch(batch);
+    return batch;
+}
+
+void ir_eval::finalize_batch(batch_results& batch) const
+{
+    batch.map = 0.0;
+    batch.gmap = 0.0;
+    batch.avg_ndcg = 0.0;
+    if (batch.queries.empty())
+        return;
+
+    double log_sum = 0.0;
+    bool zero_score = false;
+    for (const auto& stats : batch.queries)
+    {
+        batch.map += stats.avg_p;
+        batch.avg_ndcg += stats.ndcg;
+        if (stats.avg_p <= 0.0)
+            zero_score = true;
+        else
+            log_sum += std::log(stats.avg_p);
+    }
+
+    batch.map /= batch.queries.size();
+    batch.avg_ndcg /= batch.queries.size();
+    if (!zero_score)
+        batch.gmap = std::exp(log_sum / batch.queries.size());
+}
+
+std::chrono::microseconds
+ir_eval::batch_results::latency_percentile(double pct) const
+{
+    if (queries.empty())
+        return std::chrono::microseconds{0};
+
+    std::vector<std::chrono::microseconds> latencies;
+    latencies.reserve(queries.size());
+    for (const auto& stats : queries)
+        latencies.push_back(stats.latency);
+    std::sort(latencies.begin(), latencies.end());
+
+    // nearest-rank percentile
+    auto rank = static_cast<std::size_t>(
+        std::ceil(pct / 100.0 * latencies.size()));
+    if (rank > 0)
+        --rank;
+    return latencies[std::min(rank, latencies.size() - 1)];
+}
 }
 }
@@ -5,6 +5,7 @@
 
 #include "meta/analyzers/analyzer.h"
 #include "meta/corpus/libsvm_corpus.h"
+#include "meta/features/feature_remap.h"
 #include "meta/hashing/probe_map.h"
 #include "meta/index/chunk_reader.h"
 #include "meta/index/disk_index_impl.h"
@@ -17,8 +18,10 @@
 #include "meta/index/vocabulary_map_writer.h"
 #include "meta/io/libsvm_parser.h"
 #include "meta/logging/logger.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/util/pimpl.tcc"
 #include "meta/util/printing.h"
+#include "meta/util/shim.h"
 
 namespace meta
 {
@@ -39,10 +42,13 @@ class forward_index::impl
     /**
      * Tokenizes the documents in the corpus in parallel, yielding
      * num_threads number of forward_index chunks that then need to be
-     * merged.
+     * merged. If an inverter is given, each document's analyzed counts
+     * are also fed to it so that a sibling inverted index can be built
+     * from the same analysis pass.
      */
     void tokenize_docs(corpus::corpus& corpus, metadata_writer& mdata_writer,
-                       uint64_t ram_budget, std::size_t num_threads);
+                       uint64_t ram_budget, std::size_t num_threads,
+                       postings_inverter<inverted_index>* inverter = nullptr);
 
     /**
      * Merges together num_chunks number of intermediate chunks, using the
@@ -61,12 +67,29 @@ class forward_index::impl
      */
     void create_libsvm_postings(corpus::corpus& docs);
 
+    /**
+     * Finishes a co-built inverted index: merges and compresses the
+     * chunks produced during the shared analysis pass and copies over
+     * the metadata, labels and label id mapping, which are identical
+     * for both indexes.
+     *
+     * @param inverter The postings inverter fed during tokenization
+     * @param inv_name The directory of the inverted index being built
+     */
+    void finish_co_built_inverted(postings_inverter<inverted_index>& inverter,
+                                  const std::string& inv_name);
+
     /**
      * @param inv_idx The inverted index to uninvert
      * @param ram_budget The **estimated** allowed size of an in-memory
      * chunk
+     * @param remap An optional feature selection remap: unselected
+     * terms are dropped and the survivors renumbered to the dense
+     * selected-feature id space while uninverting, so pruned features
+     * are never materialized in the forward postings
      */
-    void uninvert(const inverted_index& inv_idx, uint64_t ram_budget);
+    void uninvert(const inverted_index& inv_idx, uint64_t ram_budget,
+                  const features::feature_remap* remap = nullptr);
 
     /**
      * @param name The name of the inverted index to copy data from
@@ -80,13 +103,6 @@ class forward_index::impl
      */
     bool is_libsvm_analyzer(const cpptoml::table& config) const;
 
-    /**
-     * Compresses the postings file created by uninverting.
-     * @param filename The file to compress
-     * @param num_docs The number of documents in that file
-     */
-    void compress(const std::string& filename, uint64_t num_docs);
-
     /**
      * Loads the postings file.
      * @param filename The path to the postings file to load
@@ -227,10 +243,32 @@ void forward_index::create_index(const cpptoml::table& config,
             }
             auto inv_idx = make_index<inverted_index>(config);
 
+            // an optional feature selection remap (the prefix of a
+            // feature_selector's artifacts) is applied inline while
+            // uninverting so pruned features never reach the postings
+            std::unique_ptr<features::feature_remap> remap;
+            if (auto remap_prefix = config.get_as<std::string>("feature-remap"))
+                remap = make_unique<features::feature_remap>(*remap_prefix);
+
             fwd_impl_->create_uninverted_metadata(inv_idx->index_name());
             impl_->load_labels();
             // RAM budget is given in MB
-            fwd_impl_->uninvert(*inv_idx, ram_budget * 1024 * 1024);
+            fwd_impl_->uninvert(*inv_idx, ram_budget * 1024 * 1024,
+                                remap.get());
+
+            if (remap)
+            {
+                // replace the copied vocabulary with just the selected
+                // terms; their old ids are increasing, and the inverted
+                // vocabulary is sorted, so walking the dense new ids
+                // yields the lexicographic order the writer requires
+                vocabulary_map_writer writer{
+                    index_name() + "/" + impl_->files[TERM_IDS_MAPPING]};
+                for (uint64_t f = 0; f < remap->total_selected(); ++f)
+                    writer.insert(inv_idx->term_text(
+                        remap->old_id(learn::feature_id{f})));
+            }
+
             impl_->load_term_id_mapping();
             fwd_impl_->total_unique_terms_ = impl_->total_unique_terms();
         }
@@ -238,9 +276,6 @@ void forward_index::create_index(const cpptoml::table& config,
         {
             LOG(info) << "Creating forward index: " << index_name() << ENDLG;
 
-            metadata_writer mdata_writer{index_name(), docs.size(),
-                                         docs.schema()};
-
             auto max_threads = std::thread::hardware_concurrency();
             auto num_threads = config.get_as<std::size_t>("indexer-num-threads")
                                    .value_or(max_threads);
@@ -252,13 +287,52 @@ void forward_index::create_index(const cpptoml::table& config,
                              << max_threads << ENDLG;
             }
 
-            // RAM budget is given in MB
-            fwd_impl_->tokenize_docs(docs, mdata_writer,
-                                     ram_budget * 1024 * 1024, num_threads);
+            // in co-build mode, the sibling inverted index is created
+            // from the same analysis pass instead of tokenizing the
+            // corpus a second time
+            auto co_build = config.get_as<bool>("co-build").value_or(false);
+            std::string inv_name;
+            std::unique_ptr<postings_inverter<inverted_index>> inverter;
+            if (co_build)
+            {
+                inv_name = *config.get_as<std::string>("index") + "/inv";
+                LOG(info) << "Co-building inverted index: " << inv_name
+                          << ENDLG;
+
+                filesystem::remove_all(inv_name);
+                if (!filesystem::make_directories(inv_name))
+                    throw exception{"Unable to create index directory: "
+                                    + inv_name};
+                {
+                    std::ofstream config_file{inv_name + "/config.toml"};
+                    config_file << config;
+                }
+
+                auto max_writers = config.get_as<unsigned>("indexer-max-writers")
+                                       .value_or(8);
+                inverter = make_unique<postings_inverter<inverted_index>>(
+                    inv_name, max_writers);
+                inverter->ram_budget(ram_budget * 1024 * 1024);
+                inverter->compress_chunks(
+                    config.get_as<bool>("compress-chunks").value_or(false));
+            }
+
+            {
+                metadata_writer mdata_writer{index_name(), docs.size(),
+                                             docs.schema()};
+
+                // RAM budget is given in MB
+                fwd_impl_->tokenize_docs(docs, mdata_writer,
+                                         ram_budget * 1024 * 1024, num_threads,
+                                         inverter.get());
+            }
             impl_->load_term_id_mapping();
             impl_->save_label_id_mapping();
             fwd_impl_->total_unique_terms_ = impl_->total_unique_terms();
 
+            if (co_build)
+                fwd_impl_->finish_co_built_inverted(*inverter, inv_name);
+
             // reload the label file
             impl_->load_labels();
         }
@@ -283,21 +357,24 @@ namespace
 struct local_storage
 {
     local_storage(const std::string& chunk_path,
-                  const std::unique_ptr<analyzers::analyzer>& analyzer)
+                  const std::unique_ptr<analyzers::analyzer>& analyzer,
+                  postings_inverter<inverted_index>* inverter)
         : chunk_{chunk_path, std::ios::binary}, analyzer_{analyzer->clone()}
     {
-        // nothing
+        if (inverter)
+            producer_ = make_unique<
+                postings_inverter<inverted_index>::producer>(inverter);
     }
 
     io::mofstream chunk_;
     std::unique_ptr<analyzers::analyzer> analyzer_;
+    std::unique_ptr<postings_inverter<inverted_index>::producer> producer_;
 };
 }
 
-void forward_index::impl::tokenize_docs(corpus::corpus& docs,
-                                        metadata_writer& mdata_writer,
-                                        uint64_t ram_budget,
-                                        std::size_t num_threads)
+void forward_index::impl::tokenize_docs(
+    corpus::corpus& docs, metadata_writer& mdata_writer, uint64_t ram_budget,
+    std::size_t num_threads, postings_inverter<inverted_index>* inverter)
 {
     std::mutex io_mutex;
     std::mutex vocab_mutex;
@@ -317,7 +394,7 @@ void forward_index::impl::tokenize_docs(corpus::corpus& docs,
             auto cid = chunk_id.fetch_add(1);
             return local_storage{idx_->index_name() + "/chunk-"
                                      + std::to_string(cid),
-                                 analyzer_};
+                                 analyzer_, inverter};
         },
         [&](local_storage& ls, const corpus::document& doc) {
             {
@@ -373,6 +450,12 @@ void forward_index::impl::tokenize_docs(corpus::corpus& docs,
             forward_index::postings_data_type pdata{doc.id()};
             pdata.set_counts(std::move(pd_counts));
             pdata.write_packed(ls.chunk_);
+
+            // tee the analyzed counts into the co-built inverted index;
+            // count-based analyzers emit integral values, so the
+            // narrowing to uint64_t in the producer is exact
+            if (ls.producer_)
+                (*ls.producer_)(doc.id(), counts);
         });
 
     progress.end();
@@ -461,30 +544,72 @@ void forward_index::impl::create_libsvm_postings(corpus::corpus& docs)
 
         printing::progress progress{" > Creating postings from libsvm data: ",
                                     num_docs};
+
+        // read blocks of lines off the corpus, parse them on the pool,
+        // and write the results back out in document order; the serial
+        // parts (reading and writing) are cheap compared to the parse
+        struct parsed_doc
+        {
+            std::vector<std::pair<term_id, double>> counts;
+            double length;
+        };
+
+        parallel::thread_pool pool;
+        const uint64_t block_size = 4096;
+        std::vector<corpus::document> block;
+        std::vector<parsed_doc> parsed;
+        block.reserve(block_size);
+
         while (docs.has_next())
         {
-            auto doc = docs.next();
-            progress(doc.id());
+            block.clear();
+            while (docs.has_next() && block.size() < block_size)
+                block.push_back(docs.next());
 
-            uint64_t num_unique = 0;
-            double length = 0;
-            forward_index::postings_data_type pdata{doc.id()};
+            parsed.clear();
+            parsed.resize(block.size());
 
-            auto counts = io::libsvm_parser::counts(doc.content());
-            for (const auto& count : counts)
+            auto num_tasks = std::min(pool.size(), block.size());
+            std::vector<std::future<void>> futures;
+            futures.reserve(num_tasks);
+            for (std::size_t t = 0; t < num_tasks; ++t)
             {
-                ++num_unique;
-                if (count.first > total_unique_terms_)
-                    total_unique_terms_ = count.first;
-                length += count.second;
+                futures.emplace_back(pool.submit_task([&, t]() {
+                    for (auto i = t; i < block.size(); i += num_tasks)
+                    {
+                        auto counts
+                            = io::libsvm_parser::counts(block[i].content());
+                        parsed[i].length = 0;
+                        for (const auto& count : counts)
+                            parsed[i].length += count.second;
+                        parsed[i].counts = std::move(counts);
+                    }
+                }));
             }
+            for (auto& fut : futures)
+                fut.get();
 
-            pdata.set_counts(std::move(counts));
-            out.write(pdata);
+            for (std::size_t i = 0; i < block.size(); ++i)
+            {
+                const auto& doc = block[i];
+                progress(doc.id());
 
-            md_writer.write(doc.id(), static_cast<uint64_t>(length), num_unique,
-                            doc.mdata());
-            labels[doc.id()] = idx_->impl_->get_label_id(doc.label());
+                for (const auto& count : parsed[i].counts)
+                {
+                    if (count.first > total_unique_terms_)
+                        total_unique_terms_ = count.first;
+                }
+                auto num_unique = parsed[i].counts.size();
+
+                forward_index::postings_data_type pdata{doc.id()};
+                pdata.set_counts(std::move(parsed[i].counts));
+                out.write(pdata);
+
+                md_writer.write(doc.id(),
+                                static_cast<uint64_t>(parsed[i].length),
+                                num_unique, doc.mdata());
+                labels[doc.id()] = idx_->impl_->get_label_id(doc.label());
+            }
         }
 
         // +1 since we subtracted one from each of the ids in the
@@ -500,6 +625,42 @@ void forward_index::impl::create_libsvm_postings(corpus::corpus& docs)
               << ")" << ENDLG;
 }
 
+void forward_index::impl::finish_co_built_inverted(
+    postings_inverter<inverted_index>& inverter, const std::string& inv_name)
+{
+    // stream the merged chunks straight into the compressed postings
+    // file; the number of unique terms is already known from the shared
+    // analysis pass, so no uncompressed intermediate is needed
+    auto filename = inv_name + idx_->impl_->files[POSTINGS];
+    {
+        postings_file_writer<inverted_index::index_pdata_type> out{
+            filename, total_unique_terms_};
+
+        vocabulary_map_writer vocab{inv_name
+                                    + idx_->impl_->files[TERM_IDS_MAPPING]};
+
+        // note: the merge produces pdata in sorted term order, which is
+        // exactly the insertion order the vocabulary map requires
+        inverter.merge_chunks([&](inverted_index::index_pdata_type&& pdata) {
+            vocab.insert(pdata.primary_key());
+            out.write(pdata);
+        });
+    }
+
+    LOG(info) << "Created compressed postings file ("
+              << printing::bytes_to_units(filesystem::file_size(filename))
+              << ")" << ENDLG;
+
+    // the metadata, labels and label id mapping from the shared analysis
+    // pass describe both indexes, so the inverted side gets copies
+    auto files = {DOC_LABELS,   LABEL_IDS_MAPPING, METADATA_DB,
+                  METADATA_INDEX, METADATA_LENGTHS, METADATA_UNIQUE_TERMS};
+
+    for (const auto& file : files)
+        filesystem::copy_file(idx_->index_name() + idx_->impl_->files[file],
+                              inv_name + idx_->impl_->files[file]);
+}
+
 void forward_index::impl::create_uninverted_metadata(const std::string& name)
 {
     auto files = {DOC_LABELS,       LABEL_IDS_MAPPING,
@@ -558,8 +719,19 @@ forward_index::stream_for(doc_id d_id) const
     return fwd_impl_->postings_->find_stream(d_id);
 }
 
+void forward_index::advise_sequential() const
+{
+    fwd_impl_->postings_->advise_sequential();
+}
+
+bool forward_index::pin_postings(uint64_t ram_budget)
+{
+    return fwd_impl_->postings_->pin(ram_budget);
+}
+
 void forward_index::impl::uninvert(const inverted_index& inv_idx,
-                                   uint64_t ram_budget)
+                                   uint64_t ram_budget,
+                                   const features::feature_remap* remap)
 {
     postings_inverter<forward_index> handler{idx_->index_name()};
     {
@@ -569,45 +741,29 @@ void forward_index::impl::uninvert(const inverted_index& inv_idx,
         for (term_id t_id{0}; t_id < inv_idx.unique_terms(); ++t_id)
         {
             progress(t_id);
+            if (remap && !remap->selected(t_id))
+                continue;
             auto pdata = inv_idx.search_primary(t_id);
-            producer(pdata->primary_key(), pdata->counts());
+            // with a remap, the postings are keyed by the dense
+            // selected-feature id instead of the original term id
+            auto key = remap ? term_id{remap->new_id(t_id)} : t_id;
+            producer(key, pdata->counts());
         }
     }
 
-    handler.merge_chunks();
-    compress(idx_->index_name() + idx_->impl_->files[POSTINGS],
-             inv_idx.num_docs());
-}
-
-void forward_index::impl::compress(const std::string& filename,
-                                   uint64_t num_docs)
-{
-    auto ucfilename = filename + ".uncompressed";
-    filesystem::rename_file(filename, ucfilename);
-
-    // create a scope to ensure the reader and writer close properly so we
-    // can calculate the size of the compressed file and delete the
-    // uncompressed version at the end
+    // stream the merged chunks straight into the compressed postings
+    // file instead of materializing an uncompressed copy and re-reading
+    // it for conversion
+    auto filename = idx_->index_name() + idx_->impl_->files[POSTINGS];
     {
-        postings_file_writer<forward_index::postings_data_type> out{filename,
-                                                                    num_docs};
-
-        forward_index::index_pdata_type pdata;
-        auto length = filesystem::file_size(ucfilename);
+        postings_file_writer<forward_index::postings_data_type> out{
+            filename, inv_idx.num_docs()};
 
-        std::ifstream in{ucfilename, std::ios::binary};
-        uint64_t byte_pos = 0;
-
-        printing::progress progress{" > Compressing postings: ", length};
-        // note: we will be accessing pdata in sorted order, but not every
-        // doc_id is guaranteed to exist, so we must be mindful of document
-        // gaps
+        // note: the merge produces pdata in sorted order, but not every
+        // doc_id is guaranteed to exist, so we must be mindful of
+        // document gaps
         doc_id last_id{0};
-        while (auto bytes = pdata.read_packed(in))
-        {
-            byte_pos += bytes;
-            progress(byte_pos);
-
+        handler.merge_chunks([&](forward_index::index_pdata_type&& pdata) {
             // write out any gaps
             for (doc_id d_id{last_id + 1}; d_id < pdata.primary_key(); ++d_id)
             {
@@ -626,14 +782,12 @@ void forward_index::impl::compress(const std::string& filename,
             out.write(to_write);
 
             last_id = pdata.primary_key();
-        }
+        });
     }
 
     LOG(info) << "Created compressed postings file ("
               << printing::bytes_to_units(filesystem::file_size(filename))
               << ")" << ENDLG;
-
-    filesystem::delete_file(ucfilename);
 }
 
 void forward_index::impl::load_postings()
@@ -0,0 +1,287 @@
+/**
+ * @file impact_postings.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "meta/index/impact_postings.h"
+#include "meta/index/score_data.h"
+#include "meta/io/packed.h"
+#include "meta/io/packed_block.h"
+#include "meta/util/fixed_heap.h"
+
+namespace meta
+{
+namespace index
+{
+
+impact_quantizer::impact_quantizer(float max_score, uint8_t num_levels)
+    : max_score_{max_score}, num_levels_{num_levels}
+{
+    // nothing
+}
+
+uint8_t impact_quantizer::quantize(float score) const
+{
+    if (score <= 0)
+        return 1;
+    if (score >= max_score_)
+        return num_levels_;
+    auto bucket = static_cast<uint8_t>(score / max_score_ * num_levels_) + 1;
+    return std::min<uint8_t>(bucket, num_levels_);
+}
+
+float impact_quantizer::dequantize(uint8_t impact) const
+{
+    return static_cast<float>(impact) / num_levels_ * max_score_;
+}
+
+uint8_t impact_quantizer::num_levels() const
+{
+    return num_levels_;
+}
+
+float impact_quantizer::max_score() const
+{
+    return max_score_;
+}
+
+impact_postings_writer::impact_postings_writer(const std::string& filename,
+                                               uint64_t unique_keys)
+    : output_{filename, std::ios::binary},
+      byte_locations_{filename + "_index", unique_keys},
+      byte_pos_{0},
+      id_{0}
+{
+    // nothing
+}
+
+void impact_postings_writer::write(
+    std::vector<std::pair<doc_id, uint8_t>>& postings)
+{
+    byte_locations_[id_] = byte_pos_;
+    ++id_;
+
+    // descending impact, ascending doc id within a band
+    std::sort(postings.begin(), postings.end(),
+              [](const std::pair<doc_id, uint8_t>& lhs,
+                 const std::pair<doc_id, uint8_t>& rhs) {
+                  return std::make_pair(rhs.second, lhs.first)
+                         < std::make_pair(lhs.second, rhs.first);
+              });
+
+    uint64_t num_bands = 0;
+    for (std::size_t i = 0; i < postings.size();)
+    {
+        ++num_bands;
+        auto impact = postings[i].second;
+        while (i < postings.size() && postings[i].second == impact)
+            ++i;
+    }
+    byte_pos_ += io::packed::write(output_, num_bands);
+
+    for (std::size_t i = 0; i < postings.size();)
+    {
+        auto impact = postings[i].second;
+        auto band_start = i;
+        while (i < postings.size() && postings[i].second == impact)
+            ++i;
+
+        byte_pos_ += io::packed::write(output_, impact);
+        byte_pos_ += io::packed::write(output_, i - band_start);
+        uint64_t last_id = 0;
+        for (auto j = band_start; j < i; ++j)
+        {
+            byte_pos_ += io::packed::write(output_, postings[j].first
+                                                        - last_id);
+            last_id = postings[j].first;
+        }
+    }
+}
+
+impact_postings_file::stream::stream(const char* buffer)
+    : pos_{buffer}, next_impact_{0}
+{
+    pos_ = io::packed::decode_value(pos_, bands_left_);
+    if (bands_left_ > 0)
+        pos_ = io::packed::decode_value(pos_, next_impact_);
+}
+
+uint8_t impact_postings_file::stream::peek_impact() const
+{
+    return next_impact_;
+}
+
+bool impact_postings_file::stream::next_band(uint8_t& impact,
+                                             std::vector<doc_id>& docs)
+{
+    if (bands_left_ == 0)
+        return false;
+
+    impact = next_impact_;
+    uint64_t num_docs;
+    pos_ = io::packed::decode_value(pos_, num_docs);
+
+    docs.clear();
+    docs.reserve(num_docs);
+    uint64_t id = 0;
+    for (uint64_t i = 0; i < num_docs; ++i)
+    {
+        uint64_t gap;
+        pos_ = io::packed::decode_value(pos_, gap);
+        id += gap;
+        docs.emplace_back(id);
+    }
+
+    --bands_left_;
+    next_impact_ = 0;
+    if (bands_left_ > 0)
+        pos_ = io::packed::decode_value(pos_, next_impact_);
+    return true;
+}
+
+impact_postings_file::impact_postings_file(const std::string& filename)
+    : postings_{filename}, byte_locations_{filename + "_index"}
+{
+    // nothing
+}
+
+auto impact_postings_file::find_stream(term_id pk) const
+    -> util::optional<stream>
+{
+    if (pk < byte_locations_.size())
+        return stream{postings_.begin() + byte_locations_.at(pk)};
+    return util::nullopt;
+}
+
+impact_quantizer build_impact_postings(inverted_index& idx,
+                                       ranking_function& fn,
+                                       const std::string& filename,
+                                       uint8_t num_levels)
+{
+    score_data sd{idx, idx.avg_doc_length(), idx.num_docs(),
+                  idx.total_corpus_terms(), 1.0f};
+    sd.query_term_weight = 1.0f;
+
+    auto score_posting = [&](term_id t_id, const postings_stream<doc_id>& ps,
+                             doc_id d_id, uint64_t count) {
+        sd.t_id = t_id;
+        sd.doc_count = ps.size();
+        sd.corpus_term_count = ps.total_counts();
+        sd.d_id = d_id;
+        sd.doc_term_count = count;
+        sd.doc_size = idx.doc_size(d_id);
+        sd.doc_unique_terms = idx.unique_terms(d_id);
+        return fn.score_one(sd);
+    };
+
+    // first pass: find the maximum score for the quantizer
+    auto max_score = 0.0f;
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+    {
+        auto ps = idx.stream_for(t_id);
+        for (const auto& pr : *ps)
+            max_score = std::max(
+                max_score, score_posting(t_id, *ps, pr.first, pr.second));
+    }
+
+    impact_quantizer quantizer{max_score, num_levels};
+
+    // second pass: quantize and write the impact-ordered lists
+    impact_postings_writer writer{filename, idx.unique_terms()};
+    std::vector<std::pair<doc_id, uint8_t>> postings;
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+    {
+        auto ps = idx.stream_for(t_id);
+        postings.clear();
+        postings.reserve(ps->size());
+        for (const auto& pr : *ps)
+        {
+            auto score = score_posting(t_id, *ps, pr.first, pr.second);
+            postings.emplace_back(pr.first, quantizer.quantize(score));
+        }
+        writer.write(postings);
+    }
+
+    return quantizer;
+}
+
+impact_scorer::impact_scorer(const impact_postings_file& postings,
+                             uint64_t num_docs)
+    : postings_{postings}, accumulators_(num_docs, 0)
+{
+    // nothing
+}
+
+std::vector<search_result>
+impact_scorer::score(inverted_index& idx, const corpus::document& query,
+                     uint64_t num_results, uint64_t postings_budget)
+{
+    // reset only the accumulators touched by the previous query
+    for (const auto& d_id : touched_)
+        accumulators_[d_id] = 0;
+    touched_.clear();
+
+    struct term_cursor
+    {
+        impact_postings_file::stream stream;
+        uint64_t weight;
+    };
+
+    std::vector<term_cursor> cursors;
+    for (const auto& count : idx.tokenize(query))
+    {
+        auto strm = postings_.find_stream(idx.get_term_id(count.key()));
+        if (!strm)
+            continue;
+        cursors.push_back({*strm, static_cast<uint64_t>(count.value())});
+    }
+
+    // consume bands in descending weighted impact across all terms
+    uint64_t accumulated = 0;
+    std::vector<doc_id> band;
+    while (true)
+    {
+        term_cursor* best = nullptr;
+        uint64_t best_impact = 0;
+        for (auto& cursor : cursors)
+        {
+            auto impact = cursor.stream.peek_impact() * cursor.weight;
+            if (impact > best_impact)
+            {
+                best_impact = impact;
+                best = &cursor;
+            }
+        }
+        if (!best)
+            break;
+
+        uint8_t impact;
+        best->stream.next_band(impact, band);
+        for (const auto& d_id : band)
+        {
+            if (accumulators_[d_id] == 0)
+                touched_.push_back(d_id);
+            accumulators_[d_id]
+                += static_cast<uint32_t>(impact * best->weight);
+        }
+
+        accumulated += band.size();
+        if (postings_budget != 0 && accumulated >= postings_budget)
+            break;
+    }
+
+    auto results = util::make_fixed_heap<search_result>(
+        num_results, [](const search_result& a, const search_result& b) {
+            // comparison is reversed since we want a min-heap
+            return a.score > b.score;
+        });
+    for (const auto& d_id : touched_)
+        results.emplace(d_id, static_cast<float>(accumulators_[d_id]));
+
+    return results.extract_top();
+}
+}
+}
@@ -0,0 +1,114 @@
+/**
+ * @file intersection.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+
+#include "meta/index/intersection.h"
+#include "meta/index/score_data.h"
+#include "meta/util/fixed_heap.h"
+
+namespace meta
+{
+namespace index
+{
+
+std::vector<search_result> conjunctive_score(inverted_index& idx,
+                                             ranking_function& fn,
+                                             const corpus::document& query,
+                                             uint64_t num_results)
+{
+    struct term_cursor
+    {
+        postings_stream<doc_id> ps;
+        postings_stream<doc_id>::iterator it;
+        term_id t_id;
+        float weight;
+    };
+
+    std::vector<term_cursor> cursors;
+    float query_length = 0.0f;
+    for (const auto& count : idx.tokenize(query))
+    {
+        query_length += count.value();
+        auto t_id = idx.get_term_id(count.key());
+        auto ps = idx.stream_for(t_id);
+        // conjunctive semantics: a term absent from the index empties the
+        // intersection
+        if (!ps)
+            return {};
+        cursors.push_back(
+            {*ps, ps->begin(), t_id, static_cast<float>(count.value())});
+        if (cursors.back().it == postings_stream<doc_id>::iterator{})
+            return {};
+    }
+
+    if (cursors.empty())
+        return {};
+
+    // rarest list first so that it drives the candidate documents
+    std::sort(cursors.begin(), cursors.end(),
+              [](const term_cursor& lhs, const term_cursor& rhs) {
+                  return lhs.ps.size() < rhs.ps.size();
+              });
+
+    score_data sd{idx, idx.avg_doc_length(), idx.num_docs(),
+                  idx.total_corpus_terms(), query_length};
+
+    auto results = util::make_fixed_heap<search_result>(
+        num_results, [](const search_result& a, const search_result& b) {
+            // comparison is reversed since we want a min-heap
+            return a.score > b.score;
+        });
+
+    postings_stream<doc_id>::iterator sentinel;
+    auto candidate = cursors[0].it->first;
+    std::size_t pos = 0;
+    std::size_t agree = 0;
+    while (true)
+    {
+        auto& cursor = cursors[pos];
+        cursor.it.skip_to(candidate);
+        if (cursor.it == sentinel)
+            break;
+
+        if (cursor.it->first == candidate)
+        {
+            if (++agree == cursors.size())
+            {
+                // every list is aligned on candidate: score it
+                sd.d_id = candidate;
+                sd.doc_size = idx.doc_size(candidate);
+                sd.doc_unique_terms = idx.unique_terms(candidate);
+
+                auto score = fn.initial_score(sd);
+                for (const auto& matched : cursors)
+                {
+                    sd.t_id = matched.t_id;
+                    sd.query_term_weight = matched.weight;
+                    sd.doc_count = matched.ps.size();
+                    sd.corpus_term_count
+                        = static_cast<uint64_t>(matched.ps.total_counts());
+                    sd.doc_term_count
+                        = static_cast<uint64_t>(matched.it->second);
+                    score += fn.score_one(sd);
+                }
+                results.emplace(candidate, score);
+
+                candidate = doc_id{static_cast<uint64_t>(candidate) + 1};
+                agree = 0;
+            }
+        }
+        else
+        {
+            candidate = cursor.it->first;
+            agree = 1;
+        }
+        pos = (pos + 1) % cursors.size();
+    }
+
+    return results.extract_top();
+}
+}
+}
@@ -4,6 +4,9 @@
  * @author Chase Geigle
  */
 
+#include <atomic>
+#include <mutex>
+
 #include "meta/index/disk_index_impl.h"
 #include "meta/index/inverted_index.h"
 #include "meta/index/metadata_writer.h"
@@ -12,8 +15,10 @@
 #include "meta/index/postings_inverter.h"
 #include "meta/index/vocabulary_map_writer.h"
 #include "meta/logging/logger.h"
+#include "meta/parallel/mpmc_queue.h"
 #include "meta/util/pimpl.tcc"
 #include "meta/util/printing.h"
+#include "meta/util/time.h"
 
 namespace meta
 {
@@ -59,15 +64,39 @@ class inverted_index::impl
     /**
      * Loads the postings file.
      */
-    void load_postings();
+    void load_postings() const;
+
+    /**
+     * Ensures the postings file is loaded, loading it on first use.
+     */
+    void ensure_postings() const;
+
+    /**
+     * Ensures the in-memory term statistics table is built, building it
+     * on first use with one pass over the postings headers.
+     */
+    void ensure_term_stats() const;
 
     /// The analyzer used to tokenize documents.
     std::unique_ptr<analyzers::analyzer> analyzer_;
 
-    util::optional<postings_file<inverted_index::primary_key_type,
-                                 inverted_index::secondary_key_type>>
+    /// Guards the analyzer for concurrent query tokenization.
+    std::mutex analyzer_mutex_;
+
+    /// mutable (with its once flag) for lazy loads from const accessors
+    mutable util::optional<postings_file<inverted_index::primary_key_type,
+                                         inverted_index::secondary_key_type>>
         postings_;
 
+    /// guards the lazy one-time load of the postings file
+    mutable std::once_flag postings_init_;
+
+    /// per-term statistics, indexed by term_id (lazily built)
+    mutable std::vector<inverted_index::term_stat> term_stats_;
+
+    /// guards the lazy one-time build of the term statistics table
+    mutable std::once_flag term_stats_init_;
+
     /// the total number of term occurrences in the entire corpus
     uint64_t total_corpus_terms_;
 };
@@ -135,6 +164,8 @@ void inverted_index::create_index(const cpptoml::table& config,
     }
 
     postings_inverter<inverted_index> inverter{index_name(), max_writers};
+    inverter.compress_chunks(
+        config.get_as<bool>("compress-chunks").value_or(false));
     {
         metadata_writer mdata_writer{index_name(), docs.size(), docs.schema()};
 
@@ -170,21 +201,26 @@ void inverted_index::load_index()
 {
     LOG(info) << "Loading index from disk: " << index_name() << ENDLG;
 
-    impl_->initialize_metadata();
-    impl_->load_term_id_mapping();
+    // only the (tiny) label id mapping is read eagerly; the metadata,
+    // term mapping, labels, and postings components initialize lazily
+    // on first access, so the open itself is nearly instant — call
+    // warm_up() to pay for the full load up front instead
     impl_->load_label_id_mapping();
-    impl_->load_labels();
-    inv_impl_->load_postings();
+}
+
+void inverted_index::warm_up() const
+{
+    disk_index::warm_up();
+    inv_impl_->ensure_postings();
 }
 
 namespace
 {
 struct local_storage
 {
-    local_storage(uint64_t ram_budget,
-                  postings_inverter<inverted_index>& inverter,
+    local_storage(postings_inverter<inverted_index>& inverter,
                   const std::unique_ptr<analyzers::analyzer>& analyzer)
-        : producer_{inverter.make_producer(ram_budget)},
+        : producer_{inverter.make_producer()},
           analyzer_{analyzer->clone()}
     {
         // nothing
@@ -193,6 +229,13 @@ struct local_storage
     postings_inverter<inverted_index>::producer producer_;
     std::unique_ptr<analyzers::analyzer> analyzer_;
 };
+
+/// an analyzed document in flight between the analyze and invert stages
+struct analyzed_doc
+{
+    doc_id id;
+    analyzers::feature_map<uint64_t> counts;
+};
 }
 
 void inverted_index::impl::tokenize_docs(
@@ -203,45 +246,128 @@ void inverted_index::impl::tokenize_docs(
         idx_->index_name() + idx_->impl_->files[DOC_LABELS], docs.size()};
     std::mutex io_mutex;
     printing::progress progress{" > Tokenizing Docs: ", docs.size()};
-    uint64_t local_budget = ram_budget / num_threads;
+
+    // the budget is shared across all producers rather than statically
+    // split per thread, so skewed term distributions no longer cause one
+    // thread to flush early while the others under-use their share
+    inverter.ram_budget(ram_budget);
 
     parallel::thread_pool pool{num_threads};
 
-    corpus::parallel_consume(
-        docs, pool,
-        [&]() {
-            return local_storage{local_budget, inverter, analyzer_};
-        },
-        [&](local_storage& ls, const corpus::document& doc) {
-            {
-                std::lock_guard<std::mutex> lock{io_mutex};
+    // with a single worker there is no one to run a separate invert
+    // stage, so fall back to analyzing and inverting in one step
+    if (num_threads < 2)
+    {
+        corpus::parallel_consume(
+            docs, pool,
+            [&]() {
+                return local_storage{inverter, analyzer_};
+            },
+            [&](local_storage& ls, const corpus::document& doc) {
                 progress(doc.id());
-            }
 
-            auto counts = ls.analyzer_->analyze<uint64_t>(doc);
+                auto counts = ls.analyzer_->analyze<uint64_t>(doc);
+
+                if (counts.empty())
+                {
+                    LOG(progress) << '\n' << ENDLG;
+                    LOG(warning) << "Empty document (id = " << doc.id()
+                                 << ") generated!" << ENDLG;
+                }
+
+                auto length = std::accumulate(
+                    counts.begin(), counts.end(), 0ul,
+                    [](uint64_t acc,
+                       const std::pair<std::string, uint64_t>& count) {
+                        return acc + count.second;
+                    });
+
+                mdata_writer.write(doc.id(), length, counts.size(),
+                                   doc.mdata());
+                labels[doc.id()] = idx_->impl_->get_label_id(doc.label());
+
+                ls.producer_(doc.id(), counts);
+            });
+        return;
+    }
+
+    // an explicit pipeline: this thread reads documents, most workers
+    // analyze them, and a few workers invert the resulting counts. The
+    // stages are decoupled by bounded lock-free ring queues, so a slow
+    // disk and slow analysis overlap instead of convoying on one lock
+    parallel::mpmc_queue<corpus::document> doc_queue{num_threads * 4};
+    parallel::mpmc_queue<analyzed_doc> counts_queue{num_threads * 4};
+
+    auto num_inverters = std::max<std::size_t>(1, num_threads / 4);
+    auto num_analyzers = num_threads - num_inverters;
+    std::atomic<std::size_t> live_analyzers{num_analyzers};
 
-            // warn if there is an empty document
-            if (counts.empty())
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_threads);
+
+    // the invert stage: submitted first so that every inverter holds a
+    // worker before the analyzers start filling its queue
+    for (std::size_t i = 0; i < num_inverters; ++i)
+    {
+        futures.emplace_back(pool.submit_task([&]() {
+            auto producer = inverter.make_producer();
+            analyzed_doc ad;
+            while (counts_queue.pop(ad))
+                producer(ad.id, ad.counts);
+        }));
+    }
+
+    // the analyze stage
+    for (std::size_t i = 0; i < num_analyzers; ++i)
+    {
+        futures.emplace_back(pool.submit_task([&]() {
+            auto analyzer = analyzer_->clone();
+            corpus::document doc;
+            while (doc_queue.pop(doc))
             {
-                std::lock_guard<std::mutex> lock{io_mutex};
-                LOG(progress) << '\n' << ENDLG;
-                LOG(warning) << "Empty document (id = " << doc.id()
-                             << ") generated!" << ENDLG;
+                {
+                    std::lock_guard<std::mutex> lock{io_mutex};
+                    progress(doc.id());
+                }
+
+                auto counts = analyzer->analyze<uint64_t>(doc);
+
+                // warn if there is an empty document
+                if (counts.empty())
+                {
+                    std::lock_guard<std::mutex> lock{io_mutex};
+                    LOG(progress) << '\n' << ENDLG;
+                    LOG(warning) << "Empty document (id = " << doc.id()
+                                 << ") generated!" << ENDLG;
+                }
+
+                auto length = std::accumulate(
+                    counts.begin(), counts.end(), 0ul,
+                    [](uint64_t acc,
+                       const std::pair<std::string, uint64_t>& count) {
+                        return acc + count.second;
+                    });
+
+                mdata_writer.write(doc.id(), length, counts.size(),
+                                   doc.mdata());
+                labels[doc.id()] = idx_->impl_->get_label_id(doc.label());
+
+                counts_queue.push(analyzed_doc{doc.id(), std::move(counts)});
             }
 
-            auto length = std::accumulate(
-                counts.begin(), counts.end(), 0ul,
-                [](uint64_t acc,
-                   const std::pair<std::string, uint64_t>& count) {
-                    return acc + count.second;
-                });
+            // the last analyzer out closes the downstream queue
+            if (live_analyzers.fetch_sub(1) == 1)
+                counts_queue.close();
+        }));
+    }
 
-            mdata_writer.write(doc.id(), length, counts.size(), doc.mdata());
-            labels[doc.id()] = idx_->impl_->get_label_id(doc.label());
+    // the read stage, on this thread
+    while (docs.has_next())
+        doc_queue.push(docs.next());
+    doc_queue.close();
 
-            // update chunk
-            ls.producer_(doc.id(), counts);
-        });
+    for (auto& fut : futures)
+        fut.get();
 }
 
 void inverted_index::impl::compress(const std::string& filename,
@@ -283,11 +409,52 @@ void inverted_index::impl::compress(const std::string& filename,
     filesystem::delete_file(ucfilename);
 }
 
-void inverted_index::impl::load_postings()
+void inverted_index::impl::load_postings() const
 {
     postings_ = {idx_->index_name() + idx_->impl_->files[POSTINGS]};
 }
 
+void inverted_index::impl::ensure_postings() const
+{
+    std::call_once(postings_init_, [this]() {
+        if (!postings_)
+            load_postings();
+    });
+}
+
+void inverted_index::impl::ensure_term_stats() const
+{
+    std::call_once(term_stats_init_, [this]() {
+        ensure_postings();
+        auto num_terms = idx_->unique_terms();
+        LOG(info) << "Building term statistics table (" << num_terms
+                  << " terms)" << ENDLG;
+        auto time = common::time([&]() {
+            term_stats_.resize(num_terms);
+            for (uint64_t i = 0; i < num_terms; ++i)
+            {
+                if (auto stream = postings_->find_stream(term_id{i}))
+                {
+                    term_stats_[i] = {stream->size(), stream->total_counts(),
+                                      stream->max_count()};
+                }
+            }
+        });
+        LOG(info) << "Done. (" << time.count() << "ms)" << ENDLG;
+    });
+}
+
+const inverted_index::term_stat& inverted_index::term_stats(term_id t_id) const
+{
+    inv_impl_->ensure_term_stats();
+    if (t_id >= inv_impl_->term_stats_.size())
+    {
+        static const term_stat empty{0, 0, 0};
+        return empty;
+    }
+    return inv_impl_->term_stats_[t_id];
+}
+
 uint64_t inverted_index::term_freq(term_id t_id, doc_id d_id) const
 {
     auto pdata = search_primary(t_id);
@@ -318,6 +485,9 @@ float inverted_index::avg_doc_length()
 analyzers::feature_map<uint64_t>
 inverted_index::tokenize(const corpus::document& doc)
 {
+    // the analyzer's token streams are stateful, so concurrent query
+    // paths (e.g. ranker::score_batch) must serialize tokenization
+    std::lock_guard<std::mutex> lock{inv_impl_->analyzer_mutex_};
     return inv_impl_->analyzer_->analyze<uint64_t>(doc);
 }
 
@@ -329,13 +499,21 @@ uint64_t inverted_index::doc_freq(term_id t_id) const
 auto inverted_index::search_primary(term_id t_id) const
     -> std::shared_ptr<postings_data_type>
 {
+    inv_impl_->ensure_postings();
     return inv_impl_->postings_->find(t_id);
 }
 
 util::optional<postings_stream<doc_id>>
 inverted_index::stream_for(term_id t_id) const
 {
+    inv_impl_->ensure_postings();
     return inv_impl_->postings_->find_stream(t_id);
 }
+
+void inverted_index::prefetch(term_id t_id) const
+{
+    inv_impl_->ensure_postings();
+    inv_impl_->postings_->prefetch(t_id);
+}
 }
 }
@@ -0,0 +1,275 @@
+/**
+ * @file metadata_bitmap.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include "meta/index/disk_index.h"
+#include "meta/index/metadata_bitmap.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
+
+namespace meta
+{
+namespace index
+{
+
+const constexpr uint64_t doc_set::sentinel;
+const constexpr std::size_t doc_set::max_array_size;
+
+namespace
+{
+/// the number of 64-bit words in a bitset container
+const constexpr std::size_t bitset_words = (uint64_t{1} << 16) / 64;
+}
+
+doc_set::doc_set(const std::vector<doc_id>& docs) : size_{docs.size()}
+{
+    std::size_t pos = 0;
+    while (pos < docs.size())
+    {
+        auto key = static_cast<uint64_t>(docs[pos]) >> 16;
+        auto end = pos;
+        while (end < docs.size()
+               && static_cast<uint64_t>(docs[end]) >> 16 == key)
+            ++end;
+
+        containers_.emplace_back();
+        auto& c = containers_.back();
+        c.key = key;
+        if (end - pos <= max_array_size)
+        {
+            c.array.reserve(end - pos);
+            for (; pos < end; ++pos)
+                c.array.push_back(static_cast<uint16_t>(docs[pos] & 0xffff));
+        }
+        else
+        {
+            c.bits.resize(bitset_words);
+            for (; pos < end; ++pos)
+            {
+                auto low = static_cast<uint64_t>(docs[pos]) & 0xffff;
+                c.bits[low / 64] |= uint64_t{1} << (low % 64);
+            }
+        }
+    }
+}
+
+bool doc_set::contains(doc_id d_id) const
+{
+    auto key = static_cast<uint64_t>(d_id) >> 16;
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const container& c, uint64_t k) {
+                                   return c.key < k;
+                               });
+    if (it == containers_.end() || it->key != key)
+        return false;
+
+    auto low = static_cast<uint16_t>(d_id & 0xffff);
+    if (!it->bits.empty())
+        return (it->bits[low / 64] >> (low % 64)) & 1;
+    return std::binary_search(it->array.begin(), it->array.end(), low);
+}
+
+doc_id doc_set::next_geq(doc_id d_id) const
+{
+    auto key = static_cast<uint64_t>(d_id) >> 16;
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const container& c, uint64_t k) {
+                                   return c.key < k;
+                               });
+
+    for (; it != containers_.end(); ++it)
+    {
+        // only the first candidate container constrains the low bits
+        uint64_t low = it->key == key ? (d_id & 0xffff) : 0;
+
+        if (!it->bits.empty())
+        {
+            auto word = low / 64;
+            auto masked = it->bits[word] & (~uint64_t{0} << (low % 64));
+            while (true)
+            {
+                if (masked)
+                {
+                    auto bit = word * 64
+                               + static_cast<uint64_t>(__builtin_ctzll(masked));
+                    return doc_id{(it->key << 16) | bit};
+                }
+                if (++word == bitset_words)
+                    break;
+                masked = it->bits[word];
+            }
+        }
+        else
+        {
+            auto pos = std::lower_bound(it->array.begin(), it->array.end(),
+                                        static_cast<uint16_t>(low));
+            if (pos != it->array.end())
+                return doc_id{(it->key << 16) | *pos};
+        }
+    }
+
+    return doc_id{sentinel};
+}
+
+uint64_t doc_set::size() const
+{
+    return size_;
+}
+
+void doc_set::decompress(std::vector<doc_id>& docs) const
+{
+    for (const auto& c : containers_)
+    {
+        if (!c.bits.empty())
+        {
+            for (std::size_t word = 0; word < bitset_words; ++word)
+            {
+                auto bits = c.bits[word];
+                while (bits)
+                {
+                    auto bit = static_cast<uint64_t>(__builtin_ctzll(bits));
+                    docs.push_back(doc_id{(c.key << 16) | (word * 64 + bit)});
+                    bits &= bits - 1;
+                }
+            }
+        }
+        else
+        {
+            for (auto low : c.array)
+                docs.push_back(doc_id{(c.key << 16) | low});
+        }
+    }
+}
+
+doc_set doc_set::set_union(const std::vector<const doc_set*>& sets)
+{
+    std::vector<doc_id> docs;
+    for (const auto* set : sets)
+    {
+        if (set)
+            set->decompress(docs);
+    }
+    std::sort(docs.begin(), docs.end());
+    docs.erase(std::unique(docs.begin(), docs.end()), docs.end());
+    return doc_set{docs};
+}
+
+void doc_set::save(std::ostream& out) const
+{
+    io::packed::write(out, size_);
+    io::packed::write(out, static_cast<uint64_t>(containers_.size()));
+    for (const auto& c : containers_)
+    {
+        io::packed::write(out, c.key);
+        io::packed::write(out, static_cast<uint64_t>(c.array.size()));
+        if (!c.bits.empty())
+        {
+            for (auto word : c.bits)
+                io::packed::write(out, word);
+        }
+        else
+        {
+            for (auto low : c.array)
+                io::packed::write(out, static_cast<uint64_t>(low));
+        }
+    }
+}
+
+void doc_set::load(std::istream& in)
+{
+    io::packed::read(in, size_);
+    containers_.resize(io::packed::read<uint64_t>(in));
+    for (auto& c : containers_)
+    {
+        io::packed::read(in, c.key);
+        auto array_size = io::packed::read<uint64_t>(in);
+        if (array_size == 0)
+        {
+            c.bits.resize(bitset_words);
+            for (auto& word : c.bits)
+                io::packed::read(in, word);
+        }
+        else
+        {
+            c.array.resize(array_size);
+            for (auto& low : c.array)
+                low = static_cast<uint16_t>(io::packed::read<uint64_t>(in));
+        }
+    }
+}
+
+metadata_bitmap::metadata_bitmap(disk_index& idx, const std::string& field)
+{
+    auto filename = idx.index_name() + "/" + field + ".bitmap";
+    if (!filesystem::file_exists(filename))
+    {
+        build(idx, field);
+
+        std::ofstream out{filename, std::ios::binary};
+        io::packed::write(out, static_cast<uint64_t>(bitmaps_.size()));
+        for (const auto& bucket : bitmaps_)
+        {
+            io::packed::write(out, bucket.first);
+            bucket.second.save(out);
+        }
+        return;
+    }
+
+    std::ifstream in{filename, std::ios::binary};
+    auto num_values = io::packed::read<uint64_t>(in);
+    for (uint64_t i = 0; i < num_values; ++i)
+    {
+        std::string value;
+        io::packed::read(in, value);
+        bitmaps_[value].load(in);
+    }
+}
+
+void metadata_bitmap::build(disk_index& idx, const std::string& field)
+{
+    std::unordered_map<std::string, std::vector<doc_id>> groups;
+    uint64_t found = 0;
+    for (uint64_t i = 0; i < idx.num_docs(); ++i)
+    {
+        if (auto value = idx.metadata<std::string>(doc_id{i}, field))
+        {
+            groups[*value].push_back(doc_id{i});
+            ++found;
+        }
+    }
+
+    if (!found)
+        throw metadata_bitmap_exception{
+            "no document has a string metadata field \"" + field + "\""};
+
+    for (auto& group : groups)
+        bitmaps_.emplace(group.first, doc_set{group.second});
+}
+
+const doc_set* metadata_bitmap::find(const std::string& value) const
+{
+    auto it = bitmaps_.find(value);
+    if (it == bitmaps_.end())
+        return nullptr;
+    return &it->second;
+}
+
+doc_set metadata_bitmap::filter(const std::vector<std::string>& values) const
+{
+    std::vector<const doc_set*> sets;
+    sets.reserve(values.size());
+    for (const auto& value : values)
+        sets.push_back(find(value));
+    return doc_set::set_union(sets);
+}
+
+uint64_t metadata_bitmap::num_values() const
+{
+    return bitmaps_.size();
+}
+}
+}
@@ -4,7 +4,9 @@
  */
 
 #include "meta/index/metadata_file.h"
+#include "meta/io/filesystem.h"
 #include "meta/io/packed.h"
+#include "meta/util/shim.h"
 
 namespace meta
 {
@@ -36,8 +38,21 @@ struct char_input_stream
 }
 
 metadata_file::metadata_file(const std::string& prefix)
-    : index_{prefix + "/metadata.index"}, md_db_{prefix + "/metadata.db"}
+    : index_{prefix + "/metadata.index"},
+      lengths_{prefix + "/metadata.lengths"},
+      unique_terms_{prefix + "/metadata.unique-terms"},
+      md_db_{prefix + "/metadata.db"}
 {
+    // the per-document index vectors are touched by nearly every
+    // ranked query (lengths for normalization, the index for metadata
+    // fetches), so pre-fault them at open; the metadata database
+    // itself can be large and is left lazily paged, with a random
+    // hint since documents are fetched in score order
+    index_.prefetch(0, index_.size());
+    lengths_.prefetch(0, lengths_.size());
+    unique_terms_.prefetch(0, unique_terms_.size());
+    md_db_.advise_random();
+
     // read in the header to populate the schema
     char_input_stream stream{md_db_.begin(), md_db_.begin() + md_db_.size()};
     uint64_t num_fields;
@@ -54,6 +69,52 @@ metadata_file::metadata_file(const std::string& prefix)
         info.type = static_cast<corpus::metadata::field_type>(stream.get());
         schema_.emplace_back(std::move(info));
     }
+
+    // map the per-field columns when present (indexes built before the
+    // columns existed simply fall back to record parsing)
+    if (schema_.size() > 2)
+    {
+        columns_.resize(schema_.size() - 2);
+        for (std::size_t i = 0; i < columns_.size(); ++i)
+        {
+            auto path = prefix + "/metadata.col." + std::to_string(i);
+            if (!filesystem::file_exists(path))
+                continue;
+
+            auto& col = columns_[i];
+            switch (schema_[i + 2].type)
+            {
+                case corpus::metadata::field_type::SIGNED_INT:
+                    col.signed_vals = make_unique<
+                        util::disk_vector<const int64_t>>(path);
+                    break;
+
+                case corpus::metadata::field_type::UNSIGNED_INT:
+                    col.unsigned_vals = make_unique<
+                        util::disk_vector<const uint64_t>>(path);
+                    break;
+
+                case corpus::metadata::field_type::DOUBLE:
+                    col.double_vals = make_unique<
+                        util::disk_vector<const double>>(path);
+                    break;
+
+                case corpus::metadata::field_type::STRING:
+                {
+                    auto dict = prefix + "/metadata.dict." + std::to_string(i);
+                    if (!filesystem::file_exists(dict + ".index"))
+                        continue;
+                    col.dict_ids = make_unique<
+                        util::disk_vector<const uint64_t>>(path);
+                    col.dict_offsets = make_unique<
+                        util::disk_vector<const uint64_t>>(dict + ".index");
+                    if (filesystem::file_size(dict) > 0)
+                        col.dict_bytes = make_unique<io::mmap_file>(dict);
+                    break;
+                }
+            }
+        }
+    }
 }
 
 corpus::metadata metadata_file::get(doc_id d_id) const
@@ -66,9 +127,108 @@ corpus::metadata metadata_file::get(doc_id d_id) const
     return {md_db_.begin() + seek_pos, schema_};
 }
 
+uint64_t metadata_file::doc_size(doc_id d_id) const
+{
+    if (d_id >= lengths_.size())
+        throw corpus::metadata_exception{
+            "invalid doc id in metadata retrieval"};
+
+    return lengths_[d_id];
+}
+
+uint64_t metadata_file::unique_terms(doc_id d_id) const
+{
+    if (d_id >= unique_terms_.size())
+        throw corpus::metadata_exception{
+            "invalid doc id in metadata retrieval"};
+
+    return unique_terms_[d_id];
+}
+
 uint64_t metadata_file::size() const
 {
     return index_.size();
 }
+
+util::optional<uint64_t> metadata_file::field_index(
+    util::string_view name) const
+{
+    for (uint64_t i = 0; i < schema_.size(); ++i)
+    {
+        if (schema_[i].name == name)
+            return i;
+    }
+    return util::nullopt;
+}
+
+const corpus::metadata::schema_type& metadata_file::schema() const
+{
+    return schema_;
+}
+
+auto metadata_file::checked_column(uint64_t field,
+                                   corpus::metadata::field_type type) const
+    -> const column&
+{
+    if (field < 2 || field >= schema_.size()
+        || schema_[field].type != type)
+        throw corpus::metadata_exception{
+            "field type mismatch in columnar metadata retrieval"};
+    return columns_[field - 2];
+}
+
+int64_t metadata_file::signed_value(uint64_t field, doc_id d_id) const
+{
+    const auto& col
+        = checked_column(field, corpus::metadata::field_type::SIGNED_INT);
+    if (!col.signed_vals || d_id >= col.signed_vals->size())
+        throw corpus::metadata_exception{
+            "no columnar data for metadata field"};
+    return (*col.signed_vals)[d_id];
+}
+
+uint64_t metadata_file::unsigned_value(uint64_t field, doc_id d_id) const
+{
+    // the two mandatory fields live in their own columns
+    if (field == 0)
+        return doc_size(d_id);
+    if (field == 1)
+        return unique_terms(d_id);
+
+    const auto& col
+        = checked_column(field, corpus::metadata::field_type::UNSIGNED_INT);
+    if (!col.unsigned_vals || d_id >= col.unsigned_vals->size())
+        throw corpus::metadata_exception{
+            "no columnar data for metadata field"};
+    return (*col.unsigned_vals)[d_id];
+}
+
+double metadata_file::double_value(uint64_t field, doc_id d_id) const
+{
+    const auto& col
+        = checked_column(field, corpus::metadata::field_type::DOUBLE);
+    if (!col.double_vals || d_id >= col.double_vals->size())
+        throw corpus::metadata_exception{
+            "no columnar data for metadata field"};
+    return (*col.double_vals)[d_id];
+}
+
+util::string_view metadata_file::string_value(uint64_t field,
+                                              doc_id d_id) const
+{
+    const auto& col
+        = checked_column(field, corpus::metadata::field_type::STRING);
+    if (!col.dict_ids || d_id >= col.dict_ids->size())
+        throw corpus::metadata_exception{
+            "no columnar data for metadata field"};
+
+    auto id = (*col.dict_ids)[d_id];
+    auto begin = (*col.dict_offsets)[id];
+    auto end = (*col.dict_offsets)[id + 1];
+    if (begin == end)
+        return {};
+    return {col.dict_bytes->begin() + begin,
+            static_cast<std::size_t>(end - begin)};
+}
 }
 }
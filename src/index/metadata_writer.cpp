@@ -5,6 +5,7 @@
 
 #include "meta/index/metadata_writer.h"
 #include "meta/io/packed.h"
+#include "meta/util/shim.h"
 
 namespace meta
 {
@@ -14,10 +15,42 @@ namespace index
 metadata_writer::metadata_writer(const std::string& prefix, uint64_t num_docs,
                                  corpus::metadata::schema_type schema)
     : seek_pos_{prefix + "/metadata.index", num_docs},
+      lengths_{prefix + "/metadata.lengths", num_docs},
+      unique_terms_{prefix + "/metadata.unique-terms", num_docs},
+      prefix_{prefix},
       byte_pos_{0},
       db_file_{prefix + "/metadata.db", std::ios::binary},
       schema_{std::move(schema)}
 {
+    // one fixed-width column per user-declared field
+    columns_.resize(schema_.size());
+    for (std::size_t i = 0; i < schema_.size(); ++i)
+    {
+        auto path = prefix_ + "/metadata.col." + std::to_string(i);
+        switch (schema_[i].type)
+        {
+            case corpus::metadata::field_type::SIGNED_INT:
+                columns_[i].signed_vals
+                    = make_unique<util::disk_vector<int64_t>>(path, num_docs);
+                break;
+
+            case corpus::metadata::field_type::UNSIGNED_INT:
+                columns_[i].unsigned_vals
+                    = make_unique<util::disk_vector<uint64_t>>(path, num_docs);
+                break;
+
+            case corpus::metadata::field_type::DOUBLE:
+                columns_[i].double_vals
+                    = make_unique<util::disk_vector<double>>(path, num_docs);
+                break;
+
+            case corpus::metadata::field_type::STRING:
+                columns_[i].dict_ids
+                    = make_unique<util::disk_vector<uint64_t>>(path, num_docs);
+                break;
+        }
+    }
+
     // write metadata header
     // cast below is needed for OS X overload resolution
     byte_pos_ += io::packed::write(db_file_,
@@ -44,7 +77,11 @@ void metadata_writer::write(doc_id d_id, uint64_t length, uint64_t num_unique,
     std::lock_guard<std::mutex> lock{lock_};
 
     seek_pos_[d_id] = byte_pos_;
-    // write "mandatory" metadata
+    // write "mandatory" metadata: both into the record (so the generic
+    // metadata reader still sees it) and into the fixed-width columns
+    // (so scoring can read it without unpacking the record)
+    lengths_[d_id] = length;
+    unique_terms_[d_id] = num_unique;
     byte_pos_ += io::packed::write(db_file_, length);
     byte_pos_ += io::packed::write(db_file_, num_unique);
 
@@ -53,26 +90,70 @@ void metadata_writer::write(doc_id d_id, uint64_t length, uint64_t num_unique,
         throw corpus::metadata_exception{
             "schema mismatch when writing metadata"};
 
-    for (const auto& fld : mdata)
+    for (std::size_t i = 0; i < mdata.size(); ++i)
     {
+        const auto& fld = mdata[i];
+        auto& col = columns_[i];
+        if (fld.type != schema_[i].type)
+            throw corpus::metadata_exception{
+                "schema mismatch when writing metadata"};
         switch (fld.type)
         {
             case corpus::metadata::field_type::SIGNED_INT:
                 byte_pos_ += io::packed::write(db_file_, fld.sign_int);
+                (*col.signed_vals)[d_id] = fld.sign_int;
                 break;
 
             case corpus::metadata::field_type::UNSIGNED_INT:
                 byte_pos_ += io::packed::write(db_file_, fld.usign_int);
+                (*col.unsigned_vals)[d_id] = fld.usign_int;
                 break;
 
             case corpus::metadata::field_type::DOUBLE:
                 byte_pos_ += io::packed::write(db_file_, fld.doub);
+                (*col.double_vals)[d_id] = fld.doub;
                 break;
 
             case corpus::metadata::field_type::STRING:
+            {
                 byte_pos_ += io::packed::write(db_file_, fld.str);
+                auto it = col.dict.find(fld.str);
+                if (it == col.dict.end())
+                {
+                    it = col.dict.emplace(fld.str, col.dict.size()).first;
+                    col.dict_strings.push_back(fld.str);
+                }
+                (*col.dict_ids)[d_id] = it->second;
                 break;
+            }
+        }
+    }
+}
+
+metadata_writer::~metadata_writer()
+{
+    // finalize the string dictionaries: the raw bytes in id order plus
+    // an offset vector with a trailing sentinel for length computation
+    for (std::size_t i = 0; i < columns_.size(); ++i)
+    {
+        auto& col = columns_[i];
+        if (!col.dict_ids)
+            continue;
+
+        auto path = prefix_ + "/metadata.dict." + std::to_string(i);
+        util::disk_vector<uint64_t> offsets{path + ".index",
+                                            col.dict_strings.size() + 1};
+        std::ofstream bytes{path, std::ios::binary};
+        uint64_t pos = 0;
+        for (std::size_t id = 0; id < col.dict_strings.size(); ++id)
+        {
+            offsets[id] = pos;
+            bytes.write(col.dict_strings[id].data(),
+                        static_cast<std::streamsize>(
+                            col.dict_strings[id].size()));
+            pos += col.dict_strings[id].size();
         }
+        offsets[col.dict_strings.size()] = pos;
     }
 }
 }
@@ -0,0 +1,309 @@
+/**
+ * @file positional_postings.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "meta/analyzers/analyzer.h"
+#include "meta/index/positional_postings.h"
+#include "meta/index/score_data.h"
+#include "meta/io/packed.h"
+#include "meta/io/packed_block.h"
+#include "meta/util/fixed_heap.h"
+
+namespace meta
+{
+namespace index
+{
+
+positional_postings_writer::positional_postings_writer(
+    const std::string& filename, uint64_t unique_keys)
+    : output_{filename, std::ios::binary},
+      byte_locations_{filename + "_index", unique_keys},
+      byte_pos_{0},
+      id_{0}
+{
+    // nothing
+}
+
+void positional_postings_writer::write(
+    const std::vector<std::pair<doc_id, std::vector<uint64_t>>>& postings)
+{
+    byte_locations_[id_] = byte_pos_;
+    ++id_;
+
+    byte_pos_ += io::packed::write(output_,
+                                   static_cast<uint64_t>(postings.size()));
+    uint64_t last_id = 0;
+    for (const auto& pr : postings)
+    {
+        byte_pos_ += io::packed::write(output_, pr.first - last_id);
+        last_id = pr.first;
+        byte_pos_ += io::packed::write(
+            output_, static_cast<uint64_t>(pr.second.size()));
+        uint64_t last_pos = 0;
+        for (const auto& position : pr.second)
+        {
+            byte_pos_ += io::packed::write(output_, position - last_pos);
+            last_pos = position;
+        }
+    }
+}
+
+positional_postings_file::stream::stream(const char* buffer)
+    : pos_{buffer}, prev_id_{0}
+{
+    pos_ = io::packed::decode_value(pos_, docs_left_);
+}
+
+bool positional_postings_file::stream::next(doc_id& d_id,
+                                            std::vector<uint64_t>& positions)
+{
+    if (pending_)
+    {
+        d_id = *pending_;
+        positions = std::move(pending_positions_);
+        pending_ = util::nullopt;
+        return true;
+    }
+
+    if (docs_left_ == 0)
+        return false;
+    --docs_left_;
+
+    uint64_t gap;
+    pos_ = io::packed::decode_value(pos_, gap);
+    prev_id_ += gap;
+    d_id = doc_id{prev_id_};
+
+    uint64_t num_positions;
+    pos_ = io::packed::decode_value(pos_, num_positions);
+    positions.clear();
+    positions.reserve(num_positions);
+    uint64_t position = 0;
+    for (uint64_t i = 0; i < num_positions; ++i)
+    {
+        uint64_t pgap;
+        pos_ = io::packed::decode_value(pos_, pgap);
+        position += pgap;
+        positions.push_back(position);
+    }
+    return true;
+}
+
+bool positional_postings_file::stream::find(doc_id target,
+                                            std::vector<uint64_t>& positions)
+{
+    if (pending_ && *pending_ > target)
+        return false;
+
+    doc_id d_id{0};
+    while (next(d_id, positions))
+    {
+        if (d_id == target)
+            return true;
+        if (d_id > target)
+        {
+            // save the overshoot for the next (ascending) query
+            pending_ = d_id;
+            pending_positions_ = std::move(positions);
+            return false;
+        }
+    }
+    return false;
+}
+
+positional_postings_file::positional_postings_file(const std::string& filename)
+    : postings_{filename}, byte_locations_{filename + "_index"}
+{
+    // nothing
+}
+
+auto positional_postings_file::find_stream(term_id pk) const
+    -> util::optional<stream>
+{
+    if (pk < byte_locations_.size())
+        return stream{postings_.begin() + byte_locations_.at(pk)};
+    return util::nullopt;
+}
+
+uint64_t build_positional_postings(inverted_index& idx, corpus::corpus& docs,
+                                   analyzers::token_stream& stream,
+                                   const std::string& filename)
+{
+    auto num_terms = idx.unique_terms();
+    std::vector<std::vector<std::pair<doc_id, std::vector<uint64_t>>>> lists(
+        num_terms);
+
+    while (docs.has_next())
+    {
+        auto doc = docs.next();
+        auto d_id = doc.id();
+        stream.set_content(analyzers::get_content(doc));
+
+        uint64_t position = 0;
+        while (stream)
+        {
+            auto token = stream.next();
+            auto t_id = idx.get_term_id(token.to_string());
+            // tokens outside the index vocabulary (e.g. sentence markers
+            // the analyzer adds) carry no position information we can use
+            if (t_id < num_terms)
+            {
+                auto& list = lists[t_id];
+                if (list.empty() || list.back().first != d_id)
+                    list.emplace_back(d_id, std::vector<uint64_t>{});
+                list.back().second.push_back(position);
+            }
+            ++position;
+        }
+    }
+
+    positional_postings_writer writer{filename, num_terms};
+    for (const auto& list : lists)
+        writer.write(list);
+    return num_terms;
+}
+
+namespace
+{
+/**
+ * @param position_lists One ascending position list per phrase term
+ * @return the length of the smallest window containing at least one
+ * position from every list
+ */
+uint64_t minimal_window(
+    const std::vector<std::vector<uint64_t>>& position_lists)
+{
+    // merge the positions, remembering which term each came from
+    std::vector<std::pair<uint64_t, std::size_t>> merged;
+    for (std::size_t term = 0; term < position_lists.size(); ++term)
+        for (const auto& position : position_lists[term])
+            merged.emplace_back(position, term);
+    std::sort(merged.begin(), merged.end());
+
+    // sliding window over the merged sequence
+    std::vector<uint64_t> in_window(position_lists.size(), 0);
+    std::size_t covered = 0;
+    std::size_t left = 0;
+    auto best = std::numeric_limits<uint64_t>::max();
+    for (std::size_t right = 0; right < merged.size(); ++right)
+    {
+        if (in_window[merged[right].second]++ == 0)
+            ++covered;
+        while (covered == position_lists.size())
+        {
+            best = std::min(best,
+                            merged[right].first - merged[left].first + 1);
+            if (--in_window[merged[left].second] == 0)
+                --covered;
+            ++left;
+        }
+    }
+    return best;
+}
+}
+
+std::vector<search_result>
+proximity_score(inverted_index& idx, positional_postings_file& positions,
+                ranking_function& fn, const std::vector<std::string>& phrase,
+                uint64_t num_results, float proximity_weight)
+{
+    struct term_cursor
+    {
+        postings_stream<doc_id> ps;
+        postings_stream<doc_id>::iterator it;
+        positional_postings_file::stream pstream;
+        term_id t_id;
+    };
+
+    std::vector<term_cursor> cursors;
+    for (const auto& term : phrase)
+    {
+        auto t_id = idx.get_term_id(term);
+        auto ps = idx.stream_for(t_id);
+        auto pstream = positions.find_stream(t_id);
+        if (!ps || !pstream)
+            return {};
+        cursors.push_back({*ps, ps->begin(), *pstream, t_id});
+        if (cursors.back().it == postings_stream<doc_id>::iterator{})
+            return {};
+    }
+    if (cursors.empty())
+        return {};
+
+    score_data sd{idx, idx.avg_doc_length(), idx.num_docs(),
+                  idx.total_corpus_terms(),
+                  static_cast<float>(phrase.size())};
+    sd.query_term_weight = 1.0f;
+
+    auto results = util::make_fixed_heap<search_result>(
+        num_results, [](const search_result& a, const search_result& b) {
+            // comparison is reversed since we want a min-heap
+            return a.score > b.score;
+        });
+
+    // intersect the regular postings lists; documents are produced in
+    // ascending order, which the positional cursors rely on
+    postings_stream<doc_id>::iterator sentinel;
+    std::vector<std::vector<uint64_t>> position_lists(cursors.size());
+    auto candidate = cursors[0].it->first;
+    std::size_t pos = 0;
+    std::size_t agree = 0;
+    while (true)
+    {
+        auto& cursor = cursors[pos];
+        cursor.it.skip_to(candidate);
+        if (cursor.it == sentinel)
+            break;
+
+        if (cursor.it->first == candidate)
+        {
+            if (++agree == cursors.size())
+            {
+                sd.d_id = candidate;
+                sd.doc_size = idx.doc_size(candidate);
+                sd.doc_unique_terms = idx.unique_terms(candidate);
+
+                auto score = fn.initial_score(sd);
+                for (std::size_t i = 0; i < cursors.size(); ++i)
+                {
+                    auto& matched = cursors[i];
+                    sd.t_id = matched.t_id;
+                    sd.doc_count = matched.ps.size();
+                    sd.corpus_term_count
+                        = static_cast<uint64_t>(matched.ps.total_counts());
+                    sd.doc_term_count
+                        = static_cast<uint64_t>(matched.it->second);
+                    score += fn.score_one(sd);
+
+                    matched.pstream.find(candidate, position_lists[i]);
+                }
+
+                auto span = minimal_window(position_lists);
+                // no window can exist if the positional file disagrees
+                // with the index (e.g. built with a different chain)
+                if (span != std::numeric_limits<uint64_t>::max())
+                    score += proximity_weight
+                             / (1 + span
+                                - static_cast<uint64_t>(cursors.size()));
+                results.emplace(candidate, score);
+
+                candidate = doc_id{static_cast<uint64_t>(candidate) + 1};
+                agree = 0;
+            }
+        }
+        else
+        {
+            candidate = cursor.it->first;
+            agree = 1;
+        }
+        pos = (pos + 1) % cursors.size();
+    }
+
+    return results.extract_top();
+}
+}
+}
@@ -48,6 +48,13 @@ float absolute_discount::doc_constant(const score_data& sd) const
     return delta_ * unique / sd.doc_size;
 }
 
+std::vector<search_result>
+absolute_discount::rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                                   const filter_function_type& filter)
+{
+    return detail::daat_rank(*this, ctx, num_results, filter);
+}
+
 template <>
 std::unique_ptr<ranker>
 make_ranker<absolute_discount>(const cpptoml::table& config)
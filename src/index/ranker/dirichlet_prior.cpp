@@ -46,6 +46,13 @@ float dirichlet_prior::doc_constant(const score_data& sd) const
     return mu_ / (sd.doc_size + mu_);
 }
 
+std::vector<search_result>
+dirichlet_prior::rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                                 const filter_function_type& filter)
+{
+    return detail::daat_rank(*this, ctx, num_results, filter);
+}
+
 template <>
 std::unique_ptr<ranker>
     make_ranker<dirichlet_prior>(const cpptoml::table& config)
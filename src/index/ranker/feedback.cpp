@@ -0,0 +1,104 @@
+/**
+ * @file feedback.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+
+#include "meta/hashing/hash.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/feedback.h"
+
+namespace meta
+{
+namespace index
+{
+namespace feedback
+{
+
+namespace
+{
+/// fixed seed so fingerprints are stable within a process
+const constexpr uint64_t fingerprint_seed = 0x71c38fb1d2a5e647ULL;
+}
+
+uint64_t fingerprint(const ranker_context& ctx,
+                     const std::vector<search_result>& fb_docs)
+{
+    // sort the query terms so that iteration order does not matter
+    std::vector<std::pair<uint64_t, float>> terms;
+    terms.reserve(ctx.postings.size());
+    for (const auto& pc : ctx.postings)
+        terms.emplace_back(pc.t_id, pc.query_term_weight);
+    std::sort(terms.begin(), terms.end());
+
+    using hash_algorithm = hashing::default_hasher<8>::type;
+    hash_algorithm h{fingerprint_seed};
+    using hashing::hash_append;
+    hash_append(h, terms);
+    hash_append(h, ctx.idx.index_name());
+    for (const auto& sr : fb_docs)
+        hash_append(h, static_cast<uint64_t>(sr.d_id));
+    hash_append(h, fb_docs.size());
+    return static_cast<uint64_t>(static_cast<std::size_t>(h));
+}
+
+std::vector<search_result>
+initial_pass(ranker& initial, ranker_context& ctx, uint64_t k,
+             const ranker::filter_function_type& filter, doc_set& candidates)
+{
+    std::vector<doc_id> docs;
+
+    // the context's cursors already sit on their first accepted
+    // document, which the filter will not be consulted about again
+    for (auto& pc : ctx.postings)
+    {
+        if (pc.begin != pc.end)
+            docs.push_back(pc.begin->first);
+    }
+
+    // a pushdown set would bypass the filter during traversal, hiding
+    // the accepted documents from the recording below; drop it and let
+    // the filter (which accepts the same documents) do the work
+    ctx.pushdown = nullptr;
+
+    ranker::filter_function_type recording = [&](doc_id d_id) {
+        if (!filter(d_id))
+            return false;
+        docs.push_back(d_id);
+        return true;
+    };
+    auto results = initial.rank(ctx, k, recording);
+
+    std::sort(docs.begin(), docs.end());
+    docs.erase(std::unique(docs.begin(), docs.end()), docs.end());
+    candidates = doc_set{docs};
+    return results;
+}
+
+std::vector<search_result>
+second_pass(ranker& initial, inverted_index& idx,
+            const hashing::probe_map<term_id, float>& query,
+            const doc_set& candidates, uint64_t num_results)
+{
+    ranker_context ctx{idx, query.begin(), query.end(), ranker::passthrough};
+    ctx.pushdown = &candidates;
+
+    // align every cursor with the candidate set before ranking begins
+    ctx.cur_doc = doc_id{idx.num_docs()};
+    for (auto& pc : ctx.postings)
+    {
+        while (pc.begin != pc.end && !candidates.contains(pc.begin->first))
+            pc.begin.skip_to(candidates.next_geq(pc.begin->first));
+
+        if (pc.begin != pc.end && pc.begin->first < ctx.cur_doc)
+            ctx.cur_doc = pc.begin->first;
+    }
+
+    ranker::filter_function_type callback
+        = [&candidates](doc_id d_id) { return candidates.contains(d_id); };
+    return initial.rank(ctx, num_results, callback);
+}
+}
+}
+}
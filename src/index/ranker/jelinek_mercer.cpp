@@ -46,6 +46,13 @@ float jelinek_mercer::doc_constant(const score_data&) const
     return lambda_;
 }
 
+std::vector<search_result>
+jelinek_mercer::rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                                const filter_function_type& filter)
+{
+    return detail::daat_rank(*this, ctx, num_results, filter);
+}
+
 template <>
 std::unique_ptr<ranker>
     make_ranker<jelinek_mercer>(const cpptoml::table& config)
@@ -7,6 +7,7 @@
 
 #include "cpptoml.h"
 #include "meta/index/ranker/dirichlet_prior.h"
+#include "meta/index/ranker/feedback.h"
 #include "meta/index/ranker/kl_divergence_prf.h"
 #include "meta/index/ranker/unigram_mixture.h"
 #include "meta/index/score_data.h"
@@ -26,6 +27,7 @@ const constexpr float kl_divergence_prf::default_alpha;
 const constexpr float kl_divergence_prf::default_lambda;
 const constexpr uint64_t kl_divergence_prf::default_k;
 const constexpr uint64_t kl_divergence_prf::default_max_terms;
+const constexpr uint64_t kl_divergence_prf::default_cache_size;
 
 kl_divergence_prf::kl_divergence_prf(std::shared_ptr<forward_index> fwd)
     : fwd_{std::move(fwd)},
@@ -82,37 +84,54 @@ std::vector<search_result>
 kl_divergence_prf::rank(ranker_context& ctx, uint64_t num_results,
                         const filter_function_type& filter)
 {
-    auto fb_docs = initial_ranker_->rank(ctx, k_, filter);
-    auto extract_docid = [](const search_result& sr) { return sr.d_id; };
-
-    // construct feedback document set
-    learn::dataset fb_dset{
-        fwd_, util::make_transform_iterator(fb_docs.begin(), extract_docid),
-        util::make_transform_iterator(fb_docs.end(), extract_docid),
-        printing::no_progress_trait{}};
-
-    // learn the feedback model using the EM algorithm
-    feedback::training_options options;
-    options.lambda = lambda_;
-    auto fb_model = feedback::unigram_mixture(
-        [&](term_id tid) {
-            float term_count = ctx.idx.total_num_occurences(tid);
-            return term_count / ctx.idx.total_corpus_terms();
-        },
-        fb_dset, options);
-
-    // extract only the top max_terms from the feedback model
-    using scored_term = std::pair<term_id, float>;
-    auto heap = util::make_fixed_heap<scored_term>(
-        max_terms_, [&](const scored_term& a, const scored_term& b) {
-            return a.second > b.second;
-        });
-    fb_model.each_seen_event(
-        [&](term_id tid) { heap.emplace(tid, fb_model.probability(tid)); });
+    // run the first pass, recording the candidate set so the second
+    // pass only has to touch documents matching the original query
+    doc_set candidates;
+    auto fb_docs
+        = feedback::initial_pass(*initial_ranker_, ctx, k_, filter, candidates);
+
+    // serve the feedback term distribution from the cache if this query
+    // (with these feedback documents) has been expanded before
+    auto key = feedback::fingerprint(ctx, fb_docs);
+    auto fb_terms = fb_cache_.find(key);
+    if (!fb_terms)
+    {
+        auto extract_docid = [](const search_result& sr) { return sr.d_id; };
+
+        // construct feedback document set
+        learn::dataset fb_dset{
+            fwd_,
+            util::make_transform_iterator(fb_docs.begin(), extract_docid),
+            util::make_transform_iterator(fb_docs.end(), extract_docid),
+            printing::no_progress_trait{}};
+
+        // learn the feedback model using the EM algorithm
+        feedback::training_options options;
+        options.lambda = lambda_;
+        auto fb_model = feedback::unigram_mixture(
+            [&](term_id tid) {
+                float term_count = ctx.idx.total_num_occurences(tid);
+                return term_count / ctx.idx.total_corpus_terms();
+            },
+            fb_dset, options);
+
+        // extract only the top max_terms from the feedback model
+        using scored_term = std::pair<term_id, float>;
+        auto heap = util::make_fixed_heap<scored_term>(
+            max_terms_, [&](const scored_term& a, const scored_term& b) {
+                return a.second > b.second;
+            });
+        fb_model.each_seen_event(
+            [&](term_id tid) { heap.emplace(tid, fb_model.probability(tid)); });
+
+        fb_terms
+            = std::make_shared<const feedback_terms>(heap.extract_top());
+        fb_cache_.insert(key, *fb_terms);
+    }
 
     // interpolate the old query with the top terms from the feedback model
     hashing::probe_map<term_id, float> new_query;
-    for (const auto& pr : heap.extract_top())
+    for (const auto& pr : **fb_terms)
     {
         new_query[pr.first] += alpha_ * pr.second;
     }
@@ -122,11 +141,9 @@ kl_divergence_prf::rank(ranker_context& ctx, uint64_t num_results,
         new_query[postings_ctx.t_id] += (1.0f - alpha_) * p_wq;
     }
 
-    // construct a new ranker_context from the new query
-    ranker_context new_ctx{ctx.idx, new_query.begin(), new_query.end(), filter};
-
-    // return ranking results based on the new query
-    return initial_ranker_->rank(new_ctx, num_results, filter);
+    // rescore the expanded query over the first-pass candidates only
+    return feedback::second_pass(*initial_ranker_, ctx.idx, new_query,
+                                 candidates, num_results);
 }
 
 template <>
@@ -0,0 +1,212 @@
+/**
+ * @file ltr_reranker.cpp
+ * @author Sean Massung
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "meta/corpus/document.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/ltr_reranker.h"
+#include "meta/index/ranker/ranker_factory.h"
+#include "meta/index/score_data.h"
+#include "meta/io/packed.h"
+#include "meta/util/shim.h"
+
+namespace meta
+{
+namespace index
+{
+
+ltr_reranker::ltr_reranker(
+    std::vector<std::unique_ptr<ranking_function>> feature_rankers,
+    std::unique_ptr<learn::loss::loss_function> loss,
+    learn::sgd_model::options_type options)
+    : rankers_{std::move(feature_rankers)}, loss_{std::move(loss)}
+{
+    model_ = make_unique<learn::sgd_model>(num_features(), options);
+}
+
+ltr_reranker::ltr_reranker(std::istream& in)
+{
+    auto num_rankers = io::packed::read<std::size_t>(in);
+    rankers_.reserve(num_rankers);
+    for (std::size_t i = 0; i < num_rankers; ++i)
+    {
+        auto rnk = load_ranker(in);
+        if (auto fn = dynamic_cast<ranking_function*>(rnk.get()))
+        {
+            rnk.release();
+            rankers_.emplace_back(fn);
+        }
+        else
+        {
+            throw ranker_exception{
+                "ltr_reranker feature rankers must be ranking_functions"};
+        }
+    }
+    loss_ = learn::loss::load_loss_function(in);
+    model_ = make_unique<learn::sgd_model>(in);
+}
+
+void ltr_reranker::save(std::ostream& out) const
+{
+    io::packed::write(out, rankers_.size());
+    for (const auto& rnk : rankers_)
+        rnk->save(out);
+    loss_->save(out);
+    model_->save(out);
+}
+
+std::size_t ltr_reranker::num_features() const
+{
+    // one per feature ranker, plus matched-term fraction, log document
+    // length, log unique terms, first-stage score, and reciprocal rank
+    return rankers_.size() + 5;
+}
+
+std::vector<ltr_candidate>
+ltr_reranker::extract(inverted_index& idx, const corpus::document& query,
+                      const std::vector<search_result>& results) const
+{
+    std::unordered_set<doc_id> candidates;
+    candidates.reserve(results.size());
+    for (const auto& result : results)
+        candidates.insert(result.d_id);
+
+    ranker::filter_function_type filter = [&](doc_id d_id) {
+        return candidates.find(d_id) != candidates.end();
+    };
+
+    auto counts = idx.tokenize(query);
+    ranker_context ctx{idx, counts.begin(), counts.end(), filter};
+
+    score_data sd{idx, idx.avg_doc_length(), idx.num_docs(),
+                  idx.total_corpus_terms(), ctx.query_length};
+
+    // one traversal over the candidate documents accumulates every
+    // feature ranker's score and the matched-term count per document
+    struct doc_stats
+    {
+        std::vector<float> scores;
+        uint64_t matched = 0;
+    };
+    std::unordered_map<doc_id, doc_stats> stats;
+    stats.reserve(results.size());
+
+    doc_id next_doc{idx.num_docs()};
+    while (ctx.cur_doc < idx.num_docs())
+    {
+        sd.d_id = ctx.cur_doc;
+        sd.doc_size = idx.doc_size(ctx.cur_doc);
+        sd.doc_unique_terms = idx.unique_terms(ctx.cur_doc);
+
+        auto& ds = stats[ctx.cur_doc];
+        ds.scores.resize(rankers_.size());
+        for (std::size_t r = 0; r < rankers_.size(); ++r)
+            ds.scores[r] = rankers_[r]->initial_score(sd);
+
+        for (auto& pc : ctx.postings)
+        {
+            if (pc.begin == pc.end)
+                continue;
+
+            if (pc.begin->first == ctx.cur_doc)
+            {
+                // set up this term once; every feature ranker scores
+                // against the same decoded posting
+                sd.t_id = pc.t_id;
+                sd.query_term_weight = pc.query_term_weight;
+                sd.doc_count = pc.doc_count;
+                sd.corpus_term_count = pc.corpus_term_count;
+                sd.doc_term_count = pc.begin->second;
+
+                for (std::size_t r = 0; r < rankers_.size(); ++r)
+                    ds.scores[r] += rankers_[r]->score_one(sd);
+                ++ds.matched;
+
+                detail::advance(pc, filter, nullptr);
+            }
+
+            if (pc.begin != pc.end)
+            {
+                if (pc.begin->first < next_doc)
+                    next_doc = pc.begin->first;
+            }
+        }
+
+        ctx.cur_doc = next_doc;
+        next_doc = doc_id{idx.num_docs()};
+    }
+
+    auto num_query_terms = std::max<std::size_t>(ctx.postings.size(), 1);
+
+    std::vector<ltr_candidate> out;
+    out.reserve(results.size());
+    uint64_t rank = 0;
+    for (const auto& result : results)
+    {
+        ltr_candidate cand;
+        cand.d_id = result.d_id;
+        cand.first_stage_score = result.score;
+
+        auto fid = learn::feature_id{0};
+        auto it = stats.find(result.d_id);
+        for (std::size_t r = 0; r < rankers_.size(); ++r, ++fid)
+            cand.features[fid] = it != stats.end() ? it->second.scores[r] : 0.0;
+        cand.features[fid++]
+            = it != stats.end()
+                  ? static_cast<double>(it->second.matched) / num_query_terms
+                  : 0.0;
+        cand.features[fid++] = std::log1p(idx.doc_size(result.d_id));
+        cand.features[fid++] = std::log1p(idx.unique_terms(result.d_id));
+        cand.features[fid++] = result.score;
+        cand.features[fid++] = 1.0 / (rank + 1);
+
+        out.emplace_back(std::move(cand));
+        ++rank;
+    }
+    return out;
+}
+
+double ltr_reranker::predict(const ltr_candidate& candidate) const
+{
+    return model_->predict(candidate.features);
+}
+
+std::vector<search_result>
+ltr_reranker::rerank(inverted_index& idx, const corpus::document& query,
+                     std::vector<search_result> results,
+                     uint64_t depth /* = default_rerank_depth */) const
+{
+    auto head = std::min<std::size_t>(depth, results.size());
+    if (head == 0)
+        return results;
+
+    std::vector<search_result> top{results.begin(),
+                                   results.begin()
+                                       + static_cast<std::ptrdiff_t>(head)};
+    auto candidates = extract(idx, query, top);
+
+    for (std::size_t i = 0; i < head; ++i)
+        top[i].score = static_cast<float>(predict(candidates[i]));
+
+    // stable: ties keep their first-stage order
+    std::stable_sort(top.begin(), top.end(),
+                     [](const search_result& a, const search_result& b) {
+                         return a.score > b.score;
+                     });
+
+    std::copy(top.begin(), top.end(), results.begin());
+    return results;
+}
+
+double ltr_reranker::train_one(const ltr_candidate& candidate, double relevance)
+{
+    return model_->train_one(candidate.features, relevance, *loss_);
+}
+}
+}
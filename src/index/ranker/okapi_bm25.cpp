@@ -60,6 +60,18 @@ float okapi_bm25::score_one(const score_data& sd)
     return TF * IDF * QTF;
 }
 
+float okapi_bm25::score_upper_bound(const score_data& sd)
+{
+    return score_one(sd);
+}
+
+std::vector<search_result>
+okapi_bm25::rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                            const filter_function_type& filter)
+{
+    return detail::daat_rank(*this, ctx, num_results, filter);
+}
+
 template <>
 std::unique_ptr<ranker> make_ranker<okapi_bm25>(const cpptoml::table& config)
 {
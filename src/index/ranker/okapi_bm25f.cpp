@@ -0,0 +1,252 @@
+/**
+ * @file okapi_bm25f.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "meta/analyzers/field_analyzer.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/okapi_bm25f.h"
+#include "meta/io/packed.h"
+#include "meta/math/fastapprox.h"
+#include "meta/util/fixed_heap.h"
+
+namespace meta
+{
+namespace index
+{
+
+const util::string_view okapi_bm25f::id = "bm25f";
+const constexpr float okapi_bm25f::default_content_weight;
+const constexpr float okapi_bm25f::default_k1;
+const constexpr float okapi_bm25f::default_b;
+const constexpr float okapi_bm25f::default_k3;
+
+okapi_bm25f::okapi_bm25f(std::vector<field_weight> fields,
+                         float content_weight, float k1, float b, float k3)
+    : fields_{std::move(fields)},
+      content_weight_{content_weight},
+      k1_{k1},
+      b_{b},
+      k3_{k3}
+{
+    /* nothing */
+}
+
+okapi_bm25f::okapi_bm25f(std::istream& in)
+    : fields_{[&]() {
+          std::vector<field_weight> fields(io::packed::read<uint64_t>(in));
+          for (auto& fw : fields)
+          {
+              io::packed::read(in, fw.field);
+              io::packed::read(in, fw.weight);
+          }
+          return fields;
+      }()},
+      content_weight_{io::packed::read<float>(in)},
+      k1_{io::packed::read<float>(in)},
+      b_{io::packed::read<float>(in)},
+      k3_{io::packed::read<float>(in)}
+{
+    // nothing
+}
+
+void okapi_bm25f::save(std::ostream& out) const
+{
+    io::packed::write(out, id);
+
+    io::packed::write(out, static_cast<uint64_t>(fields_.size()));
+    for (const auto& fw : fields_)
+    {
+        io::packed::write(out, fw.field);
+        io::packed::write(out, fw.weight);
+    }
+    io::packed::write(out, content_weight_);
+    io::packed::write(out, k1_);
+    io::packed::write(out, b_);
+    io::packed::write(out, k3_);
+}
+
+std::vector<search_result>
+okapi_bm25f::rank(ranker_context& ctx, uint64_t num_results,
+                  const filter_function_type& filter)
+{
+    query_stats::scoped_timer score_timer{query_stats::phase::score};
+    uint64_t candidates = 0;
+
+    // one postings cursor per (query term, field) pair; the query terms
+    // themselves define the scoring groups
+    struct field_entry
+    {
+        detail::postings_context pc;
+        float weight;
+        std::size_t group;
+    };
+
+    std::vector<field_entry> entries;
+    std::vector<uint64_t> group_df(ctx.postings.size(), 0);
+    std::vector<float> group_qtw(ctx.postings.size(), 0.0f);
+
+    for (std::size_t g = 0; g < ctx.postings.size(); ++g)
+    {
+        const auto& qpc = ctx.postings[g];
+        group_qtw[g] = qpc.query_term_weight;
+
+        auto add_field = [&](term_id t_id, float weight) {
+            auto pstream = ctx.idx.stream_for(t_id);
+            if (!pstream)
+                return;
+
+            entries.push_back(
+                {{*pstream, qpc.query_term_weight, t_id}, weight, g});
+
+            auto& pc = entries.back().pc;
+            while (pc.begin != pc.end && !filter(pc.begin->first))
+                ++pc.begin;
+            group_df[g] = std::max(group_df[g], pc.doc_count);
+        };
+
+        if (content_weight_ > 0)
+            add_field(qpc.t_id, content_weight_);
+
+        auto term = ctx.idx.term_text(qpc.t_id);
+        for (const auto& fw : fields_)
+            add_field(ctx.idx.get_term_id(
+                          analyzers::field_analyzer::field_term(fw.field,
+                                                                term)),
+                      fw.weight);
+    }
+
+    auto results = util::make_fixed_heap<search_result>(
+        num_results, [](const search_result& a, const search_result& b) {
+            // comparison is reversed since we want a min-heap
+            return a.score > b.score;
+        });
+
+    float num_docs
+        = ctx.global ? ctx.global->num_docs : ctx.idx.num_docs();
+    float avg_dl = ctx.global ? ctx.global->avg_doc_length()
+                              : ctx.idx.avg_doc_length();
+
+    doc_id cur_doc{ctx.idx.num_docs()};
+    for (auto& e : entries)
+    {
+        if (e.pc.begin != e.pc.end && e.pc.begin->first < cur_doc)
+            cur_doc = e.pc.begin->first;
+    }
+
+    // each query term's document frequency is accumulated over fields
+    // before the BM25 saturation, per BM25F
+    std::vector<float> weighted_tf(ctx.postings.size());
+    doc_id next_doc{ctx.idx.num_docs()};
+    while (cur_doc < ctx.idx.num_docs())
+    {
+        std::fill(weighted_tf.begin(), weighted_tf.end(), 0.0f);
+        for (auto& e : entries)
+        {
+            if (e.pc.begin == e.pc.end)
+                continue;
+
+            if (e.pc.begin->first == cur_doc)
+            {
+                weighted_tf[e.group] += e.weight * e.pc.begin->second;
+
+                // advance over this position in the current postings
+                // context until the next valid document
+                do
+                {
+                    ++e.pc.begin;
+                } while (e.pc.begin != e.pc.end
+                         && !filter(e.pc.begin->first));
+            }
+
+            if (e.pc.begin != e.pc.end)
+            {
+                // check if the document in the next position is the
+                // smallest accepted doc_id
+                if (e.pc.begin->first < next_doc)
+                    next_doc = e.pc.begin->first;
+            }
+        }
+
+        float doc_len = ctx.idx.doc_size(cur_doc);
+        float norm = (1.0f - b_) + b_ * doc_len / avg_dl;
+
+        float score = 0.0f;
+        for (std::size_t g = 0; g < weighted_tf.size(); ++g)
+        {
+            if (weighted_tf[g] <= 0.0f)
+                continue;
+
+            float tf = weighted_tf[g] / norm;
+            float df = group_df[g];
+
+            // add 1.0 to the IDF to ensure that the result is positive
+            float IDF = fastapprox::fastlog(
+                1.0f + (num_docs - df + 0.5f) / (df + 0.5f));
+
+            float TF = ((k1_ + 1.0f) * tf) / (k1_ + tf);
+
+            float QTF = ((k3_ + 1.0f) * group_qtw[g]) / (k3_ + group_qtw[g]);
+
+            score += TF * IDF * QTF;
+        }
+
+        results.emplace(cur_doc, score);
+        ++candidates;
+        cur_doc = next_doc;
+        next_doc = doc_id{ctx.idx.num_docs()};
+    }
+
+    score_timer.stop();
+    query_stats::record_count(query_stats::counter::candidates, candidates);
+
+    query_stats::scoped_timer heap_timer{query_stats::phase::heap};
+    return results.extract_top();
+}
+
+template <>
+std::unique_ptr<ranker> make_ranker<okapi_bm25f>(const cpptoml::table& config)
+{
+    std::vector<okapi_bm25f::field_weight> fields;
+    if (auto field_cfgs = config.get_table_array("fields"))
+    {
+        for (const auto& field_cfg : field_cfgs->get())
+        {
+            auto field = field_cfg->get_as<std::string>("field");
+            if (!field)
+                throw ranker_exception{"bm25f fields entry needs a field"};
+            auto weight = field_cfg->get_as<double>("weight").value_or(1.0);
+            if (weight < 0)
+                throw ranker_exception{"bm25f field weights must be >= 0"};
+            fields.push_back({*field, static_cast<float>(weight)});
+        }
+    }
+    if (fields.empty())
+        throw ranker_exception{"bm25f needs at least one [[ranker.fields]]"};
+
+    auto content_weight = config.get_as<double>("content-weight")
+                              .value_or(okapi_bm25f::default_content_weight);
+    auto k1 = config.get_as<double>("k1").value_or(okapi_bm25f::default_k1);
+    auto b = config.get_as<double>("b").value_or(okapi_bm25f::default_b);
+    auto k3 = config.get_as<double>("k3").value_or(okapi_bm25f::default_k3);
+
+    if (content_weight < 0)
+        throw ranker_exception{"bm25f content-weight must be >= 0"};
+
+    if (k1 < 0)
+        throw ranker_exception{"bm25f k1 must be >= 0"};
+
+    if (k3 < 0)
+        throw ranker_exception{"bm25f k3 must be >= 0"};
+
+    if (b < 0 || b > 1)
+        throw ranker_exception{"bm25f b must be on [0,1]"};
+
+    return make_unique<okapi_bm25f>(std::move(fields), content_weight, k1, b,
+                                    k3);
+}
+}
+}
@@ -45,6 +45,18 @@ float pivoted_length::score_one(const score_data& sd)
     return TF / norm * sd.query_term_weight * IDF;
 }
 
+float pivoted_length::score_upper_bound(const score_data& sd)
+{
+    return score_one(sd);
+}
+
+std::vector<search_result>
+pivoted_length::rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                                const filter_function_type& filter)
+{
+    return detail::daat_rank(*this, ctx, num_results, filter);
+}
+
 template <>
 std::unique_ptr<ranker>
     make_ranker<pivoted_length>(const cpptoml::table& config)
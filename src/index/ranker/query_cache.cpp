@@ -0,0 +1,94 @@
+/**
+ * @file query_cache.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "meta/hashing/hash.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/query_cache.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/// fixed seed so fingerprints are stable within a process
+const constexpr uint64_t fingerprint_seed = 0x2b6ac3f55ad41bc9ULL;
+}
+
+query_cache::query_cache(uint64_t max_size, std::chrono::seconds ttl)
+    : cache_{max_size}, ttl_{ttl}
+{
+    // nothing
+}
+
+uint64_t query_cache::fingerprint(ranker& r, inverted_index& idx,
+                                  const corpus::document& query,
+                                  uint64_t num_results) const
+{
+    // normalize the query to its analyzed term multiset, sorted so that
+    // any query tokenizing to the same bag of terms shares a fingerprint
+    std::vector<std::pair<std::string, uint64_t>> terms;
+    for (const auto& count : idx.tokenize(query))
+        terms.emplace_back(count.key(), count.value());
+    std::sort(terms.begin(), terms.end());
+
+    // the ranker's id and parameters, as written by its save() routine
+    std::ostringstream params;
+    r.save(params);
+
+    using hash_algorithm = hashing::default_hasher<8>::type;
+    hash_algorithm h{fingerprint_seed};
+    using hashing::hash_append;
+    hash_append(h, terms);
+    hash_append(h, params.str());
+    hash_append(h, num_results);
+    return static_cast<uint64_t>(static_cast<std::size_t>(h));
+}
+
+std::vector<search_result> query_cache::score(ranker& r, inverted_index& idx,
+                                              const corpus::document& query,
+                                              uint64_t num_results)
+{
+    auto key = fingerprint(r, idx, query, num_results);
+    auto generation = generation_.load();
+    auto now = std::chrono::steady_clock::now();
+
+    if (auto cached = cache_.find(key))
+    {
+        if ((*cached)->generation == generation && now < (*cached)->expires)
+        {
+            ++hits_;
+            return (*cached)->results;
+        }
+    }
+
+    ++misses_;
+    auto results = r.score(idx, query, num_results);
+    auto ent = std::make_shared<const entry>(
+        entry{results, generation, now + ttl_});
+    cache_.insert(key, std::move(ent));
+    return results;
+}
+
+void query_cache::bump_generation()
+{
+    ++generation_;
+}
+
+uint64_t query_cache::hits() const
+{
+    return hits_.load();
+}
+
+uint64_t query_cache::misses() const
+{
+    return misses_.load();
+}
+}
+}
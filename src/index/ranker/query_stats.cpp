@@ -0,0 +1,213 @@
+/**
+ * @file query_stats.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "meta/index/ranker/query_stats.h"
+
+namespace meta
+{
+namespace index
+{
+
+std::atomic<bool> query_stats::enabled_{false};
+
+namespace
+{
+
+/**
+ * The per-thread statistics store. Recording touches only this thread's
+ * atomics (relaxed; there is no ordering to maintain between counters),
+ * so the hot path never takes a lock. The global registry mutex is taken
+ * only on thread birth/death and by collect()/reset().
+ */
+struct collector
+{
+    std::array<std::array<std::atomic<uint64_t>,
+                          query_stats::histogram::num_buckets>,
+               query_stats::num_phases>
+        buckets;
+    std::array<std::atomic<uint64_t>, query_stats::num_phases> totals;
+    std::array<std::atomic<uint64_t>, query_stats::num_counters> counters;
+
+    collector();
+    ~collector();
+
+    void zero()
+    {
+        for (auto& phase : buckets)
+            for (auto& bucket : phase)
+                bucket.store(0, std::memory_order_relaxed);
+        for (auto& total : totals)
+            total.store(0, std::memory_order_relaxed);
+        for (auto& count : counters)
+            count.store(0, std::memory_order_relaxed);
+    }
+};
+
+struct registry
+{
+    static registry& get()
+    {
+        static registry inst;
+        return inst;
+    }
+
+    std::mutex mutables;
+    std::vector<collector*> collectors;
+    /// statistics salvaged from collectors of threads that have exited
+    query_stats::snapshot retired;
+};
+
+void accumulate(query_stats::snapshot& snap, const collector& coll)
+{
+    for (std::size_t p = 0; p < query_stats::num_phases; ++p)
+    {
+        auto& hist = snap.phases[p];
+        for (std::size_t b = 0; b < query_stats::histogram::num_buckets; ++b)
+        {
+            auto count = coll.buckets[p][b].load(std::memory_order_relaxed);
+            hist.buckets[b] += count;
+            hist.count += count;
+        }
+        hist.total += coll.totals[p].load(std::memory_order_relaxed);
+    }
+    for (std::size_t c = 0; c < query_stats::num_counters; ++c)
+        snap.counters[c] += coll.counters[c].load(std::memory_order_relaxed);
+}
+
+collector::collector()
+{
+    zero();
+    auto& reg = registry::get();
+    std::lock_guard<std::mutex> lock{reg.mutables};
+    reg.collectors.push_back(this);
+}
+
+collector::~collector()
+{
+    auto& reg = registry::get();
+    std::lock_guard<std::mutex> lock{reg.mutables};
+    accumulate(reg.retired, *this);
+    reg.collectors.erase(std::remove(reg.collectors.begin(),
+                                     reg.collectors.end(), this),
+                         reg.collectors.end());
+}
+
+collector& local_collector()
+{
+    static thread_local collector coll;
+    return coll;
+}
+
+std::size_t bucket_for(uint64_t usecs)
+{
+    std::size_t bucket = 0;
+    while (usecs > 1 && bucket + 1 < query_stats::histogram::num_buckets)
+    {
+        usecs >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+}
+
+query_stats::histogram::histogram() : count{0}, total{0}
+{
+    buckets.fill(0);
+}
+
+void query_stats::histogram::add(uint64_t usecs)
+{
+    ++buckets[bucket_for(usecs)];
+    ++count;
+    total += usecs;
+}
+
+void query_stats::histogram::merge(const histogram& other)
+{
+    for (std::size_t b = 0; b < num_buckets; ++b)
+        buckets[b] += other.buckets[b];
+    count += other.count;
+    total += other.total;
+}
+
+uint64_t query_stats::histogram::quantile(double q) const
+{
+    if (count == 0)
+        return 0;
+
+    auto rank = static_cast<uint64_t>(q * count);
+    uint64_t seen = 0;
+    for (std::size_t b = 0; b < num_buckets; ++b)
+    {
+        seen += buckets[b];
+        if (seen > rank)
+            return uint64_t{1} << (b + 1);
+    }
+    return uint64_t{1} << num_buckets;
+}
+
+query_stats::snapshot::snapshot()
+{
+    counters.fill(0);
+}
+
+void query_stats::enable()
+{
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void query_stats::disable()
+{
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+void query_stats::record_time(phase p, uint64_t usecs)
+{
+    if (!enabled())
+        return;
+
+    auto& coll = local_collector();
+    auto idx = static_cast<std::size_t>(p);
+    coll.buckets[idx][bucket_for(usecs)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+    coll.totals[idx].fetch_add(usecs, std::memory_order_relaxed);
+}
+
+void query_stats::record_count(counter c, uint64_t num /* = 1 */)
+{
+    if (!enabled())
+        return;
+
+    auto& coll = local_collector();
+    coll.counters[static_cast<std::size_t>(c)].fetch_add(
+        num, std::memory_order_relaxed);
+}
+
+auto query_stats::collect() -> snapshot
+{
+    auto& reg = registry::get();
+    std::lock_guard<std::mutex> lock{reg.mutables};
+
+    auto snap = reg.retired;
+    for (const auto* coll : reg.collectors)
+        accumulate(snap, *coll);
+    return snap;
+}
+
+void query_stats::reset()
+{
+    auto& reg = registry::get();
+    std::lock_guard<std::mutex> lock{reg.mutables};
+
+    reg.retired = snapshot{};
+    for (auto* coll : reg.collectors)
+        coll->zero();
+}
+}
+}
@@ -4,12 +4,17 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
 #include "meta/corpus/document.h"
 #include "meta/index/inverted_index.h"
 #include "meta/index/postings_data.h"
 #include "meta/index/ranker/ranker.h"
 #include "meta/index/score_data.h"
 #include "meta/util/fixed_heap.h"
+#include "meta/util/profile.h"
 
 namespace meta
 {
@@ -25,19 +30,418 @@ ranker::score(inverted_index& idx, const corpus::document& query,
     return score(idx, counts.begin(), counts.end(), num_results, filter);
 }
 
+std::vector<search_result>
+ranker::score(inverted_index& idx,
+              const std::vector<std::pair<term_id, float>>& query,
+              uint64_t num_results /* = 10 */,
+              const filter_function_type& filter /* return true */)
+{
+    return score(idx, query.begin(), query.end(), num_results, filter);
+}
+
+std::vector<search_result>
+ranker::score(inverted_index& idx,
+              const std::vector<std::pair<term_id, float>>& query, scratch& s,
+              uint64_t num_results /* = 10 */,
+              const filter_function_type& filter /* return true */)
+{
+    return score(idx, query.begin(), query.end(), s, num_results, filter);
+}
+
+std::vector<search_result> ranker::score(inverted_index& idx,
+                                         const corpus::document& query,
+                                         const doc_set& filter,
+                                         uint64_t num_results /* = 10 */)
+{
+    query_stats::scoped_timer total{query_stats::phase::total};
+    query_stats::record_count(query_stats::counter::queries);
+
+    auto counts = idx.tokenize(query);
+
+    query_stats::scoped_timer fetch{query_stats::phase::fetch};
+    ranker_context ctx{idx, counts.begin(), counts.end(), passthrough};
+    ctx.pushdown = &filter;
+
+    // align every cursor with the filter set before ranking begins
+    ctx.cur_doc = doc_id{idx.num_docs()};
+    for (auto& pc : ctx.postings)
+    {
+        while (pc.begin != pc.end && !filter.contains(pc.begin->first))
+            pc.begin.skip_to(filter.next_geq(pc.begin->first));
+
+        if (pc.begin != pc.end && pc.begin->first < ctx.cur_doc)
+            ctx.cur_doc = pc.begin->first;
+    }
+    fetch.stop();
+
+    filter_function_type callback
+        = [&filter](doc_id d_id) { return filter.contains(d_id); };
+    return rank(ctx, num_results, callback);
+}
+
+namespace detail
+{
+void apply_budget(ranker_context& ctx, score_budget& budget)
+{
+    budget.degraded = false;
+
+    if (budget.max_postings > 0 && ctx.postings.size() > 1)
+    {
+        // rarest first: when lists must be shed, the high-IDF terms
+        // are the ones worth spending the budget on
+        std::sort(ctx.postings.begin(), ctx.postings.end(),
+                  [](const detail::postings_context& lhs,
+                     const detail::postings_context& rhs) {
+                      return lhs.doc_count < rhs.doc_count;
+                  });
+
+        // shed whole lists once their cumulative length exceeds the
+        // budget, always keeping at least the rarest term
+        uint64_t cumulative = 0;
+        std::size_t keep = 0;
+        for (; keep < ctx.postings.size(); ++keep)
+        {
+            cumulative += ctx.postings[keep].doc_count;
+            if (keep > 0 && cumulative > budget.max_postings)
+                break;
+        }
+        if (keep < ctx.postings.size())
+        {
+            ctx.postings.erase(ctx.postings.begin()
+                                   + static_cast<std::ptrdiff_t>(keep),
+                               ctx.postings.end());
+            budget.degraded = true;
+        }
+
+        // the first candidate may have lived only in a shed list
+        ctx.cur_doc = doc_id{ctx.idx.num_docs()};
+        for (const auto& pc : ctx.postings)
+        {
+            if (pc.begin != pc.end && pc.begin->first < ctx.cur_doc)
+                ctx.cur_doc = pc.begin->first;
+        }
+    }
+
+    if (budget.deadline.count() > 0)
+        ctx.stop_time = std::chrono::steady_clock::now() + budget.deadline;
+
+    ctx.budget = &budget;
+}
+}
+
+std::vector<search_result> ranker::score(inverted_index& idx,
+                                         const corpus::document& query,
+                                         score_budget& budget,
+                                         uint64_t num_results /* = 10 */,
+                                         const filter_function_type& filter
+                                         /* return true */)
+{
+    query_stats::scoped_timer total{query_stats::phase::total};
+    query_stats::record_count(query_stats::counter::queries);
+
+    auto counts = idx.tokenize(query);
+
+    query_stats::scoped_timer fetch{query_stats::phase::fetch};
+    ranker_context ctx{idx, counts.begin(), counts.end(), filter};
+    detail::apply_budget(ctx, budget);
+    fetch.stop();
+
+    return rank(ctx, num_results, filter);
+}
+
+std::vector<search_result> ranker::score(inverted_index& idx,
+                                         const corpus::document& query,
+                                         const corpus_stats& stats,
+                                         uint64_t num_results /* = 10 */)
+{
+    query_stats::scoped_timer total{query_stats::phase::total};
+    query_stats::record_count(query_stats::counter::queries);
+
+    auto counts = idx.tokenize(query);
+
+    query_stats::scoped_timer fetch{query_stats::phase::fetch};
+    ranker_context ctx{idx, counts.begin(), counts.end(), passthrough};
+    ctx.global = &stats;
+
+    // replace each term's shard-local statistics with the aggregates
+    for (auto& pc : ctx.postings)
+    {
+        auto it = stats.terms.find(idx.term_text(pc.t_id));
+        if (it != stats.terms.end())
+        {
+            pc.doc_count = it->second.doc_count;
+            pc.corpus_term_count = it->second.corpus_term_count;
+        }
+    }
+    fetch.stop();
+
+    filter_function_type filter = passthrough;
+    return rank(ctx, num_results, filter);
+}
+
 std::vector<search_result>
 ranking_function::rank(ranker_context& ctx, uint64_t num_results,
                        const filter_function_type& filter)
 {
-    score_data sd{ctx.idx, ctx.idx.avg_doc_length(), ctx.idx.num_docs(),
-                  ctx.idx.total_corpus_terms(), ctx.query_length};
+    // the per-phase breakdown lives in query_stats; this site puts the
+    // whole of ranking alongside the other hooks in profile reports
+    META_PROFILE_SCOPE("ranker::rank");
+    if (wand_pruning_)
+        return wand_rank(ctx, num_results, filter);
+    return rank_exhaustive(ctx, num_results, filter);
+}
+
+std::vector<search_result>
+ranking_function::rank_exhaustive(ranker_context& ctx, uint64_t num_results,
+                                  const filter_function_type& filter)
+{
+    return detail::daat_rank(*this, ctx, num_results, filter);
+}
+
+float ranking_function::initial_score(const score_data&) const
+{
+    return 0.0;
+}
+
+float ranking_function::score_upper_bound(const score_data&)
+{
+    return std::numeric_limits<float>::infinity();
+}
+
+bool ranking_function::wand_pruning() const
+{
+    return wand_pruning_;
+}
+
+void ranking_function::wand_pruning(bool enable)
+{
+    wand_pruning_ = enable;
+}
+
+namespace
+{
+/// fills in the term-dependent fields of a score_data
+void set_term(score_data& sd, const detail::postings_context& pc)
+{
+    sd.t_id = pc.t_id;
+    sd.query_term_weight = pc.query_term_weight;
+    sd.doc_count = pc.doc_count;
+    sd.corpus_term_count = pc.corpus_term_count;
+}
+
+/// fills in the best-case document statistics for a given count bound
+void set_best_case(score_data& sd, uint64_t max_count)
+{
+    sd.doc_term_count = max_count;
+    // the smallest document that could contain the term this often
+    sd.doc_size = max_count;
+    sd.doc_unique_terms = 1;
+}
+}
+
+std::vector<search_result>
+ranking_function::wand_rank(ranker_context& ctx, uint64_t num_results,
+                            const filter_function_type& filter)
+{
+    query_stats::scoped_timer score_timer{query_stats::phase::score};
+    uint64_t candidates = 0;
+    uint64_t postings_scored = 0;
+
+    score_data sd{ctx.idx,
+                  ctx.global ? ctx.global->avg_doc_length()
+                             : ctx.idx.avg_doc_length(),
+                  ctx.global ? ctx.global->num_docs : ctx.idx.num_docs(),
+                  ctx.global ? ctx.global->total_corpus_terms
+                             : ctx.idx.total_corpus_terms(),
+                  ctx.query_length};
 
+    // with a scratch, the heap adopts the pooled result buffer; the
+    // extracted results hand it back to the caller
+    std::vector<search_result> heap_buffer;
+    if (ctx.scratch)
+        heap_buffer = std::move(ctx.scratch->results);
     auto results = util::make_fixed_heap<search_result>(
-        num_results, [](const search_result& a, const search_result& b) {
+        num_results,
+        [](const search_result& a, const search_result& b) {
             // comparison is reversed since we want a min-heap
             return a.score > b.score;
-        });
+        },
+        std::move(heap_buffer));
 
+    // upper bounds on each term's contribution to any document's score;
+    // the bookkeeping vectors come from the scratch when one is set
+    std::vector<float> local_bounds;
+    std::vector<std::size_t> local_order;
+    auto& bounds = ctx.scratch ? ctx.scratch->bounds : local_bounds;
+    auto& order = ctx.scratch ? ctx.scratch->order : local_order;
+    bounds.clear();
+    bounds.reserve(ctx.postings.size());
+    for (const auto& pc : ctx.postings)
+    {
+        set_term(sd, pc);
+        set_best_case(sd, pc.max_tf);
+        bounds.push_back(score_upper_bound(sd));
+    }
+
+    order.resize(ctx.postings.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+
+    while (true)
+    {
+        if (ctx.budget
+            && detail::budget_exhausted(ctx, postings_scored, candidates))
+            break;
+
+        // drop exhausted terms and order the rest by current document
+        order.erase(std::remove_if(order.begin(), order.end(),
+                                   [&](std::size_t i) {
+                                       return ctx.postings[i].begin
+                                              == ctx.postings[i].end;
+                                   }),
+                    order.end());
+        if (order.empty())
+            break;
+
+        std::sort(order.begin(), order.end(),
+                  [&](std::size_t lhs, std::size_t rhs) {
+                      return ctx.postings[lhs].begin->first
+                             < ctx.postings[rhs].begin->first;
+                  });
+
+        auto threshold = results.full()
+                             ? results.top().score
+                             : std::numeric_limits<float>::lowest();
+
+        // find the pivot: the first term whose accumulated upper bounds
+        // could push a document past the threshold
+        auto acc = 0.0f;
+        auto pivot = order.size();
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            acc += bounds[order[i]];
+            if (acc > threshold)
+            {
+                pivot = i;
+                break;
+            }
+        }
+        // no remaining document can enter the current top k
+        if (pivot == order.size())
+            break;
+
+        auto pivot_doc = ctx.postings[order[pivot]].begin->first;
+        if (!filter(pivot_doc))
+        {
+            // with a pushdown set, jump straight to the next document
+            // the filter accepts instead of the next posting
+            auto target = ctx.pushdown
+                              ? ctx.pushdown->next_geq(doc_id{pivot_doc + 1})
+                              : doc_id{pivot_doc + 1};
+            for (std::size_t i = 0; i <= pivot; ++i)
+                ctx.postings[order[i]].begin.skip_to(target);
+            continue;
+        }
+
+        if (ctx.postings[order[0]].begin->first != pivot_doc)
+        {
+            // advance the lagging terms up to the pivot document
+            for (std::size_t i = 0; i < pivot; ++i)
+                ctx.postings[order[i]].begin.skip_to(pivot_doc);
+            continue;
+        }
+
+        // every term up to the pivot sits on pivot_doc; refine the bound
+        // with the block-local maxima before fully scoring (Block-Max-WAND)
+        if (results.full())
+        {
+            auto block_bound = 0.0f;
+            for (std::size_t i = 0; i <= pivot; ++i)
+            {
+                const auto& pc = ctx.postings[order[i]];
+                auto block_max = pc.begin.block_max_count();
+                if (block_max == 0)
+                {
+                    block_bound += bounds[order[i]];
+                    continue;
+                }
+                set_term(sd, pc);
+                set_best_case(sd, block_max);
+                block_bound
+                    += std::min(bounds[order[i]], score_upper_bound(sd));
+            }
+
+            if (block_bound <= threshold)
+            {
+                for (std::size_t i = 0; i <= pivot; ++i)
+                    ctx.postings[order[i]].begin.skip_to(
+                        doc_id{pivot_doc + 1});
+                continue;
+            }
+        }
+
+        sd.d_id = pivot_doc;
+        sd.doc_size = ctx.idx.doc_size(pivot_doc);
+        sd.doc_unique_terms = ctx.idx.unique_terms(pivot_doc);
+
+        auto score = initial_score(sd);
+        for (std::size_t i = 0; i <= pivot; ++i)
+        {
+            auto& pc = ctx.postings[order[i]];
+            set_term(sd, pc);
+            sd.doc_term_count = pc.begin->second;
+            score += score_one(sd);
+            ++postings_scored;
+
+            // advance over this position in the current postings context
+            // until the next valid document
+            advance(pc, filter, ctx.pushdown);
+        }
+        results.emplace(pivot_doc, score);
+        ++candidates;
+    }
+
+    score_timer.stop();
+    query_stats::record_count(query_stats::counter::candidates, candidates);
+
+    query_stats::scoped_timer heap_timer{query_stats::phase::heap};
+    return results.extract_top();
+}
+
+namespace
+{
+/// reversed comparison: fixed_heap keeps the top k as a min-heap
+struct result_min_heap_cmp
+{
+    bool operator()(const search_result& a, const search_result& b) const
+    {
+        return a.score > b.score;
+    }
+};
+}
+
+std::vector<std::vector<search_result>>
+score_multi(ranker_context& ctx,
+            const std::vector<ranking_function*>& rankers,
+            uint64_t num_results,
+            const ranker::filter_function_type& filter)
+{
+    query_stats::scoped_timer score_timer{query_stats::phase::score};
+    uint64_t candidates = 0;
+
+    score_data sd{ctx.idx,
+                  ctx.global ? ctx.global->avg_doc_length()
+                             : ctx.idx.avg_doc_length(),
+                  ctx.global ? ctx.global->num_docs : ctx.idx.num_docs(),
+                  ctx.global ? ctx.global->total_corpus_terms
+                             : ctx.idx.total_corpus_terms(),
+                  ctx.query_length};
+
+    std::vector<util::fixed_heap<search_result, result_min_heap_cmp>> results;
+    results.reserve(rankers.size());
+    for (std::size_t r = 0; r < rankers.size(); ++r)
+        results.emplace_back(num_results, result_min_heap_cmp{});
+
+    std::vector<float> scores(rankers.size());
     doc_id next_doc{ctx.idx.num_docs()};
     while (ctx.cur_doc < ctx.idx.num_docs())
     {
@@ -45,7 +449,9 @@ ranking_function::rank(ranker_context& ctx, uint64_t num_results,
         sd.doc_size = ctx.idx.doc_size(ctx.cur_doc);
         sd.doc_unique_terms = ctx.idx.unique_terms(ctx.cur_doc);
 
-        auto score = initial_score(sd);
+        for (std::size_t r = 0; r < rankers.size(); ++r)
+            scores[r] = rankers[r]->initial_score(sd);
+
         for (auto& pc : ctx.postings)
         {
             if (pc.begin == pc.end)
@@ -53,21 +459,17 @@ ranking_function::rank(ranker_context& ctx, uint64_t num_results,
 
             if (pc.begin->first == ctx.cur_doc)
             {
-                // set up this term
-                sd.t_id = pc.t_id;
-                sd.query_term_weight = pc.query_term_weight;
-                sd.doc_count = pc.doc_count;
-                sd.corpus_term_count = pc.corpus_term_count;
+                // set up this term once; every ranker scores against the
+                // same decoded posting
+                set_term(sd, pc);
                 sd.doc_term_count = pc.begin->second;
 
-                score += score_one(sd);
+                for (std::size_t r = 0; r < rankers.size(); ++r)
+                    scores[r] += rankers[r]->score_one(sd);
 
                 // advance over this position in the current postings context
                 // until the next valid document
-                do
-                {
-                    ++pc.begin;
-                } while (pc.begin != pc.end && !filter(pc.begin->first));
+                advance(pc, filter, ctx.pushdown);
             }
 
             if (pc.begin != pc.end)
@@ -79,17 +481,40 @@ ranking_function::rank(ranker_context& ctx, uint64_t num_results,
             }
         }
 
-        results.emplace(ctx.cur_doc, score);
+        for (std::size_t r = 0; r < rankers.size(); ++r)
+            results[r].emplace(ctx.cur_doc, scores[r]);
+        ++candidates;
         ctx.cur_doc = next_doc;
         next_doc = doc_id{ctx.idx.num_docs()};
     }
 
-    return results.extract_top();
+    score_timer.stop();
+    query_stats::record_count(query_stats::counter::candidates, candidates);
+
+    query_stats::scoped_timer heap_timer{query_stats::phase::heap};
+    std::vector<std::vector<search_result>> all_results;
+    all_results.reserve(rankers.size());
+    for (auto& heap : results)
+        all_results.emplace_back(heap.extract_top());
+    return all_results;
 }
 
-float ranking_function::initial_score(const score_data&) const
+std::vector<std::vector<search_result>>
+score_multi(inverted_index& idx, const corpus::document& query,
+            const std::vector<ranking_function*>& rankers,
+            uint64_t num_results /* = 10 */,
+            const ranker::filter_function_type& filter /* return true */)
 {
-    return 0.0;
+    query_stats::scoped_timer total{query_stats::phase::total};
+    query_stats::record_count(query_stats::counter::queries);
+
+    auto counts = idx.tokenize(query);
+
+    query_stats::scoped_timer fetch{query_stats::phase::fetch};
+    ranker_context ctx{idx, counts.begin(), counts.end(), filter};
+    fetch.stop();
+
+    return score_multi(ctx, rankers, num_results, filter);
 }
 }
 }
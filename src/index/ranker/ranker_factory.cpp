@@ -28,6 +28,7 @@ ranker_factory::ranker_factory()
     reg<dirichlet_prior>();
     reg<jelinek_mercer>();
     reg<okapi_bm25>();
+    reg<okapi_bm25f>();
     reg<pivoted_length>();
     reg<kl_divergence_prf>();
     reg<rocchio>();
@@ -85,6 +86,7 @@ ranker_loader::ranker_loader()
     reg<dirichlet_prior>();
     reg<jelinek_mercer>();
     reg<okapi_bm25>();
+    reg<okapi_bm25f>();
     reg<pivoted_length>();
     reg<kl_divergence_prf>();
     reg<rocchio>();
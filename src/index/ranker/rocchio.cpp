@@ -7,6 +7,7 @@
 
 #include "meta/hashing/probe_map.h"
 #include "meta/index/forward_index.h"
+#include "meta/index/ranker/feedback.h"
 #include "meta/index/ranker/okapi_bm25.h"
 #include "meta/index/ranker/rocchio.h"
 #include "meta/index/score_data.h"
@@ -25,6 +26,7 @@ const constexpr float rocchio::default_alpha;
 const constexpr float rocchio::default_beta;
 const constexpr uint64_t rocchio::default_k;
 const constexpr uint64_t rocchio::default_max_terms;
+const constexpr uint64_t rocchio::default_cache_size;
 
 rocchio::rocchio(std::shared_ptr<forward_index> fwd)
     : fwd_{std::move(fwd)},
@@ -80,63 +82,81 @@ std::vector<search_result> rocchio::rank(ranker_context& ctx,
                                          uint64_t num_results,
                                          const filter_function_type& filter)
 {
-    auto fb_docs = initial_ranker_->rank(ctx, k_, filter);
-
-    // compute the centroid in both count-space and tf-idf space
-    hashing::probe_map<term_id, float> term_scores;
-    hashing::probe_map<term_id, float> centroid;
-
-    score_data sd{ctx.idx, ctx.idx.avg_doc_length(), ctx.idx.num_docs(),
-                  ctx.idx.total_corpus_terms(), 1.0f};
-    sd.query_term_weight = 1.0f;
-    for (const auto& sr : fb_docs)
+    // run the first pass, recording the candidate set so the second
+    // pass only has to touch documents matching the original query
+    doc_set candidates;
+    auto fb_docs
+        = feedback::initial_pass(*initial_ranker_, ctx, k_, filter, candidates);
+
+    // serve the feedback terms from the cache if this query (with these
+    // feedback documents) has been expanded before
+    auto key = feedback::fingerprint(ctx, fb_docs);
+    auto fb_terms = fb_cache_.find(key);
+    if (!fb_terms)
     {
-        sd.d_id = sr.d_id;
-        sd.doc_size = ctx.idx.doc_size(sd.d_id);
-        sd.doc_unique_terms = ctx.idx.unique_terms(sd.d_id);
+        // compute the centroid in both count-space and tf-idf space
+        hashing::probe_map<term_id, float> term_scores;
+        hashing::probe_map<term_id, float> centroid;
+
+        score_data sd{ctx.idx, ctx.idx.avg_doc_length(), ctx.idx.num_docs(),
+                      ctx.idx.total_corpus_terms(), 1.0f};
+        sd.query_term_weight = 1.0f;
+        for (const auto& sr : fb_docs)
+        {
+            sd.d_id = sr.d_id;
+            sd.doc_size = ctx.idx.doc_size(sd.d_id);
+            sd.doc_unique_terms = ctx.idx.unique_terms(sd.d_id);
+
+            auto stream = *fwd_->stream_for(sd.d_id);
+            for (const auto& weight : stream)
+            {
+                sd.t_id = weight.first;
+                sd.doc_count = ctx.idx.doc_freq(sd.t_id);
+                sd.corpus_term_count = ctx.idx.total_num_occurences(sd.t_id);
+                sd.doc_term_count = static_cast<uint64_t>(weight.second);
+
+                auto& rnk = dynamic_cast<ranking_function&>(*initial_ranker_);
+                term_scores[sd.t_id] += rnk.score_one(sd) / k_;
+                centroid[sd.t_id] += weight.second / k_;
+            }
+        }
 
-        auto stream = *fwd_->stream_for(sd.d_id);
-        for (const auto& weight : stream)
+        // extract the top max_terms_ feedback terms according to their
+        // scores in tf-idf space, keeping their count-space weights
+        using scored_term = std::pair<term_id, float>;
+        auto heap = util::make_fixed_heap<scored_term>(
+            max_terms_, [](const scored_term& a, const scored_term& b) {
+                return a.second > b.second;
+            });
+        for (const auto& pr : term_scores)
         {
-            sd.t_id = weight.first;
-            sd.doc_count = ctx.idx.doc_freq(sd.t_id);
-            sd.corpus_term_count = ctx.idx.total_num_occurences(sd.t_id);
-            sd.doc_term_count = static_cast<uint64_t>(weight.second);
-
-            auto& rnk = dynamic_cast<ranking_function&>(*initial_ranker_);
-            term_scores[sd.t_id] += rnk.score_one(sd) / k_;
-            centroid[sd.t_id] += weight.second / k_;
+            heap.emplace(pr.key(), pr.value());
         }
-    }
 
-    // extract the top max_terms_ feedback terms according to their scores
-    // in tf-idf space
-    using scored_term = std::pair<term_id, float>;
-    auto heap = util::make_fixed_heap<scored_term>(
-        max_terms_, [](const scored_term& a, const scored_term& b) {
-            return a.second > b.second;
-        });
-    for (const auto& pr : term_scores)
-    {
-        heap.emplace(pr.key(), pr.value());
+        feedback_terms top;
+        top.reserve(max_terms_);
+        for (const auto& pr : heap.extract_top())
+        {
+            top.emplace_back(pr.first, centroid[pr.first]);
+        }
+        fb_terms = std::make_shared<const feedback_terms>(std::move(top));
+        fb_cache_.insert(key, *fb_terms);
     }
 
     // construct a new interpolated query in count-space from these top terms
     hashing::probe_map<term_id, float> new_query;
-    for (const auto& pr : heap.extract_top())
+    for (const auto& pr : **fb_terms)
     {
-        new_query[pr.first] += beta_ * centroid[pr.first];
+        new_query[pr.first] += beta_ * pr.second;
     }
     for (const auto& postings_ctx : ctx.postings)
     {
         new_query[postings_ctx.t_id] += alpha_ * postings_ctx.query_term_weight;
     }
 
-    // construct a new ranker_context from the new query
-    ranker_context new_ctx{ctx.idx, new_query.begin(), new_query.end(), filter};
-
-    //  return ranking results based on the new query
-    return initial_ranker_->rank(new_ctx, num_results, filter);
+    // rescore the expanded query over the first-pass candidates only
+    return feedback::second_pass(*initial_ranker_, ctx.idx, new_query,
+                                 candidates, num_results);
 }
 
 template <>
@@ -0,0 +1,409 @@
+/**
+ * @file segmented_index.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <queue>
+
+#include "meta/hashing/hash_storage.h"
+#include "meta/index/make_index.h"
+#include "meta/index/metadata_writer.h"
+#include "meta/index/postings_data.h"
+#include "meta/index/postings_file_writer.h"
+#include "meta/index/segmented_index.h"
+#include "meta/index/vocabulary_map_writer.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
+#include "meta/util/disk_vector.h"
+#include "meta/util/mapping.h"
+#include "meta/util/printing.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+std::string segment_name(uint64_t segment)
+{
+    return "segment-" + std::to_string(segment);
+}
+}
+
+segmented_index::segmented_index(const cpptoml::table& config)
+    : config_{config.clone()->as_table()}
+{
+    auto index = config.get_as<std::string>("index");
+    if (!index)
+        throw exception{"index name missing from configuration file"};
+    prefix_ = *index;
+
+    filesystem::make_directories(prefix_);
+    load_segments();
+}
+
+void segmented_index::load_segments()
+{
+    uint64_t num_segments = 0;
+    {
+        std::ifstream manifest{prefix_ + "/segments.bin", std::ios::binary};
+        if (manifest)
+            io::packed::read(manifest, num_segments);
+    }
+
+    uint64_t offset = 0;
+    for (uint64_t segment = 0; segment < num_segments; ++segment)
+    {
+        auto seg
+            = make_index<inverted_index>(*segment_config(segment));
+        offsets_.push_back(offset);
+        offset += seg->num_docs();
+        segments_.emplace_back(std::move(seg));
+    }
+}
+
+std::shared_ptr<cpptoml::table>
+segmented_index::segment_config(uint64_t segment) const
+{
+    auto config = config_->clone()->as_table();
+    config->insert("index", prefix_ + "/" + segment_name(segment));
+    return config;
+}
+
+void segmented_index::append(corpus::corpus& docs)
+{
+    auto segment = segments_.size();
+    auto seg = make_index<inverted_index>(*segment_config(segment), docs);
+
+    offsets_.push_back(num_docs());
+    segments_.emplace_back(std::move(seg));
+
+    std::ofstream manifest{prefix_ + "/segments.bin", std::ios::binary};
+    io::packed::write(manifest, static_cast<uint64_t>(segments_.size()));
+}
+
+uint64_t segmented_index::num_docs() const
+{
+    if (segments_.empty())
+        return 0;
+    return offsets_.back() + segments_.back()->num_docs();
+}
+
+uint64_t segmented_index::num_segments() const
+{
+    return segments_.size();
+}
+
+corpus::metadata segmented_index::metadata(doc_id d_id) const
+{
+    // find the owning segment: the last offset not greater than d_id
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end(),
+                               static_cast<uint64_t>(d_id));
+    if (it == offsets_.begin())
+        throw exception{"document id out of range"};
+    auto segment = static_cast<std::size_t>(it - offsets_.begin()) - 1;
+
+    auto local = static_cast<uint64_t>(d_id) - offsets_[segment];
+    if (local >= segments_[segment]->num_docs())
+        throw exception{"document id out of range"};
+    return segments_[segment]->metadata(doc_id{local});
+}
+
+void segmented_index::optimize()
+{
+    if (segments_.size() <= 1 || num_docs() == 0)
+    {
+        LOG(info) << "Collection is already compact; nothing to optimize"
+                  << ENDLG;
+        return;
+    }
+
+    LOG(info) << "Optimizing " << segments_.size() << " segments into one"
+              << ENDLG;
+
+    auto tmp_dir = prefix_ + "/optimize-tmp";
+    auto out_dir = tmp_dir + "/inv";
+    filesystem::remove_all(tmp_dir);
+    if (!filesystem::make_directories(out_dir))
+        throw exception{"unable to create directory: " + out_dir};
+
+    {
+        std::ofstream config_file{out_dir + "/config.toml"};
+        config_file << *segment_config(0);
+    }
+
+    merge_postings(out_dir);
+    merge_metadata(out_dir);
+
+    // swap the compacted artifact in: drop the open segments, remove
+    // their directories, and promote the new build to segment 0
+    auto num_old = segments_.size();
+    segments_.clear();
+    offsets_.clear();
+    for (uint64_t segment = 0; segment < num_old; ++segment)
+        filesystem::remove_all(prefix_ + "/" + segment_name(segment));
+    filesystem::rename_file(tmp_dir, prefix_ + "/" + segment_name(0));
+
+    {
+        std::ofstream manifest{prefix_ + "/segments.bin", std::ios::binary};
+        io::packed::write(manifest, uint64_t{1});
+    }
+
+    load_segments();
+    LOG(info) << "Done optimizing: " << num_docs() << " documents, "
+              << segments_.front()->unique_terms() << " unique terms"
+              << ENDLG;
+}
+
+namespace
+{
+/**
+ * A cursor over one segment's vocabulary for the term-by-term merge;
+ * within a segment, term ids ascend in lexicographic term order.
+ */
+struct term_cursor
+{
+    std::size_t segment;
+    term_id t_id;
+    std::string term;
+};
+}
+
+void segmented_index::merge_postings(const std::string& out_dir) const
+{
+    auto greater = [](const term_cursor& a, const term_cursor& b) {
+        if (a.term != b.term)
+            return a.term > b.term;
+        return a.segment > b.segment;
+    };
+    using heap_type = std::priority_queue<term_cursor,
+                                          std::vector<term_cursor>,
+                                          decltype(greater)>;
+
+    auto fill = [&]() {
+        heap_type heap{greater};
+        for (std::size_t segment = 0; segment < segments_.size(); ++segment)
+        {
+            if (segments_[segment]->unique_terms() > 0)
+                heap.push({segment, term_id{0},
+                           segments_[segment]->term_text(term_id{0})});
+        }
+        return heap;
+    };
+
+    auto advance = [&](heap_type& heap, term_cursor cur) {
+        if (++cur.t_id < segments_[cur.segment]->unique_terms())
+        {
+            cur.term = segments_[cur.segment]->term_text(cur.t_id);
+            heap.push(std::move(cur));
+        }
+    };
+
+    // first pass: the postings writer needs the size of the vocabulary
+    // union up front
+    uint64_t unique_terms = 0;
+    {
+        auto heap = fill();
+        std::string last;
+        while (!heap.empty())
+        {
+            auto cur = heap.top();
+            heap.pop();
+            if (unique_terms == 0 || cur.term != last)
+            {
+                ++unique_terms;
+                last = cur.term;
+            }
+            advance(heap, std::move(cur));
+        }
+    }
+
+    // second pass: merge each term's postings across segments. Within a
+    // term the cursors pop in segment (and thus doc id offset) order, so
+    // the concatenated postings stay sorted and delta-compress from
+    // scratch under the block format
+    using index_pdata_type = inverted_index::index_pdata_type;
+    postings_file_writer<index_pdata_type> out{out_dir + "/postings.index",
+                                               unique_terms};
+    vocabulary_map_writer vocab{out_dir + "/termids.mapping"};
+
+    printing::progress progress{" > Merging postings: ", unique_terms};
+    uint64_t merged = 0;
+    auto heap = fill();
+    while (!heap.empty())
+    {
+        auto term = heap.top().term;
+        index_pdata_type::count_t counts;
+        while (!heap.empty() && heap.top().term == term)
+        {
+            auto cur = heap.top();
+            heap.pop();
+            auto stream = segments_[cur.segment]->stream_for(cur.t_id);
+            for (const auto& posting : *stream)
+            {
+                counts.emplace_back(doc_id{posting.first
+                                           + offsets_[cur.segment]},
+                                    posting.second);
+            }
+            advance(heap, std::move(cur));
+        }
+
+        progress(merged++);
+        vocab.insert(term);
+        index_pdata_type pdata{std::move(term)};
+        pdata.set_counts(std::move(counts));
+        out.write(pdata);
+    }
+}
+
+void segmented_index::merge_metadata(const std::string& out_dir) const
+{
+    auto total_docs = num_docs();
+
+    // the user-declared schema excludes the two mandatory fields
+    // (length and unique-terms), which the writer prepends itself
+    corpus::metadata::schema_type schema;
+    {
+        auto md = segments_.front()->metadata(doc_id{0});
+        const auto& full = md.schema();
+        schema.assign(full.begin() + 2, full.end());
+    }
+
+    metadata_writer mdata_writer{out_dir, total_docs, schema};
+    util::disk_vector<label_id> labels{out_dir + "/docs.labels", total_docs};
+    util::invertible_map<class_label, label_id> label_ids;
+
+    printing::progress progress{" > Merging metadata: ", total_docs};
+    doc_id global{0};
+    for (const auto& seg : segments_)
+    {
+        for (doc_id local{0}; local < seg->num_docs(); ++local)
+        {
+            progress(global);
+            auto md = seg->metadata(local);
+
+            std::vector<corpus::metadata::field> fields;
+            fields.reserve(schema.size());
+            for (const auto& info : schema)
+                fields.emplace_back(
+                    std::move(*md.get<corpus::metadata::field>(info.name)));
+
+            mdata_writer.write(global, seg->doc_size(local),
+                               seg->unique_terms(local), fields);
+
+            auto lbl = seg->label(local);
+            if (!label_ids.contains_key(lbl))
+            {
+                // label ids start at 1 for liblinear compatibility
+                label_ids.insert(
+                    lbl, label_id{static_cast<uint32_t>(label_ids.size() + 1)});
+            }
+            labels[global] = label_ids.get_value(lbl);
+            ++global;
+        }
+    }
+
+    map::save_mapping(label_ids, out_dir + "/labelids.mapping");
+}
+
+corpus_stats segmented_index::stats_for(const corpus::document& query)
+{
+    corpus_stats stats{};
+    for (const auto& seg : segments_)
+    {
+        stats.num_docs += seg->num_docs();
+        stats.total_corpus_terms += seg->total_corpus_terms();
+    }
+
+    if (segments_.empty())
+        return stats;
+
+    auto counts = segments_.front()->tokenize(query);
+    for (const auto& count : counts)
+    {
+        using kv_traits
+            = hashing::kv_traits<typename std::decay<decltype(count)>::type>;
+
+        const auto& term = kv_traits::key(count);
+        auto& term_stats = stats.terms[term];
+        for (const auto& seg : segments_)
+        {
+            auto stream = seg->stream_for(seg->get_term_id(term));
+            if (!stream)
+                continue;
+            term_stats.doc_count += stream->size();
+            term_stats.corpus_term_count += stream->total_counts();
+        }
+    }
+    return stats;
+}
+
+std::vector<search_result>
+segmented_index::merge_results(std::vector<std::vector<search_result>>& partials,
+                               uint64_t num_results) const
+{
+    std::vector<search_result> merged;
+    merged.reserve(num_results * partials.size());
+
+    for (std::size_t segment = 0; segment < partials.size(); ++segment)
+    {
+        for (const auto& result : partials[segment])
+            merged.emplace_back(doc_id{result.d_id + offsets_[segment]},
+                                result.score);
+    }
+
+    std::sort(merged.begin(), merged.end(),
+              [](const search_result& lhs, const search_result& rhs) {
+                  return lhs.score > rhs.score;
+              });
+    if (merged.size() > num_results)
+        merged.erase(merged.begin() + static_cast<std::ptrdiff_t>(num_results),
+                     merged.end());
+    return merged;
+}
+
+std::vector<search_result>
+segmented_index::score(ranker& r, const corpus::document& query,
+                       uint64_t num_results)
+{
+    auto stats = stats_for(query);
+
+    std::vector<std::vector<search_result>> partials(segments_.size());
+    for (std::size_t segment = 0; segment < segments_.size(); ++segment)
+        partials[segment]
+            = r.score(*segments_[segment], query, stats, num_results);
+
+    return merge_results(partials, num_results);
+}
+
+std::vector<search_result>
+segmented_index::score(ranker& r, const corpus::document& query,
+                       parallel::thread_pool& pool, uint64_t num_results)
+{
+    auto stats = stats_for(query);
+
+    std::vector<std::future<std::vector<search_result>>> futures;
+    futures.reserve(segments_.size());
+    for (std::size_t segment = 0; segment < segments_.size(); ++segment)
+    {
+        futures.emplace_back(pool.submit_task([&, segment]() {
+            return r.score(*segments_[segment], query, stats, num_results);
+        }));
+    }
+
+    std::vector<std::vector<search_result>> partials(segments_.size());
+    for (std::size_t segment = 0; segment < segments_.size(); ++segment)
+    {
+        // join through the pool in case we are ourselves a worker task
+        pool.wait(futures[segment]);
+        partials[segment] = futures[segment].get();
+    }
+
+    return merge_results(partials, num_results);
+}
+}
+}
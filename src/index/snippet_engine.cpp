@@ -0,0 +1,287 @@
+/**
+ * @file snippet_engine.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+#include "meta/index/disk_index.h"
+#include "meta/index/snippet_engine.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/// an input stream adapter for packed reads out of a memory mapped file
+struct char_input_stream
+{
+    char get()
+    {
+        return *input_++;
+    }
+
+    const char* input_;
+};
+
+bool is_word_char(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+char to_lower(char c)
+{
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+}
+
+snippet_engine::snippet_engine(disk_index& idx)
+    : idx_{idx},
+      offsets_{ensure_built(idx)},
+      index_{idx.index_name() + "/snippets.bin_index"}
+{
+    // nothing
+}
+
+std::string snippet_engine::ensure_built(disk_index& idx)
+{
+    auto blob_path = idx.index_name() + "/snippets.bin";
+    if (filesystem::file_exists(blob_path)
+        && filesystem::file_exists(blob_path + "_index"))
+        return blob_path;
+
+    std::ofstream blob{blob_path, std::ios::binary};
+    util::disk_vector<uint64_t> index{blob_path + "_index", idx.num_docs()};
+
+    uint64_t pos = 0;
+    for (uint64_t i = 0; i < idx.num_docs(); ++i)
+    {
+        index[i] = pos;
+
+        auto content = idx.metadata<std::string>(doc_id{i}, "content");
+        if (!content)
+        {
+            if (i == 0)
+                throw snippet_engine_exception{
+                    "snippets require an index with store-full-text = true"};
+            pos += io::packed::write(blob, uint64_t{0});
+            continue;
+        }
+
+        auto offsets = sentence_offsets(*content);
+        pos += io::packed::write(blob, static_cast<uint64_t>(offsets.size()));
+        uint64_t prev = 0;
+        for (auto off : offsets)
+        {
+            pos += io::packed::write(blob, off - prev);
+            prev = off;
+        }
+    }
+
+    return blob_path;
+}
+
+std::vector<uint64_t> snippet_engine::offsets_for(doc_id d_id) const
+{
+    char_input_stream stream{offsets_.begin() + index_[d_id]};
+
+    std::vector<uint64_t> offsets(io::packed::read<uint64_t>(stream));
+    uint64_t prev = 0;
+    for (auto& off : offsets)
+    {
+        prev += io::packed::read<uint64_t>(stream);
+        off = prev;
+    }
+    return offsets;
+}
+
+std::vector<uint64_t> snippet_engine::sentence_offsets(
+    util::string_view content)
+{
+    std::vector<uint64_t> offsets{0};
+
+    std::size_t i = 0;
+    while (i < content.size())
+    {
+        char c = content[i];
+        if (c == '.' || c == '!' || c == '?')
+        {
+            // consume the punctuation run and any closing marks
+            auto j = i + 1;
+            while (j < content.size()
+                   && (content[j] == '.' || content[j] == '!'
+                       || content[j] == '?' || content[j] == '"'
+                       || content[j] == '\'' || content[j] == ')'))
+                ++j;
+
+            if (j < content.size()
+                && std::isspace(static_cast<unsigned char>(content[j])))
+            {
+                while (j < content.size()
+                       && std::isspace(
+                              static_cast<unsigned char>(content[j])))
+                    ++j;
+                if (j < content.size())
+                    offsets.push_back(j);
+            }
+            i = j;
+        }
+        else if (c == '\n')
+        {
+            // a blank line always ends a sentence
+            auto j = i + 1;
+            while (j < content.size()
+                   && (content[j] == ' ' || content[j] == '\t'
+                       || content[j] == '\r'))
+                ++j;
+            if (j < content.size() && content[j] == '\n')
+            {
+                while (j < content.size()
+                       && std::isspace(
+                              static_cast<unsigned char>(content[j])))
+                    ++j;
+                if (j < content.size())
+                    offsets.push_back(j);
+                i = j;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    offsets.push_back(content.size());
+    return offsets;
+}
+
+snippet_engine::snippet snippet_engine::best_window(
+    util::string_view content, const std::vector<uint64_t>& offsets,
+    const std::vector<std::string>& terms, uint64_t window_size,
+    const std::string& pre, const std::string& post)
+{
+    if (offsets.size() < 2 || window_size == 0)
+        return {"", 0, 0, 0.0};
+
+    auto num_sentences = offsets.size() - 1;
+
+    std::string lower{content.to_string()};
+    std::transform(lower.begin(), lower.end(), lower.begin(), to_lower);
+
+    std::vector<std::string> lower_terms;
+    lower_terms.reserve(terms.size());
+    for (const auto& term : terms)
+    {
+        if (term.empty())
+            continue;
+        lower_terms.push_back(term);
+        std::transform(lower_terms.back().begin(), lower_terms.back().end(),
+                       lower_terms.back().begin(), to_lower);
+    }
+
+    // find every whole-word occurrence of a query term, in order
+    std::vector<std::pair<uint64_t, uint64_t>> matches; // (begin, length)
+    for (const auto& term : lower_terms)
+    {
+        auto from = std::string::size_type{0};
+        while ((from = lower.find(term, from)) != std::string::npos)
+        {
+            bool left_ok = from == 0 || !is_word_char(lower[from - 1]);
+            auto end = from + term.size();
+            bool right_ok = end == lower.size() || !is_word_char(lower[end]);
+            if (left_ok && right_ok)
+                matches.emplace_back(from, term.size());
+            ++from;
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+
+    // score each sentence: occurrences plus a bonus per distinct term
+    std::vector<double> scores(num_sentences, 0.0);
+    for (std::size_t s = 0; s < num_sentences; ++s)
+    {
+        std::size_t distinct = 0;
+        for (const auto& term : lower_terms)
+        {
+            bool found = false;
+            for (const auto& match : matches)
+            {
+                if (match.first >= offsets[s + 1])
+                    break;
+                if (match.first >= offsets[s] && match.second == term.size()
+                    && lower.compare(match.first, term.size(), term) == 0)
+                {
+                    found = true;
+                    scores[s] += 1.0;
+                }
+            }
+            if (found)
+                ++distinct;
+        }
+        scores[s] += distinct;
+    }
+
+    // best window of consecutive sentences, earliest on ties
+    std::size_t best_start = 0;
+    double best_score = -1.0;
+    for (std::size_t s = 0; s < num_sentences; ++s)
+    {
+        double window_score = 0.0;
+        for (std::size_t w = 0; w < window_size && s + w < num_sentences;
+             ++w)
+            window_score += scores[s + w];
+        if (window_score > best_score)
+        {
+            best_score = window_score;
+            best_start = s;
+        }
+    }
+
+    auto begin = offsets[best_start];
+    auto end = offsets[std::min<std::size_t>(best_start + window_size,
+                                             num_sentences)];
+
+    // highlight the window's matches (overlaps keep the first match)
+    std::string text;
+    auto cursor = begin;
+    for (const auto& match : matches)
+    {
+        if (match.first < cursor || match.first + match.second > end)
+            continue;
+        text.append(content.data() + cursor, match.first - cursor);
+        text += pre;
+        text.append(content.data() + match.first, match.second);
+        text += post;
+        cursor = match.first + match.second;
+    }
+    text.append(content.data() + cursor, end - cursor);
+
+    return {std::move(text), begin, end, best_score};
+}
+
+snippet_engine::snippet
+snippet_engine::best_snippet(doc_id d_id, const std::vector<std::string>& terms,
+                             uint64_t window_size /* = 2 */,
+                             const std::string& pre /* = "**" */,
+                             const std::string& post /* = "**" */) const
+{
+    auto content = idx_.metadata<std::string>(d_id, "content");
+    if (!content)
+        throw snippet_engine_exception{
+            "snippets require an index with store-full-text = true"};
+
+    return best_window(*content, offsets_for(d_id), terms, window_size, pre,
+                       post);
+}
+}
+}
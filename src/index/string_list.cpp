@@ -4,26 +4,120 @@
  */
 
 #include "meta/index/string_list.h"
+#include "meta/io/packed.h"
 
 namespace meta
 {
 namespace index
 {
 
+namespace
+{
+/**
+ * Minimal input stream over the mapped file for io::packed::read.
+ */
+struct char_input_stream
+{
+    char get()
+    {
+        return *input_++;
+    }
+
+    const char* input_;
+};
+}
+
+const uint64_t string_list::block_size;
+
 string_list::string_list(const std::string& path)
     : string_file_{path}, index_{path + "_index"}
 {
     // nothing
 }
 
-const char* string_list::at(uint64_t idx) const
+std::string string_list::at(uint64_t idx) const
+{
+    auto block = idx / block_size;
+    char_input_stream stream{string_file_.begin() + index_[block + 1]};
+
+    uint64_t len;
+    io::packed::read(stream, len);
+    std::string result{stream.input_, len};
+    stream.input_ += len;
+
+    for (uint64_t i = idx % block_size; i > 0; --i)
+    {
+        uint64_t lcp;
+        uint64_t suffix_len;
+        io::packed::read(stream, lcp);
+        io::packed::read(stream, suffix_len);
+        result.resize(lcp);
+        result.append(stream.input_, suffix_len);
+        stream.input_ += suffix_len;
+    }
+    return result;
+}
+
+util::string_view string_list::block_head(uint64_t block) const
+{
+    char_input_stream stream{string_file_.begin() + index_[block + 1]};
+    uint64_t len;
+    io::packed::read(stream, len);
+    return {stream.input_, len};
+}
+
+util::optional<uint64_t> string_list::find(util::string_view elem) const
 {
-    return string_file_.begin() + index_[idx];
+    if (size() == 0)
+        return util::nullopt;
+
+    // find the last block whose head is not greater than elem
+    auto num_blocks = (size() + block_size - 1) / block_size;
+    uint64_t lo = 0;
+    uint64_t hi = num_blocks - 1;
+    if (block_head(0) > elem)
+        return util::nullopt;
+    while (lo < hi)
+    {
+        auto mid = lo + (hi - lo + 1) / 2;
+        if (block_head(mid) <= elem)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    // decode the block, stopping as soon as we pass elem's spot
+    char_input_stream stream{string_file_.begin() + index_[lo + 1]};
+    uint64_t len;
+    io::packed::read(stream, len);
+    std::string current{stream.input_, len};
+    stream.input_ += len;
+
+    auto in_block = std::min(block_size, size() - lo * block_size);
+    for (uint64_t i = 0; i < in_block; ++i)
+    {
+        if (i > 0)
+        {
+            uint64_t lcp;
+            uint64_t suffix_len;
+            io::packed::read(stream, lcp);
+            io::packed::read(stream, suffix_len);
+            current.resize(lcp);
+            current.append(stream.input_, suffix_len);
+            stream.input_ += suffix_len;
+        }
+
+        if (current == elem)
+            return lo * block_size + i;
+        if (util::string_view{current} > elem)
+            break;
+    }
+    return util::nullopt;
 }
 
 uint64_t string_list::size() const
 {
-    return index_.size();
+    return index_[0];
 }
 }
 }
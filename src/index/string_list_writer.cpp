@@ -3,8 +3,11 @@
  * @author Chase Geigle
  */
 
-#include "meta/io/binary.h"
+#include <algorithm>
+
+#include "meta/index/string_list.h"
 #include "meta/index/string_list_writer.h"
+#include "meta/io/packed.h"
 
 namespace meta
 {
@@ -13,18 +16,22 @@ namespace index
 
 string_list_writer::string_list_writer(const std::string& path, uint64_t size)
     : string_file_{path},
-      write_pos_{0},
-      index_{path + "_index", size}
+      strings_(size),
+      index_{path + "_index",
+             (size + string_list::block_size - 1) / string_list::block_size
+                 + 1},
+      flushed_{false}
 {
-    // nothing
+    index_[0] = size;
 }
 
 string_list_writer::string_list_writer(string_list_writer&& other)
     : string_file_{std::move(other.string_file_)},
-      write_pos_{std::move(other.write_pos_)},
-      index_{std::move(other.index_)}
+      strings_{std::move(other.strings_)},
+      index_{std::move(other.index_)},
+      flushed_{other.flushed_}
 {
-    // nothing
+    other.flushed_ = true;
 }
 
 string_list_writer& string_list_writer::operator=(string_list_writer&& other)
@@ -32,18 +39,60 @@ string_list_writer& string_list_writer::operator=(string_list_writer&& other)
     if (this != &other)
     {
         string_file_ = std::move(other.string_file_);
-        write_pos_ = std::move(other.write_pos_);
+        strings_ = std::move(other.strings_);
         index_ = std::move(other.index_);
+        flushed_ = other.flushed_;
+        other.flushed_ = true;
     }
     return *this;
 }
 
+string_list_writer::~string_list_writer()
+{
+    if (!flushed_)
+        flush();
+}
+
 void string_list_writer::insert(uint64_t idx, const std::string& elem)
 {
     std::lock_guard<std::mutex> lock{mutex_};
-    index_[idx] = write_pos_;
-    io::write_binary(string_file_, elem);
-    write_pos_ += elem.length() + 1;
+    strings_[idx] = elem;
+}
+
+void string_list_writer::flush()
+{
+    flushed_ = true;
+
+    std::ostream& out = string_file_;
+    uint64_t write_pos = 0;
+    for (uint64_t idx = 0; idx < strings_.size(); ++idx)
+    {
+        const auto& elem = strings_[idx];
+        if (idx % string_list::block_size == 0)
+        {
+            // block head: stored whole
+            index_[idx / string_list::block_size + 1] = write_pos;
+            write_pos += io::packed::write(out, elem.size());
+            out.write(elem.data(), static_cast<std::streamsize>(elem.size()));
+            write_pos += elem.size();
+        }
+        else
+        {
+            // front-coded: shared prefix length with the predecessor,
+            // then the remaining suffix
+            const auto& prev = strings_[idx - 1];
+            auto limit = std::min(prev.size(), elem.size());
+            uint64_t lcp = 0;
+            while (lcp < limit && prev[lcp] == elem[lcp])
+                ++lcp;
+
+            write_pos += io::packed::write(out, lcp);
+            write_pos += io::packed::write(out, elem.size() - lcp);
+            out.write(elem.data() + lcp,
+                      static_cast<std::streamsize>(elem.size() - lcp));
+            write_pos += elem.size() - lcp;
+        }
+    }
 }
 }
 }
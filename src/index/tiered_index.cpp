@@ -0,0 +1,107 @@
+/**
+ * @file tiered_index.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+
+#include "meta/index/make_index.h"
+#include "meta/index/tiered_index.h"
+
+namespace meta
+{
+namespace index
+{
+
+tiered_index::tiered_index(const cpptoml::table& config)
+    : config_{config.clone()->as_table()}
+{
+    auto tiers = config.get_table_array("tiers");
+    if (!tiers)
+        throw exception{"tiers missing from configuration file"};
+
+    uint64_t offset = 0;
+    for (const auto& tier : tiers->get())
+    {
+        auto idx = make_index<inverted_index>(*tier_config(*tier));
+        offsets_.push_back(offset);
+        offset += idx->num_docs();
+        tiers_.emplace_back(std::move(idx));
+    }
+
+    if (tiers_.empty())
+        throw exception{"tiered index must have at least one tier"};
+}
+
+std::shared_ptr<cpptoml::table>
+tiered_index::tier_config(const cpptoml::table& tier) const
+{
+    auto index = tier.get_as<std::string>("index");
+    if (!index)
+        throw exception{"tier missing index name in configuration file"};
+
+    auto config = config_->clone()->as_table();
+    config->insert("index", *index);
+    return config;
+}
+
+uint64_t tiered_index::num_docs() const
+{
+    return offsets_.back() + tiers_.back()->num_docs();
+}
+
+uint64_t tiered_index::num_tiers() const
+{
+    return tiers_.size();
+}
+
+corpus::metadata tiered_index::metadata(doc_id d_id) const
+{
+    // find the owning tier: the last offset not greater than d_id
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end(),
+                               static_cast<uint64_t>(d_id));
+    if (it == offsets_.begin())
+        throw exception{"document id out of range"};
+    auto tier = static_cast<std::size_t>(it - offsets_.begin()) - 1;
+
+    auto local = static_cast<uint64_t>(d_id) - offsets_[tier];
+    if (local >= tiers_[tier]->num_docs())
+        throw exception{"document id out of range"};
+    return tiers_[tier]->metadata(doc_id{local});
+}
+
+std::vector<search_result> tiered_index::score(ranker& r,
+                                               const corpus::document& query,
+                                               uint64_t num_results,
+                                               float cutoff)
+{
+    std::vector<search_result> merged;
+
+    for (std::size_t tier = 0; tier < tiers_.size(); ++tier)
+    {
+        auto results = r.score(*tiers_[tier], query, num_results);
+        for (const auto& result : results)
+            merged.emplace_back(doc_id{result.d_id + offsets_[tier]},
+                                result.score);
+
+        // early exit: stop descending once we have k good results
+        auto good = static_cast<uint64_t>(
+            std::count_if(merged.begin(), merged.end(),
+                          [=](const search_result& res) {
+                              return res.score >= cutoff;
+                          }));
+        if (good >= num_results)
+            break;
+    }
+
+    std::sort(merged.begin(), merged.end(),
+              [](const search_result& lhs, const search_result& rhs) {
+                  return lhs.score > rhs.score;
+              });
+    if (merged.size() > num_results)
+        merged.erase(merged.begin() + static_cast<std::ptrdiff_t>(num_results),
+                     merged.end());
+    return merged;
+}
+}
+}
@@ -0,0 +1,297 @@
+/**
+ * @file bench_index.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "cpptoml.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/make_index.h"
+#include "meta/index/postings_inverter.h"
+#include "meta/io/filesystem.h"
+#include "meta/logging/logger.h"
+#include "meta/parallel/thread_pool.h"
+
+using namespace meta;
+
+namespace
+{
+
+/**
+ * Draws term ranks from a Zipfian distribution over the vocabulary, which
+ * mimics the skew of natural language far better than a uniform draw (and
+ * thus exercises the same hot postings lists the real indexer sees).
+ */
+class zipf_sampler
+{
+  public:
+    zipf_sampler(uint64_t vocab_size, double skew = 1.0)
+    {
+        cdf_.reserve(vocab_size);
+        double total = 0.0;
+        for (uint64_t rank = 1; rank <= vocab_size; ++rank)
+        {
+            total += 1.0 / std::pow(static_cast<double>(rank), skew);
+            cdf_.push_back(total);
+        }
+    }
+
+    template <class RandomEngine>
+    uint64_t operator()(RandomEngine& rng) const
+    {
+        std::uniform_real_distribution<double> dist{0.0, cdf_.back()};
+        auto it = std::upper_bound(cdf_.begin(), cdf_.end(), dist(rng));
+        return static_cast<uint64_t>(std::distance(cdf_.begin(), it));
+    }
+
+  private:
+    std::vector<double> cdf_;
+};
+
+/**
+ * @return a purely alphabetic surrogate "word" for a term rank, so the
+ * synthetic text survives the default filter chain (alpha + length
+ * filters) unmodified
+ */
+std::string term_word(uint64_t rank)
+{
+    std::string word;
+    do
+    {
+        word += static_cast<char>('a' + rank % 26);
+        rank /= 26;
+    } while (rank > 0);
+    // pad to the minimum token length accepted by the default chain
+    while (word.size() < 2)
+        word += 'a';
+    return word;
+}
+
+/**
+ * Generates the (sorted, unique) term counts for one synthetic document.
+ * Generation is seeded by doc id so every phase of the benchmark sees the
+ * same corpus.
+ */
+std::vector<std::pair<std::string, uint64_t>>
+make_doc(uint64_t d_id, uint64_t terms_per_doc, const zipf_sampler& zipf)
+{
+    std::mt19937_64 rng{d_id};
+    std::vector<std::string> samples(terms_per_doc);
+    for (auto& s : samples)
+        s = term_word(zipf(rng));
+    std::sort(samples.begin(), samples.end());
+
+    std::vector<std::pair<std::string, uint64_t>> counts;
+    for (auto& s : samples)
+    {
+        if (!counts.empty() && counts.back().first == s)
+            ++counts.back().second;
+        else
+            counts.emplace_back(std::move(s), 1);
+    }
+    return counts;
+}
+
+/**
+ * @return the peak resident set size of this process in kilobytes, or 0
+ * if the platform provides no way to query it
+ */
+uint64_t peak_rss_kb()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+    return 0;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+}
+
+/**
+ * Index-build benchmark harness. Drives postings_inverter directly with a
+ * synthetic Zipfian corpus to time the invert and merge phases in
+ * isolation, then runs a full end-to-end inverted_index build (analyzer
+ * chain included) over the same corpus written to disk as a line_corpus.
+ * Emits a single JSON object on stdout so results can be tracked release
+ * over release.
+ */
+int main(int argc, char* argv[])
+{
+    uint64_t num_docs = 100000;
+    uint64_t vocab_size = 100000;
+    uint64_t terms_per_doc = 150;
+    uint64_t num_threads = std::thread::hardware_concurrency();
+    uint64_t ram_budget_mb = 1024;
+
+    if (argc > 1 && std::string{argv[1]} == "--help")
+    {
+        std::cerr << "Usage:\t" << argv[0]
+                  << " [num-docs] [vocab-size] [terms-per-doc] [threads]"
+                     " [ram-budget-mb]"
+                  << std::endl;
+        return 1;
+    }
+
+    if (argc > 1)
+        num_docs = std::stoull(argv[1]);
+    if (argc > 2)
+        vocab_size = std::stoull(argv[2]);
+    if (argc > 3)
+        terms_per_doc = std::stoull(argv[3]);
+    if (argc > 4)
+        num_threads = std::stoull(argv[4]);
+    if (argc > 5)
+        ram_budget_mb = std::stoull(argv[5]);
+
+    logging::set_cerr_logging();
+
+    const std::string scratch = "bench-index-scratch";
+    filesystem::remove_all(scratch);
+    if (!filesystem::make_directories(scratch + "/bench"))
+    {
+        std::cerr << "Unable to create scratch directory: " << scratch
+                  << std::endl;
+        return 1;
+    }
+
+    zipf_sampler zipf{vocab_size};
+
+    // phase 1: drive the postings_inverter directly with pre-analyzed
+    // synthetic documents; this isolates the inversion machinery (buffer
+    // management, chunk flushing) from the analyzer stack
+    index::postings_inverter<index::inverted_index> inverter{scratch};
+    inverter.ram_budget(ram_budget_mb * 1024 * 1024);
+
+    uint64_t total_postings = 0;
+    auto invert_start = std::chrono::steady_clock::now();
+    {
+        std::atomic<uint64_t> postings{0};
+        parallel::thread_pool pool{num_threads};
+        std::vector<std::future<void>> futures;
+        auto docs_per_thread = (num_docs + num_threads - 1) / num_threads;
+        for (uint64_t t = 0; t < num_threads; ++t)
+        {
+            auto begin = t * docs_per_thread;
+            auto end = std::min(begin + docs_per_thread, num_docs);
+            futures.emplace_back(pool.submit_task([&, begin, end]() {
+                auto producer = inverter.make_producer();
+                uint64_t local = 0;
+                for (uint64_t d = begin; d < end; ++d)
+                {
+                    auto counts = make_doc(d, terms_per_doc, zipf);
+                    local += counts.size();
+                    producer(doc_id{d}, counts);
+                }
+                postings.fetch_add(local);
+            }));
+        }
+        for (auto& fut : futures)
+            fut.get();
+        total_postings = postings.load();
+    }
+    auto invert_seconds = seconds_since(invert_start);
+    auto flushes = inverter.size();
+
+    // phase 2: the multiway merge of the on-disk chunks
+    auto merge_start = std::chrono::steady_clock::now();
+    inverter.merge_chunks();
+    auto merge_seconds = seconds_since(merge_start);
+    auto unique_terms = inverter.unique_primary_keys();
+    auto postings_bytes = inverter.final_size();
+
+    // phase 3: a full end-to-end build over the same corpus serialized as
+    // a line_corpus, exercising tokenization, metadata and compression
+    {
+        std::ofstream corpus_file{scratch + "/bench/bench.dat"};
+        for (uint64_t d = 0; d < num_docs; ++d)
+        {
+            std::mt19937_64 rng{d};
+            for (uint64_t t = 0; t < terms_per_doc; ++t)
+                corpus_file << term_word(zipf(rng)) << ' ';
+            corpus_file << '\n';
+        }
+    }
+    {
+        std::ofstream corpus_config{scratch + "/bench/line.toml"};
+        corpus_config << "type = \"line-corpus\"\n";
+    }
+    // an empty stopword list keeps the default chain self-contained
+    {
+        std::ofstream stopwords{scratch + "/stopwords.txt"};
+    }
+
+    auto config = cpptoml::make_table();
+    config->insert("prefix", scratch);
+    config->insert("dataset", std::string{"bench"});
+    config->insert("corpus", std::string{"line.toml"});
+    config->insert("index", scratch + "/bench-idx");
+    config->insert("indexer-ram-budget", static_cast<int64_t>(ram_budget_mb));
+    config->insert("indexer-num-threads", static_cast<int64_t>(num_threads));
+    config->insert("stop-words", scratch + "/stopwords.txt");
+    auto ana = cpptoml::make_table();
+    ana->insert("method", std::string{"ngram-word"});
+    ana->insert("ngram", static_cast<int64_t>(1));
+    ana->insert("filter", std::string{"default-unigram-chain"});
+    auto ana_arr = cpptoml::make_table_array();
+    ana_arr->push_back(ana);
+    config->insert("analyzers", ana_arr);
+
+    auto build_start = std::chrono::steady_clock::now();
+    auto idx = index::make_index<index::inverted_index>(*config);
+    auto build_seconds = seconds_since(build_start);
+
+    std::cout << "{\n"
+              << "  \"config\": {\n"
+              << "    \"num_docs\": " << num_docs << ",\n"
+              << "    \"vocab_size\": " << vocab_size << ",\n"
+              << "    \"terms_per_doc\": " << terms_per_doc << ",\n"
+              << "    \"num_threads\": " << num_threads << ",\n"
+              << "    \"ram_budget_mb\": " << ram_budget_mb << "\n"
+              << "  },\n"
+              << "  \"invert\": {\n"
+              << "    \"seconds\": " << invert_seconds << ",\n"
+              << "    \"docs_per_sec\": " << num_docs / invert_seconds
+              << ",\n"
+              << "    \"postings_per_sec\": "
+              << total_postings / invert_seconds << ",\n"
+              << "    \"flushes\": " << flushes << "\n"
+              << "  },\n"
+              << "  \"merge\": {\n"
+              << "    \"seconds\": " << merge_seconds << ",\n"
+              << "    \"unique_terms\": " << unique_terms << ",\n"
+              << "    \"postings_bytes\": " << postings_bytes << "\n"
+              << "  },\n"
+              << "  \"end_to_end\": {\n"
+              << "    \"seconds\": " << build_seconds << ",\n"
+              << "    \"docs_per_sec\": " << idx->num_docs() / build_seconds
+              << "\n"
+              << "  },\n"
+              << "  \"peak_rss_kb\": " << peak_rss_kb() << "\n"
+              << "}" << std::endl;
+
+    idx = nullptr;
+    filesystem::remove_all(scratch);
+
+    return 0;
+}
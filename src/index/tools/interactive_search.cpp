@@ -10,6 +10,7 @@
 
 #include "meta/corpus/document.h"
 #include "meta/index/inverted_index.h"
+#include "meta/index/ranker/query_cache.h"
 #include "meta/index/ranker/ranker_factory.h"
 #include "meta/parser/analyzers/tree_analyzer.h"
 #include "meta/sequence/analyzers/ngram_pos_analyzer.h"
@@ -46,6 +47,9 @@ int main(int argc, char* argv[])
         throw std::runtime_error{"\"ranker\" group needed in config file!"};
     auto ranker = index::make_ranker(*config, *group);
 
+    // Cache results so that repeated queries skip scoring entirely.
+    index::query_cache cache{1024};
+
     // Find the path prefix to each document so we can print out the contents.
     std::string prefix = *config->get_as<std::string>("prefix") + "/"
                          + *config->get_as<std::string>("dataset") + "/";
@@ -66,8 +70,8 @@ int main(int argc, char* argv[])
 
         // Use the ranker to score the query over the index.
         std::vector<index::search_result> ranking;
-        auto time
-            = common::time([&]() { ranking = ranker->score(*idx, query, 5); });
+        auto time = common::time(
+            [&]() { ranking = cache.score(*ranker, *idx, query, 5); });
 
         std::cout << "Showing top 5 results (" << time.count() << "ms)"
                   << std::endl;
@@ -3,17 +3,23 @@
  * @author Sean Massung
  */
 
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "meta/corpus/document.h"
 #include "meta/index/eval/ir_eval.h"
 #include "meta/index/inverted_index.h"
 #include "meta/index/ranker/ranker_factory.h"
+#include "meta/parallel/thread_pool.h"
 #include "meta/parser/analyzers/tree_analyzer.h"
 #include "meta/sequence/analyzers/ngram_pos_analyzer.h"
 #include "meta/util/printing.h"
+#include "meta/util/profile.h"
 #include "meta/util/time.h"
 
 using namespace meta;
@@ -60,13 +66,28 @@ void print_trec(const Index& idx, const SearchResult& result,
 
 /**
  * Demo app to read a file with one query per line and run each query on an
- * inverted index.
+ * inverted index. Queries are scored on a pool of worker threads while
+ * the main thread keeps reading ahead and a dedicated writer thread
+ * prints finished results in query order, so parsing, scoring, and
+ * output are overlapped instead of strictly serial.
  */
 int main(int argc, char* argv[])
 {
-    if (argc != 2)
+    std::size_t num_threads = std::thread::hardware_concurrency();
+    std::string config_path;
+    for (int i = 1; i < argc; ++i)
     {
-        std::cerr << "Usage:\t" << argv[0] << " config.toml" << std::endl;
+        std::string arg{argv[i]};
+        if (arg.find("--threads=") == 0)
+            num_threads = std::stoul(arg.substr(arg.find('=') + 1));
+        else
+            config_path = arg;
+    }
+
+    if (config_path.empty() || num_threads == 0)
+    {
+        std::cerr << "Usage:\t" << argv[0] << " config.toml [--threads=n]"
+                  << std::endl;
         return 1;
     }
 
@@ -78,7 +99,7 @@ int main(int argc, char* argv[])
     sequence::register_analyzers();
 
     // Create an inverted index based on the config file
-    auto config = cpptoml::parse_file(argv[1]);
+    auto config = cpptoml::parse_file(config_path);
     auto idx = index::make_index<index::inverted_index>(*config);
 
     // Create a ranking class based on the config file.
@@ -120,35 +141,89 @@ int main(int argc, char* argv[])
                   << ENDLG;
     }
 
-    std::string content;
-    auto elapsed_seconds = common::time([&]() {
-        while (std::getline(queries, content))
+    // the pipeline: the main thread reads and enqueues queries, the
+    // pool scores them, and the writer thread prints finished rankings
+    // in query order; back-pressure keeps the read-ahead bounded
+    using ranking_future = std::future<std::vector<index::search_result>>;
+    struct pipeline_item
+    {
+        std::string content;
+        ranking_future ranking;
+    };
+
+    parallel::thread_pool pool{num_threads};
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<pipeline_item> in_flight;
+    const std::size_t max_in_flight = num_threads * 8;
+    bool done_reading = false;
+    uint64_t num_queries = 0;
+
+    std::thread writer{[&]() {
+        uint64_t cur_id = q_id;
+        while (true)
         {
-            corpus::document query{doc_id{0}};
-            query.content(content);
+            std::unique_lock<std::mutex> lock{mutex};
+            cond.wait(lock,
+                      [&]() { return !in_flight.empty() || done_reading; });
+            if (in_flight.empty())
+                break;
+            auto item = std::move(in_flight.front());
+            in_flight.pop_front();
+            lock.unlock();
+            cond.notify_all();
+
+            auto ranking = item.ranking.get();
             if (!trec_format)
             {
                 std::cout << std::string(80, '=') << std::endl;
-                std::cout << "Query " << q_id << ": \"" << content << "\""
-                          << std::endl;
+                std::cout << "Query " << cur_id << ": \"" << item.content
+                          << "\"" << std::endl;
                 std::cout << std::string(80, '-') << std::endl;
             }
-            auto ranking = ranker->score(*idx, query, max_results);
             uint64_t result_num = 1;
-            for (auto& result : ranking)
+            for (const auto& result : ranking)
             {
                 if (trec_format)
-                    print_trec(idx, result, result_num, q_id);
+                    print_trec(idx, result, result_num, cur_id);
                 else
                     print_results(idx, result, result_num);
                 if (result_num++ == max_results)
                     break;
             }
             if (!trec_format && eval)
-                eval->print_stats(ranking, query_id{q_id}, std::cout,
+                eval->print_stats(ranking, query_id{cur_id}, std::cout,
                                   max_results);
-            ++q_id;
+            ++cur_id;
+        }
+    }};
+
+    auto elapsed_seconds = common::time([&]() {
+        std::string content;
+        while (std::getline(queries, content))
+        {
+            corpus::document query{doc_id{0}};
+            query.content(content);
+            ++num_queries;
+
+            auto fut = pool.submit_task([&, query]() {
+                return ranker->score(*idx, query, max_results);
+            });
+
+            std::unique_lock<std::mutex> lock{mutex};
+            cond.wait(lock,
+                      [&]() { return in_flight.size() < max_in_flight; });
+            in_flight.push_back({std::move(content), std::move(fut)});
+            lock.unlock();
+            cond.notify_all();
         }
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            done_reading = true;
+        }
+        cond.notify_all();
+        writer.join();
     });
 
     if (!trec_format && eval)
@@ -160,4 +235,15 @@ int main(int argc, char* argv[])
     }
     std::cerr << "Elapsed time: " << elapsed_seconds.count() << "ms"
               << std::endl;
+    if (num_queries > 0 && elapsed_seconds.count() > 0)
+    {
+        std::cerr << "QPS: "
+                  << num_queries * 1000.0
+                         / static_cast<double>(elapsed_seconds.count())
+                  << " (" << num_queries << " queries, " << num_threads
+                  << " threads)" << std::endl;
+    }
+
+    // prints nothing unless built with ENABLE_PROFILE_HOOKS
+    profile::report(std::cerr);
 }
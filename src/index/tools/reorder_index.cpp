@@ -0,0 +1,300 @@
+/**
+ * @file reorder_index.cpp
+ * @author Chase Geigle
+ *
+ * Rewrites an index with a new document id assignment. Delta-encoded
+ * postings compress best when similar documents receive nearby ids, but
+ * make_index assigns ids in corpus order; re-clustering the id space
+ * after the fact (by a metadata key such as a URL or path, or by an
+ * externally computed clustering order) typically shrinks the postings
+ * file by a large margin without touching its format.
+ *
+ * The ordering is either a lexicographic sort on a string metadata
+ * field (-f <field>, default "path") or an explicit permutation read
+ * from a file (-o <file>, one old doc id per line in new id order),
+ * which is how clustering tools plug in. The inverted postings, the
+ * forward postings (when a forward index exists alongside), and every
+ * per-document metadata file are rewritten into a fresh index directory;
+ * the vocabulary and the postings format are unchanged, so the result
+ * loads like any other index.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "meta/index/forward_index.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/postings_data.h"
+#include "meta/index/postings_file_writer.h"
+#include "meta/io/filesystem.h"
+#include "meta/logging/logger.h"
+#include "meta/util/disk_vector.h"
+#include "meta/util/printing.h"
+#include "meta/util/time.h"
+
+using namespace meta;
+
+namespace
+{
+/**
+ * Permutes a per-document disk_vector: element i of the output is
+ * element order[i] of the input.
+ */
+template <class T>
+void permute_file(const std::string& in, const std::string& out,
+                  const std::vector<doc_id>& order)
+{
+    util::disk_vector<const T> src{in};
+    util::disk_vector<T> dst{out, src.size()};
+    for (uint64_t i = 0; i < order.size(); ++i)
+        dst[i] = src[order[i]];
+}
+
+/**
+ * Permutes the per-document metadata files and copies the
+ * document-independent ones. Every columnar metadata file stores 8-byte
+ * elements regardless of field type, so the permutation is
+ * type-agnostic.
+ */
+void rewrite_metadata(const std::string& in_dir, const std::string& out_dir,
+                      const std::vector<doc_id>& order)
+{
+    permute_file<label_id>(in_dir + "/docs.labels", out_dir + "/docs.labels",
+                           order);
+    permute_file<uint64_t>(in_dir + "/metadata.index",
+                           out_dir + "/metadata.index", order);
+    permute_file<uint64_t>(in_dir + "/metadata.lengths",
+                           out_dir + "/metadata.lengths", order);
+    permute_file<uint64_t>(in_dir + "/metadata.unique-terms",
+                           out_dir + "/metadata.unique-terms", order);
+
+    for (uint64_t col = 0;
+         filesystem::file_exists(in_dir + "/metadata.col."
+                                 + std::to_string(col));
+         ++col)
+    {
+        auto name = "/metadata.col." + std::to_string(col);
+        permute_file<uint64_t>(in_dir + name, out_dir + name, order);
+
+        // string columns keep their (doc-independent) dictionaries
+        auto dict = "/metadata.dict." + std::to_string(col);
+        if (filesystem::file_exists(in_dir + dict))
+            filesystem::copy_file(in_dir + dict, out_dir + dict);
+        if (filesystem::file_exists(in_dir + dict + ".index"))
+            filesystem::copy_file(in_dir + dict + ".index",
+                                  out_dir + dict + ".index");
+    }
+
+    for (const auto& name :
+         {"/metadata.db", "/labelids.mapping", "/config.toml"})
+        filesystem::copy_file(in_dir + name, out_dir + name);
+}
+
+/**
+ * Copies the vocabulary files, which a doc id permutation leaves
+ * untouched.
+ */
+void copy_vocabulary(const std::string& in_dir, const std::string& out_dir)
+{
+    for (const auto& name : {"/termids.mapping", "/termids.mapping.inverse"})
+    {
+        if (filesystem::file_exists(in_dir + name))
+            filesystem::copy_file(in_dir + name, out_dir + name);
+    }
+}
+
+/**
+ * Rewrites the inverted postings with each document's new id, re-sorting
+ * every list so the delta encoding sees the new id order.
+ */
+void rewrite_inverted(index::inverted_index& idx, const std::string& out_dir,
+                      const std::vector<doc_id>& new_ids)
+{
+    index::postings_file_writer<index::inverted_index::postings_data_type> out{
+        out_dir + "/postings.index", idx.unique_terms()};
+
+    printing::progress progress{" > Rewriting inverted postings: ",
+                                idx.unique_terms()};
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+    {
+        progress(t_id);
+        auto pdata = idx.search_primary(t_id);
+        auto counts = pdata->counts();
+        for (auto& count : counts)
+            count.first = new_ids[count.first];
+        std::sort(counts.begin(), counts.end(),
+                  [](const std::pair<doc_id, uint64_t>& a,
+                     const std::pair<doc_id, uint64_t>& b) {
+                      return a.first < b.first;
+                  });
+
+        index::inverted_index::postings_data_type to_write{t_id};
+        to_write.set_counts(std::move(counts));
+        out.write(to_write);
+    }
+}
+
+/**
+ * Rewrites the forward postings in new doc id order; the term ids inside
+ * each document's list are unchanged.
+ */
+void rewrite_forward(index::forward_index& idx, const std::string& out_dir,
+                     const std::vector<doc_id>& order)
+{
+    index::postings_file_writer<index::forward_index::postings_data_type> out{
+        out_dir + "/postings.index", idx.num_docs()};
+
+    printing::progress progress{" > Rewriting forward postings: ",
+                                idx.num_docs()};
+    for (uint64_t i = 0; i < order.size(); ++i)
+    {
+        progress(i);
+        auto pdata = idx.search_primary(order[i]);
+
+        index::forward_index::postings_data_type to_write{doc_id{i}};
+        to_write.set_counts(pdata->counts());
+        out.write(to_write);
+    }
+}
+
+/**
+ * @return the new-to-old id order from sorting on a string metadata
+ * field
+ */
+std::vector<doc_id> field_order(index::inverted_index& idx,
+                                const std::string& field)
+{
+    std::vector<std::string> keys(idx.num_docs());
+    for (doc_id d_id{0}; d_id < idx.num_docs(); ++d_id)
+    {
+        auto val = idx.metadata<std::string>(d_id, field);
+        if (!val)
+            throw std::runtime_error{"document " + std::to_string(d_id)
+                                     + " has no metadata field \"" + field
+                                     + "\""};
+        keys[d_id] = *val;
+    }
+
+    std::vector<doc_id> order(idx.num_docs());
+    std::iota(order.begin(), order.end(), 0_did);
+    std::sort(order.begin(), order.end(), [&](doc_id a, doc_id b) {
+        return keys[a] < keys[b];
+    });
+    return order;
+}
+
+/**
+ * @return the new-to-old id order read from a file with one old doc id
+ * per line
+ */
+std::vector<doc_id> file_order(const std::string& path, uint64_t num_docs)
+{
+    std::ifstream in{path};
+    std::vector<doc_id> order;
+    order.reserve(num_docs);
+
+    uint64_t d_id;
+    while (in >> d_id)
+        order.emplace_back(d_id);
+
+    if (order.size() != num_docs)
+        throw std::runtime_error{"ordering file has " + std::to_string(
+                                     order.size()) + " ids for "
+                                 + std::to_string(num_docs) + " documents"};
+
+    std::vector<bool> seen(num_docs, false);
+    for (const auto& id : order)
+    {
+        if (id >= num_docs || seen[id])
+            throw std::runtime_error{
+                "ordering file is not a permutation of the doc ids"};
+        seen[id] = true;
+    }
+    return order;
+}
+
+int usage(const char* name)
+{
+    std::cerr << "Usage:\t" << name
+              << " configFile outputDir [-f field | -o orderFile]\n"
+              << "    Rewrites the index with doc ids reassigned by a\n"
+              << "    metadata field sort (default: -f path) or by an\n"
+              << "    explicit ordering file (one old doc id per line)."
+              << std::endl;
+    return 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3 && argc != 5)
+        return usage(argv[0]);
+
+    std::string out_prefix = argv[2];
+    std::string field = "path";
+    std::string order_file;
+    if (argc == 5)
+    {
+        if (std::string{argv[3]} == "-f")
+            field = argv[4];
+        else if (std::string{argv[3]} == "-o")
+            order_file = argv[4];
+        else
+            return usage(argv[0]);
+    }
+
+    logging::set_cerr_logging();
+
+    auto config = cpptoml::parse_file(argv[1]);
+    auto in_prefix = *config->get_as<std::string>("index");
+    auto idx = index::make_index<index::inverted_index>(*config);
+
+    // order[new_id] = old_id, and its inverse
+    auto order = order_file.empty() ? field_order(*idx, field)
+                                    : file_order(order_file, idx->num_docs());
+    std::vector<doc_id> new_ids(order.size());
+    for (uint64_t i = 0; i < order.size(); ++i)
+        new_ids[order[i]] = doc_id{i};
+
+    auto time = common::time([&]() {
+        auto out_inv = out_prefix + "/inv";
+        filesystem::remove_all(out_inv);
+        if (!filesystem::make_directories(out_inv))
+            throw std::runtime_error{"unable to create directory: " + out_inv};
+
+        rewrite_inverted(*idx, out_inv, new_ids);
+        copy_vocabulary(in_prefix + "/inv", out_inv);
+        rewrite_metadata(in_prefix + "/inv", out_inv, order);
+
+        // a forward index over the same corpus shares the id space, so
+        // it must be rewritten in the same breath to stay consistent
+        if (filesystem::exists(in_prefix + "/fwd"))
+        {
+            auto out_fwd = out_prefix + "/fwd";
+            filesystem::remove_all(out_fwd);
+            if (!filesystem::make_directories(out_fwd))
+                throw std::runtime_error{"unable to create directory: "
+                                         + out_fwd};
+
+            auto fwd = index::make_index<index::forward_index>(*config);
+            rewrite_forward(*fwd, out_fwd, order);
+            copy_vocabulary(in_prefix + "/fwd", out_fwd);
+            rewrite_metadata(in_prefix + "/fwd", out_fwd, order);
+            filesystem::copy_file(in_prefix + "/fwd/corpus.uniqueterms",
+                                  out_fwd + "/corpus.uniqueterms");
+        }
+    });
+
+    auto old_size = filesystem::file_size(in_prefix + "/inv/postings.index");
+    auto new_size = filesystem::file_size(out_prefix + "/inv/postings.index");
+    std::cout << "Reordering took: " << time.count() / 1000.0 << " seconds"
+              << std::endl;
+    std::cout << "Inverted postings: " << printing::bytes_to_units(old_size)
+              << " -> " << printing::bytes_to_units(new_size) << std::endl;
+
+    return 0;
+}
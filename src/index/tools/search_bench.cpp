@@ -0,0 +1,166 @@
+/**
+ * @file search_bench.cpp
+ * @author Chase Geigle
+ */
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "meta/corpus/document.h"
+#include "meta/index/eval/ir_eval.h"
+#include "meta/index/forward_index.h"
+#include "meta/index/inverted_index.h"
+#include "meta/index/ranker/all.h"
+#include "meta/logging/logger.h"
+#include "meta/parser/analyzers/tree_analyzer.h"
+#include "meta/sequence/analyzers/ngram_pos_analyzer.h"
+#include "meta/util/time.h"
+
+using namespace meta;
+
+namespace
+{
+/**
+ * Writes one ranker's throughput, latency, and effectiveness numbers as a
+ * JSON object. The effectiveness measures are printed at full precision so
+ * that any change in ranking output shows up in a diff of the artifact.
+ */
+void print_ranker_json(std::ostream& out, const std::string& name,
+                       const index::ir_eval::batch_results& batch,
+                       uint64_t num_queries, double elapsed_ms)
+{
+    auto old_precision = out.precision(17);
+    out << "    {\n"
+        << "      \"ranker\": \"" << name << "\",\n"
+        << "      \"queries\": " << num_queries << ",\n"
+        << "      \"qps\": " << (num_queries * 1000.0 / elapsed_ms) << ",\n"
+        << "      \"latency_us\": {"
+        << "\"p50\": " << batch.latency_percentile(50).count() << ", "
+        << "\"p90\": " << batch.latency_percentile(90).count() << ", "
+        << "\"p95\": " << batch.latency_percentile(95).count() << ", "
+        << "\"p99\": " << batch.latency_percentile(99).count() << "},\n"
+        << "      \"map\": " << batch.map << ",\n"
+        << "      \"gmap\": " << batch.gmap << ",\n"
+        << "      \"avg_ndcg\": " << batch.avg_ndcg << "\n"
+        << "    }";
+    out.precision(old_precision);
+}
+}
+
+/**
+ * Benchmarks every bag-of-words ranker over a fixed query set, emitting
+ * QPS, latency percentiles, and effectiveness measures per ranker as
+ * JSON. Run via the bench-search target against the pinned cranfield
+ * dataset to get a diffable before/after artifact for any change that
+ * could affect search speed or ranking output.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage:\t" << argv[0] << " config.toml [output.json]"
+                  << std::endl;
+        return 1;
+    }
+
+    // Log to standard error
+    logging::set_cerr_logging();
+
+    // Register additional analyzers
+    parser::register_analyzers();
+    sequence::register_analyzers();
+
+    auto config = cpptoml::parse_file(argv[1]);
+
+    // Get the config group with options specific to this executable.
+    auto bench_group = config->get_table("search-bench");
+    if (!bench_group)
+        throw std::runtime_error{"\"search-bench\" group needed in config"};
+
+    // the benchmark pins its own dataset and index so its numbers are
+    // comparable regardless of what the rest of the config points at
+    if (auto dataset = bench_group->get_as<std::string>("dataset"))
+        config->insert("dataset", *dataset);
+    if (auto corpus = bench_group->get_as<std::string>("corpus"))
+        config->insert("corpus", *corpus);
+    if (auto index = bench_group->get_as<std::string>("index"))
+        config->insert("index", *index);
+
+    auto query_path = bench_group->get_as<std::string>("query-path");
+    if (!query_path)
+        throw std::runtime_error{
+            "config file needs a \"query-path\" parameter"};
+    if (!meta::filesystem::file_exists(*query_path))
+        throw std::runtime_error{"query path does not exist: " + *query_path};
+
+    auto max_results
+        = bench_group->get_as<uint64_t>("max-results").value_or(10);
+    auto q_id = bench_group->get_as<uint64_t>("query-id-start").value_or(1);
+
+    auto idx = index::make_index<index::inverted_index>(*config);
+    auto fwd = index::make_index<index::forward_index>(*config);
+
+    index::ir_eval eval{*bench_group};
+
+    std::ifstream queries{*query_path};
+    std::vector<corpus::document> query_batch;
+    std::string content;
+    while (std::getline(queries, content))
+    {
+        corpus::document query{doc_id{0}};
+        query.content(content);
+        query_batch.emplace_back(std::move(query));
+    }
+
+    // every bag-of-words ranker, at its default parameters
+    std::vector<std::pair<std::string, std::unique_ptr<index::ranker>>>
+        rankers;
+    rankers.emplace_back(index::okapi_bm25::id.to_string(),
+                         make_unique<index::okapi_bm25>());
+    rankers.emplace_back(index::pivoted_length::id.to_string(),
+                         make_unique<index::pivoted_length>());
+    rankers.emplace_back(index::jelinek_mercer::id.to_string(),
+                         make_unique<index::jelinek_mercer>());
+    rankers.emplace_back(index::dirichlet_prior::id.to_string(),
+                         make_unique<index::dirichlet_prior>());
+    rankers.emplace_back(index::kl_divergence_prf::id.to_string(),
+                         make_unique<index::kl_divergence_prf>(fwd));
+    rankers.emplace_back(index::rocchio::id.to_string(),
+                         make_unique<index::rocchio>(fwd));
+
+    std::ofstream json_file;
+    if (argc == 3)
+        json_file.open(argv[2]);
+    std::ostream& out = argc == 3 ? json_file : std::cout;
+
+    parallel::thread_pool pool;
+    out << "{\n  \"dataset\": \""
+        << config->get_as<std::string>("dataset").value_or("[none]")
+        << "\",\n  \"rankers\": [\n";
+    for (std::size_t i = 0; i < rankers.size(); ++i)
+    {
+        LOG(info) << "Benchmarking " << rankers[i].first << ENDLG;
+
+        // warm up the postings caches so every ranker sees the same
+        // starting state
+        rankers[i].second->score_batch(*idx, query_batch.begin(),
+                                       query_batch.end(), max_results);
+
+        index::ir_eval::batch_results batch;
+        auto elapsed = common::time([&]() {
+            batch = eval.evaluate_batch(*rankers[i].second, *idx,
+                                        query_batch.begin(), query_batch.end(),
+                                        query_id{q_id}, pool, max_results);
+        });
+
+        print_ranker_json(out, rankers[i].first, batch, query_batch.size(),
+                          static_cast<double>(elapsed.count()));
+        out << (i + 1 < rankers.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return 0;
+}
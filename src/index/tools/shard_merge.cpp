@@ -0,0 +1,200 @@
+/**
+ * @file shard_merge.cpp
+ * @author Chase Geigle
+ *
+ * Stitches the uncompressed postings of per-shard inverted index builds
+ * into a single globally-sorted postings file. Each shard is expected to
+ * have been built over one shard of a range-partitioned corpus (see
+ * corpus::shard_corpus), so restoring global doc ids is a constant
+ * offset per shard: the cumulative document count of the shards before
+ * it. Shard directories must be given in shard order.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "meta/index/postings_data.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/mmap_file.h"
+#include "meta/io/packed.h"
+#include "meta/logging/logger.h"
+#include "meta/util/multiway_merge.h"
+
+using namespace meta;
+
+namespace
+{
+using pdata_type = index::postings_data<std::string, doc_id>;
+
+/**
+ * Record for the merge: a term and its postings with global doc ids.
+ */
+struct shard_record
+{
+    std::string key;
+    pdata_type::count_t counts;
+
+    void merge_with(shard_record&& other)
+    {
+        std::move(other.counts.begin(), other.counts.end(),
+                  std::back_inserter(counts));
+        pdata_type::count_t{}.swap(other.counts);
+    }
+
+    bool operator<(const shard_record& other) const
+    {
+        return key < other.key;
+    }
+
+    bool operator==(const shard_record& other) const
+    {
+        return key == other.key;
+    }
+};
+
+/**
+ * ChunkIterator over one shard's postings file that rewrites shard-local
+ * doc ids into global ids as records are read.
+ */
+class shard_iterator
+{
+  public:
+    shard_iterator() = default;
+
+    shard_iterator(const std::string& filename, uint64_t offset)
+        : input_{filename},
+          offset_{offset},
+          bytes_read_{0},
+          total_bytes_{filesystem::file_size(filename)}
+    {
+        ++(*this);
+    }
+
+    shard_iterator& operator++()
+    {
+        if (input_.peek() == EOF)
+        {
+            input_.close();
+            return *this;
+        }
+
+        pdata_type pdata;
+        bytes_read_ += pdata.read_packed(input_);
+        record_.key = pdata.primary_key();
+        record_.counts = pdata.counts();
+        for (auto& pr : record_.counts)
+            pr.first = doc_id{pr.first + offset_};
+        return *this;
+    }
+
+    shard_record& operator*()
+    {
+        return record_;
+    }
+
+    const shard_record& operator*() const
+    {
+        return record_;
+    }
+
+    uint64_t total_bytes() const
+    {
+        return total_bytes_;
+    }
+
+    uint64_t bytes_read() const
+    {
+        return bytes_read_;
+    }
+
+    bool operator==(const shard_iterator& other) const
+    {
+        return !input_.is_open() && !other.input_.is_open();
+    }
+
+  private:
+    io::mmap_ifstream input_;
+    shard_record record_;
+    uint64_t offset_;
+    uint64_t bytes_read_;
+    uint64_t total_bytes_;
+};
+
+bool operator!=(const shard_iterator& a, const shard_iterator& b)
+{
+    return !(a == b);
+}
+
+/**
+ * @param filename A shard's postings file
+ * @return the number of documents in the shard, taken as one past the
+ * largest doc id appearing in its postings
+ */
+uint64_t count_docs(const std::string& filename)
+{
+    uint64_t num_docs = 0;
+    for (shard_iterator it{filename, 0}; it != shard_iterator{}; ++it)
+    {
+        for (const auto& pr : (*it).counts)
+            num_docs = std::max<uint64_t>(num_docs, pr.first + 1);
+    }
+    return num_docs;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " output-dir shard-dir [shard-dir...]" << std::endl;
+        std::cerr << "Merges the uncompressed postings of per-shard index "
+                     "builds (in shard order)\ninto output-dir/postings.index "
+                     "with global doc ids." << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging();
+
+    std::vector<std::string> postings;
+    for (int i = 2; i < argc; ++i)
+        postings.push_back(std::string{argv[i]} + "/postings.index");
+
+    for (const auto& file : postings)
+    {
+        if (!filesystem::file_exists(file))
+        {
+            std::cerr << "Missing shard postings file: " << file << std::endl;
+            return 1;
+        }
+    }
+
+    // global doc-id offsets are the cumulative shard document counts
+    std::vector<shard_iterator> to_merge;
+    to_merge.reserve(postings.size());
+    uint64_t offset = 0;
+    for (const auto& file : postings)
+    {
+        auto num_docs = count_docs(file);
+        LOG(info) << file << ": " << num_docs << " documents (offset "
+                  << offset << ")" << ENDLG;
+        to_merge.emplace_back(file, offset);
+        offset += num_docs;
+    }
+
+    filesystem::make_directory(std::string{argv[1]});
+    std::ofstream output{std::string{argv[1]} + "/postings.index",
+                         std::ios::binary};
+
+    auto unique_terms = util::multiway_merge(
+        to_merge.begin(), to_merge.end(), [&](shard_record&& record) {
+            pdata_type pdata{std::move(record.key)};
+            pdata.set_counts(std::move(record.counts));
+            pdata.write_packed(output);
+        });
+
+    LOG(info) << "Merged " << postings.size() << " shards: " << unique_terms
+              << " unique terms, " << offset << " documents" << ENDLG;
+    return 0;
+}
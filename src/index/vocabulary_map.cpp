@@ -3,7 +3,9 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
 #include <cstring>
+#include <numeric>
 
 #include "meta/index/vocabulary_map.h"
 #include "meta/util/optional.h"
@@ -16,6 +18,14 @@ namespace index
 vocabulary_map::vocabulary_map(const std::string& path, uint16_t block_size)
     : file_{path}, inverse_{path + ".inverse"}, block_size_{block_size}
 {
+    // the vocabulary is consulted on every query and is small relative
+    // to the postings, so pre-fault it at open instead of paying the
+    // page-fault latency on the first queries after a restart; lookups
+    // within it jump between tree levels, hence the random hint
+    file_.advise_random();
+    file_.prefetch(0, file_.size());
+    inverse_.prefetch(0, inverse_.size());
+
     // determine the position that denotes the end of the leaf node
     // level---we can use this to determine when to stop our finds later on
     auto pos = inverse_[inverse_.size() - 1];
@@ -29,7 +39,7 @@ vocabulary_map::vocabulary_map(const std::string& path, uint16_t block_size)
     initial_seek_pos_ = *reinterpret_cast<uint64_t*>(file_.begin() + first_pos);
 }
 
-util::optional<term_id> vocabulary_map::find(const std::string& term) const
+util::optional<term_id> vocabulary_map::find(util::string_view term) const
 {
     uint64_t pos = file_.size() - block_size_;
     uint64_t seek_pos = initial_seek_pos_;
@@ -64,21 +74,50 @@ util::optional<term_id> vocabulary_map::find(const std::string& term) const
 
     // we are now at a leaf node---find our term if it exists
     uint64_t endpos = pos + block_size_;
-    while (pos < endpos)
+    while (pos < endpos && *(file_.begin() + pos))
     {
-        if (compare(term, file_.begin() + pos) == 0)
+        auto cmp = compare(term, file_.begin() + pos);
+        if (cmp == 0)
         {
-            pos += term.length() + 1;
+            pos += term.size() + 1;
             return term_id{*reinterpret_cast<uint64_t*>(file_.begin() + pos)};
         }
+        // leaf entries are sorted, so we can stop as soon as we pass the
+        // spot the term would occupy
+        if (cmp < 0)
+            return util::nullopt;
         pos += std::strlen(file_.begin() + pos) + 1 + sizeof(uint64_t);
     }
     return util::nullopt;
 }
 
-int vocabulary_map::compare(const std::string& term, const char* other) const
+std::vector<util::optional<term_id>>
+vocabulary_map::find_batch(const std::vector<std::string>& terms) const
 {
-    return std::memcmp(term.c_str(), other, term.length() + 1);
+    std::vector<std::size_t> order(terms.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return terms[a] < terms[b];
+    });
+
+    std::vector<util::optional<term_id>> ids(terms.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        // duplicates are adjacent after sorting: reuse the probe
+        if (i > 0 && terms[order[i]] == terms[order[i - 1]])
+            ids[order[i]] = ids[order[i - 1]];
+        else
+            ids[order[i]] = find(terms[order[i]]);
+    }
+    return ids;
+}
+
+int vocabulary_map::compare(util::string_view term, const char* other) const
+{
+    if (auto res = std::memcmp(term.data(), other, term.size()))
+        return res;
+    // equal prefixes: the term is smaller iff the tree string is longer
+    return -static_cast<int>(static_cast<unsigned char>(other[term.size()]));
 }
 
 std::string vocabulary_map::find_term(term_id t_id) const
@@ -86,6 +125,11 @@ std::string vocabulary_map::find_term(term_id t_id) const
     return file_.begin() + inverse_[t_id];
 }
 
+util::string_view vocabulary_map::find_term_view(term_id t_id) const
+{
+    return file_.begin() + inverse_[t_id];
+}
+
 uint64_t vocabulary_map::size() const
 {
     return inverse_.size();
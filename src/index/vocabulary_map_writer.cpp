@@ -8,6 +8,7 @@
 #include "meta/meta.h"
 #include "meta/index/vocabulary_map_writer.h"
 #include "meta/io/binary.h"
+#include "meta/parallel/parallel_for.h"
 
 namespace meta
 {
@@ -21,8 +22,7 @@ vocabulary_map_writer::vocabulary_map_writer(const std::string& path,
       path_{path},
       block_size_{block_size},
       num_terms_{0},
-      remaining_block_space_{block_size},
-      written_nodes_{0}
+      remaining_block_space_{block_size}
 {
     file_.open(path, file_.binary | file_.trunc);
     if (!file_ || !inverse_file_)
@@ -39,10 +39,13 @@ void vocabulary_map_writer::insert(const std::string& term)
     auto length = sizeof(term_id) + term.length() + 1;
 
     if (length > remaining_block_space_)
-    {
         write_padding();
-        ++written_nodes_;
-    }
+
+    // remember the head of every leaf so the internal levels can be
+    // bulk-loaded without re-reading the leaves
+    if (remaining_block_space_ == block_size_)
+        level_heads_.push_back(node_head{term, file_write_pos_});
+
     // record term position in inverse file
     io::write_binary(inverse_file_, file_write_pos_);
 
@@ -74,7 +77,6 @@ void vocabulary_map_writer::flush()
 {
     write_padding();
     file_.flush();
-    ++written_nodes_;
 }
 
 vocabulary_map_writer::~vocabulary_map_writer()
@@ -84,65 +86,63 @@ vocabulary_map_writer::~vocabulary_map_writer()
         flush();
     file_.flush();
 
-    uint64_t remaining_nodes{0};
-    std::swap(remaining_nodes, written_nodes_);
-
-    // begin writing the internal nodes
-    std::ifstream reader{path_, std::ios::binary};
-    uint64_t read_pos = 0;
-
-    // this first loop is over each of the levels: when we have written
-    // only one node inside the inner loop, we've just finished writing the
-    // root and we can stop
-    while (remaining_nodes != 1)
+    // bulk-load the internal nodes bottom-up: every level's entries are
+    // the remembered (head term, position) pairs of the level below, so
+    // each level is packed in one in-memory pass; we stop once a level
+    // consists of a single node---the root
+    parallel::thread_pool pool;
+    auto level = std::move(level_heads_);
+    while (level.size() > 1)
     {
-        // this loop is over the last level that was written---once we have
-        // processed all nodes in the previous level, we can move to the
-        // next level's iteration
-        while (remaining_nodes > 0)
+        // greedily assign this level's entries to blocks; block b spans
+        // entries [block_begin[b], block_begin[b + 1])
+        std::vector<std::size_t> block_begin{0};
+        std::size_t space = block_size_;
+        for (std::size_t i = 0; i < level.size(); ++i)
         {
-            uint64_t t_id;
-            std::string term;
-            io::read_binary(reader, term);
-            io::read_binary(reader, t_id);
-
-            // signed int for safe negation below (auto causes a big on
-            // 32-bit systems)
-            auto length
-                = static_cast<int64_t>(sizeof(uint64_t) + term.length() + 1);
-
-            // if we are out of room in the current block, flush it and start a
-            // new one
-            if (length > remaining_block_space_)
+            // + 1 for null terminator
+            auto length = sizeof(uint64_t) + level[i].term.length() + 1;
+            if (length > space)
             {
-                flush();
-                // we need to re-read the block head we just read
-                reader.seekg(-length, file_.cur);
+                block_begin.push_back(i);
+                space = block_size_;
             }
-            // otherwise, write the head term of the block we are reading to
-            // the current block along with its position
-            else
+            space -= length;
+        }
+        block_begin.push_back(level.size());
+
+        // the blocks are independent once assigned, so serialize them
+        // in parallel and then stream the buffers out in order
+        auto num_blocks = block_begin.size() - 1;
+        std::vector<std::string> blocks(num_blocks);
+        parallel::parallel_for(
+            blocks.begin(), blocks.end(), pool, [&](std::string& block)
             {
-                // write the position of the block and the term at its head
-                io::write_binary(file_, term);
-                io::write_binary(file_, read_pos);
-
-                // skip to the next block
-                reader.seekg(block_size_ - length, file_.cur);
-                read_pos += block_size_;
-
-                // update the remaining space in the current block
-                remaining_block_space_ -= length;
-                --remaining_nodes;
-            }
+                auto b = static_cast<std::size_t>(&block - blocks.data());
+                block.reserve(block_size_);
+                for (auto i = block_begin[b]; i < block_begin[b + 1]; ++i)
+                {
+                    block.append(level[i].term.c_str(),
+                                 level[i].term.length() + 1);
+                    block.append(reinterpret_cast<const char*>(&level[i].pos),
+                                 sizeof(uint64_t));
+                }
+                // null padding out to the fixed node size
+                block.resize(block_size_, '\0');
+            });
+
+        std::vector<node_head> next;
+        next.reserve(num_blocks);
+        for (std::size_t b = 0; b < num_blocks; ++b)
+        {
+            next.push_back(node_head{level[block_begin[b]].term,
+                                     file_write_pos_});
+            file_.write(blocks[b].data(), block_size_);
+            file_write_pos_ += block_size_;
         }
+        file_.flush();
 
-        // if there is still a partial block remaining to be written for
-        // this level, write it
-        if (remaining_block_space_ != block_size_)
-            flush();
-
-        std::swap(remaining_nodes, written_nodes_);
+        level = std::move(next);
     }
 }
 }
@@ -4,11 +4,21 @@
  * @author Chase Geigle
  */
 
+#include <atomic>
 #include <fstream>
 #include <vector>
 
 #include "meta/io/filesystem.h"
+#include "meta/parallel/parallel_for.h"
+#include "meta/parallel/thread_pool.h"
+#include "meta/io/gzstream.h"
 #include "meta/io/mmap_file.h"
+#if META_HAS_LIBLZMA
+#include "meta/io/xzstream.h"
+#endif
+#if META_HAS_ZSTD
+#include "meta/io/zstdstream.h"
+#endif
 #include "meta/util/printing.h"
 #include "meta/util/progress.h"
 
@@ -33,6 +43,15 @@
 #include <experimental/filesystem>
 #endif
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <linux/fs.h>
+#endif
+
 namespace meta
 {
 namespace filesystem
@@ -167,6 +186,36 @@ std::uintmax_t remove_all(const std::string& path)
 {
     return remove_all(path_type{path.c_str()});
 }
+
+namespace
+{
+bool is_directory(const std::string& path)
+{
+    traits::stat_data_type st;
+    if (!traits::stat(path.c_str(), &st))
+        return false;
+    return traits::is_directory(&st);
+}
+
+void list_tree(const std::string& root, const std::string& rel,
+               std::vector<std::string>& dirs, std::vector<std::string>& files)
+{
+    auto abs = rel.empty() ? root : root + "/" + rel;
+    for (const auto& p : platformstl::readdir_sequence{abs})
+    {
+        auto child = rel.empty() ? std::string{p} : rel + "/" + p;
+        if (is_directory(root + "/" + child))
+        {
+            dirs.push_back(child);
+            list_tree(root, child, dirs, files);
+        }
+        else
+        {
+            files.push_back(child);
+        }
+    }
+}
+}
 #else
 namespace fs = std::experimental::filesystem;
 
@@ -226,6 +275,88 @@ std::uintmax_t remove_all(const std::string& path)
     return count;
 #endif
 }
+
+namespace
+{
+bool is_directory(const std::string& path)
+{
+    return fs::is_directory(path);
+}
+
+void list_tree(const std::string& root, const std::string& rel,
+               std::vector<std::string>& dirs, std::vector<std::string>& files)
+{
+    auto abs = rel.empty() ? root : root + "/" + rel;
+    for (fs::directory_iterator d{abs}, end; d != end; ++d)
+    {
+        auto name = d->path().filename().string();
+        auto child = rel.empty() ? name : rel + "/" + name;
+        if (fs::is_directory(d->path()))
+        {
+            dirs.push_back(child);
+            list_tree(root, child, dirs, files);
+        }
+        else
+        {
+            files.push_back(child);
+        }
+    }
+}
+}
+#endif
+
+#ifdef __linux__
+namespace
+{
+/**
+ * Attempts to copy a file via a reflink (FICLONE) or an in-kernel
+ * copy_file_range. A reflink shares extents with the source, so on
+ * filesystems that support it (XFS, btrfs) the "copy" is pure metadata;
+ * copy_file_range avoids bouncing the data through a userspace buffer
+ * and lets the filesystem offload the copy where it can. Returns false
+ * (leaving no partial output behind) when neither path applies so the
+ * caller can fall back to a buffered copy.
+ */
+bool copy_file_fast(const std::string& source, const std::string& dest,
+                    uint64_t size)
+{
+    int in = ::open(source.c_str(), O_RDONLY);
+    if (in < 0)
+        return false;
+    int out = ::open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0)
+    {
+        ::close(in);
+        return false;
+    }
+
+    bool success = false;
+#ifdef FICLONE
+    if (::ioctl(out, FICLONE, in) == 0)
+        success = true;
+#endif
+#ifdef __NR_copy_file_range
+    if (!success)
+    {
+        uint64_t copied = 0;
+        while (copied < size)
+        {
+            auto ret = ::syscall(__NR_copy_file_range, in, nullptr, out,
+                                 nullptr, size - copied, 0u);
+            if (ret <= 0)
+                break;
+            copied += static_cast<uint64_t>(ret);
+        }
+        success = copied == size;
+    }
+#endif
+    ::close(in);
+    ::close(out);
+    if (!success)
+        delete_file(dest);
+    return success;
+}
+}
 #endif
 
 bool copy_file(const std::string& source, const std::string& dest)
@@ -233,8 +364,14 @@ bool copy_file(const std::string& source, const std::string& dest)
     if (!file_exists(source))
         return false;
 
-    // if file is larger than 128 MB, show copy progress
     auto size = file_size(source);
+
+#ifdef __linux__
+    if (copy_file_fast(source, dest, size))
+        return true;
+#endif
+
+    // if file is larger than 128 MB, show copy progress
     uint64_t max_size = 1024UL * 1024UL * 1024UL * 128UL;
     if (size > max_size)
     {
@@ -264,6 +401,40 @@ bool copy_file(const std::string& source, const std::string& dest)
     return true;
 }
 
+std::uintmax_t copy_tree(const std::string& source, const std::string& dest)
+{
+    if (!exists(source))
+        return 0;
+
+    if (!is_directory(source))
+        return copy_file(source, dest) ? 1 : 0;
+
+    std::vector<std::string> dirs;
+    std::vector<std::string> files;
+    list_tree(source, "", dirs, files);
+
+    // the directory skeleton is cheap metadata work and defines the
+    // destinations, so it is created up front; the file copies carry
+    // all of the data and run one per task
+    make_directories(dest);
+    for (const auto& dir : dirs)
+        make_directory(dest + "/" + dir);
+
+    std::atomic<bool> failed{false};
+    parallel::thread_pool pool;
+    parallel::parallel_for(files.begin(), files.end(), pool,
+                           [&](const std::string& rel) {
+                               if (!copy_file(source + "/" + rel,
+                                              dest + "/" + rel))
+                                   failed = true;
+                           });
+
+    if (failed)
+        throw filesystem_exception{"failed to copy tree rooted at " + source};
+
+    return dirs.size() + files.size() + 1;
+}
+
 std::string file_text(const std::string& in_name)
 {
     std::ifstream infile{in_name};
@@ -272,8 +443,60 @@ std::string file_text(const std::string& in_name)
     return buf.str();
 }
 
+namespace
+{
+
+bool has_suffix(const std::string& filename, const std::string& suffix)
+{
+    return filename.size() >= suffix.size()
+           && filename.compare(filename.size() - suffix.size(), suffix.size(),
+                               suffix)
+                  == 0;
+}
+
+uint64_t num_stream_lines(std::istream& input, char delimiter)
+{
+    uint64_t num = 0;
+    auto last = static_cast<int>(delimiter);
+    for (auto ch = input.get(); ch != EOF; ch = input.get())
+    {
+        if (ch == delimiter)
+            ++num;
+        last = ch;
+    }
+
+    // this fixes a potential off-by-one if the last line in the file
+    // doesn't end with the delimiter
+    if (last != delimiter)
+        ++num;
+    return num;
+}
+}
+
 uint64_t num_lines(const std::string& filename, char delimiter /*= '\n'*/)
 {
+    // compressed files can't be mmapped, so count them through the
+    // appropriate decompression stream instead
+    if (has_suffix(filename, ".gz"))
+    {
+        io::gzifstream input{filename};
+        return num_stream_lines(input, delimiter);
+    }
+#if META_HAS_LIBLZMA
+    if (has_suffix(filename, ".xz"))
+    {
+        io::xzifstream input{filename};
+        return num_stream_lines(input, delimiter);
+    }
+#endif
+#if META_HAS_ZSTD
+    if (has_suffix(filename, ".zst"))
+    {
+        io::zstdifstream input{filename};
+        return num_stream_lines(input, delimiter);
+    }
+#endif
+
     io::mmap_file file{filename};
     uint64_t num = 0;
 
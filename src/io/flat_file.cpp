@@ -0,0 +1,231 @@
+/**
+ * @file flat_file.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include <zlib.h>
+
+#include "meta/io/flat_file.h"
+#include "meta/io/packed.h"
+
+namespace meta
+{
+namespace io
+{
+
+namespace
+{
+
+const char flat_file_magic[8]
+    = {'M', 'E', 'T', 'A', 'F', 'L', 'A', 'T'};
+const uint32_t flat_file_version = 1;
+const uint64_t header_size = 24;
+const uint64_t section_alignment = 8;
+
+uint32_t checksum_bytes(const char* data, uint64_t size)
+{
+    auto crc = ::crc32(0L, Z_NULL, 0);
+    while (size > 0)
+    {
+        auto len = static_cast<uInt>(
+            std::min<uint64_t>(size, std::numeric_limits<uInt>::max()));
+        crc = ::crc32(crc, reinterpret_cast<const Bytef*>(data), len);
+        data += len;
+        size -= len;
+    }
+    return static_cast<uint32_t>(crc);
+}
+
+struct char_input_stream
+{
+    char_input_stream(const char* input, const char* end)
+        : input_{input}, end_{end}
+    {
+        // nothing
+    }
+
+    char get()
+    {
+        if (input_ == end_)
+            throw flat_file_exception{"section table ends prematurely"};
+        return *input_++;
+    }
+
+    const char* input_;
+    const char* end_;
+};
+}
+
+flat_file_writer::flat_file_writer(const std::string& path)
+    : output_{path, std::ios::binary}, pos_{header_size}, closed_{false}
+{
+    if (!output_)
+        throw flat_file_exception{"unable to open " + path + " for writing"};
+
+    output_.write(flat_file_magic, sizeof(flat_file_magic));
+    output_.write(reinterpret_cast<const char*>(&flat_file_version),
+                  sizeof(flat_file_version));
+    uint64_t table_offset = 0; // patched in close()
+    output_.write(reinterpret_cast<const char*>(&table_offset),
+                  sizeof(table_offset));
+    uint32_t padding = 0;
+    output_.write(reinterpret_cast<const char*>(&padding), sizeof(padding));
+}
+
+flat_file_writer::~flat_file_writer()
+{
+    if (!closed_)
+        close();
+}
+
+void flat_file_writer::write_section(util::string_view name, const char* data,
+                                     uint64_t size)
+{
+    if (closed_)
+        throw flat_file_exception{"cannot write section to a closed file"};
+
+    for (const auto& sec : sections_)
+    {
+        if (sec.name == name)
+            throw flat_file_exception{"duplicate section name: "
+                                      + name.to_string()};
+    }
+
+    // pad to the alignment boundary so array sections can be viewed
+    // in place
+    while (pos_ % section_alignment != 0)
+    {
+        output_.put('\0');
+        ++pos_;
+    }
+
+    output_.write(data, static_cast<std::streamsize>(size));
+    sections_.push_back(
+        {name.to_string(), pos_, size, checksum_bytes(data, size)});
+    pos_ += size;
+}
+
+void flat_file_writer::close()
+{
+    if (closed_)
+        return;
+    closed_ = true;
+
+    auto table_offset = pos_;
+    io::packed::write(output_, sections_.size());
+    for (const auto& sec : sections_)
+    {
+        io::packed::write(output_, sec.name);
+        io::packed::write(output_, sec.offset);
+        io::packed::write(output_, sec.size);
+        io::packed::write(output_, sec.checksum);
+    }
+
+    output_.seekp(static_cast<std::streamoff>(sizeof(flat_file_magic)
+                                              + sizeof(flat_file_version)));
+    output_.write(reinterpret_cast<const char*>(&table_offset),
+                  sizeof(table_offset));
+    output_.flush();
+    if (!output_)
+        throw flat_file_exception{"failed writing flat file"};
+}
+
+flat_file::flat_file(const std::string& path) : file_{path}
+{
+    if (file_.size() < header_size)
+        throw flat_file_exception{path + " is not a flat file (too small)"};
+
+    if (!std::equal(flat_file_magic, flat_file_magic + sizeof(flat_file_magic),
+                    file_.begin()))
+        throw flat_file_exception{path + " is not a flat file (bad magic)"};
+
+    uint32_t version;
+    std::copy(file_.begin() + sizeof(flat_file_magic),
+              file_.begin() + sizeof(flat_file_magic) + sizeof(version),
+              reinterpret_cast<char*>(&version));
+    if (version > flat_file_version)
+        throw flat_file_exception{
+            path + " was written by a newer version of the toolkit"};
+
+    uint64_t table_offset;
+    std::copy(file_.begin() + sizeof(flat_file_magic) + sizeof(version),
+              file_.begin() + sizeof(flat_file_magic) + sizeof(version)
+                  + sizeof(table_offset),
+              reinterpret_cast<char*>(&table_offset));
+    if (table_offset < header_size || table_offset > file_.size())
+        throw flat_file_exception{path + " has a corrupt section table"};
+
+    char_input_stream stream{file_.begin() + table_offset,
+                             file_.begin() + file_.size()};
+    uint64_t num_sections;
+    io::packed::read(stream, num_sections);
+    names_.reserve(num_sections);
+    sections_.reserve(num_sections);
+    for (uint64_t i = 0; i < num_sections; ++i)
+    {
+        std::string name;
+        section_info info;
+        io::packed::read(stream, name);
+        io::packed::read(stream, info.offset);
+        io::packed::read(stream, info.size);
+        io::packed::read(stream, info.checksum);
+
+        if (info.offset + info.size > table_offset)
+            throw flat_file_exception{path + " has a section out of bounds"};
+
+        index_.emplace(name, names_.size());
+        names_.emplace_back(std::move(name));
+        sections_.push_back(info);
+    }
+}
+
+bool flat_file::has_section(util::string_view name) const
+{
+    return index_.find(name.to_string()) != index_.end();
+}
+
+util::string_view flat_file::section(util::string_view name) const
+{
+    auto it = index_.find(name.to_string());
+    if (it == index_.end())
+        throw flat_file_exception{"no such section: " + name.to_string()};
+
+    const auto& info = sections_[it->second];
+    return {file_.begin() + info.offset, info.size};
+}
+
+bool flat_file::verify(util::string_view name) const
+{
+    auto it = index_.find(name.to_string());
+    if (it == index_.end())
+        throw flat_file_exception{"no such section: " + name.to_string()};
+
+    const auto& info = sections_[it->second];
+    return checksum_bytes(file_.begin() + info.offset, info.size)
+           == info.checksum;
+}
+
+bool flat_file::verify() const
+{
+    for (const auto& name : names_)
+    {
+        if (!verify(name))
+            return false;
+    }
+    return true;
+}
+
+std::size_t flat_file::num_sections() const
+{
+    return sections_.size();
+}
+
+const std::vector<std::string>& flat_file::section_names() const
+{
+    return names_;
+}
+}
+}
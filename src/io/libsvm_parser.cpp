@@ -3,6 +3,7 @@
  * @author Sean Massung
  */
 
+#include <cmath>
 #include <cstdlib>
 
 #include "meta/io/libsvm_parser.h"
@@ -31,48 +32,161 @@ void throw_exception(const std::string& text)
     throw libsvm_parser_exception{"incorrectly formatted libsvm data: " + text};
 }
 
-counts_t counts(const std::string& text, bool contains_label /* = true */)
+namespace
+{
+/**
+ * Consumes a run of decimal digits.
+ *
+ * @param it The current position; advanced past any digits consumed
+ * @param end One past the last character of the input
+ * @param val Accumulates the parsed value
+ * @return whether at least one digit was consumed
+ */
+inline bool parse_unsigned(const char*& it, const char* end, uint64_t& val)
 {
-    util::string_view sv{text};
+    const char* start = it;
+    val = 0;
+    while (it != end && *it >= '0' && *it <= '9')
+    {
+        val = val * 10 + static_cast<uint64_t>(*it - '0');
+        ++it;
+    }
+    return it != start;
+}
 
-    if (contains_label)
+/**
+ * Consumes a floating point value of the form
+ * [+-]digits[.digits][(e|E)[+-]digits]. This covers everything liblinear
+ * and libsvm emit while avoiding the locale lookups and per-token
+ * function call overhead of strtod, which dominate the parse time for
+ * large feature files.
+ *
+ * @param it The current position; advanced past the value consumed
+ * @param end One past the last character of the input
+ * @param val The parsed value
+ * @return whether a value was consumed
+ */
+inline bool parse_double(const char*& it, const char* end, double& val)
+{
+    const char* start = it;
+
+    bool negative = false;
+    if (it != end && (*it == '+' || *it == '-'))
     {
-        auto pos = sv.find_first_of(" \t");
-        if (pos == std::string::npos || pos == 0)
-            throw_exception(text);
-        sv = sv.substr(pos);
+        negative = *it == '-';
+        ++it;
     }
 
-    auto consume_whitespace = [&]() {
-        auto pos = sv.find_first_not_of(" \t");
-        if (pos != sv.npos)
-            sv = sv.substr(pos);
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool any_digits = false;
+    while (it != end && *it >= '0' && *it <= '9')
+    {
+        any_digits = true;
+        // cap the mantissa before it overflows; further integer digits
+        // only scale the exponent
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*it - '0');
+            ++digits;
+        }
         else
-            sv = util::string_view{}; // .clear() doesn't exist for GCC...
-    };
+        {
+            ++exponent;
+        }
+        ++it;
+    }
 
-    consume_whitespace();
+    if (it != end && *it == '.')
+    {
+        ++it;
+        while (it != end && *it >= '0' && *it <= '9')
+        {
+            any_digits = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*it - '0');
+                ++digits;
+                --exponent;
+            }
+            ++it;
+        }
+    }
 
-    std::vector<std::pair<term_id, double>> counts;
-    while (!sv.empty())
+    if (!any_digits)
     {
-        auto whitespace = sv.find_first_of(" \t");
-        auto token = sv.substr(0, whitespace);
+        it = start;
+        return false;
+    }
+
+    if (it != end && (*it == 'e' || *it == 'E'))
+    {
+        const char* exp_start = it;
+        ++it;
+        bool exp_negative = false;
+        if (it != end && (*it == '+' || *it == '-'))
+        {
+            exp_negative = *it == '-';
+            ++it;
+        }
+        uint64_t exp_val;
+        if (!parse_unsigned(it, end, exp_val))
+        {
+            // a trailing 'e' that isn't an exponent; leave it unconsumed
+            it = exp_start;
+        }
+        else
+        {
+            exponent += exp_negative ? -static_cast<int>(exp_val)
+                                     : static_cast<int>(exp_val);
+        }
+    }
+
+    val = static_cast<double>(mantissa);
+    if (exponent != 0)
+        val *= std::pow(10.0, exponent);
+    if (negative)
+        val = -val;
+    return true;
+}
 
-        if (token.empty())
-            throw_exception("empty token: " + token.to_string());
+inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+}
+
+counts_t counts(const std::string& text, bool contains_label /* = true */)
+{
+    const char* it = text.data();
+    const char* end = it + text.size();
+
+    if (contains_label)
+    {
+        const char* start = it;
+        while (it != end && !is_space(*it))
+            ++it;
+        if (it == start || it == end)
+            throw_exception(text);
+    }
 
-        auto colon = token.find_first_of(":");
-        if (colon == std::string::npos || colon == 0 || colon == token.size() - 1)
-            throw_exception("no colon in token: " + token.to_string());
+    std::vector<std::pair<term_id, double>> counts;
+    while (true)
+    {
+        while (it != end && is_space(*it))
+            ++it;
+        if (it == end)
+            break;
 
-        char* end = nullptr;
-        auto term = std::strtoul(token.data(), nullptr, 0);
-        double count = std::strtod(token.substr(colon + 1).data(), &end);
+        uint64_t term;
+        if (!parse_unsigned(it, end, term) || it == end || *it != ':')
+            throw_exception(text);
+        ++it;
 
-        if (end != token.data() + token.size())
-            throw_exception("full token not consumed: " + token.to_string());
-            //throw_exception(text);
+        double count;
+        if (!parse_double(it, end, count) || (it != end && !is_space(*it)))
+            throw_exception(text);
 
         if (term == 0)
             throw libsvm_parser_exception{"term id was 0 from libsvm format"};
@@ -80,12 +194,6 @@ counts_t counts(const std::string& text, bool contains_label /* = true */)
         // liblinear has term_ids start at 1 instead of 0 like MeTA and libsvm
         term_id minus_term{term - 1};
         counts.emplace_back(minus_term, count);
-
-        if (whitespace == std::string::npos)
-            break;
-
-        sv = sv.substr(whitespace);
-        consume_whitespace();
     }
 
     return counts;
@@ -9,12 +9,14 @@
 #include "meta/io/mman-win32/mman.h"
 #endif
 
+#include <algorithm>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include "meta/io/filesystem.h"
 #include "meta/io/mmap_file.h"
+#include "meta/util/memory_accounting.h"
 
 namespace meta
 {
@@ -36,6 +38,8 @@ mmap_file::mmap_file(const std::string& path)
         close(file_descriptor_);
         throw mmap_file_exception("error memory-mapping " + path_);
     }
+
+    memory::component("io::mmap_file (mapped)").allocated(size_);
 }
 
 mmap_file::mmap_file(mmap_file&& other)
@@ -60,6 +64,47 @@ char* mmap_file::begin() const
     return start_;
 }
 
+void mmap_file::advise_sequential() const
+{
+#ifdef MADV_SEQUENTIAL
+    if (start_ != nullptr)
+        madvise(start_, size_, MADV_SEQUENTIAL);
+#endif
+}
+
+void mmap_file::advise_random() const
+{
+#ifdef MADV_RANDOM
+    if (start_ != nullptr)
+        madvise(start_, size_, MADV_RANDOM);
+#endif
+}
+
+void mmap_file::advise_hugepage() const
+{
+#ifdef MADV_HUGEPAGE
+    if (start_ != nullptr)
+        madvise(start_, size_, MADV_HUGEPAGE);
+#endif
+}
+
+void mmap_file::prefetch(uint64_t offset, uint64_t length) const
+{
+#ifdef MADV_WILLNEED
+    if (start_ == nullptr || offset >= size_)
+        return;
+
+    // madvise requires a page-aligned starting address
+    const uint64_t page_size = 4096;
+    auto aligned = offset & ~(page_size - 1);
+    length = std::min(length + (offset - aligned), size_ - aligned);
+    madvise(start_ + aligned, length, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
+
 mmap_file& mmap_file::operator=(mmap_file&& other)
 {
     if (this != &other)
@@ -68,6 +113,7 @@ mmap_file& mmap_file::operator=(mmap_file&& other)
         {
             munmap(start_, size_);
             close(file_descriptor_);
+            memory::component("io::mmap_file (mapped)").released(size_);
         }
         path_ = std::move(other.path_);
         start_ = std::move(other.start_);
@@ -94,6 +140,7 @@ mmap_file::~mmap_file()
     {
         munmap(start_, size_);
         close(file_descriptor_);
+        memory::component("io::mmap_file (mapped)").released(size_);
     }
 }
 
@@ -122,6 +169,12 @@ int mmap_ifstream::get()
     return static_cast<unsigned char>((*file_)[pos_++]);
 }
 
+void mmap_ifstream::prefetch(std::size_t offset, std::size_t length) const
+{
+    if (is_open())
+        file_->prefetch(offset, length);
+}
+
 void mmap_ifstream::close()
 {
     file_ = util::nullopt;
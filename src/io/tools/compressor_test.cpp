@@ -10,6 +10,9 @@
 #if META_HAS_LIBLZMA
 #include "meta/io/xzstream.h"
 #endif
+#if META_HAS_ZSTD
+#include "meta/io/zstdstream.h"
+#endif
 
 using namespace meta;
 
@@ -55,6 +58,10 @@ int main(int argc, char** argv)
     test_compressor<io::xzifstream, io::xzofstream>(
         argv[1], std::string{argv[2]} + ".xz");
 #endif
+#if META_HAS_ZSTD
+    test_compressor<io::zstdifstream, io::zstdofstream>(
+        argv[1], std::string{argv[2]} + ".zst");
+#endif
 
     return 0;
 }
@@ -0,0 +1,365 @@
+/**
+ * @file zstdstream.cpp
+ * @author Chase Geigle
+ *
+ * Streaming portions follow the same structure as xzstream.cpp; the
+ * streaming API usage is based on the examples in the zstd repo.
+ * @see
+ * https://github.com/facebook/zstd/blob/dev/examples/streaming_compression.c
+ * @see
+ * https://github.com/facebook/zstd/blob/dev/examples/streaming_decompression.c
+ */
+
+#include <fstream>
+#include <future>
+
+#include "meta/io/mmap_file.h"
+#include "meta/io/zstdstream.h"
+#include "meta/parallel/thread_pool.h"
+#include "meta/util/string_view.h"
+
+namespace meta
+{
+namespace io
+{
+
+namespace
+{
+
+void throw_if_error(std::size_t code, std::string msg)
+{
+    if (ZSTD_isError(code))
+        throw zstd_exception{msg + ": " + ZSTD_getErrorName(code), code};
+}
+}
+
+zstdstreambuf::zstdstreambuf(const char* filename, const char* openmode,
+                             std::size_t buffer_size, uint64_t frame_size)
+    : in_buffer_(buffer_size),
+      out_buffer_(buffer_size),
+      file_{std::fopen(filename, openmode)},
+      bytes_read_{0},
+      frame_bytes_{0},
+      frames_written_{0},
+      frame_size_{frame_size},
+      cstream_{nullptr},
+      dstream_{nullptr}
+{
+    in_.src = nullptr;
+    in_.size = 0;
+    in_.pos = 0;
+
+    util::string_view mode{openmode};
+    if (mode == "wb")
+    {
+        reading_ = false;
+        setp(&in_buffer_.front(), &in_buffer_.back());
+
+        cstream_ = ZSTD_createCStream();
+        if (!cstream_)
+            throw zstd_exception{"Failed to initialize encoder", 0};
+    }
+    else if (mode == "rb")
+    {
+        auto end = &out_buffer_.back() + 1;
+        setg(end, end, end);
+        reading_ = true;
+
+        dstream_ = ZSTD_createDStream();
+        if (!dstream_)
+            throw zstd_exception{"Failed to initialize decoder", 0};
+    }
+    else
+    {
+        throw std::runtime_error{"Unrecognized open mode"};
+    }
+}
+
+zstdstreambuf::~zstdstreambuf()
+{
+    if (!reading_)
+    {
+        sync();
+        // close the trailing frame; if nothing was ever written, still
+        // emit one (empty) frame so the file is a valid archive
+        if (frame_bytes_ > 0 || frames_written_ == 0)
+            end_frame();
+    }
+
+    fclose(file_);
+    ZSTD_freeCStream(cstream_);
+    ZSTD_freeDStream(dstream_);
+}
+
+auto zstdstreambuf::underflow() -> int_type
+{
+    if (gptr() && (gptr() < egptr()))
+        return traits_type::to_int_type(*gptr());
+
+    // keep decompressing until we fill the output buffer, reading input
+    // from the internal file as needed; frame boundaries inside the
+    // archive are crossed transparently
+    ZSTD_outBuffer out;
+    out.dst = &out_buffer_[0];
+    out.size = out_buffer_.size();
+    out.pos = 0;
+    while (out.pos < out.size)
+    {
+        if (in_.pos == in_.size)
+        {
+            if (std::feof(file_))
+                break;
+
+            auto read = std::fread(&in_buffer_[0], sizeof(char),
+                                   in_buffer_.size(), file_);
+            bytes_read_ += read;
+
+            if (std::ferror(file_))
+            {
+                setg(&out_buffer_[0], &out_buffer_[0], &out_buffer_[0]);
+                return traits_type::eof();
+            }
+
+            in_.src = &in_buffer_[0];
+            in_.size = read;
+            in_.pos = 0;
+
+            if (read == 0)
+                break;
+        }
+
+        auto ret = ZSTD_decompressStream(dstream_, &out, &in_);
+        throw_if_error(ret, "Decoder error");
+
+        // ret == 0 indicates the end of a frame; only stop early if
+        // there is no further input to begin the next one
+        if (ret == 0 && in_.pos == in_.size && std::feof(file_))
+            break;
+    }
+
+    if (out.pos > 0)
+    {
+        setg(&out_buffer_[0], &out_buffer_[0], &out_buffer_[0] + out.pos);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    // if we get here, we must have exhausted both the input file and the
+    // input buffer, so finally report EOF
+    setg(&out_buffer_[0], &out_buffer_[0], &out_buffer_[0]);
+    return traits_type::eof();
+}
+
+auto zstdstreambuf::overflow(int_type ch) -> int_type
+{
+    if (ch != traits_type::eof())
+    {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        if (sync() == 0)
+            return ch;
+    }
+
+    return traits_type::eof();
+}
+
+int zstdstreambuf::sync()
+{
+    auto bytes = pptr() - pbase();
+
+    ZSTD_inBuffer in;
+    in.src = pbase();
+    in.size = static_cast<std::size_t>(bytes);
+    in.pos = 0;
+    while (in.pos < in.size)
+    {
+        ZSTD_outBuffer out;
+        out.dst = &out_buffer_[0];
+        out.size = out_buffer_.size();
+        out.pos = 0;
+
+        auto ret = ZSTD_compressStream2(cstream_, &out, &in, ZSTD_e_continue);
+        throw_if_error(ret, "Encoder error");
+
+        if (!write_out(out))
+            return -1;
+    }
+
+    // cut the archive into independent frames so that it can be
+    // decompressed frame-parallel later
+    frame_bytes_ += static_cast<uint64_t>(bytes);
+    if (frame_bytes_ >= frame_size_)
+    {
+        if (!end_frame())
+            return -1;
+    }
+
+    if (bytes > 0)
+        pbump(-static_cast<int>(bytes));
+
+    return 0;
+}
+
+bool zstdstreambuf::write_out(const ZSTD_outBuffer& out)
+{
+    return std::fwrite(out.dst, sizeof(char), out.pos, file_) == out.pos;
+}
+
+bool zstdstreambuf::end_frame()
+{
+    ZSTD_inBuffer in;
+    in.src = nullptr;
+    in.size = 0;
+    in.pos = 0;
+
+    std::size_t remaining;
+    do
+    {
+        ZSTD_outBuffer out;
+        out.dst = &out_buffer_[0];
+        out.size = out_buffer_.size();
+        out.pos = 0;
+
+        remaining = ZSTD_compressStream2(cstream_, &out, &in, ZSTD_e_end);
+        throw_if_error(remaining, "Encoder error");
+
+        if (!write_out(out))
+            return false;
+    } while (remaining != 0);
+
+    frame_bytes_ = 0;
+    ++frames_written_;
+    return true;
+}
+
+bool zstdstreambuf::is_open() const
+{
+    return file_ != nullptr && !::ferror(file_);
+}
+
+uint64_t zstdstreambuf::bytes_read() const
+{
+    return bytes_read_;
+}
+
+zstdifstream::zstdifstream(std::string name)
+    : std::istream{&buffer_}, buffer_{name.c_str(), "rb"}
+{
+    clear();
+}
+
+zstdstreambuf* zstdifstream::rdbuf() const
+{
+    return const_cast<zstdstreambuf*>(&buffer_);
+}
+
+void zstdifstream::flush()
+{
+    buffer_.sync();
+}
+
+uint64_t zstdifstream::bytes_read() const
+{
+    return buffer_.bytes_read();
+}
+
+zstdofstream::zstdofstream(std::string name)
+    : std::ostream{&buffer_}, buffer_{name.c_str(), "wb"}
+{
+    clear();
+}
+
+zstdstreambuf* zstdofstream::rdbuf() const
+{
+    return const_cast<zstdstreambuf*>(&buffer_);
+}
+
+void zstdofstream::flush()
+{
+    buffer_.sync();
+}
+
+namespace
+{
+
+std::vector<char> decompress_frame(const char* data, std::size_t size)
+{
+    auto dstream = ZSTD_createDStream();
+    if (!dstream)
+        throw zstd_exception{"Failed to initialize decoder", 0};
+
+    std::vector<char> result;
+    std::vector<char> chunk(ZSTD_DStreamOutSize());
+    try
+    {
+        ZSTD_inBuffer in;
+        in.src = data;
+        in.size = size;
+        in.pos = 0;
+        while (in.pos < in.size)
+        {
+            ZSTD_outBuffer out;
+            out.dst = &chunk[0];
+            out.size = chunk.size();
+            out.pos = 0;
+
+            auto ret = ZSTD_decompressStream(dstream, &out, &in);
+            throw_if_error(ret, "Decoder error");
+
+            result.insert(result.end(), &chunk[0], &chunk[0] + out.pos);
+            if (ret == 0)
+                break;
+        }
+    }
+    catch (...)
+    {
+        ZSTD_freeDStream(dstream);
+        throw;
+    }
+    ZSTD_freeDStream(dstream);
+    return result;
+}
+}
+
+uint64_t parallel_decompress(const std::string& input_path,
+                             const std::string& output_path,
+                             std::size_t num_threads)
+{
+    mmap_file input{input_path};
+
+    // metadata-only scan for the frame boundaries
+    std::vector<std::pair<uint64_t, uint64_t>> frames;
+    uint64_t pos = 0;
+    while (pos < input.size())
+    {
+        auto frame_size
+            = ZSTD_findFrameCompressedSize(input.begin() + pos,
+                                           input.size() - pos);
+        throw_if_error(frame_size, "Corrupt frame header in " + input_path);
+        frames.emplace_back(pos, frame_size);
+        pos += frame_size;
+    }
+
+    parallel::thread_pool pool{std::max<std::size_t>(1, num_threads)};
+    std::vector<std::future<std::vector<char>>> results;
+    results.reserve(frames.size());
+    for (const auto& frame : frames)
+    {
+        auto offset = frame.first;
+        auto length = frame.second;
+        results.emplace_back(pool.submit_task([&input, offset, length]() {
+            return decompress_frame(input.begin() + offset, length);
+        }));
+    }
+
+    uint64_t total = 0;
+    std::ofstream output{output_path, std::ios::binary};
+    for (auto& result : results)
+    {
+        auto bytes = result.get();
+        output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        total += bytes.size();
+    }
+    return total;
+}
+}
+}
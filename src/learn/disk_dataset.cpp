@@ -0,0 +1,170 @@
+/**
+ * @file disk_dataset.cpp
+ * @author Chase Geigle
+ */
+
+#include <fstream>
+
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
+#include "meta/learn/disk_dataset.h"
+#include "meta/util/progress.h"
+
+namespace meta
+{
+namespace learn
+{
+
+namespace
+{
+/**
+ * An io::packed input stream over a position in a memory mapped file.
+ */
+struct buffer_istream
+{
+    int get()
+    {
+        return static_cast<unsigned char>(*pos++);
+    }
+
+    const char* pos;
+};
+
+uint64_t read_total_features(const std::string& path)
+{
+    std::ifstream index{path + ".index", std::ios::binary};
+    if (!index)
+        throw std::runtime_error{"disk_dataset index not found: " + path
+                                 + ".index"};
+    return io::packed::read<uint64_t>(index);
+}
+}
+
+const constexpr uint64_t disk_dataset::default_cache_size;
+
+disk_dataset::disk_dataset(std::shared_ptr<index::forward_index> idx,
+                           std::vector<doc_id> docs, const std::string& path,
+                           uint64_t cache_size)
+    : dataset{[&]()
+              {
+                  if (!filesystem::file_exists(path)
+                      || !filesystem::file_exists(path + ".index"))
+                      return write_packed(*idx, docs, path);
+                  return static_cast<size_type>(read_total_features(path));
+              }()},
+      cache_size_{cache_size}
+{
+    open(path);
+}
+
+disk_dataset::disk_dataset(const std::string& path, uint64_t cache_size)
+    : dataset{read_total_features(path)}, cache_size_{cache_size}
+{
+    open(path);
+}
+
+auto disk_dataset::write_packed(index::forward_index& idx,
+                                const std::vector<doc_id>& docs,
+                                const std::string& path) -> size_type
+{
+    std::ofstream data{path, std::ios::binary};
+    std::vector<uint64_t> offsets;
+    offsets.reserve(docs.size() + 1);
+
+    printing::progress progress{" > Packing instances to disk: ",
+                                docs.size()};
+    uint64_t written = 0;
+    uint64_t pos = 0;
+    for (const auto& d_id : docs)
+    {
+        progress(written++);
+        offsets.push_back(pos);
+
+        auto stream = idx.stream_for(d_id);
+        std::vector<std::pair<feature_id, double>> weights{stream->begin(),
+                                                           stream->end()};
+
+        pos += io::packed::write(data, weights.size());
+        auto prev = feature_id{0};
+        for (const auto& pr : weights)
+        {
+            // feature ids are sorted, so delta encoding keeps the
+            // packed ints small
+            pos += io::packed::write(
+                data, static_cast<uint64_t>(pr.first - prev));
+            pos += io::packed::write(data, pr.second);
+            prev = pr.first;
+        }
+    }
+    offsets.push_back(pos);
+
+    std::ofstream index{path + ".index", std::ios::binary};
+    io::packed::write(index, idx.unique_terms());
+    io::packed::write(index, offsets.size());
+    for (auto off : offsets)
+        io::packed::write(index, off);
+
+    return idx.unique_terms();
+}
+
+void disk_dataset::open(const std::string& path)
+{
+    std::ifstream index{path + ".index", std::ios::binary};
+    io::packed::read<uint64_t>(index); // total features, read by the base
+    auto num_offsets = io::packed::read<uint64_t>(index);
+    offsets_.reserve(num_offsets);
+    for (uint64_t i = 0; i < num_offsets; ++i)
+        offsets_.push_back(io::packed::read<uint64_t>(index));
+
+    data_ = io::mmap_file{path};
+}
+
+auto disk_dataset::size() const -> size_type
+{
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+}
+
+auto disk_dataset::decode(size_type index) const -> instance_type
+{
+    buffer_istream stream{data_->begin() + offsets_.at(index)};
+
+    auto nnz = io::packed::read<uint64_t>(stream);
+    std::vector<std::pair<feature_id, double>> contents;
+    contents.reserve(nnz);
+
+    auto fid = uint64_t{0};
+    for (uint64_t i = 0; i < nnz; ++i)
+    {
+        fid += io::packed::read<uint64_t>(stream);
+        auto weight = io::packed::read<double>(stream);
+        contents.emplace_back(feature_id{fid}, weight);
+    }
+
+    feature_vector weights;
+    weights.contents(std::move(contents));
+    return {instance_id{index}, std::move(weights)};
+}
+
+auto disk_dataset::operator()(size_type index) const -> const instance_type&
+{
+    auto it = cached_.find(index);
+    if (it != cached_.end())
+    {
+        // move to the front of the LRU list
+        cache_.splice(cache_.begin(), cache_, it->second);
+        return it->second->second;
+    }
+
+    cache_.emplace_front(index, decode(index));
+    cached_[index] = cache_.begin();
+
+    while (cache_.size() > cache_size_)
+    {
+        cached_.erase(cache_.back().first);
+        cache_.pop_back();
+    }
+
+    return cache_.front().second;
+}
+}
+}
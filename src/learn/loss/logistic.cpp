@@ -3,8 +3,11 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
+
 #include "meta/learn/loss/logistic.h"
 #include "meta/io/packed.h"
+#include "meta/math/fastapprox_batch.h"
 
 namespace meta
 {
@@ -25,6 +28,59 @@ double logistic::derivative(double prediction, double expected) const
     return -expected / (std::exp(prediction * expected) + 1);
 }
 
+namespace
+{
+/// staging buffer length for the vectorized transcendental kernels
+const constexpr std::size_t chunk_size = 256;
+}
+
+void logistic::evaluate(util::array_view<const double> predictions,
+                        util::array_view<const double> expected,
+                        util::array_view<double> out) const
+{
+    // stage the margins through a float buffer in chunks so the
+    // transcendentals run through the vectorized batch kernels
+    float buf[chunk_size];
+    for (std::size_t start = 0; start < predictions.size();
+         start += chunk_size)
+    {
+        auto len = std::min(chunk_size, predictions.size() - start);
+        util::array_view<float> view{buf, len};
+
+        for (std::size_t i = 0; i < len; ++i)
+            buf[i] = -static_cast<float>(predictions[start + i]
+                                         * expected[start + i]);
+        fastapprox::fastexp(view, view);
+        for (std::size_t i = 0; i < len; ++i)
+            buf[i] += 1.0f;
+        fastapprox::fastlog(view, view);
+
+        for (std::size_t i = 0; i < len; ++i)
+            out[start + i] = buf[i];
+    }
+}
+
+void logistic::evaluate_derivative(util::array_view<const double> predictions,
+                                   util::array_view<const double> expected,
+                                   util::array_view<double> out) const
+{
+    float buf[chunk_size];
+    for (std::size_t start = 0; start < predictions.size();
+         start += chunk_size)
+    {
+        auto len = std::min(chunk_size, predictions.size() - start);
+        util::array_view<float> view{buf, len};
+
+        for (std::size_t i = 0; i < len; ++i)
+            buf[i] = static_cast<float>(predictions[start + i]
+                                        * expected[start + i]);
+        fastapprox::fastexp(view, view);
+
+        for (std::size_t i = 0; i < len; ++i)
+            out[start + i] = -expected[start + i] / (buf[i] + 1.0f);
+    }
+}
+
 void logistic::save(std::ostream& out) const
 {
     io::packed::write(out, id);
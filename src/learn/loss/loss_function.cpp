@@ -0,0 +1,38 @@
+/**
+ * @file loss_function.cpp
+ * @author Chase Geigle
+ */
+
+#include <cassert>
+
+#include "meta/learn/loss/loss_function.h"
+
+namespace meta
+{
+namespace learn
+{
+namespace loss
+{
+
+void loss_function::evaluate(util::array_view<const double> predictions,
+                             util::array_view<const double> expected,
+                             util::array_view<double> out) const
+{
+    assert(predictions.size() == expected.size());
+    assert(predictions.size() == out.size());
+    for (std::size_t i = 0; i < predictions.size(); ++i)
+        out[i] = loss(predictions[i], expected[i]);
+}
+
+void loss_function::evaluate_derivative(
+    util::array_view<const double> predictions,
+    util::array_view<const double> expected, util::array_view<double> out) const
+{
+    assert(predictions.size() == expected.size());
+    assert(predictions.size() == out.size());
+    for (std::size_t i = 0; i < predictions.size(); ++i)
+        out[i] = derivative(predictions[i], expected[i]);
+}
+}
+}
+}
@@ -143,6 +143,125 @@ double sgd_model::train_one(const feature_vector& x, double expected_label,
     return loss.loss(predicted, expected_label);
 }
 
+double sgd_model::train_batch_impl(const loss::loss_function& loss)
+{
+    if (batch_.empty())
+        return 0;
+
+    if (grad_.size() != weights_.size())
+    {
+        grad_.assign(weights_.size(), 0.0);
+        in_batch_.assign(weights_.size(), 0);
+    }
+
+    // pass 1: predictions against the current weights for the whole
+    // batch
+    predictions_.clear();
+    expected_.clear();
+    for (const auto& inst : batch_)
+    {
+        const auto& x = *inst.first;
+        t_ += 1;
+
+        auto predicted = 0.0;
+        for (const auto& pr : x)
+        {
+            auto abs_val = std::abs(pr.second);
+            auto& weight_val = weights_.at(pr.first);
+            if (abs_val > weight_val.scale)
+            {
+                weight_val.weight *= weight_val.scale / abs_val;
+                weight_val.scale = abs_val;
+            }
+
+            if (weight_val.scale > 0)
+                update_scale_ += (pr.second * pr.second)
+                                 / (weight_val.scale * weight_val.scale);
+
+            predicted += pr.second * scale_ * weight_val.weight;
+        }
+
+        // handle the bias (we treat it as always being 1)
+        update_scale_ += 1.0;
+        predicted += scale_ * bias_.weight;
+
+        predictions_.push_back(predicted);
+        expected_.push_back(inst.second);
+    }
+
+    // evaluate the loss and its derivative for the whole batch at once,
+    // letting the loss function use its vectorized kernel if it has one
+    derivatives_.resize(batch_.size());
+    losses_.resize(batch_.size());
+    loss.evaluate_derivative(predictions_, expected_, derivatives_);
+    loss.evaluate(predictions_, expected_, losses_);
+    auto total_loss = std::accumulate(losses_.begin(), losses_.end(), 0.0);
+
+    // accumulate each instance's gradient into the dense buffer
+    auto bias_grad = 0.0;
+    for (std::size_t i = 0; i < batch_.size(); ++i)
+    {
+        auto error_derivative = derivatives_[i];
+        bias_grad += error_derivative;
+
+        for (const auto& pr : *batch_[i].first)
+        {
+            if (pr.second == 0.0)
+                continue;
+            if (!in_batch_[pr.first])
+            {
+                in_batch_[pr.first] = 1;
+                touched_.push_back(pr.first);
+            }
+            grad_[pr.first] += error_derivative * pr.second;
+        }
+    }
+
+    // amortize the L2 shrinking and the renormalization check over the
+    // whole batch
+    scale_ *= std::pow(1.0 - lr_ * l2_regularization_,
+                       static_cast<double>(batch_.size()));
+    if (scale_ < 1e-10)
+    {
+        for (auto& weight_val : weights_)
+            weight_val.weight *= scale_;
+        bias_.weight *= scale_;
+        scale_ = 1;
+    }
+
+    // pass 2: apply the mean batch gradient with the NAG update
+    // equation, visiting only the touched features
+    auto delta = -lr_ * std::sqrt(t_ / update_scale_) / scale_;
+    auto inv_batch = 1.0 / static_cast<double>(batch_.size());
+    for (auto idx : touched_)
+    {
+        auto grad_f = grad_[idx] * inv_batch;
+        grad_[idx] = 0.0;
+        in_batch_[idx] = 0;
+        if (grad_f == 0.0)
+            continue;
+
+        auto& weight_val = weights_[idx];
+        weight_val.grad_squared += grad_f * grad_f;
+        weight_val.weight
+            += delta * grad_f
+               / (weight_val.scale * std::sqrt(weight_val.grad_squared));
+
+        if (l1_regularization_ > 0)
+            penalize(weight_val);
+    }
+    touched_.clear();
+
+    bias_grad *= inv_batch;
+    if (bias_grad != 0.0)
+    {
+        bias_.grad_squared += bias_grad * bias_grad;
+        bias_.weight += delta * bias_grad / std::sqrt(bias_.grad_squared);
+    }
+
+    return total_loss;
+}
+
 void sgd_model::penalize(weight_type& weight_val)
 {
     auto u = t_ * lr_ * l1_regularization_;
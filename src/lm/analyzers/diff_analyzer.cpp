@@ -47,7 +47,10 @@ void diff_analyzer::tokenize(const corpus::document& doc, featurizer& counts)
             continue;
         }
         else if (next != "<s>")
-            buffer += next + " ";
+        {
+            buffer.append(next.begin(), next.end());
+            buffer += ' ';
+        }
     }
 
     for (auto& s : sentences)
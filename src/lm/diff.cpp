@@ -4,6 +4,7 @@
  */
 
 #include <algorithm>
+#include <cmath>
 #include <queue>
 
 #include "meta/analyzers/filters/porter2_stemmer.h"
@@ -72,6 +73,65 @@ void diff::add(PQ& candidates, const sentence& sent)
     candidates.emplace(sent, score);
 }
 
+template <class PQ>
+void diff::add(PQ& candidates, const sentence& sent, double log_prob)
+{
+    seen_.insert(sent);
+    if (sent.size() == 0)
+        throw language_model_exception{"perplexity() called on empty sentence"};
+    auto ppw = std::pow(10.0, -(log_prob / sent.size())) / sent.size();
+    auto score = lambda_ * ppw + (1.0 - lambda_) * sent.average_weight();
+    candidates.emplace(sent, score);
+}
+
+auto diff::cache_sentence(const sentence& sent) const -> sentence_cache
+{
+    sentence_cache cache;
+    cache.states.reserve(sent.size() + 1);
+    cache.prefix.reserve(sent.size() + 1);
+
+    lm_state state;
+    lm_state state_next;
+    double total = 0;
+    cache.states.push_back(state);
+    cache.prefix.push_back(total);
+    for (uint64_t i = 0; i < sent.size(); ++i)
+    {
+        total += lm_.score(state, sent[i], state_next);
+        state = state_next;
+        cache.states.push_back(state);
+        cache.prefix.push_back(total);
+    }
+    return cache;
+}
+
+double diff::incremental_score(const sentence_cache& cache,
+                               const sentence& sent, uint64_t edit_idx,
+                               int64_t shift) const
+{
+    auto parent_size = static_cast<int64_t>(cache.prefix.size()) - 1;
+    auto total = cache.prefix[edit_idx];
+    lm_state state = cache.states[edit_idx];
+    lm_state state_next;
+    for (uint64_t i = edit_idx; i < sent.size(); ++i)
+    {
+        // past the edit point, the tokens match the original again
+        // (offset by shift); once the threaded state also matches the
+        // cached one the remaining scores are unchanged, so the cached
+        // suffix sum finishes the sentence
+        if (i > edit_idx)
+        {
+            auto j = static_cast<int64_t>(i) - shift;
+            if (j >= 0 && j <= parent_size
+                && state.previous == cache.states[j].previous)
+                return total + cache.prefix[parent_size] - cache.prefix[j];
+        }
+        total += lm_.score(state, sent[i], state_next);
+        state = state_next;
+    }
+    return total;
+}
+
 uint64_t diff::least_likely_ngram(const sentence& sent) const
 {
     double min_prob = 1;
@@ -91,15 +151,16 @@ uint64_t diff::least_likely_ngram(const sentence& sent) const
 }
 
 template <class PQ>
-void diff::lm_ops(const sentence& sent, PQ& candidates, uint64_t depth)
+void diff::lm_ops(const sentence_cache& cache, const sentence& sent,
+                  PQ& candidates, uint64_t depth)
 {
     auto best_idx = least_likely_ngram(sent);
 
     for (uint64_t i = 0; i < n_val_ && i < best_idx; ++i)
     {
-        insert(sent, best_idx - i, candidates, depth);
-        remove(sent, best_idx - i, candidates, depth);
-        substitute(sent, best_idx - i, candidates, depth);
+        insert(cache, sent, best_idx - i, candidates, depth);
+        remove(cache, sent, best_idx - i, candidates, depth);
+        substitute(cache, sent, best_idx - i, candidates, depth);
     }
 
     if (lm_generate_ && best_idx >= n_val_)
@@ -119,7 +180,8 @@ void diff::lm_ops(const sentence& sent, PQ& candidates, uint64_t depth)
 
                 if (seen_.find(ins_cpy) == seen_.end())
                 {
-                    add(candidates, ins_cpy);
+                    add(candidates, ins_cpy,
+                        incremental_score(cache, ins_cpy, best_idx, 1));
                     step(ins_cpy, candidates, depth + 1);
                 }
 
@@ -129,7 +191,8 @@ void diff::lm_ops(const sentence& sent, PQ& candidates, uint64_t depth)
 
                 if (seen_.find(sub_cpy) == seen_.end())
                 {
-                    add(candidates, sub_cpy);
+                    add(candidates, sub_cpy,
+                        incremental_score(cache, sub_cpy, best_idx, 0));
                     step(sub_cpy, candidates, depth + 1);
                 }
             }
@@ -142,8 +205,8 @@ void diff::lm_ops(const sentence& sent, PQ& candidates, uint64_t depth)
 }
 
 template <class PQ>
-void diff::insert(const sentence& sent, size_t idx, PQ& candidates,
-                  uint64_t depth)
+void diff::insert(const sentence_cache& cache, const sentence& sent,
+                  size_t idx, PQ& candidates, uint64_t depth)
 {
     for (const auto& fw : fwords_)
     {
@@ -151,15 +214,15 @@ void diff::insert(const sentence& sent, size_t idx, PQ& candidates,
         ins_cpy.insert(idx, fw, base_penalty_ + insert_penalty_);
         if (seen_.find(ins_cpy) == seen_.end())
         {
-            add(candidates, ins_cpy);
+            add(candidates, ins_cpy, incremental_score(cache, ins_cpy, idx, 1));
             step(ins_cpy, candidates, depth + 1);
         }
     }
 }
 
 template <class PQ>
-void diff::substitute(const sentence& sent, size_t idx, PQ& candidates,
-                      uint64_t depth)
+void diff::substitute(const sentence_cache& cache, const sentence& sent,
+                      size_t idx, PQ& candidates, uint64_t depth)
 {
     std::string stemmed{sent[idx]};
     analyzers::filters::porter2::stem(stemmed);
@@ -175,7 +238,8 @@ void diff::substitute(const sentence& sent, size_t idx, PQ& candidates,
             subbed.substitute(idx, stem, base_penalty_ + substitute_penalty_);
             if (seen_.find(subbed) == seen_.end())
             {
-                add(candidates, subbed);
+                add(candidates, subbed,
+                    incremental_score(cache, subbed, idx, 0));
                 step(subbed, candidates, depth + 1);
             }
         }
@@ -183,14 +247,14 @@ void diff::substitute(const sentence& sent, size_t idx, PQ& candidates,
 }
 
 template <class PQ>
-void diff::remove(const sentence& sent, size_t idx, PQ& candidates,
-                  uint64_t depth)
+void diff::remove(const sentence_cache& cache, const sentence& sent,
+                  size_t idx, PQ& candidates, uint64_t depth)
 {
     sentence rem_cpy{sent};
     rem_cpy.remove(idx, base_penalty_ + remove_penalty_);
     if (seen_.find(rem_cpy) == seen_.end())
     {
-        add(candidates, rem_cpy);
+        add(candidates, rem_cpy, incremental_score(cache, rem_cpy, idx, -1));
         step(rem_cpy, candidates, depth + 1);
     }
 }
@@ -201,15 +265,19 @@ void diff::step(const sentence& sent, PQ& candidates, size_t depth)
     if (depth == max_edits_)
         return;
 
+    // score the sentence once; every candidate below differs from it by
+    // a single edit and is scored incrementally off of this cache
+    auto cache = cache_sentence(sent);
+
     if (use_lm_)
-        lm_ops(sent, candidates, depth);
+        lm_ops(cache, sent, candidates, depth);
     else
     {
         for (size_t i = 0; i < sent.size(); ++i)
         {
-            remove(sent, i, candidates, depth);
-            insert(sent, i, candidates, depth);
-            substitute(sent, i, candidates, depth);
+            remove(cache, sent, i, candidates, depth);
+            insert(cache, sent, i, candidates, depth);
+            substitute(cache, sent, i, candidates, depth);
         }
     }
 }
@@ -8,6 +8,7 @@
  */
 
 #include "meta/lm/language_model.h"
+#include "meta/io/packed.h"
 #include "meta/lm/read_arpa.h"
 #include "meta/logging/logger.h"
 #include "meta/util/fixed_heap.h"
@@ -16,6 +17,7 @@
 
 #include <random>
 #include <sstream>
+#include <thread>
 
 namespace meta
 {
@@ -42,13 +44,35 @@ language_model::language_model(const cpptoml::table& config)
                                  + ".binlm");
         });
         LOG(info) << "Done. (" << time.count() << "ms)" << ENDLG;
+
+        // validate against the header if one was written with the binary
+        // files; this catches partial conversions and stale files
+        if (filesystem::file_exists(*binary_file + "binlm.header"))
+        {
+            std::ifstream header{*binary_file + "binlm.header",
+                                 std::ios::binary};
+            uint64_t order;
+            io::packed::read(header, order);
+            uint64_t count;
+            for (uint64_t i = 0; i < order; ++i)
+                io::packed::read(header, count);
+            uint64_t vocab_count;
+            io::packed::read(header, vocab_count);
+            if (order != N_ || vocab_count != vocabulary_.size())
+                throw language_model_exception{
+                    "binary language model files do not match their header; "
+                    "delete them and rebuild from the .arpa file"};
+        }
     }
     else if (arpa_file && binary_file)
     {
         LOG(info) << "Loading language model from .arpa file: " << *arpa_file
                   << ENDLG;
         prefix_ = *binary_file;
-        auto time = common::time([&]() { read_arpa_format(*arpa_file); });
+        auto quant_bits = static_cast<uint8_t>(
+            table->get_as<int64_t>("quantize-bits").value_or(0));
+        auto time = common::time(
+            [&]() { read_arpa_format(*arpa_file, quant_bits); });
         LOG(info) << "Done. (" << time.count() << "ms)" << ENDLG;
     }
     else
@@ -61,33 +85,137 @@ language_model::language_model(const cpptoml::table& config)
     unk_node_ = *lm_[0].find({unk_id_});
 }
 
-void language_model::read_arpa_format(const std::string& arpa_file)
+void language_model::read_arpa_format(const std::string& arpa_file,
+                                      uint8_t quant_bits)
 {
-    std::ifstream infile{arpa_file};
-    std::vector<uint64_t> count;
-    std::ofstream unigrams{prefix_ + "0.strings"};
-    term_id unigram_id{0};
-
-    read_arpa(
-        infile, [&](uint64_t /* order */,
-                    uint64_t ngramcount) { count.push_back(ngramcount); },
-        [&](uint64_t order, const std::string& ngram, float prob,
-            float backoff) {
-            if (lm_.size() < order + 1)
+    // first pass: read the header counts and record where each ngram
+    // section begins so the orders can be converted in parallel
+    std::vector<uint64_t> counts;
+    std::vector<std::streamoff> sections;
+    {
+        std::ifstream infile{arpa_file};
+        std::string buffer;
+        while (std::getline(infile, buffer))
+        {
+            if (buffer.find("ngram ") == 0)
             {
-                lm_.emplace_back(prefix_ + std::to_string(N_) + ".binlm",
-                                 count[N_]);
-                ++N_;
+                auto equal = buffer.find_first_of("=");
+                counts.push_back(std::stoul(buffer.substr(equal + 1)));
             }
-
-            if (order == 0)
+            else if (!buffer.empty() && buffer[0] == '\\'
+                     && buffer.find("-grams:") != std::string::npos)
             {
-                unigrams << ngram << "\n";
-                vocabulary_.emplace(ngram, unigram_id++);
+                sections.push_back(infile.tellg());
+                if (sections.size() == counts.size())
+                    break;
             }
+        }
+    }
+
+    if (counts.empty() || sections.size() != counts.size())
+        throw language_model_exception{"invalid .arpa format"};
+
+    N_ = counts.size();
+
+    // parses the lines of one ngram section on its own stream, invoking
+    // handler(ngram, prob, backoff) for each entry
+    auto parse_section = [&](std::streamoff offset, auto&& handler) {
+        std::ifstream infile{arpa_file};
+        infile.seekg(offset);
+        std::string buffer;
+        while (std::getline(infile, buffer))
+        {
+            if (buffer.empty())
+                continue;
+            if (buffer[0] == '\\')
+                break;
 
-            lm_.back().insert(token_list{ngram, vocabulary_}, prob, backoff);
+            auto first_tab = buffer.find_first_of('\t');
+            float prob = std::stof(buffer.substr(0, first_tab));
+            auto second_tab = buffer.find_first_of('\t', first_tab + 1);
+            auto ngram
+                = buffer.substr(first_tab + 1, second_tab - first_tab - 1);
+            float backoff = 0.0;
+            if (second_tab != std::string::npos)
+                backoff = std::stof(buffer.substr(second_tab + 1));
+
+            handler(ngram, prob, backoff);
+        }
+    };
+
+    // unigrams come first: they define the vocabulary that the higher
+    // orders are encoded against
+    // when quantizing, every order gets its codebooks from a first pass
+    // over its section before any values are inserted
+    auto quantize_section = [&](std::streamoff offset, uint64_t count,
+                                static_probe_map& table) {
+        std::vector<float> probs;
+        std::vector<float> backoffs;
+        probs.reserve(count);
+        backoffs.reserve(count);
+        parse_section(offset, [&](const std::string& /* ngram */, float prob,
+                                  float backoff) {
+            probs.push_back(prob);
+            backoffs.push_back(backoff);
+        });
+        table.quantize(std::move(probs), std::move(backoffs));
+    };
+
+    {
+        std::ofstream unigrams{prefix_ + "0.strings"};
+        term_id unigram_id{0};
+        lm_.emplace_back(prefix_ + "0.binlm", counts[0], quant_bits);
+        if (quant_bits != 0)
+            quantize_section(sections[0], counts[0], lm_[0]);
+        parse_section(sections[0], [&](const std::string& ngram, float prob,
+                                       float backoff) {
+            unigrams << ngram << "\n";
+            vocabulary_.emplace(ngram, unigram_id++);
+            lm_[0].insert(token_list{ngram, vocabulary_}, prob, backoff);
         });
+    }
+
+    // the remaining orders only read the vocabulary and each insert into
+    // their own table, so they can be converted concurrently
+    for (uint64_t ord = 1; ord < N_; ++ord)
+        lm_.emplace_back(prefix_ + std::to_string(ord) + ".binlm", counts[ord],
+                         quant_bits);
+
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(N_);
+    for (uint64_t ord = 1; ord < N_; ++ord)
+    {
+        workers.emplace_back([&, ord]() {
+            try
+            {
+                if (quant_bits != 0)
+                    quantize_section(sections[ord], counts[ord], lm_[ord]);
+                parse_section(sections[ord],
+                              [&](const std::string& ngram, float prob,
+                                  float backoff) {
+                                  lm_[ord].insert(
+                                      token_list{ngram, vocabulary_}, prob,
+                                      backoff);
+                              });
+            }
+            catch (...)
+            {
+                errors[ord] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    for (const auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+
+    // a header allows binary loads to detect partial or stale files
+    std::ofstream header{prefix_ + "binlm.header", std::ios::binary};
+    io::packed::write(header, N_);
+    for (const auto& count : counts)
+        io::packed::write(header, count);
+    io::packed::write(header, vocabulary_.size());
 }
 
 std::vector<std::pair<std::string, float>>
@@ -144,6 +272,48 @@ float language_model::log_prob(const token_list& tokens) const
     return prob;
 }
 
+std::vector<float>
+language_model::rescore_nbest(const std::vector<sentence>& hypotheses) const
+{
+    // trie over the hypothesis tokens; each node caches the cumulative
+    // log probability of its prefix and the lm_state needed to extend it
+    struct trie_node
+    {
+        std::unordered_map<term_id, std::size_t> children;
+        lm_state state;
+        float log_prob = 0.0f;
+    };
+    std::vector<trie_node> trie(1); // root: empty prefix, empty state
+
+    std::vector<float> scores;
+    scores.reserve(hypotheses.size());
+    for (const auto& hyp : hypotheses)
+    {
+        token_list tokens{hyp, vocabulary_};
+        std::size_t cur = 0;
+        for (const auto& token : tokens.tokens())
+        {
+            auto it = trie[cur].children.find(token);
+            if (it != trie[cur].children.end())
+            {
+                cur = it->second;
+                continue;
+            }
+
+            // unseen extension: score it once and cache the result
+            trie_node child;
+            child.log_prob = trie[cur].log_prob
+                             + score(trie[cur].state, token, child.state);
+            auto idx = trie.size();
+            trie[cur].children.emplace(token, idx);
+            trie.push_back(std::move(child));
+            cur = idx;
+        }
+        scores.push_back(trie[cur].log_prob);
+    }
+    return scores;
+}
+
 float language_model::perplexity(const sentence& tokens) const
 {
     if (tokens.size() == 0)
@@ -170,6 +340,12 @@ term_id language_model::unk() const
     return unk_id_;
 }
 
+float language_model::score(const lm_state& in_state, const std::string& token,
+                            lm_state& out_state) const
+{
+    return score(in_state, index(token), out_state);
+}
+
 float language_model::score(const lm_state& in_state, term_id token,
                             lm_state& out_state) const
 {
@@ -9,6 +9,7 @@
 
 #include <cassert>
 
+#include "meta/hashing/bloom_filter.h"
 #include "meta/io/filesystem.h"
 #include "meta/lm/mph_language_model.h"
 #include "meta/lm/ngram_map.h"
@@ -30,6 +31,7 @@ class ngram_handler
     using unigram_builder_type = ngram_map_builder<std::string>;
     using middle_builder_type = ngram_map_builder<std::vector<term_id>>;
     using last_builder_type = ngram_map_builder<std::vector<term_id>, float>;
+    using bloom_filter_type = hashing::bloom_filter<std::vector<term_id>>;
 
     ngram_handler(const std::string& prefix) : prefix_{prefix}
     {
@@ -102,6 +104,9 @@ class ngram_handler
 
             assert(ids.size() == order + 1);
 
+            assert(filter_);
+            filter_->insert(ids);
+
             prob_backoff<> value;
             value.prob = prob;
             value.backoff = backoff;
@@ -144,6 +149,7 @@ class ngram_handler
             filesystem::make_directory(options.prefix);
 
             middle_builder_ = make_unique<middle_builder_type>(options);
+            filter_ = make_unique<bloom_filter_type>(options.num_keys);
             progress_ = make_unique<printing::progress>(" > Reading 2-grams: ",
                                                         options.num_keys);
         }
@@ -152,6 +158,7 @@ class ngram_handler
         {
             assert(middle_builder_);
             middle_builder_->write();
+            write_filter();
 
             // set up the next middle builder
             if (order_ + 1 < counts_.size() - 1)
@@ -163,6 +170,7 @@ class ngram_handler
                 filesystem::make_directory(options.prefix);
 
                 middle_builder_ = make_unique<middle_builder_type>(options);
+                filter_ = make_unique<bloom_filter_type>(options.num_keys);
                 progress_ = make_unique<printing::progress>(
                     " > Reading " + std::to_string(order_ + 2) + "-grams: ",
                     options.num_keys);
@@ -179,6 +187,7 @@ class ngram_handler
                 filesystem::make_directory(options.prefix);
 
                 last_builder_ = make_unique<last_builder_type>(options);
+                filter_ = make_unique<bloom_filter_type>(options.num_keys);
                 progress_ = make_unique<printing::progress>(
                     " > Reading " + std::to_string(order_ + 2) + "-grams: ",
                     options.num_keys);
@@ -189,11 +198,22 @@ class ngram_handler
         {
             assert(last_builder_);
             last_builder_->write();
+            write_filter();
             last_builder_ = nullptr;
         }
     }
 
   private:
+    void write_filter()
+    {
+        assert(filter_);
+        std::ofstream output{prefix_ + "/" + std::to_string(order_)
+                                 + "/bloom.bin",
+                             std::ios::binary};
+        filter_->save(output);
+        filter_ = nullptr;
+    }
+
     std::string prefix_;
     uint64_t order_ = 0;
     uint64_t observed_ = 0;
@@ -203,6 +223,7 @@ class ngram_handler
     std::unique_ptr<ngram_map<util::string_view>> unigrams_;
     std::unique_ptr<middle_builder_type> middle_builder_;
     std::unique_ptr<last_builder_type> last_builder_;
+    std::unique_ptr<bloom_filter_type> filter_;
 };
 
 uint64_t build_from_arpa(const std::string& arpa_file,
@@ -229,6 +250,7 @@ struct mph_language_model::impl
     using unigram_map_type = ngram_map<util::string_view>;
     using middle_map_type = ngram_map<std::vector<term_id>>;
     using last_map_type = ngram_map<std::vector<term_id>, float>;
+    using bloom_filter_type = hashing::bloom_filter<std::vector<term_id>>;
 
     impl(const std::string& prefix, uint64_t ord)
         : order{ord},
@@ -242,6 +264,19 @@ struct mph_language_model::impl
             middle_vec.push_back(std::move(mid));
         }
 
+        // the filters are optional: binary files converted before they
+        // were introduced simply take the full probe path
+        filters.resize(order);
+        for (uint64_t i = 1; i <= order; ++i)
+        {
+            auto path = prefix + "/" + std::to_string(i) + "/bloom.bin";
+            if (filesystem::file_exists(path))
+            {
+                std::ifstream input{path, std::ios::binary};
+                filters[i - 1] = make_unique<bloom_filter_type>(input);
+            }
+        }
+
         unk = *unigrams.index_and_value("<unk>");
     }
 
@@ -250,11 +285,24 @@ struct mph_language_model::impl
         return *middle_vec[len - 2];
     }
 
+    /**
+     * Consults the Bloom filter for ngrams of this length (if one was
+     * built) before the caller pays for the perfect hash probe; at high
+     * orders the overwhelmingly common case during beam search is a
+     * miss, which the filter rejects without touching the values file.
+     */
+    bool may_contain(const std::vector<term_id>& ngram) const
+    {
+        const auto& filter = filters[ngram.size() - 2];
+        return !filter || filter->contains(ngram);
+    }
+
     uint64_t order;
     hashing::indexed_value<prob_backoff<>> unk;
     unigram_map_type unigrams;
     std::vector<std::unique_ptr<middle_map_type>> middle_vec;
     last_map_type last;
+    std::vector<std::unique_ptr<bloom_filter_type>> filters;
 };
 
 mph_language_model::mph_language_model(const cpptoml::table& config)
@@ -320,10 +368,13 @@ float mph_language_model::score(const lm_state& in_state, term_id token,
     // (1) Find the longest matching ngram
     if (out_state.previous.size() == impl_->order + 1)
     {
-        if (auto full = impl_->last.at(out_state.previous))
+        if (impl_->may_contain(out_state.previous))
         {
-            out_state.shrink();
-            return *full;
+            if (auto full = impl_->last.at(out_state.previous))
+            {
+                out_state.shrink();
+                return *full;
+            }
         }
         out_state.shrink();
     }
@@ -331,11 +382,14 @@ float mph_language_model::score(const lm_state& in_state, term_id token,
     float res = 0;
     while (out_state.previous.size() > 1)
     {
-        const auto& table = impl_->middle(out_state.previous.size());
-        if (auto mid = table.at(out_state.previous))
+        if (impl_->may_contain(out_state.previous))
         {
-            res = mid->prob;
-            break;
+            const auto& table = impl_->middle(out_state.previous.size());
+            if (auto mid = table.at(out_state.previous))
+            {
+                res = mid->prob;
+                break;
+            }
         }
         out_state.shrink();
     }
@@ -5,37 +5,151 @@
 
 #include "meta/lm/static_probe_map.h"
 #include "meta/hashing/hash.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
+#include "meta/lm/quantize.h"
+#include "meta/util/shim.h"
+
+#include <fstream>
 
 namespace meta
 {
 namespace lm
 {
 static_probe_map::static_probe_map(const std::string& filename,
-                                   uint64_t num_elems)
-    : table_{filename, static_cast<uint64_t>((num_elems / 0.7) * 2)}
-// load factor of 0.7; x2 for keys and vals
+                                   uint64_t num_elems, uint8_t quant_bits)
+    : filename_{filename}, quant_bits_{quant_bits}
+{
+    if (num_elems == 0)
+    {
+        // load a previously created table; a codebook file indicates it
+        // was built with quantization
+        if (filesystem::file_exists(filename + ".quant"))
+        {
+            std::ifstream quant{filename + ".quant", std::ios::binary};
+            io::packed::read(quant, quant_bits_);
+            uint64_t book_size;
+            io::packed::read(quant, book_size);
+            prob_book_.resize(book_size);
+            for (auto& val : prob_book_)
+                io::packed::read(quant, val);
+            io::packed::read(quant, book_size);
+            backoff_book_.resize(book_size);
+            for (auto& val : backoff_book_)
+                io::packed::read(quant, val);
+
+            keys_ = make_unique<util::disk_vector<uint64_t>>(filename);
+            if (quant_bits_ == 8)
+                codes8_ = make_unique<util::disk_vector<uint16_t>>(filename
+                                                                   + ".codes");
+            else
+                codes16_ = make_unique<util::disk_vector<uint32_t>>(
+                    filename + ".codes");
+        }
+        else
+        {
+            quant_bits_ = 0;
+            table_ = make_unique<util::disk_vector<uint64_t>>(filename);
+        }
+        return;
+    }
+
+    if (quant_bits_ == 0)
+    {
+        // load factor of 0.7; x2 for keys and vals
+        table_ = make_unique<util::disk_vector<uint64_t>>(
+            filename, static_cast<uint64_t>((num_elems / 0.7) * 2));
+    }
+    else if (quant_bits_ == 8 || quant_bits_ == 16)
+    {
+        // quantized tables keep keys and codes in separate arrays so
+        // probing only touches the (denser) key array
+        auto num_slots = static_cast<uint64_t>(num_elems / 0.7);
+        keys_ = make_unique<util::disk_vector<uint64_t>>(filename, num_slots);
+        if (quant_bits_ == 8)
+            codes8_ = make_unique<util::disk_vector<uint16_t>>(
+                filename + ".codes", num_slots);
+        else
+            codes16_ = make_unique<util::disk_vector<uint32_t>>(
+                filename + ".codes", num_slots);
+    }
+    else
+        throw static_probe_map_exception{
+            "quantization width must be 0, 8, or 16 bits"};
+}
+
+void static_probe_map::quantize(std::vector<float> probs,
+                                std::vector<float> backoffs)
 {
+    if (quant_bits_ == 0)
+        throw static_probe_map_exception{
+            "quantize() called on an unquantized table"};
+
+    auto max_bins = uint64_t{1} << quant_bits_;
+    prob_book_ = quantize::build_codebook(std::move(probs), max_bins);
+    backoff_book_ = quantize::build_codebook(std::move(backoffs), max_bins);
+
+    std::ofstream quant{filename_ + ".quant", std::ios::binary};
+    io::packed::write(quant, quant_bits_);
+    io::packed::write(quant, prob_book_.size());
+    for (auto val : prob_book_)
+        io::packed::write(quant, val);
+    io::packed::write(quant, backoff_book_.size());
+    for (auto val : backoff_book_)
+        io::packed::write(quant, val);
 }
 
 void static_probe_map::insert(const token_list& key, float prob, float backoff)
 {
     auto hashed = hash(key.tokens());
-    auto idx = (hashed % (table_.size() / 2)) * 2;
+
+    if (quant_bits_ != 0)
+    {
+        if (prob_book_.empty())
+            throw static_probe_map_exception{
+                "quantize() must be called before inserting"};
+
+        auto idx = hashed % keys_->size();
+        while (true)
+        {
+            if ((*keys_)[idx] == uint64_t{0})
+            {
+                (*keys_)[idx] = hashed;
+                auto pcode = quantize::encode(prob_book_, prob);
+                auto bcode = quantize::encode(backoff_book_, backoff);
+                if (quant_bits_ == 8)
+                    (*codes8_)[idx]
+                        = static_cast<uint16_t>((pcode << 8) | bcode);
+                else
+                    (*codes16_)[idx]
+                        = static_cast<uint32_t>((pcode << 16) | bcode);
+                return;
+            }
+
+            if ((*keys_)[idx] == hashed)
+                throw static_probe_map_exception{
+                    "key already exists (or collision)"};
+
+            idx = (idx + 1) % keys_->size();
+        }
+    }
+
+    auto idx = (hashed % (table_->size() / 2)) * 2;
 
     while (true)
     {
-        if (table_[idx] == uint64_t{0})
+        if ((*table_)[idx] == uint64_t{0})
         {
-            table_[idx] = hashed;
-            table_[idx + 1] = lm_node::write_packed(prob, backoff);
+            (*table_)[idx] = hashed;
+            (*table_)[idx + 1] = lm_node::write_packed(prob, backoff);
             return;
         }
 
-        if (table_[idx] == hashed)
+        if ((*table_)[idx] == hashed)
             throw static_probe_map_exception{
                 "key already exists (or collision)"};
 
-        idx = (idx + 2) % table_.size();
+        idx = (idx + 2) % table_->size();
     }
 }
 
@@ -47,17 +161,48 @@ static_probe_map::find(const std::vector<term_id>& ngram) const
 
 util::optional<lm_node> static_probe_map::find_hash(uint64_t hashed) const
 {
-    auto idx = (hashed % (table_.size() / 2)) * 2;
+    if (quant_bits_ != 0)
+    {
+        auto idx = hashed % keys_->size();
+        while (true)
+        {
+            if ((*keys_)[idx] == uint64_t{0})
+                return util::nullopt;
+
+            if ((*keys_)[idx] == hashed)
+            {
+                uint64_t pcode;
+                uint64_t bcode;
+                if (quant_bits_ == 8)
+                {
+                    auto codes = (*codes8_)[idx];
+                    pcode = codes >> 8;
+                    bcode = codes & 0xff;
+                }
+                else
+                {
+                    auto codes = (*codes16_)[idx];
+                    pcode = codes >> 16;
+                    bcode = codes & 0xffff;
+                }
+                return {lm_node{prob_book_[pcode], backoff_book_[bcode]}};
+            }
+
+            idx = (idx + 1) % keys_->size();
+        }
+    }
+
+    auto idx = (hashed % (table_->size() / 2)) * 2;
 
     while (true)
     {
-        if (table_[idx] == uint64_t{0})
+        if ((*table_)[idx] == uint64_t{0})
             return util::nullopt;
 
-        if (table_[idx] == hashed)
-            return {table_[idx + 1]};
+        if ((*table_)[idx] == hashed)
+            return {(*table_)[idx + 1]};
 
-        idx = (idx + 2) % table_.size();
+        idx = (idx + 2) % table_->size();
     }
 }
 
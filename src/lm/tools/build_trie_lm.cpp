@@ -0,0 +1,27 @@
+/**
+ * @file build_trie_lm.cpp
+ * @author Sean Massung
+ */
+
+#include <iostream>
+
+#include "meta/lm/trie_language_model.h"
+#include "meta/logging/logger.h"
+
+int main(int argc, char** argv)
+{
+    using namespace meta;
+
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " config.toml" << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging();
+
+    auto config = cpptoml::parse_file(argv[1]);
+
+    lm::trie_language_model model{*config};
+    return 0;
+}
@@ -33,7 +33,7 @@ lm::sentence tokenize_sentence(std::string& line, const cpptoml::table& config)
     lm::sentence sent; // create empty sentence
     stream->set_content(std::move(line));
     while (*stream)
-        sent.push_back(stream->next());
+        sent.push_back(stream->next().to_string());
 
     return sent;
 }
@@ -0,0 +1,467 @@
+/**
+ * @file trie_language_model.cpp
+ * @author Sean Massung
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#include "meta/lm/trie_language_model.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
+#include "meta/lm/quantize.h"
+#include "meta/lm/read_arpa.h"
+#include "meta/lm/token_list.h"
+#include "meta/logging/logger.h"
+#include "meta/util/shim.h"
+#include "meta/util/time.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+namespace meta
+{
+namespace lm
+{
+
+namespace
+{
+/**
+ * Compares two ngrams of the same length most-recent-word first, which is
+ * the order the trie needs: ngrams sharing a parent (everything but the
+ * oldest word) become contiguous, parent groups appear in the same order
+ * as the parents themselves, and children within a group are sorted by
+ * their oldest word.
+ */
+int compare_reversed(const term_id* a, const term_id* b, uint64_t len)
+{
+    for (uint64_t j = len; j-- > 0;)
+    {
+        if (a[j] != b[j])
+            return a[j] < b[j] ? -1 : 1;
+    }
+    return 0;
+}
+
+}
+
+trie_language_model::trie_language_model(const cpptoml::table& config)
+{
+    auto table = config.get_table("language-model");
+    auto arpa_file = table->get_as<std::string>("arpa-file");
+    auto binary_file = table->get_as<std::string>("binary-file-prefix");
+
+    if (binary_file && filesystem::file_exists(*binary_file + "trie-meta.bin"))
+    {
+        LOG(info) << "Loading language model from binary files: "
+                  << *binary_file << "trie-*" << ENDLG;
+        auto time = common::time([&]() {
+            prefix_ = *binary_file;
+            load_vocab();
+            load_binary();
+        });
+        LOG(info) << "Done. (" << time.count() << "ms)" << ENDLG;
+    }
+    else if (arpa_file && binary_file)
+    {
+        LOG(info) << "Loading language model from .arpa file: " << *arpa_file
+                  << ENDLG;
+        auto time = common::time([&]() {
+            prefix_ = *binary_file;
+            build(*arpa_file);
+            load_binary();
+        });
+        LOG(info) << "Done. (" << time.count() << "ms)" << ENDLG;
+    }
+    else
+        throw trie_language_model_exception{
+            "arpa-file or binary-file-prefix needed in config file"};
+
+    unk_id_ = vocabulary_.at("<unk>");
+}
+
+void trie_language_model::build(const std::string& arpa_file)
+{
+    std::ifstream infile{arpa_file};
+
+    /// In-memory staging for one order before sorting and bit-packing
+    struct staged_order
+    {
+        std::vector<term_id> words;
+        std::vector<float> probs;
+        std::vector<float> backoffs;
+    };
+    std::vector<staged_order> staged;
+    std::vector<uint64_t> header_counts;
+
+    std::ofstream unigram_strings{prefix_ + "trie-0.strings"};
+    term_id unigram_id{0};
+
+    read_arpa(infile,
+              [&](uint64_t /* order */, uint64_t ngramcount) {
+                  header_counts.push_back(ngramcount);
+              },
+              [&](uint64_t order, const std::string& ngram, float prob,
+                  float backoff) {
+                  if (staged.size() < order + 1)
+                  {
+                      staged.emplace_back();
+                      if (order < header_counts.size())
+                      {
+                          staged.back().words.reserve(header_counts[order]
+                                                      * (order + 1));
+                          staged.back().probs.reserve(header_counts[order]);
+                          staged.back().backoffs.reserve(header_counts[order]);
+                      }
+                  }
+
+                  if (order == 0)
+                  {
+                      unigram_strings << ngram << "\n";
+                      vocabulary_.emplace(ngram, unigram_id++);
+                  }
+
+                  token_list tokens{ngram, vocabulary_};
+                  if (tokens.size() != order + 1)
+                      throw trie_language_model_exception{
+                          "ngram length does not match its section in "
+                          + arpa_file};
+
+                  auto& st = staged[order];
+                  for (uint64_t i = 0; i < tokens.size(); ++i)
+                      st.words.push_back(tokens[i]);
+                  st.probs.push_back(prob);
+                  st.backoffs.push_back(backoff);
+              });
+
+    N_ = staged.size();
+    if (N_ == 0)
+        throw trie_language_model_exception{"no ngrams found in " + arpa_file};
+
+    // unigrams are indexed directly by word id and keep exact values
+    const auto& uni = staged[0];
+    {
+        util::disk_vector<uint64_t> nodes{prefix_ + "trie-unigrams.bin",
+                                          uni.probs.size()};
+        for (uint64_t i = 0; i < uni.probs.size(); ++i)
+            nodes[i] = lm_node::write_packed(uni.probs[i], uni.backoffs[i]);
+    }
+
+    // sort every higher order most-recent-word first so that each ngram
+    // is adjacent to its siblings and parent groups are monotonic
+    std::vector<std::vector<uint64_t>> sorted(N_);
+    for (uint64_t ord = 2; ord <= N_; ++ord)
+    {
+        const auto& st = staged[ord - 1];
+        auto& idx = sorted[ord - 1];
+        idx.resize(st.probs.size());
+        std::iota(idx.begin(), idx.end(), 0ul);
+        std::sort(idx.begin(), idx.end(), [&](uint64_t a, uint64_t b) {
+            return compare_reversed(&st.words[a * ord], &st.words[b * ord],
+                                    ord) < 0;
+        });
+    }
+
+    std::ofstream meta{prefix_ + "trie-meta.bin", std::ios::binary};
+    io::packed::write(meta, N_);
+    for (uint64_t ord = 1; ord <= N_; ++ord)
+        io::packed::write(meta, staged[ord - 1].probs.size());
+
+    for (uint64_t ord = 2; ord <= N_; ++ord)
+    {
+        const auto& st = staged[ord - 1];
+        const auto& idx = sorted[ord - 1];
+        auto parent_count = staged[ord - 2].probs.size();
+
+        // count the children of each node of the previous order; the
+        // parent of an ngram is the ngram less its oldest word, which
+        // must itself be in the model (the ARPA suffix property)
+        std::vector<uint64_t> child_count(parent_count, 0);
+        uint64_t p = 0;
+        for (auto i : idx)
+        {
+            const term_id* gram = &st.words[i * ord];
+            if (ord == 2)
+            {
+                p = static_cast<uint64_t>(gram[1]);
+                if (p >= parent_count)
+                    throw trie_language_model_exception{
+                        "bigram context word missing from unigrams"};
+            }
+            else
+            {
+                const auto& par = staged[ord - 2];
+                const auto& pidx = sorted[ord - 2];
+                while (p < parent_count
+                       && compare_reversed(&par.words[pidx[p] * (ord - 1)],
+                                           gram + 1, ord - 1) < 0)
+                    ++p;
+                if (p == parent_count
+                    || compare_reversed(&par.words[pidx[p] * (ord - 1)],
+                                        gram + 1, ord - 1) != 0)
+                    throw trie_language_model_exception{
+                        arpa_file + " violates the suffix property needed "
+                                    "for trie storage"};
+            }
+            ++child_count[p];
+        }
+
+        std::vector<uint64_t> offsets(parent_count + 1, 0);
+        std::partial_sum(child_count.begin(), child_count.end(),
+                         offsets.begin() + 1);
+        succinct::make_compressed_vector(prefix_ + "trie-"
+                                             + std::to_string(ord - 1)
+                                             + ".children",
+                                         offsets.begin(), offsets.end());
+
+        auto base = prefix_ + "trie-" + std::to_string(ord);
+        std::vector<uint64_t> packed(idx.size());
+
+        std::transform(idx.begin(), idx.end(), packed.begin(),
+                       [&](uint64_t i) {
+                           return static_cast<uint64_t>(st.words[i * ord]);
+                       });
+        succinct::make_compressed_vector(base + ".words", packed.begin(),
+                                         packed.end());
+
+        auto prob_book = quantize::build_codebook(st.probs, 256);
+        std::transform(idx.begin(), idx.end(), packed.begin(),
+                       [&](uint64_t i) {
+                           return quantize::encode(prob_book, st.probs[i]);
+                       });
+        succinct::make_compressed_vector(base + ".probs", packed.begin(),
+                                         packed.end());
+        io::packed::write(meta, prob_book.size());
+        for (auto val : prob_book)
+            io::packed::write(meta, val);
+
+        if (ord < N_)
+        {
+            auto backoff_book = quantize::build_codebook(st.backoffs, 256);
+            std::transform(idx.begin(), idx.end(), packed.begin(),
+                           [&](uint64_t i) {
+                               return quantize::encode(backoff_book, st.backoffs[i]);
+                           });
+            succinct::make_compressed_vector(base + ".backoffs",
+                                             packed.begin(), packed.end());
+            io::packed::write(meta, backoff_book.size());
+            for (auto val : backoff_book)
+                io::packed::write(meta, val);
+        }
+    }
+}
+
+void trie_language_model::load_binary()
+{
+    std::ifstream meta{prefix_ + "trie-meta.bin", std::ios::binary};
+    if (!meta)
+        throw trie_language_model_exception{"missing binary file: " + prefix_
+                                            + "trie-meta.bin"};
+
+    io::packed::read(meta, N_);
+    std::vector<uint64_t> counts(N_);
+    for (auto& count : counts)
+        io::packed::read(meta, count);
+
+    unigrams_ = make_unique<util::disk_vector<uint64_t>>(prefix_
+                                                         + "trie-unigrams.bin");
+    if (unigrams_->size() != counts[0])
+        throw trie_language_model_exception{
+            "unigram file does not match the recorded ngram counts"};
+
+    orders_.clear();
+    if (N_ > 1)
+    {
+        unigram_children_ = make_unique<succinct::compressed_vector>(
+            prefix_ + "trie-1.children");
+        orders_.resize(N_ - 1);
+    }
+
+    for (uint64_t ord = 2; ord <= N_; ++ord)
+    {
+        auto& st = orders_[ord - 2];
+        auto base = prefix_ + "trie-" + std::to_string(ord);
+
+        st.words = make_unique<succinct::compressed_vector>(base + ".words");
+        st.probs = make_unique<succinct::compressed_vector>(base + ".probs");
+
+        uint64_t book_size;
+        io::packed::read(meta, book_size);
+        st.prob_book.resize(book_size);
+        for (auto& val : st.prob_book)
+            io::packed::read(meta, val);
+
+        if (ord < N_)
+        {
+            st.children = make_unique<succinct::compressed_vector>(
+                base + ".children");
+            st.backoffs = make_unique<succinct::compressed_vector>(
+                base + ".backoffs");
+
+            io::packed::read(meta, book_size);
+            st.backoff_book.resize(book_size);
+            for (auto& val : st.backoff_book)
+                io::packed::read(meta, val);
+        }
+    }
+}
+
+void trie_language_model::load_vocab()
+{
+    std::string word;
+    std::ifstream unigrams{prefix_ + "trie-0.strings"};
+    term_id cur{0};
+    while (std::getline(unigrams, word))
+    {
+        if (word.empty())
+            continue;
+
+        vocabulary_.emplace(word, cur++);
+    }
+}
+
+term_id trie_language_model::index(const std::string& token) const
+{
+    auto it = vocabulary_.find(token);
+    return it != vocabulary_.end() ? it->second : unk_id_;
+}
+
+term_id trie_language_model::unk() const
+{
+    return unk_id_;
+}
+
+util::optional<uint64_t> trie_language_model::find_child(uint64_t order,
+                                                         uint64_t node,
+                                                         term_id word) const
+{
+    if (order >= N_)
+        return util::nullopt;
+
+    const auto& children
+        = order == 1 ? *unigram_children_ : *orders_[order - 2].children;
+    const auto& words = *orders_[order - 1].words;
+    auto target = static_cast<uint64_t>(word);
+
+    auto begin = children[node];
+    auto end = children[node + 1];
+    while (begin < end)
+    {
+        auto mid = begin + (end - begin) / 2;
+        auto val = words[mid];
+        if (val < target)
+            begin = mid + 1;
+        else if (val > target)
+            end = mid;
+        else
+            return {mid};
+    }
+    return util::nullopt;
+}
+
+float trie_language_model::backoff(uint64_t order, uint64_t node) const
+{
+    if (order == 1)
+        return lm_node{(*unigrams_)[node]}.backoff;
+
+    const auto& st = orders_[order - 2];
+    return st.backoff_book[(*st.backoffs)[node]];
+}
+
+float trie_language_model::score(const lm_state& in_state, term_id token,
+                                 lm_state& out_state) const
+{
+    out_state = in_state;
+    out_state.previous.push_back(token);
+
+    const auto& context = in_state.previous;
+    auto vocab_size = unigrams_->size();
+
+    // (1) find the longest ngram ending in the token by extending it
+    // backward through the context one word at a time
+    auto node = static_cast<uint64_t>(token) < vocab_size
+                    ? static_cast<uint64_t>(token)
+                    : static_cast<uint64_t>(unk_id_);
+    float res = lm_node{(*unigrams_)[node]}.prob;
+    uint64_t matched = 1;
+    for (uint64_t d = 0; d < context.size() && matched < N_; ++d)
+    {
+        auto child = find_child(matched, node, context[context.size() - 1 - d]);
+        if (!child)
+            break;
+        node = *child;
+        ++matched;
+        const auto& st = orders_[matched - 2];
+        res = st.prob_book[(*st.probs)[node]];
+    }
+
+    while (out_state.previous.size() > std::min(matched, N_ - 1))
+        out_state.shrink();
+
+    if (matched > context.size())
+        return res;
+
+    // (2) apply backoff penalties for the context suffixes at least as
+    // long as the match, sharing a single backward walk; a suffix absent
+    // from the model contributes no penalty
+    uint64_t backoff_node = 0;
+    auto max_suffix = std::min<uint64_t>(context.size(), N_ - 1);
+    for (uint64_t d = 1; d <= max_suffix; ++d)
+    {
+        auto word = context[context.size() - d];
+        if (d == 1)
+        {
+            if (static_cast<uint64_t>(word) >= vocab_size)
+                break;
+            backoff_node = static_cast<uint64_t>(word);
+        }
+        else
+        {
+            auto child = find_child(d - 1, backoff_node, word);
+            if (!child)
+                break;
+            backoff_node = *child;
+        }
+
+        if (d >= matched)
+            res += backoff(d, backoff_node);
+    }
+
+    return res;
+}
+
+float trie_language_model::log_prob(const sentence& tokens) const
+{
+    float prob = 0.0f;
+
+    lm_state state;
+    lm_state state_next;
+    for (const auto& token : tokens)
+    {
+        prob += score(state, index(token), state_next);
+        state = state_next;
+    }
+
+    return prob;
+}
+
+float trie_language_model::perplexity(const sentence& tokens) const
+{
+    if (tokens.size() == 0)
+        throw trie_language_model_exception{
+            "perplexity() called on empty sentence"};
+    return std::pow(10.0f, -(log_prob(tokens) / tokens.size()));
+}
+
+float trie_language_model::perplexity_per_word(const sentence& tokens) const
+{
+    if (tokens.size() == 0)
+        throw trie_language_model_exception{
+            "perplexity_per_word() called on empty sentence"};
+    return perplexity(tokens) / tokens.size();
+}
+}
+}
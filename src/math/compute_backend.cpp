@@ -0,0 +1,69 @@
+/**
+ * @file compute_backend.cpp
+ * @author Chase Geigle
+ */
+
+#include <cmath>
+
+#include "meta/math/compute_backend.h"
+#include "meta/math/dense_similarity.h"
+
+namespace meta
+{
+namespace math
+{
+
+namespace
+{
+class cpu_backend final : public compute_backend
+{
+  public:
+    util::string_view name() const override
+    {
+        return "cpu";
+    }
+
+    void dot_products(const double* matrix, std::size_t num_rows,
+                      std::size_t dim, const double* query,
+                      double* out) const override
+    {
+        for (std::size_t r = 0; r < num_rows; ++r)
+            out[r] = dense::dot(matrix + r * dim, query, dim);
+    }
+
+    void adagrad_apply(double* weights, double* gradsq,
+                       const std::size_t* row_offsets, const double* grads,
+                       std::size_t num_updates, std::size_t dim) const override
+    {
+        for (std::size_t u = 0; u < num_updates; ++u)
+        {
+            double* w = weights + row_offsets[u];
+            double* a = gradsq + row_offsets[u];
+            const double* g = grads + u * dim;
+            for (std::size_t i = 0; i < dim; ++i)
+            {
+                w[i] -= g[i] / std::sqrt(a[i]);
+                a[i] += g[i] * g[i];
+            }
+        }
+    }
+};
+}
+
+const compute_backend& compute_backend::cpu()
+{
+    static cpu_backend backend;
+    return backend;
+}
+
+const compute_backend& compute_backend::instance()
+{
+#if META_HAS_CUDA
+    static std::unique_ptr<compute_backend> cuda = make_cuda_compute_backend();
+    if (cuda)
+        return *cuda;
+#endif
+    return cpu();
+}
+}
+}
@@ -0,0 +1,188 @@
+/**
+ * @file compute_backend_cuda.cu
+ * @author Chase Geigle
+ *
+ * CUDA compute backend. Compiled only when the toolkit is configured
+ * with META_ENABLE_CUDA; selected at runtime only when a usable device
+ * is present.
+ */
+
+#include <cuda_runtime.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "meta/math/compute_backend.h"
+
+namespace meta
+{
+namespace math
+{
+
+namespace
+{
+
+inline void cuda_check(cudaError_t err)
+{
+    if (err != cudaSuccess)
+        throw std::runtime_error{std::string{"cuda error: "}
+                                 + cudaGetErrorString(err)};
+}
+
+/**
+ * One block per matrix row; threads stride over the row and reduce the
+ * partial dot products through shared memory.
+ */
+__global__ void dot_products_kernel(const double* matrix, std::size_t dim,
+                                    const double* query, double* out)
+{
+    extern __shared__ double partial[];
+
+    const double* row = matrix + static_cast<std::size_t>(blockIdx.x) * dim;
+    double sum = 0.0;
+    for (std::size_t i = threadIdx.x; i < dim; i += blockDim.x)
+        sum += row[i] * query[i];
+    partial[threadIdx.x] = sum;
+    __syncthreads();
+
+    for (unsigned stride = blockDim.x / 2; stride > 0; stride >>= 1)
+    {
+        if (threadIdx.x < stride)
+            partial[threadIdx.x] += partial[threadIdx.x + stride];
+        __syncthreads();
+    }
+
+    if (threadIdx.x == 0)
+        out[blockIdx.x] = partial[0];
+}
+
+/**
+ * One block per row update; the staged weight and accumulator rows are
+ * contiguous, so update u touches elements [u * dim, (u + 1) * dim).
+ */
+__global__ void adagrad_kernel(double* weights, double* gradsq,
+                               const double* grads, std::size_t dim)
+{
+    std::size_t base = static_cast<std::size_t>(blockIdx.x) * dim;
+    for (std::size_t i = threadIdx.x; i < dim; i += blockDim.x)
+    {
+        double g = grads[base + i];
+        weights[base + i] -= g / sqrt(gradsq[base + i]);
+        gradsq[base + i] += g * g;
+    }
+}
+
+class cuda_backend final : public compute_backend
+{
+  public:
+    util::string_view name() const override
+    {
+        return "cuda";
+    }
+
+    void dot_products(const double* matrix, std::size_t num_rows,
+                      std::size_t dim, const double* query,
+                      double* out) const override
+    {
+        if (num_rows == 0)
+            return;
+
+        double* d_matrix;
+        double* d_query;
+        double* d_out;
+        cuda_check(cudaMalloc(&d_matrix, num_rows * dim * sizeof(double)));
+        cuda_check(cudaMalloc(&d_query, dim * sizeof(double)));
+        cuda_check(cudaMalloc(&d_out, num_rows * sizeof(double)));
+
+        cuda_check(cudaMemcpy(d_matrix, matrix,
+                              num_rows * dim * sizeof(double),
+                              cudaMemcpyHostToDevice));
+        cuda_check(cudaMemcpy(d_query, query, dim * sizeof(double),
+                              cudaMemcpyHostToDevice));
+
+        unsigned threads = 256;
+        dot_products_kernel<<<static_cast<unsigned>(num_rows), threads,
+                              threads * sizeof(double)>>>(d_matrix, dim,
+                                                          d_query, d_out);
+        cuda_check(cudaGetLastError());
+
+        cuda_check(cudaMemcpy(out, d_out, num_rows * sizeof(double),
+                              cudaMemcpyDeviceToHost));
+
+        cudaFree(d_matrix);
+        cudaFree(d_query);
+        cudaFree(d_out);
+    }
+
+    void adagrad_apply(double* weights, double* gradsq,
+                       const std::size_t* row_offsets, const double* grads,
+                       std::size_t num_updates, std::size_t dim) const override
+    {
+        if (num_updates == 0)
+            return;
+
+        // the touched rows are scattered through the weight table, so
+        // gather them into contiguous staging buffers for one block
+        // transfer each way
+        std::vector<double> w_stage(num_updates * dim);
+        std::vector<double> a_stage(num_updates * dim);
+        for (std::size_t u = 0; u < num_updates; ++u)
+        {
+            std::copy(weights + row_offsets[u],
+                      weights + row_offsets[u] + dim,
+                      w_stage.begin() + u * dim);
+            std::copy(gradsq + row_offsets[u], gradsq + row_offsets[u] + dim,
+                      a_stage.begin() + u * dim);
+        }
+
+        auto bytes = num_updates * dim * sizeof(double);
+        double* d_weights;
+        double* d_gradsq;
+        double* d_grads;
+        cuda_check(cudaMalloc(&d_weights, bytes));
+        cuda_check(cudaMalloc(&d_gradsq, bytes));
+        cuda_check(cudaMalloc(&d_grads, bytes));
+
+        cuda_check(cudaMemcpy(d_weights, w_stage.data(), bytes,
+                              cudaMemcpyHostToDevice));
+        cuda_check(cudaMemcpy(d_gradsq, a_stage.data(), bytes,
+                              cudaMemcpyHostToDevice));
+        cuda_check(
+            cudaMemcpy(d_grads, grads, bytes, cudaMemcpyHostToDevice));
+
+        adagrad_kernel<<<static_cast<unsigned>(num_updates), 256>>>(
+            d_weights, d_gradsq, d_grads, dim);
+        cuda_check(cudaGetLastError());
+
+        cuda_check(cudaMemcpy(w_stage.data(), d_weights, bytes,
+                              cudaMemcpyDeviceToHost));
+        cuda_check(cudaMemcpy(a_stage.data(), d_gradsq, bytes,
+                              cudaMemcpyDeviceToHost));
+
+        cudaFree(d_weights);
+        cudaFree(d_gradsq);
+        cudaFree(d_grads);
+
+        for (std::size_t u = 0; u < num_updates; ++u)
+        {
+            std::copy(w_stage.begin() + u * dim,
+                      w_stage.begin() + (u + 1) * dim,
+                      weights + row_offsets[u]);
+            std::copy(a_stage.begin() + u * dim,
+                      a_stage.begin() + (u + 1) * dim,
+                      gradsq + row_offsets[u]);
+        }
+    }
+};
+}
+
+std::unique_ptr<compute_backend> make_cuda_compute_backend()
+{
+    int devices = 0;
+    if (cudaGetDeviceCount(&devices) != cudaSuccess || devices == 0)
+        return nullptr;
+    return std::unique_ptr<compute_backend>{new cuda_backend{}};
+}
+}
+}
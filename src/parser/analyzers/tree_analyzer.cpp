@@ -63,7 +63,7 @@ void tree_analyzer::tokenize(const corpus::document& doc, featurizer& counts)
         }
         else
         {
-            seq.add_symbol(sequence::symbol_t{next});
+            seq.add_symbol(sequence::symbol_t{next.to_string()});
         }
     }
 }
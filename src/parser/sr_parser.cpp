@@ -67,12 +67,24 @@ parse_tree sr_parser::parse(const sequence::sequence& sentence) const
     {
         using scored_state = std::pair<state, float>;
 
+        /**
+         * A candidate transition out of a state currently on the beam.
+         * Candidates are pruned before the states are advanced, so the
+         * expensive state::advance is paid for at most beam_size_
+         * survivors per step instead of every (state, transition) pair.
+         */
+        struct candidate
+        {
+            size_t parent;
+            trans_id tid;
+            float score;
+        };
+
         struct comparator
         {
-            bool operator()(const scored_state& lhs,
-                            const scored_state& rhs) const
+            bool operator()(const candidate& lhs, const candidate& rhs) const
             {
-                return std::get<1>(lhs) > std::get<1>(rhs);
+                return lhs.score > rhs.score;
             };
         };
 
@@ -81,20 +93,26 @@ parse_tree sr_parser::parse(const sequence::sequence& sentence) const
             return std::get<0>(ss).finalized();
         };
 
-        using fixed_heap = util::fixed_heap<scored_state, comparator>;
+        using fixed_heap = util::fixed_heap<candidate, comparator>;
 
-        fixed_heap agenda{beam_size_, comparator{}};
-        agenda.emplace(st, 0);
+        // the agendas are preallocated once and reused across steps
+        std::vector<scored_state> agenda;
+        std::vector<scored_state> new_agenda;
+        agenda.reserve(beam_size_);
+        new_agenda.reserve(beam_size_);
+        agenda.emplace_back(st, 0);
 
         while (!std::all_of(agenda.begin(), agenda.end(), fin))
         {
-            fixed_heap new_agenda{beam_size_, comparator{}};
+            fixed_heap candidates{beam_size_, comparator{}};
 
-            for (const auto& ss : agenda)
+            for (size_t i = 0; i < agenda.size(); ++i)
             {
-                const auto& c_state = std::get<0>(ss);
-                auto score = std::get<1>(ss);
+                const auto& c_state = std::get<0>(agenda[i]);
+                auto score = std::get<1>(agenda[i]);
 
+                // features are extracted once per state; all of its
+                // candidate transitions share the scored feature vector
                 auto feats = analyzer.featurize(c_state);
 
                 auto transitions
@@ -105,11 +123,18 @@ parse_tree sr_parser::parse(const sequence::sequence& sentence) const
                     auto trans = std::get<0>(scored_trans);
                     auto t_score = std::get<1>(scored_trans);
 
-                    new_agenda.emplace(c_state.advance(trans_.at(trans)),
-                                       score + t_score);
+                    candidates.emplace(candidate{i, trans, score + t_score});
                 }
             }
 
+            new_agenda.clear();
+            for (const auto& cand : candidates.extract_top())
+            {
+                const auto& c_state = std::get<0>(agenda[cand.parent]);
+                new_agenda.emplace_back(c_state.advance(trans_.at(cand.tid)),
+                                        cand.score);
+            }
+
             if (new_agenda.size() == 0)
             {
                 for (const auto& ss : agenda)
@@ -118,19 +143,22 @@ parse_tree sr_parser::parse(const sequence::sequence& sentence) const
                     auto score = std::get<1>(ss);
 
                     auto trans = c_state.emergency_transition();
-                    new_agenda.emplace(c_state.advance(trans), score);
+                    new_agenda.emplace_back(c_state.advance(trans), score);
                 }
             }
 
             if (new_agenda.size() == 0)
                 throw sr_parser_exception{"unparsable"};
 
-            agenda = std::move(new_agenda);
+            std::swap(agenda, new_agenda);
         }
 
-        // min because comp is backwards
-        auto best
-            = std::min_element(agenda.begin(), agenda.end(), comparator{});
+        auto best = std::max_element(
+            agenda.begin(), agenda.end(),
+            [](const scored_state& lhs, const scored_state& rhs)
+            {
+                return std::get<1>(lhs) < std::get<1>(rhs);
+            });
 
         parse_tree tree{std::get<0>(*best).stack_item(0)->clone()};
         debinarizer debin;
@@ -140,6 +168,29 @@ parse_tree sr_parser::parse(const sequence::sequence& sentence) const
     }
 }
 
+std::vector<parse_tree>
+sr_parser::parse_batch(const std::vector<sequence::sequence>& sentences,
+                       parallel::thread_pool& pool) const
+{
+    std::vector<util::optional<parse_tree>> results(sentences.size());
+
+    if (!sentences.empty())
+    {
+        auto range = util::range<size_t>(0, sentences.size() - 1); // inclusive
+        parallel::parallel_for(range.begin(), range.end(), pool,
+                               [&](size_t i)
+                               {
+                                   results[i] = parse(sentences[i]);
+                               });
+    }
+
+    std::vector<parse_tree> trees;
+    trees.reserve(results.size());
+    for (auto& result : results)
+        trees.emplace_back(std::move(*result));
+    return trees;
+}
+
 void sr_parser::train(std::vector<parse_tree>& trees, training_options options)
 {
     if (options.algorithm == training_algorithm::BEAM_SEARCH)
@@ -234,8 +285,7 @@ auto sr_parser::train_batch(training_batch batch, parallel::thread_pool& pool,
         for (const auto& feat : thread_update.second)
         {
             auto& wv = std::get<0>(result)[feat.first];
-            for (const auto& weight : feat.second)
-                wv[weight.first] += weight.second;
+            wv.merge_sorted(feat.second.begin(), feat.second.end());
         }
     }
     std::get<1>(result) = num_correct.load();
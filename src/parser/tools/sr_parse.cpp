@@ -78,7 +78,7 @@ int main(int argc, char* argv[])
             }
             else
             {
-                seq.add_symbol(sequence::symbol_t{token});
+                seq.add_symbol(sequence::symbol_t{token.to_string()});
             }
         }
 
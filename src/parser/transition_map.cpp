@@ -70,7 +70,8 @@ void transition_map::load(std::istream& store)
 
 const transition& transition_map::at(trans_id id) const
 {
-    return transitions_.at(id);
+    assert(id < transitions_.size());
+    return transitions_[id];
 }
 
 trans_id transition_map::at(const transition& trans) const
@@ -79,14 +80,14 @@ trans_id transition_map::at(const transition& trans) const
     if (it == map_.end())
         throw std::out_of_range{"index out of bounds"};
 
-    return it->second;
+    return it->value();
 }
 
 trans_id transition_map::operator[](const transition& trans)
 {
     auto it = map_.find(trans);
     if (it != map_.end())
-        return it->second;
+        return it->value();
 
     transitions_.push_back(trans);
     assert(map_.size() <= std::numeric_limits<uint16_t>::max());
@@ -3,7 +3,12 @@
  * @author Chase Geigle
  */
 
+#include <array>
+#include <mutex>
+#include <vector>
+
 #include "meta/parser/trees/node.h"
+#include "meta/util/shim.h"
 
 namespace meta
 {
@@ -16,6 +21,117 @@ bool is_temporary(const std::string& lbl)
 {
     return lbl[lbl.length() - 1] == '*';
 }
+
+/**
+ * A pool allocator for parse tree nodes. Nodes are bump-allocated out of
+ * large slabs and recycled through per-size-class free lists, so that
+ * steady-state tree construction and destruction never touches the
+ * general-purpose allocator.
+ *
+ * Each thread gets its own pool, so allocation and deallocation are
+ * lock-free on the hot path. The slabs themselves are registered in a
+ * process-wide list and only released at program exit: nodes may migrate
+ * between threads (e.g. trees built on the main thread and destroyed by
+ * a worker), so slab storage must outlive any individual thread's pool.
+ */
+class node_pool
+{
+  public:
+    void* allocate(std::size_t size)
+    {
+        auto cls = size_class(size);
+        if (auto blk = free_lists_[cls])
+        {
+            free_lists_[cls] = blk->next;
+            return blk;
+        }
+
+        auto bytes = (cls + 1) * granularity;
+        if (remaining_ < bytes)
+        {
+            cursor_ = new_slab();
+            remaining_ = slab_size;
+        }
+
+        auto result = cursor_;
+        cursor_ += bytes;
+        remaining_ -= bytes;
+        return result;
+    }
+
+    void deallocate(void* ptr, std::size_t size)
+    {
+        auto blk = static_cast<free_block*>(ptr);
+        auto cls = size_class(size);
+        blk->next = free_lists_[cls];
+        free_lists_[cls] = blk;
+    }
+
+  private:
+    /// blocks are carved out in multiples of this many bytes
+    const static std::size_t granularity = 16;
+    /// the largest block size the pool will serve
+    const static std::size_t max_block_size = 256;
+    /// the number of bytes in each slab
+    const static std::size_t slab_size = 1 << 16;
+
+    struct free_block
+    {
+        free_block* next;
+    };
+
+    static std::size_t size_class(std::size_t size)
+    {
+        return (size - 1) / granularity;
+    }
+
+    static char* new_slab()
+    {
+        static std::mutex lock;
+        static std::vector<std::unique_ptr<char[]>> slabs;
+
+        auto slab = make_unique<char[]>(slab_size);
+        auto result = slab.get();
+        std::lock_guard<std::mutex> guard{lock};
+        slabs.emplace_back(std::move(slab));
+        return result;
+    }
+
+    /// free lists for recycled blocks, indexed by size class
+    std::array<free_block*, max_block_size / granularity> free_lists_ = {};
+    /// the bump pointer into the current slab
+    char* cursor_ = nullptr;
+    /// the number of bytes remaining in the current slab
+    std::size_t remaining_ = 0;
+
+  public:
+    static node_pool& get()
+    {
+        static thread_local node_pool pool;
+        return pool;
+    }
+
+    static bool poolable(std::size_t size)
+    {
+        return size <= max_block_size;
+    }
+};
+}
+
+void* node::operator new(std::size_t size)
+{
+    if (!node_pool::poolable(size))
+        return ::operator new(size);
+    return node_pool::get().allocate(size);
+}
+
+void node::operator delete(void* ptr, std::size_t size)
+{
+    if (!ptr)
+        return;
+    if (!node_pool::poolable(size))
+        return ::operator delete(ptr);
+    node_pool::get().deallocate(ptr, size);
 }
 
 node::node(class_label cat) : category_{std::move(cat)}
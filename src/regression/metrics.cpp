@@ -30,6 +30,12 @@ void metrics_accumulator::add(predicted_response predicted, response actual)
                                           static_cast<double>(actual)});
 }
 
+void metrics_accumulator::merge(const metrics_accumulator& other)
+{
+    responses_.insert(responses_.end(), other.responses_.begin(),
+                      other.responses_.end());
+}
+
 double metrics_accumulator::mean_absolute_error() const
 {
     return accumulate(responses_,
@@ -4,6 +4,7 @@
  */
 
 #include "meta/logging/logger.h"
+#include "meta/parallel/algorithm.h"
 #include "meta/regression/models/regressor.h"
 #include "meta/regression/regressor_factory.h"
 
@@ -24,6 +25,25 @@ metrics regressor::test(dataset_view_type docs) const
     return m;
 }
 
+metrics regressor::test(dataset_view_type docs,
+                        parallel::thread_pool& pool) const
+{
+    auto m = parallel::reduction(
+        docs.begin(), docs.end(), pool,
+        []() { return metrics_accumulator{}; },
+        [&](metrics_accumulator& local, const instance_type& instance)
+        {
+            predicted_response predicted{predict(instance.weights)};
+            response actual{docs.label(instance)};
+            local.add(predicted, actual);
+        },
+        [](metrics_accumulator& total, const metrics_accumulator& partial)
+        {
+            total.merge(partial);
+        });
+    return m;
+}
+
 std::vector<metrics> cross_validate(const cpptoml::table& config,
                                     regressor::dataset_view_type docs,
                                     std::size_t k)
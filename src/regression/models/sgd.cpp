@@ -3,8 +3,12 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "meta/regression/models/sgd.h"
 #include "meta/learn/loss/loss_function_factory.h"
+#include "meta/parallel/algorithm.h"
 
 namespace meta
 {
@@ -87,6 +91,66 @@ void sgd::train(dataset_view_type docs)
     }
 }
 
+void sgd::train(dataset_view_type docs, parallel::thread_pool& pool)
+{
+    double prev_avg_loss = 0;
+    for (size_t iter = 0; iter < max_iter_; ++iter)
+    {
+        docs.shuffle();
+        // Hogwild: each thread trains on its shard against the shared
+        // model with no locking; per-thread losses are reduced at the
+        // epoch boundary
+        auto total_loss = parallel::reduction(
+            docs.begin(), docs.end(), pool, []() { return 0.0; },
+            [&](double& local_loss, const instance_type& instance)
+            {
+                local_loss += model_.train_one(instance.weights,
+                                               docs.label(instance), *loss_);
+            },
+            [](double& total, double partial)
+            {
+                total += partial;
+            });
+
+        auto avg_loss = total_loss / docs.size();
+        if (prev_avg_loss > 0
+            && std::abs(prev_avg_loss - avg_loss) / prev_avg_loss < gamma_)
+            return;
+        prev_avg_loss = avg_loss;
+    }
+}
+
+void sgd::train_minibatch(dataset_view_type docs, std::size_t batch_size)
+{
+    using diff_type = decltype(docs.begin())::difference_type;
+
+    double prev_avg_loss = 0;
+    for (size_t iter = 0; iter < max_iter_; ++iter)
+    {
+        docs.shuffle();
+        double total_loss = 0;
+        for (auto it = docs.begin(); it != docs.end();)
+        {
+            auto left = static_cast<std::size_t>(
+                std::distance(it, docs.end()));
+            auto batch_end
+                = it + static_cast<diff_type>(std::min(batch_size, left));
+            total_loss += model_.train_batch(
+                it, batch_end, *loss_, [&](const instance_type& inst)
+                {
+                    return docs.label(inst);
+                });
+            it = batch_end;
+        }
+
+        auto avg_loss = total_loss / docs.size();
+        if (prev_avg_loss > 0
+            && std::abs(prev_avg_loss - avg_loss) / prev_avg_loss < gamma_)
+            return;
+        prev_avg_loss = avg_loss;
+    }
+}
+
 void sgd::train_one(const feature_vector& doc, double label)
 {
     model_.train_one(doc, label, *loss_);
@@ -61,7 +61,7 @@ void ngram_pos_analyzer::tokenize(const corpus::document& doc,
             sentences.emplace_back(std::move(seq));
         else
             seq.add_observation(
-                {sequence::symbol_t{next}, sequence::tag_t{"[unknown]"}});
+                {sequence::symbol_t{next.to_string()}, sequence::tag_t{"[unknown]"}});
     }
 
     auto tagger = crf_->make_tagger();
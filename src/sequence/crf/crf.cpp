@@ -8,6 +8,7 @@
 #include <numeric>
 #include <map>
 #include <set>
+#include <unordered_set>
 #include "meta/logging/logger.h"
 #include "meta/sequence/crf/crf.h"
 #include "meta/sequence/crf/scorer.h"
@@ -148,6 +149,7 @@ void crf::reset()
     for (auto& w : *transition_weights_)
         w = 0;
     scale_ = 1;
+    ++weight_version_;
 }
 
 uint64_t crf::num_labels() const
@@ -343,15 +345,168 @@ double crf::epoch(parameters params, printing::progress& progress,
                   const std::vector<sequence>& examples, scorer& scorer)
 {
     double sum_loss = 0;
-    for (uint64_t i = 0; i < indices.size(); ++i)
+    if (params.batch_size <= 1)
+    {
+        for (uint64_t i = 0; i < indices.size(); ++i)
+        {
+            progress(i);
+            const auto& elem = examples[indices[i]];
+            sum_loss
+                += iteration(params, iter * indices.size() + i, elem, scorer);
+        }
+        return sum_loss;
+    }
+
+    parallel::thread_pool pool;
+    std::unordered_map<std::thread::id, class scorer> scorers;
+    for (const auto& id : pool.thread_ids())
+        scorers[id];
+    for (uint64_t i = 0; i < indices.size(); i += params.batch_size)
     {
         progress(i);
-        const auto& elem = examples[indices[i]];
-        sum_loss += iteration(params, iter * indices.size() + i, elem, scorer);
+        auto end = std::min<uint64_t>(i + params.batch_size, indices.size());
+        sum_loss += batch_iteration(params, iter * indices.size() + i, indices,
+                                    i, end, examples, scorers, pool);
     }
     return sum_loss;
 }
 
+double crf::batch_iteration(
+    parameters params, uint64_t iter, const std::vector<uint64_t>& indices,
+    uint64_t start, uint64_t end, const std::vector<sequence>& examples,
+    std::unordered_map<std::thread::id, scorer>& scorers,
+    parallel::thread_pool& pool)
+{
+    double lr = 1 / (params.lambda * (params.t0 + iter));
+    scale_ *= (1 - params.lambda * lr);
+    auto gain = lr / scale_;
+
+    // per-thread gradient buffers: the weights are only read while the
+    // batch is being scored, so the merged gradient is applied afterward
+    std::unordered_map<std::thread::id,
+                       std::unordered_map<crf_feature_id, double>> obs_grads;
+    std::unordered_map<std::thread::id, std::vector<double>> trans_grads;
+    for (const auto& id : pool.thread_ids())
+    {
+        obs_grads[id];
+        trans_grads[id].resize(transition_weights_->size());
+    }
+
+    // the forward-backward passes are independent per sequence, so the
+    // whole batch can be scored concurrently
+    std::vector<std::future<double>> losses;
+    losses.reserve(end - start);
+    for (uint64_t i = start; i < end; ++i)
+    {
+        const sequence* seq = &examples[indices[i]];
+        losses.emplace_back(pool.submit_task(
+            [this, seq, gain, &scorers, &obs_grads, &trans_grads]()
+            {
+                auto tid = std::this_thread::get_id();
+                auto& scr = scorers.at(tid);
+                scr.score(*this, *seq);
+                scr.marginals();
+                gradient(*seq, gain, scr, obs_grads.at(tid),
+                         trans_grads.at(tid));
+                return scr.loss(*seq);
+            }));
+    }
+
+    double sum_loss = 0;
+    for (auto& loss : losses)
+        sum_loss += loss.get();
+
+    // merge and apply the per-thread sparse gradients
+    for (const auto& id : pool.thread_ids())
+    {
+        auto& obs_grad = obs_grads.at(id);
+        for (const auto& pair : obs_grad)
+            obs_weight(pair.first) += pair.second;
+        obs_grad.clear();
+
+        auto& trans_grad = trans_grads.at(id);
+        for (uint64_t idx = 0; idx < trans_grad.size(); ++idx)
+        {
+            if (trans_grad[idx] != 0)
+                trans_weight(crf_feature_id{idx}) += trans_grad[idx];
+        }
+    }
+
+    // every scorer's cache is now stale for the batch's features
+    std::unordered_set<feature_id> touched;
+    for (uint64_t i = start; i < end; ++i)
+    {
+        for (const auto& obs : examples[indices[i]])
+            for (const auto& pair : obs.features())
+                touched.insert(pair.first);
+    }
+    std::vector<feature_id> feats{touched.begin(), touched.end()};
+    for (auto& pair : scorers)
+        pair.second.invalidate(*this, feats);
+
+    return sum_loss;
+}
+
+void crf::gradient(const sequence& seq, double gain, const scorer& scr,
+                   std::unordered_map<crf_feature_id, double>& obs_grad,
+                   std::vector<double>& trans_grad) const
+{
+    // observation expectation part
+    util::optional<label_id> prev;
+    for (const auto& obs : seq)
+    {
+        auto lbl = obs.label();
+        for (const auto& pair : obs.features())
+        {
+            for (const auto& idx : obs_range(pair.first))
+            {
+                if (observation(idx) == lbl)
+                {
+                    obs_grad[idx] += gain * pair.second;
+                    break;
+                }
+            }
+        }
+
+        if (prev)
+        {
+            for (const auto& idx : trans_range(*prev))
+            {
+                if (transition(idx) == lbl)
+                {
+                    trans_grad[idx] += gain;
+                    break;
+                }
+            }
+        }
+
+        prev = lbl;
+    }
+
+    // model expectation part
+    for (uint64_t t = 0; t < seq.size(); ++t)
+    {
+        for (const auto& pair : seq[t].features())
+        {
+            for (const auto& idx : obs_range(pair.first))
+            {
+                auto lbl = observation(idx);
+                obs_grad[idx]
+                    -= gain * pair.second * scr.state_marginal(t, lbl);
+            }
+        }
+    }
+
+    for (label_id i{0}; i < num_labels(); ++i)
+    {
+        for (const auto& idx : trans_range(i))
+        {
+            auto j = transition(idx);
+            trans_grad[idx] -= gain * scr.trans_marginal(i, j);
+        }
+    }
+}
+
 double crf::iteration(parameters params, uint64_t iter, const sequence& seq,
                       scorer& scorer)
 {
@@ -365,6 +520,10 @@ double crf::iteration(parameters params, uint64_t iter, const sequence& seq,
     gradient_observation_expectation(seq, gain);
     gradient_model_expectation(seq, -1.0 * gain, scorer);
 
+    // only the weights for this sequence's features were touched, so
+    // only their cache entries need refreshing
+    scorer.invalidate(*this, seq);
+
     return scorer.loss(seq);
 }
 
@@ -445,6 +604,7 @@ void crf::rescale()
     for (auto& w : *transition_weights_)
         w *= scale_;
     scale_ = 1;
+    ++weight_version_;
 }
 }
 }
@@ -18,6 +18,9 @@ void crf::scorer::score(const crf& model, const sequence& seq)
     bwd_ = util::nullopt;
     state_mrg_ = util::nullopt;
     trans_mrg_ = util::nullopt;
+    // the trellises are gone now, so their scratch memory can be reused
+    // for this sequence
+    arena_.reset();
 }
 
 void crf::scorer::transition_scores(const crf& model)
@@ -25,6 +28,7 @@ void crf::scorer::transition_scores(const crf& model)
     auto num_labels = model.num_labels();
     trans_.resize(num_labels, num_labels);
     trans_exp_.resize(num_labels, num_labels);
+    trans_exp_t_.resize(num_labels, num_labels);
     for (label_id outer{0}; outer < num_labels; ++outer)
     {
         for (const auto& idx : model.trans_range(outer))
@@ -35,11 +39,21 @@ void crf::scorer::transition_scores(const crf& model)
         std::transform(trans_.begin(outer), trans_.end(outer),
                        trans_exp_.begin(outer), [](double val)
         { return std::exp(val); });
+
+        // also store the transpose so the forward trellis reads each
+        // destination label's incoming scores contiguously
+        for (label_id in{0}; in < num_labels; ++in)
+            trans_exp_t_(in, outer) = trans_exp_(outer, in);
     }
 }
 
 void crf::scorer::state_scores(const crf& model, const sequence& seq)
 {
+    auto num_feats = model.observation_ranges_->size() - 1;
+    if (obs_cache_.size() != num_feats
+        || cache_version_ != model.weight_version_)
+        rebuild_cache(model);
+
     auto num_labels = model.num_labels();
     state_.resize(seq.size(), num_labels);
     state_exp_.resize(seq.size(), num_labels);
@@ -48,11 +62,8 @@ void crf::scorer::state_scores(const crf& model, const sequence& seq)
         for (const auto& pair : seq[t].features())
         {
             auto value = model.scale_ * pair.second;
-            for (const auto& idx : model.obs_range(pair.first))
-            {
-                auto lbl = model.observation(idx);
-                state_(t, lbl) += model.obs_weight(idx) * value;
-            }
+            for (const auto& feat : obs_cache_[pair.first])
+                state_(t, feat.first) += feat.second * value;
         }
 
         // exponentiate and store in state_exp_
@@ -62,9 +73,45 @@ void crf::scorer::state_scores(const crf& model, const sequence& seq)
     }
 }
 
+void crf::scorer::invalidate(const crf& model, const sequence& seq)
+{
+    if (obs_cache_.empty())
+        return;
+
+    for (const auto& obs : seq)
+        for (const auto& pair : obs.features())
+            refresh_feature(model, pair.first);
+}
+
+void crf::scorer::invalidate(const crf& model,
+                             const std::vector<feature_id>& feats)
+{
+    if (obs_cache_.empty())
+        return;
+
+    for (const auto& fid : feats)
+        refresh_feature(model, fid);
+}
+
+void crf::scorer::rebuild_cache(const crf& model)
+{
+    obs_cache_.resize(model.observation_ranges_->size() - 1);
+    for (feature_id fid{0}; fid < obs_cache_.size(); ++fid)
+        refresh_feature(model, fid);
+    cache_version_ = model.weight_version_;
+}
+
+void crf::scorer::refresh_feature(const crf& model, feature_id fid)
+{
+    auto& feats = obs_cache_[fid];
+    feats.clear();
+    for (const auto& idx : model.obs_range(fid))
+        feats.emplace_back(model.observation(idx), model.obs_weight(idx));
+}
+
 void crf::scorer::forward()
 {
-    fwd_ = forward_trellis{state_exp_.rows(), state_exp_.columns()};
+    fwd_ = forward_trellis{state_exp_.rows(), state_exp_.columns(), arena_};
 
     // initialize first column of trellis
     for (label_id lbl{0}; lbl < state_exp_.columns(); ++lbl)
@@ -81,7 +128,7 @@ void crf::scorer::forward()
             double sum = 0;
             for (label_id in{0}; in < state_exp_.columns(); ++in)
             {
-                sum += fwd_->probability(t - 1, in) * trans_exp(in, lbl);
+                sum += fwd_->probability(t - 1, in) * trans_exp_t_(lbl, in);
             }
             fwd_->probability(t, lbl, score * sum);
         }
@@ -95,7 +142,7 @@ void crf::scorer::backward()
     if (!fwd_)
         forward();
 
-    bwd_ = trellis{state_exp_.rows(), state_exp_.columns()};
+    bwd_ = trellis{state_exp_.rows(), state_exp_.columns(), arena_};
 
     // initialize last column of the trellis
     for (label_id lbl{0}; lbl < state_exp_.columns(); ++lbl)
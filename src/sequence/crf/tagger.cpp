@@ -4,6 +4,7 @@
  */
 
 #include "meta/sequence/crf/tagger.h"
+#include "meta/util/fixed_heap.h"
 #include "meta/util/functional.h"
 
 namespace meta
@@ -38,5 +39,44 @@ void crf::tagger::tag(sequence& seq)
     for (uint64_t t = seq.size() - 1; t > 0; t--)
         seq[t - 1].label(trellis.previous_tag(t, seq[t].label()));
 }
+
+std::vector<std::pair<std::vector<label_id>, double>>
+crf::tagger::tag_nbest(const sequence& seq, uint64_t n)
+{
+    auto trellis = scorer_.viterbi_nbest(seq, n);
+
+    // collect the n best path endings across all final labels
+    using ending = std::pair<double, std::pair<label_id, uint64_t>>;
+    auto endings = util::make_fixed_heap<ending>(
+        n, [](const ending& a, const ending& b)
+        {
+            return a.first > b.first;
+        });
+    for (label_id lbl{0}; lbl < num_labels_; ++lbl)
+    {
+        const auto& hyps = trellis.hypotheses(seq.size() - 1, lbl);
+        for (uint64_t rank = 0; rank < hyps.size(); ++rank)
+            endings.emplace(hyps[rank].score, std::make_pair(lbl, rank));
+    }
+
+    // follow each ending's back pointers through the (label, rank) pairs
+    std::vector<std::pair<std::vector<label_id>, double>> results;
+    for (const auto& end : endings.extract_top())
+    {
+        std::vector<label_id> labels(seq.size(), label_id{0});
+        auto lbl = end.second.first;
+        auto rank = end.second.second;
+        labels[seq.size() - 1] = lbl;
+        for (uint64_t t = seq.size() - 1; t > 0; t--)
+        {
+            const auto& hyp = trellis.hypotheses(t, lbl)[rank];
+            lbl = hyp.previous;
+            rank = hyp.rank;
+            labels[t - 1] = lbl;
+        }
+        results.emplace_back(std::move(labels), end.first);
+    }
+    return results;
+}
 }
 }
@@ -72,7 +72,7 @@ int main(int argc, char* argv[])
             if (token == " " || token == "<s>" || token == "</s>")
                 continue;
             seq.add_observation(
-                {sequence::symbol_t{token}, sequence::tag_t{"[UNK]"}});
+                {sequence::symbol_t{token.to_string()}, sequence::tag_t{"[UNK]"}});
         }
 
         if (seq.size() == 0)
@@ -4,6 +4,7 @@
  */
 
 #include "meta/sequence/crf/viterbi_scorer.h"
+#include "meta/util/fixed_heap.h"
 
 namespace meta
 {
@@ -54,5 +55,50 @@ viterbi_trellis crf::viterbi_scorer::viterbi(const sequence& seq)
     return table;
 }
 
+nbest_trellis crf::viterbi_scorer::viterbi_nbest(const sequence& seq,
+                                                 uint64_t n)
+{
+    scorer_.state_scores(*model_, seq);
+
+    nbest_trellis table{seq.size(), model_->num_labels(), n};
+
+    // initialize first column of trellis; each node starts with a single
+    // hypothesis whose back pointer is never followed
+    for (label_id lbl{0}; lbl < model_->num_labels(); ++lbl)
+        table.hypotheses(0, lbl, {{scorer_.state(0, lbl), label_id{0}, 0}});
+
+    auto comp = [](const nbest_trellis::backpointer& a,
+                   const nbest_trellis::backpointer& b)
+    {
+        return a.score > b.score;
+    };
+
+    // compute remaining columns: each node keeps the top n extensions of
+    // the hypotheses stored at the previous time step
+    for (uint64_t t = 1; t < seq.size(); ++t)
+    {
+        for (label_id lbl{0}; lbl < model_->num_labels(); ++lbl)
+        {
+            auto best
+                = util::make_fixed_heap<nbest_trellis::backpointer>(n, comp);
+            for (label_id in{0}; in < model_->num_labels(); ++in)
+            {
+                const auto& hyps = table.hypotheses(t - 1, in);
+                for (uint64_t rank = 0; rank < hyps.size(); ++rank)
+                {
+                    best.emplace(nbest_trellis::backpointer{
+                        hyps[rank].score + scorer_.trans(in, lbl), in, rank});
+                }
+            }
+
+            auto top = best.extract_top();
+            for (auto& hyp : top)
+                hyp.score += scorer_.state(t, lbl);
+            table.hypotheses(t, lbl, std::move(top));
+        }
+    }
+    return table;
+}
+
 }
 }
@@ -0,0 +1,112 @@
+/**
+ * @file feature_cache.cpp
+ * @author Chase Geigle
+ */
+
+#include <fstream>
+
+#include "meta/io/filesystem.h"
+#include "meta/sequence/feature_cache.h"
+#include "meta/util/progress.h"
+
+namespace meta
+{
+namespace sequence
+{
+
+namespace
+{
+template <class T>
+void write_raw(std::ofstream& out, T value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+}
+
+std::string feature_cache::write_cache(const std::string& prefix,
+                                       std::vector<sequence>& sequences,
+                                       sequence_analyzer& analyzer)
+{
+    filesystem::make_directory(prefix);
+
+    std::ofstream seq_offsets{prefix + "/cache.seq_offsets",
+                              std::ios::binary};
+    std::ofstream offsets{prefix + "/cache.offsets", std::ios::binary};
+    std::ofstream ids{prefix + "/cache.ids", std::ios::binary};
+    std::ofstream values{prefix + "/cache.values", std::ios::binary};
+    if (!seq_offsets || !offsets || !ids || !values)
+        throw exception{"failed to create feature cache files in " + prefix};
+
+    printing::progress progress{" > Featurizing: ", sequences.size()};
+    uint64_t obs_index = 0;
+    uint64_t entry_index = 0;
+    for (uint64_t s = 0; s < sequences.size(); ++s)
+    {
+        progress(s);
+        auto& seq = sequences[s];
+        write_raw(seq_offsets, obs_index);
+        for (uint64_t t = 0; t < seq.size(); ++t)
+        {
+            analyzer.analyze_static(seq, t);
+            write_raw(offsets, entry_index);
+            for (const auto& feat : seq[t].features())
+            {
+                write_raw(ids, static_cast<uint64_t>(feat.first));
+                write_raw(values, feat.second);
+            }
+            entry_index += seq[t].features().size();
+            ++obs_index;
+        }
+    }
+    // sentinel offsets so the last ranges are well defined
+    write_raw(seq_offsets, obs_index);
+    write_raw(offsets, entry_index);
+
+    return prefix;
+}
+
+feature_cache::feature_cache(const std::string& prefix,
+                             std::vector<sequence>& sequences,
+                             sequence_analyzer& analyzer)
+    : feature_cache{write_cache(prefix, sequences, analyzer)}
+{
+    // nothing
+}
+
+feature_cache::feature_cache(const std::string& prefix)
+    : seq_offsets_{prefix + "/cache.seq_offsets"},
+      offsets_{prefix + "/cache.offsets"},
+      ids_{prefix + "/cache.ids"},
+      values_{prefix + "/cache.values"}
+{
+    // nothing
+}
+
+uint64_t feature_cache::size() const
+{
+    return seq_offsets_.size() - 1;
+}
+
+void feature_cache::fill(uint64_t seq_index, sequence& seq) const
+{
+    if (seq_index >= size())
+        throw exception{"sequence index out of range"};
+
+    auto obs_begin = seq_offsets_[seq_index];
+    if (seq_offsets_[seq_index + 1] - obs_begin != seq.size())
+        throw exception{"sequence does not match the cached featurization"};
+
+    for (uint64_t t = 0; t < seq.size(); ++t)
+    {
+        auto begin = offsets_[obs_begin + t];
+        auto end = offsets_[obs_begin + t + 1];
+
+        observation::feature_vector feats;
+        feats.reserve(end - begin);
+        for (auto i = begin; i < end; ++i)
+            feats.emplace_back(feature_id{ids_[i]}, values_[i]);
+        seq[t].features(std::move(feats));
+    }
+}
+}
+}
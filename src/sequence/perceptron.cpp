@@ -4,10 +4,14 @@
  */
 
 #include <fstream>
+#include <unordered_map>
 
 #include "meta/io/filesystem.h"
 #include "meta/io/gzstream.h"
+#include "meta/parallel/parallel_for.h"
+#include "meta/sequence/feature_cache.h"
 #include "meta/sequence/perceptron.h"
+#include "meta/util/optional.h"
 #include "meta/utf/utf.h"
 #include "meta/util/progress.h"
 #include "meta/util/time.h"
@@ -20,8 +24,10 @@ namespace sequence
 perceptron::perceptron() : analyzer_{default_pos_analyzer()}
 {
     // special analyzer function that adds features that wouldn't be
-    // allowed under our linear-chain CRF model
-    analyzer_.add_observation_function(
+    // allowed under our linear-chain CRF model; it reads the labels of
+    // earlier observations, so it is dynamic and excluded from the
+    // training-time featurization cache
+    analyzer_.add_dynamic_observation_function(
         [](const sequence& seq, uint64_t t, sequence_analyzer::collector& coll)
         {
             std::string prev = "<s>";
@@ -49,6 +55,8 @@ perceptron::perceptron(const std::string& prefix) : perceptron()
     analyzer_.load(prefix);
     io::gzifstream file{prefix + "/tagger.model.gz"};
     model_.load(file);
+    // loaded taggers only ever score, so use the contiguous form
+    model_.freeze();
 }
 
 void perceptron::tag(sequence& seq) const
@@ -61,6 +69,16 @@ void perceptron::tag(sequence& seq) const
     }
 }
 
+void perceptron::tag_batch(std::vector<sequence>& sequences,
+                           parallel::thread_pool& pool) const
+{
+    parallel::parallel_for(sequences.begin(), sequences.end(), pool,
+                           [&](sequence& seq)
+                           {
+                               tag(seq);
+                           });
+}
+
 void perceptron::train(std::vector<sequence>& sequences,
                        const training_options& options)
 {
@@ -69,8 +87,42 @@ void perceptron::train(std::vector<sequence>& sequences,
     std::vector<size_t> indices(sequences.size());
     std::iota(indices.begin(), indices.end(), 0);
 
-    classify::linear_model<feature_id, double, label_id> for_avg;
+    // lazy (timestamped) averaging: each touched weight remembers how
+    // many steps its value has been integrated through, so a weight
+    // only pays averaging cost on the steps that actually change it;
+    // everything else is settled in one pass after the last epoch
+    struct avg_state
+    {
+        double integral = 0;
+        uint64_t covered = 0;
+    };
+    std::unordered_map<feature_id, util::small_sparse_vector<
+                                       label_id, avg_state>> averages;
+
+    // featurize every sequence once up front; later epochs restore the
+    // static features with an mmap'd array walk and only rerun the
+    // dynamic (label-dependent) observation functions
+    util::optional<feature_cache> cache;
+    if (!options.cache_path.empty())
+        cache = feature_cache{options.cache_path, sequences, analyzer_};
+
     uint64_t total_updates = 0;
+
+    auto weight = [&](const feature_id& fid, label_id cid)
+    {
+        const auto& weights = model_.weights();
+        auto it = weights.find(fid);
+        return it == weights.end() ? 0.0 : it->second.at(cid);
+    };
+
+    auto update = [&](label_id cid, const feature_id& fid, double delta)
+    {
+        auto current = weight(fid, cid);
+        auto& state = averages[fid][cid];
+        state.integral += (total_updates - 1 - state.covered) * current;
+        state.covered = total_updates - 1;
+        model_.update(cid, fid, delta);
+    };
     for (uint64_t epoch = 1; epoch <= options.max_iterations; ++epoch)
     {
         std::shuffle(indices.begin(), indices.end(), rng);
@@ -88,10 +140,15 @@ void perceptron::train(std::vector<sequence>& sequences,
                 {
                     progress(i);
                     auto& seq = sequences[indices[i]];
+                    if (cache)
+                        cache->fill(indices[i], seq);
 
                     for (uint64_t t = 0; t < seq.size(); ++t)
                     {
-                        analyzer_.analyze(seq, t);
+                        if (cache)
+                            analyzer_.analyze_dynamic(seq, t);
+                        else
+                            analyzer_.analyze(seq, t);
 
                         auto lbl = model_.best_class(seq[t].features());
                         auto correct = analyzer_.label(seq[t].tag());
@@ -102,16 +159,8 @@ void perceptron::train(std::vector<sequence>& sequences,
                             ++num_incorrect;
                             for (const auto& feat : seq[t].features())
                             {
-                                model_.update(lbl, feat.first,
-                                              -1.0 * feat.second);
-                                for_avg.update(lbl, feat.first,
-                                               -1.0 * (total_updates - 1)
-                                               * feat.second);
-
-                                model_.update(correct, feat.first, feat.second);
-                                for_avg.update(correct, feat.first,
-                                               (total_updates - 1)
-                                               * feat.second);
+                                update(lbl, feat.first, -1.0 * feat.second);
+                                update(correct, feat.first, feat.second);
                             }
                         }
                         else
@@ -128,11 +177,37 @@ void perceptron::train(std::vector<sequence>& sequences,
                   << ENDLG;
 
         model_.condense(true);
-        for_avg.condense(false);
     }
 
-    // update weights to be average over all parameters
-    model_.update(for_avg.weights(), -1.0 / total_updates);
+    // settle every weight's integral through the final step and move
+    // the model to the average over all steps
+    classify::linear_model<feature_id, double, label_id>::weight_vectors
+        correction;
+    for (const auto& feat_avg : averages)
+    {
+        for (const auto& class_state : feat_avg.second)
+        {
+            auto current = weight(feat_avg.first, class_state.first);
+            auto integral = class_state.second.integral
+                            + (total_updates - class_state.second.covered)
+                                  * current;
+            auto average = integral / total_updates;
+            if (average != current)
+                correction[feat_avg.first][class_state.first]
+                    = average - current;
+        }
+    }
+    model_.update(correction);
+    model_.condense(true);
+
+    // training is done; compact into the contiguous inference form
+    model_.freeze();
+
+    if (cache)
+    {
+        cache = util::nullopt;
+        filesystem::remove_all(options.cache_path);
+    }
 }
 
 void perceptron::save(const std::string& prefix) const
@@ -5,7 +5,9 @@
 
 #include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <sstream>
+#include "meta/hashing/hash.h"
 #include "meta/io/packed.h"
 #include "meta/io/filesystem.h"
 #include "meta/io/gzstream.h"
@@ -24,16 +26,32 @@ sequence_analyzer::sequence_analyzer(const std::string& prefix)
     load(prefix);
 }
 
+sequence_analyzer::sequence_analyzer(uint64_t num_buckets)
+    : hash_space_{num_buckets}
+{
+    // nothing
+}
+
 void sequence_analyzer::load(const std::string& prefix)
 {
     feature_id_mapping_.clear();
     label_id_mapping_.clear();
+    hash_space_ = 0;
     load_feature_id_mapping(prefix);
     load_label_id_mapping(prefix);
 }
 
 void sequence_analyzer::load_feature_id_mapping(const std::string& prefix)
 {
+    // hashed analyzers have no feature mapping, just a bucket count
+    auto hash_file = prefix + "/feature.hashing";
+    if (filesystem::file_exists(hash_file))
+    {
+        std::ifstream input{hash_file, std::ios::binary};
+        io::packed::read(input, hash_space_);
+        return;
+    }
+
     auto feature_file = prefix + "/feature.mapping.gz";
     if (!filesystem::file_exists(feature_file))
         throw exception{"missing feature id mapping: " + feature_file};
@@ -66,6 +84,14 @@ void sequence_analyzer::load_label_id_mapping(const std::string& prefix)
 
 void sequence_analyzer::save(const std::string& prefix) const
 {
+    if (hash_space_)
+    {
+        std::ofstream output{prefix + "/feature.hashing", std::ios::binary};
+        io::packed::write(output, hash_space_);
+        map::save_mapping(label_id_mapping_, prefix + "/label.mapping");
+        return;
+    }
+
     printing::progress progress{" > Saving feature mapping: ",
                                 feature_id_mapping_.size()};
 
@@ -89,9 +115,55 @@ void sequence_analyzer::analyze(sequence& sequence)
 
 void sequence_analyzer::analyze(sequence& sequence, uint64_t t)
 {
-    default_collector coll{this, &sequence[t]};
-    for (const auto& fn : obs_fns_)
-        fn(sequence, t, coll);
+    {
+        default_collector coll{this, &sequence[t]};
+        for (const auto& fn : obs_fns_)
+            fn(sequence, t, coll);
+        for (const auto& fn : dyn_obs_fns_)
+            fn(sequence, t, coll);
+    }
+    assign_label(sequence, t);
+}
+
+void sequence_analyzer::analyze_static(sequence& sequence, uint64_t t)
+{
+    {
+        default_collector coll{this, &sequence[t]};
+        for (const auto& fn : obs_fns_)
+            fn(sequence, t, coll);
+    }
+    assign_label(sequence, t);
+}
+
+void sequence_analyzer::analyze_dynamic(sequence& sequence, uint64_t t)
+{
+    if (dyn_obs_fns_.empty())
+        return;
+
+    // collect the dynamic features separately, then merge them into the
+    // (already sorted) static features restored before this call
+    auto existing = sequence[t].features();
+    {
+        default_collector coll{this, &sequence[t]};
+        for (const auto& fn : dyn_obs_fns_)
+            fn(sequence, t, coll);
+    }
+    auto dynamic = sequence[t].features();
+
+    observation::feature_vector merged;
+    merged.reserve(existing.size() + dynamic.size());
+    std::merge(existing.begin(), existing.end(), dynamic.begin(),
+               dynamic.end(), std::back_inserter(merged),
+               [](const std::pair<feature_id, double>& lhs,
+                  const std::pair<feature_id, double>& rhs)
+               {
+                   return lhs.first < rhs.first;
+               });
+    sequence[t].features(std::move(merged));
+}
+
+void sequence_analyzer::assign_label(sequence& sequence, uint64_t t)
+{
     if (!label_id_mapping_.contains_key(sequence[t].tag()))
     {
         label_id id(static_cast<uint32_t>(label_id_mapping_.size()));
@@ -111,6 +183,8 @@ void sequence_analyzer::analyze(sequence& sequence, uint64_t t) const
     const_collector coll{this, &sequence[t]};
     for (const auto& fn : obs_fns_)
         fn(sequence, t, coll);
+    for (const auto& fn : dyn_obs_fns_)
+        fn(sequence, t, coll);
 
     if (!sequence[t].tagged()
         || !label_id_mapping_.contains_key(sequence[t].tag()))
@@ -122,9 +196,13 @@ void sequence_analyzer::analyze(sequence& sequence, uint64_t t) const
 
 feature_id sequence_analyzer::feature(const std::string& feature)
 {
+    if (hash_space_)
+        return hashed_feature(feature);
     auto it = feature_id_mapping_.find(feature);
     if (it != feature_id_mapping_.end())
         return it->second;
+    if (frozen_)
+        return feature_id{feature_id_mapping_.size()};
     auto sze = feature_id{feature_id_mapping_.size()};
     feature_id_mapping_[feature] = sze;
     return sze;
@@ -132,14 +210,31 @@ feature_id sequence_analyzer::feature(const std::string& feature)
 
 feature_id sequence_analyzer::feature(const std::string& feature) const
 {
+    if (hash_space_)
+        return hashed_feature(feature);
     auto it = feature_id_mapping_.find(feature);
     if (it != feature_id_mapping_.end())
         return it->second;
     return feature_id{feature_id_mapping_.size()};
 }
 
+feature_id sequence_analyzer::hashed_feature(const std::string& feat) const
+{
+    hashing::farm_hash hasher;
+    hasher(feat.data(), feat.size());
+    auto hashed = static_cast<hashing::farm_hash::result_type>(hasher);
+    return feature_id{hashed % hash_space_};
+}
+
+void sequence_analyzer::freeze()
+{
+    frozen_ = true;
+}
+
 uint64_t sequence_analyzer::num_features() const
 {
+    if (hash_space_)
+        return hash_space_;
     return feature_id_mapping_.size();
 }
 
@@ -181,10 +276,10 @@ std::string prefix(const std::string& input, uint64_t length)
 }
 }
 
-sequence_analyzer default_pos_analyzer()
+namespace
+{
+void add_pos_observation_functions(sequence_analyzer& analyzer)
 {
-    sequence_analyzer analyzer;
-
     auto word_feats = [](const std::string& word, uint64_t t,
                          sequence_analyzer::collector& coll)
     {
@@ -295,7 +390,20 @@ sequence_analyzer default_pos_analyzer()
         {
             coll.add("bias", 1);
         });
+}
+}
+
+sequence_analyzer default_pos_analyzer()
+{
+    sequence_analyzer analyzer;
+    add_pos_observation_functions(analyzer);
+    return analyzer;
+}
 
+sequence_analyzer default_pos_analyzer(uint64_t num_buckets)
+{
+    sequence_analyzer analyzer{num_buckets};
+    add_pos_observation_functions(analyzer);
     return analyzer;
 }
 }
@@ -18,6 +18,12 @@ trellis::trellis(uint64_t size, uint64_t labels)
     // nothing
 }
 
+trellis::trellis(uint64_t size, uint64_t labels, util::arena& arena)
+    : trellis_(size, labels, util::arena_allocator<double>{arena})
+{
+    // nothing
+}
+
 uint64_t trellis::size() const
 {
     return trellis_.rows();
@@ -39,6 +45,14 @@ viterbi_trellis::viterbi_trellis(uint64_t size, uint64_t labels)
     // nothing
 }
 
+viterbi_trellis::viterbi_trellis(uint64_t size, uint64_t labels,
+                                 util::arena& arena)
+    : trellis{size, labels, arena},
+      paths_{size, labels, util::arena_allocator<label_id>{arena}}
+{
+    // nothing
+}
+
 void viterbi_trellis::previous_tag(uint64_t idx, const label_id& current,
                                    const label_id& previous)
 {
@@ -51,12 +65,48 @@ const label_id& viterbi_trellis::previous_tag(uint64_t idx,
     return paths_(idx, current);
 }
 
+nbest_trellis::nbest_trellis(uint64_t size, uint64_t labels, uint64_t n)
+    : hypotheses_{size, labels}, n_{n}
+{
+    // nothing
+}
+
+uint64_t nbest_trellis::size() const
+{
+    return hypotheses_.rows();
+}
+
+uint64_t nbest_trellis::num_best() const
+{
+    return n_;
+}
+
+void nbest_trellis::hypotheses(uint64_t idx, const label_id& tag,
+                               std::vector<backpointer> hyps)
+{
+    hypotheses_(idx, tag) = std::move(hyps);
+}
+
+const std::vector<nbest_trellis::backpointer>&
+nbest_trellis::hypotheses(uint64_t idx, const label_id& tag) const
+{
+    return hypotheses_(idx, tag);
+}
+
 forward_trellis::forward_trellis(uint64_t size, uint64_t labels)
     : trellis{size, labels}, normalizers_(size)
 {
     // nothing
 }
 
+forward_trellis::forward_trellis(uint64_t size, uint64_t labels,
+                                 util::arena& arena)
+    : trellis{size, labels, arena},
+      normalizers_(size, 0.0, util::arena_allocator<double>{arena})
+{
+    // nothing
+}
+
 double forward_trellis::normalizer(uint64_t idx) const
 {
     return normalizers_[idx];
@@ -0,0 +1,204 @@
+/**
+ * @file dd_sketch.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "meta/stats/dd_sketch.h"
+
+namespace meta
+{
+namespace stats
+{
+
+dd_sketch::dd_sketch(double relative_accuracy /* = 0.01 */,
+                     std::size_t max_buckets /* = 2048 */)
+    : relative_accuracy_{relative_accuracy},
+      gamma_{(1.0 + relative_accuracy) / (1.0 - relative_accuracy)},
+      inv_log_gamma_{1.0 / std::log(gamma_)},
+      max_buckets_{max_buckets},
+      zero_count_{0},
+      count_{0},
+      min_{0.0},
+      max_{0.0}
+{
+    if (relative_accuracy <= 0.0 || relative_accuracy >= 1.0)
+        throw exception{"relative accuracy must be in (0, 1)"};
+    if (max_buckets < 2)
+        throw exception{"bucket budget must be at least 2"};
+}
+
+int32_t dd_sketch::bucket_index(double value) const
+{
+    return static_cast<int32_t>(std::ceil(std::log(value) * inv_log_gamma_));
+}
+
+double dd_sketch::bucket_value(int32_t index) const
+{
+    // the midpoint (in relative terms) of (gamma^(i-1), gamma^i]
+    return 2.0 * std::pow(gamma_, index) / (gamma_ + 1.0);
+}
+
+void dd_sketch::add(double value, uint64_t count /* = 1 */)
+{
+    if (count == 0)
+        return;
+
+    if (count_ == 0 || value < min_)
+        min_ = std::max(value, 0.0);
+    if (count_ == 0 || value > max_)
+        max_ = std::max(value, 0.0);
+    count_ += count;
+
+    if (value <= 0.0)
+    {
+        zero_count_ += count;
+        return;
+    }
+
+    buckets_[bucket_index(value)] += count;
+    collapse();
+}
+
+void dd_sketch::add_bucket(int32_t index, uint64_t count)
+{
+    if (count == 0)
+        return;
+
+    auto rep = bucket_value(index);
+    if (count_ == 0 || rep < min_)
+        min_ = rep;
+    if (count_ == 0 || rep > max_)
+        max_ = rep;
+    count_ += count;
+
+    buckets_[index] += count;
+    collapse();
+}
+
+void dd_sketch::merge(const dd_sketch& other)
+{
+    if (relative_accuracy_ != other.relative_accuracy_)
+        throw exception{"cannot merge sketches of differing accuracy"};
+
+    if (other.count_ == 0)
+        return;
+
+    if (count_ == 0 || other.min_ < min_)
+        min_ = other.min_;
+    if (count_ == 0 || other.max_ > max_)
+        max_ = other.max_;
+    count_ += other.count_;
+    zero_count_ += other.zero_count_;
+
+    for (const auto& bucket : other.buckets_)
+        buckets_[bucket.first] += bucket.second;
+    collapse();
+}
+
+void dd_sketch::collapse()
+{
+    while (buckets_.size() > max_buckets_)
+    {
+        auto lowest = buckets_.begin();
+        auto count = lowest->second;
+        lowest = buckets_.erase(lowest);
+        lowest->second += count;
+    }
+}
+
+double dd_sketch::quantile(double q) const
+{
+    if (count_ == 0)
+        return 0.0;
+
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1));
+
+    if (rank < zero_count_)
+        return 0.0;
+
+    auto cumulative = zero_count_;
+    for (const auto& bucket : buckets_)
+    {
+        cumulative += bucket.second;
+        if (cumulative > rank)
+            return std::min(std::max(bucket_value(bucket.first), min_), max_);
+    }
+    return max_;
+}
+
+uint64_t dd_sketch::size() const
+{
+    return count_;
+}
+
+double dd_sketch::relative_accuracy() const
+{
+    return relative_accuracy_;
+}
+
+concurrent_dd_sketch::concurrent_dd_sketch(
+    double relative_accuracy /* = 0.01 */, double min_trackable /* = 1e-6 */,
+    double max_trackable /* = 1e9 */)
+    : proto_{relative_accuracy}
+{
+    if (!(min_trackable > 0.0) || !(max_trackable > min_trackable))
+        throw dd_sketch::exception{"invalid trackable range"};
+
+    base_index_ = proto_.bucket_index(min_trackable);
+    auto top_index = proto_.bucket_index(max_trackable);
+    // slot 0 counts non-positive values; the rest are the index range
+    num_buckets_ = static_cast<std::size_t>(top_index - base_index_ + 1) + 1;
+
+    counts_.reset(new std::atomic<uint64_t>[num_shards * num_buckets_]);
+    for (std::size_t i = 0; i < num_shards * num_buckets_; ++i)
+        counts_[i].store(0, std::memory_order_relaxed);
+}
+
+void concurrent_dd_sketch::add(double value)
+{
+    // spread threads over the shards to keep hot buckets from
+    // ping-ponging between cores; the exact assignment is irrelevant
+    static std::atomic<std::size_t> next_shard{0};
+    static thread_local const std::size_t shard
+        = next_shard.fetch_add(1, std::memory_order_relaxed) % num_shards;
+
+    std::size_t slot = 0;
+    if (value > 0.0)
+    {
+        auto index = proto_.bucket_index(value);
+        index = std::max(
+            base_index_,
+            std::min(index, base_index_
+                                + static_cast<int32_t>(num_buckets_) - 2));
+        slot = static_cast<std::size_t>(index - base_index_) + 1;
+    }
+    counts_[shard * num_buckets_ + slot].fetch_add(1,
+                                                   std::memory_order_relaxed);
+}
+
+dd_sketch concurrent_dd_sketch::snapshot() const
+{
+    dd_sketch result{proto_.relative_accuracy()};
+    for (std::size_t slot = 0; slot < num_buckets_; ++slot)
+    {
+        uint64_t count = 0;
+        for (std::size_t shard = 0; shard < num_shards; ++shard)
+            count += counts_[shard * num_buckets_ + slot].load(
+                std::memory_order_relaxed);
+        if (count == 0)
+            continue;
+
+        if (slot == 0)
+            result.add(0.0, count);
+        else
+            result.add_bucket(base_index_ + static_cast<int32_t>(slot) - 1,
+                              count);
+    }
+    return result;
+}
+}
+}
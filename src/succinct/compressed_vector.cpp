@@ -7,7 +7,11 @@
  * project.
  */
 
+#include <algorithm>
+
+#include "meta/io/packed.h"
 #include "meta/succinct/compressed_vector.h"
+#include "meta/util/shim.h"
 
 namespace meta
 {
@@ -31,9 +35,103 @@ uint64_t compressed_vector::operator[](uint64_t i) const
     return num_bvv.extract(start, static_cast<uint8_t>(end - start));
 }
 
+uint64_t compressed_vector::decode(uint64_t start, uint64_t count,
+                                   uint64_t* out) const
+{
+    auto total = size();
+    if (start >= total)
+        return 0;
+    count = std::min(count, total - start);
+
+    bit_vector_view num_bvv{{numbers_.begin(), numbers_.end()},
+                            64 * numbers_.size()};
+    auto high = positions_.high_bits();
+    auto low = positions_.low_bits();
+    auto lb = positions_.num_low_bits();
+
+    // one select query lands on the start-th boundary; every boundary
+    // after that comes from walking the set bits of the position
+    // index's high array a word at a time
+    auto pos = select_.select(start);
+    auto high_idx = (pos >> lb) + start;
+    auto word_idx = high_idx / 64;
+    auto cur = high.extract(64 * word_idx, 64);
+
+    // consume the start-th one and everything below it in its word
+    auto off = high_idx % 64;
+    cur = off == 63 ? 0 : cur & (~uint64_t{0} << (off + 1));
+
+    for (uint64_t k = 1; k <= count; ++k)
+    {
+        while (!cur)
+            cur = high.extract(64 * ++word_idx, 64);
+
+        auto one_idx = start + k;
+        auto bit = 64 * word_idx + broadword::lsb(cur);
+        cur &= cur - 1;
+
+        auto next
+            = (bit - one_idx) << lb | low.extract(one_idx * lb, lb);
+        out[k - 1] = num_bvv.extract(pos, static_cast<uint8_t>(next - pos));
+        pos = next;
+    }
+    return count;
+}
+
 uint64_t compressed_vector::size() const
 {
     return select_.size() - 1;
 }
+
+compressed_vector_builder::compressed_vector_builder(const std::string& prefix)
+    : prefix_{prefix}
+{
+    filesystem::make_directory(prefix);
+    bv_stream_.open(prefix + "/compressed-vec.bin", std::ios::binary);
+    len_stream_.open(prefix + "/lengths.tmp", std::ios::binary);
+    bv_builder_
+        = make_unique<builder_type>(make_bit_vector_builder(bv_stream_));
+}
+
+void compressed_vector_builder::operator()(uint64_t word)
+{
+    uint64_t len = (word) ? broadword::msb(word) : 1;
+    bv_builder_->write_bits({word, static_cast<uint8_t>(len)});
+    io::packed::write(len_stream_, len);
+    ++num_elems_;
+}
+
+compressed_vector_builder::~compressed_vector_builder()
+{
+    auto num_bits = bv_builder_->total_bits();
+    // flush any trailing partial word of value bits
+    bv_builder_ = nullptr;
+    bv_stream_.close();
+    len_stream_.close();
+
+    // replay the staged bit lengths to build the boundary positions;
+    // this is the only second pass, and it is over the (small) packed
+    // lengths file rather than the values themselves
+    auto len_file = prefix_ + "/lengths.tmp";
+    {
+        filesystem::make_directory(prefix_ + "/sarray");
+        sarray_builder s_builder{prefix_ + "/sarray", num_elems_ + 1,
+                                 num_bits};
+        std::ifstream lengths{len_file, std::ios::binary};
+        uint64_t pos = 0;
+        s_builder(pos);
+        for (uint64_t i = 0; i < num_elems_; ++i)
+        {
+            uint64_t len;
+            io::packed::read(lengths, len);
+            pos += len;
+            s_builder(pos);
+        }
+    }
+    filesystem::delete_file(len_file);
+
+    sarray select{prefix_ + "/sarray"};
+    sarray_select{prefix_ + "/sarray", select};
+}
 }
 }
@@ -0,0 +1,284 @@
+/**
+ * @file bench_core.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "meta/embeddings/cooccur_record.h"
+#include "meta/hashing/probe_map.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
+#include "meta/parallel/thread_pool.h"
+#include "meta/util/fixed_heap.h"
+#include "meta/util/multiway_merge.h"
+#include "meta/util/progress.h"
+
+using namespace meta;
+
+namespace
+{
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+/**
+ * @return the peak resident set size of this process in kilobytes, or 0
+ * if the platform provides no way to query it
+ */
+uint64_t peak_rss_kb()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+    return 0;
+}
+}
+
+/**
+ * Microbenchmark harness for the core primitives the indexing and
+ * retrieval pipelines are built from: the packed integer codec, the
+ * probing hash table, the bounded top-k heap, the k-way chunk merge, and
+ * thread_pool task dispatch. Every workload is generated from fixed
+ * seeds and results go to stdout as one JSON object, so two build trees
+ * can be compared run against run (see contrib/benchmarks).
+ */
+int main(int argc, char* argv[])
+{
+    uint64_t num_elems = 10000000;
+    uint64_t num_chunks = 16;
+    uint64_t num_threads = std::thread::hardware_concurrency();
+
+    if (argc > 1 && std::string{argv[1]} == "--help")
+    {
+        std::cerr << "Usage:\t" << argv[0]
+                  << " [num-elems] [num-chunks] [threads]" << std::endl;
+        return 1;
+    }
+
+    if (argc > 1)
+        num_elems = std::stoull(argv[1]);
+    if (argc > 2)
+        num_chunks = std::stoull(argv[2]);
+    if (argc > 3)
+        num_threads = std::stoull(argv[3]);
+
+    const std::string scratch = "bench-core-scratch";
+    filesystem::remove_all(scratch);
+    if (!filesystem::make_directory(scratch))
+    {
+        std::cerr << "Unable to create scratch directory: " << scratch
+                  << std::endl;
+        return 1;
+    }
+
+    // phase 1: the byte-oriented varint codec from io/packed.h, over a
+    // geometric length mix so all encoded widths are exercised the way
+    // compressed postings exercise them
+    double packed_write_secs;
+    double packed_read_secs;
+    uint64_t packed_bytes;
+    {
+        std::mt19937_64 rng{42};
+        std::vector<uint64_t> values(num_elems);
+        for (auto& v : values)
+            v = rng() >> (rng() % 64);
+
+        std::stringstream stream;
+        auto write_start = std::chrono::steady_clock::now();
+        uint64_t bytes = 0;
+        for (const auto& v : values)
+            bytes += io::packed::write(stream, v);
+        packed_write_secs = seconds_since(write_start);
+        packed_bytes = bytes;
+
+        uint64_t checksum = 0;
+        auto read_start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < num_elems; ++i)
+        {
+            uint64_t v;
+            io::packed::read(stream, v);
+            checksum ^= v;
+        }
+        packed_read_secs = seconds_since(read_start);
+
+        for (const auto& v : values)
+            checksum ^= v;
+        if (checksum != 0)
+        {
+            std::cerr << "packed codec roundtrip mismatch" << std::endl;
+            return 1;
+        }
+    }
+
+    // phase 2: probe_map counting via insert_or_add over a keyspace a
+    // quarter the size of the stream (so both hits and growth-triggering
+    // misses occur), then a full find() pass over the distinct keys
+    double probe_insert_secs;
+    double probe_find_secs;
+    uint64_t probe_size;
+    {
+        std::mt19937_64 rng{42};
+        std::vector<uint64_t> keys(num_elems);
+        for (auto& k : keys)
+            k = rng() % std::max<uint64_t>(1, num_elems / 4);
+
+        hashing::probe_map<uint64_t, uint64_t> counts;
+        auto insert_start = std::chrono::steady_clock::now();
+        for (const auto& k : keys)
+            counts.insert_or_add(k, 1);
+        probe_insert_secs = seconds_since(insert_start);
+        probe_size = counts.size();
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        uint64_t found = 0;
+        auto find_start = std::chrono::steady_clock::now();
+        for (const auto& k : keys)
+            found += counts.find(k) != counts.end();
+        probe_find_secs = seconds_since(find_start);
+        if (found != probe_size)
+        {
+            std::cerr << "probe_map lookup mismatch" << std::endl;
+            return 1;
+        }
+    }
+
+    // phase 3: bounded top-k selection over a random stream, the shape
+    // of every ranker's result accumulation
+    double heap_secs;
+    {
+        const uint64_t k = 1000;
+        std::mt19937_64 rng{42};
+        using pair_t = std::pair<uint64_t, uint64_t>;
+        auto heap = util::make_fixed_heap<pair_t>(
+            k, [](const pair_t& a, const pair_t& b) {
+                return a.second > b.second;
+            });
+        auto heap_start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < num_elems; ++i)
+            heap.emplace(i, rng());
+        auto top = heap.extract_top();
+        heap_secs = seconds_since(heap_start);
+        if (top.size() != k)
+        {
+            std::cerr << "fixed_heap size mismatch" << std::endl;
+            return 1;
+        }
+    }
+
+    // phase 4: the k-way merge of sorted on-disk chunks that finishes
+    // every index build, using the cooccurrence record as a typical
+    // fixed-shape Record
+    double merge_secs;
+    uint64_t merge_unique;
+    {
+        auto records_per_chunk = std::max<uint64_t>(1, num_elems / num_chunks);
+        // a keyspace smaller than the record count guarantees merges
+        // both within and across chunks
+        auto vocab = std::max<uint64_t>(1, records_per_chunk / 2);
+        std::vector<util::chunk_iterator<embeddings::cooccur_record>> chunks;
+        for (uint64_t c = 0; c < num_chunks; ++c)
+        {
+            std::mt19937_64 rng{c};
+            std::vector<embeddings::cooccur_record> records(records_per_chunk);
+            for (auto& r : records)
+                r = {rng() % vocab, rng() % vocab, 1.0};
+            std::sort(records.begin(), records.end());
+
+            auto filename = scratch + "/chunk-" + std::to_string(c);
+            std::ofstream output{filename, std::ios::binary};
+            for (const auto& r : records)
+                io::packed::write(output, r);
+            output.close();
+            chunks.emplace_back(filename);
+        }
+
+        uint64_t unique = 0;
+        auto merge_start = std::chrono::steady_clock::now();
+        util::multiway_merge(chunks.begin(), chunks.end(),
+                             [&](embeddings::cooccur_record&&) { ++unique; },
+                             printing::no_progress_trait{});
+        merge_secs = seconds_since(merge_start);
+        merge_unique = unique;
+    }
+
+    // phase 5: thread_pool dispatch overhead, measured with tasks small
+    // enough that submission and scheduling dominate the work itself
+    double pool_secs;
+    const uint64_t num_tasks = 100000;
+    {
+        parallel::thread_pool pool{num_threads};
+        std::vector<std::future<uint64_t>> futures;
+        futures.reserve(num_tasks);
+        auto pool_start = std::chrono::steady_clock::now();
+        for (uint64_t t = 0; t < num_tasks; ++t)
+            futures.emplace_back(pool.submit_task([t]() { return t; }));
+        uint64_t total = 0;
+        for (auto& fut : futures)
+            total += fut.get();
+        pool_secs = seconds_since(pool_start);
+        if (total != num_tasks * (num_tasks - 1) / 2)
+        {
+            std::cerr << "thread_pool result mismatch" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "{\n"
+              << "  \"config\": {\n"
+              << "    \"num_elems\": " << num_elems << ",\n"
+              << "    \"num_chunks\": " << num_chunks << ",\n"
+              << "    \"num_threads\": " << num_threads << "\n"
+              << "  },\n"
+              << "  \"packed\": {\n"
+              << "    \"bytes\": " << packed_bytes << ",\n"
+              << "    \"write_elems_per_sec\": " << num_elems / packed_write_secs
+              << ",\n"
+              << "    \"read_elems_per_sec\": " << num_elems / packed_read_secs
+              << "\n"
+              << "  },\n"
+              << "  \"probe_map\": {\n"
+              << "    \"distinct_keys\": " << probe_size << ",\n"
+              << "    \"inserts_per_sec\": " << num_elems / probe_insert_secs
+              << ",\n"
+              << "    \"finds_per_sec\": " << probe_size / probe_find_secs
+              << "\n"
+              << "  },\n"
+              << "  \"fixed_heap\": {\n"
+              << "    \"pushes_per_sec\": " << num_elems / heap_secs << "\n"
+              << "  },\n"
+              << "  \"multiway_merge\": {\n"
+              << "    \"unique_records\": " << merge_unique << ",\n"
+              << "    \"records_per_sec\": "
+              << (num_elems / num_chunks) * num_chunks / merge_secs << "\n"
+              << "  },\n"
+              << "  \"thread_pool\": {\n"
+              << "    \"tasks_per_sec\": " << num_tasks / pool_secs << "\n"
+              << "  },\n"
+              << "  \"peak_rss_kb\": " << peak_rss_kb() << "\n"
+              << "}" << std::endl;
+
+    filesystem::remove_all(scratch);
+
+    return 0;
+}
@@ -186,7 +186,7 @@ void pos(const std::string& file, const cpptoml::table& config, bool replace)
         }
         else
         {
-            seq.add_symbol(sequence::symbol_t{token});
+            seq.add_symbol(sequence::symbol_t{token.to_string()});
         }
     }
 
@@ -262,7 +262,7 @@ void parse(const std::string& file, const cpptoml::table& config)
         }
         else
         {
-            seq.add_symbol(sequence::symbol_t{token});
+            seq.add_symbol(sequence::symbol_t{token.to_string()});
         }
     }
 
@@ -3,36 +3,133 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "cpptoml.h"
 #include "meta/analyzers/analyzer.h"
 #include "meta/analyzers/filters/all.h"
+#include "meta/analyzers/token_stream.h"
 #include "meta/corpus/corpus.h"
 #include "meta/corpus/corpus_factory.h"
 #include "meta/logging/logger.h"
+#include "meta/parallel/thread_pool.h"
+#include "meta/stats/space_saving.h"
 #include "meta/util/fixed_heap.h"
 #include "meta/util/progress.h"
-#include <algorithm>
-#include <iostream>
-#include <string>
-#include <unordered_map>
-#include <vector>
 
 using namespace meta;
 
+namespace
+{
+
+/**
+ * Thread-local state for the bounded-memory counting pass: a private
+ * filter chain and SpaceSaving summary, folded into the shared summary
+ * when the worker finishes.
+ */
+struct local_counts
+{
+    local_counts(const cpptoml::table& config, const cpptoml::table& ana,
+                 std::size_t num_counters,
+                 stats::space_saving<std::string>& global, std::mutex& mutex)
+        : stream{analyzers::load_filters(config, ana)},
+          counts{num_counters},
+          global_(global),
+          mutex_(mutex)
+    {
+        // nothing
+    }
+
+    // moved-from workers merge an empty summary, which is a no-op
+    local_counts(local_counts&&) = default;
+
+    ~local_counts()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        global_.merge(counts);
+    }
+
+    std::unique_ptr<analyzers::token_stream> stream;
+    stats::space_saving<std::string> counts;
+    stats::space_saving<std::string>& global_;
+    std::mutex& mutex_;
+};
+
+/**
+ * Thread-local state for the optional exact pass: counts only the
+ * candidate terms from the first pass, merged into the shared map when
+ * the worker finishes.
+ */
+struct local_exact
+{
+    local_exact(const cpptoml::table& config, const cpptoml::table& ana,
+                const std::unordered_set<std::string>& candidates,
+                std::unordered_map<std::string, uint64_t>& global,
+                std::mutex& mutex)
+        : stream{analyzers::load_filters(config, ana)},
+          candidates_(candidates),
+          global_(global),
+          mutex_(mutex)
+    {
+        // nothing
+    }
+
+    // moved-from workers merge an empty map, which is a no-op
+    local_exact(local_exact&&) = default;
+
+    ~local_exact()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        for (const auto& count : counts)
+            global_[count.first] += count.second;
+    }
+
+    std::unique_ptr<analyzers::token_stream> stream;
+    std::unordered_map<std::string, uint64_t> counts;
+    const std::unordered_set<std::string>& candidates_;
+    std::unordered_map<std::string, uint64_t>& global_;
+    std::mutex& mutex_;
+};
+}
+
 int main(int argc, char* argv[])
 {
-    if (argc != 3)
+    if (argc < 3)
     {
-        std::cerr << "Usage: " << argv[0] << " config.toml k" << std::endl;
-        std::cerr << "Prints out the top k most frequent terms in the corpus "
-                     "according to the filter chain specified in the config "
-                     "file."
-                  << std::endl;
+        std::cerr << "Usage: " << argv[0]
+                  << " config.toml k [num-counters] [--exact]" << std::endl;
+        std::cerr
+            << "Prints out the top k most frequent terms in the corpus "
+               "according to the filter chain specified in the config "
+               "file. Terms are counted with a bounded-memory SpaceSaving "
+               "summary of num-counters counters (default 100 * k); pass "
+               "--exact to re-count the candidate terms exactly with a "
+               "second pass over the corpus."
+            << std::endl;
         return 1;
     }
 
     auto k = std::stoul(argv[2]);
 
+    std::size_t num_counters = 100 * k;
+    bool exact = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg{argv[i]};
+        if (arg == "--exact")
+            exact = true;
+        else
+            num_counters = std::stoul(arg);
+    }
+    num_counters = std::max<std::size_t>(num_counters, k);
+
     logging::set_cerr_logging();
 
     auto config = cpptoml::parse_file(argv[1]);
@@ -41,28 +138,80 @@ int main(int argc, char* argv[])
         throw std::runtime_error{"[[analyzers]] missing from config"};
 
     // only use the feature representation of the first analyzer
-    auto filts = analyzers::load_filters(*config, *(group->get()[0]));
+    const auto& ana = *(group->get()[0]);
+
+    parallel::thread_pool pool;
+    stats::space_saving<std::string> counts{num_counters};
 
-    std::unordered_map<std::string, uint64_t> counts;
-    auto docs = corpus::make_corpus(*config);
-    printing::progress prog{" > Reading corpus: ", docs->size()};
-    while (docs->has_next())
     {
-        auto doc = docs->next();
-        prog(doc.id());
-        auto content = doc.content();
-        filts->set_content(std::move(content));
-        while (*filts)
-            ++counts[filts->next()];
+        auto docs = corpus::make_corpus(*config);
+        printing::progress prog{" > Reading corpus: ", docs->size()};
+        std::atomic<uint64_t> processed{0};
+        std::mutex merge_mutex;
+        corpus::parallel_consume(
+            *docs, pool,
+            [&]() {
+                return local_counts{*config, ana, num_counters, counts,
+                                    merge_mutex};
+            },
+            [&](local_counts& ls, const corpus::document& doc) {
+                prog(processed++);
+                auto content = doc.content();
+                ls.stream->set_content(std::move(content));
+                while (*ls.stream)
+                    ls.counts.increment(ls.stream->next().to_string());
+            });
+        prog.end();
     }
-    prog.end();
 
     using pair_t = std::pair<std::string, uint64_t>;
     auto terms = util::make_fixed_heap<pair_t>(
         k,
         [](const pair_t& a, const pair_t& b) { return a.second > b.second; });
-    for (auto& term : counts)
-        terms.emplace(term);
+
+    if (!exact)
+    {
+        for (const auto& ctr : counts.counters())
+            terms.emplace(ctr.key, ctr.count);
+    }
+    else
+    {
+        // the summary's counts are upper bounds, but its key set is
+        // guaranteed to contain every sufficiently frequent term, so a
+        // second pass restricted to those candidates yields exact
+        // counts from bounded memory
+        std::unordered_set<std::string> candidates;
+        for (const auto& ctr : counts.counters())
+            candidates.insert(ctr.key);
+
+        std::unordered_map<std::string, uint64_t> exact_counts;
+
+        auto docs = corpus::make_corpus(*config);
+        printing::progress prog{" > Counting candidates: ", docs->size()};
+        std::atomic<uint64_t> processed{0};
+        std::mutex merge_mutex;
+        corpus::parallel_consume(
+            *docs, pool,
+            [&]() {
+                return local_exact{*config, ana, candidates, exact_counts,
+                                   merge_mutex};
+            },
+            [&](local_exact& ls, const corpus::document& doc) {
+                prog(processed++);
+                auto content = doc.content();
+                ls.stream->set_content(std::move(content));
+                while (*ls.stream)
+                {
+                    auto term = ls.stream->next().to_string();
+                    if (ls.candidates_.find(term) != ls.candidates_.end())
+                        ++ls.counts[term];
+                }
+            });
+        prog.end();
+
+        for (const auto& count : exact_counts)
+            terms.emplace(count);
+    }
 
     auto sorted = terms.extract_top();
     for (const auto& it : sorted)
@@ -16,7 +16,7 @@ namespace topics
 
 lda_cvb::lda_cvb(std::shared_ptr<index::forward_index> idx,
                  std::size_t num_topics, double alpha, double beta)
-    : lda_model{std::move(idx), num_topics}
+    : lda_model{std::move(idx), num_topics}, alpha_{alpha}
 {
     gamma_.resize(idx_->num_docs());
 
@@ -73,7 +73,8 @@ void lda_cvb::initialize()
 
         uint64_t i = 0; // i here is the inter-document term id, since we need
                         // to handle each word occurrence separately
-        for (auto& freq : idx_->search_primary(d)->counts())
+        auto stream = idx_->stream_for(d);
+        for (const auto& freq : *stream)
         {
             for (uint64_t count = 0; count < freq.second; ++count)
             {
@@ -110,7 +111,8 @@ double lda_cvb::perform_iteration(uint64_t iter)
         uint64_t i = 0; // term number within document---constructed
                         // so that each occurrence of the same term
                         // can still be assigned a different topic
-        for (auto& freq : idx_->search_primary(d)->counts())
+        auto stream = idx_->stream_for(d);
+        for (const auto& freq : *stream)
         {
             for (uint64_t count = 0; count < freq.second; ++count)
             {
@@ -158,6 +160,11 @@ double lda_cvb::compute_term_topic_probability(term_id term,
     return phi_[topic].probability(term);
 }
 
+double lda_cvb::doc_topic_prior() const
+{
+    return alpha_;
+}
+
 double lda_cvb::compute_doc_topic_probability(doc_id doc, topic_id topic) const
 {
     return theta_[doc].probability(topic);
@@ -5,8 +5,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <fstream>
+#include <numeric>
 
 #include "meta/index/postings_data.h"
+#include "meta/io/filesystem.h"
+#include "meta/io/packed.h"
 #include "meta/logging/logger.h"
 #include "meta/topics/lda_gibbs.h"
 #include "meta/util/progress.h"
@@ -18,7 +22,7 @@ namespace topics
 
 lda_gibbs::lda_gibbs(std::shared_ptr<index::forward_index> idx,
                      std::size_t num_topics, double alpha, double beta)
-    : lda_model{std::move(idx), num_topics}
+    : lda_model{std::move(idx), num_topics}, alpha_{alpha}, beta_{beta}
 {
     doc_word_topic_.resize(idx_->num_docs());
 
@@ -38,13 +42,28 @@ lda_gibbs::lda_gibbs(std::shared_ptr<index::forward_index> idx,
         phi_.emplace_back(
             stats::dirichlet<term_id>{beta, idx_->unique_terms()});
 
+    word_topic_counts_.resize(idx_->unique_terms());
+    alpha_vec_.assign(num_topics_, alpha);
+    alpha_sum_ = alpha * num_topics_;
+    refresh_smoothing_sum();
+
     std::random_device dev;
     rng_.seed(dev());
 }
 
+void lda_gibbs::refresh_smoothing_sum()
+{
+    smoothing_sum_ = 0;
+    for (topic_id topic{0}; topic < num_topics_; ++topic)
+        smoothing_sum_ += alpha_vec_[topic] * beta_ / phi_[topic].counts();
+}
+
 void lda_gibbs::run(uint64_t num_iters, double convergence /* = 1e-6 */)
 {
-    initialize();
+    // a nonzero completed iteration count means we were restored from a
+    // checkpoint, whose assignments replace initialization
+    if (completed_iterations_ == 0)
+        initialize();
     double likelihood = corpus_log_likelihood();
     std::stringstream ss;
     ss << "Initialization log likelihood (log P(W|Z)): " << likelihood;
@@ -54,9 +73,16 @@ void lda_gibbs::run(uint64_t num_iters, double convergence /* = 1e-6 */)
     ss << spacing;
     LOG(progress) << '\r' << ss.str() << '\n' << ENDLG;
 
-    for (uint64_t i = 0; i < num_iters; ++i)
+    for (uint64_t i = completed_iterations_; i < num_iters; ++i)
     {
         perform_iteration(i + 1);
+        completed_iterations_ = i + 1;
+        if (optimize_alpha_period_ > 0
+            && completed_iterations_ % optimize_alpha_period_ == 0)
+            optimize_alpha();
+        if (checkpoint_period_ > 0
+            && completed_iterations_ % checkpoint_period_ == 0)
+            write_checkpoint_async();
         double likelihood_update = corpus_log_likelihood();
         double ratio = std::fabs((likelihood - likelihood_update) / likelihood);
         likelihood = likelihood_update;
@@ -75,10 +101,181 @@ void lda_gibbs::run(uint64_t num_iters, double convergence /* = 1e-6 */)
             break;
         }
     }
+    // make sure the last checkpoint write (if any) has hit disk
+    if (checkpoint_future_.valid())
+        checkpoint_future_.get();
     LOG(info) << "Finished maximum iterations, or found convergence!" << ENDLG;
 }
 
+void lda_gibbs::checkpoint_every(uint64_t period, const std::string& prefix)
+{
+    checkpoint_period_ = period;
+    checkpoint_prefix_ = prefix;
+}
+
+void lda_gibbs::write_checkpoint(const std::string& filename) const
+{
+    std::ofstream out{filename, std::ios::binary};
+    io::packed::write(out, num_topics_);
+    io::packed::write(out, alpha_);
+    io::packed::write(out, beta_);
+    io::packed::write(out, alpha_vec_);
+    io::packed::write(out, completed_iterations_);
+    io::packed::write(out, doc_word_topic_);
+}
+
+void lda_gibbs::write_checkpoint_async()
+{
+    // never overlap two checkpoint writes
+    if (checkpoint_future_.valid())
+        checkpoint_future_.get();
+
+    // the assignments are the full sampler state (all counts are
+    // derivable from them), so the synchronous part of a checkpoint is
+    // just this copy
+    auto snapshot = std::make_shared<std::vector<std::vector<topic_id>>>(
+        doc_word_topic_);
+    auto filename = checkpoint_prefix_ + ".chk";
+    auto num_topics = num_topics_;
+    auto alpha = alpha_;
+    auto beta = beta_;
+    auto alpha_vec = alpha_vec_;
+    auto completed = completed_iterations_;
+    checkpoint_future_ = checkpoint_pool_.submit_task(
+        [snapshot, filename, num_topics, alpha, beta, alpha_vec,
+         completed]() {
+            {
+                std::ofstream out{filename + ".tmp", std::ios::binary};
+                io::packed::write(out, num_topics);
+                io::packed::write(out, alpha);
+                io::packed::write(out, beta);
+                io::packed::write(out, alpha_vec);
+                io::packed::write(out, completed);
+                io::packed::write(out, *snapshot);
+            }
+            // atomically replace the previous checkpoint
+            filesystem::rename_file(filename + ".tmp", filename);
+        });
+}
+
+void lda_gibbs::resume(const std::string& filename)
+{
+    std::ifstream in{filename, std::ios::binary};
+    if (!in)
+        throw std::runtime_error{"unable to open checkpoint file " + filename};
+
+    std::size_t num_topics;
+    io::packed::read(in, num_topics);
+    if (num_topics != num_topics_)
+        throw std::runtime_error{
+            "checkpoint was taken with a different number of topics"};
+    io::packed::read(in, alpha_);
+    io::packed::read(in, beta_);
+    io::packed::read(in, alpha_vec_);
+    alpha_sum_ = std::accumulate(alpha_vec_.begin(), alpha_vec_.end(), 0.0);
+    io::packed::read(in, completed_iterations_);
+    io::packed::read(in, doc_word_topic_);
+    if (doc_word_topic_.size() != idx_->num_docs())
+        throw std::runtime_error{
+            "checkpoint was taken over a different corpus"};
+
+    // rebuild every count structure from the restored assignments; the
+    // cached log likelihood is rebuilt alongside them by
+    // increase_counts()
+    for (auto& phi : phi_)
+        phi.clear();
+    for (auto& theta : theta_)
+        theta.clear();
+    for (auto& word_topics : word_topic_counts_)
+        word_topics.clear();
+    log_likelihood_ = 0;
+
+    printing::progress progress{" > Restoring counts: ", idx_->num_docs()};
+    for (const auto& i : idx_->docs())
+    {
+        progress(i);
+        uint64_t n = 0;
+        auto stream = idx_->stream_for(i);
+        for (const auto& freq : *stream)
+        {
+            for (uint64_t j = 0; j < freq.second; ++j)
+            {
+                increase_counts(doc_word_topic_[i][n], freq.first, i);
+                n += 1;
+            }
+        }
+    }
+    refresh_smoothing_sum();
+}
+
 topic_id lda_gibbs::sample_topic(term_id term, doc_id doc)
+{
+    // SparseLDA bucket decomposition: the sampling weight for topic t,
+    //
+    //   (n_{d,t} + \alpha)(n_{w,t} + \beta) / (n_t + V\beta),
+    //
+    // splits into a smoothing-only part \alpha\beta / (n_t + V\beta)
+    // (cached as smoothing_sum_), a document part that is nonzero only
+    // for topics present in the document, and a topic-word part that is
+    // nonzero only for topics in which the word occurs
+    const auto& theta = theta_[doc];
+
+    doc_weights_.clear();
+    double doc_sum = 0;
+    theta.each_seen_event([&](const topic_id& topic) {
+        auto doc_count = theta.counts(topic)
+                         - theta.prior().pseudo_counts(topic);
+        if (doc_count <= 0)
+            return;
+        auto weight = doc_count * beta_ / phi_[topic].counts();
+        doc_weights_.emplace_back(topic, weight);
+        doc_sum += weight;
+    });
+
+    word_weights_.clear();
+    double word_sum = 0;
+    for (const auto& count : word_topic_counts_[term])
+    {
+        auto doc_count = theta.counts(count.first)
+                         - theta.prior().pseudo_counts(count.first);
+        auto weight = (alpha_vec_[count.first] + doc_count) * count.second
+                      / phi_[count.first].counts();
+        word_weights_.emplace_back(count.first, weight);
+        word_sum += weight;
+    }
+
+    std::uniform_real_distribution<double> dist{
+        0, smoothing_sum_ + doc_sum + word_sum};
+    auto sample = dist(rng_);
+
+    if (sample < word_sum)
+    {
+        for (const auto& weight : word_weights_)
+            if ((sample -= weight.second) < 0)
+                return weight.first;
+        return word_weights_.back().first;
+    }
+    sample -= word_sum;
+
+    if (sample < doc_sum)
+    {
+        for (const auto& weight : doc_weights_)
+            if ((sample -= weight.second) < 0)
+                return weight.first;
+        return doc_weights_.back().first;
+    }
+    sample -= doc_sum;
+
+    // landing in the smoothing-only bucket is rare (its mass shrinks as
+    // counts accumulate), so the full scan over topics here does not
+    // affect the amortized per-token cost
+    for (topic_id topic{0}; topic < num_topics_; ++topic)
+        if ((sample -= alpha_vec_[topic] * beta_ / phi_[topic].counts()) < 0)
+            return topic;
+    return topic_id{num_topics_ - 1};
+}
+
+topic_id lda_gibbs::sample_topic_dense(term_id term, doc_id doc)
 {
     stats::multinomial<topic_id> full_conditional;
     for (topic_id topic{0}; topic < num_topics_; ++topic)
@@ -105,7 +302,100 @@ double lda_gibbs::compute_term_topic_probability(term_id term,
 double lda_gibbs::compute_doc_topic_probability(doc_id doc,
                                                 topic_id topic) const
 {
-    return theta_[doc].probability(topic);
+    // the theta_ priors hold the initial symmetric alpha, so recover
+    // the raw counts and apply the live (possibly optimized) alphas
+    const auto& theta = theta_[doc];
+    auto raw = theta.counts(topic) - theta.prior().pseudo_counts(topic);
+    auto raw_total = theta.counts() - theta.prior().pseudo_counts();
+    return (raw + alpha_vec_[topic]) / (raw_total + alpha_sum_);
+}
+
+double lda_gibbs::doc_topic_prior() const
+{
+    return alpha_sum_ / num_topics_;
+}
+
+void lda_gibbs::optimize_alpha_every(uint64_t period)
+{
+    optimize_alpha_period_ = period;
+}
+
+void lda_gibbs::optimize_alpha()
+{
+    // Minka's fixed-point update for an asymmetric \f$\mathbf{\alpha}\f$:
+    //
+    //   \alpha_t <- \alpha_t
+    //     \frac{\sum_d \Psi(n_{d,t} + \alpha_t) - D \Psi(\alpha_t)}
+    //          {\sum_d \Psi(n_d + \sum_k \alpha_k)
+    //           - D \Psi(\sum_k \alpha_k)},
+    //
+    // computed over count histograms. Since the topic counts are
+    // integers, every digamma difference collapses to the exact
+    // rational sum \sum_{i=0}^{n-1} 1 / (\alpha + i), so evaluating
+    // (or approximating) the digamma function is never necessary.
+    std::vector<uint64_t> length_hist;
+    std::vector<std::vector<uint64_t>> topic_hists(num_topics_);
+    for (doc_id doc{0}; doc < idx_->num_docs(); ++doc)
+    {
+        auto len = idx_->doc_size(doc);
+        if (len >= length_hist.size())
+            length_hist.resize(len + 1, 0);
+        ++length_hist[len];
+
+        const auto& theta = theta_[doc];
+        theta.each_seen_event([&](const topic_id& topic) {
+            auto raw = theta.counts(topic)
+                       - theta.prior().pseudo_counts(topic);
+            auto count = static_cast<uint64_t>(raw + 0.5);
+            if (count == 0)
+                return;
+            auto& hist = topic_hists[topic];
+            if (count >= hist.size())
+                hist.resize(count + 1, 0);
+            ++hist[count];
+        });
+    }
+
+    const uint64_t max_fixed_point_iters = 20;
+    for (uint64_t fp = 0; fp < max_fixed_point_iters; ++fp)
+    {
+        // shared denominator: number of documents longer than i tokens,
+        // summed against 1 / (\sum_k \alpha_k + i)
+        double denom = 0;
+        uint64_t docs_left = idx_->num_docs();
+        for (uint64_t i = 0; i + 1 < length_hist.size(); ++i)
+        {
+            docs_left -= length_hist[i];
+            denom += docs_left / (alpha_sum_ + i);
+        }
+
+        double diff = 0;
+        double new_sum = 0;
+        for (topic_id topic{0}; topic < num_topics_; ++topic)
+        {
+            const auto& hist = topic_hists[topic];
+            auto left = std::accumulate(hist.begin(), hist.end(),
+                                        uint64_t{0});
+            double numer = 0;
+            for (uint64_t i = 0; i + 1 < hist.size(); ++i)
+            {
+                left -= hist[i];
+                numer += left / (alpha_vec_[topic] + i);
+            }
+            // keep even a currently-empty topic samplable
+            auto updated
+                = std::max(alpha_vec_[topic] * numer / denom, 1e-8);
+            diff += std::fabs(updated - alpha_vec_[topic]);
+            alpha_vec_[topic] = updated;
+            new_sum += updated;
+        }
+        alpha_sum_ = new_sum;
+        if (diff < 1e-6 * alpha_sum_)
+            break;
+    }
+
+    // the smoothing-only bucket depends on alpha
+    refresh_smoothing_sum();
 }
 
 void lda_gibbs::initialize()
@@ -122,13 +412,20 @@ void lda_gibbs::perform_iteration(uint64_t iter, bool init /* = false */)
         str = "Iteration " + std::to_string(iter) + ": ";
     printing::progress progress{str, idx_->num_docs()};
     progress.print_endline(false);
+    // bound the drift accumulated by the incremental smoothing updates
+    refresh_smoothing_sum();
     for (const auto& i : idx_->docs())
     {
         progress(i);
         uint64_t n = 0; // term number within document---constructed
                         // so that each occurrence of the same term
                         // can still be assigned a different topic
-        for (const auto& freq : idx_->search_primary(i)->counts())
+
+        // stream the postings instead of materializing a postings_data
+        // per document: the decode is allocation-free, and it reads from
+        // the pinned in-memory copy when the file has been pinned
+        auto stream = idx_->stream_for(i);
+        for (const auto& freq : *stream)
         {
             for (uint64_t j = 0; j < freq.second; ++j)
             {
@@ -152,34 +449,44 @@ void lda_gibbs::perform_iteration(uint64_t iter, bool init /* = false */)
 
 void lda_gibbs::decrease_counts(topic_id topic, term_id term, doc_id doc)
 {
+    smoothing_sum_ -= alpha_vec_[topic] * beta_ / phi_[topic].counts();
     phi_[topic].decrement(term, 1);
     theta_[doc].decrement(topic, 1);
+    smoothing_sum_ += alpha_vec_[topic] * beta_ / phi_[topic].counts();
+
+    // remove this token's contribution to log P(W|Z): the lgamma terms
+    // it changed telescope down to a single log ratio
+    log_likelihood_
+        -= std::log(phi_[topic].counts(term)) - std::log(phi_[topic].counts());
+
+    auto& word_topics = word_topic_counts_[term];
+    auto it = std::lower_bound(
+        word_topics.begin(), word_topics.end(), topic,
+        [](const std::pair<topic_id, uint64_t>& count, topic_id tid) {
+            return count.first < tid;
+        });
+    if (--(it->second) == 0)
+        word_topics.erase(it);
 }
 
 void lda_gibbs::increase_counts(topic_id topic, term_id term, doc_id doc)
 {
+    // add this token's contribution to log P(W|Z) (evaluated against
+    // the counts *before* the increment)
+    log_likelihood_
+        += std::log(phi_[topic].counts(term)) - std::log(phi_[topic].counts());
+
+    smoothing_sum_ -= alpha_vec_[topic] * beta_ / phi_[topic].counts();
     phi_[topic].increment(term, 1);
     theta_[doc].increment(topic, 1);
+    smoothing_sum_ += alpha_vec_[topic] * beta_ / phi_[topic].counts();
+
+    word_topic_counts_[term][topic] += 1;
 }
 
 double lda_gibbs::corpus_log_likelihood() const
 {
-    auto tid0 = topic_id{0};
-    // V * \beta if symmetric, \sum_{r=1}^V \beta_r otherwise
-    auto total_pcs = phi_[tid0].prior().pseudo_counts();
-
-    double likelihood = num_topics_ * std::lgamma(total_pcs);
-
-    for (topic_id j{0}; j < num_topics_; ++j)
-    {
-        for (term_id t{0}; t < num_words_; ++t)
-        {
-            likelihood += std::lgamma(phi_[j].counts(t))
-                          - std::lgamma(phi_[j].prior().pseudo_counts(t));
-        }
-        likelihood -= std::lgamma(phi_[j].counts());
-    }
-    return likelihood;
+    return log_likelihood_;
 }
 }
 }
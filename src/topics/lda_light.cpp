@@ -0,0 +1,185 @@
+/**
+ * @file lda_light.cpp
+ * @author Chase Geigle
+ */
+
+#include "meta/index/postings_data.h"
+#include "meta/logging/logger.h"
+#include "meta/topics/lda_light.h"
+#include "meta/util/progress.h"
+
+namespace meta
+{
+namespace topics
+{
+
+void lda_light::resume(const std::string& filename)
+{
+    lda_gibbs::resume(filename);
+    proposals_.resize(idx_->unique_terms());
+}
+
+void lda_light::initialize()
+{
+    proposals_.resize(idx_->unique_terms());
+
+    printing::progress progress{"Initialization: ", idx_->num_docs()};
+    progress.print_endline(false);
+    std::uniform_int_distribution<uint64_t> dist{0, num_topics_ - 1};
+    for (const auto& i : idx_->docs())
+    {
+        progress(i);
+        uint64_t n = 0;
+        auto stream = idx_->stream_for(i);
+        for (const auto& freq : *stream)
+        {
+            for (uint64_t j = 0; j < freq.second; ++j)
+            {
+                topic_id topic{dist(rng_)};
+                doc_word_topic_[i][n] = topic;
+                increase_counts(topic, freq.first, i);
+                n += 1;
+            }
+        }
+    }
+}
+
+void lda_light::perform_iteration(uint64_t iter, bool /* init */)
+{
+    ++sweep_;
+    printing::progress progress{"Iteration " + std::to_string(iter) + ": ",
+                                idx_->num_docs()};
+    progress.print_endline(false);
+    for (const auto& i : idx_->docs())
+    {
+        progress(i);
+        uint64_t n = 0; // term number within document---constructed
+                        // so that each occurrence of the same term
+                        // can still be assigned a different topic
+        auto stream = idx_->stream_for(i);
+        for (const auto& freq : *stream)
+        {
+            for (uint64_t j = 0; j < freq.second; ++j)
+            {
+                auto old_topic = doc_word_topic_[i][n];
+                // don't include current topic assignment in
+                // probability calculation
+                decrease_counts(old_topic, freq.first, i);
+
+                // run the Metropolis-Hastings chain seeded with the
+                // old assignment
+                auto topic = sample_topic_light(freq.first, i, old_topic);
+                doc_word_topic_[i][n] = topic;
+
+                // increase counts
+                increase_counts(topic, freq.first, i);
+                n += 1;
+            }
+        }
+    }
+}
+
+topic_id lda_light::sample_topic_light(term_id term, doc_id doc,
+                                       topic_id old_topic)
+{
+    auto cur = old_topic;
+    const auto& assignments = doc_word_topic_[doc];
+    auto doc_len = static_cast<double>(assignments.size());
+    const auto& theta = theta_[doc];
+    std::uniform_real_distribution<double> unit{0, 1};
+
+    for (uint64_t step = 0; step < mh_steps_; ++step)
+    {
+        topic_id proposed;
+        double q_proposed;
+        double q_cur;
+        if (step % 2 == 0)
+        {
+            // doc proposal: draw a uniform token's assignment with
+            // probability n_d / (n_d + K * alpha), otherwise a uniform
+            // topic. The assignment array still contains old_topic at
+            // the slot being resampled (the counts do not), so the
+            // proposal density carries a +1 there.
+            std::uniform_real_distribution<double> dist{
+                0, doc_len + alpha_ * num_topics_};
+            auto draw = dist(rng_);
+            if (draw < doc_len)
+                proposed = assignments[static_cast<std::size_t>(draw)];
+            else
+                proposed = topic_id{std::min<uint64_t>(
+                    static_cast<uint64_t>((draw - doc_len) / alpha_),
+                    num_topics_ - 1)};
+
+            q_proposed = theta.counts(proposed)
+                         + (proposed == old_topic ? 1.0 : 0.0);
+            q_cur = theta.counts(cur) + (cur == old_topic ? 1.0 : 0.0);
+        }
+        else
+        {
+            // word proposal: mixture of the (possibly stale) alias
+            // table over the word's nonzero topic counts and a uniform
+            // smoothing component with mass K * beta. The acceptance
+            // ratio uses the same snapshot the table was built from, so
+            // staleness does not bias the chain.
+            const auto& prop = proposal(term);
+            auto smoothing = beta_ * num_topics_;
+            std::uniform_real_distribution<double> dist{0,
+                                                        prop.mass + smoothing};
+            auto draw = dist(rng_);
+            if (draw < smoothing)
+            {
+                std::uniform_int_distribution<uint64_t> topic_dist{
+                    0, num_topics_ - 1};
+                proposed = topic_id{topic_dist(rng_)};
+            }
+            else
+            {
+                proposed = prop.counts.contents()[prop.table(rng_)].first;
+            }
+
+            q_proposed = beta_ + prop.counts.at(proposed);
+            q_cur = beta_ + prop.counts.at(cur);
+        }
+
+        if (proposed == cur)
+            continue;
+
+        auto accept = full_conditional(term, doc, proposed) * q_cur
+                      / (full_conditional(term, doc, cur) * q_proposed);
+        if (accept >= 1.0 || unit(rng_) < accept)
+            cur = proposed;
+    }
+
+    return cur;
+}
+
+auto lda_light::proposal(term_id term) -> const word_proposal&
+{
+    auto& prop = proposals_[term];
+    if (prop.sweep != sweep_)
+    {
+        prop.counts = word_topic_counts_[term];
+        std::vector<double> weights;
+        weights.reserve(prop.counts.size());
+        prop.mass = 0;
+        for (const auto& count : prop.counts)
+        {
+            weights.push_back(static_cast<double>(count.second));
+            prop.mass += static_cast<double>(count.second);
+        }
+        prop.table = util::alias_table{weights};
+        prop.sweep = sweep_;
+    }
+    return prop;
+}
+
+double lda_light::full_conditional(term_id term, doc_id doc,
+                                   topic_id topic) const
+{
+    const auto& theta = theta_[doc];
+    auto doc_count = theta.counts(topic) - theta.prior().pseudo_counts(topic);
+    return (doc_count + alpha_vec_[topic]) * phi_[topic].counts(term)
+           / phi_[topic].counts();
+}
+}
+}
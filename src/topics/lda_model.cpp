@@ -3,7 +3,13 @@
  * @author Chase Geigle
  */
 
+#include <fstream>
+
+#include "meta/io/flat_file.h"
+#include "meta/io/packed.h"
+#include "meta/parallel/parallel_for.h"
 #include "meta/topics/lda_model.h"
+#include "meta/util/range.h"
 
 namespace meta
 {
@@ -70,12 +76,123 @@ void lda_model::save_topic_term_distributions(const std::string& filename) const
     }
 }
 
+void lda_model::save_doc_topic_distributions_binary(
+    const std::string& filename) const
+{
+    io::flat_file_writer file{filename};
+
+    uint64_t dims[] = {idx_->num_docs(), static_cast<uint64_t>(num_topics_)};
+    file.write_section("dims", util::array_view<const uint64_t>{dims, 2});
+
+    std::vector<double> theta;
+    theta.reserve(idx_->num_docs() * num_topics_);
+    for (const auto& d_id : idx_->docs())
+    {
+        for (topic_id j{0}; j < num_topics_; ++j)
+            theta.push_back(compute_doc_topic_probability(d_id, j));
+    }
+    file.write_section(
+        "theta", util::array_view<const double>{theta.data(), theta.size()});
+    file.close();
+}
+
+void lda_model::save_topic_term_distributions_binary(
+    const std::string& filename) const
+{
+    io::flat_file_writer file{filename};
+
+    uint64_t dims[] = {static_cast<uint64_t>(num_topics_),
+                       static_cast<uint64_t>(idx_->unique_terms())};
+    file.write_section("dims", util::array_view<const uint64_t>{dims, 2});
+
+    std::vector<double> phi;
+    phi.reserve(num_topics_ * idx_->unique_terms());
+    for (topic_id j{0}; j < num_topics_; ++j)
+    {
+        for (term_id t_id{0}; t_id < idx_->unique_terms(); ++t_id)
+            phi.push_back(compute_term_topic_probability(t_id, j));
+    }
+    file.write_section("phi",
+                       util::array_view<const double>{phi.data(), phi.size()});
+    file.close();
+}
+
 void lda_model::save(const std::string& prefix) const
 {
     save_doc_topic_distributions(prefix + ".theta");
     save_topic_term_distributions(prefix + ".phi");
 }
 
+std::vector<double> lda_model::infer(const learn::feature_vector& doc,
+                                     uint64_t n_iters) const
+{
+    auto alpha = doc_topic_prior();
+
+    // soft topic assignments for each distinct term, started uniform
+    std::vector<double> counts(num_topics_, 0.0);
+    std::vector<std::vector<double>> gammas;
+    gammas.reserve(doc.size());
+    double total_weight = 0;
+    for (const auto& weight : doc)
+    {
+        gammas.emplace_back(num_topics_, 1.0 / num_topics_);
+        for (std::size_t k = 0; k < num_topics_; ++k)
+            counts[k] += weight.second / num_topics_;
+        total_weight += weight.second;
+    }
+
+    std::vector<double> updated(num_topics_);
+    for (uint64_t iter = 0; iter < n_iters; ++iter)
+    {
+        std::size_t i = 0;
+        for (const auto& weight : doc)
+        {
+            term_id term{weight.first};
+            auto& gamma = gammas[i++];
+
+            // CVB0 update against the fixed topic-term distributions,
+            // excluding this term's own current assignment mass
+            double sum = 0;
+            for (topic_id k{0}; k < num_topics_; ++k)
+            {
+                auto excluded = counts[k] - weight.second * gamma[k];
+                updated[k] = compute_term_topic_probability(term, k)
+                             * (excluded + alpha);
+                sum += updated[k];
+            }
+            for (std::size_t k = 0; k < num_topics_; ++k)
+            {
+                updated[k] /= sum;
+                counts[k] += weight.second * (updated[k] - gamma[k]);
+                gamma[k] = updated[k];
+            }
+        }
+    }
+
+    std::vector<double> theta(num_topics_);
+    auto denom = total_weight + num_topics_ * alpha;
+    for (std::size_t k = 0; k < num_topics_; ++k)
+        theta[k] = (counts[k] + alpha) / denom;
+    return theta;
+}
+
+std::vector<std::vector<double>>
+lda_model::infer(const std::vector<learn::feature_vector>& docs,
+                 uint64_t n_iters, parallel::thread_pool& pool) const
+{
+    std::vector<std::vector<double>> results(docs.size());
+    if (docs.empty())
+        return results;
+
+    auto range = util::range<std::size_t>(0, docs.size() - 1);
+    parallel::parallel_for(range.begin(), range.end(), pool,
+                           [&](std::size_t i)
+                           {
+                               results[i] = infer(docs[i], n_iters);
+                           });
+    return results;
+}
+
 uint64_t lda_model::num_topics() const
 {
     return num_topics_;
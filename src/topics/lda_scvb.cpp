@@ -3,6 +3,8 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
+#include <numeric>
 #include <random>
 #include "meta/index/postings_data.h"
 #include "meta/topics/lda_scvb.h"
@@ -28,21 +30,162 @@ void lda_scvb::run(uint64_t num_iters, double)
 {
     std::mt19937 gen{std::random_device{}()};
     initialize(gen);
-    auto docs = idx_->docs();
+
+    // stream mini-batches in sequential disk order, wrapping around the
+    // corpus, and prefetch the next batch while processing the current
+    // one so the compute thread never waits on the index
+    doc_id cursor{0};
+    auto next = prefetch_pool_.submit_task(
+        [this, cursor]() { return load_minibatch(cursor); });
     for (uint64_t iter = 0; iter < num_iters; ++iter)
     {
-        std::shuffle(docs.begin(), docs.end(), gen);
-        perform_iteration(iter + 1, docs);
+        auto batch = next.get();
+        cursor = doc_id{(cursor + minibatch_size_) % idx_->num_docs()};
+        next = prefetch_pool_.submit_task(
+            [this, cursor]() { return load_minibatch(cursor); });
+        perform_iteration(iter + 1, batch);
+        if ((iter + 1) % rebucket_period_ == 0)
+            topic_term_count_.rebucket();
     }
+    next.wait();
+}
+
+const uint64_t lda_scvb::topic_term_storage::npos;
+
+lda_scvb::topic_term_storage::topic_term_storage(std::size_t num_topics,
+                                                 std::size_t num_words,
+                                                 std::size_t hot_size)
+    : hot_slot_(num_words, npos),
+      hot_words_(hot_size),
+      dense_(num_topics, std::vector<double>(hot_size, 0.0)),
+      sparse_(num_topics),
+      scale_(num_topics, 1.0)
+{
+    // seed the hot set with the first hot_size term ids; rebucket()
+    // replaces it with a mass-ranked set once counts exist
+    for (std::size_t h = 0; h < hot_size; ++h)
+    {
+        hot_words_[h] = term_id{h};
+        hot_slot_[h] = h;
+    }
+}
+
+double lda_scvb::topic_term_storage::get(topic_id topic, term_id term) const
+{
+    auto slot = hot_slot_[term];
+    auto raw = slot != npos ? dense_[topic][slot] : sparse_[topic].at(term);
+    return raw * scale_[topic];
+}
+
+void lda_scvb::topic_term_storage::set(topic_id topic, term_id term,
+                                       double value)
+{
+    auto raw = value / scale_[topic];
+    auto slot = hot_slot_[term];
+    if (slot != npos)
+        dense_[topic][slot] = raw;
+    else
+        sparse_[topic][term] = raw;
+}
+
+void lda_scvb::topic_term_storage::scale(topic_id topic, double factor)
+{
+    scale_[topic] *= factor;
+    // fold the multiplier back in before it underflows
+    if (scale_[topic] < 1e-100)
+        materialize(topic);
+}
+
+void lda_scvb::topic_term_storage::materialize(topic_id topic)
+{
+    auto factor = scale_[topic];
+    if (factor == 1.0)
+        return;
+    for (auto& value : dense_[topic])
+        value *= factor;
+    for (auto& entry : sparse_[topic])
+        entry.second *= factor;
+    scale_[topic] = 1.0;
+}
+
+void lda_scvb::topic_term_storage::rebucket()
+{
+    // total expected mass per term across all topics
+    std::vector<double> mass(hot_slot_.size(), 0.0);
+    for (std::size_t k = 0; k < dense_.size(); ++k)
+    {
+        topic_id topic{k};
+        materialize(topic);
+        for (std::size_t h = 0; h < hot_words_.size(); ++h)
+            mass[hot_words_[h]] += dense_[k][h];
+        for (const auto& entry : sparse_[k])
+            mass[entry.first] += entry.second;
+    }
+
+    // pick the heaviest words as the new hot set
+    std::vector<term_id> order(mass.size());
+    std::iota(order.begin(), order.end(), term_id{0});
+    auto hot_size = std::min(hot_words_.size(), order.size());
+    std::nth_element(order.begin(),
+                     order.begin() + static_cast<std::ptrdiff_t>(hot_size),
+                     order.end(), [&](term_id a, term_id b) {
+                         return mass[a] > mass[b];
+                     });
+
+    std::vector<uint64_t> new_slot(hot_slot_.size(), npos);
+    for (std::size_t h = 0; h < hot_size; ++h)
+        new_slot[order[h]] = h;
+
+    // migrate every nonzero entry into its new bucket
+    for (std::size_t k = 0; k < dense_.size(); ++k)
+    {
+        std::vector<double> new_dense(hot_words_.size(), 0.0);
+        std::vector<std::pair<term_id, double>> tail;
+        auto migrate = [&](term_id term, double value) {
+            if (value == 0.0)
+                return;
+            auto slot = new_slot[term];
+            if (slot != npos)
+                new_dense[slot] = value;
+            else
+                tail.emplace_back(term, value);
+        };
+        for (std::size_t h = 0; h < hot_words_.size(); ++h)
+            migrate(hot_words_[h], dense_[k][h]);
+        for (const auto& entry : sparse_[k])
+            migrate(entry.first, entry.second);
+
+        std::sort(tail.begin(), tail.end());
+        dense_[k] = std::move(new_dense);
+        sparse_[k].contents(std::move(tail));
+    }
+
+    hot_words_.assign(order.begin(),
+                      order.begin() + static_cast<std::ptrdiff_t>(hot_size));
+    hot_slot_ = std::move(new_slot);
+}
+
+auto lda_scvb::load_minibatch(doc_id start) const -> minibatch
+{
+    minibatch batch;
+    batch.docs.reserve(minibatch_size_);
+    for (uint64_t j = 0; j < minibatch_size_; ++j)
+    {
+        doc_id d{(start + j) % idx_->num_docs()};
+        auto stream = idx_->stream_for(d);
+        batch.docs.push_back(
+            {d, idx_->doc_size(d), {stream->begin(), stream->end()}});
+    }
+    return batch;
 }
 
 void lda_scvb::initialize(std::mt19937& rng)
 {
     // TODO: Don't actually iterate through whole dataset here
     doc_topic_count_.resize(idx_->num_docs());
-    topic_term_count_.resize(num_topics_);
-    for (auto& v : topic_term_count_)
-        v.resize(idx_->unique_terms());
+    topic_term_count_ = topic_term_storage{
+        num_topics_, idx_->unique_terms(),
+        std::min<std::size_t>(idx_->unique_terms(), 1ul << 16)};
     topic_count_.resize(num_topics_);
 
     printing::progress progress{" > Initialization: ", idx_->num_docs()};
@@ -52,7 +195,8 @@ void lda_scvb::initialize(std::mt19937& rng)
 
         doc_topic_count_[d].resize(num_topics_);
 
-        for (auto& freq : idx_->search_primary(d)->counts())
+        auto stream = idx_->stream_for(d);
+        for (const auto& freq : *stream)
         {
             double sum = 0;
             std::vector<double> gamma(num_topics_);
@@ -65,15 +209,19 @@ void lda_scvb::initialize(std::mt19937& rng)
             for (topic_id k{0}; k < num_topics_; ++k)
             {
                 gamma[k] = gamma[k] * freq.second / sum;
-                topic_term_count_[k][freq.first] += gamma[k];
+                topic_term_count_.set(k, freq.first,
+                                      topic_term_count_.get(k, freq.first)
+                                          + gamma[k]);
                 doc_topic_count_[d][k] += gamma[k];
                 topic_count_[k] += gamma[k];
             }
         }
     }
+    // rank the hot set from the freshly initialized masses
+    topic_term_count_.rebucket();
 }
 
-void lda_scvb::perform_iteration(uint64_t iter, const std::vector<doc_id>& docs)
+void lda_scvb::perform_iteration(uint64_t iter, const minibatch& batch)
 {
     printing::progress progress{"Minibatch " + std::to_string(iter) + ": ",
                                 minibatch_size_};
@@ -83,18 +231,19 @@ void lda_scvb::perform_iteration(uint64_t iter, const std::vector<doc_id>& docs)
     std::vector<double> batch_topic_count_(num_topics_, 0.0);
     std::vector<double> gamma(num_topics_);
 
-    for (uint64_t j = 0; j < minibatch_size_; ++j)
+    for (uint64_t j = 0; j < batch.docs.size(); ++j)
     {
         progress(j);
-        auto d = docs[j];
+        const auto& doc = batch.docs[j];
+        auto d = doc.id;
         // burn-in phase
         double t = 0;
-        for (const auto& freq : idx_->search_primary(d)->counts())
+        for (const auto& freq : doc.counts)
         {
             double sum = 0;
             for (topic_id k{0}; k < num_topics_; ++k)
             {
-                gamma[k] = (topic_term_count_[k][freq.first] + beta_)
+                gamma[k] = (topic_term_count_.get(k, freq.first) + beta_)
                            / (topic_count_[k] + num_words_ * beta_)
                            * (doc_topic_count_[d][k] + alpha_);
                 sum += gamma[k];
@@ -106,18 +255,18 @@ void lda_scvb::perform_iteration(uint64_t iter, const std::vector<doc_id>& docs)
                 auto weight = std::pow(1 - lr, freq.second);
                 doc_topic_count_[d][k]
                     = weight * doc_topic_count_[d][k]
-                      + (1 - weight) * idx_->doc_size(d) * gamma[k];
+                      + (1 - weight) * doc.size * gamma[k];
             }
             t += freq.second;
         }
 
         // normal phase
-        for (const auto& freq : idx_->search_primary(d)->counts())
+        for (const auto& freq : doc.counts)
         {
             double sum = 0;
             for (topic_id k{0}; k < num_topics_; ++k)
             {
-                gamma[k] = (topic_term_count_[k][freq.first] + beta_)
+                gamma[k] = (topic_term_count_.get(k, freq.first) + beta_)
                            / (topic_count_[k] + num_words_ * beta_)
                            * (doc_topic_count_[d][k] + alpha_);
                 sum += gamma[k];
@@ -133,7 +282,7 @@ void lda_scvb::perform_iteration(uint64_t iter, const std::vector<doc_id>& docs)
 
                 doc_topic_count_[d][k]
                     = weight * doc_topic_count_[d][k]
-                      + (1 - weight) * idx_->doc_size(d) * gamma[k];
+                      + (1 - weight) * doc.size * gamma[k];
 
                 batch_topic_term_count_[k][freq.first]
                     += idx_->num_docs() * gamma[k];
@@ -148,19 +297,15 @@ void lda_scvb::perform_iteration(uint64_t iter, const std::vector<doc_id>& docs)
     // compute the learning schedule
     auto lr = 10.0 / std::pow(1000 + iter * minibatch_size_, 0.9);
 
-    // TODO: better weight decay here? We can represent the vectors as the
-    // product of a scalar and a vector to efficiently scale by (1 - lr)
-    // when the batch count is 0, and we can cancel the factor out in the
-    // addition when it is nonzero. Not sure if this will help, but I think
-    // it may...
+    // the (1 - lr) decay of each row folds into its lazy scale factor,
+    // so only the terms actually touched by this minibatch need a write
     for (topic_id k{0}; k < num_topics_; ++k)
     {
-        for (term_id i{0}; i < num_words_; ++i)
-        {
-            topic_term_count_[k][i]
-                = (1 - lr) * topic_term_count_[k][i]
-                  + lr * (batch_topic_term_count_[k][i] / minibatch_size_);
-        }
+        topic_term_count_.scale(k, 1 - lr);
+        for (const auto& count : batch_topic_term_count_[k])
+            topic_term_count_.set(k, count.first,
+                                  topic_term_count_.get(k, count.first)
+                                      + lr * (count.second / minibatch_size_));
         topic_count_[k] = (1 - lr) * topic_count_[k]
                           + lr * (batch_topic_count_[k] / minibatch_size_);
     }
@@ -169,7 +314,7 @@ void lda_scvb::perform_iteration(uint64_t iter, const std::vector<doc_id>& docs)
 double lda_scvb::compute_term_topic_probability(term_id term,
                                                 topic_id topic) const
 {
-    return (topic_term_count_.at(topic).at(term) + beta_)
+    return (topic_term_count_.get(topic, term) + beta_)
            / (topic_count_.at(topic) + num_words_ * beta_);
 }
 
@@ -178,5 +323,10 @@ double lda_scvb::compute_doc_topic_probability(doc_id doc, topic_id topic) const
     return (doc_topic_count_.at(doc).at(topic) + alpha_)
            / (idx_->doc_size(doc) + num_topics_ * alpha_);
 }
+
+double lda_scvb::doc_topic_prior() const
+{
+    return alpha_;
+}
 }
 }
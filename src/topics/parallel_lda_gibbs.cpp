@@ -3,6 +3,9 @@
  * @author Chase Geigle
  */
 
+#include <atomic>
+#include <cmath>
+
 #include "meta/index/postings_data.h"
 #include "meta/logging/logger.h"
 #include "meta/parallel/parallel_for.h"
@@ -15,13 +18,29 @@ namespace meta
 namespace topics
 {
 
-void parallel_lda_gibbs::initialize()
+void parallel_lda_gibbs::init_thread_states()
 {
     for (auto& id : pool_.thread_ids())
-        phi_diffs_[id].resize(num_topics_);
+    {
+        auto& state = states_[id];
+        state.phi_diff.resize(num_topics_);
+        state.weights.resize(num_topics_);
+        state.rng.seed(rng_());
+    }
+}
+
+void parallel_lda_gibbs::initialize()
+{
+    init_thread_states();
     lda_gibbs::initialize();
 }
 
+void parallel_lda_gibbs::resume(const std::string& filename)
+{
+    init_thread_states();
+    lda_gibbs::resume(filename);
+}
+
 void parallel_lda_gibbs::perform_iteration(uint64_t iter,
                                            bool init /* = false */)
 {
@@ -36,22 +55,25 @@ void parallel_lda_gibbs::perform_iteration(uint64_t iter,
     auto range = util::range<doc_id>(doc_id{0}, doc_id{idx_->num_docs() - 1});
 
     // clear out diffs
-    for (auto& phis : phi_diffs_)
-        for (auto& phi : phis.second)
+    for (auto& state : states_)
+        for (auto& phi : state.second.phi_diff)
             phi.clear();
 
-    std::mutex mutex;
-    uint64_t assigned = 0;
+    std::atomic<uint64_t> assigned{0};
     parallel::parallel_for(range.begin(), range.end(), pool_, [&](doc_id i)
                            {
-        {
-            std::lock_guard<std::mutex> lock{mutex};
-            progress(assigned++);
-        }
+        progress(assigned++);
+
+        // everything below reads and writes only thread-local state,
+        // this document's theta, and the frozen global phi counts
+        auto& state = states_.at(std::this_thread::get_id());
+        auto& theta = theta_[i];
+
         size_t n = 0; // term number within document---constructed
                       // so that each occurrence of the same term
                       // can still be assigned a different topic
-        for (const auto& freq : idx_->search_primary(i)->counts())
+        auto stream = idx_->stream_for(i);
+        for (const auto& freq : *stream)
         {
             for (size_t j = 0; j < freq.second; ++j)
             {
@@ -59,52 +81,74 @@ void parallel_lda_gibbs::perform_iteration(uint64_t iter,
                 // don't include current topic assignment in
                 // probability calculation
                 if (!init)
-                    decrease_counts(old_topic, freq.first, i);
+                {
+                    state.phi_diff[old_topic].decrement(freq.first, 1);
+                    theta.decrement(old_topic, 1);
+                }
+
+                // compute the dense full conditional into the scratch
+                // buffer and sample from it directly
+                double total = 0;
+                for (topic_id topic{0}; topic < num_topics_; ++topic)
+                {
+                    const auto& diff = state.phi_diff[topic];
+                    // the per-token denominator of the theta term is
+                    // constant across topics, so the raw count plus the
+                    // live alpha suffices as the (unnormalized) weight
+                    auto doc_count
+                        = theta.counts(topic)
+                          - theta.prior().pseudo_counts(topic);
+                    auto weight = (phi_[topic].counts(freq.first)
+                                   + diff.counts(freq.first))
+                                  / (phi_[topic].counts() + diff.counts())
+                                  * (doc_count + alpha_vec_[topic]);
+                    state.weights[topic] = weight;
+                    total += weight;
+                }
+
+                std::uniform_real_distribution<double> dist{0, total};
+                auto draw = dist(state.rng);
+                topic_id topic{0};
+                for (; topic < num_topics_ - 1; ++topic)
+                {
+                    draw -= state.weights[topic];
+                    if (draw < 0)
+                        break;
+                }
 
-                // sample a new topic assignment
-                auto topic = sample_topic(freq.first, i);
                 doc_word_topic_[i][n] = topic;
 
                 // increase counts
-                increase_counts(topic, freq.first, i);
+                state.phi_diff[topic].increment(freq.first, 1);
+                theta.increment(topic, 1);
                 n += 1;
             }
         }
     });
 
     // reduce down the distribution diffs for phi into the global
-    // distributions for phi
-    for (const auto& phis_pair : phi_diffs_)
+    // distributions for phi, swapping out the lgamma terms each diff
+    // touches so the cached log likelihood stays current even though
+    // the thread-local updates bypassed {in,de}crease_counts()
+    for (const auto& state : states_)
     {
-        const auto& phis = phis_pair.second;
+        const auto& phis = state.second.phi_diff;
         for (topic_id topic{0}; topic < phis.size(); ++topic)
-            phi_[topic] += phis[topic];
-    }
-}
-
-void parallel_lda_gibbs::decrease_counts(topic_id topic, term_id term,
-                                         doc_id doc)
-{
-    auto tid = std::this_thread::get_id();
-    phi_diffs_[tid][topic].decrement(term, 1);
-    theta_[doc].decrement(topic, 1);
-}
+        {
+            auto& phi = phi_[topic];
+            phis[topic].each_seen_event([&](const term_id& term) {
+                log_likelihood_ -= std::lgamma(phi.counts(term));
+            });
+            log_likelihood_ += std::lgamma(phi.counts());
 
-void parallel_lda_gibbs::increase_counts(topic_id topic, term_id term,
-                                         doc_id doc)
-{
-    auto tid = std::this_thread::get_id();
-    phi_diffs_[tid][topic].increment(term, 1);
-    theta_[doc].increment(topic, 1);
-}
+            phi += phis[topic];
 
-double parallel_lda_gibbs::compute_sampling_weight(term_id term, doc_id doc,
-                                                   topic_id topic) const
-{
-    auto tid = std::this_thread::get_id();
-    return (phi_[topic].counts(term) + phi_diffs_.at(tid)[topic].counts(term))
-           / (phi_[topic].counts() + phi_diffs_.at(tid)[topic].counts())
-           * compute_doc_topic_probability(doc, topic);
+            phis[topic].each_seen_event([&](const term_id& term) {
+                log_likelihood_ += std::lgamma(phi.counts(term));
+            });
+            log_likelihood_ -= std::lgamma(phi.counts());
+        }
+    }
 }
 }
 }
@@ -0,0 +1,343 @@
+/**
+ * @file bench_topics.cpp
+ * @author Chase Geigle
+ *
+ * Benchmark and quality harness for the topic model implementations.
+ * Generates a synthetic corpus with planted topic structure, trains each
+ * sampler on it for a fixed number of iterations, and reports sampling
+ * throughput, per-iteration wall time, peak RSS, and held-out perplexity
+ * as a single JSON object on stdout so results can be tracked release
+ * over release. The corpus is generated from fixed seeds, so regressions
+ * in either speed or model quality show up as plain numeric diffs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "cpptoml.h"
+#include "meta/caching/no_evict_cache.h"
+#include "meta/index/forward_index.h"
+#include "meta/index/make_index.h"
+#include "meta/io/filesystem.h"
+#include "meta/learn/instance.h"
+#include "meta/logging/logger.h"
+#include "meta/topics/lda_cvb.h"
+#include "meta/topics/lda_gibbs.h"
+#include "meta/topics/lda_light.h"
+#include "meta/topics/lda_scvb.h"
+#include "meta/topics/parallel_lda_gibbs.h"
+
+using namespace meta;
+
+namespace
+{
+
+/**
+ * The planted generative model: each true topic is a Zipfian
+ * distribution over its own slice of the vocabulary, and each document
+ * draws its topic proportions from a symmetric Dirichlet.
+ */
+class corpus_generator
+{
+  public:
+    corpus_generator(uint64_t num_topics, uint64_t words_per_topic,
+                     double skew = 1.0)
+        : num_topics_{num_topics}
+    {
+        cdf_.reserve(words_per_topic);
+        double total = 0.0;
+        for (uint64_t rank = 1; rank <= words_per_topic; ++rank)
+        {
+            total += 1.0 / std::pow(static_cast<double>(rank), skew);
+            cdf_.push_back(total);
+        }
+    }
+
+    std::vector<std::string> make_doc(uint64_t seed, uint64_t length) const
+    {
+        std::mt19937_64 rng{seed};
+
+        // symmetric Dirichlet(0.1) topic proportions via gamma draws
+        std::gamma_distribution<double> gamma{0.1, 1.0};
+        std::vector<double> props(num_topics_);
+        double prop_total = 0;
+        for (auto& p : props)
+        {
+            p = gamma(rng);
+            prop_total += p;
+        }
+
+        std::vector<std::string> words;
+        words.reserve(length);
+        std::uniform_real_distribution<double> unif{0.0, prop_total};
+        std::uniform_real_distribution<double> word_dist{0.0, cdf_.back()};
+        for (uint64_t i = 0; i < length; ++i)
+        {
+            auto draw = unif(rng);
+            uint64_t topic = 0;
+            for (; topic + 1 < num_topics_; ++topic)
+            {
+                draw -= props[topic];
+                if (draw < 0)
+                    break;
+            }
+
+            auto it = std::upper_bound(cdf_.begin(), cdf_.end(),
+                                       word_dist(rng));
+            auto rank = static_cast<uint64_t>(
+                std::distance(cdf_.begin(), it));
+            words.emplace_back("w" + std::to_string(topic) + "-"
+                               + std::to_string(rank));
+        }
+        return words;
+    }
+
+  private:
+    uint64_t num_topics_;
+    std::vector<double> cdf_;
+};
+
+/**
+ * @return the peak resident set size of this process in kilobytes, or 0
+ * if the platform provides no way to query it
+ */
+uint64_t peak_rss_kb()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+    return 0;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+/**
+ * Computes held-out perplexity: the topic proportions for each held-out
+ * document are inferred with the fixed-model CVB0 path, and the
+ * per-token log likelihood is evaluated against the trained topic-term
+ * distributions.
+ */
+double heldout_perplexity(const topics::lda_model& model,
+                          const std::vector<learn::feature_vector>& docs)
+{
+    double log_likelihood = 0;
+    double tokens = 0;
+    for (const auto& doc : docs)
+    {
+        auto theta = model.infer(doc, 20);
+        for (const auto& weight : doc)
+        {
+            term_id term{weight.first};
+            double word_prob = 0;
+            for (topic_id topic{0}; topic < model.num_topics(); ++topic)
+                word_prob += theta[topic]
+                             * model.compute_term_topic_probability(term,
+                                                                    topic);
+            log_likelihood += weight.second * std::log(word_prob);
+            tokens += weight.second;
+        }
+    }
+    return std::exp(-log_likelihood / tokens);
+}
+
+struct bench_result
+{
+    std::string name;
+    double seconds;
+    double perplexity;
+    uint64_t rss_kb;
+};
+
+template <class Model, class Index>
+bench_result bench(const std::string& name, Index& idx, uint64_t iters,
+                   std::size_t topics, double alpha, double beta,
+                   uint64_t train_tokens,
+                   const std::vector<learn::feature_vector>& heldout)
+{
+    std::cerr << "Benchmarking " << name << "..." << std::endl;
+    Model model{idx, topics, alpha, beta};
+    auto start = std::chrono::steady_clock::now();
+    // convergence 0 disables early stopping so every run times the same
+    // number of sweeps
+    model.run(iters, 0);
+    bench_result res;
+    res.name = name;
+    res.seconds = seconds_since(start);
+    res.perplexity = heldout_perplexity(model, heldout);
+    res.rss_kb = peak_rss_kb();
+
+    auto tokens_per_sec = train_tokens * iters / res.seconds;
+    std::cerr << name << ": " << res.seconds << "s, " << tokens_per_sec
+              << " tokens/sec, held-out perplexity " << res.perplexity
+              << std::endl;
+    return res;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t num_docs = 2000;
+    uint64_t heldout_docs = 200;
+    uint64_t doc_length = 150;
+    uint64_t num_true_topics = 10;
+    uint64_t words_per_topic = 2000;
+    uint64_t num_topics = 10;
+    uint64_t iters = 50;
+
+    if (argc > 1 && std::string{argv[1]} == "--help")
+    {
+        std::cerr << "Usage:\t" << argv[0]
+                  << " [num-docs] [doc-length] [topics] [iters]" << std::endl;
+        return 1;
+    }
+
+    if (argc > 1)
+        num_docs = std::stoull(argv[1]);
+    if (argc > 2)
+        doc_length = std::stoull(argv[2]);
+    if (argc > 3)
+        num_topics = std::stoull(argv[3]);
+    if (argc > 4)
+        iters = std::stoull(argv[4]);
+
+    logging::set_cerr_logging();
+
+    const std::string scratch = "bench-topics-scratch";
+    filesystem::remove_all(scratch);
+    if (!filesystem::make_directories(scratch + "/bench"))
+    {
+        std::cerr << "Unable to create scratch directory: " << scratch
+                  << std::endl;
+        return 1;
+    }
+
+    corpus_generator gen{num_true_topics, words_per_topic};
+
+    // write the training documents to disk as a line_corpus
+    {
+        std::ofstream corpus_file{scratch + "/bench/bench.dat"};
+        for (uint64_t d = 0; d < num_docs; ++d)
+        {
+            for (const auto& word : gen.make_doc(d, doc_length))
+                corpus_file << word << ' ';
+            corpus_file << '\n';
+        }
+    }
+    {
+        std::ofstream corpus_config{scratch + "/bench/line.toml"};
+        corpus_config << "type = \"line-corpus\"\n";
+    }
+    // an empty stopword list keeps the default chain self-contained
+    {
+        std::ofstream stopwords{scratch + "/stopwords.txt"};
+    }
+
+    auto config = cpptoml::make_table();
+    config->insert("prefix", scratch);
+    config->insert("dataset", std::string{"bench"});
+    config->insert("corpus", std::string{"line.toml"});
+    config->insert("index", scratch + "/bench-idx");
+    config->insert("stop-words", scratch + "/stopwords.txt");
+    auto ana = cpptoml::make_table();
+    ana->insert("method", std::string{"ngram-word"});
+    ana->insert("ngram", static_cast<int64_t>(1));
+    ana->insert("filter", std::string{"default-unigram-chain"});
+    auto ana_arr = cpptoml::make_table_array();
+    ana_arr->push_back(ana);
+    config->insert("analyzers", ana_arr);
+
+    auto f_idx
+        = index::make_index<index::forward_index, caching::no_evict_cache>(
+            *config);
+
+    uint64_t train_tokens = 0;
+    for (doc_id d{0}; d < f_idx->num_docs(); ++d)
+        train_tokens += f_idx->doc_size(d);
+
+    // held-out documents are drawn from the same generative model but
+    // never indexed; terms outside the training vocabulary are dropped
+    std::vector<learn::feature_vector> heldout;
+    heldout.reserve(heldout_docs);
+    for (uint64_t d = 0; d < heldout_docs; ++d)
+    {
+        learn::feature_vector fv;
+        for (const auto& word : gen.make_doc(num_docs + d, doc_length))
+        {
+            auto tid = f_idx->get_term_id(word);
+            if (tid < f_idx->unique_terms())
+                fv[learn::feature_id{tid}] += 1;
+        }
+        heldout.emplace_back(std::move(fv));
+    }
+
+    double alpha = 0.1;
+    double beta = 0.1;
+
+    std::vector<bench_result> results;
+    results.push_back(bench<topics::lda_gibbs>("gibbs", f_idx, iters,
+                                               num_topics, alpha, beta,
+                                               train_tokens, heldout));
+    results.push_back(bench<topics::parallel_lda_gibbs>(
+        "pargibbs", f_idx, iters, num_topics, alpha, beta, train_tokens,
+        heldout));
+    results.push_back(bench<topics::lda_light>("lightlda", f_idx, iters,
+                                               num_topics, alpha, beta,
+                                               train_tokens, heldout));
+    results.push_back(bench<topics::lda_cvb>("cvb", f_idx, iters, num_topics,
+                                             alpha, beta, train_tokens,
+                                             heldout));
+    results.push_back(bench<topics::lda_scvb>("scvb", f_idx, iters,
+                                              num_topics, alpha, beta,
+                                              train_tokens, heldout));
+
+    std::cout << "{\n"
+              << "  \"config\": {\n"
+              << "    \"num_docs\": " << num_docs << ",\n"
+              << "    \"heldout_docs\": " << heldout_docs << ",\n"
+              << "    \"doc_length\": " << doc_length << ",\n"
+              << "    \"true_topics\": " << num_true_topics << ",\n"
+              << "    \"topics\": " << num_topics << ",\n"
+              << "    \"iters\": " << iters << ",\n"
+              << "    \"train_tokens\": " << train_tokens << "\n"
+              << "  },\n"
+              << "  \"models\": {\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& res = results[i];
+        std::cout << "    \"" << res.name << "\": {\n"
+                  << "      \"seconds\": " << res.seconds << ",\n"
+                  << "      \"seconds_per_iter\": " << res.seconds / iters
+                  << ",\n"
+                  << "      \"tokens_per_sec\": "
+                  << train_tokens * iters / res.seconds << ",\n"
+                  << "      \"heldout_perplexity\": " << res.perplexity
+                  << ",\n"
+                  << "      \"peak_rss_kb\": " << res.rss_kb << "\n"
+                  << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  },\n"
+              << "  \"peak_rss_kb\": " << peak_rss_kb() << "\n"
+              << "}" << std::endl;
+
+    f_idx = nullptr;
+    filesystem::remove_all(scratch);
+
+    return 0;
+}
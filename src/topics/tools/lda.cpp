@@ -4,6 +4,7 @@
 
 #include "meta/topics/lda_cvb.h"
 #include "meta/topics/lda_gibbs.h"
+#include "meta/topics/lda_light.h"
 #include "meta/topics/lda_scvb.h"
 #include "meta/topics/parallel_lda_gibbs.h"
 
@@ -69,6 +70,16 @@ int run_lda(const std::string& config_file)
     auto f_idx
         = index::make_index<index::forward_index, caching::no_evict_cache>(
             *config);
+
+    // every inference method sweeps the full postings file once per
+    // iteration, so keep the compressed postings resident in memory when
+    // they fit the budget (in MB, like indexer-ram-budget)
+    auto ram_budget = lda_group->get_as<uint64_t>("ram-budget").value_or(1024);
+    if (f_idx->pin_postings(ram_budget * 1024 * 1024))
+        std::cout << "Pinned compressed postings in memory" << std::endl;
+    else
+        f_idx->advise_sequential();
+
     if (type == "gibbs")
     {
         std::cout << "Beginning LDA using serial Gibbs sampling..."
@@ -83,6 +94,14 @@ int run_lda(const std::string& config_file)
         return run_lda<parallel_lda_gibbs>(f_idx, iters, topics, alpha, beta,
                                            save_prefix);
     }
+    else if (type == "lightlda")
+    {
+        std::cout << "Beginning LDA using alias-table Metropolis-Hastings "
+                     "sampling..."
+                  << std::endl;
+        return run_lda<lda_light>(f_idx, iters, topics, alpha, beta,
+                                  save_prefix);
+    }
     else if (type == "cvb")
     {
         std::cout << "Beginning LDA using serial collapsed variational bayes..."
@@ -97,7 +116,7 @@ int run_lda(const std::string& config_file)
         return run_lda<lda_scvb>(f_idx, iters, topics, alpha, beta,
                                  save_prefix);
     }
-    std::cout << "Incorrect method selected: must be gibbs, pargibbs, or cvb"
+    std::cout << "Incorrect method selected: must be gibbs, pargibbs, lightlda, cvb, or scvb"
               << std::endl;
     return 1;
 }
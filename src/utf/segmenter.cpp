@@ -5,6 +5,8 @@
 
 #include <unicode/brkiter.h>
 
+#include <unordered_map>
+
 #include "detail.h"
 #include "meta/utf/segmenter.h"
 #include "meta/util/pimpl.tcc"
@@ -14,6 +16,43 @@ namespace meta
 namespace utf
 {
 
+namespace
+{
+/**
+ * Obtains a break iterator for the given locale by cloning a cached,
+ * thread-local master instance. Creating a break iterator from scratch
+ * parses its break rules, which is far more expensive than clone();
+ * caching the masters per thread means that segmenter copies (e.g. one
+ * per indexing thread) only pay that cost once per locale.
+ *
+ * @param locale The locale to create the break iterator for
+ * @param sentences Whether to return a sentence (vs. word) iterator
+ * @return a cloned break iterator owned by the caller
+ */
+std::unique_ptr<icu::BreakIterator> make_break_iterator(
+    const icu::Locale& locale, bool sentences)
+{
+    thread_local std::unordered_map<std::string,
+                                    std::unique_ptr<icu::BreakIterator>>
+        masters;
+
+    auto key = std::string{locale.getName()} + (sentences ? "|s" : "|w");
+    auto it = masters.find(key);
+    if (it == masters.end())
+    {
+        auto status = U_ZERO_ERROR;
+        std::unique_ptr<icu::BreakIterator> master{
+            sentences
+                ? icu::BreakIterator::createSentenceInstance(locale, status)
+                : icu::BreakIterator::createWordInstance(locale, status)};
+        if (!U_SUCCESS(status))
+            throw std::runtime_error{"failed to create segmenter"};
+        it = masters.emplace(std::move(key), std::move(master)).first;
+    }
+    return std::unique_ptr<icu::BreakIterator>{it->second->clone()};
+}
+}
+
 /**
  * Implementation class for the segmenter.
  */
@@ -25,14 +64,9 @@ class segmenter::impl
      */
     impl()
     {
-        auto status = U_ZERO_ERROR;
         const auto& locale = icu::Locale::getUS();
-        sentence_iter_.reset(
-            icu::BreakIterator::createSentenceInstance(locale, status));
-        word_iter_.reset(
-            icu::BreakIterator::createWordInstance(locale, status));
-        if (!U_SUCCESS(status))
-            throw std::runtime_error{"failed to create segmenter"};
+        sentence_iter_ = make_break_iterator(locale, true);
+        word_iter_ = make_break_iterator(locale, false);
     }
 
     /**
@@ -46,13 +80,8 @@ class segmenter::impl
         if (locale.isBogus())
             throw std::runtime_error{"failed to create locale"};
 
-        auto status = U_ZERO_ERROR;
-        sentence_iter_.reset(
-            icu::BreakIterator::createSentenceInstance(locale, status));
-        word_iter_.reset(
-            icu::BreakIterator::createWordInstance(locale, status));
-        if (!U_SUCCESS(status))
-            throw std::runtime_error{"failed to create segmenter"};
+        sentence_iter_ = make_break_iterator(locale, true);
+        word_iter_ = make_break_iterator(locale, false);
     }
 
     /**
@@ -152,10 +181,58 @@ class segmenter::impl
             throw std::runtime_error{err};
         }
 
-        iter->setText(&utxt, status);
+        collect(iter, &utxt, first, results);
+        utext_close(&utxt);
+        return results;
+    }
+
+    /**
+     * Obtains both the sentence and the word boundaries of the entire
+     * content, opening the ICU text buffer only once and running each
+     * break iterator over it in turn.
+     *
+     * @param sentences Filled with the sentence segments
+     * @param words Filled with the word segments
+     */
+    void bulk_segment(std::vector<segment>& sentences,
+                      std::vector<segment>& words) const
+    {
+        sentences.clear();
+        words.clear();
+
+        auto status = U_ZERO_ERROR;
+        UText utxt = UTEXT_INITIALIZER;
+        utext_openUTF8(&utxt, text_.data(),
+                       static_cast<int32_t>(text_.length()), &status);
         if (!U_SUCCESS(status))
         {
-            utext_close(&utxt);
+            std::string err = "Failed to open UText: ";
+            err += u_errorName(status);
+            throw std::runtime_error{err};
+        }
+
+        collect(sentence_iter_.get(), &utxt, 0, sentences);
+        collect(word_iter_.get(), &utxt, 0, words);
+        utext_close(&utxt);
+    }
+
+    /**
+     * Runs a break iterator over an already-opened text buffer and
+     * appends the resulting segments, shifted by the given offset.
+     *
+     * @param iter The break iterator to run
+     * @param utxt The opened text buffer to iterate over
+     * @param offset The offset of the buffer within the full content
+     * @param results The vector to append the segments to
+     */
+    void collect(icu::BreakIterator* iter, UText* utxt, int32_t offset,
+                 std::vector<segment>& results) const
+    {
+        auto status = U_ZERO_ERROR;
+        iter->setText(utxt, status);
+        if (!U_SUCCESS(status))
+        {
+            utext_close(utxt);
             std::string err = "Failed to setText: ";
             err += u_errorName(status);
             throw std::runtime_error{err};
@@ -165,12 +242,10 @@ class segmenter::impl
         auto end = iter->next();
         while (end != icu::BreakIterator::DONE)
         {
-            results.emplace_back(first + start, first + end);
+            results.emplace_back(offset + start, offset + end);
             start = end;
             end = iter->next();
         }
-        utext_close(&utxt);
-        return results;
     }
 
   private:
@@ -221,6 +296,12 @@ auto segmenter::words(const segment& seg) const -> std::vector<segment>
     return impl_->segments(seg.begin_, seg.end_, impl::segment_t::WORDS);
 }
 
+void segmenter::bulk_segment(std::vector<segment>& sentences,
+                             std::vector<segment>& words) const
+{
+    impl_->bulk_segment(sentences, words);
+}
+
 util::string_view segmenter::content(const segment& seg) const
 {
     return impl_->substr(seg.begin_, seg.end_);
@@ -16,6 +16,10 @@
 #include "meta/util/pimpl.tcc"
 #include "meta/utf/utf.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace meta
 {
 namespace utf
@@ -82,29 +86,115 @@ std::u16string to_utf16(const std::string& str)
     return icu_to_u16str(icu_str);
 }
 
+namespace
+{
+/**
+ * Case transform with an ASCII fast path. ASCII runs are flipped
+ * bytewise (sixteen bytes at a time with SSE2 where available) without
+ * ever decoding a codepoint, so mostly-ASCII text stays in UTF-8 and
+ * pays no per-codepoint work; only non-ASCII codepoints fall back to
+ * the ICU per-codepoint function. For ASCII, flipping bit 0x20 on the
+ * letter range agrees with u_tolower/u_toupper/u_foldCase exactly.
+ */
+template <class CodepointFunction>
+std::string case_transform(const std::string& str, bool upper,
+                           CodepointFunction&& fun)
+{
+    std::string result;
+    result.reserve(str.size());
+
+    const char* s = str.c_str();
+    auto length = static_cast<int32_t>(str.length());
+    int32_t i = 0;
+    while (i < length)
+    {
+#if defined(__SSE2__)
+        // full chunks with no high bit set: branch-free case flip
+        while (i + 16 <= length)
+        {
+            auto chunk = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(s + i));
+            if (_mm_movemask_epi8(chunk) != 0)
+                break;
+
+            __m128i mask;
+            if (upper)
+            {
+                mask = _mm_and_si128(
+                    _mm_cmpgt_epi8(chunk, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(chunk, _mm_set1_epi8('z' + 1)));
+                chunk = _mm_andnot_si128(
+                    _mm_and_si128(mask, _mm_set1_epi8(0x20)), chunk);
+            }
+            else
+            {
+                mask = _mm_and_si128(
+                    _mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)),
+                    _mm_cmplt_epi8(chunk, _mm_set1_epi8('Z' + 1)));
+                chunk = _mm_or_si128(
+                    chunk, _mm_and_si128(mask, _mm_set1_epi8(0x20)));
+            }
+
+            char buf[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(buf), chunk);
+            result.append(buf, 16);
+            i += 16;
+        }
+#endif
+        // scalar ASCII bytes: the partial tail chunk, or the bytes in
+        // front of a non-ASCII byte
+        auto scalar_end = std::min(length, i + 16);
+        while (i < scalar_end
+               && static_cast<unsigned char>(s[i]) < 0x80)
+        {
+            char c = s[i++];
+            if (upper)
+            {
+                if (c >= 'a' && c <= 'z')
+                    c = static_cast<char>(c & ~0x20);
+            }
+            else
+            {
+                if (c >= 'A' && c <= 'Z')
+                    c = static_cast<char>(c | 0x20);
+            }
+            result += c;
+        }
+
+        if (i < length && static_cast<unsigned char>(s[i]) >= 0x80)
+        {
+            auto codepoint = detail::utf8_next_codepoint(s, i, length);
+            detail::utf8_append_codepoint(
+                result, fun(static_cast<uint32_t>(codepoint)));
+        }
+    }
+    return result;
+}
+}
+
 std::string tolower(const std::string& str)
 {
-    return transform(str, [](uint32_t cp)
-                     {
-                         return u_tolower(static_cast<UChar32>(cp));
-                     });
+    return case_transform(str, false, [](uint32_t cp)
+                          {
+                              return u_tolower(static_cast<UChar32>(cp));
+                          });
 }
 
 std::string toupper(const std::string& str)
 {
-    return transform(str, [](uint32_t cp)
-                     {
-                         return u_toupper(static_cast<UChar32>(cp));
-                     });
+    return case_transform(str, true, [](uint32_t cp)
+                          {
+                              return u_toupper(static_cast<UChar32>(cp));
+                          });
 }
 
 std::string foldcase(const std::string& str)
 {
-    return transform(str, [](uint32_t cp)
-                     {
-                         return u_foldCase(static_cast<UChar32>(cp),
-                                           U_FOLD_CASE_DEFAULT);
-                     });
+    return case_transform(str, false, [](uint32_t cp)
+                          {
+                              return u_foldCase(static_cast<UChar32>(cp),
+                                                U_FOLD_CASE_DEFAULT);
+                          });
 }
 
 bool isalpha(uint32_t codepoint)
@@ -0,0 +1,96 @@
+/**
+ * @file memory_accounting.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <ostream>
+
+#include "meta/util/memory_accounting.h"
+#include "meta/util/printing.h"
+
+namespace meta
+{
+namespace memory
+{
+
+namespace
+{
+/**
+ * The process-wide name -> account table. Accounts are never destroyed,
+ * so references handed out by component() stay valid forever.
+ */
+class registry
+{
+  public:
+    static registry& get()
+    {
+        static registry instance;
+        return instance;
+    }
+
+    account& component(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        auto it = accounts_.find(name);
+        if (it == accounts_.end())
+        {
+            it = accounts_
+                     .emplace(name, std::unique_ptr<account>{
+                                        new account{name}})
+                     .first;
+        }
+        return *it->second;
+    }
+
+    std::vector<report_entry> report() const
+    {
+        std::vector<report_entry> entries;
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            entries.reserve(accounts_.size());
+            for (const auto& acct : accounts_)
+                entries.push_back(
+                    {acct.first, acct.second->live(), acct.second->peak()});
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const report_entry& a, const report_entry& b) {
+                      return a.live > b.live;
+                  });
+        return entries;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<account>> accounts_;
+};
+}
+
+account& component(const std::string& name)
+{
+    return registry::get().component(name);
+}
+
+std::vector<report_entry> memory_report()
+{
+    return registry::get().report();
+}
+
+void memory_report(std::ostream& os)
+{
+    auto entries = memory_report();
+    if (entries.empty())
+        return;
+
+    os << "memory accounts (live/peak):\n";
+    for (const auto& entry : entries)
+    {
+        os << "  " << entry.name << ": "
+           << printing::bytes_to_units(entry.live) << " / "
+           << printing::bytes_to_units(entry.peak) << "\n";
+    }
+}
+}
+}
@@ -0,0 +1,155 @@
+/**
+ * @file profile.cpp
+ * @author Chase Geigle
+ */
+
+#include "meta/util/profile.h"
+
+#if META_PROFILE_HOOKS
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace meta
+{
+namespace profile
+{
+
+namespace
+{
+
+/**
+ * The process-wide list of instrumentation sites. Sites are
+ * function-local statics that are never destroyed, so the registry holds
+ * raw pointers.
+ */
+class registry
+{
+  public:
+    static registry& get()
+    {
+        static registry instance;
+        return instance;
+    }
+
+    void add(counter* c)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        counters_.push_back(c);
+    }
+
+    void add(timer_site* site)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        timers_.push_back(site);
+    }
+
+    std::vector<counter*> counters() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return counters_;
+    }
+
+    std::vector<timer_site*> timers() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return timers_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::vector<counter*> counters_;
+    std::vector<timer_site*> timers_;
+};
+
+/**
+ * @return the calibrated rate of cycle_count() against the steady
+ * clock, measured once on first use
+ */
+double cycles_per_second()
+{
+    static const double rate = []() {
+        auto wall_start = std::chrono::steady_clock::now();
+        auto cycle_start = cycle_count();
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        auto cycles = cycle_count() - cycle_start;
+        auto wall = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - wall_start)
+                        .count();
+        return static_cast<double>(cycles) / wall;
+    }();
+    return rate;
+}
+}
+
+counter::counter(const char* name) : name_{name}
+{
+    registry::get().add(this);
+}
+
+timer_site::timer_site(const char* name) : name_{name}
+{
+    registry::get().add(this);
+}
+
+void report(std::ostream& os)
+{
+    const auto& reg = registry::get();
+
+    // a site instantiated in more than one translation unit (e.g. from
+    // a template) appears once per instantiation; merge by name
+    std::map<std::string, uint64_t> counts;
+    for (const auto* c : reg.counters())
+        counts[c->name()] += c->value();
+
+    struct timing
+    {
+        stats::dd_sketch sketch{0.01};
+        double sum = 0;
+        std::size_t samples = 0;
+    };
+    std::map<std::string, timing> timings;
+    for (const auto* site : reg.timers())
+    {
+        auto& t = timings[site->name()];
+        t.sketch.merge(site->sketch());
+        auto moments = site->moments();
+        t.sum += moments.mean() * static_cast<double>(moments.size());
+        t.samples += moments.size();
+    }
+
+    if (counts.empty() && timings.empty())
+        return;
+
+    auto to_usecs = [](double cycles) {
+        return cycles / cycles_per_second() * 1e6;
+    };
+
+    os << "profile counters:\n";
+    for (const auto& count : counts)
+        os << "  " << count.first << ": " << count.second << "\n";
+
+    os << "profile timers (sampled 1/" << sample_period << ", usecs):\n";
+    for (const auto& t : timings)
+    {
+        const auto& timing = t.second;
+        if (timing.samples == 0)
+            continue;
+        os << "  " << t.first << ": samples=" << timing.samples
+           << std::fixed << std::setprecision(1)
+           << " mean=" << to_usecs(timing.sum
+                                   / static_cast<double>(timing.samples))
+           << " p50=" << to_usecs(timing.sketch.quantile(0.5))
+           << " p99=" << to_usecs(timing.sketch.quantile(0.99))
+           << " p99.9=" << to_usecs(timing.sketch.quantile(0.999)) << "\n";
+        os.unsetf(std::ios_base::floatfield);
+    }
+}
+}
+}
+
+#endif
@@ -3,14 +3,12 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <thread>
-#include <algorithm>
-#include <iomanip>
-#include <sstream>
+#include <vector>
 #include "meta/logging/logger.h"
-#include "meta/util/printing.h"
 #include "meta/util/progress.h"
 
 namespace meta
@@ -18,67 +16,135 @@ namespace meta
 namespace printing
 {
 
-progress::progress(const std::string& prefix, uint64_t length, int interval)
-    : prefix_len_{prefix.length()},
-      start_{std::chrono::steady_clock::now()},
-      iter_{0},
-      length_{length},
-      interval_{interval},
-      endline_{true}
+/**
+ * Process-wide registry of the active progress bars. Bars register on
+ * construction and deregister when they finish; a single reporter thread
+ * samples the innermost (most recently registered) bar's atomic counter
+ * and redraws its line, so nested bars take turns on the terminal
+ * instead of interleaving. The reporter is started when the first bar
+ * registers and joined when the last one finishes.
+ */
+class progress_registry
 {
-    output_.resize(80, ' ');
-    assert(prefix_len_ < 80 - 20);
-    std::copy(prefix.begin(), prefix.end(), output_.begin());
-    output_[prefix_len_] = '[';
-
-    thread_ = std::thread(std::bind(&progress::progress_thread, this));
-}
+  public:
+    static progress_registry& instance()
+    {
+        static progress_registry inst;
+        return inst;
+    }
 
-void progress::print()
-{
-    using namespace std::chrono;
-    auto iter = std::max(uint64_t{1}, iter_.load());
-    auto tp = steady_clock::now();
-    auto percent = static_cast<double>(iter) / length_;
-    auto elapsed = duration_cast<milliseconds>(tp - start_).count();
-    auto remain = (length_ - iter) * static_cast<double>(elapsed) / (iter);
-
-    auto secs = static_cast<int>(remain / 1000);
-    auto mins = secs / 60;
-    auto hrs = mins / 60;
-
-    std::ptrdiff_t max_len = 80 - static_cast<std::ptrdiff_t>(prefix_len_) - 20;
-    if (hrs > 100)
-        max_len -= 1;
-
-    auto it = output_.begin() + static_cast<std::ptrdiff_t>(prefix_len_) + 1;
-    auto barend = it + max_len;
-    auto end = it + static_cast<std::ptrdiff_t>(max_len * percent);
-    std::fill(it, end, '=');
-    *end = '>';
-    if (end < barend)
-        std::fill(end + 1, barend, ' ');
-    it = barend;
-    *it++ = ']';
-    *it++ = ' ';
-
-    it += ::sprintf(&(*it), "%d%%", static_cast<int>(percent * 100));
-    it += ::sprintf(&(*it), " ETA %02d:%02d:%02d", std::min(999, hrs),
-                    mins % 60, secs % 60);
-
-    LOG(progress) << '\r' << output_ << ENDLG;
-}
+    void add(progress* bar)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stack_.push_back(bar);
+        if (stack_.size() == 1)
+        {
+            // collect the reporter from a previous batch of bars, if any
+            if (thread_.joinable())
+                thread_.join();
+            thread_ = std::thread{[this]() { report(); }};
+        }
+    }
 
-void progress::progress_thread()
-{
-    while (iter_ != length_)
+    void remove(progress* bar)
     {
-        print();
+        std::thread reporter;
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stack_.erase(std::remove(stack_.begin(), stack_.end(), bar),
+                         stack_.end());
+            // always emit a final (100%) line for the finishing bar
+            print(*bar);
+            if (bar->endline_)
+                LOG(progress) << '\n' << ENDLG;
+            if (stack_.empty())
+                reporter = std::move(thread_);
+            cond_var_.notify_all();
+        }
+        if (reporter.joinable())
+            reporter.join();
+    }
 
+  private:
+    void report()
+    {
         std::unique_lock<std::mutex> lock{mutex_};
-        cond_var_.wait_for(lock, std::chrono::milliseconds(interval_));
+        while (!stack_.empty())
+        {
+            auto* bar = stack_.back();
+            print(*bar);
+            cond_var_.wait_for(lock, std::chrono::milliseconds(bar->interval_));
+        }
     }
-    print();
+
+    /**
+     * Formats and emits a single bar's output line. Callers must hold
+     * mutex_, which also serializes the terminal writes.
+     */
+    void print(progress& bar)
+    {
+        using namespace std::chrono;
+        auto prefix_len = bar.prefix_.length();
+        std::string output(80, ' ');
+        std::copy(bar.prefix_.begin(), bar.prefix_.end(), output.begin());
+        output[prefix_len] = '[';
+
+        auto iter = std::max(uint64_t{1},
+                             bar.iter_.load(std::memory_order_relaxed));
+        auto tp = steady_clock::now();
+        auto percent = static_cast<double>(iter) / bar.length_;
+        auto elapsed = duration_cast<milliseconds>(tp - bar.start_).count();
+        auto remain
+            = (bar.length_ - iter) * static_cast<double>(elapsed) / (iter);
+
+        auto secs = static_cast<int>(remain / 1000);
+        auto mins = secs / 60;
+        auto hrs = mins / 60;
+
+        std::ptrdiff_t max_len
+            = 80 - static_cast<std::ptrdiff_t>(prefix_len) - 20;
+        if (hrs > 100)
+            max_len -= 1;
+
+        auto it = output.begin() + static_cast<std::ptrdiff_t>(prefix_len) + 1;
+        auto barend = it + max_len;
+        auto end = it + static_cast<std::ptrdiff_t>(max_len * percent);
+        std::fill(it, end, '=');
+        *end = '>';
+        if (end < barend)
+            std::fill(end + 1, barend, ' ');
+        it = barend;
+        *it++ = ']';
+        *it++ = ' ';
+
+        it += ::sprintf(&(*it), "%d%%", static_cast<int>(percent * 100));
+        it += ::sprintf(&(*it), " ETA %02d:%02d:%02d", std::min(999, hrs),
+                        mins % 60, secs % 60);
+
+        LOG(progress) << '\r' << output << ENDLG;
+    }
+
+    /// The currently active bars, in registration (nesting) order
+    std::vector<progress*> stack_;
+    /// Protects the stack and serializes terminal output
+    std::mutex mutex_;
+    /// Wakes the reporter for shutdown between sampling ticks
+    std::condition_variable cond_var_;
+    /// The shared reporter thread
+    std::thread thread_;
+};
+
+progress::progress(const std::string& prefix, uint64_t length, int interval)
+    : prefix_{prefix},
+      start_{std::chrono::steady_clock::now()},
+      iter_{0},
+      length_{length},
+      interval_{interval},
+      endline_{true},
+      finished_{false}
+{
+    assert(prefix_.length() < 80 - 20);
+    progress_registry::instance().add(this);
 }
 
 void progress::print_endline(bool endline)
@@ -88,18 +154,16 @@ void progress::print_endline(bool endline)
 
 void progress::operator()(uint64_t iter)
 {
-    iter_ = (iter < length_) ? iter : length_;
+    iter_.store((iter < length_) ? iter : length_, std::memory_order_relaxed);
 }
 
 void progress::end()
 {
-    if (thread_.joinable())
+    if (!finished_)
     {
-        iter_ = length_;
-        cond_var_.notify_all();
-        thread_.join();
-        if (endline_)
-            LOG(progress) << '\n' << ENDLG;
+        finished_ = true;
+        iter_.store(length_, std::memory_order_relaxed);
+        progress_registry::instance().remove(this);
     }
 }
 
@@ -0,0 +1,83 @@
+/**
+ * @file async_writer_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "bandit/bandit.h"
+#include "meta/logging/async_writer.h"
+
+using namespace bandit;
+using namespace meta;
+
+go_bandit([]() {
+    describe("[async writer]", []() {
+
+        it("should deliver every line logged from concurrent threads", [&]() {
+            logging::logger log;
+            std::stringstream out;
+            log.add_sink({out,
+                          [](const logging::logger::log_line&) { return true; },
+                          [](const logging::logger::log_line& ll) {
+                              return ll.str() + "\n";
+                          }});
+
+            const std::size_t num_threads = 4;
+            const std::size_t lines_per_thread = 50;
+            {
+                // the ring never fills here, so the writer thread is
+                // the stream's only writer
+                logging::async_writer writer{log, 1024};
+
+                std::vector<std::thread> threads;
+                for (std::size_t t = 0; t < num_threads; ++t)
+                {
+                    threads.emplace_back([&, t]() {
+                        for (std::size_t i = 0; i < lines_per_thread; ++i)
+                        {
+                            logging::logger::log_line ll{
+                                log, logging::logger::severity_level::info, 0,
+                                "test"};
+                            ll << "thread " << t << " line " << i;
+                            ll.write_to_sinks();
+                        }
+                    });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+
+                writer.flush();
+                // after a flush, everything staged so far is visible
+                std::size_t lines = 0;
+                std::string line;
+                std::stringstream check{out.str()};
+                while (std::getline(check, line))
+                    ++lines;
+                AssertThat(lines, Equals(num_threads * lines_per_thread));
+            }
+        });
+
+        it("should fall back to synchronous writes when uninstalled", [&]() {
+            logging::logger log;
+            std::stringstream out;
+            log.add_sink({out,
+                          [](const logging::logger::log_line&) { return true; },
+                          [](const logging::logger::log_line& ll) {
+                              return ll.str() + "\n";
+                          }});
+
+            {
+                logging::async_writer writer{log, 8};
+            }
+
+            logging::logger::log_line ll{
+                log, logging::logger::severity_level::info, 0, "test"};
+            ll << "after teardown";
+            ll.write_to_sinks();
+            AssertThat(out.str(), Equals("after teardown\n"));
+        });
+    });
+});
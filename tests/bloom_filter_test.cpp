@@ -0,0 +1,57 @@
+/**
+ * @file bloom_filter_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <random>
+#include <sstream>
+
+#include "bandit/bandit.h"
+#include "meta/hashing/bloom_filter.h"
+
+using namespace bandit;
+using namespace meta;
+
+go_bandit([]() {
+    describe("[bloom-filter]", []() {
+
+        it("should never report an inserted key as absent", []() {
+            hashing::bloom_filter<uint64_t> filter{1000};
+            for (uint64_t i = 0; i < 1000; ++i)
+                filter.insert(i * 7919);
+            for (uint64_t i = 0; i < 1000; ++i)
+                AssertThat(filter.contains(i * 7919), IsTrue());
+        });
+
+        it("should reject most absent keys", []() {
+            hashing::bloom_filter<uint64_t> filter{1000};
+            for (uint64_t i = 0; i < 1000; ++i)
+                filter.insert(i);
+
+            uint64_t false_positives = 0;
+            for (uint64_t i = 1000; i < 11000; ++i)
+                false_positives += filter.contains(i);
+
+            // ~1% expected at 10 bits per key; allow generous slack
+            AssertThat(false_positives, IsLessThan(500ul));
+        });
+
+        it("should round-trip through save and load", []() {
+            hashing::bloom_filter<std::string> filter{100};
+            std::vector<std::string> keys;
+            for (int i = 0; i < 100; ++i)
+                keys.push_back("key-" + std::to_string(i));
+            for (const auto& key : keys)
+                filter.insert(key);
+
+            std::stringstream stream;
+            filter.save(stream);
+            hashing::bloom_filter<std::string> loaded{stream};
+
+            for (const auto& key : keys)
+                AssertThat(loaded.contains(key), IsTrue());
+            AssertThat(loaded.contains(std::string{"absent"}),
+                       Equals(filter.contains(std::string{"absent"})));
+        });
+    });
+});
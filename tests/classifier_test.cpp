@@ -11,6 +11,8 @@
 #include "bandit/bandit.h"
 #include "classifier_test_helper.h"
 #include "cpptoml.h"
+#include "meta/classify/concurrent_confusion_matrix.h"
+#include "meta/parallel/parallel_for.h"
 
 using namespace bandit;
 using namespace meta;
@@ -43,6 +45,25 @@ void run_tests(const std::string& index_type) {
             check_split(f_idx, *cfg, 0.92);
         });
 
+        it("should classify batches identically to one-at-a-time", [&]() {
+            using namespace classify;
+            multiclass_dataset dataset{f_idx};
+            multiclass_dataset_view mcdv{dataset, std::mt19937_64{47}};
+
+            auto cfg = cpptoml::make_table();
+            cfg->insert("method", naive_bayes::id.to_string());
+            auto cls = make_classifier(*cfg, mcdv);
+
+            auto batch = cls->classify_batch(mcdv);
+            AssertThat(batch.size(), Equals(mcdv.size()));
+            std::size_t pos = 0;
+            for (const auto& instance : mcdv)
+            {
+                AssertThat(batch[pos], Equals(cls->classify(instance.weights)));
+                ++pos;
+            }
+        });
+
         it("should create KNN classifier with CV", [&]() {
             check_cv(f_idx, [&](multiclass_dataset_view docs) {
                 return make_unique<knn>(std::move(docs), i_idx, 10,
@@ -318,5 +339,37 @@ go_bandit([]() {
             AssertThat(mtx.f1_score(),
                        EqualsWithDelta((2.0 / 7 + 6.0 / 7) / 3, delta));
         });
+
+        it("should match when accumulated concurrently", [&]() {
+            classify::concurrent_confusion_matrix cmtx{
+                {"A"_cl, "B"_cl, "C"_cl}};
+
+            parallel::thread_pool pool;
+            parallel::parallel_for(preds.begin(), preds.end(), pool,
+                                   [&](const std::pair<predicted_label,
+                                                       class_label>& pair) {
+                                       cmtx.add(pair.first, pair.second);
+                                   });
+
+            AssertThat(cmtx.accuracy(),
+                       EqualsWithDelta(mtx.accuracy(), delta));
+            for (const auto& lbl : {"A"_cl, "B"_cl, "C"_cl})
+            {
+                AssertThat(cmtx.precision(lbl),
+                           EqualsWithDelta(mtx.precision(lbl), delta));
+                AssertThat(cmtx.recall(lbl),
+                           EqualsWithDelta(mtx.recall(lbl), delta));
+                AssertThat(cmtx.f1_score(lbl),
+                           EqualsWithDelta(mtx.f1_score(lbl), delta));
+            }
+            AssertThat(cmtx.precision(),
+                       EqualsWithDelta(mtx.precision(), delta));
+            AssertThat(cmtx.recall(), EqualsWithDelta(mtx.recall(), delta));
+            AssertThat(cmtx.f1_score(), EqualsWithDelta(mtx.f1_score(), delta));
+
+            auto converted = cmtx.matrix();
+            AssertThat(converted.accuracy(),
+                       EqualsWithDelta(mtx.accuracy(), delta));
+        });
     });
 });
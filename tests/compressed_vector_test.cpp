@@ -37,5 +37,36 @@ go_bandit([]() {
             for (std::size_t i = 0; i < values.size(); ++i)
                 AssertThat(cv[i], Equals(values[i]));
         });
+
+        it("should block-decode runs of values", [&]() {
+            std::vector<uint64_t> buffer(64);
+            for (uint64_t start = 0; start < values.size();
+                 start += buffer.size())
+            {
+                auto decoded = cv.decode(start, buffer.size(), buffer.data());
+                for (uint64_t j = 0; j < decoded; ++j)
+                    AssertThat(buffer[j], Equals(values[start + j]));
+            }
+        });
+
+        it("should block-decode from unaligned starts", [&]() {
+            std::vector<uint64_t> buffer(77);
+            auto decoded = cv.decode(12345, buffer.size(), buffer.data());
+            AssertThat(decoded, Equals(buffer.size()));
+            for (uint64_t j = 0; j < decoded; ++j)
+                AssertThat(buffer[j], Equals(values[12345 + j]));
+        });
+
+        it("should clip block decodes at the end of the vector", [&]() {
+            std::vector<uint64_t> buffer(100);
+            auto decoded
+                = cv.decode(values.size() - 10, buffer.size(), buffer.data());
+            AssertThat(decoded, Equals(10ul));
+            for (uint64_t j = 0; j < decoded; ++j)
+                AssertThat(buffer[j], Equals(values[values.size() - 10 + j]));
+
+            AssertThat(cv.decode(values.size(), buffer.size(), buffer.data()),
+                       Equals(0ul));
+        });
     });
 });
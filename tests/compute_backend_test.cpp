@@ -0,0 +1,68 @@
+/**
+ * @file compute_backend_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <cmath>
+
+#include "bandit/bandit.h"
+#include "meta/math/compute_backend.h"
+#include "meta/util/aligned_allocator.h"
+
+using namespace bandit;
+using namespace meta;
+
+go_bandit([]() {
+    describe("[compute backend]", []() {
+        const auto& backend = math::compute_backend::cpu();
+
+        it("should name itself", [&]() {
+            AssertThat(backend.name().to_string(), Equals("cpu"));
+        });
+
+        it("should score a query against a block of rows", [&]() {
+            // three rows of dimension 4
+            util::aligned_vector<double> matrix
+                = {1, 0, 0, 0, //
+                   0, 2, 0, 0, //
+                   1, 1, 1, 1};
+            util::aligned_vector<double> query = {1, 2, 3, 4};
+            std::vector<double> out(3);
+
+            backend.dot_products(matrix.data(), 3, 4, query.data(),
+                                 out.data());
+            AssertThat(out[0], EqualsWithDelta(1.0, 1e-10));
+            AssertThat(out[1], EqualsWithDelta(4.0, 1e-10));
+            AssertThat(out[2], EqualsWithDelta(10.0, 1e-10));
+        });
+
+        it("should apply a batch of AdaGrad row updates", [&]() {
+            // two rows of dimension 2 in a strided table: row offsets
+            // 0 and 3 leave a gap element that must stay untouched
+            util::aligned_vector<double> weights = {1, 1, 7, 1, 1};
+            util::aligned_vector<double> gradsq = {1, 4, 7, 1, 16};
+            std::vector<std::size_t> offsets = {0, 3};
+            util::aligned_vector<double> grads = {1, 2, 3, 4};
+
+            backend.adagrad_apply(weights.data(), gradsq.data(),
+                                  offsets.data(), grads.data(), 2, 2);
+
+            AssertThat(weights[0], EqualsWithDelta(1.0 - 1.0 / 1.0, 1e-10));
+            AssertThat(weights[1], EqualsWithDelta(1.0 - 2.0 / 2.0, 1e-10));
+            AssertThat(weights[3], EqualsWithDelta(1.0 - 3.0 / 1.0, 1e-10));
+            AssertThat(weights[4], EqualsWithDelta(1.0 - 4.0 / 4.0, 1e-10));
+            AssertThat(weights[2], EqualsWithDelta(7.0, 1e-10));
+
+            AssertThat(gradsq[0], EqualsWithDelta(2.0, 1e-10));
+            AssertThat(gradsq[1], EqualsWithDelta(8.0, 1e-10));
+            AssertThat(gradsq[3], EqualsWithDelta(10.0, 1e-10));
+            AssertThat(gradsq[4], EqualsWithDelta(32.0, 1e-10));
+            AssertThat(gradsq[2], EqualsWithDelta(7.0, 1e-10));
+        });
+
+        it("should select a usable backend process-wide", [&]() {
+            const auto& selected = math::compute_backend::instance();
+            AssertThat(selected.name().empty(), IsFalse());
+        });
+    });
+});
@@ -0,0 +1,128 @@
+/**
+ * @file dd_sketch_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bandit/bandit.h"
+#include "meta/stats/dd_sketch.h"
+
+using namespace bandit;
+
+namespace
+{
+/// checks every decile of a sketch against the exact quantiles
+void check_quantiles(const meta::stats::dd_sketch& sketch,
+                     std::vector<double>& values)
+{
+    std::sort(values.begin(), values.end());
+    for (double q = 0.1; q < 1.0; q += 0.1)
+    {
+        auto exact
+            = values[static_cast<std::size_t>(q * (values.size() - 1))];
+        auto approx = sketch.quantile(q);
+        AssertThat(std::abs(approx - exact),
+                   IsLessThan(sketch.relative_accuracy() * exact
+                              + 1e-12));
+    }
+}
+}
+
+go_bandit([]() {
+    using namespace meta;
+
+    describe("[dd sketch]", []() {
+        it("should answer quantiles within the relative accuracy", []() {
+            std::mt19937 rng{47};
+            std::lognormal_distribution<double> latencies{3.0, 1.5};
+
+            stats::dd_sketch sketch;
+            std::vector<double> values;
+            for (std::size_t i = 0; i < 20000; ++i)
+            {
+                auto value = latencies(rng);
+                sketch.add(value);
+                values.push_back(value);
+            }
+            AssertThat(sketch.size(), Equals(uint64_t{20000}));
+
+            check_quantiles(sketch, values);
+        });
+
+        it("should merge sketches over disjoint streams", []() {
+            std::mt19937 rng{47};
+            std::exponential_distribution<double> latencies{0.01};
+
+            stats::dd_sketch left;
+            stats::dd_sketch right;
+            std::vector<double> values;
+            for (std::size_t i = 0; i < 10000; ++i)
+            {
+                auto value = latencies(rng);
+                (i % 2 == 0 ? left : right).add(value);
+                values.push_back(value);
+            }
+
+            left.merge(right);
+            AssertThat(left.size(), Equals(uint64_t{10000}));
+            check_quantiles(left, values);
+        });
+
+        it("should refuse to merge sketches of differing accuracy", []() {
+            stats::dd_sketch coarse{0.05};
+            stats::dd_sketch fine{0.01};
+            AssertThrows(stats::dd_sketch::exception, coarse.merge(fine));
+        });
+
+        it("should count non-positive values in the zero bucket", []() {
+            stats::dd_sketch sketch;
+            for (std::size_t i = 0; i < 90; ++i)
+                sketch.add(0.0);
+            for (std::size_t i = 0; i < 10; ++i)
+                sketch.add(100.0);
+
+            AssertThat(sketch.quantile(0.5), Equals(0.0));
+            AssertThat(std::abs(sketch.quantile(0.99) - 100.0),
+                       IsLessThan(0.01 * 100.0));
+        });
+
+        it("should collapse low buckets under a tight budget", []() {
+            stats::dd_sketch sketch{0.01, 16};
+            for (std::size_t i = 1; i <= 10000; ++i)
+                sketch.add(static_cast<double>(i));
+
+            // upper quantiles keep the guarantee (within one bucket of
+            // rank rounding); low ones degrade
+            auto p99 = sketch.quantile(0.99);
+            AssertThat(std::abs(p99 - 9901.0), IsLessThan(0.021 * 9901.0));
+        });
+
+        it("should snapshot concurrent writers consistently", []() {
+            stats::concurrent_dd_sketch sketch{0.01, 1.0, 1e6};
+
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0; t < 4; ++t)
+            {
+                threads.emplace_back([&sketch, t]() {
+                    std::mt19937 rng{static_cast<uint32_t>(t)};
+                    std::uniform_real_distribution<double> dist{1.0, 1e5};
+                    for (std::size_t i = 0; i < 5000; ++i)
+                        sketch.add(dist(rng));
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+
+            auto snap = sketch.snapshot();
+            AssertThat(snap.size(), Equals(uint64_t{20000}));
+            // a uniform [1, 1e5] stream has its median near 5e4
+            AssertThat(snap.quantile(0.5), IsGreaterThan(4.5e4));
+            AssertThat(snap.quantile(0.5), IsLessThan(5.5e4));
+        });
+    });
+});
@@ -0,0 +1,98 @@
+/**
+ * @file dense_matrix_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <cstdint>
+
+#include "bandit/bandit.h"
+#include "meta/util/dense_matrix.h"
+
+using namespace bandit;
+using namespace meta;
+
+go_bandit([]() {
+    describe("[dense matrix]", []() {
+
+        it("should transpose with a blocked traversal", [&]() {
+            // larger than one block in each dimension
+            util::dense_matrix<uint64_t> mat{70, 40};
+            for (uint64_t r = 0; r < mat.rows(); ++r)
+                for (uint64_t c = 0; c < mat.columns(); ++c)
+                    mat(r, c) = r * 1000 + c;
+
+            auto trans = mat.transpose();
+            AssertThat(trans.rows(), Equals(mat.columns()));
+            AssertThat(trans.columns(), Equals(mat.rows()));
+            for (uint64_t r = 0; r < mat.rows(); ++r)
+                for (uint64_t c = 0; c < mat.columns(); ++c)
+                    AssertThat(trans(c, r), Equals(mat(r, c)));
+
+            // transposing twice round-trips
+            auto twice = trans.transpose();
+            for (uint64_t r = 0; r < mat.rows(); ++r)
+                for (uint64_t c = 0; c < mat.columns(); ++c)
+                    AssertThat(twice(r, c), Equals(mat(r, c)));
+        });
+
+        it("should compute row and column sums", [&]() {
+            util::dense_matrix<uint64_t> mat{3, 4};
+            for (uint64_t r = 0; r < mat.rows(); ++r)
+                for (uint64_t c = 0; c < mat.columns(); ++c)
+                    mat(r, c) = r + c;
+
+            auto rows = mat.row_sums();
+            AssertThat(rows.size(), Equals(3ul));
+            for (uint64_t r = 0; r < rows.size(); ++r)
+                AssertThat(rows[r], Equals(4 * r + 0 + 1 + 2 + 3));
+
+            auto cols = mat.column_sums();
+            AssertThat(cols.size(), Equals(4ul));
+            for (uint64_t c = 0; c < cols.size(); ++c)
+                AssertThat(cols[c], Equals(3 * c + 0 + 1 + 2));
+        });
+
+        it("should view matrices through a strided view", [&]() {
+            util::dense_matrix<double> mat{4, 5};
+            for (uint64_t r = 0; r < mat.rows(); ++r)
+                for (uint64_t c = 0; c < mat.columns(); ++c)
+                    mat(r, c) = r * 10.0 + c;
+
+            util::matrix_view<double> view{mat};
+            AssertThat(view.rows(), Equals(mat.rows()));
+            AssertThat(view.columns(), Equals(mat.columns()));
+            AssertThat(view.stride(), Equals(mat.columns()));
+            view(2, 3) = 42.0;
+            AssertThat(mat(2, 3), Equals(42.0));
+
+            const auto& cmat = mat;
+            util::matrix_view<const double> cview{cmat};
+            AssertThat(cview(2, 3), Equals(42.0));
+            AssertThat(static_cast<uint64_t>(cview.end(1) - cview.begin(1)),
+                       Equals(mat.columns()));
+        });
+
+        it("should pad rows to cache lines in a padded_matrix", [&]() {
+            util::padded_matrix<double> mat{3, 5};
+            AssertThat(mat.rows(), Equals(3ul));
+            AssertThat(mat.columns(), Equals(5ul));
+            // 64 bytes per line / 8 bytes per double = 8 per line
+            AssertThat(mat.stride(), Equals(8ul));
+
+            for (uint64_t r = 0; r < mat.rows(); ++r)
+                for (uint64_t c = 0; c < mat.columns(); ++c)
+                    mat(r, c) = r * 10.0 + c;
+
+            auto view = mat.view();
+            AssertThat(view.stride(), Equals(8ul));
+            for (uint64_t r = 0; r < mat.rows(); ++r)
+            {
+                // every row begins on its own cache line
+                auto addr = reinterpret_cast<std::uintptr_t>(view.begin(r));
+                AssertThat(addr % 64, Equals(0ul));
+                for (uint64_t c = 0; c < mat.columns(); ++c)
+                    AssertThat(view(r, c), Equals(r * 10.0 + c));
+            }
+        });
+    });
+});
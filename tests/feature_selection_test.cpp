@@ -8,6 +8,7 @@
 #include "meta/classify/multiclass_dataset.h"
 #include "meta/classify/multiclass_dataset_view.h"
 #include "meta/features/all.h"
+#include "meta/features/feature_remap.h"
 #include "meta/features/feature_selector.h"
 #include "meta/features/selector_factory.h"
 
@@ -33,6 +34,14 @@ void run_test(const Dataset& dset, DatasetView& dset_vw,
 
     AssertThat(selector->selected(tid), IsTrue());
 
+    // the standalone remap view should agree with the selector it was
+    // written by
+    features::feature_remap remap{selector->prefix()};
+    AssertThat(remap.total_selected(), Equals(selector->total_selected()));
+    AssertThat(remap.selected(tid), IsTrue());
+    AssertThat(remap.new_id(tid), Equals(selector->new_id(tid)));
+    AssertThat(remap.old_id(remap.new_id(tid)), Equals(tid));
+
     for (uint64_t lbl_id = 0; lbl_id < dset_vw.total_labels(); ++lbl_id)
         AssertThat(filesystem::file_exists("test-features/" + method_id + "/"
                                            + std::to_string(lbl_id + 1)
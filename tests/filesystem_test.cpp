@@ -41,4 +41,47 @@ go_bandit([]() {
 
         filesystem::delete_file(filename);
     });
+
+    describe("[filesystem] copying", []() {
+        auto write_file = [](const std::string& path,
+                             const std::string& data) {
+            std::ofstream file{path, std::ios::binary};
+            file.write(data.c_str(),
+                       static_cast<std::streamsize>(data.length()));
+        };
+
+        it("should copy files byte-for-byte", [&]() {
+            write_file("filesystem-copy-src.bin", "some copied content\n");
+            AssertThat(filesystem::copy_file("filesystem-copy-src.bin",
+                                             "filesystem-copy-dst.bin"),
+                       IsTrue());
+            AssertThat(filesystem::file_text("filesystem-copy-dst.bin"),
+                       Equals("some copied content\n"));
+
+            filesystem::delete_file("filesystem-copy-src.bin");
+            filesystem::delete_file("filesystem-copy-dst.bin");
+        });
+
+        it("should copy directory trees recursively", [&]() {
+            filesystem::remove_all("filesystem-tree-src");
+            filesystem::remove_all("filesystem-tree-dst");
+
+            filesystem::make_directory("filesystem-tree-src");
+            filesystem::make_directory("filesystem-tree-src/sub");
+            write_file("filesystem-tree-src/a.txt", "top level\n");
+            write_file("filesystem-tree-src/sub/b.txt", "nested\n");
+
+            // 2 files + 1 subdirectory + the root itself
+            AssertThat(filesystem::copy_tree("filesystem-tree-src",
+                                             "filesystem-tree-dst"),
+                       Equals(std::uintmax_t{4}));
+            AssertThat(filesystem::file_text("filesystem-tree-dst/a.txt"),
+                       Equals("top level\n"));
+            AssertThat(filesystem::file_text("filesystem-tree-dst/sub/b.txt"),
+                       Equals("nested\n"));
+
+            filesystem::remove_all("filesystem-tree-src");
+            filesystem::remove_all("filesystem-tree-dst");
+        });
+    });
 });
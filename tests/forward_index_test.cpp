@@ -5,6 +5,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <unordered_set>
 
 #include "bandit/bandit.h"
@@ -12,6 +13,7 @@
 #include "meta/caching/all.h"
 #include "cpptoml.h"
 #include "meta/index/forward_index.h"
+#include "meta/index/inverted_index.h"
 #include "meta/index/postings_data.h"
 #include "meta/io/filesystem.h"
 
@@ -129,6 +131,25 @@ void check_ceeaus_doc_id(Index& idx) {
     }
 }
 
+template <class Index>
+void check_pinned_streams(Index& idx) {
+    // a zero budget can never hold the postings file
+    AssertThat(idx.pin_postings(0), IsFalse());
+
+    auto before = idx.search_primary(doc_id{47})->counts();
+    AssertThat(idx.pin_postings(std::numeric_limits<uint64_t>::max()),
+               IsTrue());
+
+    auto stream = idx.stream_for(doc_id{47});
+    std::vector<std::pair<term_id, double>> after{stream->begin(),
+                                                  stream->end()};
+    AssertThat(after.size(), Equals(before.size()));
+    for (uint64_t i = 0; i < after.size(); ++i) {
+        AssertThat(after[i].first, Equals(before[i].first));
+        AssertThat(after[i].second, EqualsWithDelta(before[i].second, 0.001));
+    }
+}
+
 void ceeaus_forward_test(const cpptoml::table& conf) {
     auto idx = index::make_index<index::forward_index, caching::splay_cache>(
         conf, uint32_t{10000});
@@ -156,11 +177,34 @@ go_bandit([]() {
 
         it("should load the index", [&]() { ceeaus_forward_test(*file_cfg); });
 
+        it("should stream identical postings after pinning in memory", [&]() {
+            auto idx
+                = index::make_index<index::forward_index,
+                                    caching::splay_cache>(*file_cfg,
+                                                          uint32_t{10000});
+            check_pinned_streams(*idx);
+        });
+
         it("should uninvert if specified", [&]() {
             filesystem::remove_all("ceeaus");
             file_cfg->insert("uninvert", true);
             ceeaus_forward_test(*file_cfg);
         });
+
+        it("should co-build the inverted index if specified", [&]() {
+            filesystem::remove_all("ceeaus");
+            auto cfg = tests::create_config("file");
+            cfg->insert("co-build", true);
+            ceeaus_forward_test(*cfg);
+
+            // the sibling inverted index should have been created from
+            // the same analysis pass and load without a rebuild
+            AssertThat(filesystem::file_exists("ceeaus/inv/postings.index"),
+                       IsTrue());
+            auto inv = index::make_index<index::inverted_index>(*cfg);
+            AssertThat(inv->num_docs(), Equals(1008ul));
+            AssertThat(inv->unique_terms(), Equals(4224ul));
+        });
     });
 
     describe("[forward-index] from line config", []() {
@@ -92,6 +92,18 @@ go_bandit([]() {
             auto docs = corpus::make_corpus(*file_cfg);
             check_full_text(*docs, *file_cfg);
         });
+
+        it("should create the same index with compressed spill chunks", [&]() {
+            filesystem::remove_all("ceeaus");
+            auto cfg = tests::create_config("file");
+            cfg->insert("compress-chunks", true);
+            // a tiny budget forces spills so the compressed path is hit
+            cfg->insert("indexer-ram-budget", int64_t{1});
+            auto idx = index::make_index<index::inverted_index>(*cfg);
+            check_ceeaus_expected(*idx);
+            check_term_id(*idx);
+            filesystem::remove_all("ceeaus");
+        });
     });
 
     describe("[inverted-index] from line config", []() {
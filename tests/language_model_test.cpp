@@ -47,6 +47,26 @@ void run_test(const cpptoml::table& line_cfg) {
                EqualsWithDelta(model.perplexity(s3) / s3.size(), delta));
     AssertThat(model.perplexity_per_word(s4),
                EqualsWithDelta(model.perplexity(s4) / s4.size(), delta));
+
+    // incrementally scoring a sentence token by token with threaded
+    // states should match scoring it all at once
+    lm::lm_state state;
+    lm::lm_state state_next;
+    float total = 0.0f;
+    for (const auto& word : s1) {
+        total += model.score(state, word, state_next);
+        state = state_next;
+    }
+    AssertThat(total, EqualsWithDelta(model.log_prob(s1), delta));
+
+    // n-best rescoring with prefix deduplication should match scoring
+    // each hypothesis independently
+    std::vector<lm::sentence> nbest{s1, s2, s1, s3, s4};
+    auto rescored = model.rescore_nbest(nbest);
+    AssertThat(rescored.size(), Equals(nbest.size()));
+    for (std::size_t i = 0; i < nbest.size(); ++i)
+        AssertThat(rescored[i],
+                   EqualsWithDelta(model.log_prob(nbest[i]), delta));
 }
 }
 
@@ -128,5 +148,52 @@ go_bandit([]() {
         filesystem::delete_file("test-lm-1.binlm");
         filesystem::delete_file("test-lm-2.binlm");
         filesystem::delete_file("test-lm-0.strings");
+        filesystem::delete_file("test-lm-binlm.header");
+    });
+
+    describe("[language-model] quantized language_model", [&]() {
+
+        auto quant_cfg = cpptoml::make_table();
+        auto lm_table = cpptoml::make_table();
+        lm_table->insert("arpa-file", "../data/english-sentences.arpa");
+        lm_table->insert("binary-file-prefix", "test-lm-q-");
+        lm_table->insert("quantize-bits", static_cast<int64_t>(8));
+        quant_cfg->insert("language-model", lm_table);
+
+        auto run_quant_test = [&]() {
+            lm::language_model exact{*line_cfg};
+            lm::language_model quant{*quant_cfg};
+            lm::sentence s1{"<s> I disagree with this statement for several "
+                            "reasons . </s>",
+                            false};
+            lm::sentence s2{"<s> Hello world ! </s>", false};
+
+            // 8-bit codebooks introduce a small per-token rounding error
+            const double delta = 0.01;
+            AssertThat(static_cast<double>(quant.log_prob(s1)),
+                       EqualsWithDelta(exact.log_prob(s1), delta * s1.size()));
+            AssertThat(static_cast<double>(quant.log_prob(s2)),
+                       EqualsWithDelta(exact.log_prob(s2), delta * s2.size()));
+        };
+
+        it("should quantize values during .arpa conversion",
+           [&]() { run_quant_test(); });
+
+        it("should read quantized binary files with correct output",
+           [&]() { run_quant_test(); });
+
+        filesystem::delete_file("test-lm-0.binlm");
+        filesystem::delete_file("test-lm-1.binlm");
+        filesystem::delete_file("test-lm-2.binlm");
+        filesystem::delete_file("test-lm-0.strings");
+        filesystem::delete_file("test-lm-binlm.header");
+        for (const std::string& ord : {"0", "1", "2"})
+        {
+            filesystem::delete_file("test-lm-q-" + ord + ".binlm");
+            filesystem::delete_file("test-lm-q-" + ord + ".binlm.codes");
+            filesystem::delete_file("test-lm-q-" + ord + ".binlm.quant");
+        }
+        filesystem::delete_file("test-lm-q-0.strings");
+        filesystem::delete_file("test-lm-q-binlm.header");
     });
 });
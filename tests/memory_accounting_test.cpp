@@ -0,0 +1,73 @@
+/**
+ * @file memory_accounting_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <vector>
+
+#include "bandit/bandit.h"
+#include "meta/util/memory_accounting.h"
+
+using namespace bandit;
+using namespace meta;
+
+go_bandit([]() {
+
+    describe("[memory-accounting]", []() {
+
+        it("should track live and peak bytes per component", []() {
+            auto& acct = memory::component("test::raw");
+            acct.allocated(1000);
+            acct.allocated(500);
+            AssertThat(acct.live(), Equals(1500ul));
+            acct.released(1200);
+            AssertThat(acct.live(), Equals(300ul));
+            AssertThat(acct.peak(), Is().GreaterThanOrEqualTo(1500ul));
+        });
+
+        it("should return the same account for the same name", []() {
+            auto& a = memory::component("test::same");
+            auto& b = memory::component("test::same");
+            AssertThat(&a, Equals(&b));
+        });
+
+        it("should charge container allocations through the allocator",
+           []() {
+               auto& acct = memory::component("test::allocator");
+               {
+                   std::vector<uint64_t, memory::tracking_allocator<uint64_t>>
+                       vec{memory::tracking_allocator<uint64_t>{acct}};
+                   vec.resize(1024);
+                   AssertThat(acct.live(), Is().GreaterThanOrEqualTo(
+                                               1024 * sizeof(uint64_t)));
+               }
+               AssertThat(acct.live(), Equals(0ul));
+               AssertThat(acct.peak(), Is().GreaterThanOrEqualTo(
+                                           1024 * sizeof(uint64_t)));
+           });
+
+        it("should release scoped charges at destruction", []() {
+            auto& acct = memory::component("test::scoped");
+            {
+                memory::scoped_charge charge{acct};
+                charge.add(4096);
+                AssertThat(acct.live(), Equals(4096ul));
+
+                auto copy = charge;
+                AssertThat(acct.live(), Equals(8192ul));
+            }
+            AssertThat(acct.live(), Equals(0ul));
+        });
+
+        it("should list every component in the report", []() {
+            memory::component("test::report").allocated(42);
+            auto entries = memory::memory_report();
+            auto found = std::find_if(entries.begin(), entries.end(),
+                                      [](const memory::report_entry& entry) {
+                                          return entry.name == "test::report";
+                                      });
+            AssertThat(found == entries.end(), IsFalse());
+            AssertThat(found->live, Equals(42ul));
+        });
+    });
+});
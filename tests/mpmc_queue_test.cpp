@@ -0,0 +1,120 @@
+/**
+ * @file mpmc_queue_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "bandit/bandit.h"
+#include "meta/parallel/mpmc_queue.h"
+
+using namespace bandit;
+
+go_bandit([]() {
+    using namespace meta;
+
+    describe("[mpmc queue]", []() {
+        it("should deliver elements in FIFO order within capacity", []() {
+            parallel::mpmc_queue<uint64_t> queue{6};
+            // capacity rounds up to a power of two
+            AssertThat(queue.capacity(), Equals(std::size_t{8}));
+
+            for (uint64_t i = 0; i < queue.capacity(); ++i)
+                AssertThat(queue.try_push(std::move(i)), IsTrue());
+            uint64_t overflow = 100;
+            AssertThat(queue.try_push(std::move(overflow)), IsFalse());
+
+            uint64_t out;
+            for (uint64_t i = 0; i < queue.capacity(); ++i)
+            {
+                AssertThat(queue.try_pop(out), IsTrue());
+                AssertThat(out, Equals(i));
+            }
+            AssertThat(queue.try_pop(out), IsFalse());
+        });
+
+        it("should deliver every element exactly once under contention",
+           []() {
+               // a queue much smaller than the stream forces many full
+               // laps of the ring with both sides contending
+               const std::size_t num_producers = 4;
+               const std::size_t num_consumers = 4;
+               const uint64_t per_producer = 10000;
+               parallel::mpmc_queue<uint64_t> queue{64};
+
+               std::vector<std::vector<uint64_t>> received(num_consumers);
+               std::vector<std::thread> consumers;
+               for (std::size_t c = 0; c < num_consumers; ++c)
+               {
+                   consumers.emplace_back([&queue, &received, c]() {
+                       uint64_t value;
+                       while (queue.pop(value))
+                           received[c].push_back(value);
+                   });
+               }
+
+               std::vector<std::thread> producers;
+               for (std::size_t p = 0; p < num_producers; ++p)
+               {
+                   producers.emplace_back([&queue, p, per_producer]() {
+                       for (uint64_t i = 0; i < per_producer; ++i)
+                           queue.push(p * per_producer + i);
+                   });
+               }
+
+               for (auto& producer : producers)
+                   producer.join();
+               queue.close();
+               for (auto& consumer : consumers)
+                   consumer.join();
+
+               std::vector<uint64_t> all;
+               for (const auto& vec : received)
+                   all.insert(all.end(), vec.begin(), vec.end());
+               AssertThat(all.size(), Equals(std::size_t{num_producers
+                                                         * per_producer}));
+               std::sort(all.begin(), all.end());
+               for (uint64_t i = 0; i < all.size(); ++i)
+                   AssertThat(all[i], Equals(i));
+           });
+
+        it("should drain remaining elements after close", []() {
+            parallel::mpmc_queue<uint64_t> queue{8};
+            for (uint64_t i = 0; i < 5; ++i)
+                queue.push(i);
+            queue.close();
+            AssertThat(queue.closed(), IsTrue());
+
+            // consumers see the backlog in order, then shutdown
+            uint64_t out;
+            for (uint64_t i = 0; i < 5; ++i)
+            {
+                AssertThat(queue.pop(out), IsTrue());
+                AssertThat(out, Equals(i));
+            }
+            AssertThat(queue.pop(out), IsFalse());
+        });
+
+        it("should push and pop in batches up to the available space", []() {
+            parallel::mpmc_queue<uint64_t> queue{8};
+            std::vector<uint64_t> input(12);
+            std::iota(input.begin(), input.end(), 0);
+
+            // only the first capacity() elements fit
+            auto it = queue.try_push_batch(input.begin(), input.end());
+            AssertThat(std::distance(input.begin(), it),
+                       Equals(static_cast<std::ptrdiff_t>(queue.capacity())));
+
+            std::vector<uint64_t> output;
+            auto popped
+                = queue.try_pop_batch(std::back_inserter(output), 100);
+            AssertThat(popped, Equals(queue.capacity()));
+            for (uint64_t i = 0; i < output.size(); ++i)
+                AssertThat(output[i], Equals(i));
+        });
+    });
+});
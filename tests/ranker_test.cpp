@@ -3,6 +3,8 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
+
 #include "bandit/bandit.h"
 #include "create_config.h"
 #include "meta/corpus/document.h"
@@ -93,6 +95,139 @@ go_bandit([]() {
             test_rank(r, *idx, encoding);
         });
 
+        it("should rank term-id queries identically to string queries", [&]() {
+            index::okapi_bm25 r;
+            corpus::document query;
+            query.content("character");
+
+            auto expected = r.score(*idx, query);
+
+            auto counts = idx->tokenize(query);
+            std::vector<std::pair<term_id, float>> tid_query;
+            tid_query.reserve(counts.size());
+            for (const auto& count : counts)
+                tid_query.emplace_back(idx->get_term_id(count.key()),
+                                       static_cast<float>(count.value()));
+
+            auto ranking = r.score(*idx, tid_query);
+            AssertThat(ranking.size(), Equals(expected.size()));
+            for (uint64_t i = 0; i < ranking.size(); ++i)
+            {
+                AssertThat(ranking[i].d_id, Equals(expected[i].d_id));
+                AssertThat(ranking[i].score,
+                           EqualsWithDelta(expected[i].score, 0.0001));
+            }
+        });
+
+        it("should rank identically when scoring through a scratch", [&]() {
+            index::okapi_bm25 r;
+            corpus::document query;
+            query.content("character");
+
+            auto expected = r.score(*idx, query);
+
+            auto counts = idx->tokenize(query);
+            std::vector<std::pair<term_id, float>> tid_query;
+            tid_query.reserve(counts.size());
+            for (const auto& count : counts)
+                tid_query.emplace_back(idx->get_term_id(count.key()),
+                                       static_cast<float>(count.value()));
+
+            // repeated queries recycle the scratch's buffers
+            index::ranker::scratch scratch;
+            for (int round = 0; round < 3; ++round)
+            {
+                auto ranking = r.score(*idx, tid_query, scratch);
+                AssertThat(ranking.size(), Equals(expected.size()));
+                for (uint64_t i = 0; i < ranking.size(); ++i)
+                {
+                    AssertThat(ranking[i].d_id, Equals(expected[i].d_id));
+                    AssertThat(ranking[i].score,
+                               EqualsWithDelta(expected[i].score, 0.0001));
+                }
+                scratch.results = std::move(ranking);
+            }
+
+            // the pruned path draws its bookkeeping from the scratch too
+            r.wand_pruning(true);
+            auto pruned = r.score(*idx, tid_query, scratch);
+            AssertThat(pruned.size(), Equals(expected.size()));
+            for (uint64_t i = 0; i < pruned.size(); ++i)
+                AssertThat(pruned[i].d_id, Equals(expected[i].d_id));
+        });
+
+        it("should degrade gracefully under a score budget", [&]() {
+            index::okapi_bm25 r;
+            corpus::document query;
+            query.content("character");
+
+            auto exact = r.score(*idx, query);
+
+            // a budget large enough to never trip returns exact results
+            index::score_budget generous;
+            generous.max_postings = idx->num_docs() * 10;
+            auto ranking = r.score(*idx, query, generous);
+            AssertThat(generous.degraded, IsFalse());
+            AssertThat(ranking.size(), Equals(exact.size()));
+            for (uint64_t i = 0; i < ranking.size(); ++i)
+                AssertThat(ranking[i].d_id, Equals(exact[i].d_id));
+
+            // a tiny budget still returns sorted best-so-far results
+            index::score_budget tight;
+            tight.max_postings = 5;
+            auto degraded = r.score(*idx, query, tight);
+            AssertThat(tight.degraded, IsTrue());
+            for (uint64_t i = 1; i < degraded.size(); ++i)
+                AssertThat(degraded[i - 1].score,
+                           Is().GreaterThanOrEqualTo(degraded[i].score));
+        });
+
+        it("should extract LTR features and rerank the top k", [&]() {
+            index::okapi_bm25 first_stage;
+            corpus::document query;
+            query.content("character");
+
+            auto results = first_stage.score(*idx, query, 20);
+
+            std::vector<std::unique_ptr<index::ranking_function>> features;
+            features.emplace_back(make_unique<index::dirichlet_prior>());
+            features.emplace_back(make_unique<index::jelinek_mercer>());
+            index::ltr_reranker ltr{std::move(features)};
+
+            auto candidates = ltr.extract(*idx, query, results);
+            AssertThat(candidates.size(), Equals(results.size()));
+            for (uint64_t i = 0; i < candidates.size(); ++i)
+            {
+                AssertThat(candidates[i].d_id, Equals(results[i].d_id));
+                AssertThat(candidates[i].features.size(),
+                           Equals(ltr.num_features()));
+            }
+
+            // train toward the first-stage order as a relevance signal
+            for (int round = 0; round < 50; ++round)
+                for (uint64_t i = 0; i < candidates.size(); ++i)
+                    ltr.train_one(candidates[i],
+                                  static_cast<double>(candidates.size() - i));
+
+            auto reranked = ltr.rerank(*idx, query, results, 10);
+            AssertThat(reranked.size(), Equals(results.size()));
+
+            // reranking reorders the head but never changes the doc set
+            std::vector<doc_id> before, after;
+            for (const auto& r : results)
+                before.push_back(r.d_id);
+            for (const auto& r : reranked)
+                after.push_back(r.d_id);
+            std::sort(before.begin(), before.end());
+            std::sort(after.begin(), after.end());
+            AssertThat(after, Equals(before));
+
+            // the model's scores are sorted over the reranked head
+            for (uint64_t i = 1; i < 10; ++i)
+                AssertThat(reranked[i - 1].score,
+                           Is().GreaterThanOrEqualTo(reranked[i].score));
+        });
+
         it("should be able to rank with KL-divergence pseudo-relevance "
            "feedback",
            [&]() {
@@ -0,0 +1,114 @@
+/**
+ * @file space_saving_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bandit/bandit.h"
+#include "meta/stats/space_saving.h"
+
+using namespace bandit;
+
+go_bandit([]() {
+    using namespace meta;
+
+    describe("[space saving]", []() {
+        it("should count exactly when every key fits in a counter", []() {
+            stats::space_saving<std::string> summary{16};
+            for (uint64_t i = 0; i < 10; ++i)
+                for (uint64_t j = 0; j <= i; ++j)
+                    summary.increment("key-" + std::to_string(i));
+
+            AssertThat(summary.size(), Equals(std::size_t{10}));
+            auto counters = summary.counters();
+            AssertThat(counters.front().key, Equals(std::string{"key-9"}));
+            AssertThat(counters.front().count, Equals(uint64_t{10}));
+            for (const auto& ctr : counters)
+                AssertThat(ctr.error, Equals(uint64_t{0}));
+        });
+
+        it("should keep heavy hitters with bounded overestimation", []() {
+            // 10 heavy keys interleaved with a long tail of singletons;
+            // far more distinct keys than counters
+            stats::space_saving<std::string> summary{64};
+            std::mt19937 rng{47};
+            uint64_t total = 0;
+            uint64_t tail = 0;
+            for (uint64_t round = 0; round < 1000; ++round)
+            {
+                for (uint64_t h = 0; h < 10; ++h)
+                {
+                    summary.increment("heavy-" + std::to_string(h));
+                    ++total;
+                }
+                for (uint64_t t = 0; t < 5; ++t)
+                {
+                    summary.increment("tail-" + std::to_string(rng()));
+                    ++tail;
+                    ++total;
+                }
+            }
+
+            auto counters = summary.counters();
+            AssertThat(counters.size(), Equals(std::size_t{64}));
+
+            uint64_t heavy_found = 0;
+            for (const auto& ctr : counters)
+            {
+                // estimates are upper bounds, over by at most the error
+                AssertThat(ctr.count, IsGreaterThan(ctr.error));
+                if (ctr.key.find("heavy-") == 0)
+                {
+                    ++heavy_found;
+                    AssertThat(ctr.count,
+                               IsGreaterThan(uint64_t{999}));
+                    AssertThat(ctr.count - ctr.error,
+                               IsLessThan(uint64_t{1001}));
+                }
+            }
+            // every key above the N/m frequency bound must be present
+            AssertThat(heavy_found, Equals(uint64_t{10}));
+            // no count can exceed true count plus the max possible error
+            AssertThat(counters.front().count,
+                       IsLessThan(1000 + tail / 64 + 1));
+        });
+
+        it("should merge per-shard summaries into one candidate set", []() {
+            stats::space_saving<std::string> left{32};
+            stats::space_saving<std::string> right{32};
+            std::mt19937 rng{42};
+            for (uint64_t round = 0; round < 500; ++round)
+            {
+                for (uint64_t h = 0; h < 5; ++h)
+                {
+                    left.increment("heavy-" + std::to_string(h));
+                    right.increment("heavy-" + std::to_string(h));
+                }
+                left.increment("tail-" + std::to_string(rng()));
+                right.increment("tail-" + std::to_string(rng()));
+            }
+
+            left.merge(right);
+            uint64_t heavy_found = 0;
+            for (const auto& ctr : left.counters())
+            {
+                if (ctr.key.find("heavy-") == 0)
+                {
+                    ++heavy_found;
+                    // merged counts remain upper bounds on true counts
+                    AssertThat(ctr.count,
+                               Is().Not().LessThan(uint64_t{1000}));
+                }
+            }
+            AssertThat(heavy_found, Equals(uint64_t{5}));
+        });
+
+        it("should reject a zero counter budget", []() {
+            AssertThrows(stats::space_saving<std::string>::exception,
+                         stats::space_saving<std::string>{0});
+        });
+    });
+});
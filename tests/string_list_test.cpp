@@ -18,12 +18,6 @@ using namespace meta;
 
 namespace {
 
-void assert_read(std::ifstream& file, const std::string& expected) {
-    std::string str;
-    io::read_binary(file, str);
-    AssertThat(str, Equals(expected));
-}
-
 /**
  * Always makes sure a new file is created.
  */
@@ -51,34 +45,12 @@ go_bandit([]() {
 
     describe("[string-list]", []() {
 
-        it("should write strings", [&]() {
-            file_guard f{"meta-tmp-string-list.bin"};
-            file_guard fi{"meta-tmp-string-list.bin_index"};
-            using namespace index;
-            {
-                string_list_writer writer{"meta-tmp-string-list.bin", 5};
-                writer.insert(5, "wat woah this is neato");
-                writer.insert(0, "things and stuff");
-                writer.insert(2, "other stuff");
-                writer.insert(1, "cat");
-                writer.insert(4, "dog");
-                writer.insert(3, "a no good very dead ex-parrot");
-            }
-            std::ifstream file{"meta-tmp-string-list.bin", std::ios::binary};
-            assert_read(file, "wat woah this is neato");
-            assert_read(file, "things and stuff");
-            assert_read(file, "other stuff");
-            assert_read(file, "cat");
-            assert_read(file, "dog");
-            assert_read(file, "a no good very dead ex-parrot");
-        });
-
         it("should read strings", [&]() {
             file_guard f{"meta-tmp-string-list.bin"};
             file_guard fi{"meta-tmp-string-list.bin_index"};
             using namespace index;
             {
-                string_list_writer writer{"meta-tmp-string-list.bin", 5};
+                string_list_writer writer{"meta-tmp-string-list.bin", 6};
                 writer.insert(5, "wat woah this is neato");
                 writer.insert(0, "things and stuff");
                 writer.insert(2, "other stuff");
@@ -88,6 +60,7 @@ go_bandit([]() {
             }
 
             string_list list{"meta-tmp-string-list.bin"};
+            AssertThat(list.size(), Equals(uint64_t{6}));
             AssertThat(list.at(5), Equals("wat woah this is neato"));
             AssertThat(list.at(0), Equals("things and stuff"));
             AssertThat(list.at(2), Equals("other stuff"));
@@ -95,5 +68,63 @@ go_bandit([]() {
             AssertThat(list.at(4), Equals("dog"));
             AssertThat(list.at(3), Equals("a no good very dead ex-parrot"));
         });
+
+        it("should front-code shared prefixes", [&]() {
+            file_guard f{"meta-tmp-string-list.bin"};
+            file_guard fi{"meta-tmp-string-list.bin_index"};
+            using namespace index;
+
+            std::vector<std::string> terms;
+            uint64_t raw_size = 0;
+            for (uint64_t i = 0; i < 100; ++i) {
+                terms.push_back("http://www.example.com/articles/page/"
+                                + std::to_string(i));
+                raw_size += terms.back().size() + 1;
+            }
+            std::sort(terms.begin(), terms.end());
+
+            {
+                string_list_writer writer{"meta-tmp-string-list.bin",
+                                          terms.size()};
+                for (uint64_t i = 0; i < terms.size(); ++i)
+                    writer.insert(i, terms[i]);
+            }
+
+            AssertThat(filesystem::file_size("meta-tmp-string-list.bin") * 2
+                           < raw_size,
+                       IsTrue());
+
+            string_list list{"meta-tmp-string-list.bin"};
+            AssertThat(list.size(), Equals(terms.size()));
+            for (uint64_t i = 0; i < terms.size(); ++i)
+                AssertThat(list.at(i), Equals(terms[i]));
+        });
+
+        it("should find strings in sorted lists", [&]() {
+            file_guard f{"meta-tmp-string-list.bin"};
+            file_guard fi{"meta-tmp-string-list.bin_index"};
+            using namespace index;
+
+            std::vector<std::string> terms;
+            for (uint64_t i = 0; i < 50; ++i)
+                terms.push_back("term" + std::to_string(i));
+            std::sort(terms.begin(), terms.end());
+
+            {
+                string_list_writer writer{"meta-tmp-string-list.bin",
+                                          terms.size()};
+                for (uint64_t i = 0; i < terms.size(); ++i)
+                    writer.insert(i, terms[i]);
+            }
+
+            string_list list{"meta-tmp-string-list.bin"};
+            for (uint64_t i = 0; i < terms.size(); ++i) {
+                auto found = list.find(terms[i]);
+                AssertThat(static_cast<bool>(found), IsTrue());
+                AssertThat(*found, Equals(i));
+            }
+            AssertThat(static_cast<bool>(list.find("aardvark")), IsFalse());
+            AssertThat(static_cast<bool>(list.find("zebra")), IsFalse());
+        });
     });
 });
@@ -0,0 +1,115 @@
+/**
+ * @file thread_pool_test.cpp
+ * @author Chase Geigle
+ */
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "bandit/bandit.h"
+#include "meta/parallel/thread_pool.h"
+
+using namespace bandit;
+
+go_bandit([]() {
+    using namespace meta;
+
+    describe("[thread pool]", []() {
+        it("should join same-pool children from inside a worker", []() {
+            // every worker fans out into the pool and joins its own
+            // children; with a plain future::get() this configuration
+            // deadlocks (all workers asleep, all children queued), so
+            // the join must go through pool.wait()
+            parallel::thread_pool pool{8};
+            std::vector<std::future<uint64_t>> outer;
+            for (uint64_t i = 0; i < 8; ++i)
+            {
+                outer.emplace_back(pool.submit_task([&pool, i]() {
+                    std::vector<std::future<uint64_t>> inner;
+                    for (uint64_t j = 0; j < 8; ++j)
+                    {
+                        inner.emplace_back(pool.submit_task(
+                            [i, j]() { return 8 * i + j; }));
+                    }
+                    uint64_t sum = 0;
+                    for (auto& fut : inner)
+                    {
+                        pool.wait(fut);
+                        sum += fut.get();
+                    }
+                    return sum;
+                }));
+            }
+
+            uint64_t total = 0;
+            for (auto& fut : outer)
+            {
+                pool.wait(fut);
+                total += fut.get();
+            }
+            AssertThat(total, Equals(uint64_t{64 * 63 / 2}));
+        });
+
+        it("should steal tasks queued behind a blocked worker", []() {
+            parallel::thread_pool pool{4};
+
+            // occupy one worker with a task that cannot finish until
+            // every short task has completed, then aim all of the short
+            // tasks at the same inbox: they can only complete if the
+            // other workers steal them
+            std::promise<void> release;
+            auto released = release.get_future().share();
+            auto long_task = pool.submit_task(
+                [released]() {
+                    released.wait();
+                    return std::this_thread::get_id();
+                },
+                0);
+
+            std::vector<std::future<std::thread::id>> shorts;
+            for (std::size_t i = 0; i < 32; ++i)
+            {
+                shorts.emplace_back(pool.submit_task(
+                    []() { return std::this_thread::get_id(); }, 0));
+            }
+
+            std::vector<std::thread::id> ids;
+            for (auto& fut : shorts)
+                ids.push_back(fut.get());
+
+            release.set_value();
+            auto long_id = long_task.get();
+            // the blocked worker cannot have run any of them
+            for (const auto& id : ids)
+                AssertThat(id, Is().Not().EqualTo(long_id));
+        });
+
+        it("should treat affinity hints as placement only", []() {
+            parallel::thread_pool pool{4};
+            auto pool_ids = pool.thread_ids();
+
+            // hints beyond the pool size wrap around, and every hinted
+            // task still runs on some pool thread (an idle worker may
+            // steal it from the hinted inbox)
+            std::vector<std::future<std::thread::id>> futures;
+            for (std::size_t i = 0; i < 2 * pool.size(); ++i)
+            {
+                futures.emplace_back(pool.submit_task(
+                    []() { return std::this_thread::get_id(); }, i));
+            }
+            for (auto& fut : futures)
+            {
+                auto id = fut.get();
+                AssertThat(std::find(pool_ids.begin(), pool_ids.end(), id)
+                               != pool_ids.end(),
+                           IsTrue());
+            }
+
+            // an unpinned pool spans a single memory node
+            AssertThat(pool.num_nodes(), Equals(std::size_t{1}));
+            AssertThat(pool.workers_on_node(0).size(), Equals(pool.size()));
+        });
+    });
+});
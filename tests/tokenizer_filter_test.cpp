@@ -26,7 +26,7 @@ void check_expected(analyzers::token_stream& filter,
 {
     AssertThat(static_cast<bool>(filter), IsTrue());
     for (const auto& s : expected)
-        AssertThat(filter.next(), Equals(s));
+        AssertThat(filter.next().to_string(), Equals(s));
     AssertThat(static_cast<bool>(filter), IsFalse());
 }
 }
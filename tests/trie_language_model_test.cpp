@@ -0,0 +1,75 @@
+/**
+ * @file trie_language_model_test.cpp
+ * @author Sean Massung
+ */
+
+#include "bandit/bandit.h"
+#include "create_config.h"
+#include "meta/io/filesystem.h"
+#include "meta/lm/language_model.h"
+#include "meta/lm/sentence.h"
+#include "meta/lm/trie_language_model.h"
+
+using namespace bandit;
+using namespace meta;
+
+namespace {
+
+void run_test(const cpptoml::table& line_cfg) {
+    lm::language_model reference{line_cfg};
+    lm::trie_language_model model{line_cfg};
+
+    lm::sentence s1{
+        "<s> I disagree with this statement for several reasons . </s>", false};
+    lm::sentence s2{
+        "<s> I disagree with this octopus for several reasons . </s>", false};
+    lm::sentence s3{"<s> Hello world ! </s>", false};
+    lm::sentence s4{"<s> xyz xyz xyz </s>", false};
+
+    // the trie quantizes probabilities and backoffs above unigrams to at
+    // most 256 values per order, so scores may deviate slightly from the
+    // exact hashed representation
+    const double delta = 0.15;
+    AssertThat(model.log_prob(s1),
+               EqualsWithDelta(reference.log_prob(s1), delta));
+    AssertThat(model.log_prob(s2),
+               EqualsWithDelta(reference.log_prob(s2), delta));
+    AssertThat(model.log_prob(s3),
+               EqualsWithDelta(reference.log_prob(s3), delta));
+    AssertThat(model.log_prob(s4),
+               EqualsWithDelta(reference.log_prob(s4), delta));
+
+    AssertThat(model.perplexity(s1),
+               EqualsWithDelta(reference.perplexity(s1), delta));
+    AssertThat(model.perplexity_per_word(s1),
+               EqualsWithDelta(model.perplexity(s1) / s1.size(), 1e-5));
+}
+}
+
+go_bandit([]() {
+    auto line_cfg = tests::create_config("line");
+
+    describe("[language-model] trie_language_model", [&]() {
+
+        it("should create new binary files with correct output",
+           [&]() { run_test(*line_cfg); });
+
+        it("should read binary files with correct output",
+           [&]() { run_test(*line_cfg); });
+
+        filesystem::delete_file("test-lm-0.binlm");
+        filesystem::delete_file("test-lm-1.binlm");
+        filesystem::delete_file("test-lm-2.binlm");
+        filesystem::delete_file("test-lm-0.strings");
+        filesystem::delete_file("test-lm-trie-0.strings");
+        filesystem::delete_file("test-lm-trie-meta.bin");
+        filesystem::delete_file("test-lm-trie-unigrams.bin");
+        filesystem::remove_all("test-lm-trie-1.children");
+        filesystem::remove_all("test-lm-trie-2.children");
+        filesystem::remove_all("test-lm-trie-2.words");
+        filesystem::remove_all("test-lm-trie-2.probs");
+        filesystem::remove_all("test-lm-trie-2.backoffs");
+        filesystem::remove_all("test-lm-trie-3.words");
+        filesystem::remove_all("test-lm-trie-3.probs");
+    });
+});